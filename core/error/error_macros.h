@@ -30,7 +30,19 @@ SOFTWARE.
 
 #include "thirdparty/logger/src/logger.h"
 #include "thirdparty/logger/src/loggerconf.h"
-#include "thirdparty/log/log.h"
+
+// thirdparty/log/log.h declares LOG_TRACE ... LOG_FATAL as plain
+// enumerators, which clash with raylib's TraceLogLevel in every file that
+// also sees raylib.h (Variant's Vector2 and Color come from it). Only the
+// entry point is needed here; the levels are log.h's.
+extern "C" void log_log(int level, const char* file, int line, const char* fmt, ...);
+
+enum ErrLogLevel {
+    ERR_LOG_LEVEL_INFO = 2,
+    ERR_LOG_LEVEL_WARN = 3,
+    ERR_LOG_LEVEL_ERROR = 4,
+};
+
 // Debug Log
 
 #define LOG(...)       do {} while (0)
@@ -48,24 +60,16 @@ SOFTWARE.
 #define BREAK_IF(cond)           if(cond) break
 
 
-#define ERR_PRINT(fmt, ...) \ 
-      log_error("ERROR: " fmt, ##__VA_ARGS__);
-
-
-#define ERR_WARN(fmt , ...) \ 
-      log_warn("WARN: " fmt , ##__VA_ARGS__);
-
-
-#define ERR_WARN(fmt , ...)  \ 
-      log_info("INFO: " fmt, ##__VA_ARGS__);
-
-
-
+#define ERR_PRINT(fmt, ...) \
+      log_log(ERR_LOG_LEVEL_ERROR, __FILE__, __LINE__, "ERROR: " fmt, ##__VA_ARGS__);
 
 
-	
+#define ERR_WARN(fmt , ...) \
+      log_log(ERR_LOG_LEVEL_WARN, __FILE__, __LINE__, "WARN: " fmt , ##__VA_ARGS__);
 
 
+#define ERR_INFO(fmt , ...)  \
+      log_log(ERR_LOG_LEVEL_INFO, __FILE__, __LINE__, "INFO: " fmt, ##__VA_ARGS__);
 
 
 #endif // ERROR_MACROS_H
@@ -0,0 +1,743 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "core/io/async_io.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define AIO_OPEN_FLAGS _O_BINARY
+#else
+#include <unistd.h>
+#define AIO_OPEN_FLAGS O_CLOEXEC
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define AIO_IO_URING_ENABLED
+#endif
+#endif
+
+AsyncIO* AsyncIO::singleton = nullptr;
+
+// Every batch owns its descriptor, so concurrent batches never share a
+// file position and the Windows lseek+read emulation stays correct.
+static int64_t _aio_pread(int fd, uint8_t* dst, size_t length, uint64_t offset) {
+    size_t done = 0;
+#ifdef _WIN32
+    if (_lseeki64(fd, offset, SEEK_SET) < 0) {
+        return -1;
+    }
+#endif
+    while (done < length) {
+#ifdef _WIN32
+        int got = _read(fd, dst + done, static_cast<unsigned int>(std::min<size_t>(length - done, 1u << 30)));
+#else
+        ssize_t got = ::pread(fd, dst + done, length - done, static_cast<off_t>(offset + done));
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+#endif
+        if (got < 0) {
+            return -1;
+        }
+        if (got == 0) {
+            break;
+        }
+        done += static_cast<size_t>(got);
+    }
+    return static_cast<int64_t>(done);
+}
+
+static int64_t _aio_pwrite(int fd, const uint8_t* src, size_t length, uint64_t offset) {
+    size_t done = 0;
+#ifdef _WIN32
+    if (_lseeki64(fd, offset, SEEK_SET) < 0) {
+        return -1;
+    }
+#endif
+    while (done < length) {
+#ifdef _WIN32
+        int put = _write(fd, src + done, static_cast<unsigned int>(std::min<size_t>(length - done, 1u << 30)));
+#else
+        ssize_t put = ::pwrite(fd, src + done, length - done, static_cast<off_t>(offset + done));
+        if (put < 0 && errno == EINTR) {
+            continue;
+        }
+#endif
+        if (put <= 0) {
+            return -1;
+        }
+        done += static_cast<size_t>(put);
+    }
+    return static_cast<int64_t>(done);
+}
+
+Error AsyncRequest::wait() {
+    if (is_done() || !owner) {
+        return error;
+    }
+    return owner->wait(this);
+}
+
+bool AsyncRequest::cancel() {
+    return owner ? owner->cancel(this) : false;
+}
+
+/**
+ * One read or write issued to the backend. A coalesced read carries several
+ * requests and reads their union into `buffer`.
+ */
+struct AsyncIO::Batch {
+    AsyncRequest::Operation op = AsyncRequest::OP_READ;
+    std::string path;
+    uint64_t offset = 0;
+    size_t size = 0;
+    size_t done = 0; ///< Bytes transferred so far, io_uring may return short counts.
+    int fd = -1;
+    uint8_t* dst = nullptr;
+    const uint8_t* src = nullptr;
+    std::vector<Ref<AsyncRequest>> requests;
+    std::vector<uint8_t> buffer;
+};
+
+AsyncIO::AsyncIO(Backend p_backend, int p_threads) {
+    if (!singleton) {
+        singleton = this;
+    }
+    running.store(true, std::memory_order_release);
+
+    const char* forced = std::getenv("PATSHER_ASYNC_IO");
+    if (forced && std::strcmp(forced, "threads") == 0) {
+        p_backend = BACKEND_THREAD_POOL;
+    }
+
+    if (p_backend == BACKEND_IO_URING && _ring_init(64)) {
+        backend = BACKEND_IO_URING;
+        threads.emplace_back(&AsyncIO::_ring_thread, this);
+        return;
+    }
+
+    backend = BACKEND_THREAD_POOL;
+    int count = p_threads;
+    if (count <= 0) {
+        count = static_cast<int>(std::min(4u, std::max(1u, std::thread::hardware_concurrency())));
+    }
+    for (int i = 0; i < count; i++) {
+        threads.emplace_back(&AsyncIO::_worker_thread, this);
+    }
+}
+
+AsyncIO::~AsyncIO() {
+    // Queued requests are dropped; in-flight ones finish before the threads exit.
+    std::vector<Ref<AsyncRequest>> dropped;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        running.store(false, std::memory_order_release);
+        for (int i = 0; i < PRIORITY_MAX; i++) {
+            for (Ref<AsyncRequest>& request : queues[i]) {
+                request->submitted = true;
+                dropped.push_back(std::move(request));
+            }
+            queues[i].clear();
+        }
+        queued = 0;
+    }
+    for (const Ref<AsyncRequest>& request : dropped) {
+        request->cancel_requested.store(true, std::memory_order_relaxed);
+        _complete(request, AsyncRequest::STATUS_CANCELED);
+    }
+
+    queue_cond.notify_all();
+#ifdef AIO_IO_URING_ENABLED
+    if (wake_fd >= 0) {
+        uint64_t one = 1;
+        (void)::write(wake_fd, &one, sizeof(one));
+    }
+#endif
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    _ring_free();
+
+    for (const Ref<AsyncRequest>& request : completed) {
+        request->owner = nullptr;
+    }
+    completed.clear();
+    if (singleton == this) {
+        singleton = nullptr;
+    }
+}
+
+Ref<AsyncRequest> AsyncIO::_queue(AsyncRequest* p_request, Priority p_priority) {
+    Ref<AsyncRequest> request(p_request);
+    request->owner = this;
+    request->priority = p_priority < 0 || p_priority >= PRIORITY_MAX ? PRIORITY_NORMAL : p_priority;
+
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        stats.requests++;
+    }
+
+    if (request->size == 0 || !running.load(std::memory_order_acquire)) {
+        request->submitted = true;
+        if (request->size != 0) {
+            request->error = ERR_UNAVAILABLE;
+        }
+        _complete(request, AsyncRequest::STATUS_DONE);
+        return request;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        queues[request->priority].push_back(request);
+        queued++;
+    }
+
+    if (backend == BACKEND_IO_URING) {
+#ifdef AIO_IO_URING_ENABLED
+        uint64_t one = 1;
+        (void)::write(wake_fd, &one, sizeof(one));
+#endif
+    } else {
+        queue_cond.notify_one();
+    }
+    return request;
+}
+
+Ref<AsyncRequest> AsyncIO::read(const std::string& p_path, uint64_t p_offset, size_t p_size, AsyncRequest::Callback p_callback, Priority p_priority) {
+    AsyncRequest* request = new AsyncRequest;
+    request->op = AsyncRequest::OP_READ;
+    request->path = p_path;
+    request->offset = p_offset;
+    request->size = p_size;
+    request->callback = std::move(p_callback);
+    return _queue(request, p_priority);
+}
+
+Ref<AsyncRequest> AsyncIO::write(const std::string& p_path, uint64_t p_offset, std::vector<uint8_t> p_data, AsyncRequest::Callback p_callback, Priority p_priority) {
+    AsyncRequest* request = new AsyncRequest;
+    request->op = AsyncRequest::OP_WRITE;
+    request->path = p_path;
+    request->offset = p_offset;
+    request->size = p_data.size();
+    request->data = std::move(p_data);
+    request->callback = std::move(p_callback);
+    return _queue(request, p_priority);
+}
+
+// Called with queue_mutex held and queued > 0.
+bool AsyncIO::_pop_batch(Batch& r_batch) {
+    Ref<AsyncRequest> first;
+    for (int i = 0; i < PRIORITY_MAX && first.is_null(); i++) {
+        if (!queues[i].empty()) {
+            first = std::move(queues[i].front());
+            queues[i].pop_front();
+        }
+    }
+    if (first.is_null()) {
+        return false;
+    }
+    first->submitted = true;
+    queued--;
+
+    r_batch.op = first->op;
+    r_batch.path = first->path;
+    r_batch.offset = first->offset;
+    r_batch.size = first->size;
+    r_batch.requests.push_back(std::move(first));
+
+    if (r_batch.op != AsyncRequest::OP_READ) {
+        return true;
+    }
+
+    // Pull in queued reads of the same file that touch the span. A merge can
+    // make an earlier-rejected neighbour adjacent, so rescan until nothing
+    // grows. Only the head of each queue is looked at, which keeps a pop
+    // cheap when thousands of requests are waiting.
+    bool grew = true;
+    while (grew && queued > 0) {
+        grew = false;
+        for (int i = 0; i < PRIORITY_MAX; i++) {
+            std::deque<Ref<AsyncRequest>>& queue = queues[i];
+            size_t window = std::min(queue.size(), COALESCE_WINDOW);
+            for (size_t j = 0; j < window;) {
+                AsyncRequest* request = queue[j].get_ptr();
+                uint64_t begin = std::min(r_batch.offset, request->offset);
+                uint64_t end = std::max(r_batch.offset + r_batch.size, request->offset + request->size);
+                bool touches = request->offset <= r_batch.offset + r_batch.size && r_batch.offset <= request->offset + request->size;
+                if (request->op != AsyncRequest::OP_READ || !touches || end - begin > MAX_COALESCED_SIZE || request->path != r_batch.path) {
+                    j++;
+                    continue;
+                }
+                r_batch.offset = begin;
+                r_batch.size = static_cast<size_t>(end - begin);
+                request->submitted = true;
+                r_batch.requests.push_back(std::move(queue[j]));
+                queue.erase(queue.begin() + j);
+                window--;
+                queued--;
+                grew = true;
+            }
+        }
+    }
+    return true;
+}
+
+bool AsyncIO::_open_batch(Batch& r_batch) {
+    int flags = r_batch.op == AsyncRequest::OP_READ ? O_RDONLY : (O_WRONLY | O_CREAT);
+    r_batch.fd = ::open(r_batch.path.c_str(), flags | AIO_OPEN_FLAGS, 0644);
+    if (r_batch.fd < 0) {
+        Error err = errno == ENOENT ? ERR_FILE_NOT_FOUND : (errno == EACCES ? ERR_FILE_NO_PERMISSION : ERR_FILE_CANT_OPEN);
+        for (const Ref<AsyncRequest>& request : r_batch.requests) {
+            request->error = err;
+        }
+        _finish_batch(r_batch, -1);
+        return false;
+    }
+
+    if (r_batch.op == AsyncRequest::OP_WRITE) {
+        r_batch.src = r_batch.requests[0]->data.data();
+    } else if (r_batch.requests.size() == 1) {
+        // Uncoalesced: read straight into the request.
+        r_batch.requests[0]->data.resize(r_batch.size);
+        r_batch.dst = r_batch.requests[0]->data.data();
+    } else {
+        r_batch.buffer.resize(r_batch.size);
+        r_batch.dst = r_batch.buffer.data();
+    }
+    return true;
+}
+
+void AsyncIO::_finish_batch(Batch& r_batch, int64_t p_result) {
+    if (r_batch.fd >= 0) {
+        ::close(r_batch.fd);
+        r_batch.fd = -1;
+    }
+
+    bool is_read = r_batch.op == AsyncRequest::OP_READ;
+    for (const Ref<AsyncRequest>& request : r_batch.requests) {
+        if (p_result < 0) {
+            if (request->error == OK) {
+                request->error = is_read ? ERR_FILE_CANT_READ : ERR_FILE_CANT_WRITE;
+            }
+            if (is_read) {
+                request->data.clear();
+            }
+            continue;
+        }
+        if (!is_read) {
+            request->transferred = static_cast<size_t>(p_result);
+            continue;
+        }
+        // A short result means end of file: each request gets what exists
+        // of its own range.
+        uint64_t got = static_cast<uint64_t>(p_result);
+        uint64_t start = request->offset - r_batch.offset;
+        size_t available = got > start ? static_cast<size_t>(std::min<uint64_t>(request->size, got - start)) : 0;
+        if (r_batch.requests.size() == 1) {
+            request->data.resize(available);
+        } else {
+            request->data.assign(r_batch.buffer.data() + start, r_batch.buffer.data() + start + available);
+        }
+        request->transferred = available;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        stats.operations++;
+        stats.coalesced += r_batch.requests.size() - 1;
+        if (p_result > 0) {
+            stats.bytes += static_cast<uint64_t>(p_result);
+        }
+    }
+
+    for (const Ref<AsyncRequest>& request : r_batch.requests) {
+        bool canceled = request->cancel_requested.load(std::memory_order_acquire);
+        if (canceled && is_read) {
+            request->data.clear();
+            request->data.shrink_to_fit();
+            request->transferred = 0;
+        }
+        _complete(request, canceled ? AsyncRequest::STATUS_CANCELED : AsyncRequest::STATUS_DONE);
+    }
+    r_batch.requests.clear();
+}
+
+void AsyncIO::_complete(const Ref<AsyncRequest>& p_request, AsyncRequest::Status p_status) {
+    if (p_status == AsyncRequest::STATUS_CANCELED) {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        stats.canceled++;
+    }
+    {
+        std::lock_guard<std::mutex> lock(done_mutex);
+        p_request->status.store(p_status, std::memory_order_release);
+        // Requests without a callback need no poll(), so nothing keeps them.
+        if (p_request->callback.is_valid()) {
+            completed.push_back(p_request);
+        }
+    }
+    done_cond.notify_all();
+}
+
+bool AsyncIO::cancel(const Ref<AsyncRequest>& p_request) {
+    return cancel(p_request.get_ptr());
+}
+
+bool AsyncIO::cancel(AsyncRequest* p_request) {
+    if (!p_request || p_request->owner != this) {
+        return false;
+    }
+
+    Ref<AsyncRequest> dropped;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        if (p_request->is_done()) {
+            return false;
+        }
+        p_request->cancel_requested.store(true, std::memory_order_release);
+        if (p_request->submitted) {
+            // In flight, the backend completes it as canceled.
+            return true;
+        }
+        std::deque<Ref<AsyncRequest>>& queue = queues[p_request->priority];
+        for (size_t i = 0; i < queue.size(); i++) {
+            if (queue[i].get_ptr() == p_request) {
+                dropped = std::move(queue[i]);
+                queue.erase(queue.begin() + i);
+                queued--;
+                break;
+            }
+        }
+        p_request->submitted = true;
+    }
+    if (dropped.is_valid()) {
+        dropped->data.clear();
+        _complete(dropped, AsyncRequest::STATUS_CANCELED);
+    }
+    return true;
+}
+
+Error AsyncIO::wait(AsyncRequest* p_request) {
+    std::unique_lock<std::mutex> lock(done_mutex);
+    done_cond.wait(lock, [p_request] { return p_request->is_done(); });
+    return p_request->error;
+}
+
+int AsyncIO::poll(int p_max) {
+    std::vector<Ref<AsyncRequest>> ready;
+    {
+        std::lock_guard<std::mutex> lock(done_mutex);
+        if (p_max <= 0 || static_cast<size_t>(p_max) >= completed.size()) {
+            ready.swap(completed);
+        } else {
+            ready.assign(std::make_move_iterator(completed.begin()), std::make_move_iterator(completed.begin() + p_max));
+            completed.erase(completed.begin(), completed.begin() + p_max);
+        }
+    }
+    for (const Ref<AsyncRequest>& request : ready) {
+        // Dropped after the call, a closure holding its own request must not
+        // keep it alive.
+        AsyncRequest::Callback callback = std::move(request->callback);
+        request->callback.reset();
+        callback(*request.get_ptr());
+    }
+    return static_cast<int>(ready.size());
+}
+
+AsyncIO::Stats AsyncIO::get_stats() {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    return stats;
+}
+
+void AsyncIO::_worker_thread() {
+    while (true) {
+        Batch batch;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_cond.wait(lock, [this] { return queued > 0 || !running.load(std::memory_order_acquire); });
+            if (queued == 0) {
+                return;
+            }
+            _pop_batch(batch);
+        }
+        if (!_open_batch(batch)) {
+            continue;
+        }
+        int64_t result = batch.op == AsyncRequest::OP_READ
+                ? _aio_pread(batch.fd, batch.dst, batch.size, batch.offset)
+                : _aio_pwrite(batch.fd, batch.src, batch.size, batch.offset);
+        _finish_batch(batch, result);
+    }
+}
+
+#ifdef AIO_IO_URING_ENABLED
+
+/** Submission and completion rings shared with the kernel. */
+struct AsyncIO::Ring {
+    int fd = -1;
+    unsigned entries = 0;
+
+    unsigned* sq_head = nullptr;
+    unsigned* sq_tail = nullptr;
+    unsigned* sq_mask = nullptr;
+    unsigned* sq_array = nullptr;
+    io_uring_sqe* sqes = nullptr;
+
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned* cq_mask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+
+    void* sq_ptr = MAP_FAILED;
+    size_t sq_size = 0;
+    void* cq_ptr = MAP_FAILED;
+    size_t cq_size = 0;
+    size_t sqes_size = 0;
+
+    uint64_t wake_value = 0; ///< Target of the pending eventfd read.
+};
+
+static const uint64_t AIO_WAKE_TAG = 0;
+
+bool AsyncIO::_ring_init(unsigned p_entries) {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    int fd = static_cast<int>(syscall(__NR_io_uring_setup, p_entries, &params));
+    if (fd < 0) {
+        return false; // Old kernel, or blocked by seccomp (containers).
+    }
+    // IORING_OP_READ needs 5.6; FAST_POLL arrived in 5.7 and is the
+    // cheapest feature bit that proves it.
+    if (!(params.features & IORING_FEAT_FAST_POLL)) {
+        ::close(fd);
+        return false;
+    }
+
+    Ring* r = new Ring;
+    r->fd = fd;
+    r->entries = params.sq_entries;
+    r->sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    r->cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        r->sq_size = r->cq_size = std::max(r->sq_size, r->cq_size);
+    }
+
+    r->sq_ptr = mmap(nullptr, r->sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (r->sq_ptr != MAP_FAILED) {
+        r->cq_ptr = single_mmap ? r->sq_ptr : mmap(nullptr, r->cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    }
+    r->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = MAP_FAILED;
+    if (r->cq_ptr != MAP_FAILED) {
+        sqes = mmap(nullptr, r->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    }
+    wake_fd = sqes != MAP_FAILED ? eventfd(0, EFD_CLOEXEC) : -1;
+    ring = r;
+    if (wake_fd < 0) {
+        if (sqes != MAP_FAILED) {
+            munmap(sqes, r->sqes_size);
+        }
+        _ring_free();
+        return false;
+    }
+
+    uint8_t* sq = static_cast<uint8_t*>(r->sq_ptr);
+    uint8_t* cq = static_cast<uint8_t*>(r->cq_ptr);
+    r->sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    r->sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    r->sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    r->sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    r->sqes = static_cast<io_uring_sqe*>(sqes);
+    r->cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    r->cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    r->cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    r->cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    return true;
+}
+
+void AsyncIO::_ring_free() {
+    if (wake_fd >= 0) {
+        ::close(wake_fd);
+        wake_fd = -1;
+    }
+    if (!ring) {
+        return;
+    }
+    if (ring->sqes) {
+        munmap(ring->sqes, ring->sqes_size);
+    }
+    if (ring->cq_ptr != MAP_FAILED && ring->cq_ptr != ring->sq_ptr) {
+        munmap(ring->cq_ptr, ring->cq_size);
+    }
+    if (ring->sq_ptr != MAP_FAILED) {
+        munmap(ring->sq_ptr, ring->sq_size);
+    }
+    if (ring->fd >= 0) {
+        ::close(ring->fd);
+    }
+    delete ring;
+    ring = nullptr;
+}
+
+// The ring thread is the only producer of SQEs and only consumer of CQEs.
+static void _aio_prep(unsigned* p_sq_tail, unsigned* p_sq_mask, unsigned* p_sq_array, io_uring_sqe* p_sqes,
+        uint8_t p_opcode, int p_fd, const void* p_addr, unsigned p_len, uint64_t p_offset, uint64_t p_user_data) {
+    unsigned tail = *p_sq_tail;
+    unsigned index = tail & *p_sq_mask;
+    io_uring_sqe* sqe = &p_sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = p_opcode;
+    sqe->fd = p_fd;
+    sqe->addr = reinterpret_cast<uint64_t>(p_addr);
+    sqe->len = p_len;
+    sqe->off = p_offset;
+    sqe->user_data = p_user_data;
+    p_sq_array[index] = index;
+    __atomic_store_n(p_sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+void AsyncIO::_ring_thread() {
+    Ring* r = ring;
+    unsigned in_flight = 0;
+    unsigned to_submit = 0;
+    bool arm_wake = true;
+    // Leave room for the eventfd read.
+    const unsigned max_in_flight = r->entries - 1;
+    // Linux caps a single read at 0x7ffff000 bytes.
+    const size_t max_len = 0x7ffff000;
+
+    auto prep_batch = [&](Batch* p_batch) {
+        size_t remaining = p_batch->size - p_batch->done;
+        unsigned len = static_cast<unsigned>(std::min(remaining, max_len));
+        uint64_t offset = p_batch->offset + p_batch->done;
+        if (p_batch->op == AsyncRequest::OP_READ) {
+            _aio_prep(r->sq_tail, r->sq_mask, r->sq_array, r->sqes, IORING_OP_READ, p_batch->fd, p_batch->dst + p_batch->done, len, offset, reinterpret_cast<uint64_t>(p_batch));
+        } else {
+            _aio_prep(r->sq_tail, r->sq_mask, r->sq_array, r->sqes, IORING_OP_WRITE, p_batch->fd, p_batch->src + p_batch->done, len, offset, reinterpret_cast<uint64_t>(p_batch));
+        }
+        to_submit++;
+    };
+
+    std::vector<Batch*> fresh;
+    while (true) {
+        fresh.clear();
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            if (!running.load(std::memory_order_acquire) && queued == 0 && in_flight == 0) {
+                break;
+            }
+            while (queued > 0 && in_flight + fresh.size() < max_in_flight) {
+                Batch* batch = new Batch;
+                if (!_pop_batch(*batch)) {
+                    delete batch;
+                    break;
+                }
+                fresh.push_back(batch);
+            }
+        }
+
+        for (Batch* batch : fresh) {
+            if (!_open_batch(*batch)) {
+                delete batch;
+                continue;
+            }
+            prep_batch(batch);
+            in_flight++;
+        }
+        if (arm_wake) {
+            _aio_prep(r->sq_tail, r->sq_mask, r->sq_array, r->sqes, IORING_OP_READ, wake_fd, &r->wake_value, sizeof(r->wake_value), static_cast<uint64_t>(-1), AIO_WAKE_TAG);
+            to_submit++;
+            arm_wake = false;
+        }
+
+        // Submit and sleep until something completes: I/O, or the eventfd
+        // written by _queue() / the destructor.
+        while (true) {
+            int ret = static_cast<int>(syscall(__NR_io_uring_enter, r->fd, to_submit, 1, IORING_ENTER_GETEVENTS, nullptr, 0));
+            if (ret >= 0) {
+                to_submit -= std::min<unsigned>(to_submit, static_cast<unsigned>(ret));
+                break;
+            }
+            if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                break;
+            }
+        }
+
+        unsigned head = *r->cq_head;
+        unsigned tail = __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+        while (head != tail) {
+            io_uring_cqe* cqe = &r->cqes[head & *r->cq_mask];
+            uint64_t user_data = cqe->user_data;
+            int res = cqe->res;
+            head++;
+            if (user_data == AIO_WAKE_TAG) {
+                arm_wake = true;
+                continue;
+            }
+            Batch* batch = reinterpret_cast<Batch*>(user_data);
+            if (res > 0) {
+                batch->done += static_cast<size_t>(res);
+                if (batch->done < batch->size) {
+                    prep_batch(batch); // Short transfer, continue the rest.
+                    continue;
+                }
+            }
+            in_flight--;
+            int64_t result = static_cast<int64_t>(batch->done);
+            if (res < 0 || (res == 0 && batch->op == AsyncRequest::OP_WRITE)) {
+                result = -1;
+            }
+            _finish_batch(*batch, result);
+            delete batch;
+        }
+        __atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+    }
+}
+
+#else
+
+bool AsyncIO::_ring_init(unsigned p_entries) {
+    (void)p_entries;
+    return false;
+}
+
+void AsyncIO::_ring_free() {
+    wake_fd = -1;
+}
+
+void AsyncIO::_ring_thread() {
+}
+
+#endif // AIO_IO_URING_ENABLED
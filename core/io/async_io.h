@@ -0,0 +1,232 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef ASYNC_IO_H
+#define ASYNC_IO_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/error/error_list.h"
+#include "core/object/ref_counted.h"
+#include "core/templates/delegate.h"
+
+class AsyncIO;
+
+/**
+ * @class AsyncRequest
+ * @brief Completion token for one asynchronous read or write.
+ *
+ * Returned by AsyncIO::read() / write() and FileAccess::read_async(). The
+ * caller may poll is_done(), block in wait(), or cancel(). Once done, the
+ * result fields are immutable and can be read from any thread.
+ */
+class AsyncRequest : public RefCounted {
+public:
+    enum Status {
+        STATUS_PENDING, ///< Queued or in flight.
+        STATUS_DONE, ///< Completed, see get_error() for the outcome.
+        STATUS_CANCELED, ///< Canceled before its result was delivered.
+    };
+
+    enum Operation {
+        OP_READ,
+        OP_WRITE,
+    };
+
+    /** Runs on the thread that calls AsyncIO::poll(), never on an I/O thread. */
+    typedef Delegate<void(AsyncRequest&)> Callback;
+
+private:
+    friend class AsyncIO;
+
+    AsyncIO* owner = nullptr;
+    Operation op = OP_READ;
+    int priority = 0;
+    std::string path;
+    uint64_t offset = 0;
+    size_t size = 0;
+    Callback callback;
+
+    std::atomic<int> status{ STATUS_PENDING };
+    std::atomic<bool> cancel_requested{ false };
+    bool submitted = false; ///< Taken off the queue by a backend. Guarded by AsyncIO::queue_mutex.
+    Error error = OK;
+    size_t transferred = 0;
+    std::vector<uint8_t> data; ///< Read result, or the bytes to write.
+
+public:
+    Operation get_operation() const { return op; }
+    const std::string& get_path() const { return path; }
+    uint64_t get_offset() const { return offset; }
+    size_t get_size() const { return size; }
+
+    Status get_status() const { return static_cast<Status>(status.load(std::memory_order_acquire)); }
+    bool is_done() const { return get_status() != STATUS_PENDING; }
+    bool is_canceled() const { return get_status() == STATUS_CANCELED; }
+
+    /** Valid once done. ERR_FILE_CANT_OPEN, ERR_FILE_CANT_READ, ... */
+    Error get_error() const { return error; }
+    /** Bytes read or written. A read past the end of the file is short, not an error. */
+    size_t get_bytes_transferred() const { return transferred; }
+    /** Bytes read. Valid once done; empty for writes. */
+    const std::vector<uint8_t>& get_data() const { return data; }
+    /** Moves the read bytes out of the request. */
+    std::vector<uint8_t> take_data() { return std::move(data); }
+
+    /** Blocks until the request is done or canceled. Returns get_error(). */
+    Error wait();
+    /** See AsyncIO::cancel(). */
+    bool cancel();
+};
+
+/**
+ * @class AsyncIO
+ * @brief Asynchronous file I/O service.
+ *
+ * Requests are queued per priority class and handed to a backend:
+ *  - io_uring on Linux (raw syscalls, no liburing), one thread submitting
+ *    and reaping; a queued request wakes it through an eventfd.
+ *  - a pool of threads doing pread()/pwrite() everywhere else, and on
+ *    kernels or sandboxes where io_uring_setup() fails.
+ * Setting PATSHER_ASYNC_IO=threads in the environment forces the pool.
+ *
+ * When a backend takes a read it also takes the queued reads of the same
+ * file whose ranges touch it (within the first COALESCE_WINDOW entries of
+ * each queue, up to MAX_COALESCED_SIZE), issues one read for the whole span
+ * and splits the result. Many small adjacent reads, as issued by a loader
+ * walking a pack file, become a few large ones.
+ *
+ * Priorities are strict: LOW requests only run when no HIGH or NORMAL
+ * request is queued. Completion callbacks are not run on I/O threads; they
+ * are queued and run by poll(), which the main loop calls once per frame.
+ */
+class AsyncIO {
+public:
+    enum Priority {
+        PRIORITY_HIGH, ///< Needed this frame (streaming in view).
+        PRIORITY_NORMAL,
+        PRIORITY_LOW, ///< Prefetch, background loading.
+        PRIORITY_MAX
+    };
+
+    enum Backend {
+        BACKEND_THREAD_POOL,
+        BACKEND_IO_URING,
+    };
+
+    static constexpr size_t MAX_COALESCED_SIZE = 4 * 1024 * 1024;
+    static constexpr size_t COALESCE_WINDOW = 64; ///< Queued requests per priority considered for a merge.
+
+    struct Stats {
+        uint64_t requests = 0; ///< Requests queued.
+        uint64_t operations = 0; ///< Reads and writes actually issued.
+        uint64_t coalesced = 0; ///< Requests served by another request's read.
+        uint64_t canceled = 0;
+        uint64_t bytes = 0;
+    };
+
+private:
+    struct Batch;
+    struct Ring;
+
+    static AsyncIO* singleton;
+
+    Backend backend = BACKEND_THREAD_POOL;
+    std::atomic<bool> running{ false };
+
+    std::mutex queue_mutex;
+    std::condition_variable queue_cond;
+    std::deque<Ref<AsyncRequest>> queues[PRIORITY_MAX];
+    size_t queued = 0;
+
+    std::mutex done_mutex;
+    std::condition_variable done_cond;
+    std::vector<Ref<AsyncRequest>> completed; ///< Waiting for poll() to run their callbacks.
+
+    std::vector<std::thread> threads;
+    Ring* ring = nullptr;
+    int wake_fd = -1;
+
+    std::mutex stats_mutex;
+    Stats stats;
+
+    Ref<AsyncRequest> _queue(AsyncRequest* p_request, Priority p_priority);
+    bool _pop_batch(Batch& r_batch);
+    bool _open_batch(Batch& r_batch);
+    void _finish_batch(Batch& r_batch, int64_t p_result);
+    void _complete(const Ref<AsyncRequest>& p_request, AsyncRequest::Status p_status);
+
+    void _worker_thread();
+    bool _ring_init(unsigned p_entries);
+    void _ring_free();
+    void _ring_thread();
+
+public:
+    static AsyncIO* get_singleton() { return singleton; }
+
+    /**
+     * @brief Starts the service.
+     * @param p_backend Preferred backend; io_uring falls back to the pool
+     * when unavailable.
+     * @param p_threads Pool size, 0 for min(4, hardware threads).
+     */
+    AsyncIO(Backend p_backend = BACKEND_IO_URING, int p_threads = 0);
+    ~AsyncIO();
+
+    Backend get_backend() const { return backend; }
+
+    /** @brief Reads p_size bytes at p_offset. */
+    Ref<AsyncRequest> read(const std::string& p_path, uint64_t p_offset, size_t p_size, AsyncRequest::Callback p_callback = nullptr, Priority p_priority = PRIORITY_NORMAL);
+    /** @brief Writes p_data at p_offset, creating the file if needed. */
+    Ref<AsyncRequest> write(const std::string& p_path, uint64_t p_offset, std::vector<uint8_t> p_data, AsyncRequest::Callback p_callback = nullptr, Priority p_priority = PRIORITY_NORMAL);
+
+    /**
+     * @brief Cancels a request. A queued request is dropped without touching
+     * the file. One already in flight still runs, but completes as canceled
+     * and its data is discarded. The callback runs either way.
+     * @return false if the request had already completed.
+     */
+    bool cancel(const Ref<AsyncRequest>& p_request);
+    bool cancel(AsyncRequest* p_request);
+
+    Error wait(AsyncRequest* p_request);
+
+    /**
+     * @brief Runs the callbacks of completed requests on the calling thread.
+     * @param p_max Stop after this many, 0 for all.
+     * @return Callbacks run.
+     */
+    int poll(int p_max = 0);
+
+    Stats get_stats();
+};
+
+#endif // ASYNC_IO_H
@@ -20,25 +20,687 @@
  * 
  * 
  */
+#include "config_file.h"
 
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
 
-#include "config_file.h"
+#include "core/io/file_access.h"
+#include "core/variant/variant_parser.h"
+#include "core/variant/variant_utils.h"
+
+namespace {
+
+struct CacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t source_size;
+    int64_t source_mtime;
+    uint64_t content_hash;
+    uint32_t payload_size;
+    uint32_t reserved;
+};
+static_assert(sizeof(CacheHeader) == ConfigFile::CACHE_HEADER_SIZE, "Cache header layout changed");
+
+inline uint64_t _mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+std::string_view _trim(std::string_view p_text) {
+    size_t from = 0;
+    size_t to = p_text.size();
+    while (from < to && (p_text[from] == ' ' || p_text[from] == '\t' || p_text[from] == '\r')) {
+        from++;
+    }
+    while (to > from && (p_text[to - 1] == ' ' || p_text[to - 1] == '\t' || p_text[to - 1] == '\r')) {
+        to--;
+    }
+    return p_text.substr(from, to - from);
+}
+
+// Bare INI values end at a ';' or '#' that follows whitespace, so "#fff"
+// and "a;b" stay whole.
+std::string_view _strip_comment(std::string_view p_text) {
+    for (size_t i = 1; i < p_text.size(); i++) {
+        if ((p_text[i] == ';' || p_text[i] == '#') && (p_text[i - 1] == ' ' || p_text[i - 1] == '\t')) {
+            return _trim(p_text.substr(0, i));
+        }
+    }
+    return p_text;
+}
+
+// Only arrays, dictionaries, strings and constructor calls may continue
+// on the next lines; a bare value always ends with its line.
+bool _may_span_lines(std::string_view p_value) {
+    if (p_value.empty()) {
+        return false;
+    }
+    if (p_value[0] == '[' || p_value[0] == '{' || p_value[0] == '"') {
+        return true;
+    }
+    size_t i = 0;
+    while (i < p_value.size() && (isalnum(static_cast<unsigned char>(p_value[i])) || p_value[i] == '_')) {
+        i++;
+    }
+    if (i == 0 || isdigit(static_cast<unsigned char>(p_value[0]))) {
+        return false;
+    }
+    while (i < p_value.size() && (p_value[i] == ' ' || p_value[i] == '\t')) {
+        i++;
+    }
+    return i < p_value.size() && p_value[i] == '(';
+}
+
+// Tracks bracket depth across the lines of a multi-line value. Outside a
+// string, a ';' or '#' after whitespace ends the line, as in
+// _strip_comment(); source collects the lines without their comments.
+struct BracketScanner {
+    int depth = 0;
+    bool in_string = false;
+    bool escape = false;
+    std::string source;
+
+    void feed(std::string_view p_text) {
+        if (!source.empty()) {
+            source += '\n';
+        }
+        char previous = ' ';
+        size_t length = 0;
+        for (char c : p_text) {
+            const char before = previous;
+            previous = c;
+            if (!in_string && (c == ';' || c == '#') && (before == ' ' || before == '\t')) {
+                break;
+            }
+            length++;
+            if (in_string) {
+                if (escape) {
+                    escape = false;
+                } else if (c == '\\') {
+                    escape = true;
+                } else if (c == '"') {
+                    in_string = false;
+                }
+            } else if (c == '"') {
+                in_string = true;
+            } else if (c == '[' || c == '{' || c == '(') {
+                depth++;
+            } else if (c == ']' || c == '}' || c == ')') {
+                depth--;
+            }
+        }
+        while (length > 0 && (p_text[length - 1] == '\r' || (!in_string && (p_text[length - 1] == ' ' || p_text[length - 1] == '\t')))) {
+            length--;
+        }
+        source.append(p_text.data(), length);
+    }
+};
+
+void _append_real(std::string& r_out, double p_value, bool p_single) {
+    if (std::isnan(p_value)) {
+        r_out += "nan";
+        return;
+    }
+    if (std::isinf(p_value)) {
+        r_out += p_value > 0 ? "inf" : "inf_neg";
+        return;
+    }
+    // Shortest form that reads back to the same value.
+    char buffer[32];
+    for (int precision = p_single ? 6 : 15; precision <= 17; precision++) {
+        snprintf(buffer, sizeof(buffer), "%.*g", precision, p_value);
+        if (p_single ? float(strtod(buffer, nullptr)) == float(p_value) : strtod(buffer, nullptr) == p_value) {
+            break;
+        }
+    }
+    r_out += buffer;
+    if (!strpbrk(buffer, ".e")) {
+        r_out += ".0"; // Keep it a float on reload.
+    }
+}
+
+void _append_value(std::string& r_out, const Variant& p_value) {
+    char buffer[96];
+    switch (p_value.get_type()) {
+        case Variant::BOOL:
+            r_out += p_value.operator bool() ? "true" : "false";
+            break;
+        case Variant::INT:
+            snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(p_value.operator int64_t()));
+            r_out += buffer;
+            break;
+        case Variant::FLOAT:
+            _append_real(r_out, p_value.operator double(), false);
+            break;
+        case Variant::VECTOR2: {
+            Vector2 v = p_value;
+            r_out += "Vector2(";
+            _append_real(r_out, v.x, true);
+            r_out += ", ";
+            _append_real(r_out, v.y, true);
+            r_out += ")";
+        } break;
+        case Variant::VECTOR2I: {
+            Vector2i v = p_value;
+            snprintf(buffer, sizeof(buffer), "Vector2i(%d, %d)", v.x, v.y);
+            r_out += buffer;
+        } break;
+        case Variant::RECT2I: {
+            Rect2i r = p_value;
+            snprintf(buffer, sizeof(buffer), "Rect2i(%d, %d, %d, %d)", r.x, r.y, r.width, r.height);
+            r_out += buffer;
+        } break;
+        case Variant::COLOR: {
+            Color c = p_value;
+            const float components[4] = { color_component_to_float(c.r), color_component_to_float(c.g), color_component_to_float(c.b), color_component_to_float(c.a) };
+            r_out += "Color(";
+            for (int i = 0; i < 4; i++) {
+                if (i > 0) {
+                    r_out += ", ";
+                }
+                _append_real(r_out, components[i], true);
+            }
+            r_out += ")";
+        } break;
+        case Variant::STRING: {
+            const std::string* text = p_value.get_string_ptr();
+            r_out += '"';
+            for (char c : *text) {
+                switch (c) {
+                    case '"':
+                        r_out += "\\\"";
+                        break;
+                    case '\\':
+                        r_out += "\\\\";
+                        break;
+                    case '\n':
+                        r_out += "\\n";
+                        break;
+                    case '\r':
+                        r_out += "\\r";
+                        break;
+                    case '\t':
+                        r_out += "\\t";
+                        break;
+                    default:
+                        r_out += c;
+                }
+            }
+            r_out += '"';
+        } break;
+        default:
+            r_out += "null"; // Objects have no text form.
+            break;
+    }
+}
 
+Error _read_text(const std::string& p_path, std::string& r_text) {
+    FileAccess file;
+    if (!file.open(p_path, FileAccess::READ)) {
+        return ERR_FILE_CANT_OPEN;
+    }
+    r_text.resize(static_cast<size_t>(file.get_length()));
+    if (file.get_buffer(reinterpret_cast<uint8_t*>(&r_text[0]), r_text.size()) != r_text.size()) {
+        return ERR_FILE_CANT_READ;
+    }
+    return OK;
+}
+
+} // namespace
+
+ConfigFile::ConfigFile() {}
+
+ConfigFile::~ConfigFile() {}
+
+ConfigFile::Section& ConfigFile::_get_section(const std::string& p_section) {
+    auto it = section_index.find(p_section);
+    if (it != section_index.end()) {
+        return sections[it->second];
+    }
+    section_index.emplace(p_section, static_cast<uint32_t>(sections.size()));
+    sections.emplace_back();
+    sections.back().name = p_section;
+    return sections.back();
+}
+
+const ConfigFile::Value* ConfigFile::_find(const std::string& p_section, const std::string& p_key) const {
+    auto section = section_index.find(p_section);
+    if (section == section_index.end()) {
+        return nullptr;
+    }
+    const Section& s = sections[section->second];
+    auto key = s.keys.find(p_key);
+    return key == s.keys.end() ? nullptr : &s.values[key->second];
+}
+
+void ConfigFile::_set(Section& r_section, std::string_view p_key, Variant&& p_value, bool p_verbatim) {
+    std::string key(p_key);
+    auto result = r_section.keys.emplace(key, static_cast<uint32_t>(r_section.values.size()));
+    if (!result.second) {
+        Value& value = r_section.values[result.first->second];
+        value.value = std::move(p_value);
+        value.verbatim = p_verbatim;
+        return;
+    }
+    r_section.values.push_back({ std::move(key), std::move(p_value), p_verbatim });
+}
 
-#include "core/object/ref_counted.h"
-#include "core/object/script.h"
-#include "modules/mic/src/mic.h"
+void ConfigFile::set_value(const std::string& p_section, const std::string& p_key, const Variant& p_value) {
+    _set(_get_section(p_section), p_key, Variant(p_value), false);
+}
 
-ConfigFile::ConfigFile()
-	: Data()
-{
-	
+Variant ConfigFile::get_value(const std::string& p_section, const std::string& p_key, const Variant& p_default) const {
+    const Value* value = _find(p_section, p_key);
+    return value ? value->value : p_default;
 }
 
+const Variant* ConfigFile::get_value_ptr(const std::string& p_section, const std::string& p_key) const {
+    const Value* value = _find(p_section, p_key);
+    return value ? &value->value : nullptr;
+}
 
-ConfigFile::~ConfigFile()
-{
-	
+bool ConfigFile::has_section(const std::string& p_section) const {
+    return section_index.count(p_section) != 0;
 }
 
+bool ConfigFile::has_section_key(const std::string& p_section, const std::string& p_key) const {
+    return _find(p_section, p_key) != nullptr;
+}
 
+std::vector<std::string> ConfigFile::get_sections() const {
+    std::vector<std::string> result;
+    result.reserve(sections.size());
+    for (const Section& section : sections) {
+        result.push_back(section.name);
+    }
+    return result;
+}
+
+std::vector<std::string> ConfigFile::get_section_keys(const std::string& p_section) const {
+    std::vector<std::string> result;
+    auto it = section_index.find(p_section);
+    if (it != section_index.end()) {
+        for (const Value& value : sections[it->second].values) {
+            result.push_back(value.key);
+        }
+    }
+    return result;
+}
+
+void ConfigFile::erase_section(const std::string& p_section) {
+    auto it = section_index.find(p_section);
+    if (it == section_index.end()) {
+        return;
+    }
+    uint32_t index = it->second;
+    sections.erase(sections.begin() + index);
+    section_index.erase(it);
+    for (auto& entry : section_index) {
+        if (entry.second > index) {
+            entry.second--;
+        }
+    }
+}
+
+void ConfigFile::erase_section_key(const std::string& p_section, const std::string& p_key) {
+    auto it = section_index.find(p_section);
+    if (it == section_index.end()) {
+        return;
+    }
+    Section& section = sections[it->second];
+    auto key = section.keys.find(p_key);
+    if (key == section.keys.end()) {
+        return;
+    }
+    uint32_t index = key->second;
+    section.values.erase(section.values.begin() + index);
+    section.keys.erase(key);
+    for (auto& entry : section.keys) {
+        if (entry.second > index) {
+            entry.second--;
+        }
+    }
+}
+
+void ConfigFile::clear() {
+    sections.clear();
+    section_index.clear();
+}
+
+Error ConfigFile::_error(int p_line, const char* p_message) {
+    error_line = p_line;
+    error_text = p_message;
+    return ERR_PARSE_ERROR;
+}
+
+Error ConfigFile::parse(std::string_view p_text) {
+    clear();
+    error_line = 0;
+    error_text.clear();
+    if (p_text.size() >= 3 && memcmp(p_text.data(), "\xEF\xBB\xBF", 3) == 0) {
+        p_text.remove_prefix(3);
+    }
+
+    VariantParser parser;
+    VariantParser::Event event;
+    std::string unescaped;
+    Section* section = nullptr;
+    const char* cursor = p_text.data();
+    const char* end = cursor + p_text.size();
+    int line = 0;
+
+    while (cursor < end) {
+        const char* newline = static_cast<const char*>(memchr(cursor, '\n', end - cursor));
+        const char* line_end = newline ? newline : end;
+        std::string_view text = _trim(std::string_view(cursor, line_end - cursor));
+        cursor = newline ? newline + 1 : end;
+        line++;
+
+        if (text.empty() || text[0] == ';' || text[0] == '#') {
+            continue;
+        }
+        if (text[0] == '[') {
+            size_t close = text.find(']');
+            if (close == std::string_view::npos) {
+                return _error(line, "Expected ']' after section name.");
+            }
+            section = &_get_section(std::string(_trim(text.substr(1, close - 1))));
+            continue;
+        }
+
+        size_t equals = text.find('=');
+        if (equals == std::string_view::npos || equals == 0) {
+            return _error(line, "Expected 'key = value'.");
+        }
+        std::string_view key = _trim(text.substr(0, equals));
+        std::string_view value = _trim(text.substr(equals + 1));
+
+        BracketScanner scanner;
+        const bool spans = _may_span_lines(value);
+        if (spans) {
+            scanner.feed(value);
+        }
+        int first_line = line;
+        while ((scanner.depth > 0 || scanner.in_string) && cursor < end) {
+            newline = static_cast<const char*>(memchr(cursor, '\n', end - cursor));
+            line_end = newline ? newline : end;
+            scanner.feed(std::string_view(cursor, line_end - cursor));
+            value = _trim(std::string_view(value.data(), line_end - value.data()));
+            cursor = newline ? newline + 1 : end;
+            line++;
+        }
+        if (scanner.depth > 0 || scanner.in_string) {
+            return _error(first_line, "Unterminated value.");
+        }
+
+        if (!section) {
+            section = &_get_section(std::string());
+        }
+
+        // The parser reads "key = value" as a top-level property.
+        const char* value_end = value.data() + value.size();
+        parser.open_buffer(key.data(), value_end - key.data());
+        if (parser.next(event) == OK && event.type == VariantParser::EVENT_KEY && parser.next(event) == OK && event.type == VariantParser::EVENT_VALUE) {
+            std::string_view rest = _trim(std::string_view(key.data() + parser.get_position(), value_end - key.data() - parser.get_position()));
+            if (rest.empty() || rest[0] == ';' || rest[0] == '#') {
+                if (event.is_string) {
+                    if (event.has_escapes) {
+                        VariantParser::unescape(event.text, unescaped);
+                        _set(*section, key, Variant(unescaped), false);
+                    } else {
+                        _set(*section, key, Variant(std::string(event.text)), false);
+                    }
+                } else {
+                    _set(*section, key, std::move(event.value), false);
+                }
+                continue;
+            }
+        }
+        _set(*section, key, Variant(spans ? std::move(scanner.source) : std::string(_strip_comment(value))), true);
+    }
+    return OK;
+}
+
+Error ConfigFile::load(const std::string& p_path) {
+    from_cache = false;
+    std::string text;
+    Error err = _read_text(p_path, text);
+    if (err != OK) {
+        return err;
+    }
+    return parse(text);
+}
+
+Error ConfigFile::save(const std::string& p_path) const {
+    std::string text;
+    // The unnamed section has no header, so it has to come first.
+    auto unnamed = section_index.find(std::string());
+    for (size_t pass = 0; pass < 2; pass++) {
+        for (uint32_t i = 0; i < sections.size(); i++) {
+            const bool is_unnamed = unnamed != section_index.end() && unnamed->second == i;
+            if (is_unnamed != (pass == 0)) {
+                continue;
+            }
+            const Section& section = sections[i];
+            if (!is_unnamed) {
+                if (!text.empty()) {
+                    text += '\n';
+                }
+                text += '[';
+                text += section.name;
+                text += "]\n\n";
+            }
+            for (const Value& value : section.values) {
+                text += value.key;
+                text += '=';
+                if (value.verbatim) {
+                    text += *value.value.get_string_ptr();
+                } else {
+                    _append_value(text, value.value);
+                }
+                text += '\n';
+            }
+        }
+    }
+
+    FileAccess file;
+    if (!file.open(p_path, FileAccess::WRITE)) {
+        return ERR_FILE_CANT_OPEN;
+    }
+    return file.store_buffer(text.data(), text.size()) ? OK : ERR_FILE_CANT_WRITE;
+}
+
+std::string ConfigFile::get_cache_path(const std::string& p_path) {
+    size_t slash = p_path.find_last_of("/\\");
+    size_t name = slash == std::string::npos ? 0 : slash + 1;
+    return p_path.substr(0, name) + "." + p_path.substr(name) + ".cache";
+}
+
+uint64_t ConfigFile::hash_content(const char* p_data, size_t p_size) {
+    // Eight bytes per step, as in ScriptCache::hash_source().
+    uint64_t h = _mix((uint64_t(CACHE_VERSION) << 48) ^ p_size);
+    size_t i = 0;
+    for (; i + 8 <= p_size; i += 8) {
+        uint64_t word;
+        memcpy(&word, p_data + i, 8);
+        h = (h ^ _mix(word)) * 0x9E3779B97F4A7C15ull;
+    }
+    uint64_t tail = 0;
+    if (i < p_size) {
+        memcpy(&tail, p_data + i, p_size - i);
+    }
+    h = (h ^ _mix(tail ^ (p_size - i))) * 0x9E3779B97F4A7C15ull;
+    return _mix(h);
+}
+
+Error ConfigFile::load_cached(const std::string& p_path) {
+    from_cache = false;
+    // Stat before reading, so an edit made while loading is seen next time.
+    std::error_code ec;
+    const uint64_t size = std::filesystem::file_size(p_path, ec);
+    if (ec) {
+        return ERR_FILE_NOT_FOUND;
+    }
+    const int64_t mtime = static_cast<int64_t>(std::filesystem::last_write_time(p_path, ec).time_since_epoch().count());
+    if (ec) {
+        return ERR_FILE_CANT_OPEN;
+    }
+
+    const std::string cache_path = get_cache_path(p_path);
+    std::string text;
+    bool have_text = false;
+    uint64_t hash = 0;
+
+    FileAccess cache;
+    if (cache.open(cache_path, FileAccess::READ_MMAP)) {
+        Span<const uint8_t> data = cache.get_mapped_data();
+        CacheHeader header;
+        if (data.size() >= CACHE_HEADER_SIZE) {
+            memcpy(&header, data.data(), CACHE_HEADER_SIZE);
+        }
+        if (data.size() >= CACHE_HEADER_SIZE && header.magic == CACHE_MAGIC && header.version == CACHE_VERSION && header.source_size == size && header.payload_size <= data.size() - CACHE_HEADER_SIZE) {
+            bool valid = header.source_mtime == mtime;
+            if (!valid && _read_text(p_path, text) == OK) {
+                have_text = true;
+                hash = hash_content(text.data(), text.size());
+                valid = hash == header.content_hash;
+            }
+            if (valid && _decode_cache(data.data() + CACHE_HEADER_SIZE, header.payload_size) == OK) {
+                from_cache = true;
+                cache.close();
+                if (header.source_mtime != mtime) {
+                    _save_cache(cache_path, size, mtime, header.content_hash);
+                }
+                return OK;
+            }
+        }
+        cache.close();
+    }
+
+    if (!have_text) {
+        Error err = _read_text(p_path, text);
+        if (err != OK) {
+            return err;
+        }
+        hash = hash_content(text.data(), text.size());
+    }
+    Error err = parse(text);
+    if (err != OK) {
+        return err;
+    }
+    // Best effort: a read-only project still loads, just without the cache.
+    _save_cache(cache_path, size, mtime, hash);
+    return OK;
+}
+
+Error ConfigFile::_decode_cache(const uint8_t* p_data, size_t p_size) {
+    clear();
+    VariantDecoder decoder;
+    Error err = decoder.open(p_data, p_size);
+    uint32_t section_count = 0;
+    if (err == OK) {
+        err = decoder.read_dictionary_begin(section_count);
+    }
+    for (uint32_t i = 0; err == OK && i < section_count; i++) {
+        std::string_view name;
+        uint32_t value_count = 0;
+        err = decoder.read_key(name);
+        if (err == OK) {
+            err = decoder.read_dictionary_begin(value_count);
+        }
+        if (err != OK || section_index.count(std::string(name))) {
+            break;
+        }
+        Section& section = _get_section(std::string(name));
+        section.values.reserve(value_count);
+        section.keys.reserve(value_count);
+        for (uint32_t j = 0; err == OK && j < value_count; j++) {
+            std::string_view key;
+            Variant value;
+            err = decoder.read_key(key);
+            if (err != OK) {
+                break;
+            }
+            // Verbatim text is wrapped in a one-element array.
+            if (decoder.get_next_tag() == VariantBinary::TAG_ARRAY) {
+                uint32_t count = 0;
+                std::string_view text;
+                err = decoder.read_array_begin(count);
+                if (err == OK && count != 1) {
+                    err = ERR_FILE_CORRUPT;
+                }
+                if (err == OK) {
+                    err = decoder.read_string(text);
+                }
+                if (err == OK) {
+                    _set(section, key, Variant(std::string(text)), true);
+                }
+            } else {
+                err = decoder.read(value);
+                if (err == OK) {
+                    _set(section, key, std::move(value), false);
+                }
+            }
+        }
+    }
+    if (err != OK || section_index.size() != section_count) {
+        clear();
+        return err != OK ? err : ERR_FILE_CORRUPT;
+    }
+    return OK;
+}
+
+Error ConfigFile::_save_cache(const std::string& p_cache_path, uint64_t p_size, int64_t p_mtime, uint64_t p_hash) const {
+    VariantEncoder encoder;
+    encoder.put_dictionary_begin(static_cast<uint32_t>(sections.size()));
+    for (const Section& section : sections) {
+        encoder.put_key(section.name);
+        encoder.put_dictionary_begin(static_cast<uint32_t>(section.values.size()));
+        for (const Value& value : section.values) {
+            encoder.put_key(value.key);
+            if (value.verbatim) {
+                encoder.put_array_begin(1);
+                encoder.put_string(*value.value.get_string_ptr());
+            } else if (encoder.put(value.value) != OK) {
+                return ERR_INVALID_DATA;
+            }
+        }
+    }
+    std::vector<uint8_t> payload;
+    encoder.finish(payload);
+
+    CacheHeader header = {};
+    header.magic = CACHE_MAGIC;
+    header.version = CACHE_VERSION;
+    header.source_size = p_size;
+    header.source_mtime = p_mtime;
+    header.content_hash = p_hash;
+    header.payload_size = static_cast<uint32_t>(payload.size());
+
+    // Renamed into place, so a concurrent reader never maps half a cache.
+    std::string temp_path = p_cache_path + ".tmp";
+    FileAccess file;
+    if (!file.open(temp_path, FileAccess::WRITE)) {
+        return ERR_FILE_CANT_OPEN;
+    }
+    bool ok = file.store_buffer(reinterpret_cast<const char*>(&header), sizeof(header));
+    ok = ok && file.store_buffer(reinterpret_cast<const char*>(payload.data()), payload.size());
+    file.close();
+    std::error_code ec;
+    if (ok) {
+        std::filesystem::rename(temp_path, p_cache_path, ec);
+    }
+    if (!ok || ec) {
+        std::filesystem::remove(temp_path, ec);
+        return ERR_FILE_CANT_WRITE;
+    }
+    return OK;
+}
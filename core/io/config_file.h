@@ -20,34 +20,119 @@
  * 
  * 
  */
-
-
 #ifndef CONFIG_FILE_H
 #define CONFIG_FILE_H
 
-#i
-#include <filesystem>
-#include <cassert>
-#include <cstring>
-
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
+#include "core/error/error_list.h"
+#include "core/object/m_object.h"
+#include "core/object/ref_counted.h"
+#include "core/variant/variant.h"
+
+/**
+ * @class ConfigFile
+ * @brief Sections of typed key/value pairs, read from INI or .cfg text.
+ *
+ *     ; comment
+ *     [display]
+ *     width = 1280
+ *     scale = 1.5
+ *     size = Vector2i(1280, 720)
+ *     title = "My Game"
+ *     driver = opengl3
+ *
+ * Values are parsed with VariantParser, so numbers, booleans, strings and
+ * the math constructors come out typed. Anything else (a bare word, an
+ * array or dictionary, another constructor) is kept as its source text
+ * and written back unchanged by save(). Sections and keys are hashed, so
+ * get_value() is O(1); iteration keeps file order.
+ *
+ * load_cached() keeps a binary copy of the parsed file next to the source.
+ * While the source size and mtime match, the cache is mapped and decoded
+ * without reading the source. If only the mtime differs (a checkout, a
+ * copy), the source is hashed and the cache is still used when the content
+ * matches. Anything else, including a damaged cache, parses the source and
+ * rewrites the cache.
+ */
+class ConfigFile : public RefCounted {
+    CLASS(ConfigFile, RefCounted);
+
+public:
+    static const uint32_t CACHE_MAGIC = 0x46435350; // "PSCF"
+    static const uint32_t CACHE_VERSION = 1;
+    static const size_t CACHE_HEADER_SIZE = 40;
+
+    ConfigFile();
+    virtual ~ConfigFile();
+
+    void set_value(const std::string& p_section, const std::string& p_key, const Variant& p_value);
+    Variant get_value(const std::string& p_section, const std::string& p_key, const Variant& p_default = Variant()) const;
+    /** @brief The stored value without a copy, or nullptr. Invalidated by any change. */
+    const Variant* get_value_ptr(const std::string& p_section, const std::string& p_key) const;
+
+    bool has_section(const std::string& p_section) const;
+    bool has_section_key(const std::string& p_section, const std::string& p_key) const;
+    std::vector<std::string> get_sections() const;
+    std::vector<std::string> get_section_keys(const std::string& p_section) const;
+
+    void erase_section(const std::string& p_section);
+    void erase_section_key(const std::string& p_section, const std::string& p_key);
+    void clear();
+
+    /**
+     * Replace the contents with p_text. Keys before the first section go to
+     * the "" section.
+     * @return OK, or ERR_PARSE_ERROR (see get_error_line()).
+     */
+    Error parse(std::string_view p_text);
+    Error load(const std::string& p_path);
+    Error save(const std::string& p_path) const;
+
+    /** @brief load() through the binary cache at get_cache_path(p_path). */
+    Error load_cached(const std::string& p_path);
+    /** @brief "dir/.name.cache" for "dir/name"; hidden, so indexers skip it. */
+    static std::string get_cache_path(const std::string& p_path);
+    /** @brief True if the last load_cached() was served from the cache. */
+    bool is_from_cache() const { return from_cache; }
+
+    int get_error_line() const { return error_line; }
+    const std::string& get_error_text() const { return error_text; }
+
+    static uint64_t hash_content(const char* p_data, size_t p_size);
+
+private:
+    struct Value {
+        std::string key;
+        Variant value;
+        bool verbatim = false; ///< Source text of a value that is not a Variant.
+    };
+
+    struct Section {
+        std::string name;
+        std::vector<Value> values;
+        std::unordered_map<std::string, uint32_t> keys;
+    };
+
+    std::vector<Section> sections;
+    std::unordered_map<std::string, uint32_t> section_index;
+
+    int error_line = 0;
+    std::string error_text;
+    bool from_cache = false;
 
+    Section& _get_section(const std::string& p_section);
+    const Value* _find(const std::string& p_section, const std::string& p_key) const;
+    void _set(Section& r_section, std::string_view p_key, Variant&& p_value, bool p_verbatim);
+    Error _error(int p_line, const char* p_message);
 
-class ConfigFile: public RefCounted
-	CLASS(ConfigFile , RefCounted);
-{
-	public:
-		ConfigFile();
-		virtual ~ConfigFile();
-	
-	private:
-		Ref<ConfigFile> config;
-		std::filesystem file;
-		
-		
+    Error _decode_cache(const uint8_t* p_data, size_t p_size);
+    Error _save_cache(const std::string& p_cache_path, uint64_t p_size, int64_t p_mtime, uint64_t p_hash) const;
 };
 
-#endif /* CONFIG_FILE_H */ 
+#endif // CONFIG_FILE_H
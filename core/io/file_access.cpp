@@ -1,83 +1,494 @@
 #include "file_access.h"
 
 
-#include <iostream> // Include for simplicity, replace with proper implementation for compressed/encrypted files
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <sstream>
 #include <iterator>
 #include <chrono>
 
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <fcntl.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <sys/utime.h>
+#define FA_OPEN_FLAGS _O_BINARY
+#define FA_STAT _stat64
+#define FA_FSTAT _fstat64
+#define FA_UTIMBUF _utimbuf
+#define FA_UTIME _utime
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#include <utime.h>
+#define FA_OPEN_FLAGS O_CLOEXEC
+#define FA_STAT stat
+#define FA_FSTAT fstat
+#define FA_UTIMBUF utimbuf
+#define FA_UTIME utime
+#endif
+
+
+static int64_t _pread_full(int fd, uint8_t* dst, size_t length, uint64_t offset) {
+    size_t done = 0;
+#ifdef _WIN32
+    if (_lseeki64(fd, offset, SEEK_SET) < 0) {
+        return -1;
+    }
+#endif
+    while (done < length) {
+#ifdef _WIN32
+        int got = _read(fd, dst + done, static_cast<unsigned int>(std::min<size_t>(length - done, 1u << 30)));
+#else
+        ssize_t got = ::pread(fd, dst + done, length - done, static_cast<off_t>(offset + done));
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+#endif
+        if (got < 0) {
+            return done ? static_cast<int64_t>(done) : -1;
+        }
+        if (got == 0) {
+            break;
+        }
+        done += static_cast<size_t>(got);
+    }
+    return static_cast<int64_t>(done);
+}
+
+static bool _pwrite_full(int fd, const uint8_t* src, size_t length, uint64_t offset) {
+    size_t done = 0;
+#ifdef _WIN32
+    if (_lseeki64(fd, offset, SEEK_SET) < 0) {
+        return false;
+    }
+#endif
+    while (done < length) {
+#ifdef _WIN32
+        int put = _write(fd, src + done, static_cast<unsigned int>(std::min<size_t>(length - done, 1u << 30)));
+#else
+        ssize_t put = ::pwrite(fd, src + done, length - done, static_cast<off_t>(offset + done));
+        if (put < 0 && errno == EINTR) {
+            continue;
+        }
+#endif
+        if (put <= 0) {
+            return false;
+        }
+        done += static_cast<size_t>(put);
+    }
+    return true;
+}
 
 
 FileAccess::FileAccess() {}
 
 FileAccess::~FileAccess() {
-    if (file.is_open()) {
-        file.close();
-    }
+    close();
 }
 
 
-bool FileAccess::open(const std::string& path, ModeFlags mode) {
-    std::ios_base::openmode fileMode = std::ios::out | std::ios::in;
+bool FileAccess::open(const std::string& path, ModeFlags p_mode) {
+    close();
 
-    switch (mode) {
+    int flags = FA_OPEN_FLAGS;
+    switch (p_mode) {
         case READ:
-            fileMode |= std::ios::in;
+        case READ_MMAP:
+            flags |= O_RDONLY;
             break;
         case WRITE:
-            fileMode |= std::ios::out;
+            flags |= O_WRONLY | O_CREAT | O_TRUNC;
             break;
-        case APPEND:
-            fileMode |= std::ios::app;
+        case WRITE_READ:
+            flags |= O_RDWR | O_CREAT | O_TRUNC;
             break;
         case READ_WRITE:
-            fileMode |= std::ios::in | std::ios::out;
+            flags |= O_RDWR;
             break;
-        case WRITE_READ:
-            fileMode |= std::ios::out | std::ios::in;
+        case APPEND:
+            flags |= O_WRONLY | O_CREAT | O_APPEND;
             break;
     }
 
     filename = path;
-    file.open(filename, fileMode);
-
-    if (!file.is_open()) {
+#ifdef _WIN32
+    fd = _open(filename.c_str(), flags, _S_IREAD | _S_IWRITE);
+#else
+    fd = ::open(filename.c_str(), flags, 0644);
+#endif
+    if (fd < 0) {
         lastError = "Error opening file: " + filename;
         return false;
     }
 
-    mode = mode;  // Update the mode member variable
+    mode = p_mode;
+    opened = true;
+    eof = false;
+    buffer_state = BUFFER_EMPTY;
+    buffer_offset = 0;
+    buffer_pos = 0;
+    buffer_len = 0;
+
+    if (mode == READ_MMAP) {
+        struct FA_STAT st;
+        if (FA_FSTAT(fd, &st) != 0) {
+            lastError = "Error reading file size: " + filename;
+            close();
+            return false;
+        }
+        map_size = static_cast<uint64_t>(st.st_size);
+        map_pos = 0;
+        if (map_size > 0) {
+#ifdef _WIN32
+            // No mapping here: read the file once into memory instead.
+            uint8_t* data = new uint8_t[map_size];
+            if (_pread_full(fd, data, map_size, 0) != static_cast<int64_t>(map_size)) {
+                delete[] data;
+                lastError = "Error reading file: " + filename;
+                close();
+                return false;
+            }
+            map_data = data;
+#else
+            void* data = mmap(nullptr, map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED) {
+                lastError = "Error mapping file: " + filename;
+                close();
+                return false;
+            }
+            map_data = static_cast<const uint8_t*>(data);
+#endif
+        }
+        // The mapping keeps the file alive.
+#ifdef _WIN32
+        _close(fd);
+#else
+        ::close(fd);
+#endif
+        fd = -1;
+        return true;
+    }
 
+    if (!buffer) {
+        buffer.reset(new uint8_t[buffer_capacity]);
+    }
+    if (mode == APPEND) {
+        buffer_offset = get_length();
+    }
     return true;
-
-
 }
 
 
 bool FileAccess::is_open() const {
-    return file.is_open();
+    return opened;
 
 }
 
+void FileAccess::set_buffer_size(size_t size) {
+    if (is_open() || size == 0) {
+        return;
+    }
+    buffer_capacity = size;
+    buffer.reset();
+}
+
 
 bool FileAccess::file_exists(const std::string& path) const {
     return std::filesystem::exists(path);
 
 }
 
-bool FileAccess::write(const std::string& data) const {
-    if (file.is_open()) {
-        file << data;
+bool FileAccess::_flush_write() {
+    if (buffer_state != BUFFER_WRITE) {
+        return true;
+    }
+    bool ok = buffer_pos == 0 || _pwrite_full(fd, buffer.get(), buffer_pos, buffer_offset);
+    buffer_offset += buffer_pos;
+    buffer_pos = 0;
+    buffer_state = BUFFER_EMPTY;
+    if (!ok) {
+        lastError = "Error writing to file: " + filename;
+    }
+    return ok;
+}
+
+bool FileAccess::_fill(size_t p_min) {
+    if (buffer_state == BUFFER_READ && buffer_len - buffer_pos >= p_min) {
         return true;
     }
+    if (buffer_state == BUFFER_WRITE) {
+        _flush_write();
+    }
+    if (buffer_state == BUFFER_EMPTY) {
+        buffer_len = 0;
+    }
+    // Keep the unread tail, refill behind it.
+    size_t remain = buffer_len - buffer_pos;
+    if (remain && buffer_pos) {
+        memmove(buffer.get(), buffer.get() + buffer_pos, remain);
+    }
+    buffer_offset += buffer_pos;
+    buffer_pos = 0;
+    buffer_len = remain;
+    buffer_state = BUFFER_READ;
+
+    int64_t got = _pread_full(fd, buffer.get() + buffer_len, buffer_capacity - buffer_len, buffer_offset + buffer_len);
+    if (got > 0) {
+        buffer_len += static_cast<size_t>(got);
+    }
+    return buffer_len >= p_min;
+}
+
+size_t FileAccess::get_buffer(uint8_t* data, size_t length) {
+    if (mode == READ_MMAP) {
+        size_t count = map_pos < map_size ? static_cast<size_t>(std::min<uint64_t>(length, map_size - map_pos)) : 0;
+        if (count) {
+            memcpy(data, map_data + map_pos, count);
+        }
+        map_pos += count;
+        eof = count < length;
+        return count;
+    }
+    if (fd < 0) {
+        return 0;
+    }
+
+    size_t done = 0;
+    if (buffer_state == BUFFER_READ) {
+        done = std::min(length, buffer_len - buffer_pos);
+        memcpy(data, buffer.get() + buffer_pos, done);
+        buffer_pos += done;
+    }
+    if (length - done >= buffer_capacity) {
+        // Large reads skip the buffer and go straight to the destination.
+        _flush_write();
+        const uint64_t position = get_position();
+        int64_t got = _pread_full(fd, data + done, length - done, position);
+        if (got > 0) {
+            done += static_cast<size_t>(got);
+        }
+        buffer_state = BUFFER_EMPTY;
+        buffer_offset = position + (got > 0 ? got : 0);
+        buffer_pos = 0;
+        buffer_len = 0;
+    } else if (done < length) {
+        _fill(length - done);
+        size_t count = std::min(length - done, buffer_len - buffer_pos);
+        memcpy(data + done, buffer.get() + buffer_pos, count);
+        buffer_pos += count;
+        done += count;
+    }
+    eof = done < length;
+    return done;
+}
 
-    lastError = "Error writing to file: " + filename;
+bool FileAccess::_get_bytes(void* p_dst, size_t p_size) {
+    if (get_buffer(static_cast<uint8_t*>(p_dst), p_size) == p_size) {
+        return true;
+    }
+    memset(p_dst, 0, p_size);
     return false;
 }
 
+Span<const uint8_t> FileAccess::get_span(size_t length) {
+    if (mode == READ_MMAP) {
+        size_t count = map_pos < map_size ? static_cast<size_t>(std::min<uint64_t>(length, map_size - map_pos)) : 0;
+        Span<const uint8_t> span(map_data + map_pos, count);
+        map_pos += count;
+        eof = count < length;
+        return span;
+    }
+    if (fd < 0 || length > buffer_capacity) {
+        return Span<const uint8_t>();
+    }
+    _fill(length);
+    size_t count = std::min(length, buffer_len - buffer_pos);
+    Span<const uint8_t> span(buffer.get() + buffer_pos, count);
+    buffer_pos += count;
+    eof = count < length;
+    return span;
+}
+
+const uint8_t* FileAccess::_get_view(size_t p_size, uint8_t* p_scratch) {
+    // The typed getters read in place when the bytes are already there.
+    if (buffer_state == BUFFER_READ && buffer_len - buffer_pos >= p_size) {
+        const uint8_t* src = buffer.get() + buffer_pos;
+        buffer_pos += p_size;
+        return src;
+    }
+    if (mode == READ_MMAP && map_pos + p_size <= map_size) {
+        const uint8_t* src = map_data + map_pos;
+        map_pos += p_size;
+        return src;
+    }
+    _get_bytes(p_scratch, p_size);
+    return p_scratch;
+}
+
+uint8_t FileAccess::get_8() {
+    uint8_t b[1];
+    return *_get_view(1, b);
+}
+
+uint16_t FileAccess::get_16() {
+    uint8_t b[2];
+    const uint8_t* p = _get_view(2, b);
+    return uint16_t(p[0] | (p[1] << 8));
+}
+
+uint32_t FileAccess::get_32() {
+    uint8_t b[4];
+    const uint8_t* p = _get_view(4, b);
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+uint64_t FileAccess::get_64() {
+    uint8_t b[8];
+    const uint8_t* p = _get_view(8, b);
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+float FileAccess::get_float() {
+    uint32_t bits = get_32();
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+double FileAccess::get_double() {
+    uint64_t bits = get_64();
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+bool FileAccess::seek(uint64_t position) {
+    eof = false;
+    if (mode == READ_MMAP) {
+        map_pos = position;
+        return true;
+    }
+    if (fd < 0) {
+        return false;
+    }
+    if (buffer_state == BUFFER_READ && position >= buffer_offset && position <= buffer_offset + buffer_len) {
+        // Still inside the buffered range: no system call.
+        buffer_pos = static_cast<size_t>(position - buffer_offset);
+        return true;
+    }
+    bool ok = _flush_write();
+    buffer_state = BUFFER_EMPTY;
+    buffer_offset = position;
+    buffer_pos = 0;
+    buffer_len = 0;
+    return ok;
+}
+
+bool FileAccess::seek_end(int64_t position) {
+    return seek(static_cast<uint64_t>(static_cast<int64_t>(get_length()) + position));
+}
+
+uint64_t FileAccess::get_position() const {
+    if (mode == READ_MMAP) {
+        return map_pos;
+    }
+    return buffer_offset + buffer_pos;
+}
+
+uint64_t FileAccess::get_length() const {
+    if (mode == READ_MMAP) {
+        return map_size;
+    }
+    if (fd < 0) {
+        return 0;
+    }
+    struct FA_STAT st;
+    uint64_t length = FA_FSTAT(fd, &st) == 0 ? static_cast<uint64_t>(st.st_size) : 0;
+    if (buffer_state == BUFFER_WRITE) {
+        length = std::max<uint64_t>(length, buffer_offset + buffer_pos);
+    }
+    return length;
+}
+
+bool FileAccess::_write_bytes(const void* p_data, size_t p_size) {
+    if (fd < 0 || mode == READ || mode == READ_MMAP) {
+        lastError = "Error writing to file: " + filename;
+        return false;
+    }
+    if (p_size == 0) {
+        return true;
+    }
+    if (buffer_state == BUFFER_READ) {
+        // Drop read-ahead; the logical position stays where it is.
+        buffer_offset += buffer_pos;
+        buffer_pos = 0;
+        buffer_len = 0;
+        buffer_state = BUFFER_EMPTY;
+    }
+    buffer_state = BUFFER_WRITE;
+    if (p_size > buffer_capacity - buffer_pos) {
+        if (!_flush_write()) {
+            return false;
+        }
+        buffer_state = BUFFER_WRITE;
+        if (p_size >= buffer_capacity) {
+            if (!_pwrite_full(fd, static_cast<const uint8_t*>(p_data), p_size, buffer_offset)) {
+                lastError = "Error writing to file: " + filename;
+                return false;
+            }
+            buffer_offset += p_size;
+            return true;
+        }
+    }
+    memcpy(buffer.get() + buffer_pos, p_data, p_size);
+    buffer_pos += p_size;
+    return true;
+}
+
+bool FileAccess::store_8(uint8_t value) {
+    return _write_bytes(&value, 1);
+}
+
+bool FileAccess::store_16(uint16_t value) {
+    uint8_t b[2] = { uint8_t(value), uint8_t(value >> 8) };
+    return _write_bytes(b, 2);
+}
+
+bool FileAccess::store_32(uint32_t value) {
+    uint8_t b[4] = { uint8_t(value), uint8_t(value >> 8), uint8_t(value >> 16), uint8_t(value >> 24) };
+    return _write_bytes(b, 4);
+}
+
+bool FileAccess::store_64(uint64_t value) {
+    return store_32(static_cast<uint32_t>(value)) && store_32(static_cast<uint32_t>(value >> 32));
+}
+
+bool FileAccess::store_double(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return store_64(bits);
+}
+
+bool FileAccess::write(const std::string& data) {
+    return _write_bytes(data.data(), data.size());
+}
+
+bool FileAccess::write_line_to_file(const std::string& line) {
+    return write(line) && store_8('\n');
+}
+
 bool FileAccess::store_float(float value) {
-    if (file.is_open()) {
-        file.write(reinterpret_cast<const char*>(&value), sizeof(float));
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    if (store_32(bits)) {
         return true;
     }
 
@@ -86,10 +497,8 @@ bool FileAccess::store_float(float value) {
 }
 
 bool FileAccess::store_pascal_string(const std::string& pascalString) {
-    if (file.is_open()) {
-        size_t length = pascalString.length();
-        file.write(reinterpret_cast<const char*>(&length), sizeof(size_t));
-        file << pascalString;
+    // 64-bit length, as the earlier size_t prefix was on 64-bit builds.
+    if (store_64(pascalString.length()) && write(pascalString)) {
         return true;
     }
 
@@ -98,8 +507,7 @@ bool FileAccess::store_pascal_string(const std::string& pascalString) {
 }
 
 bool FileAccess::store_buffer(const char* buffer, size_t size) {
-    if (file.is_open()) {
-        file.write(buffer, size);
+    if (_write_bytes(buffer, size)) {
         return true;
     }
 
@@ -108,8 +516,7 @@ bool FileAccess::store_buffer(const char* buffer, size_t size) {
 }
 
 bool FileAccess::store_var(const void* variable, size_t size) {
-    if (file.is_open()) {
-        file.write(reinterpret_cast<const char*>(variable), size);
+    if (_write_bytes(variable, size)) {
         return true;
     }
 
@@ -117,10 +524,8 @@ bool FileAccess::store_var(const void* variable, size_t size) {
     return false;
 }
 
-bool FileAccess::write_16_To_file(uint16_t value) {
-    if (file.is_open()) {
-        // Add logic to write a 16-bit integer to the file
-        file.write(reinterpret_cast<const char*>(&value), sizeof(uint16_t));
+bool FileAccess::write_16_to_file(uint16_t value) {
+    if (store_16(value)) {
         return true;
     }
 
@@ -129,14 +534,13 @@ bool FileAccess::write_16_To_file(uint16_t value) {
 }
 
 bool FileAccess::read(std::string& data) {
-    if (file.is_open()) {
-        file.seekg(0, std::ios::beg);
-
-        char ch;
-        while (file.get(ch)) {
-            data += ch;
-        }
-
+    if (is_open()) {
+        // One bulk read of the whole file instead of a call per character.
+        const size_t length = static_cast<size_t>(get_length());
+        const size_t start = data.size();
+        seek(0);
+        data.resize(start + length);
+        data.resize(start + get_buffer(reinterpret_cast<uint8_t*>(&data[start]), length));
         return true;
     }
 
@@ -145,18 +549,48 @@ bool FileAccess::read(std::string& data) {
 }
 
 bool FileAccess::get_line_from_file(std::string& line) {
-    if (file.is_open()) {
-        std::getline(file, line);
-        return true;
+    if (!is_open()) {
+        lastError = "Error getting line from file: " + filename;
+        return false;
     }
 
-    lastError = "Error getting line from file: " + filename;
-    return false;
+    line.clear();
+    bool found = false;
+    if (mode == READ_MMAP) {
+        const size_t count = map_pos < map_size ? static_cast<size_t>(map_size - map_pos) : 0;
+        const uint8_t* start = map_data + map_pos;
+        const uint8_t* newline = count ? static_cast<const uint8_t*>(memchr(start, '\n', count)) : nullptr;
+        const size_t length = newline ? static_cast<size_t>(newline - start) : count;
+        line.assign(reinterpret_cast<const char*>(start), length);
+        map_pos += length + (newline ? 1 : 0);
+        found = newline || length;
+        eof = !newline;
+    } else {
+        // Scan the buffer a chunk at a time.
+        eof = true;
+        while (_fill(1)) {
+            const uint8_t* start = buffer.get() + buffer_pos;
+            const size_t count = buffer_len - buffer_pos;
+            const uint8_t* newline = static_cast<const uint8_t*>(memchr(start, '\n', count));
+            const size_t length = newline ? static_cast<size_t>(newline - start) : count;
+            line.append(reinterpret_cast<const char*>(start), length);
+            buffer_pos += length;
+            found = true;
+            if (newline) {
+                buffer_pos++;
+                eof = false;
+                break;
+            }
+        }
+    }
+    if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+    }
+    return found;
 }
 
 bool FileAccess::store_string(const std::string& data) {
-    if (file.is_open()) {
-        file << data << std::endl;
+    if (write(data) && store_8('\n')) {
         return true;
     }
 
@@ -165,28 +599,14 @@ bool FileAccess::store_string(const std::string& data) {
 }
 
 bool FileAccess::get_var_from_file(void* variable, size_t size) {
-    if (file.is_open()) {
-        // Add logic to read a variable from the file
-        file.read(reinterpret_cast<char*>(variable), size);
-        return true;
+    if (is_open()) {
+        return _get_bytes(variable, size);
     }
 
     lastError = "Error getting variable from file: " + filename;
     return false;
 }
 
-uint16_t FileAccess::get16() {
-    uint16_t value = 0;
-
-    if (file.is_open()) {
-        file.read(reinterpret_cast<char*>(&value), sizeof(uint16_t));
-    } else {
-        lastError = "Error getting 16-bit integer from file: " + filename;
-    }
-
-    return value;
-}
-
 std::string FileAccess::get_file_path() const {
     return filename;
 }
@@ -196,42 +616,60 @@ std::string FileAccess::get_open_error() const {
 }
 
 void FileAccess::close() {
-    if (file.is_open()) {
-        file.close();
+    if (fd >= 0) {
+        _flush_write();
+#ifdef _WIN32
+        _close(fd);
+#else
+        ::close(fd);
+#endif
+        fd = -1;
+    }
+    if (map_data) {
+#ifdef _WIN32
+        delete[] map_data;
+#else
+        munmap(const_cast<uint8_t*>(map_data), map_size);
+#endif
+        map_data = nullptr;
     }
+    map_size = 0;
+    map_pos = 0;
+    buffer_state = BUFFER_EMPTY;
+    buffer_offset = 0;
+    buffer_pos = 0;
+    buffer_len = 0;
+    opened = false;
 }
 
 void FileAccess::flush() {
-    if (file.is_open()) {
-        file.flush();
+    if (fd >= 0) {
+        _flush_write();
     }
 }
 
 bool FileAccess::get8(uint8_t& value) {
-    if (file.is_open()) {
-        file.read(reinterpret_cast<char*>(&value), sizeof(uint8_t));
-        return true;
+    if (is_open()) {
+        value = get_8();
+        return !eof;
     }
 
     lastError = "Error getting 8-bit integer from file: " + filename;
     return false;
 }
 
-std::vector<uint8_t> FileAccess::get_file_as_bytes() const {
+std::vector<uint8_t> FileAccess::get_file_as_bytes() {
     std::vector<uint8_t> bytes;
 
-    if (file.is_open()) {
-        file.seekg(0, std::ios::end);
-        std::streamsize fileSize = file.tellg();
-        file.seekg(0, std::ios::beg);
-
-        bytes.resize(static_cast<size_t>(fileSize));
-
-        if (file.read(reinterpret_cast<char*>(bytes.data()), fileSize))
+    if (is_open()) {
+        bytes.resize(static_cast<size_t>(get_length()));
+        seek(0);
+        if (get_buffer(bytes.data(), bytes.size()) == bytes.size())
             return bytes;
     }
 
     lastError = "Error getting file as bytes: " + filename;
+    bytes.clear();
     return bytes;  // Return an empty vector if there was an error
 }
 
@@ -243,7 +681,7 @@ std::vector<std::string> FileAccess::get_csv_Line(char delimiter) {
     std::vector<std::string> fields;
     std::string line;
 
-    if (file.is_open() && std::getline(file, line)) {
+    if (get_line_from_file(line)) {
         std::istringstream stream(line);
         std::string field;
 
@@ -258,8 +696,8 @@ std::vector<std::string> FileAccess::get_csv_Line(char delimiter) {
 uint16_t FileAccess::get16() {
     uint16_t value = 0;
 
-    if (file.is_open()) {
-        file.read(reinterpret_cast<char*>(&value), sizeof(uint16_t));
+    if (is_open()) {
+        value = get_16();
     } else {
         lastError = "Error getting 16-bit integer from file: " + filename;
     }
@@ -270,42 +708,28 @@ uint16_t FileAccess::get16() {
 std::string FileAccess::get_as_text() {
     std::string content;
 
-    if (file.is_open()) {
-        file.seekg(0, std::ios::end);
-        std::streamsize fileSize = file.tellg();
-        file.seekg(0, std::ios::beg);
-
-        content.resize(static_cast<size_t>(fileSize));
-        
-        if (file.read(&content[0], fileSize))
+    if (is_open()) {
+        content.resize(static_cast<size_t>(get_length()));
+        seek(0);
+        if (get_buffer(reinterpret_cast<uint8_t*>(&content[0]), content.size()) == content.size())
             return content;
     }
 
     lastError = "Error getting file content as text: " + filename;
+    content.clear();
     return content;  // Return an empty string if there was an error
 }
 
 
 
-std::chrono::system_clock::time_point FileAccess::get_modified_time() const {
+std::chrono::system_clock::time_point FileAccess::get_modified_time() {
   std::chrono::system_clock::time_point timePoint;
 
-    if (file.is_open()) {
-#ifdef _WIN32
-        // Windows-specific code to get file modification time
-        FILETIME ftCreate, ftAccess, ftWrite;
-        GetFileTime(file.native_handle(), &ftCreate, &ftAccess, &ftWrite);
-        ULARGE_INTEGER ull;
-        ull.LowPart = ftWrite.dwLowDateTime;
-        ull.HighPart = ftWrite.dwHighDateTime;
-        timePoint = std::chrono::system_clock::from_time_t(ull.QuadPart / 10000000ULL - 11644473600ULL);
-#else
-        // Unix-like system code to get file modification time
-        struct stat result;
-        if (stat(filename.c_str(), &result) == 0) {
+    if (is_open()) {
+        struct FA_STAT result;
+        if (FA_STAT(filename.c_str(), &result) == 0) {
             timePoint = std::chrono::system_clock::from_time_t(result.st_mtime);
         }
-#endif
     } else {
         lastError = "Error getting file modified time: " + filename;
     }
@@ -314,30 +738,36 @@ std::chrono::system_clock::time_point FileAccess::get_modified_time() const {
 }
 
 bool FileAccess::set_modified_time(const std::chrono::system_clock::time_point& newTime) {
-    if (file.is_open()) {
-#ifdef _WIN32
-        // Windows-specific code to set file modification time
-        FILETIME ft;
-        ULARGE_INTEGER ull;
-        ull.QuadPart = std::chrono::duration_cast<std::chrono::seconds>(newTime.time_since_epoch()).count() * 10000000ULL + 11644473600ULL * 10000000ULL;
-        ft.dwLowDateTime = ull.LowPart;
-        ft.dwHighDateTime = ull.HighPart;
-        SetFileTime(file.native_handle(), nullptr, nullptr, &ft);
-        return true;
-#else
-        // Unix-like system code to set file modification time
-        struct stat st;
-        struct utimbuf new_times;
+    if (is_open()) {
+        // Pending writes would bump the time again when flushed.
+        flush();
+        struct FA_STAT st;
+        struct FA_UTIMBUF new_times;
 
-        if (stat(filename.c_str(), &st) == 0) {
+        if (FA_STAT(filename.c_str(), &st) == 0) {
             new_times.actime = st.st_atime;
             new_times.modtime = std::chrono::system_clock::to_time_t(newTime);
-            return utime(filename.c_str(), &new_times) == 0;
+            return FA_UTIME(filename.c_str(), &new_times) == 0;
         }
-#endif
     } else {
         lastError = "Error setting file modified time: " + filename;
     }
 
     return false;
 }
+
+static AsyncIO* _get_async_io() {
+    if (AsyncIO* io = AsyncIO::get_singleton()) {
+        return io;
+    }
+    static AsyncIO fallback;
+    return &fallback;
+}
+
+Ref<AsyncRequest> FileAccess::read_async(const std::string& path, uint64_t offset, size_t size, AsyncRequest::Callback callback, AsyncIO::Priority priority) {
+    return _get_async_io()->read(path, offset, size, std::move(callback), priority);
+}
+
+Ref<AsyncRequest> FileAccess::write_async(const std::string& path, uint64_t offset, std::vector<uint8_t> data, AsyncRequest::Callback callback, AsyncIO::Priority priority) {
+    return _get_async_io()->write(path, offset, std::move(data), std::move(callback), priority);
+}
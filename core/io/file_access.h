@@ -25,46 +25,90 @@ SOFTWARE.
 #define FILE_ACCESS_H
 
 
-#include <filesystem>
-#include <new>
+#include <chrono>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
 
 #include <functional> // for std::function
 
 
-#include "core/string/ustring.h" // for String class
-#include "core/templates/vector.h" // for Vector<T> class 
+#include "core/templates/span.h" // for Span<T>, views into mapped files
+#include "core/io/async_io.h" // for AsyncIO, read_async()/write_async()
 #include "core/object/ref_counted.h" // for RefCounted class
 #include "core/error/error_list.h" // for Error enum 
-#include "core/object/m_object.h" // for CLASS() macro to registeration class 
 
 
 /**
  * @class FileAccess
- * @brief This simple FileAccess class 
- * provides basic functionality for opening, writing to, and reading from a file. 
- * The constructor takes a filename, and the member functions handle file operations.
- * 
+ * @brief Buffered or memory-mapped access to one file.
+ *
+ * Reads go through a user-space buffer (256 KiB by default), so get_8() ..
+ * get_64() and get_line() are served from memory and only a full buffer
+ * costs a system call. Multi-byte values are little-endian on every
+ * platform. Writes are buffered the same way and reach the file on
+ * flush(), seek() or close().
+ *
+ * READ_MMAP maps the whole file read-only instead. get_span() then returns
+ * views straight into the mapping: no copy and no buffer, which suits
+ * large assets read once (pack files, meshes, audio).
+ *
+ * Only depends on the standard library and core/object/ref_counted.h, so
+ * command line tools (tools/pack_tool.cpp) can link it without the engine.
  */
 
 class FileAccess : public RefCounted {
-	CLASS(FileAccess , RefCounted);	
+public:
+	enum ModeFlags {
+		WRITE, ///< Create or truncate, write only.
+		READ, ///< Existing file, read only.
+		WRITE_READ, ///< Create or truncate, read and write.
+		READ_WRITE, ///< Existing file, read and write, not truncated.
+		APPEND, ///< Create if missing, writes go to the end.
+		READ_MMAP, ///< Existing file, mapped read-only.
+	};
+
+	static const size_t DEFAULT_BUFFER_SIZE = 256 * 1024;
 
 private:
     std::string filename;
-    std::fstream file;
-    ModeFlags mode;
+    ModeFlags mode = READ;
     std::string lastError;
 
-
-public:
-	enum ModeFlags {
-		WRITE,
-		READ,
-		WRITE_READ,
-		READ_WRITE
-	};
+    int fd = -1;
+    bool opened = false;
+    bool eof = false;
+
+    // One buffer, either holding file bytes being read or bytes waiting to
+    // be written. buffer_offset is the file position of buffer[0].
+    enum BufferState {
+        BUFFER_EMPTY,
+        BUFFER_READ,
+        BUFFER_WRITE
+    };
+    std::unique_ptr<uint8_t[]> buffer;
+    size_t buffer_capacity = DEFAULT_BUFFER_SIZE;
+    BufferState buffer_state = BUFFER_EMPTY;
+    uint64_t buffer_offset = 0;
+    size_t buffer_pos = 0; ///< Read cursor, or bytes pending in write state.
+    size_t buffer_len = 0; ///< Valid bytes in read state.
+
+    // READ_MMAP.
+    const uint8_t* map_data = nullptr;
+    uint64_t map_size = 0;
+    uint64_t map_pos = 0;
+
+    bool _flush_write();
+    bool _fill(size_t p_min);
+    size_t _read_direct(uint8_t* p_dst, size_t p_length);
+    bool _write_bytes(const void* p_data, size_t p_size);
+    bool _get_bytes(void* p_dst, size_t p_size);
+    const uint8_t* _get_view(size_t p_size, uint8_t* p_scratch);
 
 public:
 	FileAccess();
@@ -77,17 +121,57 @@ public:
 	 */
 	bool open(const std::string& path, ModeFlags mode);
 	bool is_open() const;
+	ModeFlags get_mode() const { return mode; }
+
+	/** @brief Size of the read/write buffer. Takes effect on the next open(). */
+	void set_buffer_size(size_t size);
+	size_t get_buffer_size() const { return buffer_capacity; }
 	
-	bool file_exists(const String& path) const;
-	bool write(const String& data);
+	bool file_exists(const std::string& path) const;
+	bool write(const std::string& data);
+
+	// Position and size.
+	bool seek(uint64_t position);
+	bool seek_end(int64_t position = 0);
+	uint64_t get_position() const;
+	uint64_t get_length() const;
+	bool eof_reached() const { return eof; }
+
+	// Little-endian getters. On a short read they return 0 and set eof_reached().
+	uint8_t get_8();
+	uint16_t get_16();
+	uint32_t get_32();
+	uint64_t get_64();
+	float get_float();
+	double get_double();
+
+	/** @brief Copy up to length bytes. @return Bytes read. */
+	size_t get_buffer(uint8_t* data, size_t length);
+	size_t get_buffer(Span<uint8_t> data) { return get_buffer(data.data(), data.size()); }
 
-	bool open_compressed(const std::string& path, ModeFlags mode);
-	bool open_encrypted(const std::string& path, ModeFlags mode);
+	/**
+	 * View the next length bytes and advance past them, without copying.
+	 * With READ_MMAP the view stays valid until close(). Otherwise it points
+	 * into the read buffer, is valid until the next call on this file, and
+	 * is empty if length exceeds get_buffer_size(). Short at end of file.
+	 */
+	Span<const uint8_t> get_span(size_t length);
+	/** @brief The whole mapping in READ_MMAP mode, empty otherwise. */
+	Span<const uint8_t> get_mapped_data() const { return Span<const uint8_t>(map_data, static_cast<size_t>(map_size)); }
+
+	bool store_8(uint8_t value);
+	bool store_16(uint16_t value);
+	bool store_32(uint32_t value);
+	bool store_64(uint64_t value);
+	bool store_float(float value);
+	bool store_double(double value);
+	bool store_buffer(const char* buffer, size_t size);
+	bool store_buffer(Span<const uint8_t> data) { return store_buffer(reinterpret_cast<const char*>(data.data()), data.size()); }
 
 	bool write_line_to_file(const std::string& line);
-	bool write_pascal_string_to_file(const std::string& pascalString);
+	bool store_pascal_string(const std::string& pascalString);
  
-	bool write_var_to_file(const void* variable, size_t size);
+	bool store_var(const void* variable, size_t size);
   bool write_16_to_file(uint16_t value);
   
 	bool read(std::string& data);
@@ -96,14 +180,10 @@ public:
 	bool store_string(const std::string& data);
   bool get_var_from_file(void* variable, size_t size);
   
-	bool get_hidden_attribute();
-
-	uint16_t get16();
-  
 	std::string get_file_path() const;
   std::string get_open_error() const;
   
-	std::vector<uint8_t> get_file_as_Bytes() const; 
+	std::vector<uint8_t> get_file_as_bytes(); 
 	std::string get_error() const;
   
 	std::vector<std::string> get_csv_Line(char delimiter = ',');
@@ -115,46 +195,21 @@ public:
   uint16_t get16();
   
 	std::string get_as_text();
-	std::string get_file_as_string();
-
-	std::function<void()> get_create_func();
-
 
-	std::chrono::system_clock::time_point get_modified_time() const;
+	std::chrono::system_clock::time_point get_modified_time();
 	bool set_modified_time(const std::chrono::system_clock::time_point& newTime);
-	
-	/**
-     *  Creates binary data from a file.
-     *  @return A data object.
-     */
-	
-	virtual void get_data_from_file(const String& file) const;
-
 
 	/**
-     *  Gets string from a file.
-     */
-     
-     virtual void get_string_from_file(const String& file) const;
-     
-     
-	/**
-     * Gets string from a file, async off the main patsher thread
-     *
-     * @param path filepath for the string to be read. Can be relative or absolute path
-     * @param callback Function that will be called when file is read. Will be called 
-     * on the main patsher thread.
-     */
-     
-	virtual void get_string_from_file(const String& path , std::function<void(String)> callback) const;
-	
-	
-protected:
-	static void _bind_methods() {} 
-
-
-
+	 * @brief Reads p_size bytes at p_offset without blocking the caller.
+	 *
+	 * Goes through AsyncIO::get_singleton(), or a process-wide instance if
+	 * the engine did not create one. The callback runs from AsyncIO::poll().
+	 * @return Completion token: wait(), is_done(), cancel(), get_data().
+	 */
+	static Ref<AsyncRequest> read_async(const std::string& path, uint64_t offset, size_t size, AsyncRequest::Callback callback = nullptr, AsyncIO::Priority priority = AsyncIO::PRIORITY_NORMAL);
 
+	/** @brief Writes p_data at p_offset without blocking, see read_async(). */
+	static Ref<AsyncRequest> write_async(const std::string& path, uint64_t offset, std::vector<uint8_t> data, AsyncRequest::Callback callback = nullptr, AsyncIO::Priority priority = AsyncIO::PRIORITY_NORMAL);
 };
 
 
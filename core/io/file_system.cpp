@@ -0,0 +1,933 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "core/io/file_system.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
+#include "core/io/file_access.h"
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#define FSI_INOTIFY_ENABLED
+#endif
+
+struct FileSystemIndex::Record {
+    std::string path;
+    bool is_directory = false;
+    uint64_t size = 0;
+    int64_t modified_time = 0;
+};
+
+typedef std::vector<std::pair<std::string, FileSystemIndex::ChangeType>> ChangeList;
+
+static std::string _to_lower(std::string_view p_text) {
+    std::string result(p_text);
+    for (char& c : result) {
+        if (c >= 'A' && c <= 'Z') {
+            c = char(c - 'A' + 'a');
+        }
+    }
+    return result;
+}
+
+static std::string_view _file_name(std::string_view p_path) {
+    size_t slash = p_path.find_last_of('/');
+    return slash == std::string_view::npos ? p_path : p_path.substr(slash + 1);
+}
+
+static std::string _join(const std::string& p_directory, std::string_view p_name) {
+    if (p_directory.empty()) {
+        return std::string(p_name);
+    }
+    std::string result;
+    result.reserve(p_directory.size() + 1 + p_name.size());
+    result += p_directory;
+    result += '/';
+    result += p_name;
+    return result;
+}
+
+template <typename F>
+static void _parallel_for(size_t p_count, int p_threads, F&& p_work) {
+    size_t threads = p_threads > 0 ? size_t(p_threads) : std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, p_count);
+    std::atomic<size_t> next{ 0 };
+    auto worker = [&]() {
+        for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < p_count; i = next.fetch_add(1, std::memory_order_relaxed)) {
+            p_work(i);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < threads; i++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+}
+
+#ifndef _WIN32
+static int64_t _mtime_ns(const struct stat& p_st) {
+#ifdef __APPLE__
+    return int64_t(p_st.st_mtimespec.tv_sec) * 1000000000 + p_st.st_mtimespec.tv_nsec;
+#else
+    return int64_t(p_st.st_mtim.tv_sec) * 1000000000 + p_st.st_mtim.tv_nsec;
+#endif
+}
+
+// Symlinks to files are indexed with their target's data; symlinks to
+// directories are skipped, so a link loop cannot make the crawl endless.
+static bool _fill_record(int p_dir_fd, const char* p_name, struct stat& st, bool& r_is_directory, uint64_t& r_size, int64_t& r_time) {
+    if (S_ISLNK(st.st_mode)) {
+        if (fstatat(p_dir_fd, p_name, &st, 0) != 0 || S_ISDIR(st.st_mode)) {
+            return false;
+        }
+    }
+    if (!S_ISDIR(st.st_mode) && !S_ISREG(st.st_mode)) {
+        return false;
+    }
+    r_is_directory = S_ISDIR(st.st_mode);
+    r_size = r_is_directory ? 0 : uint64_t(st.st_size);
+    r_time = _mtime_ns(st);
+    return true;
+}
+#else
+static int64_t _mtime_ns(const std::filesystem::file_time_type& p_time) {
+    // file_time_type has no portable epoch before C++20; this matches MSVC's.
+    auto since_epoch = p_time.time_since_epoch() - std::chrono::seconds(11644473600LL);
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch).count();
+}
+#endif
+
+FileSystemIndex::FileSystemIndex() {}
+
+FileSystemIndex::~FileSystemIndex() {
+    close();
+}
+
+std::string FileSystemIndex::_full_path(const std::string& p_path) const {
+    return p_path.empty() ? root : root + "/" + p_path;
+}
+
+bool FileSystemIndex::_is_ignored(std::string_view p_name) const {
+    return ignore_hidden && !p_name.empty() && p_name[0] == '.';
+}
+
+bool FileSystemIndex::_stat(const std::string& p_full_path, Record& r_record) {
+#ifdef _WIN32
+    std::error_code ec;
+    std::filesystem::file_status status = std::filesystem::status(p_full_path, ec);
+    if (ec || (!std::filesystem::is_directory(status) && !std::filesystem::is_regular_file(status))) {
+        return false;
+    }
+    r_record.is_directory = std::filesystem::is_directory(status);
+    r_record.size = r_record.is_directory ? 0 : std::filesystem::file_size(p_full_path, ec);
+    r_record.modified_time = _mtime_ns(std::filesystem::last_write_time(p_full_path, ec));
+    return true;
+#else
+    struct stat st;
+    if (lstat(p_full_path.c_str(), &st) != 0) {
+        return false;
+    }
+    return _fill_record(AT_FDCWD, p_full_path.c_str(), st, r_record.is_directory, r_record.size, r_record.modified_time);
+#endif
+}
+
+bool FileSystemIndex::_list(const std::string& p_path, std::vector<Record>& r_records) const {
+    std::string full = _full_path(p_path);
+#ifdef _WIN32
+    std::error_code ec;
+    std::filesystem::directory_iterator it(full, ec);
+    if (ec) {
+        return false;
+    }
+    for (const std::filesystem::directory_entry& entry : it) {
+        std::string name = entry.path().filename().string();
+        Record record;
+        if (_is_ignored(name) || !_stat(entry.path().string(), record)) {
+            continue;
+        }
+        record.path = _join(p_path, name);
+        r_records.push_back(std::move(record));
+    }
+    return true;
+#else
+    DIR* dir = opendir(full.c_str());
+    if (!dir) {
+        return false;
+    }
+    int dir_fd = dirfd(dir);
+    while (struct dirent* entry = readdir(dir)) {
+        const char* name = entry->d_name;
+        if (std::strcmp(name, ".") == 0 || std::strcmp(name, "..") == 0 || _is_ignored(name)) {
+            continue;
+        }
+        struct stat st;
+        Record record;
+        if (fstatat(dir_fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0 || !_fill_record(dir_fd, name, st, record.is_directory, record.size, record.modified_time)) {
+            continue;
+        }
+        record.path = _join(p_path, name);
+        r_records.push_back(std::move(record));
+    }
+    closedir(dir);
+    return true;
+#endif
+}
+
+// Crawls the subtrees below p_directories on worker threads. Each worker
+// lists one directory at a time and queues the subdirectories it finds.
+void FileSystemIndex::_crawl(const std::vector<std::string>& p_directories, std::vector<Record>& r_records) const {
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::vector<std::string> queue(p_directories);
+    int active = 0;
+
+    size_t threads = thread_count > 0 ? size_t(thread_count) : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::vector<Record>> results(threads);
+
+    auto worker = [&](size_t p_id) {
+        std::vector<Record>& out = results[p_id];
+        std::vector<Record> listed;
+        std::unique_lock<std::mutex> guard(mutex);
+        while (true) {
+            cond.wait(guard, [&] { return !queue.empty() || active == 0; });
+            if (queue.empty()) {
+                break;
+            }
+            std::string directory = std::move(queue.back());
+            queue.pop_back();
+            active++;
+            guard.unlock();
+
+            listed.clear();
+            _list(directory, listed);
+
+            guard.lock();
+            for (Record& record : listed) {
+                if (record.is_directory) {
+                    queue.push_back(record.path);
+                }
+                out.push_back(std::move(record));
+            }
+            active--;
+            cond.notify_all();
+        }
+        cond.notify_all();
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < threads; i++) {
+        pool.emplace_back(worker, i);
+    }
+    worker(0);
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+
+    for (std::vector<Record>& result : results) {
+        std::move(result.begin(), result.end(), std::back_inserter(r_records));
+    }
+    // Parents sort before their children, so they are added first.
+    std::sort(r_records.begin(), r_records.end(), [](const Record& a, const Record& b) { return a.path < b.path; });
+}
+
+void FileSystemIndex::_index(uint32_t p_index) {
+    const Entry& entry = entries[p_index];
+    by_path[entry.path] = p_index;
+    if (entry.is_directory) {
+        return;
+    }
+    by_extension[entry.extension].insert(p_index);
+    by_name.emplace(entry.name_key, p_index);
+    by_time.emplace(entry.modified_time, p_index);
+}
+
+template <typename M, typename K>
+static void _erase_pair(M& p_map, const K& p_key, uint32_t p_index) {
+    auto range = p_map.equal_range(p_key);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == p_index) {
+            p_map.erase(it);
+            return;
+        }
+    }
+}
+
+void FileSystemIndex::_unindex(uint32_t p_index) {
+    const Entry& entry = entries[p_index];
+    by_path.erase(entry.path);
+    if (entry.is_directory) {
+        return;
+    }
+    auto ext = by_extension.find(entry.extension);
+    if (ext != by_extension.end()) {
+        ext->second.erase(p_index);
+        if (ext->second.empty()) {
+            by_extension.erase(ext);
+        }
+    }
+    _erase_pair(by_name, entry.name_key, p_index);
+    _erase_pair(by_time, entry.modified_time, p_index);
+}
+
+uint32_t FileSystemIndex::_add(const Record& p_record, ChangeList* r_changes) {
+    auto existing = by_path.find(p_record.path);
+    if (existing != by_path.end()) {
+        uint32_t index = existing->second;
+        if (entries[index].is_directory == p_record.is_directory) {
+            if (_update(index, p_record) && r_changes && !p_record.is_directory) {
+                r_changes->emplace_back(p_record.path, CHANGE_MODIFIED);
+            }
+            return index;
+        }
+        _remove(index, r_changes); // A file became a directory or the reverse.
+    }
+
+    uint32_t parent = UINT32_MAX;
+    if (!p_record.path.empty()) {
+        size_t slash = p_record.path.find_last_of('/');
+        auto it = by_path.find(slash == std::string::npos ? std::string() : p_record.path.substr(0, slash));
+        if (it == by_path.end()) {
+            return UINT32_MAX; // Parent not indexed (hidden or gone).
+        }
+        parent = it->second;
+    }
+
+    uint32_t index;
+    if (!free_entries.empty()) {
+        index = free_entries.back();
+        free_entries.pop_back();
+    } else {
+        index = static_cast<uint32_t>(entries.size());
+        entries.emplace_back();
+    }
+
+    Entry& entry = entries[index];
+    entry.path = p_record.path;
+    std::string_view name = _file_name(entry.path);
+    entry.name_key = _to_lower(name);
+    size_t dot = name.find_last_of('.');
+    entry.extension = dot == std::string_view::npos || dot == 0 ? std::string() : _to_lower(name.substr(dot + 1));
+    entry.parent = parent;
+    entry.size = p_record.size;
+    entry.modified_time = p_record.modified_time;
+    entry.is_directory = p_record.is_directory;
+    entry.alive = true;
+    entry.watch = -1;
+    entry.children.clear();
+
+    if (parent != UINT32_MAX) {
+        entries[parent].children.push_back(index);
+    }
+    _index(index);
+    if (!p_record.is_directory) {
+        file_count++;
+    }
+    if (r_changes) {
+        r_changes->emplace_back(p_record.path, CHANGE_ADDED);
+    }
+    if (p_record.is_directory) {
+        _add_watch(index);
+    }
+    return index;
+}
+
+bool FileSystemIndex::_update(uint32_t p_index, const Record& p_record) {
+    Entry& entry = entries[p_index];
+    if (entry.size == p_record.size && entry.modified_time == p_record.modified_time) {
+        return false;
+    }
+    if (!entry.is_directory) {
+        _erase_pair(by_time, entry.modified_time, p_index);
+        by_time.emplace(p_record.modified_time, p_index);
+    }
+    entry.size = p_record.size;
+    entry.modified_time = p_record.modified_time;
+    return true;
+}
+
+void FileSystemIndex::_remove(uint32_t p_index, ChangeList* r_changes) {
+    std::vector<uint32_t> children = std::move(entries[p_index].children);
+    for (uint32_t child : children) {
+        _remove(child, r_changes);
+    }
+
+    Entry& entry = entries[p_index];
+#ifdef FSI_INOTIFY_ENABLED
+    if (entry.watch >= 0) {
+        watches.erase(entry.watch);
+        if (inotify_fd >= 0) {
+            inotify_rm_watch(inotify_fd, entry.watch);
+        }
+    }
+#endif
+    if (entry.parent != UINT32_MAX) {
+        std::vector<uint32_t>& siblings = entries[entry.parent].children;
+        auto it = std::find(siblings.begin(), siblings.end(), p_index);
+        if (it != siblings.end()) {
+            *it = siblings.back();
+            siblings.pop_back();
+        }
+    }
+    _unindex(p_index);
+    if (!entry.is_directory) {
+        file_count--;
+    }
+    if (r_changes) {
+        r_changes->emplace_back(entry.path, CHANGE_REMOVED);
+    }
+    entry = Entry();
+    free_entries.push_back(p_index);
+}
+
+void FileSystemIndex::_clear() {
+    entries.clear();
+    free_entries.clear();
+    by_path.clear();
+    by_extension.clear();
+    by_name.clear();
+    by_time.clear();
+    watches.clear();
+    file_count = 0;
+}
+
+void FileSystemIndex::_notify(const ChangeList& p_changes) {
+    if (!listener.is_valid()) {
+        return;
+    }
+    for (const std::pair<std::string, ChangeType>& change : p_changes) {
+        listener(change.first, change.second);
+    }
+}
+
+Error FileSystemIndex::open(const std::string& p_root, const std::string& p_cache_path) {
+    close();
+    std::string path = p_root;
+    while (path.size() > 1 && (path.back() == '/' || path.back() == '\\')) {
+        path.pop_back();
+    }
+    Record record;
+    if (!_stat(path, record) || !record.is_directory) {
+        return ERR_FILE_BAD_PATH;
+    }
+    root = path;
+    if (p_cache_path.empty() || load_cache(p_cache_path) != OK) {
+        std::unique_lock<std::shared_mutex> guard(lock);
+        _clear();
+    }
+    scan(false);
+    return OK;
+}
+
+void FileSystemIndex::close() {
+    stop_watching();
+    std::unique_lock<std::shared_mutex> guard(lock);
+    _clear();
+    root.clear();
+}
+
+int FileSystemIndex::scan(bool p_verify_files) {
+    return _scan(p_verify_files, nullptr);
+}
+
+// p_directories restricts the pass to those directory entries; nullptr
+// checks every directory.
+int FileSystemIndex::_scan(bool p_verify_files, const std::vector<uint32_t>* p_directories) {
+    if (root.empty()) {
+        return 0;
+    }
+
+    bool empty;
+    {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        empty = by_path.empty();
+    }
+    if (empty) {
+        // First build: nothing to report, every entry is new.
+        Record root_record;
+        if (!_stat(root, root_record)) {
+            return 0;
+        }
+        std::vector<Record> records;
+        _crawl({ std::string() }, records);
+        std::unique_lock<std::shared_mutex> guard(lock);
+        entries.reserve(records.size() + 1);
+        by_path.reserve(records.size() + 1);
+        _add(root_record, nullptr);
+        for (const Record& record : records) {
+            _add(record, nullptr);
+        }
+        return 0;
+    }
+
+    struct DirectoryResult {
+        uint32_t index = 0;
+        std::string path;
+        int64_t known_time = 0;
+        bool missing = false;
+        bool listed = false;
+        Record self;
+        std::vector<Record> children;
+    };
+
+    std::vector<DirectoryResult> results;
+    {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        const auto collect = [&](uint32_t p_index) {
+            if (p_index < entries.size() && entries[p_index].alive && entries[p_index].is_directory) {
+                DirectoryResult result;
+                result.index = p_index;
+                result.path = entries[p_index].path;
+                result.known_time = entries[p_index].modified_time;
+                results.push_back(std::move(result));
+            }
+        };
+        if (p_directories) {
+            for (uint32_t index : *p_directories) {
+                collect(index);
+            }
+        } else {
+            for (uint32_t i = 0; i < entries.size(); i++) {
+                collect(i);
+            }
+        }
+    }
+
+    // One stat per directory; only changed ones (or all, when verifying)
+    // are listed again.
+    _parallel_for(results.size(), thread_count, [&](size_t i) {
+        DirectoryResult& result = results[i];
+        if (!_stat(_full_path(result.path), result.self) || !result.self.is_directory) {
+            result.missing = true;
+            return;
+        }
+        if (p_verify_files || result.self.modified_time != result.known_time) {
+            result.listed = _list(result.path, result.children);
+        }
+    });
+
+    ChangeList changes;
+    std::vector<std::string> new_directories;
+    {
+        std::unique_lock<std::shared_mutex> guard(lock);
+        for (DirectoryResult& result : results) {
+            Entry& entry = entries[result.index];
+            if (!entry.alive || entry.path != result.path) {
+                continue; // Removed along with a parent.
+            }
+            if (result.missing) {
+                _remove(result.index, &changes);
+                continue;
+            }
+            if (!result.listed) {
+                continue;
+            }
+            entry.modified_time = result.self.modified_time;
+
+            std::unordered_map<std::string_view, const Record*> listed;
+            for (const Record& record : result.children) {
+                listed.emplace(record.path, &record);
+            }
+            std::vector<uint32_t> children = entries[result.index].children;
+            for (uint32_t child : children) {
+                auto it = listed.find(entries[child].path);
+                if (it == listed.end() || it->second->is_directory != entries[child].is_directory) {
+                    _remove(child, &changes);
+                }
+            }
+            for (const Record& record : result.children) {
+                bool known = by_path.count(record.path) != 0;
+                _add(record, &changes);
+                if (!known && record.is_directory) {
+                    new_directories.push_back(record.path);
+                }
+            }
+        }
+    }
+
+    if (!new_directories.empty()) {
+        std::vector<Record> records;
+        _crawl(new_directories, records);
+        std::unique_lock<std::shared_mutex> guard(lock);
+        for (const Record& record : records) {
+            _add(record, &changes);
+        }
+    }
+
+    _notify(changes);
+    return static_cast<int>(changes.size());
+}
+
+Error FileSystemIndex::save_cache(const std::string& p_path) const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    std::vector<const Entry*> sorted;
+    sorted.reserve(by_path.size());
+    for (const Entry& entry : entries) {
+        if (entry.alive) {
+            sorted.push_back(&entry);
+        }
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const Entry* a, const Entry* b) { return a->path < b->path; });
+
+    std::string temp_path = p_path + ".tmp";
+    FileAccess file;
+    if (!file.open(temp_path, FileAccess::WRITE)) {
+        return ERR_FILE_CANT_OPEN;
+    }
+    bool ok = file.store_32(CACHE_MAGIC) && file.store_32(CACHE_VERSION) && file.store_32(ignore_hidden ? 1 : 0);
+    ok = ok && file.store_32(static_cast<uint32_t>(root.size())) && file.store_buffer(root.data(), root.size());
+    ok = ok && file.store_32(static_cast<uint32_t>(sorted.size()));
+    for (size_t i = 0; ok && i < sorted.size(); i++) {
+        const Entry& entry = *sorted[i];
+        ok = file.store_32(static_cast<uint32_t>(entry.path.size())) && file.store_buffer(entry.path.data(), entry.path.size());
+        ok = ok && file.store_8(entry.is_directory ? 1 : 0) && file.store_64(entry.size) && file.store_64(static_cast<uint64_t>(entry.modified_time));
+    }
+    file.close();
+    if (!ok) {
+        std::remove(temp_path.c_str());
+        return ERR_FILE_CANT_WRITE;
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp_path, p_path, ec);
+    return ec ? ERR_FILE_CANT_WRITE : OK;
+}
+
+Error FileSystemIndex::load_cache(const std::string& p_path) {
+    FileAccess file;
+    if (!file.open(p_path, FileAccess::READ)) {
+        return ERR_FILE_CANT_OPEN;
+    }
+    if (file.get_32() != CACHE_MAGIC || file.get_32() != CACHE_VERSION) {
+        return ERR_FILE_UNRECOGNIZED;
+    }
+    bool hidden = file.get_32() != 0;
+    uint32_t root_length = file.get_32();
+    if (root_length > 0xFFFF) {
+        return ERR_FILE_CORRUPT;
+    }
+    std::string cached_root(root_length, '\0');
+    if (file.get_buffer(reinterpret_cast<uint8_t*>(&cached_root[0]), root_length) != root_length) {
+        return ERR_FILE_CORRUPT;
+    }
+    if (cached_root != root || hidden != ignore_hidden) {
+        return ERR_INVALID_DATA; // Written for another tree or settings.
+    }
+
+    uint32_t count = file.get_32();
+    // Smallest record: length, flag, size, time.
+    if (uint64_t(count) * 21 > file.get_length()) {
+        return ERR_FILE_CORRUPT;
+    }
+
+    std::unique_lock<std::shared_mutex> guard(lock);
+    _clear();
+    entries.reserve(count);
+    by_path.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        Record record;
+        uint32_t length = file.get_32();
+        if (length > 0xFFFF) {
+            _clear();
+            return ERR_FILE_CORRUPT;
+        }
+        record.path.resize(length);
+        if (file.get_buffer(reinterpret_cast<uint8_t*>(&record.path[0]), length) != length) {
+            _clear();
+            return ERR_FILE_CORRUPT;
+        }
+        record.is_directory = file.get_8() != 0;
+        record.size = file.get_64();
+        record.modified_time = static_cast<int64_t>(file.get_64());
+        if (file.eof_reached() || (i == 0) != record.path.empty() || _add(record, nullptr) == UINT32_MAX) {
+            _clear();
+            return ERR_FILE_CORRUPT;
+        }
+    }
+    return OK;
+}
+
+void FileSystemIndex::_add_watch(uint32_t p_index) {
+#ifdef FSI_INOTIFY_ENABLED
+    if (inotify_fd < 0 || !entries[p_index].is_directory) {
+        return;
+    }
+    const uint32_t mask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+    int wd = inotify_add_watch(inotify_fd, _full_path(entries[p_index].path).c_str(), mask);
+    if (wd < 0) {
+        if (errno == ENOSPC) {
+            watch_limit_reached = true;
+        }
+        return;
+    }
+    entries[p_index].watch = wd;
+    watches[wd] = p_index;
+#else
+    (void)p_index;
+#endif
+}
+
+int FileSystemIndex::_poll_unwatched() {
+    const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    if (now < next_unwatched_poll) {
+        return 0;
+    }
+    next_unwatched_poll = now + UNWATCHED_POLL_INTERVAL_MS * 1000000;
+
+    // Retry first: watches freed by removed directories, or a raised limit,
+    // let some of them go back to events. Stop at the first refusal.
+    std::vector<uint32_t> unwatched;
+    {
+        std::unique_lock<std::shared_mutex> guard(lock);
+        watch_limit_reached = false;
+        for (uint32_t i = 0; i < entries.size(); i++) {
+            if (entries[i].alive && entries[i].is_directory && entries[i].watch < 0) {
+                unwatched.push_back(i);
+                if (!watch_limit_reached) {
+                    _add_watch(i);
+                }
+            }
+        }
+    }
+    // Even the ones just watched may have changed while they were not.
+    return _scan(false, &unwatched);
+}
+
+bool FileSystemIndex::start_watching() {
+#ifdef FSI_INOTIFY_ENABLED
+    if (inotify_fd >= 0) {
+        return true;
+    }
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0) {
+        return false;
+    }
+    std::unique_lock<std::shared_mutex> guard(lock);
+    watch_limit_reached = false;
+    for (uint32_t i = 0; i < entries.size(); i++) {
+        if (entries[i].alive && entries[i].is_directory) {
+            _add_watch(i);
+        }
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void FileSystemIndex::stop_watching() {
+#ifdef FSI_INOTIFY_ENABLED
+    if (inotify_fd < 0) {
+        return;
+    }
+    ::close(inotify_fd);
+    inotify_fd = -1;
+    std::unique_lock<std::shared_mutex> guard(lock);
+    watches.clear();
+    for (Entry& entry : entries) {
+        entry.watch = -1;
+    }
+#endif
+}
+
+int FileSystemIndex::process_events() {
+#ifdef FSI_INOTIFY_ENABLED
+    if (inotify_fd < 0) {
+        return 0;
+    }
+
+    ChangeList changes;
+    std::vector<std::string> new_directories;
+    bool overflow = false;
+    alignas(struct inotify_event) char buffer[64 * 1024];
+    {
+        std::unique_lock<std::shared_mutex> guard(lock);
+        while (true) {
+            ssize_t length = ::read(inotify_fd, buffer, sizeof(buffer));
+            if (length <= 0) {
+                break; // EAGAIN: drained.
+            }
+            for (ssize_t pos = 0; pos < length;) {
+                const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(buffer + pos);
+                pos += sizeof(struct inotify_event) + event->len;
+
+                if (event->mask & IN_Q_OVERFLOW) {
+                    overflow = true;
+                    continue;
+                }
+                auto watch = watches.find(event->wd);
+                if (watch == watches.end()) {
+                    continue;
+                }
+                if (event->mask & IN_IGNORED) {
+                    entries[watch->second].watch = -1;
+                    watches.erase(watch);
+                    continue;
+                }
+                if (event->len == 0 || _is_ignored(event->name)) {
+                    continue;
+                }
+
+                std::string path = _join(entries[watch->second].path, event->name);
+                auto existing = by_path.find(path);
+                if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                    if (existing != by_path.end()) {
+                        _remove(existing->second, &changes);
+                    }
+                    continue;
+                }
+
+                Record record;
+                if (!_stat(_full_path(path), record)) {
+                    if (existing != by_path.end()) {
+                        _remove(existing->second, &changes);
+                    }
+                    continue;
+                }
+                record.path = path;
+                bool known = existing != by_path.end();
+                _add(record, &changes);
+                if (!known && record.is_directory) {
+                    new_directories.push_back(path);
+                }
+            }
+        }
+    }
+
+    // A directory created or moved in may already hold files the watch
+    // never saw.
+    if (!new_directories.empty()) {
+        std::vector<Record> records;
+        _crawl(new_directories, records);
+        std::unique_lock<std::shared_mutex> guard(lock);
+        for (const Record& record : records) {
+            _add(record, &changes);
+        }
+    }
+
+    _notify(changes);
+    int count = static_cast<int>(changes.size());
+    if (overflow) {
+        count += scan(false);
+    } else if (watch_limit_reached) {
+        count += _poll_unwatched();
+    }
+    return count;
+#else
+    return 0;
+#endif
+}
+
+int FileSystemIndex::get_file_count() const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    return static_cast<int>(file_count);
+}
+
+bool FileSystemIndex::has_file(const std::string& p_path) const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    return by_path.count(p_path) != 0;
+}
+
+bool FileSystemIndex::get_info(const std::string& p_path, FileInfo& r_info) const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    auto it = by_path.find(p_path);
+    if (it == by_path.end()) {
+        return false;
+    }
+    const Entry& entry = entries[it->second];
+    r_info.path = entry.path;
+    r_info.size = entry.size;
+    r_info.modified_time = entry.modified_time;
+    r_info.is_directory = entry.is_directory;
+    return true;
+}
+
+std::vector<std::string> FileSystemIndex::get_directory(const std::string& p_directory) const {
+    std::vector<std::string> result;
+    std::shared_lock<std::shared_mutex> guard(lock);
+    auto it = by_path.find(p_directory);
+    if (it == by_path.end() || !entries[it->second].is_directory) {
+        return result;
+    }
+    for (uint32_t child : entries[it->second].children) {
+        result.emplace_back(_file_name(entries[child].path));
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<std::string> FileSystemIndex::get_files_with_extension(const std::string& p_extension) const {
+    std::string extension = _to_lower(p_extension);
+    if (!extension.empty() && extension[0] == '.') {
+        extension.erase(0, 1);
+    }
+    std::vector<std::string> result;
+    std::shared_lock<std::shared_mutex> guard(lock);
+    auto it = by_extension.find(extension);
+    if (it != by_extension.end()) {
+        result.reserve(it->second.size());
+        for (uint32_t index : it->second) {
+            result.push_back(entries[index].path);
+        }
+    }
+    return result;
+}
+
+std::vector<std::string> FileSystemIndex::find_by_name_prefix(const std::string& p_prefix, int p_max) const {
+    std::string prefix = _to_lower(p_prefix);
+    std::vector<std::string> result;
+    std::shared_lock<std::shared_mutex> guard(lock);
+    for (auto it = by_name.lower_bound(prefix); it != by_name.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it) {
+        result.push_back(entries[it->second].path);
+        if (p_max > 0 && int(result.size()) >= p_max) {
+            break;
+        }
+    }
+    return result;
+}
+
+std::vector<std::string> FileSystemIndex::get_modified_since(int64_t p_time) const {
+    std::vector<std::string> result;
+    std::shared_lock<std::shared_mutex> guard(lock);
+    for (auto it = by_time.lower_bound(p_time); it != by_time.end(); ++it) {
+        result.push_back(entries[it->second].path);
+    }
+    return result;
+}
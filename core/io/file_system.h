@@ -0,0 +1,190 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef FILE_SYSTEM_H
+#define FILE_SYSTEM_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "core/error/error_list.h"
+#include "core/templates/delegate.h"
+
+/**
+ * @class FileSystemIndex
+ * @brief Persistent index of a project tree, kept current by inotify.
+ *
+ * The first scan crawls the tree on worker threads and records each entry's
+ * size and modification time. save_cache() writes the index; the next
+ * open() loads it and only re-lists directories whose own mtime changed
+ * (adding, removing or renaming an entry updates it), so reopening a large
+ * project costs one stat per directory instead of a full crawl. File
+ * contents edited while the editor was closed do not touch directory
+ * mtimes; scan(true) also re-stats every file and is meant to run in the
+ * background after startup.
+ *
+ * While watching, inotify events are applied by process_events(), which
+ * the editor calls once per frame. If the kernel queue overflows, the index
+ * falls back to an incremental scan(). Directories left unwatched because
+ * the watch limit (fs.inotify.max_user_watches) was hit are polled instead:
+ * at most once per UNWATCHED_POLL_INTERVAL_MS, process_events() retries
+ * their watches and re-lists the ones whose mtime changed.
+ *
+ * Queries by extension, name prefix and modification time use secondary
+ * indexes updated with each change, so none of them walks the tree.
+ * Paths are relative to the root and use '/'.
+ */
+class FileSystemIndex {
+public:
+    enum ChangeType {
+        CHANGE_ADDED,
+        CHANGE_MODIFIED,
+        CHANGE_REMOVED,
+    };
+
+    typedef Delegate<void(const std::string&, ChangeType)> ChangeListener;
+
+    struct FileInfo {
+        std::string path;
+        uint64_t size = 0;
+        int64_t modified_time = 0; ///< Nanoseconds since the Unix epoch.
+        bool is_directory = false;
+    };
+
+    static const uint32_t CACHE_MAGIC = 0x49465350; // "PSFI"
+    static const uint32_t CACHE_VERSION = 1;
+    static const int64_t UNWATCHED_POLL_INTERVAL_MS = 1000;
+
+private:
+    struct Entry {
+        std::string path;
+        std::string name_key; ///< Lowercase file name, for prefix search.
+        std::string extension; ///< Lowercase, without the dot.
+        uint32_t parent = UINT32_MAX;
+        uint64_t size = 0;
+        int64_t modified_time = 0;
+        bool is_directory = false;
+        bool alive = false;
+        int watch = -1; ///< inotify descriptor of a directory.
+        std::vector<uint32_t> children;
+    };
+
+    struct Record;
+
+    std::string root;
+    bool ignore_hidden = true;
+    int thread_count = 0;
+
+    mutable std::shared_mutex lock;
+    std::vector<Entry> entries;
+    std::vector<uint32_t> free_entries;
+    std::unordered_map<std::string, uint32_t> by_path;
+    std::unordered_map<std::string, std::unordered_set<uint32_t>> by_extension;
+    std::multimap<std::string, uint32_t> by_name;
+    std::multimap<int64_t, uint32_t> by_time;
+    uint32_t file_count = 0;
+
+    int inotify_fd = -1;
+    std::unordered_map<int, uint32_t> watches;
+    bool watch_limit_reached = false;
+    int64_t next_unwatched_poll = 0; ///< Steady clock, nanoseconds.
+
+    ChangeListener listener;
+
+    std::string _full_path(const std::string& p_path) const;
+    bool _is_ignored(std::string_view p_name) const;
+    static bool _stat(const std::string& p_full_path, Record& r_record);
+    bool _list(const std::string& p_path, std::vector<Record>& r_records) const;
+    void _crawl(const std::vector<std::string>& p_directories, std::vector<Record>& r_records) const;
+
+    uint32_t _add(const Record& p_record, std::vector<std::pair<std::string, ChangeType>>* r_changes);
+    bool _update(uint32_t p_index, const Record& p_record);
+    void _remove(uint32_t p_index, std::vector<std::pair<std::string, ChangeType>>* r_changes);
+    void _index(uint32_t p_index);
+    void _unindex(uint32_t p_index);
+    void _clear();
+
+    int _scan(bool p_verify_files, const std::vector<uint32_t>* p_directories);
+    void _add_watch(uint32_t p_index);
+    int _poll_unwatched();
+    void _notify(const std::vector<std::pair<std::string, ChangeType>>& p_changes);
+
+public:
+    FileSystemIndex();
+    ~FileSystemIndex();
+
+    /** @brief Skip names starting with '.' (.git, .import). Default true. */
+    void set_ignore_hidden(bool p_ignore) { ignore_hidden = p_ignore; }
+    /** @brief Threads used by scans, 0 for the hardware count. */
+    void set_thread_count(int p_threads) { thread_count = p_threads; }
+    void set_change_listener(ChangeListener p_listener) { listener = std::move(p_listener); }
+
+    /**
+     * @brief Indexes p_root. Loads p_cache_path if it was written for the
+     * same root, then brings it up to date with scan(); otherwise crawls.
+     */
+    Error open(const std::string& p_root, const std::string& p_cache_path = "");
+    void close();
+    const std::string& get_root() const { return root; }
+
+    /**
+     * @brief Brings the index up to date. Re-lists directories whose mtime
+     * changed; with p_verify_files, also re-stats every file.
+     * @return Number of changes reported to the listener.
+     */
+    int scan(bool p_verify_files = false);
+
+    Error save_cache(const std::string& p_path) const;
+    Error load_cache(const std::string& p_path);
+
+    /** @return false where inotify is unavailable; scan() still works. */
+    bool start_watching();
+    void stop_watching();
+    bool is_watching() const { return inotify_fd >= 0; }
+    /** @brief True while some directories could not be watched and are polled. */
+    bool is_watch_limit_reached() const { return watch_limit_reached; }
+    /** @brief Applies pending inotify events without blocking. @return Changes applied. */
+    int process_events();
+
+    int get_file_count() const;
+    bool has_file(const std::string& p_path) const;
+    bool get_info(const std::string& p_path, FileInfo& r_info) const;
+    /** @brief Names of the entries directly inside p_directory ("" for the root). */
+    std::vector<std::string> get_directory(const std::string& p_directory) const;
+
+    /** @brief Files with extension p_extension ("png", case-insensitive). */
+    std::vector<std::string> get_files_with_extension(const std::string& p_extension) const;
+    /** @brief Files whose name starts with p_prefix, case-insensitive. @param p_max 0 for all. */
+    std::vector<std::string> find_by_name_prefix(const std::string& p_prefix, int p_max = 0) const;
+    /** @brief Files modified at or after p_time (nanoseconds since epoch). */
+    std::vector<std::string> get_modified_since(int64_t p_time) const;
+};
+
+#endif // FILE_SYSTEM_H
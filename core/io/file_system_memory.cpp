@@ -0,0 +1,379 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "core/io/file_system_memory.h"
+
+#include <algorithm>
+#include <filesystem>
+
+#include "core/io/file_access.h"
+#include "core/io/file_system_pack.h"
+
+FileSystemMemory* FileSystemMemory::singleton = nullptr;
+
+std::string FileSystemMemory::normalize_path(std::string_view p_path) {
+    std::string result;
+    size_t scheme = p_path.find("://");
+    if (scheme != std::string_view::npos) {
+        result.assign(p_path.substr(0, scheme + 3));
+        p_path.remove_prefix(scheme + 3);
+    } else if (!p_path.empty() && (p_path[0] == '/' || p_path[0] == '\\')) {
+        result = "/";
+    }
+    size_t root = result.size();
+
+    size_t start = 0;
+    while (start <= p_path.size()) {
+        size_t end = p_path.find_first_of("/\\", start);
+        if (end == std::string_view::npos) {
+            end = p_path.size();
+        }
+        std::string_view segment = p_path.substr(start, end - start);
+        start = end + 1;
+        if (segment.empty() || segment == ".") {
+            continue;
+        }
+        if (segment == "..") {
+            size_t slash = result.find_last_of('/');
+            if (result.size() > root) {
+                result.resize(slash == std::string::npos || slash < root ? root : slash);
+            }
+            continue;
+        }
+        if (result.size() > root) {
+            result += '/';
+        }
+        result += segment;
+    }
+    return result;
+}
+
+FileSystemMemory::FileSystemMemory() {
+    if (!singleton) {
+        singleton = this;
+    }
+}
+
+FileSystemMemory::~FileSystemMemory() {
+    if (singleton == this) {
+        singleton = nullptr;
+    }
+}
+
+void FileSystemMemory::mount_directory(const std::string& p_prefix, const std::string& p_directory) {
+    std::unique_lock<std::shared_mutex> guard(lock);
+    Mount mount;
+    mount.prefix = normalize_path(p_prefix);
+    mount.directory = p_directory.empty() ? "." : p_directory;
+    mounts.push_back(mount);
+    std::stable_sort(mounts.begin(), mounts.end(), [](const Mount& a, const Mount& b) { return a.prefix.size() > b.prefix.size(); });
+}
+
+void FileSystemMemory::mount_packs(const std::string& p_prefix, FileSystemPack* p_packs) {
+    std::unique_lock<std::shared_mutex> guard(lock);
+    Mount mount;
+    mount.prefix = normalize_path(p_prefix);
+    mount.packs = p_packs;
+    mounts.push_back(mount);
+    std::stable_sort(mounts.begin(), mounts.end(), [](const Mount& a, const Mount& b) { return a.prefix.size() > b.prefix.size(); });
+}
+
+bool FileSystemMemory::unmount(const std::string& p_prefix) {
+    std::unique_lock<std::shared_mutex> guard(lock);
+    std::string prefix = normalize_path(p_prefix);
+    for (size_t i = 0; i < mounts.size(); i++) {
+        if (mounts[i].prefix == prefix) {
+            mounts.erase(mounts.begin() + i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Called with the lock held, shared or exclusive.
+const FileSystemMemory::Mount* FileSystemMemory::_find_mount(const std::string& p_path, std::string& r_relative) const {
+    for (const Mount& mount : mounts) {
+        const std::string& prefix = mount.prefix;
+        if (p_path.compare(0, prefix.size(), prefix) != 0) {
+            continue;
+        }
+        bool boundary = prefix.empty() || p_path.size() == prefix.size() || prefix.back() == '/' || p_path[prefix.size()] == '/';
+        if (!boundary) {
+            continue;
+        }
+        size_t start = prefix.size();
+        if (start < p_path.size() && p_path[start] == '/') {
+            start++;
+        }
+        r_relative = p_path.substr(start);
+        return &mount;
+    }
+    return nullptr;
+}
+
+bool FileSystemMemory::_has_lower(const std::string& p_path) const {
+    std::string relative;
+    const Mount* mount = _find_mount(p_path, relative);
+    if (!mount) {
+        return false;
+    }
+    if (mount->packs) {
+        return mount->packs->has_file(relative);
+    }
+    std::error_code ec;
+    return std::filesystem::is_regular_file(std::filesystem::path(mount->directory) / relative, ec);
+}
+
+Error FileSystemMemory::_read_lower(const std::string& p_path, Ref<MemoryBuffer>& r_buffer) const {
+    std::string relative;
+    const Mount* mount = _find_mount(p_path, relative);
+    if (!mount) {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return ERR_FILE_NOT_FOUND;
+    }
+
+    if (mount->packs) {
+        Ref<PackFile> pack = mount->packs->find_pack(relative);
+        Span<const uint8_t> data;
+        if (pack.is_null() || !pack->get_file(relative, data)) {
+            misses.fetch_add(1, std::memory_order_relaxed);
+            return ERR_FILE_NOT_FOUND;
+        }
+        // Borrowed: the buffer keeps the pack mapped, even past an unmount.
+        r_buffer = Ref<MemoryBuffer>(new MemoryBuffer(data, pack));
+        pack_reads.fetch_add(1, std::memory_order_relaxed);
+        return OK;
+    }
+
+    std::string disk_path = (std::filesystem::path(mount->directory) / relative).string();
+    FileAccess file;
+    if (!file.open(disk_path, FileAccess::READ)) {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return ERR_FILE_NOT_FOUND;
+    }
+    std::vector<uint8_t> data(static_cast<size_t>(file.get_length()));
+    if (file.get_buffer(data.data(), data.size()) != data.size()) {
+        return ERR_FILE_CANT_READ;
+    }
+    r_buffer = Ref<MemoryBuffer>(new MemoryBuffer(std::move(data)));
+    disk_reads.fetch_add(1, std::memory_order_relaxed);
+    return OK;
+}
+
+void FileSystemMemory::_set(const std::string& p_path, const Ref<MemoryBuffer>& p_buffer, bool p_deleted) {
+    Node& node = files[p_path];
+    node.buffer = p_buffer;
+    node.deleted = p_deleted;
+    node.version = next_version++;
+}
+
+void FileSystemMemory::_notify(const std::string& p_path) {
+    std::vector<ChangeListener> to_call;
+    {
+        std::lock_guard<std::mutex> guard(listener_mutex);
+        for (const std::pair<int, ChangeListener>& listener : listeners) {
+            to_call.push_back(listener.second);
+        }
+    }
+    for (const ChangeListener& listener : to_call) {
+        listener(p_path);
+    }
+}
+
+Error FileSystemMemory::write_file(const std::string& p_path, std::vector<uint8_t> p_data) {
+    return write_file(p_path, Ref<MemoryBuffer>(new MemoryBuffer(std::move(p_data))));
+}
+
+Error FileSystemMemory::write_file(const std::string& p_path, const Ref<MemoryBuffer>& p_buffer) {
+    std::string path = normalize_path(p_path);
+    if (path.empty() || p_buffer.is_null()) {
+        return ERR_INVALID_PARAMETER;
+    }
+    {
+        std::unique_lock<std::shared_mutex> guard(lock);
+        _set(path, p_buffer, false);
+    }
+    _notify(path);
+    return OK;
+}
+
+Error FileSystemMemory::append_file(const std::string& p_path, Span<const uint8_t> p_data) {
+    std::string path = normalize_path(p_path);
+    if (path.empty()) {
+        return ERR_INVALID_PARAMETER;
+    }
+    {
+        std::unique_lock<std::shared_mutex> guard(lock);
+        Ref<MemoryBuffer> current;
+        auto it = files.find(path);
+        if (it != files.end()) {
+            current = it->second.buffer;
+        } else {
+            // Copy up. A missing file just starts empty, like opening for append.
+            _read_lower(path, current);
+        }
+        std::vector<uint8_t> data;
+        size_t old_size = current.is_valid() ? current->size() : 0;
+        data.reserve(old_size + p_data.size());
+        if (old_size) {
+            data.insert(data.end(), current->get_data().begin(), current->get_data().end());
+        }
+        data.insert(data.end(), p_data.begin(), p_data.end());
+        _set(path, Ref<MemoryBuffer>(new MemoryBuffer(std::move(data))), false);
+    }
+    _notify(path);
+    return OK;
+}
+
+Error FileSystemMemory::copy_file(const std::string& p_from, const std::string& p_to) {
+    Ref<MemoryBuffer> buffer;
+    Error err = read_file(p_from, buffer);
+    if (err != OK) {
+        return err;
+    }
+    return write_file(p_to, buffer);
+}
+
+Error FileSystemMemory::remove_file(const std::string& p_path) {
+    std::string path = normalize_path(p_path);
+    {
+        std::unique_lock<std::shared_mutex> guard(lock);
+        auto it = files.find(path);
+        bool in_overlay = it != files.end() && !it->second.deleted;
+        bool below = _has_lower(path);
+        if (!in_overlay && (!below || it != files.end())) {
+            return ERR_FILE_NOT_FOUND;
+        }
+        if (below) {
+            _set(path, Ref<MemoryBuffer>(), true);
+        } else {
+            files.erase(it);
+        }
+    }
+    _notify(path);
+    return OK;
+}
+
+bool FileSystemMemory::revert_file(const std::string& p_path) {
+    std::string path = normalize_path(p_path);
+    {
+        std::unique_lock<std::shared_mutex> guard(lock);
+        if (files.erase(path) == 0) {
+            return false;
+        }
+    }
+    _notify(path);
+    return true;
+}
+
+void FileSystemMemory::clear() {
+    std::vector<std::string> changed;
+    {
+        std::unique_lock<std::shared_mutex> guard(lock);
+        for (const auto& entry : files) {
+            changed.push_back(entry.first);
+        }
+        files.clear();
+    }
+    for (const std::string& path : changed) {
+        _notify(path);
+    }
+}
+
+bool FileSystemMemory::has_file(const std::string& p_path) const {
+    std::string path = normalize_path(p_path);
+    std::shared_lock<std::shared_mutex> guard(lock);
+    auto it = files.find(path);
+    if (it != files.end()) {
+        return !it->second.deleted;
+    }
+    return _has_lower(path);
+}
+
+Error FileSystemMemory::read_file(const std::string& p_path, Ref<MemoryBuffer>& r_buffer) const {
+    std::string path = normalize_path(p_path);
+    std::shared_lock<std::shared_mutex> guard(lock);
+    auto it = files.find(path);
+    if (it != files.end()) {
+        if (it->second.deleted) {
+            misses.fetch_add(1, std::memory_order_relaxed);
+            return ERR_FILE_NOT_FOUND;
+        }
+        r_buffer = it->second.buffer;
+        overlay_hits.fetch_add(1, std::memory_order_relaxed);
+        return OK;
+    }
+    return _read_lower(path, r_buffer);
+}
+
+bool FileSystemMemory::is_overridden(const std::string& p_path) const {
+    std::string path = normalize_path(p_path);
+    std::shared_lock<std::shared_mutex> guard(lock);
+    return files.count(path) != 0;
+}
+
+uint64_t FileSystemMemory::get_version(const std::string& p_path) const {
+    std::string path = normalize_path(p_path);
+    std::shared_lock<std::shared_mutex> guard(lock);
+    auto it = files.find(path);
+    return it == files.end() ? 0 : it->second.version;
+}
+
+std::vector<std::string> FileSystemMemory::get_overlay_files(const std::string& p_prefix) const {
+    std::string prefix = normalize_path(p_prefix);
+    std::vector<std::string> result;
+    std::shared_lock<std::shared_mutex> guard(lock);
+    for (const auto& entry : files) {
+        if (!entry.second.deleted && entry.first.compare(0, prefix.size(), prefix) == 0) {
+            result.push_back(entry.first);
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+int FileSystemMemory::add_change_listener(ChangeListener p_listener) {
+    std::lock_guard<std::mutex> guard(listener_mutex);
+    int id = next_listener_id++;
+    listeners.emplace_back(id, std::move(p_listener));
+    return id;
+}
+
+void FileSystemMemory::remove_change_listener(int p_id) {
+    std::lock_guard<std::mutex> guard(listener_mutex);
+    for (size_t i = 0; i < listeners.size(); i++) {
+        if (listeners[i].first == p_id) {
+            listeners.erase(listeners.begin() + i);
+            return;
+        }
+    }
+}
+
+FileSystemMemory::Stats FileSystemMemory::get_stats() const {
+    Stats stats;
+    stats.overlay_hits = overlay_hits.load(std::memory_order_relaxed);
+    stats.pack_reads = pack_reads.load(std::memory_order_relaxed);
+    stats.disk_reads = disk_reads.load(std::memory_order_relaxed);
+    stats.misses = misses.load(std::memory_order_relaxed);
+    return stats;
+}
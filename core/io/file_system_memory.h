@@ -0,0 +1,178 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef FILE_SYSTEM_MEMORY_H
+#define FILE_SYSTEM_MEMORY_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "core/error/error_list.h"
+#include "core/object/ref_counted.h"
+#include "core/templates/delegate.h"
+#include "core/templates/span.h"
+
+class FileSystemPack;
+
+/**
+ * @class MemoryBuffer
+ * @brief Immutable, reference-counted file contents.
+ *
+ * Either owns its bytes or borrows a view kept alive by another object (a
+ * mounted PackFile), so files read from a pack are shared without a copy.
+ * Contents never change once created: a write replaces the buffer, and
+ * anyone still holding the old one keeps a consistent snapshot.
+ */
+class MemoryBuffer : public RefCounted {
+    std::vector<uint8_t> owned;
+    Span<const uint8_t> view;
+    Ref<RefCounted> owner;
+
+public:
+    MemoryBuffer() {}
+    explicit MemoryBuffer(std::vector<uint8_t> p_data) : owned(std::move(p_data)), view(owned) {}
+    MemoryBuffer(Span<const uint8_t> p_view, const Ref<RefCounted>& p_owner) : view(p_view), owner(p_owner) {}
+
+    Span<const uint8_t> get_data() const { return view; }
+    size_t size() const { return view.size(); }
+    bool is_borrowed() const { return owner.is_valid(); }
+};
+
+/**
+ * @class FileSystemMemory
+ * @brief In-memory overlay over disk directories and mounted packs.
+ *
+ * Files written here live in RAM and shadow whatever is below them; the
+ * lower layers are never modified. A read resolves, in order:
+ *   1. the overlay (written, copied or deleted files),
+ *   2. the longest mount whose prefix matches: a disk directory, or the
+ *      FileSystemPack stack,
+ * and misses if nothing matches. With no mounts at all the filesystem is
+ * purely in memory, which gives tests and benchmarks I/O-free timings.
+ *
+ * Copy-on-write: copy_file() shares the source buffer, and append_file()
+ * or write_file() always build a new buffer, so a MemoryBuffer handed out
+ * earlier is never modified. Deleting a file that exists below leaves a
+ * whiteout that hides it until revert_file().
+ *
+ * Every change bumps the file's version and calls the change listeners,
+ * which is how hot reload finds out. Reads may run on any thread
+ * concurrently with each other and with writes.
+ */
+class FileSystemMemory {
+public:
+    typedef Delegate<void(const std::string&)> ChangeListener;
+
+    struct Stats {
+        uint64_t overlay_hits = 0;
+        uint64_t pack_reads = 0;
+        uint64_t disk_reads = 0;
+        uint64_t misses = 0;
+    };
+
+private:
+    struct Node {
+        Ref<MemoryBuffer> buffer;
+        bool deleted = false; ///< Whiteout, hides lower layers.
+        uint64_t version = 0;
+    };
+
+    struct Mount {
+        std::string prefix;
+        std::string directory; ///< Disk root, empty for packs.
+        FileSystemPack* packs = nullptr;
+    };
+
+    static FileSystemMemory* singleton;
+
+    mutable std::shared_mutex lock;
+    std::unordered_map<std::string, Node> files;
+    std::vector<Mount> mounts; ///< Longest prefix first.
+    uint64_t next_version = 1;
+
+    std::mutex listener_mutex;
+    std::vector<std::pair<int, ChangeListener>> listeners;
+    int next_listener_id = 1;
+
+    mutable std::atomic<uint64_t> overlay_hits{ 0 };
+    mutable std::atomic<uint64_t> pack_reads{ 0 };
+    mutable std::atomic<uint64_t> disk_reads{ 0 };
+    mutable std::atomic<uint64_t> misses{ 0 };
+
+    const Mount* _find_mount(const std::string& p_path, std::string& r_relative) const;
+    Error _read_lower(const std::string& p_path, Ref<MemoryBuffer>& r_buffer) const;
+    bool _has_lower(const std::string& p_path) const;
+    void _set(const std::string& p_path, const Ref<MemoryBuffer>& p_buffer, bool p_deleted);
+    void _notify(const std::string& p_path);
+
+public:
+    static FileSystemMemory* get_singleton() { return singleton; }
+
+    /** "res://a\\b/./c" -> "res://a/b/c". Keys and mount prefixes use this form. */
+    static std::string normalize_path(std::string_view p_path);
+
+    FileSystemMemory();
+    ~FileSystemMemory();
+
+    /** @brief Serves p_prefix from a disk directory: "res://" -> "/game/data". */
+    void mount_directory(const std::string& p_prefix, const std::string& p_directory);
+    /** @brief Serves p_prefix from the pack stack, without copying file data. */
+    void mount_packs(const std::string& p_prefix, FileSystemPack* p_packs);
+    bool unmount(const std::string& p_prefix);
+
+    Error write_file(const std::string& p_path, std::vector<uint8_t> p_data);
+    Error write_file(const std::string& p_path, const Ref<MemoryBuffer>& p_buffer);
+    /** @brief Appends to the current contents, copying them up from disk or a pack if needed. */
+    Error append_file(const std::string& p_path, Span<const uint8_t> p_data);
+    /** @brief p_to shares p_from's buffer until either is written. */
+    Error copy_file(const std::string& p_from, const std::string& p_to);
+    /** @brief Removes the file from the overlay and hides any lower copy. */
+    Error remove_file(const std::string& p_path);
+    /** @brief Drops the overlay entry, so the lower layer shows again. */
+    bool revert_file(const std::string& p_path);
+    /** @brief Drops every overlay entry. */
+    void clear();
+
+    bool has_file(const std::string& p_path) const;
+    /** @return ERR_FILE_NOT_FOUND, or the disk error. */
+    Error read_file(const std::string& p_path, Ref<MemoryBuffer>& r_buffer) const;
+    /** @brief True if the path is served by the overlay (written or deleted). */
+    bool is_overridden(const std::string& p_path) const;
+    /** @brief Bumped on every change to the path, 0 if it never changed. */
+    uint64_t get_version(const std::string& p_path) const;
+    /** @brief Files written to the overlay, optionally below p_prefix. */
+    std::vector<std::string> get_overlay_files(const std::string& p_prefix = "") const;
+
+    int add_change_listener(ChangeListener p_listener);
+    void remove_change_listener(int p_id);
+
+    Stats get_stats() const;
+};
+
+#endif // FILE_SYSTEM_MEMORY_H
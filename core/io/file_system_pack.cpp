@@ -0,0 +1,536 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "core/io/file_system_pack.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <map>
+
+static_assert(sizeof(PackFile::Header) == 64, "Pack header layout changed.");
+static_assert(sizeof(PackFile::Slot) == 32, "Pack slot layout changed.");
+
+static bool _is_normalized(std::string_view p_path) {
+    if (p_path.empty() || p_path[0] == '/' || p_path.compare(0, 2, "./") == 0 || p_path.compare(0, 6, "res://") == 0) {
+        return false;
+    }
+    return p_path.find('\\') == std::string_view::npos;
+}
+
+static uint64_t _align(uint64_t p_value) {
+    return (p_value + PackFile::DATA_ALIGNMENT - 1) & ~(PackFile::DATA_ALIGNMENT - 1);
+}
+
+uint64_t PackFile::hash_path(std::string_view p_path) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (char c : p_path) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3ull;
+    }
+    return hash ? hash : 1;
+}
+
+std::string PackFile::normalize_path(std::string_view p_path) {
+    if (p_path.compare(0, 6, "res://") == 0) {
+        p_path.remove_prefix(6);
+    }
+    std::string result(p_path);
+    std::replace(result.begin(), result.end(), '\\', '/');
+    size_t start = 0;
+    while (start < result.size()) {
+        if (result[start] == '/') {
+            start++;
+        } else if (result.compare(start, 2, "./") == 0) {
+            start += 2;
+        } else {
+            break;
+        }
+    }
+    return result.substr(start);
+}
+
+PackFile::~PackFile() {
+    close();
+}
+
+Error PackFile::open(const std::string& p_path) {
+    close();
+
+    Ref<FileAccess> fa;
+    fa.instantiate();
+    if (!fa->open(p_path, FileAccess::READ_MMAP)) {
+        return ERR_FILE_CANT_OPEN;
+    }
+    Span<const uint8_t> map = fa->get_mapped_data();
+    if (map.size() < sizeof(Header)) {
+        return ERR_FILE_UNRECOGNIZED;
+    }
+
+    Header header;
+    std::memcpy(&header, map.data(), sizeof(header));
+    if (header.magic != MAGIC || header.version != VERSION) {
+        return ERR_FILE_UNRECOGNIZED;
+    }
+
+    // Everything a lookup touches without further checks is validated here;
+    // per-slot ranges are checked when the slot is used.
+    uint64_t size = map.size();
+    bool valid = header.slot_count != 0 && (header.slot_count & (header.slot_count - 1)) == 0;
+    valid = valid && header.file_count <= header.slot_count;
+    valid = valid && header.slots_offset % alignof(Slot) == 0 && header.slots_offset <= size;
+    valid = valid && uint64_t(header.slot_count) * sizeof(Slot) <= size - header.slots_offset;
+    valid = valid && header.paths_offset <= size && header.paths_size <= size - header.paths_offset;
+    valid = valid && header.data_offset <= size && header.data_size <= size - header.data_offset;
+    if (!valid) {
+        return ERR_FILE_CORRUPT;
+    }
+
+    path = p_path;
+    file = fa;
+    base = map.data();
+    length = size;
+    slots = reinterpret_cast<const Slot*>(base + header.slots_offset);
+    slot_mask = header.slot_count - 1;
+    file_count = header.file_count;
+    paths = reinterpret_cast<const char*>(base + header.paths_offset);
+    paths_size = header.paths_size;
+    return OK;
+}
+
+void PackFile::close() {
+    if (file.is_valid()) {
+        file->close();
+        file.unref();
+    }
+    base = nullptr;
+    length = 0;
+    slots = nullptr;
+    slot_mask = 0;
+    file_count = 0;
+    paths = nullptr;
+    paths_size = 0;
+}
+
+const PackFile::Slot* PackFile::_find(std::string_view p_normalized) const {
+    if (!base) {
+        return nullptr;
+    }
+    uint64_t hash = hash_path(p_normalized);
+    uint32_t index = static_cast<uint32_t>(hash) & slot_mask;
+    for (uint32_t probe = 0; probe <= slot_mask; probe++) {
+        const Slot& slot = slots[index];
+        if (slot.hash == 0) {
+            return nullptr;
+        }
+        if (slot.hash == hash && slot.path_length == p_normalized.size() && uint64_t(slot.path_offset) + slot.path_length <= paths_size
+                && std::memcmp(paths + slot.path_offset, p_normalized.data(), p_normalized.size()) == 0) {
+            return &slot;
+        }
+        index = (index + 1) & slot_mask;
+    }
+    return nullptr;
+}
+
+PackFile::LookupResult PackFile::lookup(std::string_view p_path, Span<const uint8_t>& r_data) const {
+    const Slot* slot;
+    if (_is_normalized(p_path)) {
+        slot = _find(p_path);
+    } else {
+        slot = _find(normalize_path(p_path));
+    }
+    if (!slot) {
+        return LOOKUP_MISSING;
+    }
+    if (slot->flags & SLOT_DELETED) {
+        return LOOKUP_DELETED;
+    }
+    if (slot->size > length || slot->offset > length - slot->size) {
+        return LOOKUP_MISSING; // Truncated pack.
+    }
+    r_data = Span<const uint8_t>(base + slot->offset, static_cast<size_t>(slot->size));
+    return LOOKUP_FOUND;
+}
+
+bool PackFile::has_file(std::string_view p_path) const {
+    Span<const uint8_t> data;
+    return lookup(p_path, data) == LOOKUP_FOUND;
+}
+
+bool PackFile::get_file(std::string_view p_path, Span<const uint8_t>& r_data) const {
+    return lookup(p_path, r_data) == LOOKUP_FOUND;
+}
+
+static std::vector<std::string> _list_slots(const PackFile::Slot* p_slots, uint32_t p_count, const char* p_paths, uint64_t p_paths_size, bool p_deleted) {
+    std::vector<std::string> result;
+    for (uint32_t i = 0; i < p_count; i++) {
+        const PackFile::Slot& slot = p_slots[i];
+        if (slot.hash == 0 || bool(slot.flags & PackFile::SLOT_DELETED) != p_deleted) {
+            continue;
+        }
+        if (uint64_t(slot.path_offset) + slot.path_length <= p_paths_size) {
+            result.emplace_back(p_paths + slot.path_offset, slot.path_length);
+        }
+    }
+    return result;
+}
+
+std::vector<std::string> PackFile::get_file_list() const {
+    return base ? _list_slots(slots, slot_mask + 1, paths, paths_size, false) : std::vector<std::string>();
+}
+
+std::vector<std::string> PackFile::get_deleted_list() const {
+    return base ? _list_slots(slots, slot_mask + 1, paths, paths_size, true) : std::vector<std::string>();
+}
+
+FileSystemPack* FileSystemPack::singleton = nullptr;
+
+FileSystemPack::FileSystemPack() {
+    if (!singleton) {
+        singleton = this;
+    }
+}
+
+FileSystemPack::~FileSystemPack() {
+    unmount_all();
+    if (singleton == this) {
+        singleton = nullptr;
+    }
+}
+
+Error FileSystemPack::mount(const std::string& p_path) {
+    Ref<PackFile> pack;
+    pack.instantiate();
+    Error err = pack->open(p_path);
+    if (err != OK) {
+        return err;
+    }
+    packs.push_back(pack);
+    return OK;
+}
+
+bool FileSystemPack::unmount(const std::string& p_path) {
+    for (size_t i = packs.size(); i-- > 0;) {
+        if (packs[i]->get_path() == p_path) {
+            packs.erase(packs.begin() + i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void FileSystemPack::unmount_all() {
+    packs.clear();
+}
+
+Ref<PackFile> FileSystemPack::get_pack(int p_index) const {
+    if (p_index < 0 || p_index >= get_pack_count()) {
+        return Ref<PackFile>();
+    }
+    return packs[p_index];
+}
+
+Ref<PackFile> FileSystemPack::find_pack(std::string_view p_path) const {
+    std::string normalized;
+    if (!_is_normalized(p_path)) {
+        normalized = PackFile::normalize_path(p_path);
+        p_path = normalized;
+    }
+    Span<const uint8_t> data;
+    for (size_t i = packs.size(); i-- > 0;) {
+        PackFile::LookupResult result = packs[i]->lookup(p_path, data);
+        if (result == PackFile::LOOKUP_FOUND) {
+            return packs[i];
+        }
+        if (result == PackFile::LOOKUP_DELETED) {
+            break;
+        }
+    }
+    return Ref<PackFile>();
+}
+
+bool FileSystemPack::has_file(std::string_view p_path) const {
+    Span<const uint8_t> data;
+    return get_file(p_path, data);
+}
+
+bool FileSystemPack::get_file(std::string_view p_path, Span<const uint8_t>& r_data) const {
+    std::string normalized;
+    if (!_is_normalized(p_path)) {
+        normalized = PackFile::normalize_path(p_path);
+        p_path = normalized;
+    }
+    for (size_t i = packs.size(); i-- > 0;) {
+        PackFile::LookupResult result = packs[i]->lookup(p_path, r_data);
+        if (result == PackFile::LOOKUP_FOUND) {
+            return true;
+        }
+        if (result == PackFile::LOOKUP_DELETED) {
+            return false;
+        }
+    }
+    return false;
+}
+
+std::vector<std::string> FileSystemPack::get_file_list() const {
+    std::map<std::string, bool> visible;
+    for (const Ref<PackFile>& pack : packs) {
+        for (std::string& path : pack->get_deleted_list()) {
+            visible.erase(path);
+        }
+        for (std::string& path : pack->get_file_list()) {
+            visible[std::move(path)] = true;
+        }
+    }
+    std::vector<std::string> result;
+    result.reserve(visible.size());
+    for (const auto& entry : visible) {
+        result.push_back(entry.first);
+    }
+    return result;
+}
+
+PackWriter::Entry& PackWriter::_add(const std::string& p_path) {
+    auto it = index.find(p_path);
+    if (it != index.end()) {
+        Entry& entry = entries[it->second];
+        entry = Entry();
+        entry.path = p_path;
+        return entry;
+    }
+    index[p_path] = entries.size();
+    entries.emplace_back();
+    entries.back().path = p_path;
+    return entries.back();
+}
+
+static bool _valid_pack_path(const std::string& p_path) {
+    return !p_path.empty() && p_path.size() <= 0xFFFF;
+}
+
+Error PackWriter::add_file(const std::string& p_pack_path, const std::string& p_source) {
+    std::string path = PackFile::normalize_path(p_pack_path);
+    if (!_valid_pack_path(path)) {
+        return ERR_INVALID_PARAMETER;
+    }
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(p_source, ec)) {
+        return ERR_FILE_NOT_FOUND;
+    }
+    _add(path).source = p_source;
+    return OK;
+}
+
+Error PackWriter::add_buffer(const std::string& p_pack_path, std::vector<uint8_t> p_data) {
+    std::string path = PackFile::normalize_path(p_pack_path);
+    if (!_valid_pack_path(path)) {
+        return ERR_INVALID_PARAMETER;
+    }
+    _add(path).data = std::move(p_data);
+    return OK;
+}
+
+Error PackWriter::add_deletion(const std::string& p_pack_path) {
+    std::string path = PackFile::normalize_path(p_pack_path);
+    if (!_valid_pack_path(path)) {
+        return ERR_INVALID_PARAMETER;
+    }
+    _add(path).deleted = true;
+    return OK;
+}
+
+Error PackWriter::add_directory(const std::string& p_directory, const std::string& p_prefix) {
+    std::error_code ec;
+    std::filesystem::recursive_directory_iterator it(p_directory, ec);
+    if (ec) {
+        return ERR_FILE_BAD_PATH;
+    }
+    // Sorted so the same tree always produces the same pack.
+    std::vector<std::filesystem::path> files;
+    for (const std::filesystem::directory_entry& entry : it) {
+        if (entry.is_regular_file(ec)) {
+            files.push_back(entry.path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    std::string prefix = p_prefix;
+    if (!prefix.empty() && prefix.back() != '/') {
+        prefix += '/';
+    }
+    for (const std::filesystem::path& source : files) {
+        std::string relative = std::filesystem::relative(source, p_directory, ec).generic_string();
+        Error err = add_file(prefix + relative, source.string());
+        if (err != OK) {
+            return err;
+        }
+    }
+    return OK;
+}
+
+void PackWriter::clear() {
+    entries.clear();
+    index.clear();
+}
+
+Error PackWriter::save(const std::string& p_path) {
+    uint64_t count = entries.size();
+    if (count > 0x7FFFFFFF) {
+        return ERR_INVALID_PARAMETER;
+    }
+    uint32_t slot_count = 1;
+    while (slot_count < count * 2) {
+        slot_count <<= 1;
+    }
+
+    std::string path_table;
+    std::vector<uint64_t> sizes(count, 0);
+    for (size_t i = 0; i < count; i++) {
+        const Entry& entry = entries[i];
+        path_table += entry.path;
+        if (entry.deleted) {
+            continue;
+        }
+        if (entry.source.empty()) {
+            sizes[i] = entry.data.size();
+        } else {
+            std::error_code ec;
+            sizes[i] = std::filesystem::file_size(entry.source, ec);
+            if (ec) {
+                return ERR_FILE_CANT_READ;
+            }
+        }
+    }
+    if (path_table.size() > 0xFFFFFFFFull) {
+        return ERR_INVALID_PARAMETER;
+    }
+
+    PackFile::Header header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = PackFile::MAGIC;
+    header.version = PackFile::VERSION;
+    header.file_count = static_cast<uint32_t>(count);
+    header.slot_count = slot_count;
+    header.slots_offset = sizeof(PackFile::Header);
+    header.paths_offset = header.slots_offset + uint64_t(slot_count) * sizeof(PackFile::Slot);
+    header.paths_size = path_table.size();
+    header.data_offset = _align(header.paths_offset + header.paths_size);
+
+    std::vector<PackFile::Slot> slots(slot_count);
+    std::memset(slots.data(), 0, slots.size() * sizeof(PackFile::Slot));
+    std::vector<uint64_t> offsets(count, 0);
+    uint64_t cursor = header.data_offset;
+    uint64_t data_end = header.data_offset;
+    uint32_t path_offset = 0;
+    for (size_t i = 0; i < count; i++) {
+        const Entry& entry = entries[i];
+        if (!entry.deleted) {
+            offsets[i] = cursor;
+            data_end = cursor + sizes[i];
+            cursor = _align(data_end);
+        }
+
+        uint64_t hash = PackFile::hash_path(entry.path);
+        uint32_t slot_index = static_cast<uint32_t>(hash) & (slot_count - 1);
+        while (slots[slot_index].hash != 0) {
+            slot_index = (slot_index + 1) & (slot_count - 1);
+        }
+        PackFile::Slot& slot = slots[slot_index];
+        slot.hash = hash;
+        slot.offset = offsets[i];
+        slot.size = sizes[i];
+        slot.path_offset = path_offset;
+        slot.path_length = static_cast<uint16_t>(entry.path.size());
+        slot.flags = entry.deleted ? PackFile::SLOT_DELETED : 0;
+        path_offset += static_cast<uint32_t>(entry.path.size());
+    }
+    header.data_size = data_end - header.data_offset;
+
+    // Written next to the target and renamed, so a pack that is mounted
+    // (mapped) while being rebuilt is never seen half written.
+    std::string temp_path = p_path + ".tmp";
+    FileAccess out;
+    if (!out.open(temp_path, FileAccess::WRITE)) {
+        return ERR_FILE_CANT_OPEN;
+    }
+
+    static const uint8_t zeros[PackFile::DATA_ALIGNMENT] = {};
+    auto pad_to = [&](uint64_t p_offset) {
+        bool ok = true;
+        while (ok && out.get_position() < p_offset) {
+            ok = out.store_buffer(Span<const uint8_t>(zeros, std::min<uint64_t>(sizeof(zeros), p_offset - out.get_position())));
+        }
+        return ok;
+    };
+
+    bool ok = out.store_buffer(Span<const uint8_t>(reinterpret_cast<const uint8_t*>(&header), sizeof(header)));
+    ok = ok && out.store_buffer(Span<const uint8_t>(reinterpret_cast<const uint8_t*>(slots.data()), slots.size() * sizeof(PackFile::Slot)));
+    ok = ok && out.store_buffer(path_table.data(), path_table.size());
+
+    std::vector<uint8_t> chunk;
+    for (size_t i = 0; ok && i < count; i++) {
+        const Entry& entry = entries[i];
+        if (entry.deleted) {
+            continue;
+        }
+        ok = pad_to(offsets[i]);
+        if (!ok) {
+            break;
+        }
+        if (entry.source.empty()) {
+            ok = out.store_buffer(Span<const uint8_t>(entry.data));
+            continue;
+        }
+
+        FileAccess in;
+        if (!in.open(entry.source, FileAccess::READ)) {
+            out.close();
+            std::remove(temp_path.c_str());
+            return ERR_FILE_CANT_READ;
+        }
+        chunk.resize(1024 * 1024);
+        uint64_t remaining = sizes[i];
+        while (ok && remaining > 0) {
+            size_t want = static_cast<size_t>(std::min<uint64_t>(remaining, chunk.size()));
+            size_t got = in.get_buffer(chunk.data(), want);
+            // The file changed size since save() measured it.
+            ok = got == want && out.store_buffer(Span<const uint8_t>(chunk.data(), got));
+            remaining -= got;
+        }
+        ok = ok && in.get_buffer(chunk.data(), 1) == 0;
+    }
+    out.close();
+
+    if (!ok) {
+        std::remove(temp_path.c_str());
+        return ERR_FILE_CANT_WRITE;
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp_path, p_path, ec);
+    if (ec) {
+        std::remove(temp_path.c_str());
+        return ERR_FILE_CANT_WRITE;
+    }
+    return OK;
+}
@@ -0,0 +1,206 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef FILE_SYSTEM_PACK_H
+#define FILE_SYSTEM_PACK_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "core/error/error_list.h"
+#include "core/io/file_access.h"
+#include "core/object/ref_counted.h"
+#include "core/templates/span.h"
+
+/**
+ * @class PackFile
+ * @brief Read-only, memory-mapped pack of many files.
+ *
+ * Layout, all integers little-endian:
+ *   Header   64 bytes
+ *   Slots    slot_count * 32 bytes, an open-addressed hash table of paths
+ *   Paths    the paths, concatenated without terminators
+ *   Data     file contents, each starting on a DATA_ALIGNMENT boundary
+ *
+ * The slot table is read straight from the mapping: a lookup hashes the
+ * path, probes linearly (load factor <= 0.5) and compares bytes in place,
+ * so it costs no system call and no allocation. get_file() returns a view
+ * into the mapping, valid until the pack is closed. Data is page aligned so
+ * a file can be handed to the GPU or decoder without being copied first.
+ */
+class PackFile : public RefCounted {
+public:
+    static constexpr uint32_t MAGIC = 0x4B505350; // "PSPK"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint64_t DATA_ALIGNMENT = 4096;
+
+    enum SlotFlags {
+        SLOT_DELETED = 1, ///< The path is removed, hides it in packs mounted earlier.
+    };
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t file_count;
+        uint32_t slot_count; ///< Power of two.
+        uint64_t slots_offset;
+        uint64_t paths_offset;
+        uint64_t paths_size;
+        uint64_t data_offset;
+        uint64_t data_size;
+        uint64_t reserved;
+    };
+
+    struct Slot {
+        uint64_t hash; ///< hash_path() of the normalized path, 0 for an empty slot.
+        uint64_t offset; ///< From the start of the pack.
+        uint64_t size;
+        uint32_t path_offset; ///< Into the path table.
+        uint16_t path_length;
+        uint16_t flags;
+    };
+
+    enum LookupResult {
+        LOOKUP_MISSING,
+        LOOKUP_FOUND,
+        LOOKUP_DELETED,
+    };
+
+private:
+    std::string path;
+    Ref<FileAccess> file;
+    const uint8_t* base = nullptr;
+    uint64_t length = 0;
+    const Slot* slots = nullptr;
+    uint32_t slot_mask = 0;
+    uint32_t file_count = 0;
+    const char* paths = nullptr;
+    uint64_t paths_size = 0;
+
+    const Slot* _find(std::string_view p_normalized) const;
+
+public:
+    /** FNV-1a, never 0 so 0 can mark empty slots. */
+    static uint64_t hash_path(std::string_view p_path);
+    /** Strips "res://", leading "/" and "./", and turns '\' into '/'. */
+    static std::string normalize_path(std::string_view p_path);
+
+    PackFile() {}
+    ~PackFile();
+
+    /** @return ERR_FILE_CANT_OPEN, ERR_FILE_UNRECOGNIZED or ERR_FILE_CORRUPT on failure. */
+    Error open(const std::string& p_path);
+    void close();
+    bool is_open() const { return base != nullptr; }
+    const std::string& get_path() const { return path; }
+    uint32_t get_file_count() const { return file_count; }
+
+    /** @brief Finds a path. r_data is set for LOOKUP_FOUND. */
+    LookupResult lookup(std::string_view p_path, Span<const uint8_t>& r_data) const;
+    bool has_file(std::string_view p_path) const;
+    bool get_file(std::string_view p_path, Span<const uint8_t>& r_data) const;
+    /** @brief Paths stored in the pack, deletion markers excluded. */
+    std::vector<std::string> get_file_list() const;
+    /** @brief Paths this pack marks deleted. */
+    std::vector<std::string> get_deleted_list() const;
+};
+
+/**
+ * @class FileSystemPack
+ * @brief Stack of mounted packs.
+ *
+ * Packs mounted later take precedence, so a patch pack mounted on top of
+ * the base pack replaces files, adds new ones, and hides files through
+ * deletion markers. Lookups walk the stack from the top, each level being
+ * a single hash probe.
+ *
+ * Mount and unmount during startup or loading screens: lookups are safe
+ * from any thread, but not concurrently with a mount change, and spans
+ * from an unmounted pack dangle.
+ */
+class FileSystemPack {
+    static FileSystemPack* singleton;
+
+    std::vector<Ref<PackFile>> packs;
+
+public:
+    static FileSystemPack* get_singleton() { return singleton; }
+
+    FileSystemPack();
+    ~FileSystemPack();
+
+    Error mount(const std::string& p_path);
+    bool unmount(const std::string& p_path);
+    void unmount_all();
+
+    int get_pack_count() const { return static_cast<int>(packs.size()); }
+    Ref<PackFile> get_pack(int p_index) const;
+
+    bool has_file(std::string_view p_path) const;
+    /** @brief Contents of the topmost version of p_path. */
+    bool get_file(std::string_view p_path, Span<const uint8_t>& r_data) const;
+    /** @brief The pack p_path resolves to, null if missing or deleted. */
+    Ref<PackFile> find_pack(std::string_view p_path) const;
+    /** @brief Every visible path across the stack, sorted. */
+    std::vector<std::string> get_file_list() const;
+};
+
+/**
+ * @class PackWriter
+ * @brief Builds a pack. Used by the patsher_pack tool and the exporter.
+ *
+ * Adding a path twice keeps the last one. Source files are only read by
+ * save(), which streams them into the pack.
+ */
+class PackWriter {
+    struct Entry {
+        std::string path;
+        std::string source; ///< File to copy, empty if data is used.
+        std::vector<uint8_t> data;
+        bool deleted = false;
+    };
+
+    std::vector<Entry> entries;
+    std::unordered_map<std::string, size_t> index;
+
+    Entry& _add(const std::string& p_path);
+
+public:
+    /** @return ERR_FILE_NOT_FOUND if p_source is not a regular file, ERR_INVALID_PARAMETER for an unusable path. */
+    Error add_file(const std::string& p_pack_path, const std::string& p_source);
+    Error add_buffer(const std::string& p_pack_path, std::vector<uint8_t> p_data);
+    /** @brief Marks p_pack_path deleted, see PackFile::SLOT_DELETED. */
+    Error add_deletion(const std::string& p_pack_path);
+    /** @brief Adds every file below p_directory, as p_prefix + relative path. */
+    Error add_directory(const std::string& p_directory, const std::string& p_prefix = "");
+
+    int get_file_count() const { return static_cast<int>(entries.size()); }
+    void clear();
+
+    Error save(const std::string& p_path);
+};
+
+#endif // FILE_SYSTEM_PACK_H
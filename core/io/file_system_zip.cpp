@@ -0,0 +1,595 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "core/io/file_system_zip.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <numeric>
+#include <thread>
+
+// Deflate cannot expand data by more than about 1032:1. A larger claim is
+// a corrupt or malicious header, refused before allocating for it.
+static bool _plausible_size(const ZipEntry& p_entry) {
+    if (p_entry.method == ZipEntry::METHOD_STORED) {
+        return p_entry.uncompressed_size == p_entry.compressed_size;
+    }
+    return p_entry.uncompressed_size <= p_entry.compressed_size * 1032 + 1024;
+}
+
+// Runs p_work(i) for i in [0, p_count) on up to p_threads threads, biggest
+// items first so one large entry does not finish last. Returns the first error.
+template <typename F>
+static Error _run_parallel(const std::vector<uint64_t>& p_costs, int p_threads, F&& p_work) {
+    size_t count = p_costs.size();
+    std::vector<size_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return p_costs[a] > p_costs[b]; });
+
+    size_t threads = p_threads > 0 ? size_t(p_threads) : std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, count);
+
+    std::atomic<size_t> next{ 0 };
+    std::atomic<int> first_error{ OK };
+    auto worker = [&]() {
+        for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < count; i = next.fetch_add(1, std::memory_order_relaxed)) {
+            Error err = p_work(order[i]);
+            if (err != OK) {
+                int expected = OK;
+                first_error.compare_exchange_strong(expected, err, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < threads; i++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+    return static_cast<Error>(first_error.load());
+}
+
+ZipArchive::~ZipArchive() {
+    close();
+}
+
+Error ZipArchive::open(const std::string& p_path) {
+    close();
+
+    Ref<FileAccess> fa;
+    fa.instantiate();
+    if (!fa->open(p_path, FileAccess::READ_MMAP)) {
+        return ERR_FILE_CANT_OPEN;
+    }
+    Span<const uint8_t> data = fa->get_mapped_data();
+    Error err = ZipUtils::parse_central_directory(data, entries);
+    if (err != OK) {
+        entries.clear();
+        return err;
+    }
+
+    index.reserve(entries.size());
+    for (uint32_t i = 0; i < entries.size(); i++) {
+        if (!entries[i].is_directory()) {
+            // First record wins, as with unzip.
+            index.emplace(entries[i].name, i);
+        }
+    }
+    path = p_path;
+    file = fa;
+    archive = data;
+    return OK;
+}
+
+void ZipArchive::close() {
+    index.clear();
+    entries.clear();
+    archive = Span<const uint8_t>();
+    if (file.is_valid()) {
+        file->close();
+        file.unref();
+    }
+    path.clear();
+}
+
+const ZipEntry* ZipArchive::find_entry(std::string_view p_path) const {
+    auto it = index.find(p_path);
+    return it == index.end() ? nullptr : &entries[it->second];
+}
+
+std::vector<std::string> ZipArchive::get_file_list() const {
+    std::vector<std::string> result;
+    result.reserve(index.size());
+    for (const ZipEntry& entry : entries) {
+        if (!entry.is_directory()) {
+            result.emplace_back(entry.name);
+        }
+    }
+    return result;
+}
+
+Error ZipArchive::get_entry_data(const ZipEntry& p_entry, Span<const uint8_t>& r_data) const {
+    return ZipUtils::get_entry_data(archive, p_entry, r_data);
+}
+
+Error ZipArchive::get_stored_data(std::string_view p_path, Span<const uint8_t>& r_data) const {
+    const ZipEntry* entry = find_entry(p_path);
+    if (!entry) {
+        return ERR_FILE_NOT_FOUND;
+    }
+    if (entry->method != ZipEntry::METHOD_STORED || entry->is_encrypted()) {
+        return ERR_UNAVAILABLE;
+    }
+    return get_entry_data(*entry, r_data);
+}
+
+Error ZipArchive::read_entry(const ZipEntry& p_entry, std::vector<uint8_t>& r_data) const {
+    r_data.clear();
+    if (!p_entry.is_supported()) {
+        return ERR_UNAVAILABLE;
+    }
+    Span<const uint8_t> source;
+    Error err = get_entry_data(p_entry, source);
+    if (err != OK) {
+        return err;
+    }
+    if (!_plausible_size(p_entry)) {
+        return ERR_FILE_CORRUPT;
+    }
+
+    r_data.resize(static_cast<size_t>(p_entry.uncompressed_size));
+    uint32_t crc = 0;
+    if (p_entry.method == ZipEntry::METHOD_STORED) {
+        if (!source.is_empty()) {
+            std::memcpy(r_data.data(), source.data(), source.size());
+            crc = ZipUtils::crc32(0, r_data.data(), r_data.size());
+        }
+    } else {
+        z_stream stream;
+        std::memset(&stream, 0, sizeof(stream));
+        if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+            r_data.clear();
+            return ERR_OUT_OF_MEMORY;
+        }
+        // Output is handed to zlib in small slices and checksummed right
+        // after each one, while it is still in cache. Input is fed at most
+        // 1 GiB at a time, zlib counts in uInt. Both sides are refilled
+        // before every call, so anything but Z_OK or Z_STREAM_END means
+        // truncated or excess data.
+        const size_t in_chunk = 1u << 30;
+        const size_t out_chunk = 256 * 1024;
+        uint8_t empty;
+        stream.next_out = r_data.empty() ? &empty : r_data.data();
+        size_t in_pos = 0;
+        size_t out_pos = 0;
+        int ret;
+        do {
+            if (stream.avail_in == 0 && in_pos < source.size()) {
+                stream.next_in = const_cast<Bytef*>(source.data() + in_pos);
+                stream.avail_in = static_cast<uInt>(std::min(in_chunk, source.size() - in_pos));
+                in_pos += stream.avail_in;
+            }
+            if (stream.avail_out == 0 && out_pos < r_data.size()) {
+                stream.next_out = r_data.data() + out_pos;
+                stream.avail_out = static_cast<uInt>(std::min(out_chunk, r_data.size() - out_pos));
+                out_pos += stream.avail_out;
+            }
+            uint8_t* slice = stream.next_out;
+            ret = inflate(&stream, Z_NO_FLUSH);
+            crc = ZipUtils::crc32(crc, slice, stream.next_out - slice);
+        } while (ret == Z_OK);
+        uint64_t produced = stream.total_out;
+        inflateEnd(&stream);
+        if (ret != Z_STREAM_END || produced != p_entry.uncompressed_size) {
+            r_data.clear();
+            return ERR_FILE_CORRUPT;
+        }
+    }
+
+    if (crc != p_entry.crc32) {
+        r_data.clear();
+        return ERR_FILE_CORRUPT;
+    }
+    return OK;
+}
+
+Error ZipArchive::read_file(std::string_view p_path, std::vector<uint8_t>& r_data) const {
+    const ZipEntry* entry = find_entry(p_path);
+    if (!entry) {
+        r_data.clear();
+        return ERR_FILE_NOT_FOUND;
+    }
+    return read_entry(*entry, r_data);
+}
+
+Error ZipArchive::read_files(const std::vector<std::string>& p_paths, std::vector<std::vector<uint8_t>>& r_data, int p_threads) const {
+    r_data.clear();
+    r_data.resize(p_paths.size());
+    std::vector<const ZipEntry*> found(p_paths.size());
+    std::vector<uint64_t> costs(p_paths.size(), 0);
+    for (size_t i = 0; i < p_paths.size(); i++) {
+        found[i] = find_entry(p_paths[i]);
+        costs[i] = found[i] ? found[i]->uncompressed_size : 0;
+    }
+    return _run_parallel(costs, p_threads, [&](size_t i) {
+        return found[i] ? read_entry(*found[i], r_data[i]) : ERR_FILE_NOT_FOUND;
+    });
+}
+
+static bool _is_safe_name(std::string_view p_name) {
+    if (p_name.empty() || p_name[0] == '/' || p_name[0] == '\\' || p_name.find(':') != std::string_view::npos) {
+        return false;
+    }
+    size_t start = 0;
+    while (start <= p_name.size()) {
+        size_t end = p_name.find_first_of("/\\", start);
+        if (end == std::string_view::npos) {
+            end = p_name.size();
+        }
+        if (p_name.substr(start, end - start) == "..") {
+            return false;
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+Error ZipArchive::extract_all(const std::string& p_directory, int p_threads) const {
+    namespace fs = std::filesystem;
+    std::vector<const ZipEntry*> files;
+    std::vector<uint64_t> costs;
+    Error result = OK;
+
+    // Directories are created up front, serially, so the workers only write.
+    std::error_code ec;
+    fs::create_directories(p_directory, ec);
+    for (const ZipEntry& entry : entries) {
+        if (!_is_safe_name(entry.name)) {
+            result = ERR_FILE_BAD_PATH;
+            continue;
+        }
+        fs::path target = fs::path(p_directory) / fs::path(std::string(entry.name));
+        if (entry.is_directory()) {
+            fs::create_directories(target, ec);
+            continue;
+        }
+        fs::create_directories(target.parent_path(), ec);
+        files.push_back(&entry);
+        costs.push_back(entry.uncompressed_size);
+    }
+
+    Error err = _run_parallel(costs, p_threads, [&](size_t i) {
+        const ZipEntry& entry = *files[i];
+        std::string target = (fs::path(p_directory) / fs::path(std::string(entry.name))).string();
+        Span<const uint8_t> data;
+        std::vector<uint8_t> inflated;
+        Error entry_err;
+        if (entry.method == ZipEntry::METHOD_STORED && !entry.is_encrypted()) {
+            entry_err = get_entry_data(entry, data); // Written straight from the mapping.
+            if (entry_err == OK && ZipUtils::crc32(0, data.data(), data.size()) != entry.crc32) {
+                entry_err = ERR_FILE_CORRUPT;
+            }
+        } else {
+            entry_err = read_entry(entry, inflated);
+            data = Span<const uint8_t>(inflated);
+        }
+        if (entry_err != OK) {
+            return entry_err;
+        }
+        FileAccess out;
+        if (!out.open(target, FileAccess::WRITE) || !out.store_buffer(data)) {
+            return ERR_FILE_CANT_WRITE;
+        }
+        out.close();
+        return OK;
+    });
+    return result != OK ? result : err;
+}
+
+ZipFileReader::~ZipFileReader() {
+    close();
+}
+
+Error ZipFileReader::open(const Ref<ZipArchive>& p_archive, std::string_view p_path) {
+    close();
+    if (p_archive.is_null()) {
+        return ERR_INVALID_PARAMETER;
+    }
+    const ZipEntry* found = p_archive->find_entry(p_path);
+    if (!found) {
+        return ERR_FILE_NOT_FOUND;
+    }
+    if (!found->is_supported()) {
+        return ERR_UNAVAILABLE;
+    }
+    Error err = p_archive->get_entry_data(*found, compressed);
+    if (err != OK) {
+        return err;
+    }
+    if (!_plausible_size(*found)) {
+        return ERR_FILE_CORRUPT;
+    }
+
+    if (found->method == ZipEntry::METHOD_DEFLATED) {
+        stream = new z_stream;
+        std::memset(stream, 0, sizeof(z_stream));
+        if (inflateInit2(stream, -MAX_WBITS) != Z_OK) {
+            delete stream;
+            stream = nullptr;
+            return ERR_OUT_OF_MEMORY;
+        }
+        buffer.reset(new uint8_t[BUFFER_SIZE]);
+    }
+    archive = p_archive;
+    entry = *found;
+    opened = true;
+    return OK;
+}
+
+void ZipFileReader::close() {
+    if (stream) {
+        inflateEnd(stream);
+        delete stream;
+        stream = nullptr;
+    }
+    buffer.reset();
+    archive.unref();
+    compressed = Span<const uint8_t>();
+    entry = ZipEntry();
+    opened = false;
+    buffer_pos = buffer_len = 0;
+    inflated = consumed = position = 0;
+    crc = 0;
+    crc_valid = true;
+    eof = false;
+    error = OK;
+}
+
+bool ZipFileReader::_restart() {
+    if (inflateReset(stream) != Z_OK) {
+        error = ERR_FILE_CORRUPT;
+        return false;
+    }
+    stream->avail_in = 0;
+    buffer_pos = buffer_len = 0;
+    inflated = consumed = 0;
+    crc = 0;
+    return true;
+}
+
+void ZipFileReader::_check_end() {
+    if (inflated == entry.uncompressed_size && crc_valid && crc != entry.crc32) {
+        error = ERR_FILE_CORRUPT;
+    }
+}
+
+size_t ZipFileReader::_inflate(uint8_t* p_dst, size_t p_length) {
+    p_length = static_cast<size_t>(std::min<uint64_t>(p_length, entry.uncompressed_size - inflated));
+    if (p_length == 0 || error != OK) {
+        return 0;
+    }
+    stream->next_out = p_dst;
+    stream->avail_out = static_cast<uInt>(std::min<size_t>(p_length, 1u << 30));
+    size_t requested = stream->avail_out;
+    while (stream->avail_out > 0) {
+        if (stream->avail_in == 0 && consumed < compressed.size()) {
+            stream->next_in = const_cast<Bytef*>(compressed.data() + consumed);
+            stream->avail_in = static_cast<uInt>(std::min<uint64_t>(compressed.size() - consumed, 1u << 30));
+            consumed += stream->avail_in;
+        }
+        int ret = inflate(stream, Z_NO_FLUSH);
+        if (ret == Z_STREAM_END) {
+            break;
+        }
+        if (ret != Z_OK) {
+            error = ERR_FILE_CORRUPT;
+            break;
+        }
+    }
+    size_t produced = requested - stream->avail_out;
+    crc = ZipUtils::crc32(crc, p_dst, produced);
+    inflated += produced;
+    if (produced < requested && error == OK) {
+        error = ERR_FILE_CORRUPT; // Stream ended before the declared size.
+    }
+    _check_end();
+    return error == OK ? produced : 0;
+}
+
+size_t ZipFileReader::get_buffer(uint8_t* p_data, size_t p_length) {
+    if (!opened || error != OK) {
+        eof = true;
+        return 0;
+    }
+    size_t wanted = p_length;
+    p_length = static_cast<size_t>(std::min<uint64_t>(p_length, entry.uncompressed_size - position));
+
+    if (!stream) {
+        if (p_length > 0) {
+            std::memcpy(p_data, compressed.data() + position, p_length);
+            if (crc_valid) {
+                crc = ZipUtils::crc32(crc, p_data, p_length);
+                inflated += p_length;
+                _check_end();
+            }
+            position += p_length;
+        }
+        if (p_length < wanted) {
+            eof = true;
+        }
+        return error == OK ? p_length : 0;
+    }
+
+    size_t done = 0;
+    while (done < p_length && error == OK) {
+        if (buffer_pos < buffer_len) {
+            size_t take = std::min(buffer_len - buffer_pos, p_length - done);
+            std::memcpy(p_data + done, buffer.get() + buffer_pos, take);
+            buffer_pos += take;
+            done += take;
+            continue;
+        }
+        size_t remaining = p_length - done;
+        if (remaining >= BUFFER_SIZE) {
+            // Large read: no point staging it in the buffer.
+            size_t got = _inflate(p_data + done, remaining);
+            buffer_pos = buffer_len = 0;
+            done += got;
+            if (got == 0) {
+                break;
+            }
+        } else {
+            buffer_len = _inflate(buffer.get(), BUFFER_SIZE);
+            buffer_pos = 0;
+            if (buffer_len == 0) {
+                break;
+            }
+        }
+    }
+    position += done;
+    if (done < wanted) {
+        eof = true;
+    }
+    return done;
+}
+
+bool ZipFileReader::seek(uint64_t p_position) {
+    if (!opened) {
+        return false;
+    }
+    eof = false;
+    if (p_position > entry.uncompressed_size) {
+        p_position = entry.uncompressed_size;
+    }
+    if (!stream) {
+        if (p_position != position) {
+            crc_valid = false;
+        }
+        position = p_position;
+        return true;
+    }
+
+    uint64_t buffer_start = inflated - buffer_len;
+    if (p_position >= buffer_start && p_position <= inflated) {
+        buffer_pos = static_cast<size_t>(p_position - buffer_start);
+        position = p_position;
+        return true;
+    }
+    if (p_position < buffer_start) {
+        if (!_restart()) {
+            return false;
+        }
+        position = 0;
+    }
+    // Inflate and discard up to the target.
+    uint8_t scratch[4096];
+    while (position < p_position && error == OK) {
+        size_t step = static_cast<size_t>(std::min<uint64_t>(sizeof(scratch), p_position - position));
+        if (get_buffer(scratch, step) != step) {
+            return false;
+        }
+    }
+    return error == OK;
+}
+
+bool ZipFileReader::_get_bytes(void* p_dst, size_t p_size) {
+    if (get_buffer(static_cast<uint8_t*>(p_dst), p_size) == p_size) {
+        return true;
+    }
+    std::memset(p_dst, 0, p_size);
+    return false;
+}
+
+uint8_t ZipFileReader::get_8() {
+    if (stream && buffer_pos < buffer_len) {
+        position++;
+        return buffer[buffer_pos++];
+    }
+    uint8_t b[1];
+    return _get_bytes(b, 1) ? b[0] : 0;
+}
+
+uint16_t ZipFileReader::get_16() {
+    uint8_t b[2];
+    return _get_bytes(b, 2) ? ZipUtils::read_16(b) : 0;
+}
+
+uint32_t ZipFileReader::get_32() {
+    uint8_t b[4];
+    return _get_bytes(b, 4) ? ZipUtils::read_32(b) : 0;
+}
+
+uint64_t ZipFileReader::get_64() {
+    uint8_t b[8];
+    return _get_bytes(b, 8) ? ZipUtils::read_64(b) : 0;
+}
+
+float ZipFileReader::get_float() {
+    uint32_t bits = get_32();
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+double ZipFileReader::get_double() {
+    uint64_t bits = get_64();
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+std::string ZipFileReader::get_line() {
+    std::string line;
+    while (position < entry.uncompressed_size && error == OK) {
+        uint8_t c = get_8();
+        if (c == '\n') {
+            break;
+        }
+        line.push_back(static_cast<char>(c));
+    }
+    if (position >= entry.uncompressed_size) {
+        eof = true;
+    }
+    if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+    }
+    return line;
+}
+
+std::string ZipFileReader::get_as_text() {
+    std::string text;
+    if (!opened || !seek(0)) {
+        return text;
+    }
+    text.resize(static_cast<size_t>(entry.uncompressed_size));
+    size_t got = get_buffer(reinterpret_cast<uint8_t*>(&text[0]), text.size());
+    text.resize(got);
+    return text;
+}
@@ -0,0 +1,179 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef FILE_SYSTEM_ZIP_H
+#define FILE_SYSTEM_ZIP_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "core/error/error_list.h"
+#include "core/io/file_access.h"
+#include "core/io/uzip_utils.h"
+#include "core/object/ref_counted.h"
+#include "core/templates/span.h"
+
+struct z_stream_s;
+
+/**
+ * @class ZipArchive
+ * @brief Read-only ZIP archive (mods, DLC).
+ *
+ * The archive is memory-mapped and its central directory parsed once on
+ * open() into a hash index, so find_entry() is a single lookup with no
+ * I/O. Entry names and stored (uncompressed) entries are views into the
+ * mapping: get_stored_data() copies nothing.
+ *
+ * read_files() and extract_all() inflate independent entries in parallel
+ * on worker threads; each entry is one deflate stream, so the work splits
+ * without coordination. For a single entry read as a stream, use
+ * ZipFileReader.
+ */
+class ZipArchive : public RefCounted {
+    std::string path;
+    Ref<FileAccess> file;
+    Span<const uint8_t> archive;
+    std::vector<ZipEntry> entries;
+    std::unordered_map<std::string_view, uint32_t> index;
+
+public:
+    ZipArchive() {}
+    ~ZipArchive();
+
+    /** @return ERR_FILE_CANT_OPEN, ERR_FILE_UNRECOGNIZED or ERR_FILE_CORRUPT on failure. */
+    Error open(const std::string& p_path);
+    void close();
+    bool is_open() const { return !archive.is_empty(); }
+    const std::string& get_path() const { return path; }
+
+    int get_entry_count() const { return static_cast<int>(entries.size()); }
+    const ZipEntry& get_entry(int p_index) const { return entries[p_index]; }
+    /** @brief Entry by exact name ("textures/a.png"), nullptr if missing. */
+    const ZipEntry* find_entry(std::string_view p_path) const;
+    bool has_file(std::string_view p_path) const { return find_entry(p_path) != nullptr; }
+    /** @brief File names, directories excluded. */
+    std::vector<std::string> get_file_list() const;
+
+    /** @brief Compressed bytes of an entry, a view into the mapping. */
+    Error get_entry_data(const ZipEntry& p_entry, Span<const uint8_t>& r_data) const;
+    /** @brief View of a stored entry. ERR_UNAVAILABLE if it is compressed. */
+    Error get_stored_data(std::string_view p_path, Span<const uint8_t>& r_data) const;
+
+    /**
+     * @brief Decompresses a whole entry in one call and checks its CRC.
+     * @return ERR_FILE_NOT_FOUND, ERR_UNAVAILABLE (encrypted or unsupported
+     * method) or ERR_FILE_CORRUPT.
+     */
+    Error read_entry(const ZipEntry& p_entry, std::vector<uint8_t>& r_data) const;
+    Error read_file(std::string_view p_path, std::vector<uint8_t>& r_data) const;
+
+    /**
+     * @brief Reads several files on p_threads workers (0: hardware threads).
+     * r_data[i] receives p_paths[i]. Returns the first error met, the other
+     * files are still read.
+     */
+    Error read_files(const std::vector<std::string>& p_paths, std::vector<std::vector<uint8_t>>& r_data, int p_threads = 0) const;
+
+    /**
+     * @brief Writes every file below p_directory, in parallel. Names that
+     * are absolute or contain ".." are refused with ERR_FILE_BAD_PATH.
+     */
+    Error extract_all(const std::string& p_directory, int p_threads = 0) const;
+};
+
+/**
+ * @class ZipFileReader
+ * @brief Streams one archive entry through the FileAccess read interface.
+ *
+ * Deflated entries are inflated on demand into a 64 KiB buffer; large
+ * get_buffer() calls inflate straight into the caller's memory. Seeking
+ * forward inflates and discards, seeking backward outside the buffer
+ * restarts the stream. Stored entries are read from the mapping.
+ *
+ * The CRC is checked when the entry has been read to its end; a mismatch or
+ * a broken stream sets get_error() to ERR_FILE_CORRUPT and stops reads.
+ */
+class ZipFileReader : public RefCounted {
+public:
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+private:
+    Ref<ZipArchive> archive;
+    ZipEntry entry;
+    Span<const uint8_t> compressed;
+    bool opened = false;
+
+    z_stream_s* stream = nullptr;
+    std::unique_ptr<uint8_t[]> buffer;
+    size_t buffer_pos = 0;
+    size_t buffer_len = 0;
+    uint64_t inflated = 0; ///< Uncompressed bytes produced, the buffer holds the last buffer_len.
+    uint64_t consumed = 0; ///< Compressed bytes fed to the stream.
+
+    uint64_t position = 0;
+    uint32_t crc = 0;
+    bool crc_valid = true; ///< False once a stored entry was read out of order.
+    bool eof = false;
+    Error error = OK;
+
+    size_t _inflate(uint8_t* p_dst, size_t p_length);
+    void _check_end();
+    bool _restart();
+    bool _get_bytes(void* p_dst, size_t p_size);
+
+public:
+    ZipFileReader() {}
+    ~ZipFileReader();
+
+    /** @return ERR_FILE_NOT_FOUND, ERR_UNAVAILABLE or ERR_FILE_CORRUPT on failure. */
+    Error open(const Ref<ZipArchive>& p_archive, std::string_view p_path);
+    void close();
+    bool is_open() const { return opened; }
+    Error get_error() const { return error; }
+    bool is_stored() const { return entry.method == ZipEntry::METHOD_STORED; }
+
+    bool seek(uint64_t p_position);
+    uint64_t get_position() const { return position; }
+    uint64_t get_length() const { return entry.uncompressed_size; }
+    bool eof_reached() const { return eof; }
+
+    uint8_t get_8();
+    uint16_t get_16();
+    uint32_t get_32();
+    uint64_t get_64();
+    float get_float();
+    double get_double();
+
+    /** @brief Copy up to p_length bytes. @return Bytes read. */
+    size_t get_buffer(uint8_t* p_data, size_t p_length);
+    size_t get_buffer(Span<uint8_t> p_data) { return get_buffer(p_data.data(), p_data.size()); }
+    /** @brief Next line without its terminator ('\n' or "\r\n"). */
+    std::string get_line();
+    std::string get_as_text();
+};
+
+#endif // FILE_SYSTEM_ZIP_H
@@ -0,0 +1,1056 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "core/io/http_client.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+uint64_t _now_ms() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+bool _equals_nocase(std::string_view p_a, std::string_view p_b) {
+    if (p_a.size() != p_b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < p_a.size(); i++) {
+        if (std::tolower(static_cast<unsigned char>(p_a[i])) != std::tolower(static_cast<unsigned char>(p_b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool _contains_nocase(std::string_view p_haystack, std::string_view p_needle) {
+    for (size_t i = 0; i + p_needle.size() <= p_haystack.size(); i++) {
+        if (_equals_nocase(p_haystack.substr(i, p_needle.size()), p_needle)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string_view _trim(std::string_view p_text) {
+    while (!p_text.empty() && (p_text.front() == ' ' || p_text.front() == '\t')) {
+        p_text.remove_prefix(1);
+    }
+    while (!p_text.empty() && (p_text.back() == ' ' || p_text.back() == '\t')) {
+        p_text.remove_suffix(1);
+    }
+    return p_text;
+}
+
+bool _parse_uint(std::string_view p_text, uint64_t& r_value, int p_base = 10) {
+    if (p_text.empty() || p_text.size() > (p_base == 16 ? 15 : 19)) {
+        return false;
+    }
+    r_value = 0;
+    for (char c : p_text) {
+        int digit;
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        } else if (p_base == 16 && c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        } else if (p_base == 16 && c >= 'A' && c <= 'F') {
+            digit = c - 'A' + 10;
+        } else {
+            return false;
+        }
+        r_value = r_value * uint64_t(p_base) + uint64_t(digit);
+    }
+    return true;
+}
+
+bool _is_idempotent(const std::string& p_method) {
+    return p_method == "GET" || p_method == "HEAD";
+}
+
+} // namespace
+
+// HTTPRequest
+
+void HTTPRequest::set_range(int64_t p_first, int64_t p_last) {
+    range_first = p_first;
+    range_last = p_last;
+}
+
+void HTTPRequest::set_output_file(const Ref<FileAccess>& p_file) {
+    file = p_file;
+}
+
+std::string_view HTTPRequest::get_response_header(std::string_view p_name) const {
+    for (const auto& header : response_headers) {
+        if (_equals_nocase(header.first, p_name)) {
+            return header.second;
+        }
+    }
+    return std::string_view();
+}
+
+void HTTPRequest::resume() {
+    if (status == STATUS_PENDING && owner) {
+        owner->_resume(this);
+    }
+}
+
+bool HTTPRequest::cancel() {
+    if (status != STATUS_PENDING || !owner) {
+        return false;
+    }
+    return owner->_cancel(this);
+}
+
+// HTTPClient, portable part
+
+Error HTTPClient::_parse_url(const std::string& p_url, HTTPRequest& r_request) const {
+    std::string_view url(p_url);
+    if (url.size() < 7 || !_equals_nocase(url.substr(0, 7), "http://")) {
+        return url.size() >= 8 && _equals_nocase(url.substr(0, 8), "https://") ? ERR_UNAVAILABLE : ERR_INVALID_PARAMETER;
+    }
+    url.remove_prefix(7);
+    size_t fragment = url.find('#');
+    if (fragment != std::string_view::npos) {
+        url = url.substr(0, fragment);
+    }
+    size_t path = url.find_first_of("/?");
+    std::string_view authority = url.substr(0, path);
+    r_request.target = path == std::string_view::npos ? std::string("/") : std::string(url.substr(path));
+    if (r_request.target[0] == '?') {
+        r_request.target.insert(0, "/");
+    }
+    if (authority.empty() || authority.find('@') != std::string_view::npos) {
+        return ERR_INVALID_PARAMETER;
+    }
+
+    std::string_view name = authority;
+    uint64_t port = 80;
+    size_t colon = authority.rfind(':');
+    size_t bracket = authority.rfind(']');
+    if (colon != std::string_view::npos && (bracket == std::string_view::npos || colon > bracket)) {
+        name = authority.substr(0, colon);
+        if (!_parse_uint(authority.substr(colon + 1), port) || port == 0 || port > 65535) {
+            return ERR_INVALID_PARAMETER;
+        }
+    }
+    if (name.empty()) {
+        return ERR_INVALID_PARAMETER;
+    }
+    r_request.host_header.assign(authority);
+    r_request.host.assign(name);
+    r_request.host += ':';
+    r_request.host += std::to_string(port);
+    return OK;
+}
+
+Ref<HTTPRequest> HTTPClient::create_request(const std::string& p_method, const std::string& p_url) {
+    Ref<HTTPRequest> request;
+    request.instantiate();
+    request->method = p_method;
+    if (_parse_url(p_url, *request.get_ptr()) != OK) {
+        return Ref<HTTPRequest>();
+    }
+    return request;
+}
+
+Ref<HTTPRequest> HTTPClient::get(const std::string& p_url, HTTPRequest::Callback p_callback) {
+    Ref<HTTPRequest> request = create_request("GET", p_url);
+    if (request.is_valid()) {
+        request->callback = p_callback;
+        send(request);
+    }
+    return request;
+}
+
+Ref<HTTPRequest> HTTPClient::download(const std::string& p_url, const std::string& p_path, bool p_resume, HTTPRequest::Callback p_callback) {
+    Ref<HTTPRequest> request = create_request("GET", p_url);
+    if (request.is_null()) {
+        return request;
+    }
+    request->download_path = p_path;
+    request->callback = p_callback;
+    if (p_resume) {
+        Ref<FileAccess> existing;
+        existing.instantiate();
+        if (existing->open(p_path, FileAccess::READ)) {
+            uint64_t length = existing->get_length();
+            existing->close();
+            if (length > 0) {
+                request->set_range(static_cast<int64_t>(length));
+            }
+        }
+    }
+    send(request);
+    return request;
+}
+
+Error HTTPClient::wait(HTTPRequest* p_request, uint32_t p_timeout_ms) {
+    if (!p_request || p_request->owner != this) {
+        return ERR_INVALID_PARAMETER;
+    }
+    const uint64_t deadline = _now_ms() + p_timeout_ms;
+    while (!p_request->is_done()) {
+        int slice = 100;
+        if (p_timeout_ms) {
+            uint64_t now = _now_ms();
+            if (now >= deadline) {
+                return ERR_TIMEOUT;
+            }
+            slice = static_cast<int>(std::min<uint64_t>(deadline - now, 100));
+        }
+        poll(slice);
+    }
+    if (p_request->status == HTTPRequest::STATUS_CANCELED) {
+        return ERR_SKIP;
+    }
+    return p_request->error;
+}
+
+void HTTPClient::_complete(const Ref<HTTPRequest>& p_request, HTTPRequest::Status p_status, Error p_error) {
+    if (p_request->status != HTTPRequest::STATUS_PENDING) {
+        return;
+    }
+    p_request->status = p_status;
+    p_request->error = p_error;
+    p_request->paused = false;
+    p_request->connection_id = 0;
+    if (!p_request->download_path.empty() && p_request->file.is_valid()) {
+        p_request->file->close();
+        p_request->file.unref();
+    }
+    completed.push_back(p_request);
+}
+
+#ifdef __linux__
+
+struct HTTPClient::Host {
+    std::string key;
+    std::string name;
+    uint16_t port = 80;
+    sockaddr_storage address;
+    socklen_t address_length = 0;
+    std::deque<Ref<HTTPRequest>> queue;
+    std::vector<uint64_t> connections;
+};
+
+struct HTTPClient::Connection {
+    enum State {
+        STATE_HEADERS,
+        STATE_BODY, ///< Content-Length bytes left in `remaining`.
+        STATE_UNTIL_CLOSE,
+        STATE_CHUNK_SIZE,
+        STATE_CHUNK_DATA,
+        STATE_CHUNK_END,
+        STATE_TRAILERS,
+        STATE_COMPLETE, ///< Headers ended a response without a body.
+    };
+
+    int fd = -1;
+    uint64_t id = 0;
+    Host* host = nullptr;
+    uint32_t events = 0;
+    bool connecting = true;
+    bool reusable = true;
+    uint32_t requests_sent = 0;
+    uint64_t last_active = 0;
+
+    std::string output;
+    size_t output_offset = 0;
+    std::string input;
+    size_t input_offset = 0;
+    std::deque<Ref<HTTPRequest>> in_flight; ///< Sent, answered in order.
+    State state = STATE_HEADERS;
+    uint64_t remaining = 0;
+
+    bool is_pipelinable() const {
+        if (!reusable || connecting) {
+            return false;
+        }
+        for (const Ref<HTTPRequest>& request : in_flight) {
+            if (!_is_idempotent(request->method) || request->paused) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+HTTPClient::HTTPClient() {
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+}
+
+HTTPClient::~HTTPClient() {
+    close_all();
+    // Callbacks of canceled requests are not run from the destructor.
+    completed.clear();
+    resumed.clear();
+    if (epoll_fd >= 0) {
+        ::close(epoll_fd);
+    }
+}
+
+Error HTTPClient::send(const Ref<HTTPRequest>& p_request) {
+    if (p_request.is_null()) {
+        return ERR_INVALID_PARAMETER;
+    }
+    if (p_request->owner) {
+        return ERR_ALREADY_IN_USE;
+    }
+    p_request->owner = this;
+    stats.requests++;
+    if (epoll_fd < 0) {
+        _complete(p_request, HTTPRequest::STATUS_FAILED, ERR_CANT_CREATE);
+        return ERR_CANT_CREATE;
+    }
+
+    std::unique_ptr<Host>& slot = hosts[p_request->host];
+    if (!slot) {
+        slot.reset(new Host);
+        slot->key = p_request->host;
+        size_t colon = slot->key.rfind(':');
+        slot->name = slot->key.substr(0, colon);
+        slot->port = static_cast<uint16_t>(std::stoi(slot->key.substr(colon + 1)));
+        if (slot->name.size() > 2 && slot->name.front() == '[' && slot->name.back() == ']') {
+            slot->name = slot->name.substr(1, slot->name.size() - 2);
+        }
+    }
+    Host& host = *slot;
+    if (host.address_length == 0) {
+        Error err = _resolve(host);
+        if (err != OK) {
+            _complete(p_request, HTTPRequest::STATUS_FAILED, err);
+            return err;
+        }
+    }
+    host.queue.push_back(p_request);
+    _schedule(host);
+    return OK;
+}
+
+Error HTTPClient::_resolve(Host& p_host) {
+    memset(&p_host.address, 0, sizeof(p_host.address));
+    sockaddr_in* v4 = reinterpret_cast<sockaddr_in*>(&p_host.address);
+    sockaddr_in6* v6 = reinterpret_cast<sockaddr_in6*>(&p_host.address);
+    if (inet_pton(AF_INET, p_host.name.c_str(), &v4->sin_addr) == 1) {
+        v4->sin_family = AF_INET;
+        v4->sin_port = htons(p_host.port);
+        p_host.address_length = sizeof(sockaddr_in);
+        return OK;
+    }
+    if (inet_pton(AF_INET6, p_host.name.c_str(), &v6->sin6_addr) == 1) {
+        v6->sin6_family = AF_INET6;
+        v6->sin6_port = htons(p_host.port);
+        p_host.address_length = sizeof(sockaddr_in6);
+        return OK;
+    }
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(p_host.name.c_str(), nullptr, &hints, &result) != 0 || !result) {
+        return ERR_CANT_RESOLVE;
+    }
+    memcpy(&p_host.address, result->ai_addr, result->ai_addrlen);
+    p_host.address_length = static_cast<socklen_t>(result->ai_addrlen);
+    if (result->ai_family == AF_INET6) {
+        v6->sin6_port = htons(p_host.port);
+    } else {
+        v4->sin_port = htons(p_host.port);
+    }
+    freeaddrinfo(result);
+    return OK;
+}
+
+HTTPClient::Connection* HTTPClient::_open(Host& p_host) {
+    int fd = socket(p_host.address.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return nullptr;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&p_host.address), p_host.address_length) != 0 && errno != EINPROGRESS) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    std::unique_ptr<Connection> connection(new Connection);
+    connection->fd = fd;
+    connection->id = next_connection_id++;
+    connection->host = &p_host;
+    connection->last_active = _now_ms();
+    // Even an immediate connect reports through EPOLLOUT, one code path.
+    connection->events = EPOLLOUT;
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = connection->events;
+    event.data.u64 = connection->id;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        ::close(fd);
+        return nullptr;
+    }
+    stats.connections_opened++;
+    p_host.connections.push_back(connection->id);
+    Connection* result = connection.get();
+    connections.emplace(connection->id, std::move(connection));
+    return result;
+}
+
+void HTTPClient::_schedule(Host& p_host) {
+    while (!p_host.queue.empty()) {
+        Ref<HTTPRequest> request = p_host.queue.front();
+        Connection* target = nullptr;
+        for (uint64_t id : p_host.connections) {
+            Connection* connection = connections[id].get();
+            if (connection->reusable && connection->in_flight.empty()) {
+                target = connection;
+                break;
+            }
+        }
+        if (!target && p_host.connections.size() < max_connections) {
+            target = _open(p_host);
+            if (!target) {
+                p_host.queue.pop_front();
+                _complete(request, HTTPRequest::STATUS_FAILED, ERR_CANT_CONNECT);
+                continue;
+            }
+        }
+        if (!target && max_pipeline > 1 && _is_idempotent(request->method)) {
+            for (uint64_t id : p_host.connections) {
+                Connection* connection = connections[id].get();
+                if (connection->in_flight.size() < max_pipeline && connection->is_pipelinable() && (!target || connection->in_flight.size() < target->in_flight.size())) {
+                    target = connection;
+                }
+            }
+        }
+        if (!target) {
+            return; // Everything busy; a finishing response reschedules.
+        }
+        p_host.queue.pop_front();
+        _assign(*target, request);
+    }
+}
+
+void HTTPClient::_assign(Connection& p_connection, const Ref<HTTPRequest>& p_request) {
+    HTTPRequest& request = *p_request.get_ptr();
+    request.connection_id = p_connection.id;
+    if (p_connection.requests_sent) {
+        stats.reused++;
+    }
+    if (!p_connection.in_flight.empty()) {
+        stats.pipelined++;
+    }
+    p_connection.requests_sent++;
+
+    std::string& out = p_connection.output;
+    out += request.method;
+    out += ' ';
+    out += request.target;
+    out += " HTTP/1.1\r\nHost: ";
+    out += request.host_header;
+    out += "\r\n";
+    if (request.range_first >= 0) {
+        out += "Range: bytes=";
+        out += std::to_string(request.range_first);
+        out += '-';
+        if (request.range_last >= 0) {
+            out += std::to_string(request.range_last);
+        }
+        out += "\r\n";
+    }
+    if (!request.request_body.empty() || request.method == "POST" || request.method == "PUT") {
+        out += "Content-Length: ";
+        out += std::to_string(request.request_body.size());
+        out += "\r\n";
+    }
+    for (const auto& header : request.headers) {
+        out += header.first;
+        out += ": ";
+        out += header.second;
+        out += "\r\n";
+    }
+    out += "\r\n";
+    out += request.request_body;
+    p_connection.in_flight.push_back(p_request);
+
+    if (!p_connection.connecting) {
+        if (!_flush(p_connection)) {
+            _close(p_connection.id, ERR_CONNECTION_ERROR, true);
+            return;
+        }
+        _update_events(p_connection);
+    }
+}
+
+bool HTTPClient::_flush(Connection& p_connection) {
+    while (p_connection.output_offset < p_connection.output.size()) {
+        ssize_t sent = ::send(p_connection.fd, p_connection.output.data() + p_connection.output_offset, p_connection.output.size() - p_connection.output_offset, MSG_NOSIGNAL);
+        if (sent > 0) {
+            p_connection.output_offset += static_cast<size_t>(sent);
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        return sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+    p_connection.output.clear();
+    p_connection.output_offset = 0;
+    return true;
+}
+
+void HTTPClient::_update_events(Connection& p_connection) {
+    uint32_t events;
+    if (p_connection.connecting) {
+        events = EPOLLOUT;
+    } else {
+        // A paused response stops reading, so TCP flow control slows the server.
+        bool paused = !p_connection.in_flight.empty() && p_connection.in_flight.front()->paused;
+        events = paused ? 0 : EPOLLIN | EPOLLRDHUP;
+        if (p_connection.output_offset < p_connection.output.size()) {
+            events |= EPOLLOUT;
+        }
+    }
+    if (events != p_connection.events) {
+        epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = events;
+        event.data.u64 = p_connection.id;
+        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, p_connection.fd, &event);
+        p_connection.events = events;
+    }
+}
+
+void HTTPClient::_close(uint64_t p_id, Error p_error, bool p_retry) {
+    auto it = connections.find(p_id);
+    if (it == connections.end()) {
+        return;
+    }
+    Connection& connection = *it->second;
+    Host& host = *connection.host;
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, connection.fd, nullptr);
+    ::close(connection.fd);
+    host.connections.erase(std::find(host.connections.begin(), host.connections.end(), p_id));
+
+    // Requests whose response had not started go back to the front of the
+    // queue, in order; a stale pooled connection costs nothing but a retry.
+    std::vector<Ref<HTTPRequest>> retry;
+    for (const Ref<HTTPRequest>& request : connection.in_flight) {
+        if (request->status != HTTPRequest::STATUS_PENDING) {
+            continue;
+        }
+        request->connection_id = 0;
+        if (p_retry && !request->headers_received && request->retries < 1 && _is_idempotent(request->method)) {
+            request->retries++;
+            stats.retries++;
+            retry.push_back(request);
+        } else {
+            _complete(request, HTTPRequest::STATUS_FAILED, p_error);
+        }
+    }
+    host.queue.insert(host.queue.begin(), retry.begin(), retry.end());
+    connections.erase(it);
+}
+
+void HTTPClient::_on_readable(Connection& p_connection) {
+    char buffer[65536];
+    while (p_connection.in_flight.empty() || !p_connection.in_flight.front()->paused) {
+        ssize_t received = recv(p_connection.fd, buffer, sizeof(buffer), 0);
+        if (received > 0) {
+            p_connection.last_active = _now_ms();
+            stats.bytes_received += static_cast<uint64_t>(received);
+            if (p_connection.input_offset == p_connection.input.size()) {
+                p_connection.input.clear();
+                p_connection.input_offset = 0;
+            } else if (p_connection.input_offset > sizeof(buffer)) {
+                p_connection.input.erase(0, p_connection.input_offset);
+                p_connection.input_offset = 0;
+            }
+            p_connection.input.append(buffer, static_cast<size_t>(received));
+            if (!_parse(p_connection)) {
+                return;
+            }
+            continue;
+        }
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        // Closed by the server. That ends a body delimited by the close.
+        if (received == 0 && p_connection.state == Connection::STATE_UNTIL_CLOSE && !p_connection.in_flight.empty()) {
+            p_connection.reusable = false;
+            if (!_finish_response(p_connection)) {
+                return;
+            }
+        }
+        _close(p_connection.id, ERR_CONNECTION_ERROR, true);
+        return;
+    }
+    _update_events(p_connection);
+}
+
+bool HTTPClient::_parse(Connection& p_connection) {
+    while (p_connection.input_offset < p_connection.input.size()) {
+        if (p_connection.in_flight.empty()) {
+            _close(p_connection.id, ERR_CONNECTION_ERROR, false); // Data nobody asked for.
+            return false;
+        }
+        const Ref<HTTPRequest>& request = p_connection.in_flight.front();
+        if (request->paused) {
+            return true;
+        }
+        const char* data = p_connection.input.data() + p_connection.input_offset;
+        const size_t available = p_connection.input.size() - p_connection.input_offset;
+        std::string_view view(data, available);
+
+        switch (p_connection.state) {
+            case Connection::STATE_HEADERS: {
+                size_t end = view.find("\r\n\r\n");
+                if (end == std::string_view::npos) {
+                    if (available > MAX_HEADER_SIZE) {
+                        _close(p_connection.id, ERR_PARSE_ERROR, false);
+                        return false;
+                    }
+                    return true;
+                }
+                p_connection.input_offset += end + 4;
+                if (!_parse_headers(p_connection, *request.get_ptr(), view.substr(0, end))) {
+                    _close(p_connection.id, ERR_PARSE_ERROR, false);
+                    return false;
+                }
+                if (p_connection.state == Connection::STATE_COMPLETE && !_finish_response(p_connection)) {
+                    return false;
+                }
+            } break;
+            case Connection::STATE_BODY:
+            case Connection::STATE_CHUNK_DATA: {
+                size_t offered = static_cast<size_t>(std::min<uint64_t>(available, p_connection.remaining));
+                size_t consumed = _deliver(request, reinterpret_cast<const uint8_t*>(data), offered);
+                p_connection.input_offset += consumed;
+                p_connection.remaining -= consumed;
+                if (p_connection.remaining == 0) {
+                    if (p_connection.state == Connection::STATE_CHUNK_DATA) {
+                        p_connection.state = Connection::STATE_CHUNK_END;
+                    } else if (!_finish_response(p_connection)) {
+                        return false;
+                    }
+                } else if (consumed < offered) {
+                    return true; // Paused.
+                }
+            } break;
+            case Connection::STATE_UNTIL_CLOSE: {
+                size_t consumed = _deliver(request, reinterpret_cast<const uint8_t*>(data), available);
+                p_connection.input_offset += consumed;
+                if (consumed < available) {
+                    return true;
+                }
+            } break;
+            case Connection::STATE_CHUNK_SIZE: {
+                size_t end = view.find("\r\n");
+                if (end == std::string_view::npos) {
+                    if (available > 1024) {
+                        _close(p_connection.id, ERR_PARSE_ERROR, false);
+                        return false;
+                    }
+                    return true;
+                }
+                std::string_view size_text = _trim(view.substr(0, std::min(end, view.find(';'))));
+                uint64_t size = 0;
+                if (!_parse_uint(size_text, size, 16)) {
+                    _close(p_connection.id, ERR_PARSE_ERROR, false);
+                    return false;
+                }
+                p_connection.input_offset += end + 2;
+                p_connection.remaining = size;
+                p_connection.state = size ? Connection::STATE_CHUNK_DATA : Connection::STATE_TRAILERS;
+            } break;
+            case Connection::STATE_CHUNK_END: {
+                if (available < 2) {
+                    return true;
+                }
+                if (data[0] != '\r' || data[1] != '\n') {
+                    _close(p_connection.id, ERR_PARSE_ERROR, false);
+                    return false;
+                }
+                p_connection.input_offset += 2;
+                p_connection.state = Connection::STATE_CHUNK_SIZE;
+            } break;
+            case Connection::STATE_TRAILERS: {
+                size_t end = view.find("\r\n");
+                if (end == std::string_view::npos) {
+                    if (available > MAX_HEADER_SIZE) {
+                        _close(p_connection.id, ERR_PARSE_ERROR, false);
+                        return false;
+                    }
+                    return true;
+                }
+                p_connection.input_offset += end + 2;
+                if (end == 0 && !_finish_response(p_connection)) {
+                    return false;
+                }
+            } break;
+            case Connection::STATE_COMPLETE:
+                break;
+        }
+    }
+    return true;
+}
+
+bool HTTPClient::_parse_headers(Connection& p_connection, HTTPRequest& p_request, std::string_view p_head) {
+    size_t line_end = p_head.find("\r\n");
+    std::string_view line = p_head.substr(0, line_end);
+    if (line.size() < 12 || line.compare(0, 7, "HTTP/1.") != 0 || line[8] != ' ') {
+        return false;
+    }
+    const bool http10 = line[7] == '0';
+    uint64_t code = 0;
+    if (!_parse_uint(line.substr(9, 3), code) || code < 100 || code > 599) {
+        return false;
+    }
+    if (code < 200) {
+        // 100 Continue and friends: the real response follows.
+        return code != 101;
+    }
+
+    bool chunked = false;
+    bool close = http10;
+    int64_t length = -1;
+    p_request.response_code = static_cast<int>(code);
+    p_request.response_headers.clear();
+    while (line_end != std::string_view::npos) {
+        size_t start = line_end + 2;
+        line_end = p_head.find("\r\n", start);
+        line = p_head.substr(start, line_end == std::string_view::npos ? std::string_view::npos : line_end - start);
+        size_t colon = line.find(':');
+        if (colon == std::string_view::npos) {
+            return false;
+        }
+        std::string_view name = line.substr(0, colon);
+        std::string_view value = _trim(line.substr(colon + 1));
+        if (_equals_nocase(name, "Transfer-Encoding")) {
+            chunked = _contains_nocase(value, "chunked");
+        } else if (_equals_nocase(name, "Content-Length")) {
+            uint64_t parsed = 0;
+            if (!_parse_uint(value, parsed)) {
+                return false;
+            }
+            length = static_cast<int64_t>(parsed);
+        } else if (_equals_nocase(name, "Connection")) {
+            if (_contains_nocase(value, "close")) {
+                close = true;
+            } else if (_contains_nocase(value, "keep-alive")) {
+                close = false;
+            }
+        } else if (_equals_nocase(name, "Content-Range") && value.compare(0, 6, "bytes ") == 0) {
+            uint64_t first = 0;
+            std::string_view range = value.substr(6);
+            if (_parse_uint(range.substr(0, range.find('-')), first)) {
+                p_request.range_start = static_cast<int64_t>(first);
+            }
+        }
+        p_request.response_headers.emplace_back(std::string(name), std::string(value));
+    }
+    p_request.headers_received = true;
+    if (close) {
+        p_connection.reusable = false;
+    }
+
+    // A download opens its file only now: 206 appends, any other 2xx
+    // restarts the file, errors leave it alone.
+    if (code >= 200 && code < 300 && !p_request.download_path.empty()) {
+        Ref<HTTPRequest> self;
+        self.ref_pointer(&p_request);
+        if (code == 206 && p_request.range_start != p_request.range_first) {
+            _complete(self, HTTPRequest::STATUS_FAILED, ERR_INVALID_DATA);
+        } else {
+            p_request.file.instantiate();
+            if (!p_request.file->open(p_request.download_path, code == 206 ? FileAccess::APPEND : FileAccess::WRITE)) {
+                p_request.file.unref();
+                _complete(self, HTTPRequest::STATUS_FAILED, ERR_FILE_CANT_OPEN);
+            }
+        }
+    }
+
+    if (p_request.method == "HEAD" || code == 204 || code == 304) {
+        p_connection.state = Connection::STATE_COMPLETE;
+    } else if (chunked) {
+        p_connection.state = Connection::STATE_CHUNK_SIZE;
+    } else if (length >= 0) {
+        p_request.content_length = length;
+        p_connection.remaining = static_cast<uint64_t>(length);
+        p_connection.state = length ? Connection::STATE_BODY : Connection::STATE_COMPLETE;
+    } else {
+        p_connection.state = Connection::STATE_UNTIL_CLOSE;
+        p_connection.reusable = false;
+    }
+    return true;
+}
+
+size_t HTTPClient::_deliver(const Ref<HTTPRequest>& p_request, const uint8_t* p_data, size_t p_size) {
+    HTTPRequest& request = *p_request.get_ptr();
+    if (request.status != HTTPRequest::STATUS_PENDING) {
+        return p_size; // Failed or canceled: drained and dropped.
+    }
+    const bool success = request.response_code >= 200 && request.response_code < 300;
+    if (success && request.body_callback.is_valid()) {
+        size_t consumed = std::min(request.body_callback(request, Span<const uint8_t>(p_data, p_size)), p_size);
+        request.bytes_received += consumed;
+        if (consumed < p_size && request.status == HTTPRequest::STATUS_PENDING) {
+            request.paused = true;
+        }
+        return consumed;
+    }
+    if (success && request.file.is_valid()) {
+        if (!request.file->store_buffer(reinterpret_cast<const char*>(p_data), p_size)) {
+            _complete(p_request, HTTPRequest::STATUS_FAILED, ERR_FILE_CANT_WRITE);
+            return p_size;
+        }
+        request.bytes_received += p_size;
+        return p_size;
+    }
+    if (request.body.size() + p_size > MAX_BUFFERED_BODY) {
+        _complete(p_request, HTTPRequest::STATUS_FAILED, ERR_OUT_OF_MEMORY);
+        return p_size;
+    }
+    request.body.append(reinterpret_cast<const char*>(p_data), p_size);
+    request.bytes_received += p_size;
+    return p_size;
+}
+
+bool HTTPClient::_finish_response(Connection& p_connection) {
+    Ref<HTTPRequest> request = p_connection.in_flight.front();
+    p_connection.in_flight.pop_front();
+    p_connection.state = Connection::STATE_HEADERS;
+    p_connection.remaining = 0;
+    if (request->file.is_valid() && request->download_path.empty()) {
+        request->file->flush();
+    }
+    _complete(request, HTTPRequest::STATUS_DONE, OK);
+    if (!p_connection.reusable) {
+        _close(p_connection.id, ERR_CONNECTION_ERROR, true);
+        return false;
+    }
+    return true;
+}
+
+void HTTPClient::_resume(HTTPRequest* p_request) {
+    Ref<HTTPRequest> request;
+    request.ref_pointer(p_request);
+    resumed.push_back(request);
+}
+
+bool HTTPClient::_cancel(HTTPRequest* p_request) {
+    Ref<HTTPRequest> request;
+    request.ref_pointer(p_request);
+    const uint64_t connection_id = p_request->connection_id;
+    if (connection_id == 0) {
+        auto host = hosts.find(p_request->host);
+        if (host != hosts.end()) {
+            std::deque<Ref<HTTPRequest>>& queue = host->second->queue;
+            queue.erase(std::remove(queue.begin(), queue.end(), request), queue.end());
+        }
+    } else {
+        // Its response may be mid-transfer: poll() closes the connection,
+        // the requests pipelined behind it go back to the queue.
+        doomed.push_back(connection_id);
+    }
+    _complete(request, HTTPRequest::STATUS_CANCELED, OK);
+    return true;
+}
+
+int HTTPClient::poll(int p_timeout_ms) {
+    if (epoll_fd >= 0 && !connections.empty()) {
+        epoll_event events[64];
+        int timeout = completed.empty() && resumed.empty() && doomed.empty() ? p_timeout_ms : 0;
+        int count = epoll_wait(epoll_fd, events, 64, timeout);
+        for (int i = 0; i < count; i++) {
+            auto it = connections.find(events[i].data.u64);
+            if (it == connections.end()) {
+                continue;
+            }
+            Connection& connection = *it->second;
+            const uint32_t flags = events[i].events;
+            if (connection.connecting) {
+                int error = 0;
+                socklen_t length = sizeof(error);
+                if (getsockopt(connection.fd, SOL_SOCKET, SO_ERROR, &error, &length) != 0 || error != 0) {
+                    _close(connection.id, ERR_CANT_CONNECT, false);
+                    continue;
+                }
+                connection.connecting = false;
+                connection.last_active = _now_ms();
+                if (!_flush(connection)) {
+                    _close(connection.id, ERR_CONNECTION_ERROR, true);
+                    continue;
+                }
+                _update_events(connection);
+                continue;
+            }
+            if (flags & EPOLLERR) {
+                _close(connection.id, ERR_CONNECTION_ERROR, true);
+                continue;
+            }
+            if (flags & EPOLLOUT) {
+                if (!_flush(connection)) {
+                    _close(connection.id, ERR_CONNECTION_ERROR, true);
+                    continue;
+                }
+                _update_events(connection);
+            }
+            if (flags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) {
+                _on_readable(connection);
+            }
+        }
+    } else if (p_timeout_ms > 0 && completed.empty()) {
+        // Nothing to wait on; behave like a sleep so wait() loops stay cheap.
+        std::this_thread::sleep_for(std::chrono::milliseconds(std::min(p_timeout_ms, 10)));
+    }
+
+    std::vector<uint64_t> closing;
+    closing.swap(doomed);
+    for (uint64_t id : closing) {
+        _close(id, ERR_CONNECTION_ERROR, true);
+    }
+
+    std::vector<Ref<HTTPRequest>> resuming;
+    resuming.swap(resumed);
+    for (const Ref<HTTPRequest>& request : resuming) {
+        if (!request->paused) {
+            continue;
+        }
+        request->paused = false;
+        auto it = connections.find(request->connection_id);
+        if (it != connections.end() && _parse(*it->second)) {
+            _update_events(*it->second);
+        }
+    }
+
+    const uint64_t now = _now_ms();
+    for (auto it = connections.begin(); it != connections.end();) {
+        Connection& connection = *it->second;
+        ++it;
+        const uint64_t idle = now - connection.last_active;
+        if (connection.in_flight.empty()) {
+            if (idle >= idle_timeout_ms) {
+                _close(connection.id, OK, false);
+            }
+        } else if (!connection.in_flight.front()->paused && idle >= timeout_ms) {
+            _close(connection.id, ERR_TIMEOUT, false);
+        }
+    }
+
+    for (const auto& host : hosts) {
+        if (!host.second->queue.empty()) {
+            _schedule(*host.second);
+        }
+    }
+
+    std::vector<Ref<HTTPRequest>> done;
+    done.swap(completed);
+    for (const Ref<HTTPRequest>& request : done) {
+        if (request->callback.is_valid()) {
+            request->callback(*request.get_ptr());
+        }
+    }
+    return static_cast<int>(done.size());
+}
+
+void HTTPClient::close_all() {
+    for (const auto& host : hosts) {
+        std::deque<Ref<HTTPRequest>> queue;
+        queue.swap(host.second->queue);
+        for (const Ref<HTTPRequest>& request : queue) {
+            _complete(request, HTTPRequest::STATUS_CANCELED, OK);
+        }
+    }
+    while (!connections.empty()) {
+        Connection& connection = *connections.begin()->second;
+        for (const Ref<HTTPRequest>& request : connection.in_flight) {
+            _complete(request, HTTPRequest::STATUS_CANCELED, OK);
+        }
+        _close(connection.id, OK, false);
+    }
+    doomed.clear();
+}
+
+#else
+
+struct HTTPClient::Host {};
+struct HTTPClient::Connection {};
+
+HTTPClient::HTTPClient() {}
+
+HTTPClient::~HTTPClient() {}
+
+Error HTTPClient::send(const Ref<HTTPRequest>& p_request) {
+    if (p_request.is_null() || p_request->owner) {
+        return p_request.is_null() ? ERR_INVALID_PARAMETER : ERR_ALREADY_IN_USE;
+    }
+    p_request->owner = this;
+    _complete(p_request, HTTPRequest::STATUS_FAILED, ERR_UNAVAILABLE);
+    return ERR_UNAVAILABLE;
+}
+
+int HTTPClient::poll(int p_timeout_ms) {
+    (void)p_timeout_ms;
+    std::vector<Ref<HTTPRequest>> done;
+    done.swap(completed);
+    for (const Ref<HTTPRequest>& request : done) {
+        if (request->callback.is_valid()) {
+            request->callback(*request.get_ptr());
+        }
+    }
+    return static_cast<int>(done.size());
+}
+
+void HTTPClient::close_all() {}
+
+void HTTPClient::_resume(HTTPRequest* p_request) {
+    (void)p_request;
+}
+
+bool HTTPClient::_cancel(HTTPRequest* p_request) {
+    (void)p_request;
+    return false;
+}
+
+#endif // __linux__
@@ -0,0 +1,255 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef HTTP_CLIENT_H
+#define HTTP_CLIENT_H
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/error/error_list.h"
+#include "core/io/file_access.h"
+#include "core/object/ref_counted.h"
+#include "core/templates/delegate.h"
+#include "core/templates/span.h"
+
+class HTTPClient;
+
+/**
+ * @class HTTPRequest
+ * @brief One request and its response, created by HTTPClient.
+ *
+ * Configure it before HTTPClient::send(). The response body goes, in order
+ * of preference, to the body callback, to the output file, or into
+ * get_body(). Non-2xx bodies (error pages) always go to get_body(), so they
+ * never end up in a downloaded file.
+ */
+class HTTPRequest : public RefCounted {
+public:
+    enum Status {
+        STATUS_PENDING, ///< Queued, connecting or transferring.
+        STATUS_DONE, ///< A complete response arrived; see get_response_code().
+        STATUS_FAILED, ///< See get_error().
+        STATUS_CANCELED,
+    };
+
+    /** Runs from HTTPClient::poll() when the request finishes, fails or is canceled. */
+    typedef Delegate<void(HTTPRequest&)> Callback;
+    /**
+     * @brief Receives body data as it arrives.
+     * @return Bytes consumed. Fewer than offered pauses the connection; the
+     * rest is offered again after resume().
+     */
+    typedef Delegate<size_t(HTTPRequest&, Span<const uint8_t>)> BodyCallback;
+
+private:
+    friend class HTTPClient;
+
+    HTTPClient* owner = nullptr;
+    uint64_t connection_id = 0; ///< While in flight.
+
+    std::string method;
+    std::string host; ///< Pool key, "host:port".
+    std::string host_header;
+    std::string target;
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string request_body;
+    int64_t range_first = -1;
+    int64_t range_last = -1;
+    Ref<FileAccess> file;
+    std::string download_path; ///< Opened when the response starts, see HTTPClient::download().
+    BodyCallback body_callback;
+    Callback callback;
+
+    Status status = STATUS_PENDING;
+    Error error = OK;
+    int response_code = 0;
+    std::vector<std::pair<std::string, std::string>> response_headers;
+    std::string body;
+    uint64_t bytes_received = 0;
+    int64_t content_length = -1;
+    int64_t range_start = -1;
+    bool headers_received = false;
+    bool paused = false;
+    int retries = 0;
+
+public:
+    const std::string& get_method() const { return method; }
+    const std::string& get_target() const { return target; }
+
+    void set_header(const std::string& p_name, const std::string& p_value) { headers.emplace_back(p_name, p_value); }
+    void set_body(std::string p_body) { request_body = std::move(p_body); }
+    /** @brief Asks for bytes p_first..p_last, or to the end if p_last < 0. */
+    void set_range(int64_t p_first, int64_t p_last = -1);
+    /** @brief Writes 2xx bodies to p_file at its current position. */
+    void set_output_file(const Ref<FileAccess>& p_file);
+    void set_body_callback(BodyCallback p_callback) { body_callback = p_callback; }
+    void set_callback(Callback p_callback) { callback = p_callback; }
+
+    Status get_status() const { return status; }
+    bool is_done() const { return status != STATUS_PENDING; }
+    Error get_error() const { return error; }
+    int get_response_code() const { return response_code; }
+    /** @brief Case-insensitive, empty if absent. */
+    std::string_view get_response_header(std::string_view p_name) const;
+    const std::vector<std::pair<std::string, std::string>>& get_response_headers() const { return response_headers; }
+    const std::string& get_body() const { return body; }
+    uint64_t get_bytes_received() const { return bytes_received; }
+    /** @brief From Content-Length, -1 if unknown (chunked). */
+    int64_t get_content_length() const { return content_length; }
+    /** @brief First byte of a 206 response, from Content-Range; -1 otherwise. */
+    int64_t get_range_start() const { return range_start; }
+
+    /** @brief Continues a transfer paused by the body callback. */
+    void resume();
+    bool cancel();
+};
+
+/**
+ * @class HTTPClient
+ * @brief Non-blocking HTTP/1.1 client with a keep-alive connection pool per host.
+ *
+ * Nothing runs in the background: poll() does the socket work and runs the
+ * callbacks on the calling thread, so a client belongs to one thread (the
+ * main loop, or a download worker calling wait()). Requests to the same
+ * host:port share up to get_max_connections() connections. A request goes
+ * to an idle connection, else a new one, else it is pipelined behind the
+ * least busy connection, up to get_max_pipeline() deep. Only GET and HEAD
+ * are pipelined.
+ *
+ * Idempotent requests that were sent on a connection which died before
+ * their response started are retried once on a fresh connection. This is
+ * the normal fate of a pooled connection the server timed out.
+ *
+ * Bodies may be chunked or sized; both stream through without being held
+ * in memory when a callback or file receives them. Only plain http:// is
+ * supported. Host names go through a blocking getaddrinfo() once per host.
+ * Linux only; send() fails with ERR_UNAVAILABLE elsewhere.
+ *
+ * @code
+ *     HTTPClient client;
+ *     Ref<HTTPRequest> request = client.download("http://127.0.0.1:6006/assets/pack0.pck", "user://pack0.pck", true);
+ *     client.wait(request.get_ptr(), 10000);
+ * @endcode
+ */
+class HTTPClient {
+public:
+    struct Stats {
+        uint64_t requests = 0;
+        uint64_t connections_opened = 0;
+        uint64_t reused = 0; ///< Requests sent on an already open connection.
+        uint64_t pipelined = 0; ///< Requests sent while others were in flight on the connection.
+        uint64_t retries = 0;
+        uint64_t bytes_received = 0;
+    };
+
+    static constexpr size_t MAX_HEADER_SIZE = 64 * 1024;
+    static constexpr size_t MAX_BUFFERED_BODY = 64 * 1024 * 1024; ///< For bodies kept in get_body().
+
+private:
+    struct Connection;
+    struct Host;
+
+    int epoll_fd = -1;
+    uint32_t max_connections = 4;
+    uint32_t max_pipeline = 4;
+    uint32_t timeout_ms = 30000;
+    uint32_t idle_timeout_ms = 10000;
+
+    std::unordered_map<std::string, std::unique_ptr<Host>> hosts;
+    std::unordered_map<uint64_t, std::unique_ptr<Connection>> connections;
+    uint64_t next_connection_id = 1;
+    std::vector<Ref<HTTPRequest>> completed; ///< Callbacks to run at the end of poll().
+    std::vector<Ref<HTTPRequest>> resumed;
+    std::vector<uint64_t> doomed; ///< Connections of canceled in-flight requests, closed by poll().
+    Stats stats;
+
+    Error _parse_url(const std::string& p_url, HTTPRequest& r_request) const;
+    Error _resolve(Host& p_host);
+    Connection* _open(Host& p_host);
+    void _schedule(Host& p_host);
+    void _assign(Connection& p_connection, const Ref<HTTPRequest>& p_request);
+    bool _flush(Connection& p_connection);
+    void _on_readable(Connection& p_connection);
+    bool _parse(Connection& p_connection);
+    bool _parse_headers(Connection& p_connection, HTTPRequest& p_request, std::string_view p_head);
+    size_t _deliver(const Ref<HTTPRequest>& p_request, const uint8_t* p_data, size_t p_size);
+    bool _finish_response(Connection& p_connection);
+    void _update_events(Connection& p_connection);
+    void _close(uint64_t p_id, Error p_error, bool p_retry);
+    void _complete(const Ref<HTTPRequest>& p_request, HTTPRequest::Status p_status, Error p_error);
+    void _resume(HTTPRequest* p_request);
+    bool _cancel(HTTPRequest* p_request);
+
+    friend class HTTPRequest;
+
+public:
+    HTTPClient();
+    ~HTTPClient();
+
+    /** @brief Connections per host, default 4. */
+    void set_max_connections(uint32_t p_count) { max_connections = p_count ? p_count : 1; }
+    uint32_t get_max_connections() const { return max_connections; }
+    /** @brief Requests in flight per connection, default 4; 1 disables pipelining. */
+    void set_max_pipeline(uint32_t p_depth) { max_pipeline = p_depth ? p_depth : 1; }
+    uint32_t get_max_pipeline() const { return max_pipeline; }
+    /** @brief A connection silent this long with requests in flight fails them. */
+    void set_timeout(uint32_t p_ms) { timeout_ms = p_ms; }
+    /** @brief Pooled connections unused this long are closed. Keep it below the server's. */
+    void set_idle_timeout(uint32_t p_ms) { idle_timeout_ms = p_ms; }
+
+    /** @brief Request for an http:// URL, not yet sent. Null if the URL is invalid. */
+    Ref<HTTPRequest> create_request(const std::string& p_method, const std::string& p_url);
+    /** @brief Queues the request. ERR_ALREADY_IN_USE if it was sent before. */
+    Error send(const Ref<HTTPRequest>& p_request);
+
+    /** @brief create_request("GET") and send(); the body ends up in get_body(). */
+    Ref<HTTPRequest> get(const std::string& p_url, HTTPRequest::Callback p_callback = nullptr);
+    /**
+     * @brief Downloads to p_path. With p_resume and a partial file there, only
+     * the missing tail is requested; a server answering 200 instead of 206
+     * restarts the file.
+     */
+    Ref<HTTPRequest> download(const std::string& p_url, const std::string& p_path, bool p_resume, HTTPRequest::Callback p_callback = nullptr);
+
+    /**
+     * @brief Does the pending socket work and runs finished requests' callbacks.
+     * @param p_timeout_ms Longest wait for activity; 0 returns at once.
+     * @return Requests finished during this call.
+     */
+    int poll(int p_timeout_ms = 0);
+    /** @brief Polls until p_request is done. ERR_TIMEOUT if p_timeout_ms (0: none) ran out. */
+    Error wait(HTTPRequest* p_request, uint32_t p_timeout_ms = 0);
+    /** @brief Cancels everything and closes every connection. */
+    void close_all();
+
+    Stats get_stats() const { return stats; }
+};
+
+#endif // HTTP_CLIENT_H
@@ -0,0 +1,1176 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "core/io/http_server.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "core/io/json_utils.h"
+#include "core/io/resources.h"
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr uint64_t LISTEN_ID = 0;
+constexpr uint64_t WAKE_ID = 1;
+constexpr uint64_t SWEEP_INTERVAL_MS = 1000;
+constexpr size_t PIPELINE_OUTPUT_LIMIT = 64 * 1024;
+
+uint64_t _now_ms() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+bool _equals_nocase(std::string_view p_a, std::string_view p_b) {
+    if (p_a.size() != p_b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < p_a.size(); i++) {
+        if (std::tolower(static_cast<unsigned char>(p_a[i])) != std::tolower(static_cast<unsigned char>(p_b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool _contains_nocase(std::string_view p_haystack, std::string_view p_needle) {
+    for (size_t i = 0; i + p_needle.size() <= p_haystack.size(); i++) {
+        if (_equals_nocase(p_haystack.substr(i, p_needle.size()), p_needle)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string_view _trim(std::string_view p_text) {
+    while (!p_text.empty() && (p_text.front() == ' ' || p_text.front() == '\t')) {
+        p_text.remove_prefix(1);
+    }
+    while (!p_text.empty() && (p_text.back() == ' ' || p_text.back() == '\t')) {
+        p_text.remove_suffix(1);
+    }
+    return p_text;
+}
+
+int _hex_digit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+bool _percent_decode(std::string_view p_text, std::string& r_decoded) {
+    r_decoded.clear();
+    r_decoded.reserve(p_text.size());
+    for (size_t i = 0; i < p_text.size(); i++) {
+        if (p_text[i] != '%') {
+            r_decoded += p_text[i];
+            continue;
+        }
+        if (i + 2 >= p_text.size()) {
+            return false;
+        }
+        int high = _hex_digit(p_text[i + 1]);
+        int low = _hex_digit(p_text[i + 2]);
+        if (high < 0 || low < 0 || (high == 0 && low == 0)) {
+            return false;
+        }
+        r_decoded += static_cast<char>(high * 16 + low);
+        i += 2;
+    }
+    return true;
+}
+
+const char* _reason(int p_status) {
+    switch (p_status) {
+        case 200: return "OK";
+        case 204: return "No Content";
+        case 206: return "Partial Content";
+        case 400: return "Bad Request";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 413: return "Payload Too Large";
+        case 416: return "Range Not Satisfiable";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 503: return "Service Unavailable";
+        case 505: return "HTTP Version Not Supported";
+        default: return "Unknown";
+    }
+}
+
+/**
+ * "bytes=a-b", "bytes=a-" or "bytes=-n" against a file of p_size bytes.
+ * Returns false to ignore the header; first > last means unsatisfiable.
+ */
+bool _parse_range(std::string_view p_range, uint64_t p_size, uint64_t& r_first, uint64_t& r_last) {
+    if (p_range.compare(0, 6, "bytes=") != 0 || p_range.find(',') != std::string_view::npos) {
+        return false;
+    }
+    p_range.remove_prefix(6);
+    size_t dash = p_range.find('-');
+    if (dash == std::string_view::npos) {
+        return false;
+    }
+    auto parse = [](std::string_view p_text, uint64_t& r_value) {
+        if (p_text.empty() || p_text.size() > 19) {
+            return false;
+        }
+        r_value = 0;
+        for (char c : p_text) {
+            if (c < '0' || c > '9') {
+                return false;
+            }
+            r_value = r_value * 10 + uint64_t(c - '0');
+        }
+        return true;
+    };
+    std::string_view from = _trim(p_range.substr(0, dash));
+    std::string_view to = _trim(p_range.substr(dash + 1));
+    uint64_t value = 0;
+    if (from.empty()) {
+        // Suffix: the last n bytes.
+        if (!parse(to, value)) {
+            return false;
+        }
+        if (value == 0 || p_size == 0) {
+            r_first = 1;
+            r_last = 0;
+            return true;
+        }
+        r_first = p_size - std::min(value, p_size);
+        r_last = p_size - 1;
+        return true;
+    }
+    if (!parse(from, r_first)) {
+        return false;
+    }
+    if (to.empty()) {
+        r_last = p_size - 1;
+    } else if (!parse(to, r_last) || r_last < r_first) {
+        return false;
+    } else {
+        r_last = std::min(r_last, p_size - 1);
+    }
+    if (r_first >= p_size) {
+        r_first = 1;
+        r_last = 0;
+    }
+    return true;
+}
+
+const char* _mime_type(const std::string& p_path) {
+    static const std::pair<const char*, const char*> types[] = {
+        { "html", "text/html; charset=utf-8" },
+        { "htm", "text/html; charset=utf-8" },
+        { "css", "text/css; charset=utf-8" },
+        { "js", "text/javascript; charset=utf-8" },
+        { "json", "application/json" },
+        { "txt", "text/plain; charset=utf-8" },
+        { "svg", "image/svg+xml" },
+        { "png", "image/png" },
+        { "jpg", "image/jpeg" },
+        { "jpeg", "image/jpeg" },
+        { "gif", "image/gif" },
+        { "webp", "image/webp" },
+        { "wav", "audio/wav" },
+        { "ogg", "audio/ogg" },
+        { "mp3", "audio/mpeg" },
+        { "wasm", "application/wasm" },
+        { "ttf", "font/ttf" },
+        { "woff2", "font/woff2" },
+    };
+    size_t dot = p_path.find_last_of('.');
+    size_t slash = p_path.find_last_of('/');
+    if (dot != std::string::npos && (slash == std::string::npos || dot > slash)) {
+        std::string_view ext(p_path.c_str() + dot + 1);
+        for (const auto& type : types) {
+            if (_equals_nocase(ext, type.first)) {
+                return type.second;
+            }
+        }
+    }
+    return "application/octet-stream";
+}
+
+void _write_resource_cache_stats(JSONWriter& r_writer) {
+    r_writer.begin_object();
+    ResourceCache* cache = ResourceCache::get_singleton();
+    r_writer.key("available");
+    r_writer.value(cache != nullptr);
+    if (cache) {
+        ResourceCache::Stats stats = cache->get_stats();
+        r_writer.key("hits");
+        r_writer.value(stats.hits);
+        r_writer.key("misses");
+        r_writer.value(stats.misses);
+        r_writer.key("hit_rate");
+        r_writer.value(stats.get_hit_rate());
+        r_writer.key("shared_loads");
+        r_writer.value(stats.shared_loads);
+        r_writer.key("failed_loads");
+        r_writer.value(stats.failed_loads);
+        r_writer.key("evictions");
+        r_writer.value(stats.evictions);
+        r_writer.key("demotions");
+        r_writer.value(stats.demotions);
+        r_writer.key("bytes_resident");
+        r_writer.value(stats.bytes_resident);
+        r_writer.key("budget");
+        r_writer.value(stats.budget);
+        r_writer.key("entries");
+        r_writer.value(stats.entries);
+        r_writer.key("pinned");
+        r_writer.value(stats.pinned);
+        r_writer.key("types");
+        r_writer.begin_array();
+        for (const ResourceCache::TypeStats& type : stats.types) {
+            r_writer.begin_object();
+            r_writer.key("type");
+            r_writer.value(type.type);
+            r_writer.key("count");
+            r_writer.value(type.count);
+            r_writer.key("bytes");
+            r_writer.value(type.bytes);
+            r_writer.end_object();
+        }
+        r_writer.end_array();
+    }
+    r_writer.end_object();
+}
+
+} // namespace
+
+struct HTTPServer::Connection {
+    int fd = -1;
+    uint64_t id = 0;
+    uint32_t events = 0; ///< Currently registered with epoll.
+    std::string input;
+    std::string output;
+    size_t output_offset = 0;
+    int file_fd = -1;
+    int64_t file_offset = 0;
+    int64_t file_end = 0;
+    Ref<HTTPStream> stream;
+    bool keep_alive = true; ///< For the response being sent.
+    bool read_closed = false;
+    uint64_t last_active = 0;
+
+    bool is_busy() const { return output_offset < output.size() || file_fd >= 0 || stream.is_valid(); }
+};
+
+// HTTPStream
+
+void HTTPStream::_queue() {
+    if (!queued && server) {
+        queued = true;
+        Ref<HTTPStream> self;
+        self.ref_pointer(this);
+        server->_queue_stream(self);
+    }
+}
+
+bool HTTPStream::write(std::string_view p_data) {
+    std::lock_guard<std::mutex> guard(mutex);
+    if (!server || closed) {
+        return false;
+    }
+    if (p_data.empty()) {
+        return true; // An empty chunk would end the body.
+    }
+    char size[24];
+    snprintf(size, sizeof(size), "%zx\r\n", p_data.size());
+    pending += size;
+    pending.append(p_data.data(), p_data.size());
+    pending += "\r\n";
+    _queue();
+    return true;
+}
+
+void HTTPStream::close() {
+    std::lock_guard<std::mutex> guard(mutex);
+    if (closed) {
+        return;
+    }
+    closed = true;
+    _queue();
+}
+
+bool HTTPStream::is_connected() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    return server && !closed;
+}
+
+// HTTPServer::Request / Response
+
+std::string_view HTTPServer::Request::get_header(std::string_view p_name) const {
+    for (const auto& header : headers) {
+        if (_equals_nocase(header.first, p_name)) {
+            return header.second;
+        }
+    }
+    return std::string_view();
+}
+
+HTTPServer::Response::~Response() {
+#ifdef __linux__
+    if (file_fd >= 0) {
+        ::close(file_fd);
+    }
+#endif
+}
+
+void HTTPServer::Response::set_json(std::string p_json) {
+    content_type = "application/json";
+    body = std::move(p_json);
+}
+
+Error HTTPServer::Response::set_file(const std::string& p_path) {
+#ifdef __linux__
+    if (file_fd >= 0) {
+        ::close(file_fd);
+        file_fd = -1;
+    }
+    int fd = ::open(p_path.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        status = 404;
+        body = "Not found\n";
+        return ERR_FILE_NOT_FOUND;
+    }
+    file_fd = fd;
+    file_offset = 0;
+    file_size = static_cast<uint64_t>(st.st_size);
+    content_type = _mime_type(p_path);
+    body.clear();
+    return OK;
+#else
+    status = 501;
+    return ERR_UNAVAILABLE;
+#endif
+}
+
+Ref<HTTPStream> HTTPServer::Response::begin_stream(const std::string& p_content_type) {
+    if (stream.is_null()) {
+        stream.instantiate();
+        stream->server = server;
+        stream->connection_id = connection_id;
+    }
+    content_type = p_content_type;
+    body.clear();
+    return stream;
+}
+
+// HTTPServer
+
+HTTPServer::HTTPServer() {}
+
+HTTPServer::~HTTPServer() {
+    stop();
+}
+
+void HTTPServer::add_route(const std::string& p_method, const std::string& p_path, Handler p_handler) {
+    Route route;
+    route.method = p_method;
+    route.path = p_path;
+    if (!route.path.empty() && route.path.back() == '*') {
+        route.path.pop_back();
+        route.prefix = true;
+    }
+    route.handler = p_handler;
+    routes.push_back(std::move(route));
+}
+
+void HTTPServer::mount_directory(const std::string& p_prefix, const std::string& p_directory) {
+    Mount mount;
+    mount.prefix = p_prefix;
+    mount.directory = p_directory;
+    while (mount.directory.size() > 1 && mount.directory.back() == '/') {
+        mount.directory.pop_back();
+    }
+    mounts.push_back(std::move(mount));
+    std::stable_sort(mounts.begin(), mounts.end(), [](const Mount& a, const Mount& b) { return a.prefix.size() > b.prefix.size(); });
+}
+
+void HTTPServer::add_json_route(const std::string& p_path, JSONSource p_source) {
+    add_route("GET", p_path, [p_source](const Request&, Response& r_response) {
+        JSONWriter writer;
+        p_source(writer);
+        writer.finish();
+        r_response.set_json(writer.get_string());
+    });
+}
+
+void HTTPServer::add_json_stream(const std::string& p_path, uint32_t p_interval_ms, JSONSource p_source) {
+    std::unique_ptr<JSONStream> stream(new JSONStream);
+    stream->path = p_path;
+    stream->interval_ms = std::max<uint32_t>(1, p_interval_ms);
+    stream->source = p_source;
+    json_streams.push_back(std::move(stream));
+    add_route("GET", p_path, Handler::bind<HTTPServer, &HTTPServer::_stream_json>(this));
+}
+
+void HTTPServer::add_resource_cache_routes(const std::string& p_path) {
+    add_json_route(p_path, [](JSONWriter& r_writer) { _write_resource_cache_stats(r_writer); });
+    add_json_stream(p_path + "/stream", 1000, [](JSONWriter& r_writer) { _write_resource_cache_stats(r_writer); });
+}
+
+void HTTPServer::_stream_json(const Request& p_request, Response& r_response) {
+    for (const std::unique_ptr<JSONStream>& stream : json_streams) {
+        if (stream->path == p_request.path) {
+            if (stream->subscribers.empty()) {
+                stream->next_tick = 0; // First sample right away.
+            }
+            stream->subscribers.push_back(r_response.begin_stream("application/x-ndjson"));
+            return;
+        }
+    }
+}
+
+void HTTPServer::_dispatch(const Request& p_request, Response& r_response) {
+    const std::string_view method = p_request.method == "HEAD" ? std::string_view("GET") : std::string_view(p_request.method);
+    const Route* best = nullptr;
+    for (const Route& route : routes) {
+        if (!route.prefix && route.method == method && route.path == p_request.path) {
+            best = &route;
+            break;
+        }
+    }
+    if (!best) {
+        for (const Route& route : routes) {
+            if (route.prefix && route.method == method && p_request.path.compare(0, route.path.size(), route.path) == 0 && (!best || route.path.size() > best->path.size())) {
+                best = &route;
+            }
+        }
+    }
+    if (best) {
+        best->handler(p_request, r_response);
+        return;
+    }
+    if (method == "GET") {
+        for (const Mount& mount : mounts) {
+            if (p_request.path.compare(0, mount.prefix.size(), mount.prefix) == 0) {
+                _serve_file(mount, p_request, r_response);
+                return;
+            }
+        }
+    }
+    r_response.status = 404;
+    r_response.body = "Not found\n";
+}
+
+void HTTPServer::_serve_file(const Mount& p_mount, const Request& p_request, Response& r_response) {
+    std::string_view relative(p_request.path);
+    relative.remove_prefix(p_mount.prefix.size());
+    // No way out of the mounted directory.
+    size_t start = 0;
+    while (start <= relative.size()) {
+        size_t end = relative.find('/', start);
+        if (end == std::string_view::npos) {
+            end = relative.size();
+        }
+        if (relative.substr(start, end - start) == "..") {
+            r_response.status = 403;
+            r_response.body = "Forbidden\n";
+            return;
+        }
+        start = end + 1;
+    }
+    std::string path = p_mount.directory;
+    if (relative.empty() || relative.front() != '/') {
+        path += '/';
+    }
+    path.append(relative.data(), relative.size());
+    if (path.back() == '/') {
+        path += "index.html";
+    }
+    if (r_response.set_file(path) != OK) {
+        return;
+    }
+    r_response.set_header("Accept-Ranges", "bytes");
+    std::string_view range = p_request.get_header("Range");
+    if (range.empty()) {
+        return;
+    }
+    uint64_t first = 0;
+    uint64_t last = 0;
+    if (!_parse_range(range, r_response.file_size, first, last)) {
+        return; // Malformed or several ranges: the whole file.
+    }
+    if (first > last) {
+        r_response.status = 416;
+        r_response.set_header("Content-Range", "bytes */" + std::to_string(r_response.file_size));
+        r_response.file_size = 0;
+        return;
+    }
+    r_response.status = 206;
+    r_response.set_header("Content-Range", "bytes " + std::to_string(first) + "-" + std::to_string(last) + "/" + std::to_string(r_response.file_size));
+    r_response.file_offset = first;
+    r_response.file_size = last - first + 1;
+}
+
+HTTPServer::Stats HTTPServer::get_stats() const {
+    Stats stats;
+    stats.connections_accepted = stat_accepted.load(std::memory_order_relaxed);
+    stats.connections_rejected = stat_rejected.load(std::memory_order_relaxed);
+    stats.requests = stat_requests.load(std::memory_order_relaxed);
+    stats.bytes_sent = stat_bytes_sent.load(std::memory_order_relaxed);
+    stats.file_bytes_sent = stat_file_bytes_sent.load(std::memory_order_relaxed);
+    stats.active_connections = stat_active_connections.load(std::memory_order_relaxed);
+    stats.active_streams = stat_active_streams.load(std::memory_order_relaxed);
+    return stats;
+}
+
+#ifdef __linux__
+
+Error HTTPServer::start(uint16_t p_port) {
+    if (thread.joinable()) {
+        return ERR_ALREADY_IN_USE;
+    }
+    listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        return ERR_CANT_CREATE;
+    }
+    int one = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(p_port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    Error err = OK;
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        err = errno == EADDRINUSE ? ERR_ALREADY_IN_USE : ERR_CANT_OPEN;
+    } else if (listen(listen_fd, 64) != 0 || getsockname(listen_fd, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        err = ERR_CANT_OPEN;
+    }
+
+    if (err == OK) {
+        epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.u64 = LISTEN_ID;
+        if (epoll_fd < 0 || wake_fd < 0 || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &event) != 0) {
+            err = ERR_CANT_CREATE;
+        } else {
+            event.data.u64 = WAKE_ID;
+            if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &event) != 0) {
+                err = ERR_CANT_CREATE;
+            }
+        }
+    }
+
+    if (err != OK) {
+        for (int* fd : { &listen_fd, &epoll_fd, &wake_fd }) {
+            if (*fd >= 0) {
+                ::close(*fd);
+                *fd = -1;
+            }
+        }
+        return err;
+    }
+
+    port = ntohs(address.sin_port);
+    running.store(true, std::memory_order_release);
+    thread = std::thread(&HTTPServer::_run, this);
+    return OK;
+}
+
+void HTTPServer::stop() {
+    if (!thread.joinable()) {
+        return;
+    }
+    running.store(false, std::memory_order_release);
+    uint64_t one = 1;
+    (void)::write(wake_fd, &one, sizeof(one));
+    thread.join();
+
+    // Detaches every stream, so writers see a disconnected client.
+    while (!connections.empty()) {
+        _close(connections.begin()->first);
+    }
+    for (const std::unique_ptr<JSONStream>& stream : json_streams) {
+        stream->subscribers.clear();
+    }
+    {
+        std::lock_guard<std::mutex> guard(stream_mutex);
+        dirty_streams.clear();
+    }
+    for (int* fd : { &listen_fd, &epoll_fd, &wake_fd }) {
+        ::close(*fd);
+        *fd = -1;
+    }
+}
+
+void HTTPServer::_queue_stream(const Ref<HTTPStream>& p_stream) {
+    bool wake;
+    {
+        std::lock_guard<std::mutex> guard(stream_mutex);
+        wake = dirty_streams.empty();
+        dirty_streams.push_back(p_stream);
+    }
+    if (wake) {
+        uint64_t one = 1;
+        (void)::write(wake_fd, &one, sizeof(one));
+    }
+}
+
+void HTTPServer::_run() {
+    // sendfile() raises SIGPIPE on a reset connection and has no flag
+    // against it; blocking it here keeps the rest of the process untouched.
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &set, nullptr);
+
+    epoll_event events[64];
+    int timeout = -1;
+    while (running.load(std::memory_order_acquire)) {
+        int count = epoll_wait(epoll_fd, events, 64, timeout);
+        if (count < 0 && errno != EINTR) {
+            break;
+        }
+        for (int i = 0; i < count; i++) {
+            const uint64_t id = events[i].data.u64;
+            const uint32_t flags = events[i].events;
+            if (id == LISTEN_ID) {
+                _accept();
+                continue;
+            }
+            if (id == WAKE_ID) {
+                uint64_t value;
+                (void)::read(wake_fd, &value, sizeof(value));
+                _drain_streams();
+                continue;
+            }
+            auto it = connections.find(id);
+            if (it == connections.end()) {
+                continue;
+            }
+            if (flags & EPOLLERR) {
+                _close(id);
+                continue;
+            }
+            if (flags & EPOLLOUT) {
+                _on_writable(*it->second);
+                it = connections.find(id);
+                if (it == connections.end()) {
+                    continue;
+                }
+            }
+            if (flags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) {
+                _on_readable(*it->second);
+            }
+        }
+        timeout = _tick(_now_ms());
+    }
+}
+
+void HTTPServer::_accept() {
+    while (true) {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return; // EAGAIN, or out of descriptors until something closes.
+        }
+        if (connections.size() >= MAX_CONNECTIONS) {
+            ::close(fd);
+            stat_rejected.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        std::unique_ptr<Connection> connection(new Connection);
+        connection->fd = fd;
+        connection->id = next_connection_id++;
+        connection->events = EPOLLIN | EPOLLRDHUP;
+        connection->last_active = _now_ms();
+        epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = connection->events;
+        event.data.u64 = connection->id;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            ::close(fd);
+            continue;
+        }
+        connections.emplace(connection->id, std::move(connection));
+        stat_accepted.fetch_add(1, std::memory_order_relaxed);
+        stat_active_connections.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void HTTPServer::_on_readable(Connection& p_connection) {
+    char buffer[16384];
+    while (true) {
+        ssize_t received = recv(p_connection.fd, buffer, sizeof(buffer), 0);
+        if (received > 0) {
+            p_connection.input.append(buffer, static_cast<size_t>(received));
+            if (p_connection.input.size() > MAX_HEADER_SIZE + MAX_BODY_SIZE) {
+                _close(p_connection.id); // Pipelining far ahead of the responses.
+                return;
+            }
+            continue;
+        }
+        if (received == 0) {
+            p_connection.read_closed = true;
+            break;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        }
+        _close(p_connection.id);
+        return;
+    }
+    p_connection.last_active = _now_ms();
+    _process(p_connection);
+}
+
+void HTTPServer::_on_writable(Connection& p_connection) {
+    p_connection.last_active = _now_ms();
+    if (!_flush(p_connection)) {
+        _close(p_connection.id);
+        return;
+    }
+    _process(p_connection);
+}
+
+void HTTPServer::_process(Connection& p_connection) {
+    // Pipelined requests answered from memory are batched into one send;
+    // a file or stream response holds the rest back until it is done.
+    while (true) {
+        bool answered = false;
+        while (!p_connection.input.empty() && p_connection.keep_alive && p_connection.file_fd < 0 && p_connection.stream.is_null() && p_connection.output.size() - p_connection.output_offset < PIPELINE_OUTPUT_LIMIT) {
+            Request request;
+            bool keep_alive = false;
+            int status = _parse(p_connection, request, keep_alive);
+            if (status == 0) {
+                break;
+            }
+            if (status != 200) {
+                _send_error(p_connection, status);
+            } else {
+                stat_requests.fetch_add(1, std::memory_order_relaxed);
+                Response response;
+                response.server = this;
+                response.connection_id = p_connection.id;
+                _dispatch(request, response);
+                _begin_response(p_connection, response, request.method == "HEAD", keep_alive);
+            }
+            answered = true;
+        }
+        if (!_flush(p_connection)) {
+            _close(p_connection.id);
+            return;
+        }
+        if (!answered || p_connection.is_busy() || p_connection.input.empty()) {
+            break;
+        }
+    }
+    // A stream never ends on its own, so a client that hung up is gone.
+    if (p_connection.read_closed && (!p_connection.is_busy() || p_connection.stream.is_valid())) {
+        _close(p_connection.id);
+        return;
+    }
+    _update_events(p_connection);
+}
+
+int HTTPServer::_parse(Connection& p_connection, Request& r_request, bool& r_keep_alive) {
+    const std::string& input = p_connection.input;
+    size_t header_end = input.find("\r\n\r\n");
+    if (header_end == std::string::npos) {
+        return input.size() > MAX_HEADER_SIZE ? 431 : 0;
+    }
+    if (header_end > MAX_HEADER_SIZE) {
+        return 431;
+    }
+    std::string_view head(input.data(), header_end);
+
+    size_t line_end = head.find("\r\n");
+    std::string_view line = head.substr(0, line_end);
+    size_t first = line.find(' ');
+    size_t second = first == std::string_view::npos ? first : line.find(' ', first + 1);
+    if (second == std::string_view::npos) {
+        return 400;
+    }
+    std::string_view version = line.substr(second + 1);
+    if (version != "HTTP/1.1" && version != "HTTP/1.0") {
+        return 505;
+    }
+    r_request.method.assign(line.data(), first);
+    std::string_view target = line.substr(first + 1, second - first - 1);
+    if (target.empty() || target.front() != '/') {
+        return 400;
+    }
+    size_t question = target.find('?');
+    if (question != std::string_view::npos) {
+        r_request.query.assign(target.substr(question + 1));
+        target = target.substr(0, question);
+    }
+    if (!_percent_decode(target, r_request.path)) {
+        return 400;
+    }
+
+    bool close = false;
+    bool keep_alive = false;
+    uint64_t content_length = 0;
+    while (line_end != std::string_view::npos) {
+        size_t start = line_end + 2;
+        line_end = head.find("\r\n", start);
+        line = head.substr(start, line_end == std::string_view::npos ? std::string_view::npos : line_end - start);
+        size_t colon = line.find(':');
+        if (colon == std::string_view::npos || colon == 0) {
+            return 400;
+        }
+        std::string_view name = line.substr(0, colon);
+        std::string_view value = _trim(line.substr(colon + 1));
+        if (_equals_nocase(name, "Connection")) {
+            close = close || _contains_nocase(value, "close");
+            keep_alive = keep_alive || _contains_nocase(value, "keep-alive");
+        } else if (_equals_nocase(name, "Transfer-Encoding")) {
+            return 501; // Chunked request bodies are not needed by any local tool.
+        } else if (_equals_nocase(name, "Content-Length")) {
+            if (value.empty() || value.size() > 10) {
+                return value.empty() ? 400 : 413;
+            }
+            content_length = 0;
+            for (char c : value) {
+                if (c < '0' || c > '9') {
+                    return 400;
+                }
+                content_length = content_length * 10 + uint64_t(c - '0');
+            }
+            if (content_length > MAX_BODY_SIZE) {
+                return 413;
+            }
+        }
+        r_request.headers.emplace_back(std::string(name), std::string(value));
+    }
+
+    const size_t total = header_end + 4 + static_cast<size_t>(content_length);
+    if (input.size() < total) {
+        return 0;
+    }
+    r_request.body.assign(input, header_end + 4, static_cast<size_t>(content_length));
+    r_keep_alive = version == "HTTP/1.1" ? !close : keep_alive;
+    p_connection.input.erase(0, total);
+    return 200;
+}
+
+void HTTPServer::_begin_response(Connection& p_connection, Response& p_response, bool p_head, bool p_keep_alive) {
+    p_connection.keep_alive = p_keep_alive;
+    std::string& out = p_connection.output;
+    out += "HTTP/1.1 ";
+    out += std::to_string(p_response.status);
+    out += ' ';
+    out += _reason(p_response.status);
+    out += "\r\nContent-Type: ";
+    out += p_response.content_type;
+    out += "\r\n";
+    for (const auto& header : p_response.headers) {
+        out += header.first;
+        out += ": ";
+        out += header.second;
+        out += "\r\n";
+    }
+    if (p_response.stream.is_valid()) {
+        out += "Transfer-Encoding: chunked\r\n";
+    } else {
+        out += "Content-Length: ";
+        out += std::to_string(p_response.file_fd >= 0 ? p_response.file_size : p_response.body.size());
+        out += "\r\n";
+    }
+    out += p_keep_alive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+
+    if (p_response.stream.is_valid()) {
+        if (p_head) {
+            std::lock_guard<std::mutex> guard(p_response.stream->mutex);
+            p_response.stream->server = nullptr;
+        } else {
+            p_connection.stream = p_response.stream;
+            stat_active_streams.fetch_add(1, std::memory_order_relaxed);
+        }
+    } else if (p_response.file_fd >= 0) {
+        if (!p_head && p_response.file_size > 0) {
+            p_connection.file_fd = p_response.file_fd;
+            p_connection.file_offset = static_cast<int64_t>(p_response.file_offset);
+            p_connection.file_end = static_cast<int64_t>(p_response.file_offset + p_response.file_size);
+            p_response.file_fd = -1;
+        }
+    } else if (!p_head) {
+        out += p_response.body;
+    }
+}
+
+void HTTPServer::_send_error(Connection& p_connection, int p_status) {
+    Response response;
+    response.status = p_status;
+    response.body = _reason(p_status);
+    response.body += '\n';
+    _begin_response(p_connection, response, false, false);
+    // The rest of the input cannot be trusted to start at a request.
+    p_connection.input.clear();
+    p_connection.read_closed = true;
+}
+
+bool HTTPServer::_flush(Connection& p_connection) {
+    while (p_connection.output_offset < p_connection.output.size()) {
+        // MSG_MORE holds back the headers until the file data joins them.
+        int flags = MSG_NOSIGNAL | (p_connection.file_fd >= 0 ? MSG_MORE : 0);
+        ssize_t sent = send(p_connection.fd, p_connection.output.data() + p_connection.output_offset, p_connection.output.size() - p_connection.output_offset, flags);
+        if (sent > 0) {
+            p_connection.output_offset += static_cast<size_t>(sent);
+            stat_bytes_sent.fetch_add(static_cast<uint64_t>(sent), std::memory_order_relaxed);
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        return sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+    p_connection.output.clear();
+    p_connection.output_offset = 0;
+
+    while (p_connection.file_fd >= 0 && p_connection.file_offset < p_connection.file_end) {
+        off_t offset = static_cast<off_t>(p_connection.file_offset);
+        size_t chunk = static_cast<size_t>(std::min<int64_t>(p_connection.file_end - p_connection.file_offset, 1 << 20));
+        ssize_t sent = sendfile(p_connection.fd, p_connection.file_fd, &offset, chunk);
+        if (sent > 0) {
+            p_connection.file_offset = static_cast<int64_t>(offset);
+            stat_bytes_sent.fetch_add(static_cast<uint64_t>(sent), std::memory_order_relaxed);
+            stat_file_bytes_sent.fetch_add(static_cast<uint64_t>(sent), std::memory_order_relaxed);
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        // 0 means the file shrank, the promised length cannot be met.
+        return sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+    if (p_connection.file_fd >= 0) {
+        ::close(p_connection.file_fd);
+        p_connection.file_fd = -1;
+    }
+    return p_connection.is_busy() || p_connection.keep_alive;
+}
+
+void HTTPServer::_update_events(Connection& p_connection) {
+    uint32_t events = 0;
+    if (!p_connection.read_closed) {
+        events |= EPOLLIN | EPOLLRDHUP;
+    }
+    if (p_connection.output_offset < p_connection.output.size() || p_connection.file_fd >= 0) {
+        events |= EPOLLOUT;
+    }
+    if (events != p_connection.events) {
+        epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = events;
+        event.data.u64 = p_connection.id;
+        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, p_connection.fd, &event);
+        p_connection.events = events;
+    }
+}
+
+void HTTPServer::_close(uint64_t p_id) {
+    auto it = connections.find(p_id);
+    if (it == connections.end()) {
+        return;
+    }
+    Connection& connection = *it->second;
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, connection.fd, nullptr);
+    ::close(connection.fd);
+    if (connection.file_fd >= 0) {
+        ::close(connection.file_fd);
+    }
+    if (connection.stream.is_valid()) {
+        std::lock_guard<std::mutex> guard(connection.stream->mutex);
+        connection.stream->server = nullptr;
+        stat_active_streams.fetch_sub(1, std::memory_order_relaxed);
+    }
+    connections.erase(it);
+    stat_active_connections.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void HTTPServer::_end_stream(Connection& p_connection) {
+    {
+        std::lock_guard<std::mutex> guard(p_connection.stream->mutex);
+        p_connection.stream->closed = true;
+        p_connection.stream->server = nullptr;
+    }
+    p_connection.output += "0\r\n\r\n";
+    p_connection.stream.unref();
+    stat_active_streams.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void HTTPServer::_drain_streams() {
+    std::vector<Ref<HTTPStream>> streams;
+    {
+        std::lock_guard<std::mutex> guard(stream_mutex);
+        streams.swap(dirty_streams);
+    }
+    for (const Ref<HTTPStream>& stream : streams) {
+        std::string data;
+        bool closed;
+        {
+            std::lock_guard<std::mutex> guard(stream->mutex);
+            data.swap(stream->pending);
+            stream->queued = false;
+            closed = stream->closed;
+        }
+        auto it = connections.find(stream->connection_id);
+        if (it == connections.end() || it->second->stream != stream) {
+            continue;
+        }
+        Connection& connection = *it->second;
+        connection.output += data;
+        if (closed) {
+            _end_stream(connection);
+        }
+        if (connection.output.size() - connection.output_offset > MAX_PENDING_OUTPUT) {
+            _close(connection.id);
+            continue;
+        }
+        if (!_flush(connection)) {
+            _close(connection.id);
+            continue;
+        }
+        _process(connection);
+    }
+}
+
+int HTTPServer::_tick(uint64_t p_now) {
+    uint64_t next = UINT64_MAX;
+
+    for (const std::unique_ptr<JSONStream>& stream : json_streams) {
+        std::vector<Ref<HTTPStream>>& subscribers = stream->subscribers;
+        subscribers.erase(std::remove_if(subscribers.begin(), subscribers.end(), [](const Ref<HTTPStream>& s) { return !s->is_connected(); }), subscribers.end());
+        if (subscribers.empty()) {
+            continue;
+        }
+        if (p_now >= stream->next_tick) {
+            JSONWriter writer;
+            stream->source(writer);
+            writer.finish();
+            std::string line = writer.get_string();
+            line += '\n';
+            for (const Ref<HTTPStream>& subscriber : subscribers) {
+                subscriber->write(line);
+            }
+            stream->next_tick = p_now + stream->interval_ms;
+        }
+        next = std::min(next, stream->next_tick);
+    }
+
+    if (!connections.empty()) {
+        if (p_now >= next_sweep) {
+            std::vector<uint64_t> expired;
+            std::vector<uint64_t> abandoned;
+            for (const auto& it : connections) {
+                const Connection& connection = *it.second;
+                if (connection.stream.is_valid()) {
+                    // Only the connection still holds it: ended without close().
+                    if (connection.stream->get_reference_count() == 1) {
+                        abandoned.push_back(it.first);
+                    }
+                } else if (!connection.is_busy() && p_now - connection.last_active >= keep_alive_timeout_ms) {
+                    expired.push_back(it.first);
+                }
+            }
+            for (uint64_t id : expired) {
+                _close(id);
+            }
+            for (uint64_t id : abandoned) {
+                Connection& connection = *connections[id];
+                _end_stream(connection);
+                if (!_flush(connection)) {
+                    _close(id);
+                } else {
+                    _process(connection);
+                }
+            }
+            next_sweep = p_now + SWEEP_INTERVAL_MS;
+        }
+        if (!connections.empty()) {
+            next = std::min(next, next_sweep);
+        }
+    }
+
+    if (next == UINT64_MAX) {
+        return -1; // Nothing scheduled: sleep until a socket or stream wakes us.
+    }
+    return static_cast<int>(next > p_now ? std::min<uint64_t>(next - p_now, 60000) : 0);
+}
+
+#else
+
+Error HTTPServer::start(uint16_t p_port) {
+    (void)p_port;
+    return ERR_UNAVAILABLE;
+}
+
+void HTTPServer::stop() {}
+
+void HTTPServer::_queue_stream(const Ref<HTTPStream>& p_stream) {
+    (void)p_stream;
+}
+
+#endif // __linux__
@@ -0,0 +1,267 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef HTTP_SERVER_H
+#define HTTP_SERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/error/error_list.h"
+#include "core/object/ref_counted.h"
+#include "core/templates/delegate.h"
+
+class HTTPServer;
+class JSONWriter;
+
+/**
+ * @class HTTPStream
+ * @brief Chunked response body that stays open after the handler returns.
+ *
+ * Returned by HTTPServer::Response::begin_stream(). write() may be called
+ * from any thread; each call becomes one chunk. The response ends with
+ * close(). A stream released without close() is ended by the next idle
+ * sweep. The connection then carries on with the next keep-alive request.
+ */
+class HTTPStream : public RefCounted {
+private:
+    friend class HTTPServer;
+
+    mutable std::mutex mutex;
+    HTTPServer* server = nullptr; ///< Null once the client went away.
+    uint64_t connection_id = 0;
+    std::string pending; ///< Framed chunks not yet handed to the server.
+    bool queued = false; ///< On the server's dirty list.
+    bool closed = false;
+
+    void _queue();
+
+public:
+    /** @return false if the client disconnected or the stream is closed. */
+    bool write(std::string_view p_data);
+    void close();
+    bool is_connected() const;
+};
+
+/**
+ * @class HTTPServer
+ * @brief Embedded HTTP/1.1 server for local tools: asset serving and live stats.
+ *
+ * One background thread runs an epoll loop over non-blocking sockets bound
+ * to 127.0.0.1 only. Connections are kept alive and may pipeline; requests
+ * are answered in order. Handlers run on the server thread and fill a
+ * Response: a body, a file, or a chunked stream. Files go out with
+ * sendfile(), so static assets never pass through user space.
+ *
+ * With nothing to do the thread sleeps in epoll_wait() without a timeout;
+ * it only wakes periodically while connections are open (idle keep-alive
+ * sweep) or JSON streams have subscribers.
+ *
+ * Routes, mounts and the keep-alive timeout are set before start(). Linux
+ * only; start() returns ERR_UNAVAILABLE elsewhere.
+ *
+ * @code
+ *     HTTPServer server;
+ *     server.mount_directory("/assets/", "/game/data");
+ *     server.add_json_stream("/stats/frame", 250, Delegate<void(JSONWriter&)>::bind<Profiler, &Profiler::write_json>(&profiler));
+ *     server.start(6006);
+ * @endcode
+ */
+class HTTPServer {
+public:
+    struct Request {
+        std::string method;
+        std::string path; ///< Percent-decoded, without the query.
+        std::string query;
+        std::vector<std::pair<std::string, std::string>> headers;
+        std::string body;
+
+        /** @brief Case-insensitive lookup, empty if absent. */
+        std::string_view get_header(std::string_view p_name) const;
+    };
+
+    class Response {
+    private:
+        friend class HTTPServer;
+
+        HTTPServer* server = nullptr;
+        uint64_t connection_id = 0;
+        int file_fd = -1;
+        uint64_t file_offset = 0;
+        uint64_t file_size = 0; ///< Bytes to send from file_offset.
+        Ref<HTTPStream> stream;
+
+    public:
+        int status = 200;
+        std::string content_type = "text/plain; charset=utf-8";
+        std::vector<std::pair<std::string, std::string>> headers;
+        std::string body;
+
+        Response() {}
+        Response(const Response&) = delete;
+        Response& operator=(const Response&) = delete;
+        ~Response();
+
+        void set_header(const std::string& p_name, const std::string& p_value) { headers.emplace_back(p_name, p_value); }
+        void set_json(std::string p_json);
+        /** @brief Sends the file with sendfile(). ERR_FILE_NOT_FOUND also sets status 404. */
+        Error set_file(const std::string& p_path);
+        /** @brief Answers with a chunked body fed through the returned stream. */
+        Ref<HTTPStream> begin_stream(const std::string& p_content_type);
+    };
+
+    typedef Delegate<void(const Request&, Response&)> Handler;
+    typedef Delegate<void(JSONWriter&)> JSONSource;
+
+    struct Stats {
+        uint64_t connections_accepted = 0;
+        uint64_t connections_rejected = 0;
+        uint64_t requests = 0;
+        uint64_t bytes_sent = 0;
+        uint64_t file_bytes_sent = 0; ///< Through sendfile(), included in bytes_sent.
+        uint32_t active_connections = 0;
+        uint32_t active_streams = 0;
+    };
+
+    static constexpr size_t MAX_HEADER_SIZE = 16 * 1024;
+    static constexpr size_t MAX_BODY_SIZE = 1024 * 1024;
+    static constexpr size_t MAX_PENDING_OUTPUT = 8 * 1024 * 1024; ///< A slower client is dropped.
+    static constexpr uint32_t MAX_CONNECTIONS = 256;
+
+private:
+    struct Connection;
+
+    struct Route {
+        std::string method;
+        std::string path;
+        bool prefix = false;
+        Handler handler;
+    };
+
+    struct Mount {
+        std::string prefix;
+        std::string directory;
+    };
+
+    struct JSONStream {
+        std::string path;
+        uint32_t interval_ms = 0;
+        JSONSource source;
+        uint64_t next_tick = 0;
+        std::vector<Ref<HTTPStream>> subscribers;
+    };
+
+    std::vector<Route> routes;
+    std::vector<Mount> mounts; ///< Longest prefix first.
+    std::vector<std::unique_ptr<JSONStream>> json_streams;
+    uint32_t keep_alive_timeout_ms = 15000;
+
+    int listen_fd = -1;
+    int epoll_fd = -1;
+    int wake_fd = -1;
+    uint16_t port = 0;
+    std::thread thread;
+    std::atomic<bool> running{ false };
+
+    std::unordered_map<uint64_t, std::unique_ptr<Connection>> connections;
+    uint64_t next_connection_id = 2; ///< 0 and 1 tag the listening socket and the eventfd.
+    uint64_t next_sweep = 0;
+
+    std::mutex stream_mutex;
+    std::vector<Ref<HTTPStream>> dirty_streams;
+
+    std::atomic<uint64_t> stat_accepted{ 0 };
+    std::atomic<uint64_t> stat_rejected{ 0 };
+    std::atomic<uint64_t> stat_requests{ 0 };
+    std::atomic<uint64_t> stat_bytes_sent{ 0 };
+    std::atomic<uint64_t> stat_file_bytes_sent{ 0 };
+    std::atomic<uint32_t> stat_active_connections{ 0 };
+    std::atomic<uint32_t> stat_active_streams{ 0 };
+
+    void _run();
+    void _accept();
+    void _on_readable(Connection& p_connection);
+    void _on_writable(Connection& p_connection);
+    void _process(Connection& p_connection);
+    int _parse(Connection& p_connection, Request& r_request, bool& r_keep_alive);
+    void _dispatch(const Request& p_request, Response& r_response);
+    void _serve_file(const Mount& p_mount, const Request& p_request, Response& r_response);
+    void _begin_response(Connection& p_connection, Response& p_response, bool p_head, bool p_keep_alive);
+    void _send_error(Connection& p_connection, int p_status);
+    bool _flush(Connection& p_connection);
+    void _update_events(Connection& p_connection);
+    void _close(uint64_t p_id);
+    void _end_stream(Connection& p_connection);
+    void _drain_streams();
+    void _queue_stream(const Ref<HTTPStream>& p_stream);
+    int _tick(uint64_t p_now);
+    void _stream_json(const Request& p_request, Response& r_response);
+
+    friend class HTTPStream;
+
+public:
+    HTTPServer();
+    ~HTTPServer();
+
+    /**
+     * @brief Exact route, or a prefix route if p_path ends with '*'.
+     * Exact routes win, then the longest prefix. HEAD runs the GET handler
+     * and drops the body.
+     */
+    void add_route(const std::string& p_method, const std::string& p_path, Handler p_handler);
+    /**
+     * @brief Serves GET/HEAD below p_prefix from p_directory, index.html for
+     * directories. A single "Range: bytes=" range is answered with 206.
+     */
+    void mount_directory(const std::string& p_prefix, const std::string& p_directory);
+    /** @brief GET p_path answers with the JSON p_source writes. */
+    void add_json_route(const std::string& p_path, JSONSource p_source);
+    /**
+     * @brief GET p_path streams one JSON document per line every p_interval_ms.
+     * The source runs once per tick however many clients listen, and not at
+     * all while none do.
+     */
+    void add_json_stream(const std::string& p_path, uint32_t p_interval_ms, JSONSource p_source);
+    /** @brief ResourceCache stats as p_path and, streamed every second, p_path + "/stream". */
+    void add_resource_cache_routes(const std::string& p_path = "/stats/resources");
+    void set_keep_alive_timeout(uint32_t p_ms) { keep_alive_timeout_ms = p_ms; }
+
+    /** @brief Binds 127.0.0.1:p_port (0 picks a free port) and starts the server thread. */
+    Error start(uint16_t p_port);
+    /** @brief Closes every connection and joins the server thread. */
+    void stop();
+    bool is_running() const { return running.load(std::memory_order_acquire); }
+    uint16_t get_port() const { return port; }
+
+    Stats get_stats() const;
+};
+
+#endif // HTTP_SERVER_H
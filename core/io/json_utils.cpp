@@ -0,0 +1,1185 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "core/io/json_utils.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "core/io/file_access.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define JSON_SSE2
+#endif
+#if defined(__PCLMUL__)
+#include <wmmintrin.h>
+#define JSON_PCLMUL
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+enum CharClass : uint8_t {
+    CLASS_QUOTE = 1,
+    CLASS_BACKSLASH = 2,
+    CLASS_OPERATOR = 4,
+    CLASS_SPACE = 8,
+};
+
+struct ClassTable {
+    uint8_t table[256] = {};
+    ClassTable() {
+        table[uint8_t('"')] = CLASS_QUOTE;
+        table[uint8_t('\\')] = CLASS_BACKSLASH;
+        for (char c : { '{', '}', '[', ']', ':', ',' }) {
+            table[uint8_t(c)] = CLASS_OPERATOR;
+        }
+        for (char c : { ' ', '\t', '\n', '\r' }) {
+            table[uint8_t(c)] = CLASS_SPACE;
+        }
+    }
+};
+const ClassTable char_classes;
+
+struct BlockMasks {
+    uint64_t quote = 0;
+    uint64_t backslash = 0;
+    uint64_t op = 0;
+    uint64_t space = 0;
+};
+
+inline void _classify(const uint8_t* p_block, BlockMasks& r_masks) {
+#ifdef JSON_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i lower = _mm_set1_epi8(0x20);
+    const __m128i open = _mm_set1_epi8('{');
+    const __m128i close = _mm_set1_epi8('}');
+    const __m128i colon = _mm_set1_epi8(':');
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    for (int i = 0; i < 4; i++) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_block + i * 16));
+        // '[' | 0x20 == '{' and ']' | 0x20 == '}'.
+        const __m128i folded = _mm_or_si128(v, lower);
+        const __m128i op = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(folded, open), _mm_cmpeq_epi8(folded, close)),
+                _mm_or_si128(_mm_cmpeq_epi8(v, colon), _mm_cmpeq_epi8(v, comma)));
+        const __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)),
+                _mm_or_si128(_mm_cmpeq_epi8(v, newline), _mm_cmpeq_epi8(v, cr)));
+        const int shift = i * 16;
+        r_masks.quote |= uint64_t(uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote)))) << shift;
+        r_masks.backslash |= uint64_t(uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, backslash)))) << shift;
+        r_masks.op |= uint64_t(uint16_t(_mm_movemask_epi8(op))) << shift;
+        r_masks.space |= uint64_t(uint16_t(_mm_movemask_epi8(ws))) << shift;
+    }
+#else
+    for (int i = 0; i < 64; i++) {
+        const uint64_t bit = uint64_t(1) << i;
+        switch (char_classes.table[p_block[i]]) {
+            case CLASS_QUOTE:
+                r_masks.quote |= bit;
+                break;
+            case CLASS_BACKSLASH:
+                r_masks.backslash |= bit;
+                break;
+            case CLASS_OPERATOR:
+                r_masks.op |= bit;
+                break;
+            case CLASS_SPACE:
+                r_masks.space |= bit;
+                break;
+            default:
+                break;
+        }
+    }
+#endif
+}
+
+// Bit i of the result is the xor of bits 0..i: 1 from an opening quote up
+// to (not including) the closing one.
+inline uint64_t _prefix_xor(uint64_t p_bits) {
+#ifdef JSON_PCLMUL
+    const __m128i all_ones = _mm_set1_epi8(char(0xFF));
+    return uint64_t(_mm_cvtsi128_si64(_mm_clmulepi64_si128(_mm_set_epi64x(0, int64_t(p_bits)), all_ones, 0)));
+#else
+    p_bits ^= p_bits << 1;
+    p_bits ^= p_bits << 2;
+    p_bits ^= p_bits << 4;
+    p_bits ^= p_bits << 8;
+    p_bits ^= p_bits << 16;
+    p_bits ^= p_bits << 32;
+    return p_bits;
+#endif
+}
+
+inline int _count_trailing_zeros(uint64_t p_bits) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, p_bits);
+    return int(index);
+#else
+    return __builtin_ctzll(p_bits);
+#endif
+}
+
+inline bool _is_delimiter(char c) {
+    return char_classes.table[uint8_t(c)] & (CLASS_OPERATOR | CLASS_SPACE);
+}
+
+inline bool _is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Length of the JSON number at the start of p_text, 0 if there is none.
+// std::from_chars alone accepts "01" and "1.".
+size_t _json_number_length(std::string_view p_text, bool& r_integer) {
+    size_t i = 0;
+    const size_t n = p_text.size();
+    if (i < n && p_text[i] == '-') {
+        i++;
+    }
+    if (i >= n || !_is_digit(p_text[i])) {
+        return 0;
+    }
+    if (p_text[i] == '0') {
+        i++;
+    } else {
+        while (i < n && _is_digit(p_text[i])) {
+            i++;
+        }
+    }
+    r_integer = true;
+    if (i < n && p_text[i] == '.') {
+        r_integer = false;
+        if (++i >= n || !_is_digit(p_text[i])) {
+            return 0;
+        }
+        while (i < n && _is_digit(p_text[i])) {
+            i++;
+        }
+    }
+    if (i < n && (p_text[i] == 'e' || p_text[i] == 'E')) {
+        r_integer = false;
+        i++;
+        if (i < n && (p_text[i] == '+' || p_text[i] == '-')) {
+            i++;
+        }
+        if (i >= n || !_is_digit(p_text[i])) {
+            return 0;
+        }
+        while (i < n && _is_digit(p_text[i])) {
+            i++;
+        }
+    }
+    return i;
+}
+
+bool _is_json_number(std::string_view p_text, bool& r_integer) {
+    return !p_text.empty() && _json_number_length(p_text, r_integer) == p_text.size();
+}
+
+void _append_utf8(std::string& r_out, uint32_t p_code) {
+    if (p_code < 0x80) {
+        r_out += char(p_code);
+    } else if (p_code < 0x800) {
+        r_out += char(0xC0 | (p_code >> 6));
+        r_out += char(0x80 | (p_code & 0x3F));
+    } else if (p_code < 0x10000) {
+        r_out += char(0xE0 | (p_code >> 12));
+        r_out += char(0x80 | ((p_code >> 6) & 0x3F));
+        r_out += char(0x80 | (p_code & 0x3F));
+    } else {
+        r_out += char(0xF0 | (p_code >> 18));
+        r_out += char(0x80 | ((p_code >> 12) & 0x3F));
+        r_out += char(0x80 | ((p_code >> 6) & 0x3F));
+        r_out += char(0x80 | (p_code & 0x3F));
+    }
+}
+
+bool _read_hex4(std::string_view p_text, size_t p_at, uint32_t& r_code) {
+    if (p_at + 4 > p_text.size()) {
+        return false;
+    }
+    r_code = 0;
+    for (size_t i = p_at; i < p_at + 4; i++) {
+        char c = p_text[i];
+        uint32_t digit;
+        if (c >= '0' && c <= '9') {
+            digit = uint32_t(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            digit = uint32_t(c - 'a' + 10);
+        } else if (c >= 'A' && c <= 'F') {
+            digit = uint32_t(c - 'A' + 10);
+        } else {
+            return false;
+        }
+        r_code = (r_code << 4) | digit;
+    }
+    return true;
+}
+
+Error _unescape(std::string_view p_raw, std::string& r_out) {
+    r_out.clear();
+    r_out.reserve(p_raw.size());
+    size_t i = 0;
+    while (i < p_raw.size()) {
+        const char* backslash = static_cast<const char*>(memchr(p_raw.data() + i, '\\', p_raw.size() - i));
+        size_t run_end = backslash ? size_t(backslash - p_raw.data()) : p_raw.size();
+        r_out.append(p_raw.data() + i, run_end - i);
+        if (!backslash) {
+            break;
+        }
+        i = run_end + 1;
+        if (i >= p_raw.size()) {
+            return ERR_PARSE_ERROR;
+        }
+        switch (p_raw[i++]) {
+            case '"':
+                r_out += '"';
+                break;
+            case '\\':
+                r_out += '\\';
+                break;
+            case '/':
+                r_out += '/';
+                break;
+            case 'b':
+                r_out += '\b';
+                break;
+            case 'f':
+                r_out += '\f';
+                break;
+            case 'n':
+                r_out += '\n';
+                break;
+            case 'r':
+                r_out += '\r';
+                break;
+            case 't':
+                r_out += '\t';
+                break;
+            case 'u': {
+                uint32_t code;
+                if (!_read_hex4(p_raw, i, code)) {
+                    return ERR_PARSE_ERROR;
+                }
+                i += 4;
+                // A high surrogate must be followed by an escaped low one.
+                if (code >= 0xD800 && code < 0xDC00) {
+                    uint32_t low;
+                    if (i + 6 > p_raw.size() || p_raw[i] != '\\' || p_raw[i + 1] != 'u' || !_read_hex4(p_raw, i + 2, low) || low < 0xDC00 || low >= 0xE000) {
+                        return ERR_PARSE_ERROR;
+                    }
+                    i += 6;
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                } else if (code >= 0xDC00 && code < 0xE000) {
+                    return ERR_PARSE_ERROR;
+                }
+                _append_utf8(r_out, code);
+            } break;
+            default:
+                return ERR_PARSE_ERROR;
+        }
+    }
+    return OK;
+}
+
+} // namespace
+
+// JSONValue
+
+char JSONValue::_first() const {
+    return document->data[document->structurals[index]];
+}
+
+size_t JSONValue::_position() const {
+    return document->structurals[index];
+}
+
+JSONValue::Type JSONValue::get_type() const {
+    if (!document) {
+        return TYPE_INVALID;
+    }
+    switch (_first()) {
+        case '{':
+            return TYPE_OBJECT;
+        case '[':
+            return TYPE_ARRAY;
+        case '"':
+            return TYPE_STRING;
+        case 't':
+        case 'f':
+            return TYPE_BOOL;
+        case 'n':
+            return TYPE_NULL;
+        default:
+            return TYPE_NUMBER;
+    }
+}
+
+Error JSONValue::get_bool(bool& r_value) const {
+    if (get_type() != TYPE_BOOL) {
+        return ERR_INVALID_DATA;
+    }
+    std::string_view raw = get_raw();
+    if (raw == "true" || raw == "false") {
+        r_value = raw[0] == 't';
+        return OK;
+    }
+    return ERR_PARSE_ERROR;
+}
+
+Error JSONValue::get_int(int64_t& r_value) const {
+    if (get_type() != TYPE_NUMBER) {
+        return ERR_INVALID_DATA;
+    }
+    std::string_view raw = get_raw();
+    bool integer;
+    if (!_is_json_number(raw, integer)) {
+        return ERR_PARSE_ERROR;
+    }
+    if (!integer) {
+        return ERR_INVALID_DATA;
+    }
+    std::from_chars_result result = std::from_chars(raw.data(), raw.data() + raw.size(), r_value);
+    return result.ec == std::errc() ? OK : ERR_INVALID_DATA; // Out of range.
+}
+
+Error JSONValue::get_double(double& r_value) const {
+    if (get_type() != TYPE_NUMBER) {
+        return ERR_INVALID_DATA;
+    }
+    std::string_view raw = get_raw();
+    bool integer;
+    if (!_is_json_number(raw, integer)) {
+        return ERR_PARSE_ERROR;
+    }
+    std::from_chars_result result = std::from_chars(raw.data(), raw.data() + raw.size(), r_value);
+    if (result.ec == std::errc::result_out_of_range) {
+        r_value = raw[0] == '-' ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+        return OK;
+    }
+    return result.ec == std::errc() ? OK : ERR_PARSE_ERROR;
+}
+
+Error JSONValue::get_string_view(std::string_view& r_value) const {
+    if (get_type() != TYPE_STRING) {
+        return ERR_INVALID_DATA;
+    }
+    size_t start = _position();
+    size_t end = document->_string_end(start);
+    if (end == std::string::npos) {
+        return ERR_PARSE_ERROR;
+    }
+    r_value = std::string_view(document->data + start + 1, end - start - 1);
+    return OK;
+}
+
+Error JSONValue::get_string(std::string& r_value) const {
+    std::string_view raw;
+    Error err = get_string_view(raw);
+    if (err != OK) {
+        return err;
+    }
+    if (!memchr(raw.data(), '\\', raw.size())) {
+        r_value.assign(raw.data(), raw.size());
+        return OK;
+    }
+    return _unescape(raw, r_value);
+}
+
+std::string_view JSONValue::get_raw() const {
+    if (!document) {
+        return std::string_view();
+    }
+    size_t start = _position();
+    size_t end;
+    switch (_first()) {
+        case '{':
+        case '[':
+            end = document->structurals[document->matches[index]] + 1;
+            break;
+        case '"':
+            end = document->_string_end(start);
+            end = end == std::string::npos ? start : end + 1;
+            break;
+        default:
+            end = document->_scalar_end(start);
+            break;
+    }
+    return std::string_view(document->data + start, end - start);
+}
+
+bool JSONValue::as_bool(bool p_default) const {
+    bool value;
+    return get_bool(value) == OK ? value : p_default;
+}
+
+int64_t JSONValue::as_int(int64_t p_default) const {
+    int64_t value;
+    if (get_int(value) == OK) {
+        return value;
+    }
+    double real;
+    if (get_double(real) == OK && real >= -9.2e18 && real <= 9.2e18) {
+        return int64_t(real);
+    }
+    return p_default;
+}
+
+double JSONValue::as_double(double p_default) const {
+    double value;
+    return get_double(value) == OK ? value : p_default;
+}
+
+std::string JSONValue::as_string(const std::string& p_default) const {
+    std::string value;
+    return get_string(value) == OK ? value : p_default;
+}
+
+Variant JSONValue::to_variant() const {
+    switch (get_type()) {
+        case TYPE_BOOL:
+            return Variant(as_bool());
+        case TYPE_NUMBER: {
+            int64_t integer;
+            if (get_int(integer) == OK) {
+                return Variant(integer);
+            }
+            return Variant(as_double());
+        }
+        case TYPE_STRING:
+            return Variant(as_string());
+        default:
+            return Variant();
+    }
+}
+
+JSONValue JSONValue::operator[](std::string_view p_key) const {
+    for (Field field : get_object()) {
+        if (field.key == p_key) {
+            return field.value;
+        }
+    }
+    return JSONValue();
+}
+
+JSONValue JSONValue::operator[](size_t p_index) const {
+    size_t i = 0;
+    for (JSONValue element : get_array()) {
+        if (i++ == p_index) {
+            return element;
+        }
+    }
+    return JSONValue();
+}
+
+size_t JSONValue::size() const {
+    size_t count = 0;
+    Type type = get_type();
+    if (type == TYPE_ARRAY) {
+        for (ArrayIterator it = get_array().first, end = get_array().last; it != end; ++it) {
+            count++;
+        }
+    } else if (type == TYPE_OBJECT) {
+        for (ObjectIterator it = get_object().first, end = get_object().last; it != end; ++it) {
+            count++;
+        }
+    }
+    return count;
+}
+
+JSONValue::Range<JSONValue::ArrayIterator> JSONValue::get_array() const {
+    if (get_type() != TYPE_ARRAY) {
+        return { ArrayIterator(nullptr, 0), ArrayIterator(nullptr, 0) };
+    }
+    return { ArrayIterator(document, index + 1), ArrayIterator(document, document->matches[index]) };
+}
+
+JSONValue::Range<JSONValue::ObjectIterator> JSONValue::get_object() const {
+    if (get_type() != TYPE_OBJECT) {
+        return { ObjectIterator(nullptr, 0), ObjectIterator(nullptr, 0) };
+    }
+    return { ObjectIterator(document, index + 1), ObjectIterator(document, document->matches[index]) };
+}
+
+JSONValue::Field JSONValue::ObjectIterator::operator*() const {
+    Field field;
+    JSONValue(document, index).get_string_view(field.key);
+    field.value = JSONValue(document, index + 2);
+    return field;
+}
+
+// JSONDocument
+
+JSONDocument::JSONDocument() {}
+
+JSONDocument::~JSONDocument() {
+    clear();
+}
+
+void JSONDocument::clear() {
+    data = nullptr;
+    size = 0;
+    count = 0;
+    if (file.is_valid()) {
+        file->close();
+        file.unref();
+    }
+}
+
+Error JSONDocument::_error(size_t p_offset, const char* p_message) {
+    error_offset = p_offset;
+    error_text = p_message;
+    return ERR_PARSE_ERROR;
+}
+
+size_t JSONDocument::_string_end(size_t p_quote) const {
+    size_t i = p_quote + 1;
+    while (i < size) {
+        const char* quote = static_cast<const char*>(memchr(data + i, '"', size - i));
+        if (!quote) {
+            return std::string::npos;
+        }
+        size_t at = size_t(quote - data);
+        // Escaped if preceded by an odd run of backslashes.
+        size_t backslashes = 0;
+        while (at - backslashes > p_quote + 1 && data[at - backslashes - 1] == '\\') {
+            backslashes++;
+        }
+        if ((backslashes & 1) == 0) {
+            return at;
+        }
+        i = at + 1;
+    }
+    return std::string::npos;
+}
+
+size_t JSONDocument::_scalar_end(size_t p_position) const {
+    size_t i = p_position;
+    while (i < size && !_is_delimiter(data[i])) {
+        i++;
+    }
+    return i;
+}
+
+Error JSONDocument::parse(const char* p_data, size_t p_size) {
+    clear();
+    Error err = _index(p_data, p_size, false);
+    if (err != OK) {
+        return err;
+    }
+    if (count == 0) {
+        return _error(0, "Empty document.");
+    }
+    uint32_t next = 0;
+    err = _validate(0, count, next);
+    if (err == ERR_FILE_EOF) {
+        return _error(size, "Unexpected end of document.");
+    }
+    if (err != OK) {
+        return err;
+    }
+    if (next != count) {
+        return _error(structurals[next], "Unexpected content after the root value.");
+    }
+    return OK;
+}
+
+Error JSONDocument::load_file(const std::string& p_path) {
+    clear();
+    Ref<FileAccess> mapped;
+    mapped.instantiate();
+    if (!mapped->open(p_path, FileAccess::READ_MMAP)) {
+        return ERR_FILE_CANT_OPEN;
+    }
+    Span<const uint8_t> bytes = mapped->get_mapped_data();
+    Error err = parse(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    file = mapped; // After parse(), which clears.
+    return err;
+}
+
+Error JSONDocument::_index(const char* p_data, size_t p_size, bool p_partial) {
+    if (p_size >= std::numeric_limits<uint32_t>::max() - 64) {
+        return _error(0, "Document too large; use JSONStreamReader.");
+    }
+    data = p_data;
+    size = p_size;
+    count = 0;
+    partial = p_partial;
+    error_text.clear();
+    error_offset = 0;
+    // At most one structural per byte. Uninitialized, so pages are only
+    // committed as the index grows.
+    if (capacity < p_size + 1) {
+        capacity = p_size + 1;
+        structurals.reset(new uint32_t[capacity]);
+        matches.reset(new uint32_t[capacity]);
+    }
+
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(p_data);
+    const uint64_t ODD_BITS = 0xAAAAAAAAAAAAAAAAull;
+    uint64_t prev_escaped = 0;
+    uint64_t prev_in_string = 0;
+    uint64_t prev_scalar = 0;
+    uint32_t* out = structurals.get();
+    uint8_t tail[64];
+
+    for (size_t offset = 0; offset < p_size; offset += 64) {
+        const uint8_t* block = bytes + offset;
+        if (p_size - offset < 64) {
+            // Pad with spaces, which are never structural.
+            memset(tail, ' ', sizeof(tail));
+            memcpy(tail, block, p_size - offset);
+            block = tail;
+        }
+        BlockMasks masks;
+        _classify(block, masks);
+
+        // Characters escaped by a backslash: in a run of backslashes every
+        // other one escapes the next character.
+        uint64_t escaped;
+        if (masks.backslash == 0) {
+            escaped = prev_escaped;
+            prev_escaped = 0;
+        } else {
+            const uint64_t potential = masks.backslash & ~prev_escaped;
+            const uint64_t codes = (((potential << 1) | ODD_BITS) - potential) ^ ODD_BITS;
+            escaped = codes ^ (masks.backslash | prev_escaped);
+            prev_escaped = (codes & masks.backslash) >> 63;
+        }
+
+        const uint64_t quote = masks.quote & ~escaped;
+        const uint64_t in_string = _prefix_xor(quote) ^ prev_in_string;
+        prev_in_string = uint64_t(int64_t(in_string) >> 63);
+
+        // A value starts at a non-operator, non-space byte that does not
+        // follow another one; opening quotes count, closing ones are
+        // masked out below with the string contents.
+        const uint64_t scalar = ~(masks.op | masks.space);
+        const uint64_t nonquote_scalar = scalar & ~quote;
+        const uint64_t follows_scalar = (nonquote_scalar << 1) | prev_scalar;
+        prev_scalar = nonquote_scalar >> 63;
+        uint64_t starts = (masks.op | (scalar & ~follows_scalar)) & ~(in_string ^ quote);
+
+        while (starts) {
+            *out++ = uint32_t(offset + _count_trailing_zeros(starts));
+            starts &= starts - 1;
+        }
+    }
+    count = uint32_t(out - structurals.get());
+
+    if (prev_in_string && !p_partial) {
+        return _error(p_size, "Unterminated string.");
+    }
+    return OK;
+}
+
+// Stage one only marks where a scalar starts: match the grammar from
+// there, then require a delimiter.
+Error JSONDocument::_validate_scalar(size_t p_position) {
+    const std::string_view rest(data + p_position, size - p_position);
+    const char c = rest[0];
+    size_t length = 0;
+    bool integer;
+    if (c == 't' || c == 'n') {
+        length = rest.compare(0, 4, c == 't' ? "true" : "null") == 0 ? 4 : 0;
+    } else if (c == 'f') {
+        length = rest.compare(0, 5, "false") == 0 ? 5 : 0;
+    } else if (c == '-' || _is_digit(c)) {
+        length = _json_number_length(rest, integer);
+    } else {
+        return _error(p_position, "Expected a value.");
+    }
+    if (length == 0 || (length < rest.size() && !_is_delimiter(rest[length]))) {
+        if (partial && _scalar_end(p_position) == size) {
+            return ERR_FILE_EOF; // May continue in the next window.
+        }
+        return _error(p_position, _is_digit(c) || c == '-' ? "Invalid number." : "Invalid literal.");
+    }
+    return partial && length == rest.size() ? ERR_FILE_EOF : OK;
+}
+
+Error JSONDocument::_validate(uint32_t p_begin, uint32_t p_end, uint32_t& r_next) {
+    enum Expect {
+        EXPECT_VALUE,
+        EXPECT_VALUE_OR_CLOSE,
+        EXPECT_KEY,
+        EXPECT_KEY_OR_CLOSE,
+        EXPECT_COLON,
+        EXPECT_COMMA_OR_CLOSE,
+    };
+
+    open_stack.clear();
+    Expect expect = EXPECT_VALUE;
+    for (uint32_t i = p_begin; i < p_end; i++) {
+        const size_t position = structurals[i];
+        const char c = data[position];
+        bool closed = false;
+        switch (expect) {
+            case EXPECT_VALUE_OR_CLOSE:
+                if (c == ']') {
+                    closed = true;
+                    break;
+                }
+                [[fallthrough]];
+            case EXPECT_VALUE:
+                if (c == '{' || c == '[') {
+                    if (open_stack.size() >= size_t(MAX_DEPTH)) {
+                        return _error(position, "Nesting too deep.");
+                    }
+                    open_stack.push_back(i);
+                    expect = c == '{' ? EXPECT_KEY_OR_CLOSE : EXPECT_VALUE_OR_CLOSE;
+                    continue;
+                }
+                if (c != '"') {
+                    Error err = _validate_scalar(position);
+                    if (err != OK) {
+                        return err;
+                    }
+                }
+                break;
+            case EXPECT_KEY_OR_CLOSE:
+                if (c == '}') {
+                    closed = true;
+                    break;
+                }
+                [[fallthrough]];
+            case EXPECT_KEY:
+                if (c != '"') {
+                    return _error(position, "Expected a string key.");
+                }
+                expect = EXPECT_COLON;
+                continue;
+            case EXPECT_COLON:
+                if (c != ':') {
+                    return _error(position, "Expected ':'.");
+                }
+                expect = EXPECT_VALUE;
+                continue;
+            case EXPECT_COMMA_OR_CLOSE: {
+                const bool in_object = data[structurals[open_stack.back()]] == '{';
+                if (c == ',') {
+                    expect = in_object ? EXPECT_KEY : EXPECT_VALUE;
+                    continue;
+                }
+                if (c != (in_object ? '}' : ']')) {
+                    return _error(position, in_object ? "Expected ',' or '}'." : "Expected ',' or ']'.");
+                }
+                closed = true;
+            } break;
+        }
+        if (closed) {
+            if (c != (data[structurals[open_stack.back()]] == '{' ? '}' : ']')) {
+                return _error(position, "Mismatched bracket.");
+            }
+            matches[open_stack.back()] = i;
+            open_stack.pop_back();
+        }
+        // A value ended here.
+        if (open_stack.empty()) {
+            r_next = i + 1;
+            return OK;
+        }
+        expect = EXPECT_COMMA_OR_CLOSE;
+    }
+    return ERR_FILE_EOF;
+}
+
+// JSONStreamReader
+
+JSONStreamReader::JSONStreamReader() {}
+
+JSONStreamReader::~JSONStreamReader() {
+    close();
+}
+
+void JSONStreamReader::close() {
+    if (file.is_valid()) {
+        file->close();
+        file.unref();
+    }
+    document.clear();
+    window.clear();
+    window.shrink_to_fit();
+    start = end = 0;
+    consumed = 0;
+    cursor = 0;
+    indexed = false;
+    eof = false;
+    state = STATE_DONE;
+}
+
+bool JSONStreamReader::_refill(size_t p_keep_from) {
+    // Keep the unfinished element, drop what was handed out.
+    memmove(window.data(), window.data() + p_keep_from, end - p_keep_from);
+    consumed += p_keep_from;
+    end -= p_keep_from;
+    start = 0;
+    if (end == window.size()) {
+        window.resize(window.size() * 2); // One element is larger than the window.
+    }
+    size_t read = file->get_buffer(reinterpret_cast<uint8_t*>(window.data() + end), window.size() - end);
+    end += read;
+    eof = read == 0 || file->eof_reached();
+    indexed = false;
+    return read > 0;
+}
+
+Error JSONStreamReader::open(const std::string& p_path, size_t p_window_size) {
+    close();
+    file.instantiate();
+    if (!file->open(p_path, FileAccess::READ)) {
+        file.unref();
+        return ERR_FILE_CANT_OPEN;
+    }
+    window.resize(p_window_size < 4096 ? 4096 : p_window_size);
+    _refill(0);
+
+    size_t i = 0;
+    if (end >= 3 && memcmp(window.data(), "\xEF\xBB\xBF", 3) == 0) {
+        i = 3;
+    }
+    while (i < end && (char_classes.table[uint8_t(window[i])] & CLASS_SPACE)) {
+        i++;
+    }
+    if (i >= end || (window[i] != '[' && window[i] != '{')) {
+        document._error(i, "Expected a top-level array or object.");
+        close();
+        return ERR_PARSE_ERROR;
+    }
+    object = window[i] == '{';
+    start = i + 1;
+    state = STATE_FIRST;
+    return OK;
+}
+
+Error JSONStreamReader::next(JSONValue& r_value, std::string_view& r_key) {
+    r_value = JSONValue();
+    r_key = std::string_view();
+    if (state == STATE_DONE) {
+        return ERR_FILE_EOF;
+    }
+    const char closer = object ? '}' : ']';
+
+    while (true) {
+        if (!indexed) {
+            document._index(window.data() + start, end - start, !eof);
+            cursor = 0;
+            indexed = true;
+        }
+        const uint32_t count = document.count;
+        const char* data = document.data;
+        uint32_t i = cursor;
+
+        if (i < count) {
+            if (state == STATE_FIRST && data[document.structurals[i]] == closer) {
+                state = STATE_DONE;
+                return ERR_FILE_EOF;
+            }
+            uint32_t value = i;
+            bool complete = true;
+            if (object) {
+                if (i + 2 >= count) {
+                    complete = false;
+                } else if (data[document.structurals[i]] != '"' || data[document.structurals[i + 1]] != ':') {
+                    document._error(document.structurals[i], "Expected a member name.");
+                    return ERR_PARSE_ERROR;
+                }
+                value = i + 2;
+            }
+            uint32_t next = 0;
+            if (complete) {
+                Error err = document._validate(value, count, next);
+                if (err == ERR_FILE_EOF || (err == OK && next >= count)) {
+                    complete = false; // Needs the ',' or bracket that follows.
+                } else if (err != OK) {
+                    return err;
+                }
+            }
+            if (complete) {
+                if (object && JSONValue(&document, i).get_string_view(r_key) != OK) {
+                    return ERR_PARSE_ERROR;
+                }
+                const char c = data[document.structurals[next]];
+                if (c == ',') {
+                    cursor = next + 1;
+                    state = STATE_ELEMENT;
+                } else if (c == closer) {
+                    state = STATE_DONE;
+                } else {
+                    document._error(document.structurals[next], object ? "Expected ',' or '}'." : "Expected ',' or ']'.");
+                    return ERR_PARSE_ERROR;
+                }
+                r_value = JSONValue(&document, value);
+                return OK;
+            }
+        }
+
+        if (eof) {
+            document._error(end - start, "Unexpected end of file.");
+            return ERR_PARSE_ERROR;
+        }
+        // Restart the window at the unfinished element.
+        _refill(i < count ? start + document.structurals[i] : end);
+    }
+}
+
+// JSONWriter
+
+void JSONWriter::_newline() {
+    if (indent <= 0) {
+        return;
+    }
+    buffer += '\n';
+    buffer.append(stack.size() * size_t(indent), ' ');
+}
+
+void JSONWriter::_before_value() {
+    if (after_key) {
+        after_key = false;
+        return;
+    }
+    if (stack.empty()) {
+        return;
+    }
+    uint8_t& top = stack.back();
+    if (top & 1) {
+        error = ERR_INVALID_DATA; // A value in an object needs a key first.
+    }
+    if (top & 2) {
+        buffer += ',';
+    }
+    top |= 2;
+    _newline();
+}
+
+void JSONWriter::_flush() {
+    if (file && buffer.size() >= FLUSH_SIZE) {
+        if (!file->store_buffer(buffer.data(), buffer.size())) {
+            error = ERR_FILE_CANT_WRITE;
+        }
+        buffer.clear();
+    }
+}
+
+void JSONWriter::begin_object() {
+    _before_value();
+    buffer += '{';
+    stack.push_back(1);
+}
+
+void JSONWriter::begin_array() {
+    _before_value();
+    buffer += '[';
+    stack.push_back(0);
+}
+
+void JSONWriter::end_object() {
+    if (stack.empty() || !(stack.back() & 1) || after_key) {
+        error = ERR_INVALID_DATA;
+        return;
+    }
+    bool had_items = stack.back() & 2;
+    stack.pop_back();
+    if (had_items) {
+        _newline();
+    }
+    buffer += '}';
+    _flush();
+}
+
+void JSONWriter::end_array() {
+    if (stack.empty() || (stack.back() & 1)) {
+        error = ERR_INVALID_DATA;
+        return;
+    }
+    bool had_items = stack.back() & 2;
+    stack.pop_back();
+    if (had_items) {
+        _newline();
+    }
+    buffer += ']';
+    _flush();
+}
+
+void JSONWriter::key(std::string_view p_key) {
+    if (stack.empty() || !(stack.back() & 1) || after_key) {
+        error = ERR_INVALID_DATA;
+        return;
+    }
+    uint8_t& top = stack.back();
+    if (top & 2) {
+        buffer += ',';
+    }
+    top |= 2;
+    _newline();
+    _write_string(p_key);
+    buffer += indent > 0 ? ": " : ":";
+    after_key = true;
+}
+
+void JSONWriter::_write_string(std::string_view p_string) {
+    static const char HEX[] = "0123456789abcdef";
+    buffer += '"';
+    size_t run = 0;
+    for (size_t i = 0; i < p_string.size(); i++) {
+        const uint8_t c = uint8_t(p_string[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        buffer.append(p_string.data() + run, i - run);
+        run = i + 1;
+        switch (c) {
+            case '"':
+                buffer += "\\\"";
+                break;
+            case '\\':
+                buffer += "\\\\";
+                break;
+            case '\n':
+                buffer += "\\n";
+                break;
+            case '\r':
+                buffer += "\\r";
+                break;
+            case '\t':
+                buffer += "\\t";
+                break;
+            case '\b':
+                buffer += "\\b";
+                break;
+            case '\f':
+                buffer += "\\f";
+                break;
+            default: {
+                const char escape[] = { '\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 15] };
+                buffer.append(escape, sizeof(escape));
+            } break;
+        }
+    }
+    buffer.append(p_string.data() + run, p_string.size() - run);
+    buffer += '"';
+}
+
+void JSONWriter::value(std::string_view p_value) {
+    _before_value();
+    _write_string(p_value);
+    _flush();
+}
+
+void JSONWriter::value(bool p_value) {
+    _before_value();
+    buffer += p_value ? "true" : "false";
+    _flush();
+}
+
+void JSONWriter::value(int64_t p_value) {
+    _before_value();
+    char text[24];
+    std::to_chars_result result = std::to_chars(text, text + sizeof(text), p_value);
+    buffer.append(text, result.ptr - text);
+    _flush();
+}
+
+void JSONWriter::value(uint64_t p_value) {
+    _before_value();
+    char text[24];
+    std::to_chars_result result = std::to_chars(text, text + sizeof(text), p_value);
+    buffer.append(text, result.ptr - text);
+    _flush();
+}
+
+void JSONWriter::value(double p_value) {
+    _before_value();
+    if (!std::isfinite(p_value)) {
+        buffer += "null"; // JSON has no NaN or infinity.
+    } else {
+        char text[32];
+        std::to_chars_result result = std::to_chars(text, text + sizeof(text), p_value);
+        buffer.append(text, result.ptr - text);
+    }
+    _flush();
+}
+
+void JSONWriter::value(const Variant& p_value) {
+    switch (p_value.get_type()) {
+        case Variant::BOOL:
+            value(p_value.operator bool());
+            break;
+        case Variant::INT:
+            value(p_value.operator int64_t());
+            break;
+        case Variant::FLOAT:
+            value(p_value.operator double());
+            break;
+        case Variant::STRING:
+            value(std::string_view(*p_value.get_string_ptr()));
+            break;
+        case Variant::VECTOR2:
+        case Variant::VECTOR2I:
+        case Variant::RECT2I:
+        case Variant::COLOR:
+            value(p_value.operator std::string());
+            break;
+        default:
+            null_value();
+            break;
+    }
+}
+
+void JSONWriter::null_value() {
+    _before_value();
+    buffer += "null";
+    _flush();
+}
+
+void JSONWriter::raw_value(std::string_view p_json) {
+    _before_value();
+    buffer.append(p_json.data(), p_json.size());
+    _flush();
+}
+
+Error JSONWriter::finish() {
+    if (!stack.empty() || after_key) {
+        error = ERR_INVALID_DATA;
+    }
+    if (file && !buffer.empty()) {
+        if (!file->store_buffer(buffer.data(), buffer.size())) {
+            error = ERR_FILE_CANT_WRITE;
+        }
+        buffer.clear();
+    }
+    if (file) {
+        file->flush();
+    }
+    return error;
+}
@@ -0,0 +1,386 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef JSON_UTILS_H
+#define JSON_UTILS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/error/error_list.h"
+#include "core/object/ref_counted.h"
+#include "core/variant/variant.h"
+
+class FileAccess;
+class JSONDocument;
+
+/**
+ * @class JSONValue
+ * @brief Handle to one value of a JSONDocument.
+ *
+ * Nothing is decoded until asked for: strings are views into the source
+ * (get_string() unescapes on demand) and numbers are parsed by the getter.
+ * Containers are iterated in place, and skipping a nested value costs one
+ * lookup, so reading one field of a large record never walks the rest.
+ *
+ *     for (JSONValue::Field entry : document.get_root()["strings"].get_object()) {
+ *         table[std::string(entry.key)] = entry.value.as_string();
+ *     }
+ *
+ * A handle is a pointer and an index; copy it freely. It is valid as long
+ * as its document and the source buffer.
+ */
+class JSONValue {
+public:
+    enum Type {
+        TYPE_INVALID, ///< Missing member or out-of-range index.
+        TYPE_NULL,
+        TYPE_BOOL,
+        TYPE_NUMBER,
+        TYPE_STRING,
+        TYPE_ARRAY,
+        TYPE_OBJECT,
+    };
+
+    struct Field;
+
+    class ArrayIterator {
+    public:
+        JSONValue operator*() const { return JSONValue(document, index); }
+        ArrayIterator& operator++();
+        bool operator!=(const ArrayIterator& p_other) const { return index != p_other.index; }
+
+    private:
+        friend class JSONValue;
+        ArrayIterator(const JSONDocument* p_document, uint32_t p_index) : document(p_document), index(p_index) {}
+        const JSONDocument* document;
+        uint32_t index;
+    };
+
+    class ObjectIterator {
+    public:
+        Field operator*() const;
+        ObjectIterator& operator++();
+        bool operator!=(const ObjectIterator& p_other) const { return index != p_other.index; }
+
+    private:
+        friend class JSONValue;
+        ObjectIterator(const JSONDocument* p_document, uint32_t p_index) : document(p_document), index(p_index) {}
+        const JSONDocument* document;
+        uint32_t index;
+    };
+
+    template <typename I>
+    struct Range {
+        I first;
+        I last;
+        I begin() const { return first; }
+        I end() const { return last; }
+    };
+
+    JSONValue() {}
+
+    bool is_valid() const { return document != nullptr; }
+    Type get_type() const;
+    bool is_null() const { return get_type() == TYPE_NULL; }
+
+    /** @return OK, ERR_INVALID_DATA for another type, or ERR_PARSE_ERROR for a malformed token. */
+    Error get_bool(bool& r_value) const;
+    /** @brief Integers only; 1.5 and 1e3 give ERR_INVALID_DATA. */
+    Error get_int(int64_t& r_value) const;
+    Error get_double(double& r_value) const;
+    /** @brief Contents between the quotes, escapes not decoded. No copy. */
+    Error get_string_view(std::string_view& r_value) const;
+    Error get_string(std::string& r_value) const;
+    /** @brief The JSON text of the value, containers included. */
+    std::string_view get_raw() const;
+
+    // Read-a-field helpers: p_default on a missing field or wrong type.
+    bool as_bool(bool p_default = false) const;
+    int64_t as_int(int64_t p_default = 0) const;
+    double as_double(double p_default = 0.0) const;
+    std::string as_string(const std::string& p_default = std::string()) const;
+    /** @brief Scalars as a Variant; containers give NIL. */
+    Variant to_variant() const;
+
+    /** @brief Member p_key, matched against the raw key. O(members). */
+    JSONValue operator[](std::string_view p_key) const;
+    JSONValue operator[](size_t p_index) const;
+    /** @brief Elements or members, 0 for scalars. O(count). */
+    size_t size() const;
+
+    /** @brief Elements of an array; empty for other types. */
+    Range<ArrayIterator> get_array() const;
+    /** @brief Members of an object in source order; empty for other types. */
+    Range<ObjectIterator> get_object() const;
+
+private:
+    friend class JSONDocument;
+    friend class JSONStreamReader;
+
+    JSONValue(const JSONDocument* p_document, uint32_t p_index) : document(p_document), index(p_index) {}
+
+    char _first() const;
+    size_t _position() const;
+
+    const JSONDocument* document = nullptr;
+    uint32_t index = 0; ///< Into the document's structural index.
+};
+
+struct JSONValue::Field {
+    std::string_view key; ///< Raw, escapes left as they are in the source.
+    JSONValue value;
+};
+
+/**
+ * @class JSONDocument
+ * @brief On-demand JSON parser in two stages.
+ *
+ * Stage one classifies the input 64 bytes at a time (SSE2 where
+ * available, a table otherwise) into quote, backslash, operator and
+ * whitespace masks. Escapes and string extents are resolved with bit
+ * arithmetic, with no per-byte branches, and the position of every
+ * operator and value start is written to the structural index. Stage two
+ * walks only that index: it checks the grammar and records, for each '['
+ * and '{', where it closes, which is what lets JSONValue skip values.
+ * Scalars are left for JSONValue to decode when read.
+ *
+ * The source is not copied. parse() borrows a caller-owned buffer and
+ * load_file() maps the file. Documents are limited to 4 GiB; use
+ * JSONStreamReader for larger ones.
+ */
+class JSONDocument {
+public:
+    static const int MAX_DEPTH = 1024;
+
+    JSONDocument();
+    ~JSONDocument();
+
+    JSONDocument(const JSONDocument&) = delete;
+    JSONDocument& operator=(const JSONDocument&) = delete;
+
+    /**
+     * Index p_data, which must outlive the document and its values.
+     * @return OK, or ERR_PARSE_ERROR (see get_error_text() and
+     *         get_error_offset()).
+     */
+    Error parse(const char* p_data, size_t p_size);
+    Error parse(std::string_view p_text) { return parse(p_text.data(), p_text.size()); }
+    /** @brief Map p_path and parse it. */
+    Error load_file(const std::string& p_path);
+    void clear();
+
+    JSONValue get_root() const { return count > 0 ? JSONValue(this, 0) : JSONValue(); }
+
+    const std::string& get_error_text() const { return error_text; }
+    size_t get_error_offset() const { return error_offset; }
+    size_t get_structural_count() const { return count; }
+
+private:
+    friend class JSONValue;
+    friend class JSONStreamReader;
+
+    Error _index(const char* p_data, size_t p_size, bool p_partial);
+    Error _validate(uint32_t p_begin, uint32_t p_end, uint32_t& r_next);
+    Error _validate_scalar(size_t p_position);
+    Error _error(size_t p_offset, const char* p_message);
+
+    /** @brief Index just past the value that starts at p_index. */
+    uint32_t _skip(uint32_t p_index) const {
+        char c = data[structurals[p_index]];
+        return (c == '{' || c == '[') ? matches[p_index] + 1 : p_index + 1;
+    }
+    /** @brief From one element (or member) to the next, stepping over ','. */
+    uint32_t _next(uint32_t p_index) const {
+        uint32_t next = _skip(p_index);
+        return data[structurals[next]] == ',' ? next + 1 : next;
+    }
+    size_t _string_end(size_t p_quote) const;
+    size_t _scalar_end(size_t p_position) const;
+
+    const char* data = nullptr;
+    size_t size = 0;
+    std::unique_ptr<uint32_t[]> structurals; ///< Byte offsets of operators and value starts.
+    std::unique_ptr<uint32_t[]> matches; ///< For '[' and '{': index of the closing bracket.
+    size_t capacity = 0;
+    uint32_t count = 0;
+    bool partial = false; ///< A stream window: the data may stop mid-value.
+    std::vector<uint32_t> open_stack;
+    Ref<FileAccess> file;
+
+    std::string error_text;
+    size_t error_offset = 0;
+};
+
+inline JSONValue::ArrayIterator& JSONValue::ArrayIterator::operator++() {
+    index = document->_next(index);
+    return *this;
+}
+
+inline JSONValue::ObjectIterator& JSONValue::ObjectIterator::operator++() {
+    index = document->_next(index + 2);
+    return *this;
+}
+
+/**
+ * @class JSONStreamReader
+ * @brief Reads the elements of a top-level array (or the members of a
+ * top-level object) one at a time, through a fixed window.
+ *
+ * The file is read window by window; each window is indexed as in
+ * JSONDocument and handed out element by element. An element cut by the
+ * end of the window is moved to the front and the window refilled, so
+ * memory stays at the window size (grown only if one element is larger)
+ * whatever the size of the file.
+ *
+ *     JSONStreamReader reader;
+ *     reader.open("levels.json");
+ *     JSONValue level;
+ *     std::string_view key;
+ *     while (reader.next(level, key) == OK) {
+ *         load_level(level["name"].as_string(), level["tiles"]);
+ *     }
+ */
+class JSONStreamReader {
+public:
+    static const size_t DEFAULT_WINDOW_SIZE = 16 * 1024 * 1024;
+
+    JSONStreamReader();
+    ~JSONStreamReader();
+
+    /** @return OK, ERR_FILE_CANT_OPEN, or ERR_PARSE_ERROR if the file is not an array or object. */
+    Error open(const std::string& p_path, size_t p_window_size = DEFAULT_WINDOW_SIZE);
+    void close();
+
+    /**
+     * Read the next element. r_key is the member name for an object and
+     * empty for an array. Both stay valid until the next call.
+     * @return OK, ERR_FILE_EOF after the last element, or ERR_PARSE_ERROR.
+     */
+    Error next(JSONValue& r_value, std::string_view& r_key);
+
+    bool is_object() const { return object; }
+    /** @brief Bytes of the file consumed so far. */
+    uint64_t get_position() const { return consumed + start; }
+    const std::string& get_error_text() const { return document.get_error_text(); }
+
+private:
+    enum State {
+        STATE_FIRST, ///< Right after the opening bracket.
+        STATE_ELEMENT, ///< After a ','.
+        STATE_DONE,
+    };
+
+    bool _refill(size_t p_keep_from);
+
+    Ref<FileAccess> file;
+    JSONDocument document;
+    std::vector<char> window;
+    size_t start = 0; ///< Window offset the index starts at.
+    size_t end = 0;
+    uint64_t consumed = 0;
+    uint32_t cursor = 0;
+    bool indexed = false;
+    bool eof = false;
+    bool object = false;
+    State state = STATE_DONE;
+};
+
+/**
+ * @class JSONWriter
+ * @brief Streaming JSON writer into a string or a FileAccess.
+ *
+ * Commas, quoting and escaping are handled by the writer, so output is
+ * always well-formed as long as begin/end calls pair up. With a file, the
+ * text is flushed every FLUSH_SIZE bytes, so memory does not grow with the
+ * output.
+ *
+ *     JSONWriter writer(&file);
+ *     writer.begin_object();
+ *     writer.key("name");
+ *     writer.value("Player");
+ *     writer.end_object();
+ *     writer.finish();
+ */
+class JSONWriter {
+public:
+    static const size_t FLUSH_SIZE = 64 * 1024;
+
+    JSONWriter() {}
+    /** @brief Write to p_file, which must stay open until finish(). */
+    explicit JSONWriter(FileAccess* p_file) : file(p_file) {}
+
+    /** @brief Pretty-print with p_spaces per level; 0 (default) is compact. */
+    void set_indent(int p_spaces) { indent = p_spaces; }
+
+    void begin_object();
+    void end_object();
+    void begin_array();
+    void end_array();
+    void key(std::string_view p_key);
+
+    void value(std::string_view p_value);
+    void value(const char* p_value) { value(std::string_view(p_value)); }
+    void value(const std::string& p_value) { value(std::string_view(p_value)); }
+    void value(bool p_value);
+    void value(int32_t p_value) { value(int64_t(p_value)); }
+    void value(uint32_t p_value) { value(int64_t(p_value)); }
+    void value(int64_t p_value);
+    void value(uint64_t p_value);
+    /** @brief Shortest text that reads back exactly; NaN and infinities become null. */
+    void value(double p_value);
+    /** @brief Scalars and strings; objects become null. */
+    void value(const Variant& p_value);
+    void null_value();
+    /** @brief Insert p_json as a value, unchecked. */
+    void raw_value(std::string_view p_json);
+
+    /**
+     * Flush to the file, if any.
+     * @return OK, ERR_INVALID_DATA for unbalanced or misplaced calls, or
+     *         ERR_FILE_CANT_WRITE.
+     */
+    Error finish();
+    /** @brief The text written so far, when not writing to a file. */
+    const std::string& get_string() const { return buffer; }
+    Error get_error() const { return error; }
+
+private:
+    void _before_value();
+    void _newline();
+    void _write_string(std::string_view p_string);
+    void _flush();
+
+    FileAccess* file = nullptr;
+    std::string buffer;
+    std::vector<uint8_t> stack; ///< Per open container: is_object | has_items << 1.
+    bool after_key = false;
+    int indent = 0;
+    Error error = OK;
+};
+
+#endif // JSON_UTILS_H
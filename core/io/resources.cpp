@@ -0,0 +1,532 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "core/io/resources.h"
+
+#include <algorithm>
+#include <cctype>
+
+#include "core/io/file_access.h"
+#include "core/io/file_system_memory.h"
+
+ResourceCache* ResourceCache::singleton = nullptr;
+
+namespace {
+
+inline uint64_t _mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+std::string _get_extension(const std::string& p_path) {
+    size_t dot = p_path.find_last_of('.');
+    size_t slash = p_path.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return std::string();
+    }
+    std::string ext = p_path.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext;
+}
+
+} // namespace
+
+uint64_t ResourceCache::hash_path(std::string_view p_path) {
+    // FNV-1a, finalized so short paths with a common prefix spread well.
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (char c : p_path) {
+        h = (h ^ static_cast<uint8_t>(c)) * 0x100000001B3ull;
+    }
+    return _mix(h ^ p_path.size());
+}
+
+ResourceCache::ResourceCache() {
+    if (!singleton) {
+        singleton = this;
+    }
+}
+
+ResourceCache::~ResourceCache() {
+    std::vector<Ref<RefCounted>> released;
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        for (auto& it : entries) {
+            released.push_back(std::move(it.second.strong));
+        }
+        entries.clear();
+        lru.clear();
+    }
+    if (singleton == this) {
+        singleton = nullptr;
+    }
+}
+
+void ResourceCache::register_loader(const std::string& p_type, const std::vector<std::string>& p_extensions, Loader p_loader) {
+    std::lock_guard<std::mutex> guard(mutex);
+    LoaderEntry entry;
+    entry.type = _get_type(p_type);
+    entry.loader = p_loader;
+    for (const std::string& extension : p_extensions) {
+        loaders[_get_extension("." + extension)] = entry;
+    }
+}
+
+void ResourceCache::unregister_loader(const std::string& p_extension) {
+    std::lock_guard<std::mutex> guard(mutex);
+    loaders.erase(_get_extension("." + p_extension));
+}
+
+void ResourceCache::set_budget(uint64_t p_bytes) {
+    std::vector<Ref<RefCounted>> released;
+    std::lock_guard<std::mutex> guard(mutex);
+    budget = p_bytes;
+    if (budget) {
+        _enforce_budget(budget, released);
+    }
+}
+
+uint64_t ResourceCache::get_budget() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    return budget;
+}
+
+uint32_t ResourceCache::_get_type(const std::string& p_type) {
+    auto it = type_index.find(p_type);
+    if (it != type_index.end()) {
+        return it->second;
+    }
+    uint32_t index = static_cast<uint32_t>(types.size());
+    TypeStats stats;
+    stats.type = p_type;
+    types.push_back(stats);
+    type_index.emplace(p_type, index);
+    return index;
+}
+
+ResourceCache::Entry* ResourceCache::_find(const std::string& p_path, uint64_t& r_hash) {
+    r_hash = hash_path(p_path);
+    auto it = entries.find(r_hash);
+    if (it == entries.end() || it->second.pending || it->second.path != p_path) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+const ResourceCache::Entry* ResourceCache::_find(const std::string& p_path) const {
+    auto it = entries.find(hash_path(p_path));
+    if (it == entries.end() || it->second.pending || it->second.path != p_path) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+Ref<RefCounted> ResourceCache::_acquire(Entry& p_entry, CacheMode p_mode) {
+    if (p_entry.strong.is_valid()) {
+        return p_entry.strong;
+    }
+    Ref<RefCounted> resource = p_entry.weak.lock();
+    if (resource.is_valid() && p_mode == CACHE_STRONG) {
+        p_entry.strong = resource;
+    }
+    return resource;
+}
+
+void ResourceCache::_touch(uint64_t p_hash, Entry& p_entry) {
+    if (p_entry.strong.is_null() || p_entry.pins) {
+        return;
+    }
+    if (p_entry.in_lru) {
+        lru.splice(lru.begin(), lru, p_entry.lru);
+    } else {
+        p_entry.lru = lru.insert(lru.begin(), p_hash);
+        p_entry.in_lru = true;
+    }
+}
+
+void ResourceCache::_unlink(Entry& p_entry) {
+    if (p_entry.in_lru) {
+        lru.erase(p_entry.lru);
+        p_entry.in_lru = false;
+    }
+}
+
+void ResourceCache::_account(Entry& p_entry, uint64_t p_bytes) {
+    TypeStats& stats = types[p_entry.type];
+    stats.bytes = stats.bytes - p_entry.bytes + p_bytes;
+    bytes_resident = bytes_resident - p_entry.bytes + p_bytes;
+    p_entry.bytes = p_bytes;
+}
+
+void ResourceCache::_erase(uint64_t p_hash, std::vector<Ref<RefCounted>>& r_released) {
+    auto it = entries.find(p_hash);
+    Entry& entry = it->second;
+    _unlink(entry);
+    _account(entry, 0);
+    types[entry.type].count--;
+    // Destroyed after the lock is dropped, a destructor may call back in.
+    if (entry.strong.is_valid()) {
+        r_released.push_back(std::move(entry.strong));
+    }
+    entries.erase(it);
+}
+
+void ResourceCache::_purge_dead(std::vector<Ref<RefCounted>>& r_released) {
+    for (auto it = entries.begin(); it != entries.end();) {
+        const Entry& entry = it->second;
+        uint64_t hash = it->first;
+        ++it;
+        if (!entry.pending && entry.strong.is_null() && !entry.weak.is_valid()) {
+            _erase(hash, r_released);
+        }
+    }
+}
+
+void ResourceCache::_enforce_budget(uint64_t p_target, std::vector<Ref<RefCounted>>& r_released) {
+    if (bytes_resident <= p_target) {
+        return;
+    }
+    _purge_dead(r_released);
+    // Walk from the least recently used end. Both outcomes unlink the
+    // entry, so `it` stays valid and keeps pointing past the unvisited part.
+    auto it = lru.end();
+    while (bytes_resident > p_target && it != lru.begin()) {
+        uint64_t hash = *std::prev(it);
+        Entry& entry = entries.find(hash)->second;
+        if (entry.strong->get_reference_count() == 1) {
+            // Only the cache holds it; dropping frees the memory.
+            _erase(hash, r_released);
+            evictions++;
+        } else {
+            // Still in use: freeing is up to the users. Demote, so the last
+            // of them frees it, and keep deduplicating until then.
+            _unlink(entry);
+            r_released.push_back(std::move(entry.strong));
+            demotions++;
+        }
+    }
+}
+
+Error ResourceCache::_load_file(const std::string& p_path, const LoaderEntry& p_loader, Ref<RefCounted>& r_resource, uint64_t& r_bytes) const {
+    r_bytes = 0;
+    if (FileSystemMemory* filesystem = FileSystemMemory::get_singleton()) {
+        Ref<MemoryBuffer> buffer;
+        Error err = filesystem->read_file(p_path, buffer);
+        if (err == OK) {
+            return p_loader.loader(p_path, buffer->get_data(), r_resource, r_bytes);
+        }
+        // Plain disk paths outside every mount still load from disk.
+        if (err != ERR_FILE_NOT_FOUND || p_path.find("://") != std::string::npos) {
+            return err;
+        }
+    }
+    Ref<FileAccess> file;
+    file.instantiate();
+    if (!file->open(p_path, FileAccess::READ_MMAP)) {
+        return ERR_FILE_CANT_OPEN;
+    }
+    return p_loader.loader(p_path, file->get_mapped_data(), r_resource, r_bytes);
+}
+
+Error ResourceCache::load(const std::string& p_path, Ref<RefCounted>& r_resource, CacheMode p_mode) {
+    const std::string path = FileSystemMemory::normalize_path(p_path);
+    const uint64_t hash = hash_path(path);
+    std::vector<Ref<RefCounted>> released;
+    Ref<RefCounted> shared; // Keeps a waited-for result alive across the retry.
+    bool waited = false;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = entries.find(hash);
+    while (it != entries.end()) {
+        Entry& entry = it->second;
+        if (entry.path != path) {
+            break; // 64-bit collision, loaded below without caching.
+        }
+        if (entry.pending) {
+            std::shared_ptr<PendingLoad> pending = entry.pending;
+            if (!waited) {
+                shared_loads++;
+                waited = true;
+            }
+            load_done.wait(lock, [&pending] { return pending->done; });
+            if (pending->error != OK) {
+                r_resource.unref();
+                return pending->error;
+            }
+            shared = pending->resource;
+            it = entries.find(hash);
+            continue;
+        }
+        Ref<RefCounted> resource = _acquire(entry, p_mode);
+        if (resource.is_null()) {
+            _erase(hash, released); // Weak entry outlived its resource.
+            break;
+        }
+        if (!waited) {
+            hits++;
+        }
+        _touch(hash, entry);
+        if (budget) {
+            _enforce_budget(budget, released);
+        }
+        r_resource = resource;
+        return OK;
+    }
+
+    misses++;
+    auto loader_it = loaders.find(_get_extension(path));
+    if (loader_it == loaders.end()) {
+        failed_loads++;
+        r_resource.unref();
+        return ERR_FILE_UNRECOGNIZED;
+    }
+    const LoaderEntry loader = loader_it->second; // Copied, may be unregistered while loading.
+
+    std::shared_ptr<PendingLoad> pending;
+    if (entries.find(hash) == entries.end()) {
+        Entry& entry = entries[hash];
+        entry.path = path;
+        entry.type = loader.type;
+        entry.pending = std::make_shared<PendingLoad>();
+        pending = entry.pending;
+    }
+    lock.unlock();
+
+    Ref<RefCounted> resource;
+    uint64_t bytes = 0;
+    Error err = _load_file(path, loader, resource, bytes);
+    if (err == OK && resource.is_null()) {
+        err = ERR_CANT_CREATE;
+    }
+
+    lock.lock();
+    if (err != OK) {
+        failed_loads++;
+    }
+    if (pending) {
+        // Pending entries are never erased by anyone but their loader.
+        it = entries.find(hash);
+        Entry& entry = it->second;
+        entry.pending.reset();
+        if (err != OK) {
+            entries.erase(it);
+        } else {
+            entry.weak = resource;
+            if (p_mode == CACHE_STRONG) {
+                entry.strong = resource;
+            }
+            types[entry.type].count++;
+            _account(entry, bytes);
+            _touch(hash, entry);
+            if (budget) {
+                _enforce_budget(budget, released);
+            }
+        }
+        pending->error = err;
+        pending->resource = resource;
+        pending->done = true;
+    }
+    lock.unlock();
+    if (pending) {
+        load_done.notify_all();
+    }
+    r_resource = resource;
+    return err;
+}
+
+void ResourceCache::add(const std::string& p_path, const std::string& p_type, const Ref<RefCounted>& p_resource, uint64_t p_bytes, CacheMode p_mode) {
+    if (p_resource.is_null()) {
+        return;
+    }
+    const std::string path = FileSystemMemory::normalize_path(p_path);
+    const uint64_t hash = hash_path(path);
+    std::vector<Ref<RefCounted>> released;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = entries.find(hash);
+    while (it != entries.end() && it->second.pending) {
+        std::shared_ptr<PendingLoad> pending = it->second.pending;
+        load_done.wait(lock, [&pending] { return pending->done; });
+        it = entries.find(hash);
+    }
+    if (it != entries.end()) {
+        if (it->second.path != path) {
+            return; // Collision, leave the existing entry alone.
+        }
+        _erase(hash, released);
+    }
+
+    Entry& entry = entries[hash];
+    entry.path = path;
+    entry.type = _get_type(p_type);
+    entry.weak = p_resource;
+    if (p_mode == CACHE_STRONG) {
+        entry.strong = p_resource;
+    }
+    types[entry.type].count++;
+    _account(entry, p_bytes);
+    _touch(hash, entry);
+    if (budget) {
+        _enforce_budget(budget, released);
+    }
+}
+
+Ref<RefCounted> ResourceCache::get(const std::string& p_path) {
+    const std::string path = FileSystemMemory::normalize_path(p_path);
+    std::lock_guard<std::mutex> guard(mutex);
+    uint64_t hash;
+    Entry* entry = _find(path, hash);
+    if (!entry) {
+        return Ref<RefCounted>();
+    }
+    _touch(hash, *entry);
+    return _acquire(*entry, CACHE_WEAK);
+}
+
+bool ResourceCache::has(const std::string& p_path) const {
+    const std::string path = FileSystemMemory::normalize_path(p_path);
+    std::lock_guard<std::mutex> guard(mutex);
+    const Entry* entry = _find(path);
+    return entry && (entry->strong.is_valid() || entry->weak.is_valid());
+}
+
+bool ResourceCache::set_resource_size(const std::string& p_path, uint64_t p_bytes) {
+    const std::string path = FileSystemMemory::normalize_path(p_path);
+    std::vector<Ref<RefCounted>> released;
+    std::lock_guard<std::mutex> guard(mutex);
+    uint64_t hash;
+    Entry* entry = _find(path, hash);
+    if (!entry) {
+        return false;
+    }
+    _account(*entry, p_bytes);
+    if (budget) {
+        _enforce_budget(budget, released);
+    }
+    return true;
+}
+
+bool ResourceCache::pin(const std::string& p_path) {
+    const std::string path = FileSystemMemory::normalize_path(p_path);
+    std::lock_guard<std::mutex> guard(mutex);
+    uint64_t hash;
+    Entry* entry = _find(path, hash);
+    if (!entry || _acquire(*entry, CACHE_STRONG).is_null()) {
+        return false;
+    }
+    entry->pins++;
+    _unlink(*entry);
+    return true;
+}
+
+bool ResourceCache::unpin(const std::string& p_path) {
+    const std::string path = FileSystemMemory::normalize_path(p_path);
+    std::vector<Ref<RefCounted>> released;
+    std::lock_guard<std::mutex> guard(mutex);
+    uint64_t hash;
+    Entry* entry = _find(path, hash);
+    if (!entry || entry->pins == 0) {
+        return false;
+    }
+    if (--entry->pins == 0) {
+        _touch(hash, *entry);
+        if (budget) {
+            _enforce_budget(budget, released);
+        }
+    }
+    return true;
+}
+
+bool ResourceCache::is_pinned(const std::string& p_path) const {
+    const std::string path = FileSystemMemory::normalize_path(p_path);
+    std::lock_guard<std::mutex> guard(mutex);
+    const Entry* entry = _find(path);
+    return entry && entry->pins;
+}
+
+bool ResourceCache::invalidate(const std::string& p_path) {
+    const std::string path = FileSystemMemory::normalize_path(p_path);
+    std::vector<Ref<RefCounted>> released;
+    std::lock_guard<std::mutex> guard(mutex);
+    uint64_t hash;
+    if (!_find(path, hash)) {
+        return false;
+    }
+    _erase(hash, released);
+    return true;
+}
+
+void ResourceCache::trim(uint64_t p_bytes) {
+    std::vector<Ref<RefCounted>> released;
+    std::lock_guard<std::mutex> guard(mutex);
+    _enforce_budget(p_bytes, released);
+}
+
+void ResourceCache::clear() {
+    std::vector<Ref<RefCounted>> released;
+    std::lock_guard<std::mutex> guard(mutex);
+    for (auto it = entries.begin(); it != entries.end();) {
+        uint64_t hash = it->first;
+        bool pending = it->second.pending != nullptr;
+        ++it;
+        if (!pending) {
+            _erase(hash, released);
+        }
+    }
+}
+
+ResourceCache::Stats ResourceCache::get_stats() {
+    std::vector<Ref<RefCounted>> released;
+    std::lock_guard<std::mutex> guard(mutex);
+    _purge_dead(released);
+    Stats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.shared_loads = shared_loads;
+    stats.failed_loads = failed_loads;
+    stats.evictions = evictions;
+    stats.demotions = demotions;
+    stats.bytes_resident = bytes_resident;
+    stats.budget = budget;
+    for (const auto& it : entries) {
+        if (!it.second.pending) {
+            stats.entries++;
+            stats.pinned += it.second.pins ? 1 : 0;
+        }
+    }
+    stats.types = types;
+    return stats;
+}
+
+void ResourceCache::reset_stats() {
+    std::lock_guard<std::mutex> guard(mutex);
+    hits = 0;
+    misses = 0;
+    shared_loads = 0;
+    failed_loads = 0;
+    evictions = 0;
+    demotions = 0;
+}
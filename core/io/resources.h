@@ -0,0 +1,223 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef RESOURCES_H
+#define RESOURCES_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "core/error/error_list.h"
+#include "core/object/ref_counted.h"
+#include "core/templates/delegate.h"
+#include "core/templates/span.h"
+
+/**
+ * @class ResourceCache
+ * @brief Central cache for loaded resources, keyed by the hash of their path.
+ *
+ * Loading the same path twice returns the same object. Loaders are
+ * registered per file extension together with a type name, which is what
+ * memory is accounted against. The cache reads the file (through
+ * FileSystemMemory when one exists, so overlays and packs apply) and the
+ * loader turns the bytes into a resource and reports its size.
+ *
+ * Entries are strong or weak:
+ *   - strong: the cache holds a reference, the resource stays resident
+ *     after every user dropped it, until the budget evicts it,
+ *   - weak: the cache only deduplicates; the resource dies with its last
+ *     user and the entry is purged lazily.
+ * When resident bytes exceed the budget, strong entries are evicted in
+ * least recently used order. An entry nobody else references is dropped;
+ * one that is still in use is demoted to weak, so its memory goes away with
+ * the last user. Pinned entries are never evicted or demoted.
+ *
+ * Threads asking for a path that is being loaded wait for that load instead
+ * of starting their own. Loaders run without the cache lock held.
+ */
+class ResourceCache {
+public:
+    /**
+     * @brief Builds a resource from file contents.
+     * @param p_path Normalized path.
+     * @param p_data File contents, only valid during the call.
+     * @param r_resource The resource.
+     * @param r_bytes Memory the resource keeps alive, for the budget.
+     */
+    typedef Delegate<Error(const std::string& p_path, Span<const uint8_t> p_data, Ref<RefCounted>& r_resource, uint64_t& r_bytes)> Loader;
+
+    enum CacheMode {
+        CACHE_STRONG,
+        CACHE_WEAK,
+    };
+
+    struct TypeStats {
+        std::string type;
+        uint32_t count = 0;
+        uint64_t bytes = 0;
+    };
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t shared_loads = 0; ///< Requests that waited on another thread's load.
+        uint64_t failed_loads = 0;
+        uint64_t evictions = 0;
+        uint64_t demotions = 0;
+        uint64_t bytes_resident = 0;
+        uint64_t budget = 0;
+        uint32_t entries = 0;
+        uint32_t pinned = 0;
+        std::vector<TypeStats> types;
+
+        double get_hit_rate() const { return hits + misses ? double(hits) / double(hits + misses) : 0.0; }
+    };
+
+private:
+    /** One load in flight; waiters block until done. */
+    struct PendingLoad {
+        bool done = false;
+        Error error = OK;
+        Ref<RefCounted> resource;
+    };
+
+    struct Entry {
+        std::string path;
+        uint32_t type = 0;
+        Ref<RefCounted> strong;
+        WeakRef<RefCounted> weak;
+        uint64_t bytes = 0;
+        uint32_t pins = 0;
+        bool in_lru = false;
+        std::list<uint64_t>::iterator lru; ///< Valid while in_lru.
+        std::shared_ptr<PendingLoad> pending;
+    };
+
+    struct LoaderEntry {
+        uint32_t type = 0;
+        Loader loader;
+    };
+
+    static ResourceCache* singleton;
+
+    mutable std::mutex mutex;
+    std::condition_variable load_done;
+
+    std::unordered_map<uint64_t, Entry> entries;
+    std::list<uint64_t> lru; ///< Strong, unpinned entries; most recently used first.
+    std::unordered_map<std::string, LoaderEntry> loaders; ///< By lowercase extension.
+    std::vector<TypeStats> types;
+    std::unordered_map<std::string, uint32_t> type_index;
+
+    uint64_t budget = 0;
+    uint64_t bytes_resident = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t shared_loads = 0;
+    uint64_t failed_loads = 0;
+    uint64_t evictions = 0;
+    uint64_t demotions = 0;
+
+    uint32_t _get_type(const std::string& p_type);
+    Entry* _find(const std::string& p_path, uint64_t& r_hash);
+    const Entry* _find(const std::string& p_path) const;
+    Ref<RefCounted> _acquire(Entry& p_entry, CacheMode p_mode);
+    void _touch(uint64_t p_hash, Entry& p_entry);
+    void _unlink(Entry& p_entry);
+    void _account(Entry& p_entry, uint64_t p_bytes);
+    void _erase(uint64_t p_hash, std::vector<Ref<RefCounted>>& r_released);
+    void _enforce_budget(uint64_t p_target, std::vector<Ref<RefCounted>>& r_released);
+    void _purge_dead(std::vector<Ref<RefCounted>>& r_released);
+    Error _load_file(const std::string& p_path, const LoaderEntry& p_loader, Ref<RefCounted>& r_resource, uint64_t& r_bytes) const;
+
+public:
+    static ResourceCache* get_singleton() { return singleton; }
+
+    /** @brief 64-bit hash of a normalized path, the cache key. */
+    static uint64_t hash_path(std::string_view p_path);
+
+    ResourceCache();
+    ~ResourceCache();
+
+    /** @brief Loader for files ending in any of p_extensions ("png", "wav"), accounted as p_type. */
+    void register_loader(const std::string& p_type, const std::vector<std::string>& p_extensions, Loader p_loader);
+    void unregister_loader(const std::string& p_extension);
+
+    /** @brief Resident bytes above which strong entries are evicted. 0 means unlimited. */
+    void set_budget(uint64_t p_bytes);
+    uint64_t get_budget() const;
+
+    /**
+     * @brief Returns the cached resource, or loads it.
+     * A weak entry asked for with CACHE_STRONG is promoted.
+     * @return ERR_FILE_UNRECOGNIZED without a loader for the extension,
+     * the read error, or the loader's error.
+     */
+    Error load(const std::string& p_path, Ref<RefCounted>& r_resource, CacheMode p_mode = CACHE_STRONG);
+    /** @brief load(), then a checked cast. Null on failure or type mismatch. */
+    template <class T>
+    Ref<T> load_as(const std::string& p_path, CacheMode p_mode = CACHE_STRONG);
+
+    /** @brief Caches a resource built elsewhere (procedural, downloaded), replacing any entry. */
+    void add(const std::string& p_path, const std::string& p_type, const Ref<RefCounted>& p_resource, uint64_t p_bytes, CacheMode p_mode = CACHE_STRONG);
+    /** @brief Cached resource without loading, null if absent. */
+    Ref<RefCounted> get(const std::string& p_path);
+    bool has(const std::string& p_path) const;
+    /** @brief Updates the accounted size, e.g. after mipmaps were generated. */
+    bool set_resource_size(const std::string& p_path, uint64_t p_bytes);
+
+    /** @brief Keeps the entry strong and out of eviction. Counted; pins nest. */
+    bool pin(const std::string& p_path);
+    bool unpin(const std::string& p_path);
+    bool is_pinned(const std::string& p_path) const;
+
+    /** @brief Forgets the entry; users keep their references, the next load reloads. */
+    bool invalidate(const std::string& p_path);
+    /** @brief Evicts in LRU order until at most p_bytes are resident, ignoring the budget. */
+    void trim(uint64_t p_bytes);
+    /** @brief Forgets every entry except loads in flight. */
+    void clear();
+
+    /** @brief Purges entries whose weak resource died, then snapshots the counters. */
+    Stats get_stats();
+    void reset_stats();
+};
+
+template <class T>
+Ref<T> ResourceCache::load_as(const std::string& p_path, CacheMode p_mode) {
+    Ref<RefCounted> resource;
+    Ref<T> result;
+    if (load(p_path, resource, p_mode) == OK) {
+        result.ref_pointer(dynamic_cast<T*>(resource.get_ptr()));
+    }
+    return result;
+}
+
+#endif // RESOURCES_H
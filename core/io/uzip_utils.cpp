@@ -0,0 +1,201 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "core/io/uzip_utils.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+
+static const size_t ZIP_END_SIZE = 22;
+static const size_t ZIP_END64_SIZE = 56;
+static const size_t ZIP_END64_LOCATOR_SIZE = 20;
+static const size_t ZIP_CENTRAL_HEADER_SIZE = 46;
+static const size_t ZIP_LOCAL_HEADER_SIZE = 30;
+static const uint16_t ZIP_EXTRA_ZIP64 = 0x0001;
+
+// The end record sits after the central directory, followed only by the
+// archive comment (at most 64 KiB), so it is searched for backwards.
+static bool _find_end(Span<const uint8_t> p_archive, size_t& r_offset) {
+    if (p_archive.size() < ZIP_END_SIZE) {
+        return false;
+    }
+    size_t last = p_archive.size() - ZIP_END_SIZE;
+    size_t first = last > 0xFFFF ? last - 0xFFFF : 0;
+    for (size_t i = last + 1; i-- > first;) {
+        const uint8_t* p = p_archive.data() + i;
+        if (ZipUtils::read_32(p) == ZipUtils::SIGNATURE_END && i + ZIP_END_SIZE + ZipUtils::read_16(p + 20) <= p_archive.size()) {
+            r_offset = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Sizes and offsets saturated to 0xFFFFFFFF in the record are stored in
+// the ZIP64 extra field, in this order, and only those.
+static bool _read_zip64_extra(const uint8_t* p_extra, size_t p_size, ZipEntry& r_entry, bool p_usize, bool p_csize, bool p_offset) {
+    size_t pos = 0;
+    while (pos + 4 <= p_size) {
+        uint16_t id = ZipUtils::read_16(p_extra + pos);
+        uint16_t length = ZipUtils::read_16(p_extra + pos + 2);
+        pos += 4;
+        if (pos + length > p_size) {
+            return false;
+        }
+        if (id == ZIP_EXTRA_ZIP64) {
+            const uint8_t* field = p_extra + pos;
+            size_t needed = (p_usize + p_csize + p_offset) * 8;
+            if (length < needed) {
+                return false;
+            }
+            if (p_usize) {
+                r_entry.uncompressed_size = ZipUtils::read_64(field);
+                field += 8;
+            }
+            if (p_csize) {
+                r_entry.compressed_size = ZipUtils::read_64(field);
+                field += 8;
+            }
+            if (p_offset) {
+                r_entry.local_header_offset = ZipUtils::read_64(field);
+            }
+            return true;
+        }
+        pos += length;
+    }
+    return !(p_usize || p_csize || p_offset);
+}
+
+Error ZipUtils::parse_central_directory(Span<const uint8_t> p_archive, std::vector<ZipEntry>& r_entries) {
+    r_entries.clear();
+    size_t end_offset;
+    if (!_find_end(p_archive, end_offset)) {
+        return ERR_FILE_UNRECOGNIZED;
+    }
+
+    const uint8_t* end = p_archive.data() + end_offset;
+    uint64_t count = read_16(end + 10);
+    uint64_t cd_size = read_32(end + 12);
+    uint64_t cd_offset = read_32(end + 16);
+    if (read_16(end + 4) != 0 || read_16(end + 6) != 0) {
+        return ERR_UNAVAILABLE; // Spanned archive.
+    }
+
+    if (count == 0xFFFF || cd_size == 0xFFFFFFFF || cd_offset == 0xFFFFFFFF) {
+        if (end_offset < ZIP_END64_LOCATOR_SIZE) {
+            return ERR_FILE_CORRUPT;
+        }
+        const uint8_t* locator = end - ZIP_END64_LOCATOR_SIZE;
+        if (read_32(locator) != SIGNATURE_END64_LOCATOR) {
+            return ERR_FILE_CORRUPT;
+        }
+        uint64_t end64_offset = read_64(locator + 8);
+        if (end64_offset > p_archive.size() || p_archive.size() - end64_offset < ZIP_END64_SIZE) {
+            return ERR_FILE_CORRUPT;
+        }
+        const uint8_t* end64 = p_archive.data() + end64_offset;
+        if (read_32(end64) != SIGNATURE_END64) {
+            return ERR_FILE_CORRUPT;
+        }
+        count = read_64(end64 + 32);
+        cd_size = read_64(end64 + 40);
+        cd_offset = read_64(end64 + 48);
+    }
+
+    if (cd_offset > p_archive.size() || cd_size > p_archive.size() - cd_offset || count > cd_size / ZIP_CENTRAL_HEADER_SIZE) {
+        return ERR_FILE_CORRUPT;
+    }
+
+    r_entries.reserve(static_cast<size_t>(count));
+    const uint8_t* p = p_archive.data() + cd_offset;
+    const uint8_t* cd_end = p + cd_size;
+    for (uint64_t i = 0; i < count; i++) {
+        if (size_t(cd_end - p) < ZIP_CENTRAL_HEADER_SIZE || read_32(p) != SIGNATURE_CENTRAL_HEADER) {
+            return ERR_FILE_CORRUPT;
+        }
+        size_t name_length = read_16(p + 28);
+        size_t extra_length = read_16(p + 30);
+        size_t comment_length = read_16(p + 32);
+        size_t record_size = ZIP_CENTRAL_HEADER_SIZE + name_length + extra_length + comment_length;
+        if (size_t(cd_end - p) < record_size) {
+            return ERR_FILE_CORRUPT;
+        }
+
+        ZipEntry entry;
+        entry.flags = read_16(p + 8);
+        entry.method = read_16(p + 10);
+        entry.crc32 = read_32(p + 16);
+        entry.compressed_size = read_32(p + 20);
+        entry.uncompressed_size = read_32(p + 24);
+        entry.local_header_offset = read_32(p + 42);
+        entry.name = std::string_view(reinterpret_cast<const char*>(p + ZIP_CENTRAL_HEADER_SIZE), name_length);
+
+        bool usize64 = entry.uncompressed_size == 0xFFFFFFFF;
+        bool csize64 = entry.compressed_size == 0xFFFFFFFF;
+        bool offset64 = entry.local_header_offset == 0xFFFFFFFF;
+        if (!_read_zip64_extra(p + ZIP_CENTRAL_HEADER_SIZE + name_length, extra_length, entry, usize64, csize64, offset64)) {
+            return ERR_FILE_CORRUPT;
+        }
+        if (entry.local_header_offset > p_archive.size() || entry.compressed_size > p_archive.size()) {
+            return ERR_FILE_CORRUPT;
+        }
+
+        r_entries.push_back(entry);
+        p += record_size;
+    }
+    return OK;
+}
+
+Error ZipUtils::get_entry_data(Span<const uint8_t> p_archive, const ZipEntry& p_entry, Span<const uint8_t>& r_data) {
+    uint64_t offset = p_entry.local_header_offset;
+    if (offset > p_archive.size() || p_archive.size() - offset < ZIP_LOCAL_HEADER_SIZE) {
+        return ERR_FILE_CORRUPT;
+    }
+    const uint8_t* header = p_archive.data() + offset;
+    if (read_32(header) != SIGNATURE_LOCAL_HEADER) {
+        return ERR_FILE_CORRUPT;
+    }
+    // The local name and extra field may differ from the central ones, only
+    // their lengths matter here.
+    uint64_t data_offset = offset + ZIP_LOCAL_HEADER_SIZE + read_16(header + 26) + read_16(header + 28);
+    if (data_offset > p_archive.size() || p_entry.compressed_size > p_archive.size() - data_offset) {
+        return ERR_FILE_CORRUPT;
+    }
+    if (p_entry.method == ZipEntry::METHOD_STORED && p_entry.compressed_size != p_entry.uncompressed_size) {
+        return ERR_FILE_CORRUPT;
+    }
+    r_data = Span<const uint8_t>(p_archive.data() + data_offset, static_cast<size_t>(p_entry.compressed_size));
+    return OK;
+}
+
+uint32_t ZipUtils::crc32(uint32_t p_crc, const uint8_t* p_data, size_t p_size) {
+    // zlib takes a uInt length.
+    while (p_size > 0) {
+        uInt chunk = static_cast<uInt>(std::min<size_t>(p_size, 1u << 30));
+        p_crc = static_cast<uint32_t>(::crc32(p_crc, p_data, chunk));
+        p_data += chunk;
+        p_size -= chunk;
+    }
+    return p_crc;
+}
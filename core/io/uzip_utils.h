@@ -0,0 +1,93 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef UZIP_UTILS_H
+#define UZIP_UTILS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "core/error/error_list.h"
+#include "core/templates/span.h"
+
+/**
+ * @brief One file of a ZIP archive, as described by its central directory
+ * record. The name points into the archive, it is not a copy.
+ */
+struct ZipEntry {
+    enum Method {
+        METHOD_STORED = 0,
+        METHOD_DEFLATED = 8,
+    };
+
+    std::string_view name;
+    uint16_t method = METHOD_STORED;
+    uint16_t flags = 0;
+    uint32_t crc32 = 0;
+    uint64_t compressed_size = 0;
+    uint64_t uncompressed_size = 0;
+    uint64_t local_header_offset = 0;
+
+    bool is_encrypted() const { return flags & 1; }
+    bool is_directory() const { return !name.empty() && name.back() == '/'; }
+    bool is_supported() const { return !is_encrypted() && (method == METHOD_STORED || method == METHOD_DEFLATED); }
+};
+
+/**
+ * @class ZipUtils
+ * @brief ZIP container parsing, without decompression.
+ *
+ * Works on the whole archive in memory (normally a READ_MMAP FileAccess)
+ * and checks every offset against it, so a truncated or hostile archive
+ * yields ERR_FILE_CORRUPT rather than a bad read. ZIP64 is supported;
+ * multi-disk archives are not.
+ */
+class ZipUtils {
+public:
+    static const uint32_t SIGNATURE_LOCAL_HEADER = 0x04034b50;
+    static const uint32_t SIGNATURE_CENTRAL_HEADER = 0x02014b50;
+    static const uint32_t SIGNATURE_END = 0x06054b50;
+    static const uint32_t SIGNATURE_END64 = 0x06064b50;
+    static const uint32_t SIGNATURE_END64_LOCATOR = 0x07064b50;
+
+    static uint16_t read_16(const uint8_t* p_data) { return uint16_t(p_data[0] | (p_data[1] << 8)); }
+    static uint32_t read_32(const uint8_t* p_data) { return uint32_t(read_16(p_data)) | (uint32_t(read_16(p_data + 2)) << 16); }
+    static uint64_t read_64(const uint8_t* p_data) { return uint64_t(read_32(p_data)) | (uint64_t(read_32(p_data + 4)) << 32); }
+
+    /**
+     * @brief Reads the central directory.
+     * @return ERR_FILE_UNRECOGNIZED if there is no end record,
+     * ERR_FILE_CORRUPT if a record points outside the archive.
+     */
+    static Error parse_central_directory(Span<const uint8_t> p_archive, std::vector<ZipEntry>& r_entries);
+
+    /** @brief Compressed bytes of an entry, located through its local header. */
+    static Error get_entry_data(Span<const uint8_t> p_archive, const ZipEntry& p_entry, Span<const uint8_t>& r_data);
+
+    /** @brief CRC-32 as used by ZIP, continuing from p_crc. */
+    static uint32_t crc32(uint32_t p_crc, const uint8_t* p_data, size_t p_size);
+};
+
+#endif // UZIP_UTILS_H
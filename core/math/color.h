@@ -0,0 +1,62 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef COLOR_H
+#define COLOR_H
+
+#include <cstdint>
+
+// Color is raylib's 8-bit RGBA (thirdparty/libgl/raylib.h), so values from
+// Variant go straight to the draw calls. Text formats spell it with 0..1
+// components, see color_from_normalized().
+#include <raylib.h>
+
+inline bool operator==(const Color& p_a, const Color& p_b) { return p_a.r == p_b.r && p_a.g == p_b.g && p_a.b == p_b.b && p_a.a == p_b.a; }
+inline bool operator!=(const Color& p_a, const Color& p_b) { return !(p_a == p_b); }
+
+// 0xRRGGBBAA
+inline Color color_from_rgba32(uint32_t p_rgba) {
+    return Color{ static_cast<unsigned char>(p_rgba >> 24), static_cast<unsigned char>(p_rgba >> 16),
+        static_cast<unsigned char>(p_rgba >> 8), static_cast<unsigned char>(p_rgba) };
+}
+
+inline uint32_t color_to_rgba32(const Color& p_color) {
+    return (uint32_t(p_color.r) << 24) | (uint32_t(p_color.g) << 16) | (uint32_t(p_color.b) << 8) | uint32_t(p_color.a);
+}
+
+/** @brief Component in 0..1 to its byte, clamped and rounded. */
+inline unsigned char color_component_to_byte(float p_value) {
+    float v = p_value < 0.0f ? 0.0f : (p_value > 1.0f ? 1.0f : p_value);
+    return static_cast<unsigned char>(v * 255.0f + 0.5f);
+}
+
+/** @brief Byte back to 0..1; color_component_to_byte() returns the same byte. */
+inline float color_component_to_float(unsigned char p_value) {
+    return p_value / 255.0f;
+}
+
+inline Color color_from_normalized(float p_r, float p_g, float p_b, float p_a = 1.0f) {
+    return Color{ color_component_to_byte(p_r), color_component_to_byte(p_g), color_component_to_byte(p_b), color_component_to_byte(p_a) };
+}
+
+#endif // COLOR_H
@@ -13,6 +13,7 @@ struct Rect2i {
     // Constructors
     Rect2i() : x(0), y(0), width(0), height(0) {}
     Rect2i(int x, int y, int width, int height) : x(x), y(y), width(width), height(height) {}
+    Rect2i(const Rect2i& other) = default;
 
     // Functions to convert between polar and rectangular coordinates
     static Rect2i fromPolar(int r, double theta) {
@@ -0,0 +1,36 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef VECTOR2_H
+#define VECTOR2_H
+
+// Vector2 is raylib's (thirdparty/libgl/raylib.h), the same type every
+// scene and drawing API takes. Arithmetic comes from raymath.h
+// (Vector2Add(), Vector2Length(), ...); only exact comparison, which
+// Variant and packed arrays need, is added here.
+#include <raylib.h>
+
+inline bool operator==(const Vector2& p_a, const Vector2& p_b) { return p_a.x == p_b.x && p_a.y == p_b.y; }
+inline bool operator!=(const Vector2& p_a, const Vector2& p_b) { return !(p_a == p_b); }
+
+#endif // VECTOR2_H
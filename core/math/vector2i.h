@@ -0,0 +1,45 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef VECTOR2I_H
+#define VECTOR2I_H
+
+#include <cstdint>
+
+struct Vector2i {
+    int32_t x = 0;
+    int32_t y = 0;
+
+    Vector2i() {}
+    Vector2i(int32_t p_x, int32_t p_y) : x(p_x), y(p_y) {}
+
+    Vector2i operator+(const Vector2i& p_other) const { return Vector2i(x + p_other.x, y + p_other.y); }
+    Vector2i operator-(const Vector2i& p_other) const { return Vector2i(x - p_other.x, y - p_other.y); }
+    Vector2i operator*(int32_t p_scalar) const { return Vector2i(x * p_scalar, y * p_scalar); }
+    Vector2i operator-() const { return Vector2i(-x, -y); }
+
+    bool operator==(const Vector2i& p_other) const { return x == p_other.x && y == p_other.y; }
+    bool operator!=(const Vector2i& p_other) const { return !(*this == p_other); }
+};
+
+#endif // VECTOR2I_H
@@ -21,6 +21,20 @@ void CallbackFunc<T>::emit(DataBack data) {
     executeCallback(data);
 }
 
+template <typename T>
+Error CallbackFunc<T>::call_deferred(DataBack data) {
+    if (!(initialized && callbackEnabled && callbackFunction && object)) {
+        return ERR_UNCONFIGURED;
+    }
+    // Stored inline in the queue record; the flush resolves the ID first.
+    return MessageQueue::get_singleton()->push_call<&CallbackFunc<T>::_call_deferred>(object->get_instance_id(), callbackFunction, data);
+}
+
+template <typename T>
+void CallbackFunc<T>::_call_deferred(T* p_object, const std::function<void(T*, DataBack)>& p_function, const DataBack& p_data) {
+    p_function(p_object, p_data);
+}
+
 template <typename T>
 void CallbackFunc<T>::init() {
     callbackFunction = nullptr;
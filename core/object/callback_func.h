@@ -6,6 +6,8 @@
 #include <utility>
 
 #include "core/object/m_class.h"
+#include "core/object/message_queue.h"
+#include "core/error/error_list.h"
 #include "core/templates/vector.h"
 
 
@@ -31,6 +33,12 @@ public:
     void executeCallback(DataBack data);
     void emit(DataBack data);
 
+    // Queue the callback on the MessageQueue instead of running it now, so
+    // it cannot mutate the tree mid-iteration. Runs at the next flush, keyed
+    // on the object's instance ID: dropped if the object is freed first.
+    // ERR_UNCONFIGURED without a callback or an object.
+    Error call_deferred(DataBack data);
+
     // Overloaded init functions
     void init();
     void init(std::function<void(T*, DataBack)> callback, T* obj);
@@ -58,6 +66,8 @@ public:
     static CallbackFunc<T> create();
 
 private:
+    static void _call_deferred(T* p_object, const std::function<void(T*, DataBack)>& p_function, const DataBack& p_data);
+
     std::function<void(T*, DataBack)> callbackFunction;
     T* object;
     bool initialized;
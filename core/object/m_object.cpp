@@ -1,17 +1,19 @@
 #include "m_object.h"
+#include "core/variant/variant.h"
 #include <cstdlib>
 
 // Static pointer initialization
 MObject* MObject::staticPointer = nullptr;
 
 // Constructor
-MObject::MObject() {
+Object::Object() {
     // Initialization if needed
 }
 
 // Destructor
-MObject::~MObject() {
-    // Cleanup if needed
+Object::~Object() {
+    // Pending deferred calls and stale IDs resolve to nothing from now on.
+    ObjectDB::remove_instance(_instance_id.id);
 }
 
 // Const version: Get the value for a given key
@@ -180,3 +182,14 @@ bool MObject::is_null() const {
 bool MObject::is_valid() const {
     // Example implementation, you might need to customize based on your requirements
     return !is_null();
+}
+
+// Variant's Object conversions live here so variant.cpp does not need the
+// object headers.
+Variant::Variant(const Object* p_object) : type(OBJECT) {
+    _put(uint64_t(p_object ? p_object->get_instance_id() : ObjectID()));
+}
+
+std::string _object_get_class_name(const Object* p_object) {
+    return p_object->get_class_name();
+}
@@ -33,6 +33,11 @@ class Callable;
 #include "core/templates/vector.h"
 #include "core/templates/hash_map.h"
 #include "core/variant/signals.h"
+#include "core/object/property_table.h"
+#include "core/object/object_db.h"
+#include "core/object/message_queue.h"
+#include "core/object/object_pool.h"
+#include "core/error/error_list.h"
 
 
 
@@ -43,73 +48,6 @@ class Callable;
 #include <algorithm> // for std::max_element and std::min_element
 
 
-struct PropertyInfo {
-    std::map<std::string, std::string> attributes;
-    std::vector<std::string> amenities;
-    double price;
-    
-    PropertyInfo();
-    ~PropertyInfo();
-
-    PropertyInfo(const std::map<std::string, std::string>& attributes,
-                 const std::vector<std::string>& amenities,
-                 double price);
-
-    // Getter for attributes
-    std::string get(const std::string& key) const;
-
-    // Setter for attributes
-    void set(const std::string& key, const std::string& value);
-
-    // Find function for amenities
-    bool find(const std::string& amenity) const;
-
-    // End function for amenities (returns an iterator to the end)
-    std::vector<std::string>::const_iterator end() const;
-    
-    std::vector<PropertyInfo> get_property_list();
-   
-    void insert(const std::string& amenity);
-
-    // Function to erase an amenity
-    void erase(const std::string& amenity);
-
-
-    PropertyInfo::PropertyInfo(const std::map<std::string, std::string>& attributes,
-                           const std::vector<std::string>& amenities,
-                           double price)
-    : attributes(attributes), amenities(amenities), price(price) {}
-
-std::string PropertyInfo::get(const std::string& key) const {
-    auto it = attributes.find(key);
-    return (it != attributes.end()) ? it->second : "";
-}
-
-void PropertyInfo::set(const std::string& key, const std::string& value) {
-    attributes[key] = value;
-}
-
-bool PropertyInfo::find(const std::string& amenity) const {
-    return std::find(amenities.begin(), amenities.end(), amenity) != amenities.end();
-}
-
-std::vector<std::string>::const_iterator PropertyInfo::end() const {
-    return amenities.end();
-}
-
-void PropertyInfo::insert(const std::string& amenity) {
-    amenities.push_back(amenity);
-}
-
-void PropertyInfo::erase(const std::string& amenity) {
-    auto it = std::find(amenities.begin(), amenities.end(), amenity);
-    if (it != amenities.end()) {
-        amenities.erase(it);
-    }
-}
-
-
-};
 
 
 
@@ -169,6 +107,16 @@ public:
         return _instance->_get_method_bind_impl();                                 \
     }                                                                               \
                                                                                    \
+    static PropertyTable& get_property_table_static() {                           \
+        static PropertyTable table(&base_class_name::get_property_table_static(), #class_name); \
+        static bool bound = _init_property_table<class_name, base_class_name>(table); \
+        (void)bound;                                                               \
+        return table;                                                              \
+    }                                                                               \
+    virtual const PropertyTable& _get_property_table() const override {          \
+        return get_property_table_static();                                        \
+    }                                                                               \
+                                                                                   \
     static Object* _create() { return new class_name; }                           \
                                                                                    \
     static void _bind_methods();                                                   \
@@ -178,7 +126,48 @@ public:
 class Object {
 public:
     Object();  // Constructor
-    ~Object(); // Destructor
+    virtual ~Object(); // Destructor
+
+    // Class-level property table. Properties are registered once per class
+    // from a static _bind_properties(PropertyTable&) and live in the real
+    // member fields of each instance.
+    static PropertyTable& get_property_table_static() {
+        static PropertyTable table(nullptr, "Object");
+        return table;
+    }
+    virtual const PropertyTable& _get_property_table() const { return get_property_table_static(); }
+    static void _bind_properties(PropertyTable& p_table) {}
+
+    // Resolve a property name once, then use the index on the hot path.
+    int get_property_index(const std::string& p_name) const { return _get_property_table().find(p_name); }
+
+    template <typename T>
+    T get_property_value(int p_index) const {
+        T value{};
+        const PropertyTable& table = _get_property_table();
+        if (table.is_type<T>(p_index)) {
+            table.get(this, p_index, &value);
+        }
+        return value;
+    }
+
+    template <typename T>
+    void set_property_value(int p_index, const T& p_value) {
+        const PropertyTable& table = _get_property_table();
+        if (table.is_type<T>(p_index)) {
+            table.set(this, p_index, &p_value);
+        }
+    }
+
+    // Batch access for serializers and animation tracks: no strings, no
+    // per-call lookups. Indices come from get_property_index(); invalid ones
+    // are skipped and make the call return false.
+    bool get_properties(const int* p_indices, size_t p_count, void* const* r_values) const {
+        return _get_property_table().get_batch(this, p_indices, p_count, r_values);
+    }
+    bool set_properties(const int* p_indices, size_t p_count, const void* const* p_values) {
+        return _get_property_table().set_batch(this, p_indices, p_count, p_values);
+    }
 
     // Const versions of get and set functions
     int get(const std::string& key) const;
@@ -216,8 +205,8 @@ public:
 
    // New function for connecting signals
     template <typename... Args>
-    void connect(const std::string& key, Signal<Args...>& signal, const typename Signal<Args...>::Slot& slot) {
-        signal.connect(key, this, slot);
+    void connect(const std::string& key, Signal<Args...>& signal, const typename Signal<Args...>::Slot& slot, uint32_t flags = CONNECT_DEFAULT) {
+        signal.connect(key, this, slot, flags);
     }
 
     // New function for disconnecting signals
@@ -226,7 +215,25 @@ public:
         signal.disconnect(key, this);
     }
 
-    // New function for instantiating objects dynamically
+    // Handle for deferred calls and other references that may outlive the
+    // object. Registered in ObjectDB on first use.
+    ObjectID get_instance_id() const {
+        if (_instance_id.id.is_null()) {
+            _instance_id.id = ObjectDB::add_instance(const_cast<Object*>(this));
+        }
+        return _instance_id.id;
+    }
+
+    // Queue a call of Method with copies of the arguments. It runs at the
+    // next MessageQueue flush, and is dropped if this object is freed first.
+    template <auto Method, typename... Args>
+    Error call_deferred(Args&&... p_args) {
+        return MessageQueue::get_singleton()->push_call<Method>(get_instance_id(), std::forward<Args>(p_args)...);
+    }
+
+    // New function for instantiating objects dynamically. Classes declared
+    // with MCLASS_POOLED are allocated from ObjectPool, and delete returns
+    // them there.
     template <typename T, typename... Args>
     static T* instantiate(Args&&... args) {
         return new T(std::forward<Args>(args)...);
@@ -311,7 +318,26 @@ private:
 
     // New static pointer
     static Object* staticPointer;
+
+    // Not copied with the object: a copy is a different instance.
+    struct InstanceID {
+        ObjectID id;
+        InstanceID() {}
+        InstanceID(const InstanceID&) {}
+        InstanceID& operator=(const InstanceID&) { return *this; }
+    };
+    mutable InstanceID _instance_id;
 };
+// Runs a class' own _bind_properties() once, when its table is created.
+// Classes that do not declare one inherit the parent's table untouched.
+template <class T, class B>
+bool _init_property_table(PropertyTable& p_table) {
+    if (&T::_bind_properties != &B::_bind_properties) {
+        T::_bind_properties(p_table);
+    }
+    return true;
+}
+
 // Template implementation for get_method, bind_method, and emit_signal
 template <typename ReturnType, typename... Args>
 decltype(auto) Object::get_method(const std::string& method_name) const {
@@ -0,0 +1,304 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "message_queue.h"
+
+#include "core/error/error_macros.h"
+
+#include <utility>
+
+
+// Releases the calling thread's buffer when the thread exits, so the next
+// thread can reuse it instead of growing the buffer list.
+struct MessageQueueThreadSlot {
+    MessageQueue* owner = nullptr;
+    MessageQueue::ThreadQueue* queue = nullptr;
+
+    ~MessageQueueThreadSlot() {
+        if (queue) {
+            queue->owned.store(false, std::memory_order_release);
+        }
+    }
+};
+
+static thread_local MessageQueueThreadSlot thread_slot;
+
+MessageQueue::MethodThunk MessageQueue::methods[MessageQueue::MAX_METHODS];
+std::atomic<uint32_t> MessageQueue::method_count{ 1 }; // 0 is CALLABLE_METHOD.
+
+static void _call_callable(Object*, void* p_args) {
+    (*static_cast<MessageQueue::Message*>(p_args))();
+}
+
+static void _destroy_callable(void* p_args) {
+    typedef MessageQueue::Message Message;
+    static_cast<Message*>(p_args)->~Message();
+}
+
+static inline uint32_t _align_record(size_t p_size) {
+    return static_cast<uint32_t>((p_size + 15) & ~size_t(15));
+}
+
+
+MessageQueue* MessageQueue::get_singleton() {
+    static MessageQueue singleton;
+    return &singleton;
+}
+
+MessageQueue::MessageQueue() {
+    methods[CALLABLE_METHOD] = { &_call_callable, &_destroy_callable };
+}
+
+MessageQueue::~MessageQueue() {
+    ThreadQueue* q = queues.load(std::memory_order_acquire);
+    while (q) {
+        ThreadQueue* next = q->next_queue;
+        // Destroy the arguments of calls that never ran.
+        while (Record* r = _peek(q)) {
+            methods[r->method].destroy(r + 1);
+            q->head->read += r->size;
+        }
+        Chunk* c = q->head;
+        while (c) {
+            Chunk* n = c->next.load(std::memory_order_relaxed);
+            delete[] c->data;
+            delete c;
+            c = n;
+        }
+        delete q;
+        q = next;
+    }
+    // Another queue allocated at this address must not pick up the buffer.
+    if (thread_slot.owner == this) {
+        thread_slot.owner = nullptr;
+        thread_slot.queue = nullptr;
+    }
+}
+
+MessageQueue::MethodID MessageQueue::_register_method(const MethodThunk& p_thunk) {
+    uint32_t id = method_count.fetch_add(1, std::memory_order_relaxed);
+    if (id >= MAX_METHODS) {
+        ERR_PRINT("Too many deferred method bindings, increase MessageQueue::MAX_METHODS.");
+        abort();
+    }
+    methods[id] = p_thunk;
+    return id;
+}
+
+MessageQueue::ThreadQueue* MessageQueue::_get_thread_queue() {
+    if (thread_slot.owner == this && thread_slot.queue) {
+        return thread_slot.queue;
+    }
+
+    // Try to take over a buffer released by an exited thread.
+    ThreadQueue* q = queues.load(std::memory_order_acquire);
+    for (; q; q = q->next_queue) {
+        bool expected = false;
+        if (q->owned.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+            break;
+        }
+    }
+
+    if (!q) {
+        q = new ThreadQueue;
+        q->owned.store(true, std::memory_order_relaxed);
+        Chunk* c = new Chunk;
+        c->data = new uint8_t[CHUNK_SIZE];
+        c->capacity = CHUNK_SIZE;
+        q->head = q->tail = c;
+        q->chunks_allocated.store(1, std::memory_order_relaxed);
+        q->bytes.store(CHUNK_SIZE, std::memory_order_relaxed);
+        q->peak_bytes.store(CHUNK_SIZE, std::memory_order_relaxed);
+        ThreadQueue* first = queues.load(std::memory_order_relaxed);
+        do {
+            q->next_queue = first;
+        } while (!queues.compare_exchange_weak(first, q, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    thread_slot.owner = this;
+    thread_slot.queue = q;
+    return q;
+}
+
+void* MessageQueue::_begin_record(ObjectID p_object, MethodID p_method, size_t p_args_size, Chunk** r_chunk, uint32_t* r_end) {
+    ThreadQueue* q = _get_thread_queue();
+    uint32_t size = _align_record(sizeof(Record) + p_args_size);
+    Chunk* c = q->tail;
+    uint32_t w = c->written.load(std::memory_order_relaxed);
+
+    if (w + size > c->capacity) {
+        uint32_t capacity = size > CHUNK_SIZE ? size : CHUNK_SIZE;
+        size_t limit = max_thread_bytes.load(std::memory_order_relaxed);
+        size_t bytes = q->bytes.load(std::memory_order_relaxed);
+        if (limit && bytes + capacity > limit) {
+            if (q->overflowed.fetch_add(1, std::memory_order_relaxed) == 0) {
+                ERR_PRINT("MessageQueue thread buffer full, deferred calls are being dropped. Increase max_thread_bytes or flush more often.");
+            }
+            return nullptr;
+        }
+        Chunk* n = new Chunk;
+        n->data = new uint8_t[capacity];
+        n->capacity = capacity;
+        q->chunks_allocated.fetch_add(1, std::memory_order_relaxed);
+        bytes = q->bytes.fetch_add(capacity, std::memory_order_relaxed) + capacity;
+        if (bytes > q->peak_bytes.load(std::memory_order_relaxed)) {
+            q->peak_bytes.store(bytes, std::memory_order_relaxed);
+        }
+        c->next.store(n, std::memory_order_release);
+        q->tail = n;
+        c = n;
+        w = 0;
+    }
+
+    Record* r = reinterpret_cast<Record*>(c->data + w);
+    r->sequence = sequence.fetch_add(1, std::memory_order_relaxed);
+    r->object = p_object;
+    r->method = p_method;
+    r->size = size;
+    q->pushed.fetch_add(1, std::memory_order_relaxed);
+
+    *r_chunk = c;
+    *r_end = w + size;
+    return r + 1;
+}
+
+Error MessageQueue::push_callable(Message&& p_message) {
+    Chunk* chunk;
+    uint32_t end;
+    void* mem = _begin_record(ObjectID(), CALLABLE_METHOD, sizeof(Message), &chunk, &end);
+    if (!mem) {
+        return ERR_OUT_OF_MEMORY;
+    }
+    new (mem) Message(std::move(p_message));
+    chunk->written.store(end, std::memory_order_release);
+    return OK;
+}
+
+MessageQueue::Record* MessageQueue::_peek(ThreadQueue* p_queue) {
+    Chunk* c = p_queue->head;
+    while (true) {
+        if (c->read < c->written.load(std::memory_order_acquire)) {
+            return reinterpret_cast<Record*>(c->data + c->read);
+        }
+        Chunk* n = c->next.load(std::memory_order_acquire);
+        if (!n) {
+            return nullptr;
+        }
+        // The producer publishes the last record before linking the next
+        // chunk, so check once more before retiring this one.
+        if (c->read < c->written.load(std::memory_order_acquire)) {
+            continue;
+        }
+        p_queue->head = n;
+        p_queue->bytes.fetch_sub(c->capacity, std::memory_order_relaxed);
+        delete[] c->data;
+        delete c;
+        c = n;
+    }
+}
+
+uint32_t MessageQueue::flush(FlushPhase p_phase) {
+    if (flushing) {
+        return 0;
+    }
+    flushing = true;
+
+    const uint32_t budget = flush_budget ? flush_budget : UINT32_MAX;
+    // Calls pushed from here on, by a running call or another thread, wait
+    // for the next flush; a call that requeues itself cannot spin forever.
+    const uint64_t end = sequence.load(std::memory_order_acquire);
+    uint32_t count = 0;
+    while (true) {
+        // Pick the oldest call across thread buffers, keeping global
+        // submission order. There are only a handful of pushing threads.
+        ThreadQueue* oldest_queue = nullptr;
+        Record* oldest = nullptr;
+        for (ThreadQueue* q = queues.load(std::memory_order_acquire); q; q = q->next_queue) {
+            Record* r = _peek(q);
+            if (r && (!oldest || r->sequence < oldest->sequence)) {
+                oldest = r;
+                oldest_queue = q;
+            }
+        }
+        if (!oldest || oldest->sequence >= end) {
+            break;
+        }
+        if (count == budget) {
+            budget_exhausted++;
+            break;
+        }
+
+        const MethodThunk& thunk = methods[oldest->method];
+        void* args = oldest + 1;
+        if (oldest->method == CALLABLE_METHOD) {
+            thunk.call(nullptr, args);
+        } else if (Object* object = ObjectDB::get_instance(oldest->object)) {
+            thunk.call(object, args);
+        } else {
+            dropped_freed++;
+        }
+        thunk.destroy(args);
+        // The record stays valid while it runs: its chunk is only retired by
+        // _peek() once read has moved past it.
+        oldest_queue->head->read += oldest->size;
+        count++;
+    }
+
+    flushed += count;
+    flushed_per_phase[p_phase] += count;
+    flushing = false;
+    return count;
+}
+
+MessageQueue::Stats MessageQueue::get_stats() const {
+    Stats stats;
+    for (ThreadQueue* q = queues.load(std::memory_order_acquire); q; q = q->next_queue) {
+        stats.pushed += q->pushed.load(std::memory_order_relaxed);
+        stats.overflowed += q->overflowed.load(std::memory_order_relaxed);
+        stats.chunks_allocated += q->chunks_allocated.load(std::memory_order_relaxed);
+        stats.bytes_in_use += q->bytes.load(std::memory_order_relaxed);
+        stats.peak_bytes += q->peak_bytes.load(std::memory_order_relaxed);
+    }
+    stats.flushed = flushed;
+    stats.dropped_freed = dropped_freed;
+    stats.budget_exhausted = budget_exhausted;
+    for (int i = 0; i < PHASE_MAX; i++) {
+        stats.flushed_per_phase[i] = flushed_per_phase[i];
+    }
+    return stats;
+}
+
+void MessageQueue::reset_stats() {
+    for (ThreadQueue* q = queues.load(std::memory_order_acquire); q; q = q->next_queue) {
+        q->pushed.store(0, std::memory_order_relaxed);
+        q->overflowed.store(0, std::memory_order_relaxed);
+        q->chunks_allocated.store(0, std::memory_order_relaxed);
+        q->peak_bytes.store(q->bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    flushed = 0;
+    dropped_freed = 0;
+    budget_exhausted = 0;
+    for (int i = 0; i < PHASE_MAX; i++) {
+        flushed_per_phase[i] = 0;
+    }
+}
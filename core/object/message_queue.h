@@ -0,0 +1,248 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef MESSAGE_QUEUE_H
+#define MESSAGE_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "core/error/error_list.h"
+#include "core/object/object_db.h"
+#include "core/templates/delegate.h"
+
+class Object;
+
+/**
+ * @class MessageQueue
+ * @brief Deferred call queue, drained by the scene thread at frame phases.
+ *
+ * Every thread that pushes gets its own single-producer buffer made of
+ * chunks, so pushing is lock-free and never contends with other producers.
+ * A queued call is stored inline as a record: target ObjectID, MethodID and
+ * the packed arguments. No std::function and no per-call allocation.
+ *
+ * The scene thread is the only consumer. It calls flush() at phase
+ * boundaries (after physics, before render). Calls run in submission order
+ * across all threads, and calls whose target was freed are dropped.
+ */
+class MessageQueue {
+public:
+    typedef Delegate<void()> Message;
+    typedef uint32_t MethodID;
+
+    enum FlushPhase {
+        PHASE_IDLE, ///< End of the main loop iteration.
+        PHASE_AFTER_PHYSICS,
+        PHASE_BEFORE_RENDER,
+        PHASE_MAX
+    };
+
+    struct Stats {
+        uint64_t pushed = 0; ///< Calls accepted.
+        uint64_t flushed = 0; ///< Calls taken off the queue, including dropped ones.
+        uint64_t dropped_freed = 0; ///< Target object freed before the flush.
+        uint64_t overflowed = 0; ///< Calls rejected because a thread buffer was full.
+        uint64_t budget_exhausted = 0; ///< Flushes that stopped on the budget with calls left.
+        uint64_t chunks_allocated = 0;
+        size_t bytes_in_use = 0;
+        size_t peak_bytes = 0;
+        uint64_t flushed_per_phase[PHASE_MAX] = {};
+    };
+
+    static MessageQueue* get_singleton();
+
+    /**
+     * Queue a bound call of @p Method on the object @p p_id, with copies of
+     * @p p_args. @p Method is a member function of the object's class, or a
+     * function taking a pointer to the object first. Safe from any thread.
+     * @return OK, or ERR_OUT_OF_MEMORY when the thread buffer is full.
+     */
+    template <auto Method, typename... Args>
+    Error push_call(ObjectID p_id, Args&&... p_args);
+
+    /**
+     * Queue an arbitrary closure. Prefer push_call() when the target is an
+     * Object, it is dropped safely if the object is freed first.
+     */
+    Error push_callable(Message&& p_message);
+
+    /**
+     * Run queued calls, oldest first, until the queue is empty or the flush
+     * budget is reached. Only calls queued before the flush started run;
+     * calls pushed while flushing wait for the next one. Scene thread only.
+     * @return Number of calls taken off the queue.
+     */
+    uint32_t flush(FlushPhase p_phase = PHASE_IDLE);
+
+    /** @brief Max calls per flush(), 0 for no limit. Leftovers wait for the next flush. */
+    void set_flush_budget(uint32_t p_max_calls) { flush_budget = p_max_calls; }
+    uint32_t get_flush_budget() const { return flush_budget; }
+
+    /** @brief Max bytes buffered per thread, 0 for no limit. */
+    void set_max_thread_bytes(size_t p_bytes) { max_thread_bytes.store(p_bytes, std::memory_order_relaxed); }
+    size_t get_max_thread_bytes() const { return max_thread_bytes.load(std::memory_order_relaxed); }
+
+    Stats get_stats() const;
+    void reset_stats();
+
+    bool is_flushing() const { return flushing; }
+
+    /**
+     * @brief ID of a (method, argument types) pair, allocated on first use.
+     */
+    template <auto Method, typename... Args>
+    static MethodID get_method_id();
+
+    MessageQueue();
+    ~MessageQueue();
+
+private:
+    static const uint32_t CHUNK_SIZE = 64 * 1024;
+    static const uint32_t MAX_METHODS = 16384;
+    static const MethodID CALLABLE_METHOD = 0;
+
+    // Header of a queued call. Packed arguments follow, 16-byte aligned.
+    struct alignas(16) Record {
+        uint64_t sequence;
+        ObjectID object;
+        MethodID method;
+        uint32_t size; ///< Header plus arguments, rounded up to 16.
+    };
+
+    struct MethodThunk {
+        void (*call)(Object* p_object, void* p_args);
+        void (*destroy)(void* p_args);
+    };
+
+    struct Chunk {
+        uint8_t* data = nullptr;
+        uint32_t capacity = 0;
+        std::atomic<uint32_t> written{ 0 }; ///< Published by the producer.
+        uint32_t read = 0; ///< Consumer side only.
+        std::atomic<Chunk*> next{ nullptr };
+    };
+
+    /**
+     * Single-producer single-consumer buffer of one thread. Buffers are never
+     * freed while the MessageQueue lives; when a thread exits its buffer is
+     * released and reused by the next thread that pushes.
+     */
+    struct ThreadQueue {
+        Chunk* head = nullptr; ///< Consumer side.
+        Chunk* tail = nullptr; ///< Producer side.
+        std::atomic<bool> owned{ false };
+        ThreadQueue* next_queue = nullptr;
+
+        // Producer-written counters, read by get_stats().
+        std::atomic<uint64_t> pushed{ 0 };
+        std::atomic<uint64_t> overflowed{ 0 };
+        std::atomic<uint64_t> chunks_allocated{ 0 };
+        std::atomic<size_t> bytes{ 0 };
+        std::atomic<size_t> peak_bytes{ 0 };
+    };
+
+    template <typename M>
+    struct MethodTraits;
+
+    template <typename C, typename R, typename... P>
+    struct MethodTraits<R (C::*)(P...)> {
+        typedef C Class;
+    };
+
+    template <typename C, typename R, typename... P>
+    struct MethodTraits<R (C::*)(P...) const> {
+        typedef C Class;
+    };
+
+    // A plain function taking the target first, for callers that cannot
+    // add a member to the target's class (CallbackFunc<T>).
+    template <typename C, typename R, typename... P>
+    struct MethodTraits<R (*)(C*, P...)> {
+        typedef C Class;
+    };
+
+    template <auto Method, typename... Args>
+    struct CallThunk {
+        typedef std::tuple<typename std::decay<Args>::type...> Pack;
+        typedef typename MethodTraits<decltype(Method)>::Class Class;
+
+        static void call(Object* p_object, void* p_args) {
+            Class* instance = static_cast<Class*>(p_object);
+            std::apply([instance](auto&... p_values) { std::invoke(Method, instance, p_values...); }, *static_cast<Pack*>(p_args));
+        }
+        static void destroy(void* p_args) { static_cast<Pack*>(p_args)->~Pack(); }
+    };
+
+    static MethodID _register_method(const MethodThunk& p_thunk);
+
+    ThreadQueue* _get_thread_queue();
+    void* _begin_record(ObjectID p_object, MethodID p_method, size_t p_args_size, Chunk** r_chunk, uint32_t* r_end);
+    Record* _peek(ThreadQueue* p_queue);
+
+    static MethodThunk methods[MAX_METHODS];
+    static std::atomic<uint32_t> method_count;
+
+    std::atomic<ThreadQueue*> queues{ nullptr };
+    std::atomic<uint64_t> sequence{ 0 };
+    std::atomic<size_t> max_thread_bytes{ 0 };
+    uint32_t flush_budget = 0;
+    bool flushing = false;
+
+    // Consumer-side counters.
+    uint64_t flushed = 0;
+    uint64_t dropped_freed = 0;
+    uint64_t budget_exhausted = 0;
+    uint64_t flushed_per_phase[PHASE_MAX] = {};
+
+    friend struct MessageQueueThreadSlot;
+};
+
+template <auto Method, typename... Args>
+MessageQueue::MethodID MessageQueue::get_method_id() {
+    static const MethodID id = _register_method({ &CallThunk<Method, Args...>::call, &CallThunk<Method, Args...>::destroy });
+    return id;
+}
+
+template <auto Method, typename... Args>
+Error MessageQueue::push_call(ObjectID p_id, Args&&... p_args) {
+    typedef typename CallThunk<Method, typename std::decay<Args>::type...>::Pack Pack;
+    static_assert(alignof(Pack) <= alignof(Record), "Deferred call arguments must not need more than 16-byte alignment");
+    Chunk* chunk;
+    uint32_t end;
+    void* mem = _begin_record(p_id, get_method_id<Method, typename std::decay<Args>::type...>(), sizeof(Pack), &chunk, &end);
+    if (!mem) {
+        return ERR_OUT_OF_MEMORY;
+    }
+    new (mem) Pack(std::forward<Args>(p_args)...);
+    chunk->written.store(end, std::memory_order_release);
+    return OK;
+}
+
+#endif // MESSAGE_QUEUE_H
@@ -0,0 +1,112 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "object_db.h"
+
+#include <atomic>
+#include <vector>
+
+
+namespace {
+
+struct ObjectSlot {
+    Object* object = nullptr;
+    uint32_t generation = 1;
+    uint32_t next_free = 0;
+};
+
+class SpinLock {
+    std::atomic_flag flag = ATOMIC_FLAG_INIT;
+
+public:
+    void lock() {
+        while (flag.test_and_set(std::memory_order_acquire)) {
+        }
+    }
+    void unlock() { flag.clear(std::memory_order_release); }
+};
+
+SpinLock db_lock;
+std::vector<ObjectSlot> db_slots;
+uint32_t db_free_head = 0; // 1-based, 0 means no free slot.
+uint32_t db_count = 0;
+
+} // namespace
+
+
+ObjectID ObjectDB::add_instance(Object* p_object) {
+    db_lock.lock();
+    uint32_t index;
+    if (db_free_head) {
+        index = db_free_head - 1;
+        db_free_head = db_slots[index].next_free;
+    } else {
+        index = static_cast<uint32_t>(db_slots.size());
+        db_slots.emplace_back();
+    }
+    ObjectSlot& slot = db_slots[index];
+    slot.object = p_object;
+    db_count++;
+    ObjectID id((static_cast<uint64_t>(slot.generation) << 32) | (index + 1));
+    db_lock.unlock();
+    return id;
+}
+
+void ObjectDB::remove_instance(ObjectID p_id) {
+    if (p_id.is_null()) {
+        return;
+    }
+    db_lock.lock();
+    uint32_t index = p_id.get_slot() - 1;
+    if (index < db_slots.size() && db_slots[index].generation == p_id.get_generation()) {
+        ObjectSlot& slot = db_slots[index];
+        slot.object = nullptr;
+        // Skip 0 on wrap-around so a valid ID is never null.
+        slot.generation = slot.generation + 1 ? slot.generation + 1 : 1;
+        slot.next_free = db_free_head;
+        db_free_head = index + 1;
+        db_count--;
+    }
+    db_lock.unlock();
+}
+
+Object* ObjectDB::get_instance(ObjectID p_id) {
+    if (p_id.is_null()) {
+        return nullptr;
+    }
+    Object* object = nullptr;
+    db_lock.lock();
+    uint32_t index = p_id.get_slot() - 1;
+    if (index < db_slots.size() && db_slots[index].generation == p_id.get_generation()) {
+        object = db_slots[index].object;
+    }
+    db_lock.unlock();
+    return object;
+}
+
+uint32_t ObjectDB::get_object_count() {
+    db_lock.lock();
+    uint32_t count = db_count;
+    db_lock.unlock();
+    return count;
+}
@@ -0,0 +1,57 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef OBJECT_DB_H
+#define OBJECT_DB_H
+
+#include <cstdint>
+
+#include "core/templates/object_id.h"
+
+class Object;
+
+/**
+ * @class ObjectDB
+ * @brief Registry resolving ObjectID handles to live objects.
+ *
+ * Used by deferred calls and anything else that must outlive the object it
+ * targets: holding an ObjectID instead of an Object* turns a use-after-free
+ * into a null lookup. Thread-safe.
+ */
+class ObjectDB {
+public:
+    static ObjectID add_instance(Object* p_object);
+    static void remove_instance(ObjectID p_id);
+
+    /**
+     * @return The object, or nullptr if it has been freed.
+     */
+    static Object* get_instance(ObjectID p_id);
+
+    static uint32_t get_object_count();
+
+private:
+    ObjectDB() {}
+};
+
+#endif // OBJECT_DB_H
@@ -0,0 +1,322 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "object_pool.h"
+
+#include <new>
+
+// Under AddressSanitizer free blocks are poisoned, all but their free list
+// link, so a use after delete of a pooled object is reported like one of a
+// heap object.
+#if defined(__SANITIZE_ADDRESS__)
+#define OBJECT_POOL_ASAN
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define OBJECT_POOL_ASAN
+#endif
+#endif
+
+#ifdef OBJECT_POOL_ASAN
+#include <sanitizer/asan_interface.h>
+#endif
+
+
+namespace {
+
+class SpinLock {
+    std::atomic_flag flag = ATOMIC_FLAG_INIT;
+
+public:
+    void lock() {
+        while (flag.test_and_set(std::memory_order_acquire)) {
+        }
+    }
+    void unlock() { flag.clear(std::memory_order_release); }
+};
+
+struct Block {
+    Block* next;
+};
+
+const uint32_t size_classes[] = {
+    16, 32, 48, 64, 80, 96, 112, 128,
+    160, 192, 224, 256, 320, 384, 448, 512,
+    640, 768, 896, 1024, 1280, 1536, 1792, 2048
+};
+const uint32_t SIZE_CLASS_COUNT = sizeof(size_classes) / sizeof(size_classes[0]);
+
+#ifdef OBJECT_POOL_ASAN
+inline void _poison_free(Block* p_block, uint32_t p_class) {
+    ASAN_UNPOISON_MEMORY_REGION(p_block, sizeof(Block));
+    ASAN_POISON_MEMORY_REGION(reinterpret_cast<uint8_t*>(p_block) + sizeof(Block), size_classes[p_class] - sizeof(Block));
+}
+// Only the requested size: writing past the object is reported too.
+inline void _unpoison(Block* p_block, size_t p_size) {
+    ASAN_POISON_MEMORY_REGION(p_block, sizeof(Block));
+    ASAN_UNPOISON_MEMORY_REGION(p_block, p_size);
+}
+#else
+inline void _poison_free(Block*, uint32_t) {}
+inline void _unpoison(Block*, size_t) {}
+#endif
+
+// Size class of every 16-byte step up to MAX_POOLED_SIZE.
+struct SizeClassTable {
+    uint8_t index[ObjectPool::MAX_POOLED_SIZE / 16 + 1] = {};
+
+    constexpr SizeClassTable() {
+        uint32_t c = 0;
+        for (uint32_t i = 0; i <= ObjectPool::MAX_POOLED_SIZE / 16; i++) {
+            while (size_classes[c] < i * 16) {
+                c++;
+            }
+            index[i] = static_cast<uint8_t>(c);
+        }
+    }
+};
+constexpr SizeClassTable size_class_table;
+
+inline uint32_t _size_class(size_t p_size) {
+    return size_class_table.index[(p_size + 15) >> 4];
+}
+
+// Blocks a thread keeps per size class before handing half back.
+inline uint32_t _cache_limit(uint32_t p_class) {
+    uint32_t limit = static_cast<uint32_t>((ObjectPool::SLAB_SIZE / 4) / size_classes[p_class]);
+    return limit < 8 ? 8 : (limit > 256 ? 256 : limit);
+}
+
+struct CentralList {
+    SpinLock lock;
+    Block* head = nullptr;
+    uint32_t count = 0;
+};
+
+CentralList central[SIZE_CLASS_COUNT];
+std::atomic<size_t> slab_count{ 0 };
+std::atomic<uint64_t> heap_fallbacks{ 0 };
+std::atomic<ObjectPool::ClassStats*> class_stats_head{ nullptr };
+
+// Carves a new slab. Returns the chain of blocks; r_tail gets its last one.
+Block* _new_slab(uint32_t p_class, Block** r_tail, uint32_t* r_count) {
+    const uint32_t size = size_classes[p_class];
+    const uint32_t count = static_cast<uint32_t>(ObjectPool::SLAB_SIZE / size);
+    uint8_t* slab = static_cast<uint8_t*>(::operator new(ObjectPool::SLAB_SIZE, std::align_val_t(64)));
+    for (uint32_t i = 0; i + 1 < count; i++) {
+        reinterpret_cast<Block*>(slab + i * size)->next = reinterpret_cast<Block*>(slab + (i + 1) * size);
+        _poison_free(reinterpret_cast<Block*>(slab + i * size), p_class);
+    }
+    Block* tail = reinterpret_cast<Block*>(slab + (count - 1) * size);
+    tail->next = nullptr;
+    _poison_free(tail, p_class);
+    slab_count.fetch_add(1, std::memory_order_relaxed);
+    *r_tail = tail;
+    *r_count = count;
+    return reinterpret_cast<Block*>(slab);
+}
+
+void _central_push(uint32_t p_class, Block* p_head, Block* p_tail, uint32_t p_count) {
+    CentralList& list = central[p_class];
+    list.lock.lock();
+    p_tail->next = list.head;
+    list.head = p_head;
+    list.count += p_count;
+    list.lock.unlock();
+}
+
+// Takes up to p_max blocks from the global list, or a fresh slab when it is
+// empty. The surplus of a fresh slab goes to the global list.
+Block* _central_pop(uint32_t p_class, uint32_t p_max, uint32_t* r_count) {
+    CentralList& list = central[p_class];
+    list.lock.lock();
+    Block* head = list.head;
+    uint32_t taken = 0;
+    if (head) {
+        Block* tail = head;
+        taken = 1;
+        while (taken < p_max && tail->next) {
+            tail = tail->next;
+            taken++;
+        }
+        list.head = tail->next;
+        list.count -= taken;
+        tail->next = nullptr;
+    }
+    list.lock.unlock();
+
+    if (!head) {
+        Block* tail;
+        uint32_t count;
+        head = _new_slab(p_class, &tail, &count);
+        Block* last = head;
+        taken = 1;
+        while (taken < p_max && last->next) {
+            last = last->next;
+            taken++;
+        }
+        if (last->next) {
+            _central_push(p_class, last->next, tail, count - taken);
+            last->next = nullptr;
+        }
+    }
+    *r_count = taken;
+    return head;
+}
+
+struct ThreadCache {
+    Block* head[SIZE_CLASS_COUNT] = {};
+    uint32_t count[SIZE_CLASS_COUNT] = {};
+
+    // Hands p_count blocks from the front of the list back to the global list.
+    void release(uint32_t p_class, uint32_t p_count) {
+        if (p_count == 0) {
+            return;
+        }
+        Block* first = head[p_class];
+        Block* last = first;
+        for (uint32_t i = 1; i < p_count; i++) {
+            last = last->next;
+        }
+        head[p_class] = last->next;
+        count[p_class] -= p_count;
+        _central_push(p_class, first, last, p_count);
+    }
+
+    void flush() {
+        for (uint32_t c = 0; c < SIZE_CLASS_COUNT; c++) {
+            release(c, count[c]);
+        }
+    }
+
+    ~ThreadCache();
+};
+
+// Frees that happen after this thread's cache is destroyed (objects deleted
+// by other thread_local or static destructors) go straight to the global
+// lists. A bool stays readable after thread_local destruction.
+thread_local bool thread_cache_dead = false;
+thread_local ThreadCache thread_cache;
+
+ThreadCache::~ThreadCache() {
+    flush();
+    thread_cache_dead = true;
+}
+
+} // namespace
+
+
+ObjectPool::ClassStats::ClassStats(const char* p_class_name) :
+        class_name(p_class_name) {
+    ClassStats* first = class_stats_head.load(std::memory_order_relaxed);
+    do {
+        next = first;
+    } while (!class_stats_head.compare_exchange_weak(first, this, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void* ObjectPool::allocate(size_t p_size, ClassStats& p_stats) {
+    p_stats.allocs.fetch_add(1, std::memory_order_relaxed);
+    uint64_t live = p_stats.live.fetch_add(1, std::memory_order_relaxed) + 1;
+    uint64_t peak = p_stats.peak.load(std::memory_order_relaxed);
+    while (live > peak && !p_stats.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+
+    if (p_size > MAX_POOLED_SIZE) {
+        heap_fallbacks.fetch_add(1, std::memory_order_relaxed);
+        return ::operator new(p_size);
+    }
+
+    const uint32_t c = _size_class(p_size);
+    if (thread_cache_dead) {
+        uint32_t count;
+        Block* block = _central_pop(c, 1, &count);
+        _unpoison(block, p_size);
+        return block;
+    }
+
+    ThreadCache& cache = thread_cache;
+    if (!cache.head[c]) {
+        cache.head[c] = _central_pop(c, _cache_limit(c) / 2, &cache.count[c]);
+    }
+    Block* block = cache.head[c];
+    cache.head[c] = block->next;
+    cache.count[c]--;
+    _unpoison(block, p_size);
+    return block;
+}
+
+void ObjectPool::free(void* p_ptr, size_t p_size, ClassStats& p_stats) {
+    if (!p_ptr) {
+        return;
+    }
+    p_stats.frees.fetch_add(1, std::memory_order_relaxed);
+    p_stats.live.fetch_sub(1, std::memory_order_relaxed);
+
+    if (p_size > MAX_POOLED_SIZE) {
+        ::operator delete(p_ptr);
+        return;
+    }
+
+    const uint32_t c = _size_class(p_size);
+    Block* block = static_cast<Block*>(p_ptr);
+    _poison_free(block, c);
+    if (thread_cache_dead) {
+        _central_push(c, block, block, 1);
+        return;
+    }
+
+    ThreadCache& cache = thread_cache;
+    block->next = cache.head[c];
+    cache.head[c] = block;
+    const uint32_t limit = _cache_limit(c);
+    if (++cache.count[c] > limit) {
+        cache.release(c, limit / 2);
+    }
+}
+
+std::vector<ObjectPool::ClassStatsSnapshot> ObjectPool::get_class_stats() {
+    std::vector<ClassStatsSnapshot> result;
+    for (ClassStats* s = class_stats_head.load(std::memory_order_acquire); s; s = s->next) {
+        ClassStatsSnapshot snapshot;
+        snapshot.class_name = s->class_name;
+        snapshot.allocs = s->allocs.load(std::memory_order_relaxed);
+        snapshot.frees = s->frees.load(std::memory_order_relaxed);
+        snapshot.live = s->live.load(std::memory_order_relaxed);
+        snapshot.peak = s->peak.load(std::memory_order_relaxed);
+        result.push_back(snapshot);
+    }
+    return result;
+}
+
+ObjectPool::Stats ObjectPool::get_stats() {
+    Stats stats;
+    stats.slabs = slab_count.load(std::memory_order_relaxed);
+    stats.slab_bytes = stats.slabs * SLAB_SIZE;
+    stats.heap_fallbacks = heap_fallbacks.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void ObjectPool::flush_thread_cache() {
+    if (!thread_cache_dead) {
+        thread_cache.flush();
+    }
+}
@@ -0,0 +1,115 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef OBJECT_POOL_H
+#define OBJECT_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class ObjectPool
+ * @brief Slab allocator for classes declared with MCLASS_POOLED.
+ *
+ * Memory is carved out of 64 KiB slabs into fixed size classes. Each thread
+ * keeps a small free list per size class, so most allocations and frees
+ * touch no lock and no shared cache line; the threads only meet on the
+ * global lists when a cache runs empty or overflows, and then move blocks
+ * in batches. Objects larger than MAX_POOLED_SIZE fall back to the heap.
+ *
+ * Slabs are kept for the lifetime of the process: a scene that spawns ten
+ * thousand bullets once will spawn them again.
+ */
+class ObjectPool {
+public:
+    static const size_t SLAB_SIZE = 64 * 1024;
+    static const size_t MAX_POOLED_SIZE = 2048;
+
+    /** @brief Counters of one pooled class. Registered on first use. */
+    struct ClassStats {
+        const char* class_name;
+        std::atomic<uint64_t> allocs{ 0 };
+        std::atomic<uint64_t> frees{ 0 };
+        std::atomic<uint64_t> live{ 0 };
+        std::atomic<uint64_t> peak{ 0 };
+        ClassStats* next = nullptr;
+
+        explicit ClassStats(const char* p_class_name);
+    };
+
+    struct ClassStatsSnapshot {
+        const char* class_name = nullptr;
+        uint64_t allocs = 0;
+        uint64_t frees = 0;
+        uint64_t live = 0;
+        uint64_t peak = 0;
+    };
+
+    struct Stats {
+        size_t slab_bytes = 0; ///< Memory reserved in slabs.
+        size_t slabs = 0;
+        uint64_t heap_fallbacks = 0; ///< Allocations too large for a size class.
+    };
+
+    static void* allocate(size_t p_size, ClassStats& p_stats);
+    static void free(void* p_ptr, size_t p_size, ClassStats& p_stats);
+
+    static std::vector<ClassStatsSnapshot> get_class_stats();
+    static Stats get_stats();
+
+    /** @brief Return the calling thread's cached blocks to the global lists. */
+    static void flush_thread_cache();
+
+private:
+    ObjectPool() {}
+};
+
+// Declares a class as pooled. Put it in the class body next to CLASS():
+//
+//     class Bullet : public Node2D {
+//         CLASS(Bullet, Node2D);
+//         MCLASS_POOLED(Bullet);
+//
+// new/delete of the class, and so Object::instantiate<T>() and _create(),
+// then go through ObjectPool. Subclasses inherit the pool and are counted
+// under the parent unless they declare MCLASS_POOLED themselves; the sized
+// delete picks the right size class through the virtual destructor.
+#define MCLASS_POOLED(class_name)                                                  \
+public:                                                                            \
+    static ObjectPool::ClassStats& get_pool_stats() {                              \
+        static ObjectPool::ClassStats stats(#class_name);                          \
+        return stats;                                                              \
+    }                                                                              \
+    static void* operator new(size_t p_size) {                                     \
+        return ObjectPool::allocate(p_size, get_pool_stats());                     \
+    }                                                                              \
+    static void operator delete(void* p_ptr, size_t p_size) {                      \
+        ObjectPool::free(p_ptr, p_size, get_pool_stats());                         \
+    }                                                                              \
+    static void* operator new(size_t, void* p_where) { return p_where; }           \
+    static void operator delete(void*, void*) {}                                   \
+private:
+
+#endif // OBJECT_POOL_H
@@ -0,0 +1,275 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef PROPERTY_TABLE_H
+#define PROPERTY_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+class Object;
+
+/**
+ * @brief Storage type of a registered property.
+ *
+ * Properties are registered once per class and resolved to an index, so the
+ * type only has to be checked at lookup time, never on every get/set.
+ */
+enum PropertyType : uint8_t {
+	PROPERTY_TYPE_NIL,
+	PROPERTY_TYPE_BOOL,
+	PROPERTY_TYPE_INT32,
+	PROPERTY_TYPE_INT64,
+	PROPERTY_TYPE_FLOAT,
+	PROPERTY_TYPE_DOUBLE,
+	PROPERTY_TYPE_STRING,
+	PROPERTY_TYPE_OBJECT,
+	PROPERTY_TYPE_RAW, ///< Any other trivially copyable struct (Vector2, Rect2i, Color...)
+	PROPERTY_TYPE_MAX
+};
+
+template <typename T>
+struct PropertyTypeOf {
+	static constexpr PropertyType type = std::is_pointer<T>::value ? PROPERTY_TYPE_OBJECT : PROPERTY_TYPE_RAW;
+};
+
+template <> struct PropertyTypeOf<bool> { static constexpr PropertyType type = PROPERTY_TYPE_BOOL; };
+template <> struct PropertyTypeOf<int32_t> { static constexpr PropertyType type = PROPERTY_TYPE_INT32; };
+template <> struct PropertyTypeOf<int64_t> { static constexpr PropertyType type = PROPERTY_TYPE_INT64; };
+template <> struct PropertyTypeOf<float> { static constexpr PropertyType type = PROPERTY_TYPE_FLOAT; };
+template <> struct PropertyTypeOf<double> { static constexpr PropertyType type = PROPERTY_TYPE_DOUBLE; };
+template <> struct PropertyTypeOf<std::string> { static constexpr PropertyType type = PROPERTY_TYPE_STRING; };
+
+// One address per C++ type. PROPERTY_TYPE_RAW covers every struct, so typed
+// access compares this as well to tell Vector2i from a same-sized Vector2.
+template <typename T>
+struct PropertyTypeId {
+	static inline const char tag = 0;
+	static const void* get() { return &tag; }
+};
+
+/**
+ * @brief Class-level description of one property.
+ *
+ * Every property is reached through a getter/setter thunk generated at
+ * registration. The thunk downcasts the Object to the registering class and
+ * applies the member pointer or accessor there, so the compiler does the
+ * base adjustment instead of a hand-computed byte offset.
+ */
+struct PropertyInfo {
+	typedef void (*GetFunc)(const Object* p_object, void* r_value);
+	typedef void (*SetFunc)(Object* p_object, const void* p_value);
+
+	const char* name = nullptr;
+	PropertyType type = PROPERTY_TYPE_NIL;
+	uint32_t size = 0;
+	const void* type_id = nullptr; ///< PropertyTypeId of the C++ type.
+	bool member = false; ///< Backed by a data member rather than accessors.
+	GetFunc getter = nullptr;
+	SetFunc setter = nullptr;
+
+	bool is_member() const { return member; }
+	bool is_read_only() const { return setter == nullptr; }
+};
+
+/**
+ * @brief Per-class property table.
+ *
+ * Built once when the class is first used. A derived table starts as a copy
+ * of its parent, so indices are flat and stable across the hierarchy: index
+ * N names the same property on a Node and on every class inheriting it.
+ */
+class PropertyTable {
+public:
+	explicit PropertyTable(const PropertyTable* p_parent = nullptr, const char* p_class_name = "") :
+			class_name(p_class_name) {
+		if (p_parent) {
+			properties = p_parent->properties;
+			indices = p_parent->indices;
+		}
+	}
+
+	/**
+	 * @brief Register a data member.
+	 * The thunks read and write the member through its member pointer, on the
+	 * object itself, so classes with several or virtual bases are fine.
+	 */
+	template <auto Member>
+	int add_member(const char* p_name);
+
+	/** @brief Register a property backed by a getter and a setter. */
+	template <class C, class T, T (C::*Getter)() const, void (C::*Setter)(T)>
+	int add_accessor(const char* p_name);
+
+	/** @brief Register a computed property that can only be read. */
+	template <class C, class T, T (C::*Getter)() const>
+	int add_read_only(const char* p_name);
+
+	/** @brief Resolve a property name to its index, -1 when missing. Slow path, cache the result. */
+	int find(const std::string& p_name) const {
+		auto it = indices.find(p_name);
+		return it != indices.end() ? it->second : -1;
+	}
+
+	const PropertyInfo& get_info(int p_index) const { return properties[p_index]; }
+	int get_count() const { return static_cast<int>(properties.size()); }
+	bool is_valid_index(int p_index) const { return p_index >= 0 && p_index < get_count(); }
+	const char* get_class_name() const { return class_name; }
+
+	/** @brief True when @p p_index is a property of exactly the C++ type T. */
+	template <typename T>
+	bool is_type(int p_index) const {
+		return is_valid_index(p_index) && properties[p_index].type == PropertyTypeOf<T>::type && properties[p_index].size == sizeof(T) &&
+				properties[p_index].type_id == PropertyTypeId<T>::get();
+	}
+
+	/**
+	 * @brief Copy one property of @p p_object into @p r_value.
+	 * @return false, leaving @p r_value untouched, when the index is out of range.
+	 */
+	bool get(const Object* p_object, int p_index, void* r_value) const {
+		if (!is_valid_index(p_index)) {
+			return false;
+		}
+		properties[p_index].getter(p_object, r_value);
+		return true;
+	}
+
+	/**
+	 * @brief Write one property of @p p_object from @p p_value.
+	 * @return false when the index is out of range or the property is read-only.
+	 */
+	bool set(Object* p_object, int p_index, const void* p_value) const {
+		if (!is_valid_index(p_index) || !properties[p_index].setter) {
+			return false;
+		}
+		properties[p_index].setter(p_object, p_value);
+		return true;
+	}
+
+	/**
+	 * @brief Batch read for serializers and animation tracks.
+	 * @p r_values[i] receives the property at @p p_indices[i]. No strings
+	 * and no allocations are involved. Invalid indices are skipped.
+	 * @return false if any index was skipped.
+	 */
+	bool get_batch(const Object* p_object, const int* p_indices, size_t p_count, void* const* r_values) const {
+		bool ok = true;
+		for (size_t i = 0; i < p_count; i++) {
+			ok &= get(p_object, p_indices[i], r_values[i]);
+		}
+		return ok;
+	}
+
+	/** @brief Batch write, the counterpart of get_batch(). Read-only properties count as skipped. */
+	bool set_batch(Object* p_object, const int* p_indices, size_t p_count, const void* const* p_values) const {
+		bool ok = true;
+		for (size_t i = 0; i < p_count; i++) {
+			ok &= set(p_object, p_indices[i], p_values[i]);
+		}
+		return ok;
+	}
+
+private:
+	template <class M>
+	struct MemberTraits;
+
+	template <class C, class T>
+	struct MemberTraits<T C::*> {
+		typedef C Class;
+		typedef T Type;
+	};
+
+	int _push(const PropertyInfo& p_info) {
+		auto it = indices.find(p_info.name);
+		if (it != indices.end()) {
+			// Re-registering in a derived class overrides the inherited slot.
+			properties[it->second] = p_info;
+			return it->second;
+		}
+		int index = static_cast<int>(properties.size());
+		properties.push_back(p_info);
+		indices.emplace(p_info.name, index);
+		return index;
+	}
+
+	const char* class_name;
+	std::vector<PropertyInfo> properties;
+	std::unordered_map<std::string, int> indices;
+};
+
+template <auto Member>
+int PropertyTable::add_member(const char* p_name) {
+	typedef typename MemberTraits<decltype(Member)>::Class C;
+	typedef typename MemberTraits<decltype(Member)>::Type T;
+	PropertyInfo info;
+	info.name = p_name;
+	info.type = PropertyTypeOf<T>::type;
+	info.size = sizeof(T);
+	info.type_id = PropertyTypeId<T>::get();
+	info.member = true;
+	info.getter = [](const Object* p_object, void* r_value) { *static_cast<T*>(r_value) = static_cast<const C*>(p_object)->*Member; };
+	info.setter = [](Object* p_object, const void* p_value) { static_cast<C*>(p_object)->*Member = *static_cast<const T*>(p_value); };
+	return _push(info);
+}
+
+template <class C, class T, T (C::*Getter)() const, void (C::*Setter)(T)>
+int PropertyTable::add_accessor(const char* p_name) {
+	typedef typename std::decay<T>::type V;
+	PropertyInfo info;
+	info.name = p_name;
+	info.type = PropertyTypeOf<V>::type;
+	info.size = sizeof(V);
+	info.type_id = PropertyTypeId<V>::get();
+	info.getter = [](const Object* p_object, void* r_value) { *static_cast<V*>(r_value) = (static_cast<const C*>(p_object)->*Getter)(); };
+	info.setter = [](Object* p_object, const void* p_value) { (static_cast<C*>(p_object)->*Setter)(*static_cast<const V*>(p_value)); };
+	return _push(info);
+}
+
+template <class C, class T, T (C::*Getter)() const>
+int PropertyTable::add_read_only(const char* p_name) {
+	typedef typename std::decay<T>::type V;
+	PropertyInfo info;
+	info.name = p_name;
+	info.type = PropertyTypeOf<V>::type;
+	info.size = sizeof(V);
+	info.type_id = PropertyTypeId<V>::get();
+	info.getter = [](const Object* p_object, void* r_value) { *static_cast<V*>(r_value) = (static_cast<const C*>(p_object)->*Getter)(); };
+	return _push(info);
+}
+
+// Registration helpers, used from a class' static _bind_properties(PropertyTable&).
+#define MPROPERTY(m_table, m_class, m_member) \
+	(m_table).add_member<&m_class::m_member>(#m_member)
+
+#define MPROPERTY_ACCESSOR(m_table, m_class, m_type, m_name, m_getter, m_setter) \
+	(m_table).add_accessor<m_class, m_type, &m_class::m_getter, &m_class::m_setter>(m_name)
+
+#define MPROPERTY_READ_ONLY(m_table, m_class, m_type, m_name, m_getter) \
+	(m_table).add_read_only<m_class, m_type, &m_class::m_getter>(m_name)
+
+#endif // PROPERTY_TABLE_H
@@ -25,31 +25,176 @@ SOFTWARE.
 #define REF_COUNTED_H
 
 
-
-
-#include <varargs.h>
+#include <atomic>
+#include <cstdint>
+#include <utility>
 #include <variant>
 
 class Variant;
 
+/**
+ * @brief Thread-safe reference count. Used by default, so a RefCounted can be
+ * handed to worker threads, loaders and the audio thread.
+ */
+struct RefCountAtomic {
+    std::atomic<uint32_t> count{0};
+
+    uint32_t get() const { return count.load(std::memory_order_acquire); }
+    // Taking a new reference needs no ordering, the caller already holds one.
+    void increment() { count.fetch_add(1, std::memory_order_relaxed); }
+    // Returns the new count. acq_rel so the deleting thread sees every write.
+    uint32_t decrement() { return count.fetch_sub(1, std::memory_order_acq_rel) - 1; }
+    // Increment only if the object is still alive, used by WeakRef::lock().
+    bool increment_if_alive() {
+        uint32_t c = count.load(std::memory_order_relaxed);
+        while (c != 0) {
+            if (count.compare_exchange_weak(c, c + 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    struct Lock {
+        std::atomic_flag flag = ATOMIC_FLAG_INIT;
+        void lock() {
+            while (flag.test_and_set(std::memory_order_acquire)) {
+            }
+        }
+        void unlock() { flag.clear(std::memory_order_release); }
+    };
+};
+
+/**
+ * @brief Plain reference count for types that never leave the scene thread.
+ * Nodes, actions and other per-frame objects pay no atomic cost.
+ */
+struct RefCountNonAtomic {
+    uint32_t count = 0;
+
+    uint32_t get() const { return count; }
+    void increment() { ++count; }
+    uint32_t decrement() { return --count; }
+    bool increment_if_alive() {
+        if (count == 0) {
+            return false;
+        }
+        ++count;
+        return true;
+    }
+
+    struct Lock {
+        void lock() {}
+        void unlock() {}
+    };
+};
+
+/**
+ * @brief Intrusive reference counting base, parameterized by counter policy.
+ *
+ * Derive from RefCounted (atomic) or RefCountedLocal (non-atomic). The
+ * choice is made at compile time, so Ref<T> inlines the right increment.
+ */
+template <class Policy>
+class RefCountedBase {
+public:
+    /**
+     * @brief Shared block that outlives the object while weak references
+     * exist. It is only allocated on the first WeakRef.
+     */
+    struct WeakBlock {
+        typename Policy::Lock lock;
+        RefCountedBase* object = nullptr;
+        Policy weak_refs;
+    };
+
+    RefCountedBase() {}
+    RefCountedBase(int initialRefCount) {
+        for (int i = 0; i < initialRefCount; i++) {
+            refCount.increment();
+        }
+    }
+    RefCountedBase(const RefCountedBase&) = delete;
+    RefCountedBase& operator=(const RefCountedBase&) = delete;
+    virtual ~RefCountedBase() {}
+
+    bool init_ref() {             // Initialize reference count
+        isInitialized = true;
+        return reference();
+    }
+    bool reference() {            // Add a reference
+        refCount.increment();
+        return true;
+    }
+    // Remove a reference. Returns true when this was the last one, the
+    // caller is then responsible for deleting the object.
+    bool unreference() {
+        if (refCount.decrement() != 0) {
+            return false;
+        }
+        _detach_weak();
+        return true;
+    }
+    int get_reference_count() const { return static_cast<int>(refCount.get()); }  // Get the reference count
+    bool is_referenced() const { return isInitialized; }  // Check if referenced
+
+    // Used by WeakRef, never call directly.
+    WeakBlock* _acquire_weak() {
+        WeakBlock* block = weakBlock.load(std::memory_order_acquire);
+        if (!block) {
+            // Only a strong reference holder may create weak references, so
+            // two threads racing here already share ownership; publish once.
+            WeakBlock* created = new WeakBlock;
+            created->object = this;
+            created->weak_refs.increment(); // Held by the object itself.
+            if (weakBlock.compare_exchange_strong(block, created, std::memory_order_acq_rel)) {
+                block = created;
+            } else {
+                delete created;
+            }
+        }
+        block->weak_refs.increment();
+        return block;
+    }
+    bool _try_reference() { return refCount.increment_if_alive(); }
+
+private:
+    void _detach_weak() {
+        WeakBlock* block = weakBlock.load(std::memory_order_acquire);
+        if (!block) {
+            return;
+        }
+        block->lock.lock();
+        block->object = nullptr;
+        block->lock.unlock();
+        if (block->weak_refs.decrement() == 0) {
+            delete block;
+        }
+    }
+
+    Policy refCount;
+    std::atomic<WeakBlock*> weakBlock{nullptr};
+    bool isInitialized = false;
+};
 
-class RefCounted {
+class RefCounted : public RefCountedBase<RefCountAtomic> {
 public:
     RefCounted();
     RefCounted(int initialRefCount); // Parameterized constructor
     virtual ~RefCounted();
+};
 
-    bool init_ref();             // Initialize reference count
-    bool reference();            // Add a reference
-    bool unreference();          // Remove a reference
-    int get_reference_count() const;  // Get the reference count
-    bool is_referenced() const;  // Check if referenced
-
-private:
-    unsigned int refCount;
-    bool isInitialized;
+// Scene-thread-only objects: same API as RefCounted, non-atomic counts.
+class RefCountedLocal : public RefCountedBase<RefCountNonAtomic> {
+public:
+    RefCountedLocal();
+    RefCountedLocal(int initialRefCount);
+    virtual ~RefCountedLocal();
 };
 
+// Defined with Variant, so this header does not need it.
+RefCounted* _variant_get_ref_counted(const Variant& p_variant);
+
 template<typename T>
 class Ref {
 public:
@@ -63,8 +208,11 @@ public:
     Ref(const Ref<T_Other>& p_from) : ptr(nullptr) {
         ref_pointer(static_cast<T*>(p_from.get_ptr()));
     }
+    // Steals the reference, no count traffic.
+    template <class T_Other>
+    Ref(Ref<T_Other>&& p_from) noexcept : ptr(static_cast<T*>(p_from._release())) {}
     Ref(const Variant& p_variant) : ptr(nullptr) {
-        T* p_temp = std::get<T*>(p_variant);
+        T* p_temp = dynamic_cast<T*>(_variant_get_ref_counted(p_variant));
         if (p_temp) {
             ref_pointer(p_temp);
         }
@@ -74,65 +222,70 @@ public:
             ptr->reference();
         }
     }
+    Ref(Ref<T>&& other) noexcept : ptr(other.ptr) {
+        other.ptr = nullptr;
+    }
     ~Ref() {
-        if (ptr) {
-            ptr->unreference();
-        }
+        unref();
     }
 
     Ref<T>& operator=(const Ref<T>& other) {
         if (this != &other) {
-            if (ptr) {
-                ptr->unreference();
-            }
+            ref(other);
+        }
+        return *this;
+    }
+    Ref<T>& operator=(Ref<T>&& other) noexcept {
+        if (this != &other) {
+            T* old = ptr;
             ptr = other.ptr;
-            if (ptr) {
-                ptr->reference();
-            }
+            other.ptr = nullptr;
+            _release_pointer(old);
         }
         return *this;
     }
+    template <class T_Other>
+    Ref<T>& operator=(Ref<T_Other>&& other) noexcept {
+        T* old = ptr;
+        ptr = static_cast<T*>(other._release());
+        _release_pointer(old);
+        return *this;
+    }
 
     T* operator->() const { return ptr; }
     T& operator*() const { return *ptr; }
     operator bool() const { return ptr != nullptr; }
+    bool operator==(const Ref<T>& p_other) const { return ptr == p_other.ptr; }
+    bool operator!=(const Ref<T>& p_other) const { return ptr != p_other.ptr; }
 
     void ref(const Ref<T>& p_from) {
-        if (ptr) {
-            ptr->unreference();
-        }
-        ptr = p_from.ptr;
-        if (ptr) {
-            ptr->reference();
-        }
+        ref_pointer(p_from.ptr);
     }
 
     void ref_pointer(T* p_ref) {
-        if (ptr) {
-            ptr->unreference();
+        // Reference first so self-assignment cannot drop the last count.
+        if (p_ref) {
+            p_ref->reference();
         }
+        T* old = ptr;
         ptr = p_ref;
-        if (ptr) {
-            ptr->reference();
-        }
+        _release_pointer(old);
     }
 
     template <class T_Other>
     void reference_ptr(T_Other* p_ptr) {
-        if (ptr) {
-            ptr->unreference();
-        }
+        T* old = ptr;
         ptr = static_cast<T*>(p_ptr);
         if (ptr) {
             ptr->init_ref();
         }
+        _release_pointer(old);
     }
 
     void unref() {
-        if (ptr) {
-            ptr->unreference();
-            ptr = nullptr;
-        }
+        T* old = ptr;
+        ptr = nullptr;
+        _release_pointer(old);
     }
 
     void instantiate() {
@@ -144,15 +297,121 @@ public:
         }
     }
 
-    const T* get_ptr() const { return ptr; }
+    T* get_ptr() const { return ptr; }
 
     inline bool is_valid() const { return ptr != nullptr; }
     inline bool is_null() const { return ptr == nullptr; }
 
+    // Gives up ownership without touching the count. Used by moves.
+    T* _release() {
+        T* p = ptr;
+        ptr = nullptr;
+        return p;
+    }
+
+    // Adopts a pointer whose reference was already taken, e.g. by WeakRef::lock().
+    static Ref<T> _adopt(T* p_ptr) {
+        Ref<T> r;
+        r.ptr = p_ptr;
+        return r;
+    }
+
 private:
+    static void _release_pointer(T* p_ptr) {
+        if (p_ptr && p_ptr->unreference()) {
+            delete p_ptr;
+        }
+    }
+
     T* ptr;
 };
 
+/**
+ * @brief Intrusive weak reference to a RefCounted/RefCountedLocal object.
+ *
+ * Does not keep the object alive. lock() returns a valid Ref<T> only while at
+ * least one strong reference exists; safe across threads for RefCounted.
+ */
+template <typename T>
+class WeakRef {
+public:
+    WeakRef() {}
+    WeakRef(const Ref<T>& p_ref) { _set(p_ref.get_ptr()); }
+    WeakRef(const WeakRef<T>& p_other) : block(p_other.block) {
+        if (block) {
+            block->weak_refs.increment();
+        }
+    }
+    WeakRef(WeakRef<T>&& p_other) noexcept : block(p_other.block) {
+        p_other.block = nullptr;
+    }
+    ~WeakRef() { reset(); }
+
+    WeakRef<T>& operator=(const WeakRef<T>& p_other) {
+        if (this != &p_other) {
+            reset();
+            block = p_other.block;
+            if (block) {
+                block->weak_refs.increment();
+            }
+        }
+        return *this;
+    }
+    WeakRef<T>& operator=(WeakRef<T>&& p_other) noexcept {
+        if (this != &p_other) {
+            reset();
+            block = p_other.block;
+            p_other.block = nullptr;
+        }
+        return *this;
+    }
+    WeakRef<T>& operator=(const Ref<T>& p_ref) {
+        reset();
+        _set(p_ref.get_ptr());
+        return *this;
+    }
+
+    // Returns a strong reference, or a null Ref if the object is gone.
+    Ref<T> lock() const {
+        if (!block) {
+            return Ref<T>();
+        }
+        T* obj = nullptr;
+        block->lock.lock();
+        if (block->object && block->object->_try_reference()) {
+            obj = static_cast<T*>(block->object);
+        }
+        block->lock.unlock();
+        return Ref<T>::_adopt(obj);
+    }
+
+    bool is_valid() const {
+        if (!block) {
+            return false;
+        }
+        block->lock.lock();
+        bool alive = block->object != nullptr;
+        block->lock.unlock();
+        return alive;
+    }
+
+    void reset() {
+        if (block && block->weak_refs.decrement() == 0) {
+            delete block;
+        }
+        block = nullptr;
+    }
+
+private:
+    typedef typename T::WeakBlock Block;
+
+    void _set(T* p_ptr) {
+        block = p_ptr ? p_ptr->_acquire_weak() : nullptr;
+    }
+
+    Block* block = nullptr;
+};
+
 
 
-#endif // REF_COUNTED_H
\ No newline at end of file
+#endif // REF_COUNTED_H
@@ -23,6 +23,13 @@ SOFTWARE.
 */
 #include "script.h"
 
+#include "core/error/error_macros.h"
+#include "core/object/script_cache.h"
+#include "core/object/script_instance.h"
+
+#include <algorithm>
+#include <chrono>
+
 
 static void Script::set_source_code(const String& p_code) {
     p_code = code;
@@ -31,4 +38,302 @@ static void Script::set_source_code(const String& p_code) {
 
 String Script::get_source_code() const {
     return code;
-}
\ No newline at end of file
+}
+
+const char* Script::callback_names[Script::CALLBACK_MAX] = {
+    "_ready",
+    "_process",
+    "_physics_process",
+    "_input",
+    "_exit_tree",
+};
+
+// Frame batches iterate the list by index; scripts released meanwhile leave
+// a null entry, removed once the frame is done.
+static bool frame_running = false;
+
+static uint64_t _ticks_usec() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static int _message_handler(lua_State* L) {
+    const char* message = lua_tostring(L, 1);
+    luaL_traceback(L, L, message ? message : "(error object is not a string)", 1);
+    return 1;
+}
+
+// A state is not closed while Lua code may still be running on it: a
+// callback that recompiles or frees its own script would return into a
+// closed state. Such states are retired and closed once the frame, or the
+// outermost call, is done.
+static uint32_t lua_depth = 0;
+static std::vector<lua_State*> retired_states;
+
+static void _close_state(lua_State* p_state) {
+    if (frame_running || lua_depth > 0) {
+        retired_states.push_back(p_state);
+    } else {
+        lua_close(p_state);
+    }
+}
+
+static void _close_retired_states() {
+    if (frame_running || lua_depth > 0) {
+        return;
+    }
+    for (lua_State* state : retired_states) {
+        lua_close(state);
+    }
+    retired_states.clear();
+}
+
+Script::Script() {}
+
+Script::~Script() {
+    _release_state();
+}
+
+std::vector<Script*>& Script::_get_compiled_scripts() {
+    static std::vector<Script*> scripts;
+    return scripts;
+}
+
+Error Script::compile(const std::string& p_source, const std::string& p_chunk_name, bool p_trusted_bytecode) {
+    // Build the new state first; a failed recompile keeps the old one running.
+    lua_State* state = luaL_newstate();
+    if (!state) {
+        return ERR_OUT_OF_MEMORY;
+    }
+    luaL_openlibs(state);
+
+    // Loads from the bytecode cache when the source is unchanged.
+    if (ScriptCache::load_lua(state, p_source, p_chunk_name, p_trusted_bytecode) != OK || lua_pcall(state, 0, 1, 0) != LUA_OK) {
+        ERR_PRINT("Script '%s' failed to load: %s", p_chunk_name.c_str(), lua_tostring(state, -1));
+        lua_close(state);
+        return ERR_COMPILATION_FAILED;
+    }
+    if (!lua_istable(state, -1)) {
+        ERR_PRINT("Script '%s' must return its class table.", p_chunk_name.c_str());
+        lua_close(state);
+        return ERR_COMPILATION_FAILED;
+    }
+
+    // Refs into the old state die with it.
+    lua_State* old_state = L;
+    L = state;
+    for (int i = 0; i < CALLBACK_MAX; i++) {
+        callback_refs[i] = LUA_NOREF;
+        lua_getfield(L, -1, callback_names[i]);
+        if (lua_isfunction(L, -1)) {
+            callback_refs[i] = luaL_ref(L, LUA_REGISTRYINDEX);
+        } else {
+            lua_pop(L, 1);
+        }
+    }
+    class_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+    lua_newtable(L);
+    args_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+
+    // Owners keep their ScriptInstance pointers across a reload; only the
+    // Lua side of each instance is rebuilt.
+    for (ScriptInstance* instance : instances) {
+        if (instance) {
+            instance->_rebind(old_state);
+        }
+    }
+
+    if (old_state) {
+        _close_state(old_state);
+    } else {
+        _get_compiled_scripts().push_back(this);
+    }
+    return OK;
+}
+
+void Script::_release_state() {
+    if (!L) {
+        return;
+    }
+    for (ScriptInstance* instance : instances) {
+        delete instance;
+    }
+    instances.clear();
+    free_slots = 0;
+
+    std::vector<Script*>& scripts = _get_compiled_scripts();
+    for (size_t i = 0; i < scripts.size(); i++) {
+        if (scripts[i] == this) {
+            if (frame_running) {
+                scripts[i] = nullptr;
+            } else {
+                scripts.erase(scripts.begin() + i);
+            }
+            break;
+        }
+    }
+
+    _close_state(L);
+    L = nullptr;
+    class_ref = LUA_NOREF;
+    args_ref = LUA_NOREF;
+    for (int i = 0; i < CALLBACK_MAX; i++) {
+        callback_refs[i] = LUA_NOREF;
+    }
+}
+
+ScriptInstance* Script::instance_create(Object* p_owner) {
+    if (!is_compiled()) {
+        return nullptr;
+    }
+    ScriptInstance* instance = new ScriptInstance(this, p_owner);
+    instance->index = instances.size();
+    instances.push_back(instance);
+    return instance;
+}
+
+void Script::instance_free(ScriptInstance* p_instance) {
+    if (!p_instance || p_instance->script != this) {
+        return;
+    }
+    instances[p_instance->index] = nullptr;
+    free_slots++;
+    delete p_instance;
+    // Leave the array alone while a batch walks it.
+    if (batch_depth == 0 && free_slots > instances.size() / 4) {
+        _compact_instances();
+    }
+}
+
+void Script::_compact_instances() {
+    size_t w = 0;
+    for (size_t r = 0; r < instances.size(); r++) {
+        if (instances[r]) {
+            instances[r]->index = w;
+            instances[w++] = instances[r];
+        }
+    }
+    instances.resize(w);
+    free_slots = 0;
+}
+
+Error Script::_call_ref(int p_function_ref, int p_self_ref) {
+    if (!L) {
+        return ERR_UNCONFIGURED;
+    }
+    const uint64_t begin = _ticks_usec();
+    // The call may recompile this script and move it to a new state.
+    lua_State* state = L;
+    const int base = lua_gettop(state);
+    lua_pushcfunction(state, _message_handler);
+    lua_rawgeti(state, LUA_REGISTRYINDEX, p_function_ref);
+    lua_rawgeti(state, LUA_REGISTRYINDEX, p_self_ref);
+    Error err = OK;
+    lua_depth++;
+    if (lua_pcall(state, 1, 0, base + 1) != LUA_OK) {
+        ERR_PRINT("%s", lua_tostring(state, -1));
+        profile.errors++;
+        err = ERR_SCRIPT_FAILED;
+    }
+    lua_depth--;
+    lua_settop(state, base);
+    profile.calls++;
+    _add_time(_ticks_usec() - begin, false);
+    _close_retired_states();
+    return err;
+}
+
+void Script::_run_batch(Callback p_callback, double p_delta) {
+    const uint64_t begin = _ticks_usec();
+    if (L && callback_refs[p_callback] != LUA_NOREF && instances.size() > free_slots) {
+        // Stack: handler, function, args. Each call only pushes self.
+        lua_State* state = L;
+        const int base = lua_gettop(state);
+        lua_pushcfunction(state, _message_handler);
+        lua_rawgeti(state, LUA_REGISTRYINDEX, callback_refs[p_callback]);
+        lua_rawgeti(state, LUA_REGISTRYINDEX, args_ref);
+        lua_pushnumber(state, p_delta);
+        lua_setfield(state, base + 3, "delta");
+
+        const bool physics = p_callback == CALLBACK_PHYSICS_PROCESS;
+        batch_depth++;
+        lua_depth++;
+        // Instances created by a callback wait for the next frame, and so
+        // does the rest of the batch if a callback recompiled the script.
+        const size_t count = instances.size();
+        for (size_t i = 0; i < count && L == state; i++) {
+            ScriptInstance* instance = instances[i];
+            if (!instance || !(physics ? instance->physics_process : instance->process)) {
+                continue;
+            }
+            lua_pushvalue(state, base + 2);
+            lua_rawgeti(state, LUA_REGISTRYINDEX, instance->self_ref);
+            lua_pushnumber(state, p_delta);
+            lua_pushvalue(state, base + 3);
+            if (lua_pcall(state, 3, 0, base + 1) != LUA_OK) {
+                ERR_PRINT("%s", lua_tostring(state, -1));
+                lua_pop(state, 1);
+                profile.errors++;
+            }
+            profile.calls++;
+        }
+        lua_depth--;
+        batch_depth--;
+        lua_settop(state, base);
+        if (batch_depth == 0 && free_slots > 0) {
+            _compact_instances();
+        }
+        _close_retired_states();
+    }
+    _add_time(_ticks_usec() - begin, p_callback == CALLBACK_PROCESS);
+}
+
+void Script::_add_time(uint64_t p_usec, bool p_new_frame) {
+    profile.total_usec += p_usec;
+    profile.frame_usec = p_new_frame ? p_usec : profile.frame_usec + p_usec;
+    if (profile.frame_usec > profile.max_frame_usec) {
+        profile.max_frame_usec = profile.frame_usec;
+    }
+}
+
+void Script::process_instances(double p_delta) {
+    _run_batch(CALLBACK_PROCESS, p_delta);
+}
+
+void Script::physics_process_instances(double p_delta) {
+    _run_batch(CALLBACK_PHYSICS_PROCESS, p_delta);
+}
+
+void Script::process_frame(double p_delta) {
+    std::vector<Script*>& scripts = _get_compiled_scripts();
+    const bool nested = frame_running;
+    frame_running = true;
+    const size_t count = scripts.size();
+    for (size_t i = 0; i < count; i++) {
+        if (scripts[i]) {
+            scripts[i]->process_instances(p_delta);
+        }
+    }
+    if (!nested) {
+        frame_running = false;
+        scripts.erase(std::remove(scripts.begin(), scripts.end(), nullptr), scripts.end());
+        _close_retired_states();
+    }
+}
+
+void Script::physics_process_frame(double p_delta) {
+    std::vector<Script*>& scripts = _get_compiled_scripts();
+    const bool nested = frame_running;
+    frame_running = true;
+    const size_t count = scripts.size();
+    for (size_t i = 0; i < count; i++) {
+        if (scripts[i]) {
+            scripts[i]->physics_process_instances(p_delta);
+        }
+    }
+    if (!nested) {
+        frame_running = false;
+        scripts.erase(std::remove(scripts.begin(), scripts.end(), nullptr), scripts.end());
+        _close_retired_states();
+    }
+}
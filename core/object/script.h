@@ -38,15 +38,22 @@ SOFTWARE.
 #include <core/templates/map.h>
 #include <core/templates/typed_array.h>
 
+#include <core/error/error_list.h>
+
 #include <cstring>
 #include <array>
 #include <cassert>
+#include <cstdint>
+#include <string>
+#include <vector>
 
 
 using namespace LuaCpp;
 using namespace LuaCpp::Registry;
 using namespace LuaCpp::Engine;
 
+class Object;
+class ScriptInstance;
 
 class Script : public RefCounted {
 
@@ -59,8 +66,84 @@ private:
     LuaCpp::LuaContext* p_lua;
     LuaCpp::LuaMetaObject* obj;
     
-    Ref<lua_State> L;
 
+public:
+    enum Callback {
+        CALLBACK_READY,
+        CALLBACK_PROCESS,
+        CALLBACK_PHYSICS_PROCESS,
+        CALLBACK_INPUT,
+        CALLBACK_EXIT_TREE,
+        CALLBACK_MAX
+    };
+
+    struct Profile {
+        uint64_t calls = 0;
+        uint64_t errors = 0;
+        uint64_t total_usec = 0; ///< Lua time since the last reset_profile().
+        uint64_t frame_usec = 0; ///< Lua time of the last frame.
+        uint64_t max_frame_usec = 0;
+    };
+
+    /**
+     * Compile the source into a fresh Lua state. If p_trusted_bytecode
+     * (the script comes from an exported pack), p_source may also be
+     * bytecode from ScriptCache::export_lua(). The chunk must return the
+     * class table; its callbacks (_ready, _process, ...) are resolved once
+     * here and kept as registry refs. Recompiling keeps the instances: each
+     * gets a new self table with the plain fields of the old one, so
+     * pointers from instance_create() stay valid. On failure the previous
+     * state is left running.
+     */
+    Error compile(const std::string& p_source, const std::string& p_chunk_name, bool p_trusted_bytecode = false);
+    bool is_compiled() const { return class_ref != LUA_NOREF; }
+
+    lua_State* get_lua_state() const { return L; }
+    int get_class_ref() const { return class_ref; }
+    bool has_callback(Callback p_callback) const { return callback_refs[p_callback] != LUA_NOREF; }
+
+    ScriptInstance* instance_create(Object* p_owner);
+    void instance_free(ScriptInstance* p_instance);
+    size_t get_instance_count() const { return instances.size() - free_slots; }
+
+    /**
+     * Call _process(self, delta, args) on every processing instance in one
+     * batch: the function and the shared args table are pushed once and
+     * reused for every call. Instances freed by a callback are skipped.
+     */
+    void process_instances(double p_delta);
+    void physics_process_instances(double p_delta);
+
+    /** @brief Run the batches of every compiled script, once per frame. */
+    static void process_frame(double p_delta);
+    static void physics_process_frame(double p_delta);
+
+    const Profile& get_profile() const { return profile; }
+    void reset_profile() { profile = Profile(); }
+
+    Error _call_ref(int p_function_ref, int p_self_ref);
+
+private:
+    static const char* callback_names[CALLBACK_MAX];
+    static std::vector<Script*>& _get_compiled_scripts();
+
+    void _run_batch(Callback p_callback, double p_delta);
+    void _add_time(uint64_t p_usec, bool p_new_frame);
+    void _release_state();
+    void _compact_instances();
+
+    // Lua state of the script. The chunk returns the class table, which is
+    // kept in the registry together with the engine callbacks it defines.
+    lua_State* L = nullptr;
+    int class_ref = LUA_NOREF;
+    int callback_refs[CALLBACK_MAX] = { LUA_NOREF, LUA_NOREF, LUA_NOREF, LUA_NOREF, LUA_NOREF };
+    // One argument table for every call of a batch, refilled once per frame.
+    int args_ref = LUA_NOREF;
+    // Creation order. Freed instances leave a null slot until the next compaction.
+    std::vector<ScriptInstance*> instances;
+    size_t free_slots = 0;
+    uint32_t batch_depth = 0;
+    Profile profile;
 
 public:
     static void can_init();
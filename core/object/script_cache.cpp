@@ -0,0 +1,348 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "script_cache.h"
+
+#include <thirdparty/lua/lua.hpp>
+#include "thirdparty/duktape/duktape.h"
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+
+namespace {
+
+// Cache entry: Header, then the VM bytecode. payload_hash covers the
+// bytecode itself: neither VM verifies a dump, and Duktape's loader trusts
+// it completely, so a truncated or bit-flipped file must never reach them.
+struct Header {
+    char magic[4];
+    uint32_t language;
+    uint64_t hash;
+    uint64_t source_size;
+    uint64_t payload_size;
+    uint64_t payload_hash;
+};
+
+const char ENTRY_MAGIC[4] = { 'P', 'S', 'B', 'C' };
+// Bump when the entry layout changes; old entries then miss.
+const uint32_t ENTRY_FORMAT = 2;
+
+// Duktape dumps start with this byte, which no UTF-8 source can.
+const uint8_t DUKTAPE_BYTECODE_MARKER = 0xBF;
+
+std::mutex cache_mutex;
+std::string cache_dir;
+
+std::atomic<uint64_t> stat_hits{ 0 };
+std::atomic<uint64_t> stat_misses{ 0 };
+std::atomic<uint64_t> stat_writes{ 0 };
+std::atomic<uint64_t> stat_rejected{ 0 };
+std::atomic<uint64_t> stat_bytes_loaded{ 0 };
+
+inline uint64_t _mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+// Eight bytes per step, seeded by the caller.
+uint64_t _hash_bytes(uint64_t p_seed, const char* p_data, size_t p_size) {
+    uint64_t h = _mix(p_seed ^ p_size);
+    size_t i = 0;
+    for (; i + 8 <= p_size; i += 8) {
+        uint64_t word;
+        memcpy(&word, p_data + i, 8);
+        h = (h ^ _mix(word)) * 0x9E3779B97F4A7C15ull;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, p_data + i, p_size - i);
+    h = (h ^ _mix(tail ^ (p_size - i))) * 0x9E3779B97F4A7C15ull;
+    return _mix(h);
+}
+
+uint64_t _hash_payload(const uint8_t* p_payload, size_t p_size) {
+    return _hash_bytes(0x5053424350415944ull, reinterpret_cast<const char*>(p_payload), p_size);
+}
+
+int _lua_writer(lua_State*, const void* p_data, size_t p_size, void* p_user) {
+    std::vector<uint8_t>* out = static_cast<std::vector<uint8_t>*>(p_user);
+    const uint8_t* bytes = static_cast<const uint8_t*>(p_data);
+    out->insert(out->end(), bytes, bytes + p_size);
+    return 0;
+}
+
+bool _is_lua_bytecode(const std::string& p_source) {
+    return p_source.size() >= 4 && memcmp(p_source.data(), LUA_SIGNATURE, 4) == 0;
+}
+
+bool _is_duktape_bytecode(const std::string& p_source) {
+    return !p_source.empty() && static_cast<uint8_t>(p_source[0]) == DUKTAPE_BYTECODE_MARKER;
+}
+
+// Compiles from source and leaves the function on the stack.
+Error _compile_duktape(duk_context* ctx, const std::string& p_source, const std::string& p_filename) {
+    duk_push_string(ctx, p_filename.c_str());
+    if (duk_pcompile_lstring_filename(ctx, 0, p_source.data(), p_source.size()) != 0) {
+        return ERR_COMPILATION_FAILED;
+    }
+    return OK;
+}
+
+duk_ret_t _duk_load_function(duk_context* ctx, void*) {
+    duk_load_function(ctx);
+    return 1;
+}
+
+// Pushes the function of a bytecode dump. duk_load_function() throws on a
+// buffer it cannot decode, so it runs under duk_safe_call(): the error is
+// left on the stack instead of unwinding through the caller.
+Error _load_duktape_bytecode(duk_context* ctx, const uint8_t* p_data, size_t p_size) {
+    void* buffer = duk_push_fixed_buffer(ctx, p_size);
+    memcpy(buffer, p_data, p_size);
+    return duk_safe_call(ctx, _duk_load_function, nullptr, 1, 1) == DUK_EXEC_SUCCESS ? OK : ERR_COMPILATION_FAILED;
+}
+
+} // namespace
+
+
+void ScriptCache::set_cache_dir(const std::string& p_dir) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    cache_dir = p_dir;
+    if (!cache_dir.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(cache_dir, ec);
+    }
+}
+
+std::string ScriptCache::get_cache_dir() {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return cache_dir;
+}
+
+uint64_t ScriptCache::hash_source(Language p_language, const char* p_data, size_t p_size) {
+    // The VM version is part of the key, as bytecode is only valid for the
+    // VM build that produced it.
+    const uint64_t vm_version = p_language == LANGUAGE_LUA ? LUA_VERSION_NUM : DUK_VERSION;
+    return _hash_bytes((uint64_t(ENTRY_FORMAT) << 48) ^ (uint64_t(p_language) << 40) ^ vm_version, p_data, p_size);
+}
+
+std::string ScriptCache::_entry_path(Language p_language, uint64_t p_hash) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx%s", static_cast<unsigned long long>(p_hash), p_language == LANGUAGE_LUA ? ".luac" : ".jsbc");
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    if (cache_dir.empty()) {
+        return std::string();
+    }
+    return (std::filesystem::path(cache_dir) / name).string();
+}
+
+bool ScriptCache::_read_entry(Language p_language, uint64_t p_hash, size_t p_source_size, std::vector<uint8_t>& r_payload) {
+    const std::string path = _entry_path(p_language, p_hash);
+    if (path.empty()) {
+        return false;
+    }
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::error_code ec;
+    const uintmax_t file_size = std::filesystem::file_size(path, ec);
+    Header header;
+    if (ec || !file.read(reinterpret_cast<char*>(&header), sizeof(header)) || memcmp(header.magic, ENTRY_MAGIC, 4) != 0 ||
+            header.language != uint32_t(p_language) || header.hash != p_hash || header.source_size != p_source_size ||
+            header.payload_size != file_size - sizeof(header)) {
+        stat_rejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    r_payload.resize(header.payload_size);
+    if (!file.read(reinterpret_cast<char*>(r_payload.data()), r_payload.size()) ||
+            _hash_payload(r_payload.data(), r_payload.size()) != header.payload_hash) {
+        r_payload.clear();
+        stat_rejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void ScriptCache::_write_entry(Language p_language, uint64_t p_hash, size_t p_source_size, const uint8_t* p_payload, size_t p_size) {
+    const std::string path = _entry_path(p_language, p_hash);
+    if (path.empty()) {
+        return;
+    }
+    Header header;
+    memcpy(header.magic, ENTRY_MAGIC, 4);
+    header.language = p_language;
+    header.hash = p_hash;
+    header.source_size = p_source_size;
+    header.payload_size = p_size;
+    header.payload_hash = _hash_payload(p_payload, p_size);
+
+    // Write aside and rename, so a concurrent or interrupted run never sees
+    // a half-written entry.
+    const std::string temp = path + ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(p_payload), p_size);
+        if (!file) {
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp, path, ec);
+    if (!ec) {
+        stat_writes.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+Error ScriptCache::load_lua(lua_State* L, const std::string& p_source, const std::string& p_chunk_name, bool p_trusted_bytecode) {
+    const std::string chunk_name = "@" + p_chunk_name;
+    // Untrusted bytecode goes down the text path, where mode "t" refuses it.
+    if (p_trusted_bytecode && _is_lua_bytecode(p_source)) {
+        return luaL_loadbufferx(L, p_source.data(), p_source.size(), chunk_name.c_str(), "b") == LUA_OK ? OK : ERR_COMPILATION_FAILED;
+    }
+
+    const uint64_t hash = hash_source(LANGUAGE_LUA, p_source.data(), p_source.size());
+    std::vector<uint8_t> bytecode;
+    if (_read_entry(LANGUAGE_LUA, hash, p_source.size(), bytecode)) {
+        if (luaL_loadbufferx(L, reinterpret_cast<const char*>(bytecode.data()), bytecode.size(), chunk_name.c_str(), "b") == LUA_OK) {
+            stat_hits.fetch_add(1, std::memory_order_relaxed);
+            stat_bytes_loaded.fetch_add(bytecode.size(), std::memory_order_relaxed);
+            return OK;
+        }
+        lua_pop(L, 1);
+        stat_rejected.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    stat_misses.fetch_add(1, std::memory_order_relaxed);
+    if (luaL_loadbufferx(L, p_source.data(), p_source.size(), chunk_name.c_str(), "t") != LUA_OK) {
+        return ERR_COMPILATION_FAILED;
+    }
+    if (!get_cache_dir().empty()) {
+        bytecode.clear();
+        // Keep debug info in the local cache so errors still show lines.
+        if (lua_dump(L, _lua_writer, &bytecode, 0) == 0) {
+            _write_entry(LANGUAGE_LUA, hash, p_source.size(), bytecode.data(), bytecode.size());
+        }
+    }
+    return OK;
+}
+
+Error ScriptCache::load_duktape(duk_hthread* p_ctx, const std::string& p_source, const std::string& p_filename, bool p_trusted_bytecode) {
+    // Untrusted bytecode is compiled as text, which fails on the marker byte.
+    if (p_trusted_bytecode && _is_duktape_bytecode(p_source)) {
+        return _load_duktape_bytecode(p_ctx, reinterpret_cast<const uint8_t*>(p_source.data()), p_source.size());
+    }
+
+    const uint64_t hash = hash_source(LANGUAGE_DUKTAPE, p_source.data(), p_source.size());
+    std::vector<uint8_t> bytecode;
+    if (_read_entry(LANGUAGE_DUKTAPE, hash, p_source.size(), bytecode) && !bytecode.empty() && bytecode[0] == DUKTAPE_BYTECODE_MARKER) {
+        if (_load_duktape_bytecode(p_ctx, bytecode.data(), bytecode.size()) == OK) {
+            stat_hits.fetch_add(1, std::memory_order_relaxed);
+            stat_bytes_loaded.fetch_add(bytecode.size(), std::memory_order_relaxed);
+            return OK;
+        }
+        duk_pop(p_ctx);
+        stat_rejected.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    stat_misses.fetch_add(1, std::memory_order_relaxed);
+    if (_compile_duktape(p_ctx, p_source, p_filename) != OK) {
+        return ERR_COMPILATION_FAILED;
+    }
+    if (!get_cache_dir().empty()) {
+        duk_dup(p_ctx, -1);
+        duk_dump_function(p_ctx);
+        duk_size_t size = 0;
+        const void* data = duk_get_buffer_data(p_ctx, -1, &size);
+        _write_entry(LANGUAGE_DUKTAPE, hash, p_source.size(), static_cast<const uint8_t*>(data), size);
+        duk_pop(p_ctx);
+    }
+    return OK;
+}
+
+Error ScriptCache::export_lua(const std::string& p_source, const std::string& p_chunk_name, std::vector<uint8_t>& r_bytecode) {
+    lua_State* L = luaL_newstate();
+    if (!L) {
+        return ERR_OUT_OF_MEMORY;
+    }
+    const std::string chunk_name = "@" + p_chunk_name;
+    Error err = OK;
+    r_bytecode.clear();
+    if (luaL_loadbufferx(L, p_source.data(), p_source.size(), chunk_name.c_str(), "t") != LUA_OK ||
+            lua_dump(L, _lua_writer, &r_bytecode, 1) != 0) {
+        err = ERR_COMPILATION_FAILED;
+    }
+    lua_close(L);
+    return err;
+}
+
+Error ScriptCache::export_duktape(const std::string& p_source, const std::string& p_filename, std::vector<uint8_t>& r_bytecode) {
+    duk_context* ctx = duk_create_heap_default();
+    if (!ctx) {
+        return ERR_OUT_OF_MEMORY;
+    }
+    Error err = _compile_duktape(ctx, p_source, p_filename);
+    if (err == OK) {
+        duk_dump_function(ctx);
+        duk_size_t size = 0;
+        const uint8_t* data = static_cast<const uint8_t*>(duk_get_buffer_data(ctx, -1, &size));
+        r_bytecode.assign(data, data + size);
+    }
+    duk_destroy_heap(ctx);
+    return err;
+}
+
+ScriptCache::Stats ScriptCache::get_stats() {
+    Stats stats;
+    stats.hits = stat_hits.load(std::memory_order_relaxed);
+    stats.misses = stat_misses.load(std::memory_order_relaxed);
+    stats.writes = stat_writes.load(std::memory_order_relaxed);
+    stats.rejected = stat_rejected.load(std::memory_order_relaxed);
+    stats.bytes_loaded = stat_bytes_loaded.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void ScriptCache::clear() {
+    const std::string dir = get_cache_dir();
+    if (dir.empty()) {
+        return;
+    }
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        const std::string ext = entry.path().extension().string();
+        if (ext == ".luac" || ext == ".jsbc" || ext == ".tmp") {
+            std::filesystem::remove(entry.path(), ec);
+        }
+    }
+}
@@ -0,0 +1,109 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SCRIPT_CACHE_H
+#define SCRIPT_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/error/error_list.h"
+
+struct lua_State;
+struct duk_hthread;
+
+/**
+ * @class ScriptCache
+ * @brief Compiled bytecode of Lua and Duktape scripts, keyed by source hash.
+ *
+ * Loading a script first looks for <cache_dir>/<hash>.luac (or .jsbc), where
+ * the hash covers the source, the script language and the VM version. On a
+ * miss the source is compiled as usual and its bytecode written back, so the
+ * next run skips parsing entirely. A stale or damaged entry is never
+ * trusted: the header must match the source hash and size and the bytecode
+ * its own hash, otherwise the source is compiled again and the entry
+ * replaced.
+ *
+ * Exported projects ship bytecode in place of the source (export_lua(),
+ * export_duktape()). Neither VM can check a dump it is handed, so the
+ * loaders take it only when the caller marks the source as trusted, i.e.
+ * read from an exported pack; anything else is compiled as text, and a
+ * bytecode blob then simply fails to compile.
+ */
+class ScriptCache {
+public:
+    enum Language {
+        LANGUAGE_LUA,
+        LANGUAGE_DUKTAPE,
+    };
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t writes = 0;
+        uint64_t rejected = 0; ///< Entries found but stale or damaged.
+        uint64_t bytes_loaded = 0;
+    };
+
+    /** @brief Directory of cached bytecode. Empty disables the cache. */
+    static void set_cache_dir(const std::string& p_dir);
+    static std::string get_cache_dir();
+
+    /**
+     * Push the compiled chunk of p_source on the Lua stack. With
+     * p_trusted_bytecode, p_source may also be bytecode produced by
+     * export_lua(); otherwise it is loaded as text only.
+     * @return OK, or ERR_COMPILATION_FAILED with the message on the stack.
+     */
+    static Error load_lua(lua_State* L, const std::string& p_source, const std::string& p_chunk_name, bool p_trusted_bytecode = false);
+
+    /**
+     * Push the compiled program of p_source on the Duktape stack, ready for
+     * duk_call(ctx, 0). With p_trusted_bytecode, p_source may also be
+     * bytecode from export_duktape(); Duktape does not validate bytecode,
+     * so only pass it for exported packs. Cache entries are checked
+     * against their hash.
+     * @return OK, or ERR_COMPILATION_FAILED with the error on the stack.
+     */
+    static Error load_duktape(duk_hthread* p_ctx, const std::string& p_source, const std::string& p_filename, bool p_trusted_bytecode = false);
+
+    /** @brief Compile p_source to shippable bytecode, with debug info stripped. */
+    static Error export_lua(const std::string& p_source, const std::string& p_chunk_name, std::vector<uint8_t>& r_bytecode);
+    static Error export_duktape(const std::string& p_source, const std::string& p_filename, std::vector<uint8_t>& r_bytecode);
+
+    static uint64_t hash_source(Language p_language, const char* p_data, size_t p_size);
+
+    static Stats get_stats();
+    static void clear();
+
+private:
+    ScriptCache() {}
+
+    static std::string _entry_path(Language p_language, uint64_t p_hash);
+    static bool _read_entry(Language p_language, uint64_t p_hash, size_t p_source_size, std::vector<uint8_t>& r_payload);
+    static void _write_entry(Language p_language, uint64_t p_hash, size_t p_source_size, const uint8_t* p_payload, size_t p_size);
+};
+
+#endif // SCRIPT_CACHE_H
@@ -0,0 +1,142 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "script_instance.h"
+
+#include "core/object/m_object.h"
+#include "core/object/object_db.h"
+#include "core/object/script.h"
+
+
+ScriptInstance::ScriptInstance(Script* p_script, Object* p_owner) :
+        script(p_script) {
+    if (p_owner) {
+        owner_id = p_owner->get_instance_id();
+    }
+    _create_self();
+}
+
+void ScriptInstance::_create_self() {
+    lua_State* L = script->get_lua_state();
+    if (!L) {
+        return;
+    }
+    // self = setmetatable({ __id = owner_id }, { __index = Class })
+    lua_newtable(L);
+    lua_pushinteger(L, static_cast<lua_Integer>(static_cast<uint64_t>(owner_id)));
+    lua_setfield(L, -2, "__id");
+    lua_newtable(L);
+    lua_rawgeti(L, LUA_REGISTRYINDEX, script->get_class_ref());
+    lua_setfield(L, -2, "__index");
+    lua_setmetatable(L, -2);
+    self_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+}
+
+void ScriptInstance::_rebind(lua_State* p_old_state) {
+    // The old refs die with the old state; nothing to unref.
+    const int old_self_ref = self_ref;
+    method_refs.clear();
+    self_ref = LUA_NOREF;
+    _create_self();
+
+    lua_State* L = script->get_lua_state();
+    if (!p_old_state || old_self_ref == LUA_NOREF || self_ref == LUA_NOREF) {
+        return;
+    }
+    // Carry string-keyed booleans, numbers and strings over, so a reload
+    // keeps the instance's state. Tables and functions belong to the old
+    // code and are left for _ready() or the script to rebuild.
+    lua_rawgeti(p_old_state, LUA_REGISTRYINDEX, old_self_ref);
+    lua_rawgeti(L, LUA_REGISTRYINDEX, self_ref);
+    lua_pushnil(p_old_state);
+    while (lua_next(p_old_state, -2)) {
+        const int type = lua_type(p_old_state, -1);
+        if (lua_type(p_old_state, -2) == LUA_TSTRING && (type == LUA_TBOOLEAN || type == LUA_TNUMBER || type == LUA_TSTRING)) {
+            size_t length = 0;
+            const char* key = lua_tolstring(p_old_state, -2, &length);
+            lua_pushlstring(L, key, length);
+            if (type == LUA_TBOOLEAN) {
+                lua_pushboolean(L, lua_toboolean(p_old_state, -1));
+            } else if (lua_isinteger(p_old_state, -1)) {
+                lua_pushinteger(L, lua_tointeger(p_old_state, -1));
+            } else if (type == LUA_TNUMBER) {
+                lua_pushnumber(L, lua_tonumber(p_old_state, -1));
+            } else {
+                const char* value = lua_tolstring(p_old_state, -1, &length);
+                lua_pushlstring(L, value, length);
+            }
+            lua_rawset(L, -3);
+        }
+        lua_pop(p_old_state, 1);
+    }
+    lua_pop(p_old_state, 1);
+    lua_pop(L, 1);
+}
+
+ScriptInstance::~ScriptInstance() {
+    lua_State* L = script->get_lua_state();
+    if (!L) {
+        return;
+    }
+    for (const auto& method : method_refs) {
+        luaL_unref(L, LUA_REGISTRYINDEX, method.second);
+    }
+    luaL_unref(L, LUA_REGISTRYINDEX, self_ref);
+}
+
+Object* ScriptInstance::get_owner() const {
+    return ObjectDB::get_instance(owner_id);
+}
+
+int ScriptInstance::_get_method_ref(const std::string& p_method) {
+    auto it = method_refs.find(p_method);
+    if (it != method_refs.end()) {
+        return it->second;
+    }
+    lua_State* L = script->get_lua_state();
+    int ref = LUA_REFNIL;
+    if (L && self_ref != LUA_NOREF) {
+        lua_rawgeti(L, LUA_REGISTRYINDEX, self_ref);
+        lua_getfield(L, -1, p_method.c_str());
+        if (lua_isfunction(L, -1)) {
+            ref = luaL_ref(L, LUA_REGISTRYINDEX);
+        } else {
+            lua_pop(L, 1);
+        }
+        lua_pop(L, 1);
+    }
+    method_refs[p_method] = ref;
+    return ref;
+}
+
+bool ScriptInstance::has_method(const std::string& p_method) {
+    return _get_method_ref(p_method) != LUA_REFNIL;
+}
+
+Error ScriptInstance::call(const std::string& p_method) {
+    const int ref = _get_method_ref(p_method);
+    if (ref == LUA_REFNIL) {
+        return ERR_METHOD_NOT_FOUND;
+    }
+    return script->_call_ref(ref, self_ref);
+}
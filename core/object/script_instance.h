@@ -0,0 +1,91 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SCRIPT_INSTANCE_H
+#define SCRIPT_INSTANCE_H
+
+#include <string>
+#include <unordered_map>
+
+#include <thirdparty/lua/lua.hpp>
+
+#include "core/error/error_list.h"
+#include "core/templates/object_id.h"
+
+class Object;
+class Script;
+
+/**
+ * @class ScriptInstance
+ * @brief The Lua side of one object with a script attached.
+ *
+ * Each instance is a Lua table whose metatable indexes the script's class
+ * table, held in the registry by reference. Methods are looked up once and
+ * kept as registry refs too, so a call is a rawgeti and a pcall with no
+ * string lookup. Created and freed through Script::instance_create() and
+ * Script::instance_free().
+ */
+class ScriptInstance {
+public:
+    Object* get_owner() const;
+    ObjectID get_owner_id() const { return owner_id; }
+    Script* get_script() const { return script; }
+    int get_self_ref() const { return self_ref; }
+
+    bool has_method(const std::string& p_method);
+
+    /**
+     * Call p_method(self) on the instance. The function ref is resolved on
+     * the first call and cached.
+     * @return OK, ERR_METHOD_NOT_FOUND, or ERR_SCRIPT_FAILED if the Lua call raised.
+     */
+    Error call(const std::string& p_method);
+
+    // Instances with processing disabled are skipped by the per-frame batches.
+    void set_process(bool p_enable) { process = p_enable; }
+    bool is_processing() const { return process; }
+    void set_physics_process(bool p_enable) { physics_process = p_enable; }
+    bool is_physics_processing() const { return physics_process; }
+
+private:
+    ScriptInstance(Script* p_script, Object* p_owner);
+    ~ScriptInstance();
+
+    int _get_method_ref(const std::string& p_method);
+    void _create_self();
+    // Called by Script::compile() after the script moved to a new state.
+    void _rebind(lua_State* p_old_state);
+
+    Script* script = nullptr;
+    size_t index = 0; ///< Slot in the script's instance array.
+    ObjectID owner_id;
+    int self_ref = LUA_NOREF;
+    // LUA_REFNIL caches a miss so absent methods are not looked up again.
+    std::unordered_map<std::string, int> method_refs;
+    bool process = true;
+    bool physics_process = true;
+
+    friend class Script;
+};
+
+#endif // SCRIPT_INSTANCE_H
@@ -1,20 +1,284 @@
 #include "undo_redo.h"
 
+#include <algorithm>
+#include <cstring>
 
 
+UndoRedo::UndoRedo() {}
 
+UndoRedo::~UndoRedo() {}
 
+UndoRedo& UndoRedo::get_singleton() {
+  static UndoRedo singleton;
+  return singleton;
+}
 
+size_t UndoRedo::_action_overhead(const Action& action) {
+  return sizeof(Action) + action.name.capacity();
+}
 
+void UndoRedo::add_action(const std::function<void()>& doAction, const std::function<void()>& undoAction) {
+  add_action(std::string(), doAction, undoAction);
+}
 
+void UndoRedo::add_action(const std::string& name, const std::function<void()>& doAction, const std::function<void()>& undoAction,
+                          MergeMode mergeMode, uint64_t mergeKey, size_t memoryHint) {
+  Action action;
+  action.name = name;
+  action.doAction = doAction;
+  action.undoAction = undoAction;
+  action.mergeMode = mergeMode;
+  action.mergeKey = mergeKey;
+  action.memory = memoryHint;
+  _push(std::move(action), nullptr);
+}
 
+void UndoRedo::_push(Action&& action, const void* mergeValue) {
+  _clear_redo();
 
-void UndoRedo::_bind_methods() {
-  Object::bind_method("add_action", &UndoRedo::add_action);
-  Object::bind_method("undo", &UndoRedo::undo);
+  if (!mergeBroken && action.mergeMode == MERGE_ENDS && action.mergeKey != 0 && !undoStack.empty()) {
+    Action& last = undoStack.back();
+    if (last.mergeMode == MERGE_ENDS && last.mergeKey == action.mergeKey && last.mergeObject == action.mergeObject &&
+        last.mergeProperty == action.mergeProperty && last.mergeType == action.mergeType) {
+      // Keep the oldest undo, take the newest do.
+      if (mergeValue && last.mergeValue) {
+        last.mergeValue(mergeValue);
+      } else {
+        undoBytes -= last.memory;
+        last.doAction = std::move(action.doAction);
+        last.memory = std::max(last.memory, action.memory);
+        undoBytes += last.memory;
+      }
+      merged++;
+      return;
+    }
+  }
+
+  action.memory += _action_overhead(action);
+  undoBytes += action.memory;
+  undoStack.push_back(std::move(action));
+  mergeBroken = false;
+  _enforce_limits();
 }
 
+void UndoRedo::add_snapshot_action(const std::string& name, const std::vector<uint8_t>& before, const std::vector<uint8_t>& after,
+                                   const std::function<std::vector<uint8_t>()>& capture,
+                                   const std::function<void(const std::vector<uint8_t>&)>& apply) {
+  // The same delta maps after -> before and before -> after.
+  std::shared_ptr<std::vector<uint8_t>> delta = std::make_shared<std::vector<uint8_t>>(encode_delta(before, after));
+  delta->shrink_to_fit();
 
+  Action action;
+  action.name = name;
+  action.doAction = [delta, capture, apply]() {
+    std::vector<uint8_t> state = capture();
+    apply_delta(state, *delta);
+    apply(state);
+  };
+  action.undoAction = action.doAction;
+  action.memory = delta->capacity();
+  _push(std::move(action), nullptr);
+}
+
+void UndoRedo::break_merge() {
+  mergeBroken = true;
+}
 
+void UndoRedo::undo() {
+  if (undoStack.empty()) {
+    return;
+  }
+  Action action = std::move(undoStack.back());
+  undoStack.pop_back();
+  undoBytes -= action.memory;
+  if (action.undoAction) {
+    action.undoAction();
+  }
+  redoBytes += action.memory;
+  redoStack.push_back(std::move(action));
+  mergeBroken = true;
+}
 
+void UndoRedo::redo() {
+  if (redoStack.empty()) {
+    return;
+  }
+  Action action = std::move(redoStack.back());
+  redoStack.pop_back();
+  redoBytes -= action.memory;
+  if (action.doAction) {
+    action.doAction();
+  }
+  undoBytes += action.memory;
+  undoStack.push_back(std::move(action));
+  mergeBroken = true;
+}
+
+bool UndoRedo::has_undo() const {
+  return !undoStack.empty();
+}
 
+bool UndoRedo::has_redo() const {
+  return !redoStack.empty();
+}
+
+void UndoRedo::_clear_redo() {
+  redoStack.clear();
+  redoBytes = 0;
+}
+
+void UndoRedo::clear_history() {
+  undoStack.clear();
+  _clear_redo();
+  undoBytes = 0;
+  mergeBroken = true;
+}
+
+void UndoRedo::_enforce_limits() {
+  // Always keep the newest step, even if it alone exceeds the cap.
+  while (undoStack.size() > 1 &&
+         ((maxBytes && undoBytes + redoBytes > maxBytes) || (maxSteps && undoStack.size() > maxSteps))) {
+    undoBytes -= undoStack.front().memory;
+    undoStack.pop_front();
+    evicted++;
+  }
+}
+
+void UndoRedo::set_max_memory(size_t bytes) {
+  maxBytes = bytes;
+  _enforce_limits();
+}
+
+size_t UndoRedo::get_max_memory() const {
+  return maxBytes;
+}
+
+void UndoRedo::set_max_steps(size_t steps) {
+  maxSteps = steps;
+  _enforce_limits();
+}
+
+size_t UndoRedo::get_max_steps() const {
+  return maxSteps;
+}
+
+UndoRedo::MemoryStats UndoRedo::get_memory_stats() const {
+  MemoryStats stats;
+  stats.undoBytes = undoBytes;
+  stats.redoBytes = redoBytes;
+  stats.maxBytes = maxBytes;
+  stats.evicted = evicted;
+  stats.merged = merged;
+  return stats;
+}
+
+// Delta format: [u32 size A][u32 size B] then runs over max(A, B) bytes of
+// A ^ B (missing bytes read as zero):
+//   0x00 len  -> len unchanged bytes
+//   0x01 len bytes[len] -> len changed bytes, XORed in
+// where len is a LEB128 varint.
+static void _write_varint(std::vector<uint8_t>& out, size_t v) {
+  while (v >= 0x80) {
+    out.push_back(static_cast<uint8_t>(v | 0x80));
+    v >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(v));
+}
+
+static size_t _read_varint(const std::vector<uint8_t>& in, size_t& pos) {
+  size_t v = 0;
+  int shift = 0;
+  while (pos < in.size() && shift < 64) {
+    uint8_t b = in[pos++];
+    v |= size_t(b & 0x7F) << shift;
+    if (!(b & 0x80)) {
+      break;
+    }
+    shift += 7;
+  }
+  return v;
+}
+
+static void _write_u32(std::vector<uint8_t>& out, uint32_t v) {
+  for (int i = 0; i < 4; i++) {
+    out.push_back(static_cast<uint8_t>(v >> (i * 8)));
+  }
+}
+
+static uint32_t _read_u32(const uint8_t* p) {
+  return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+std::vector<uint8_t> UndoRedo::encode_delta(const std::vector<uint8_t>& from, const std::vector<uint8_t>& to) {
+  std::vector<uint8_t> out;
+  _write_u32(out, static_cast<uint32_t>(from.size()));
+  _write_u32(out, static_cast<uint32_t>(to.size()));
+
+  const size_t len = std::max(from.size(), to.size());
+  auto xor_at = [&](size_t i) -> uint8_t {
+    uint8_t a = i < from.size() ? from[i] : 0;
+    uint8_t b = i < to.size() ? to[i] : 0;
+    return a ^ b;
+  };
+
+  size_t i = 0;
+  while (i < len) {
+    size_t run = 0;
+    if (xor_at(i) == 0) {
+      while (i + run < len && xor_at(i + run) == 0) {
+        run++;
+      }
+      out.push_back(0x00);
+      _write_varint(out, run);
+    } else {
+      // Literal run; stop at the first pair of zero bytes worth encoding as a run.
+      while (i + run < len && !(xor_at(i + run) == 0 && i + run + 1 < len && xor_at(i + run + 1) == 0)) {
+        run++;
+      }
+      out.push_back(0x01);
+      _write_varint(out, run);
+      for (size_t k = 0; k < run; k++) {
+        out.push_back(xor_at(i + k));
+      }
+    }
+    i += run;
+  }
+  return out;
+}
+
+void UndoRedo::apply_delta(std::vector<uint8_t>& data, const std::vector<uint8_t>& delta) {
+  if (delta.size() < 8) {
+    return;
+  }
+  const uint32_t sizeA = _read_u32(delta.data());
+  const uint32_t sizeB = _read_u32(delta.data() + 4);
+  // data is one side of the pair; the result is the other one.
+  const uint32_t target = data.size() == sizeA ? sizeB : sizeA;
+  data.resize(std::max(sizeA, sizeB), 0);
+
+  size_t pos = 0;
+  size_t i = 8;
+  while (i < delta.size()) {
+    uint8_t op = delta[i++];
+    size_t run = _read_varint(delta, i);
+    if (op == 0x01) {
+      for (size_t k = 0; k < run && i + k < delta.size() && pos + k < data.size(); k++) {
+        data[pos + k] ^= delta[i + k];
+      }
+      i += run;
+    }
+    pos += run;
+  }
+  data.resize(target);
+}
+
+
+void UndoRedo::_bind_methods() {
+  Object::bind_method("add_action", static_cast<void (UndoRedo::*)(const std::function<void()>&, const std::function<void()>&)>(&UndoRedo::add_action));
+  Object::bind_method("undo", &UndoRedo::undo);
+}
+
+void UndoRedo::_bind_properties(PropertyTable& p_table) {
+  MPROPERTY_ACCESSOR(p_table, UndoRedo, size_t, "max_memory", get_max_memory, set_max_memory);
+  MPROPERTY_ACCESSOR(p_table, UndoRedo, size_t, "max_steps", get_max_steps, set_max_steps);
+}
@@ -4,6 +4,11 @@
 
 #include "core/typedefs.h"
 #include "core/object/m_object.h"
+#include "core/object/object_db.h"
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
 #include <vector>
 #include <functional>
 
@@ -12,34 +17,162 @@ class UndoRedo : public Object {
   CLASS(UndoRedo , Object);
 
 public:
+    enum MergeMode {
+        MERGE_DISABLE, // Every action is its own history step
+        MERGE_ENDS,    // Consecutive actions with the same merge key keep the first undo and the last do
+    };
+
+    struct MemoryStats {
+        size_t undoBytes = 0;
+        size_t redoBytes = 0;
+        size_t maxBytes = 0;
+        uint64_t evicted = 0;  // Actions dropped by the memory cap or step limit
+        uint64_t merged = 0;   // Actions coalesced into the previous one
+    };
+
     UndoRedo();
     ~UndoRedo();
 
     // Push a new action onto the undo stack
     void add_action(const std::function<void()>& doAction, const std::function<void()>& undoAction);
 
+    // Push a named action. Actions with the same non-zero mergeKey pushed
+    // back to back are coalesced when mergeMode is MERGE_ENDS. memoryHint is
+    // the size of whatever the closures captured, for the memory cap.
+    void add_action(const std::string& name, const std::function<void()>& doAction, const std::function<void()>& undoAction,
+                    MergeMode mergeMode = MERGE_DISABLE, uint64_t mergeKey = 0, size_t memoryHint = 0);
+
+    // Record a property edit through the class property table. Dragging a
+    // sprite pushes one of these per frame; with MERGE_ENDS they collapse
+    // into a single step holding the value before the drag and the last one.
+    template <typename T>
+    void add_property_action(Object* object, int propertyIndex, const T& oldValue, const T& newValue,
+                             MergeMode mergeMode = MERGE_ENDS);
+
+    // Record an edit of a large resource as a compressed delta instead of
+    // two full copies. capture() must return the current serialized state
+    // and apply() restore one; the delta is XOR + run-length encoded, so a
+    // local change in a big buffer costs a few bytes.
+    void add_snapshot_action(const std::string& name, const std::vector<uint8_t>& before, const std::vector<uint8_t>& after,
+                             const std::function<std::vector<uint8_t>()>& capture,
+                             const std::function<void(const std::vector<uint8_t>&)>& apply);
+
+    // Stop coalescing: the next action starts a new step even if its merge
+    // key matches. Call it when a drag or a slider edit ends.
+    void break_merge();
+
     // Perform undo operation
     void undo();
 
     // Perform redo operation
     void redo();
 
+    bool has_undo() const;
+    bool has_redo() const;
+    void clear_history();
+
+    // Oldest actions are evicted first once either limit is exceeded. 0 disables the limit.
+    void set_max_memory(size_t bytes);
+    size_t get_max_memory() const;
+    void set_max_steps(size_t steps);
+    size_t get_max_steps() const;
+    MemoryStats get_memory_stats() const;
+
+    // Delta helpers, exposed for resource savers that keep their own history.
+    static std::vector<uint8_t> encode_delta(const std::vector<uint8_t>& from, const std::vector<uint8_t>& to);
+    static void apply_delta(std::vector<uint8_t>& data, const std::vector<uint8_t>& delta);
+
     // Get the singleton instance of UndoRedo
     static UndoRedo& get_singleton();
 private:
     struct Action {
+        std::string name;
         std::function<void()> doAction;
         std::function<void()> undoAction;
+        // Replaces the do-value of a coalesced property edit.
+        std::function<void(const void*)> mergeValue;
+        MergeMode mergeMode = MERGE_DISABLE;
+        uint64_t mergeKey = 0;
+        // Property edits merge only into an edit of the same object, slot and
+        // value type; the key alone can collide and mergeValue casts blindly.
+        ObjectID mergeObject;
+        int mergeProperty = -1;
+        const void* mergeType = nullptr;
+        size_t memory = 0;
     };
 
-    std::vector<Action> undoStack;
-    std::vector<Action> redoStack;
+    // One address per value type, compared to tell PropertyEdit<T>s apart.
+    template <typename T>
+    static const void* _type_tag() {
+        static const char tag = 0;
+        return &tag;
+    }
+
+    template <typename T>
+    struct PropertyEdit {
+        ObjectID object;
+        int property;
+        T oldValue;
+        T newValue;
+    };
+
+    void _push(Action&& action, const void* mergeValue);
+    void _clear_redo();
+    void _enforce_limits();
+    static size_t _action_overhead(const Action& action);
+
+    std::deque<Action> undoStack;
+    std::deque<Action> redoStack;
+
+    size_t undoBytes = 0;
+    size_t redoBytes = 0;
+    size_t maxBytes = 0;
+    size_t maxSteps = 0;
+    uint64_t evicted = 0;
+    uint64_t merged = 0;
+    bool mergeBroken = true;
 
 protected:
     void _bind_method() {}
+
+public:
+    // History limits, exposed as properties so the editor settings and
+    // config files can drive them by index.
+    static void _bind_properties(PropertyTable& p_table);
 };
 
+template <typename T>
+void UndoRedo::add_property_action(Object* object, int propertyIndex, const T& oldValue, const T& newValue, MergeMode mergeMode) {
+    if (!object || !object->_get_property_table().is_valid_index(propertyIndex)) {
+        return;
+    }
+    std::shared_ptr<PropertyEdit<T>> edit = std::make_shared<PropertyEdit<T>>(PropertyEdit<T>{ object->get_instance_id(), propertyIndex, oldValue, newValue });
 
+    Action action;
+    action.name = object->_get_property_table().get_info(propertyIndex).name;
+    action.doAction = [edit]() {
+        if (Object* obj = ObjectDB::get_instance(edit->object)) {
+            obj->set_property_value<T>(edit->property, edit->newValue);
+        }
+    };
+    action.undoAction = [edit]() {
+        if (Object* obj = ObjectDB::get_instance(edit->object)) {
+            obj->set_property_value<T>(edit->property, edit->oldValue);
+        }
+    };
+    action.mergeValue = [edit](const void* value) {
+        edit->newValue = *static_cast<const T*>(value);
+    };
+    action.mergeMode = mergeMode;
+    // Object and property identify the edit; the slot index fits in the low bits.
+    action.mergeKey = (static_cast<uint64_t>(edit->object) * 0x9E3779B97F4A7C15ull) ^ static_cast<uint64_t>(propertyIndex + 1);
+    action.mergeObject = edit->object;
+    action.mergeProperty = propertyIndex;
+    action.mergeType = _type_tag<T>();
+    action.memory = sizeof(PropertyEdit<T>);
+    _push(std::move(action), &newValue);
+}
 
 
 
+#endif // UNDO_REDO_H
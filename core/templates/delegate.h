@@ -0,0 +1,204 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef DELEGATE_H
+#define DELEGATE_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+template <typename Signature, size_t InlineSize = 6 * sizeof(void*)>
+class Delegate;
+
+/**
+ * @brief Type-erased callable with a small inline buffer.
+ *
+ * Member function bindings and lambdas capturing a few pointers or values
+ * are stored inline, so connecting a slot or queueing a call does not touch
+ * the heap. Larger callables fall back to a heap allocation.
+ * @tparam R Return type.
+ * @tparam Args Argument types.
+ * @tparam InlineSize Bytes of inline storage.
+ */
+template <typename R, typename... Args, size_t InlineSize>
+class Delegate<R(Args...), InlineSize> {
+private:
+    enum Op {
+        OP_COPY,
+        OP_MOVE,
+        OP_DESTROY
+    };
+
+    typedef R (*InvokeFunc)(void* p_storage, Args... p_args);
+    typedef void (*ManageFunc)(Op p_op, void* p_dst, void* p_src);
+
+    alignas(std::max_align_t) unsigned char storage[InlineSize]; ///< Inline callable, or a pointer to a heap one.
+    InvokeFunc invoke = nullptr;
+    ManageFunc manage = nullptr;
+
+    template <typename F>
+    static constexpr bool fits_inline() {
+        return sizeof(F) <= InlineSize && alignof(F) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible<F>::value;
+    }
+
+    template <typename F>
+    static F* _get(void* p_storage) {
+        if constexpr (fits_inline<F>()) {
+            return std::launder(reinterpret_cast<F*>(p_storage));
+        } else {
+            return *reinterpret_cast<F**>(p_storage);
+        }
+    }
+
+    template <typename F>
+    static R _invoke(void* p_storage, Args... p_args) {
+        return (*_get<F>(p_storage))(std::forward<Args>(p_args)...);
+    }
+
+    template <typename F>
+    static void _manage(Op p_op, void* p_dst, void* p_src) {
+        if constexpr (fits_inline<F>()) {
+            switch (p_op) {
+                case OP_COPY:
+                    new (p_dst) F(*_get<F>(p_src));
+                    break;
+                case OP_MOVE:
+                    new (p_dst) F(std::move(*_get<F>(p_src)));
+                    _get<F>(p_src)->~F();
+                    break;
+                case OP_DESTROY:
+                    _get<F>(p_dst)->~F();
+                    break;
+            }
+        } else {
+            switch (p_op) {
+                case OP_COPY:
+                    *reinterpret_cast<F**>(p_dst) = new F(*_get<F>(p_src));
+                    break;
+                case OP_MOVE:
+                    *reinterpret_cast<F**>(p_dst) = _get<F>(p_src);
+                    break;
+                case OP_DESTROY:
+                    delete _get<F>(p_dst);
+                    break;
+            }
+        }
+    }
+
+    template <typename C, R (C::*Method)(Args...)>
+    struct MethodBind {
+        C* instance;
+        R operator()(Args... p_args) const { return (instance->*Method)(std::forward<Args>(p_args)...); }
+    };
+
+public:
+    Delegate() {}
+    Delegate(std::nullptr_t) {}
+
+    template <typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, Delegate>::value>::type>
+    Delegate(F&& p_func) {
+        typedef typename std::decay<F>::type Func;
+        if constexpr (fits_inline<Func>()) {
+            new (storage) Func(std::forward<F>(p_func));
+        } else {
+            *reinterpret_cast<Func**>(storage) = new Func(std::forward<F>(p_func));
+        }
+        invoke = &_invoke<Func>;
+        manage = &_manage<Func>;
+    }
+
+    Delegate(const Delegate& p_other) {
+        if (p_other.manage) {
+            p_other.manage(OP_COPY, storage, const_cast<unsigned char*>(p_other.storage));
+            invoke = p_other.invoke;
+            manage = p_other.manage;
+        }
+    }
+
+    Delegate(Delegate&& p_other) noexcept {
+        if (p_other.manage) {
+            p_other.manage(OP_MOVE, storage, p_other.storage);
+            invoke = p_other.invoke;
+            manage = p_other.manage;
+            p_other.invoke = nullptr;
+            p_other.manage = nullptr;
+        }
+    }
+
+    ~Delegate() {
+        reset();
+    }
+
+    Delegate& operator=(const Delegate& p_other) {
+        if (this != &p_other) {
+            Delegate tmp(p_other);
+            *this = std::move(tmp);
+        }
+        return *this;
+    }
+
+    Delegate& operator=(Delegate&& p_other) noexcept {
+        if (this != &p_other) {
+            reset();
+            if (p_other.manage) {
+                p_other.manage(OP_MOVE, storage, p_other.storage);
+                invoke = p_other.invoke;
+                manage = p_other.manage;
+                p_other.invoke = nullptr;
+                p_other.manage = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Bind a member function of @p p_instance. Always stored inline.
+     */
+    template <typename C, R (C::*Method)(Args...)>
+    static Delegate bind(C* p_instance) {
+        return Delegate(MethodBind<C, Method>{ p_instance });
+    }
+
+    void reset() {
+        if (manage) {
+            manage(OP_DESTROY, storage, nullptr);
+            invoke = nullptr;
+            manage = nullptr;
+        }
+    }
+
+    /** @brief Call the bound callable. An empty delegate does nothing and returns R(). */
+    R operator()(Args... p_args) const {
+        if (!invoke) {
+            return R();
+        }
+        return invoke(const_cast<unsigned char*>(storage), std::forward<Args>(p_args)...);
+    }
+
+    explicit operator bool() const { return invoke != nullptr; }
+    bool is_valid() const { return invoke != nullptr; }
+};
+
+#endif // DELEGATE_H
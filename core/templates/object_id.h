@@ -0,0 +1,54 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef OBJECT_ID_H
+#define OBJECT_ID_H
+
+#include <cstdint>
+
+/**
+ * @brief Weak handle to an Object registered in ObjectDB.
+ *
+ * The low 32 bits are the ObjectDB slot, the high 32 bits its generation, so
+ * an ID of a freed object never resolves to whatever reuses its slot.
+ */
+class ObjectID {
+    uint64_t id = 0;
+
+public:
+    ObjectID() {}
+    explicit ObjectID(uint64_t p_id) : id(p_id) {}
+
+    inline bool is_valid() const { return id != 0; }
+    inline bool is_null() const { return id == 0; }
+    inline operator uint64_t() const { return id; }
+
+    inline uint32_t get_slot() const { return static_cast<uint32_t>(id & 0xFFFFFFFFu); }
+    inline uint32_t get_generation() const { return static_cast<uint32_t>(id >> 32); }
+
+    inline bool operator==(const ObjectID& p_id) const { return id == p_id.id; }
+    inline bool operator!=(const ObjectID& p_id) const { return id != p_id.id; }
+    inline bool operator<(const ObjectID& p_id) const { return id < p_id.id; }
+};
+
+#endif // OBJECT_ID_H
@@ -0,0 +1,72 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SPAN_H
+#define SPAN_H
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Non-owning view of a contiguous range, until the engine moves to
+ * C++20 and std::span.
+ *
+ * Span<const uint8_t> is what file and network APIs hand out for data they
+ * do not copy, a memory-mapped file for instance. The view is only valid
+ * while its owner keeps the memory alive.
+ */
+template <typename T>
+class Span {
+    T* ptr = nullptr;
+    size_t len = 0;
+
+public:
+    constexpr Span() {}
+    constexpr Span(T* p_ptr, size_t p_len) : ptr(p_ptr), len(p_len) {}
+    template <size_t N>
+    constexpr Span(T (&p_array)[N]) : ptr(p_array), len(N) {}
+    Span(std::vector<typename std::remove_const<T>::type>& p_vector) : ptr(p_vector.data()), len(p_vector.size()) {}
+    template <typename U = T, typename = typename std::enable_if<std::is_const<U>::value>::type>
+    Span(const std::vector<typename std::remove_const<T>::type>& p_vector) : ptr(p_vector.data()), len(p_vector.size()) {}
+
+    constexpr operator Span<const T>() const { return Span<const T>(ptr, len); }
+
+    constexpr T* data() const { return ptr; }
+    constexpr size_t size() const { return len; }
+    constexpr bool is_empty() const { return len == 0; }
+
+    constexpr T& operator[](size_t p_index) const { return ptr[p_index]; }
+    constexpr T* begin() const { return ptr; }
+    constexpr T* end() const { return ptr + len; }
+
+    /** @brief View of p_count elements from p_offset, clamped to this span. */
+    constexpr Span<T> subspan(size_t p_offset, size_t p_count = size_t(-1)) const {
+        if (p_offset > len) {
+            return Span<T>();
+        }
+        return Span<T>(ptr + p_offset, p_count < len - p_offset ? p_count : len - p_offset);
+    }
+};
+
+#endif // SPAN_H
@@ -0,0 +1,324 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef ARRAY_H
+#define ARRAY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "core/math/color.h"
+#include "core/math/vector2.h"
+
+/**
+ * @class PackedArray
+ * @brief Contiguous array of plain values with copy-on-write sharing.
+ *
+ * Elements are stored unboxed in one buffer. ptr() can be handed straight
+ * to a mesh upload, a physics polygon or the binary serializer.
+ *
+ * - Copies share the buffer until one side writes (copy-on-write).
+ * - slice() returns a view into the same buffer instead of copying. The
+ *   first write to a slice copies just its range.
+ * - fill(), append_array() and the (pointer, count) constructor work on
+ *   the whole range at once.
+ *
+ * Pointers from ptr() are invalidated by any write, to this array or to a
+ * copy that still shares the buffer with it.
+ */
+template <typename T>
+class PackedArray {
+public:
+    PackedArray() {}
+    PackedArray(std::initializer_list<T> p_values);
+    PackedArray(const T* p_data, size_t p_count);
+    explicit PackedArray(size_t p_count, const T& p_value = T());
+
+    size_t size() const { return count; }
+    bool is_empty() const { return count == 0; }
+    /** @brief True while another array or slice shares the buffer. */
+    bool is_shared() const { return storage && storage.use_count() > 1; }
+
+    const T* ptr() const { return storage ? storage->data() + offset : nullptr; }
+    /** @brief Writable pointer; unshares the buffer first. */
+    T* ptrw();
+
+    const T* begin() const { return ptr(); }
+    const T* end() const { return ptr() + count; }
+
+    /** @brief Unchecked read, for hot loops. */
+    const T& operator[](size_t p_index) const { return ptr()[p_index]; }
+    const T& get(size_t p_index) const;
+    void set(size_t p_index, const T& p_value);
+
+    void push_back(const T& p_value);
+    void append(const T& p_value) { push_back(p_value); }
+    void append_array(const PackedArray<T>& p_other);
+    void append_array(const T* p_data, size_t p_count);
+    void insert(size_t p_index, const T& p_value);
+    void remove_at(size_t p_index);
+    void resize(size_t p_count);
+    void clear();
+
+    void fill(const T& p_value);
+    void reverse();
+
+    /**
+     * View of [p_begin, p_end). Negative indices count from the end, as in
+     * scripts. The result shares this array's buffer.
+     */
+    PackedArray<T> slice(int64_t p_begin, int64_t p_end = INT64_MAX) const;
+    /** @brief Compact, unshared copy. */
+    PackedArray<T> duplicate() const;
+
+    int64_t find(const T& p_value, size_t p_from = 0) const;
+    bool has(const T& p_value) const { return find(p_value) >= 0; }
+
+    bool operator==(const PackedArray<T>& p_other) const;
+    bool operator!=(const PackedArray<T>& p_other) const { return !(*this == p_other); }
+
+private:
+    // Make the buffer owned by this array alone and exactly [0, count).
+    std::vector<T>& _write();
+
+    std::shared_ptr<std::vector<T>> storage;
+    size_t offset = 0;
+    size_t count = 0;
+};
+
+typedef PackedArray<uint8_t> PackedByteArray;
+typedef PackedArray<int32_t> PackedInt32Array;
+typedef PackedArray<int64_t> PackedInt64Array;
+typedef PackedArray<float> PackedFloat32Array;
+typedef PackedArray<double> PackedFloat64Array;
+typedef PackedArray<Vector2> PackedVector2Array;
+typedef PackedArray<Color> PackedColorArray;
+
+
+template <typename T>
+PackedArray<T>::PackedArray(std::initializer_list<T> p_values) :
+        PackedArray(p_values.begin(), p_values.size()) {}
+
+template <typename T>
+PackedArray<T>::PackedArray(const T* p_data, size_t p_count) {
+    if (p_count) {
+        storage = std::make_shared<std::vector<T>>(p_data, p_data + p_count);
+        count = p_count;
+    }
+}
+
+template <typename T>
+PackedArray<T>::PackedArray(size_t p_count, const T& p_value) {
+    if (p_count) {
+        storage = std::make_shared<std::vector<T>>(p_count, p_value);
+        count = p_count;
+    }
+}
+
+template <typename T>
+std::vector<T>& PackedArray<T>::_write() {
+    if (!storage) {
+        storage = std::make_shared<std::vector<T>>();
+    } else if (storage.use_count() > 1) {
+        storage = std::make_shared<std::vector<T>>(storage->begin() + offset, storage->begin() + offset + count);
+    } else if (offset != 0 || count != storage->size()) {
+        // Last owner of a slice: trim the buffer in place.
+        storage->resize(offset + count);
+        storage->erase(storage->begin(), storage->begin() + offset);
+    }
+    offset = 0;
+    return *storage;
+}
+
+template <typename T>
+T* PackedArray<T>::ptrw() {
+    return count ? _write().data() : nullptr;
+}
+
+template <typename T>
+const T& PackedArray<T>::get(size_t p_index) const {
+    if (p_index >= count) {
+        throw std::out_of_range("PackedArray index out of range.");
+    }
+    return ptr()[p_index];
+}
+
+template <typename T>
+void PackedArray<T>::set(size_t p_index, const T& p_value) {
+    if (p_index >= count) {
+        throw std::out_of_range("PackedArray index out of range.");
+    }
+    _write()[p_index] = p_value;
+}
+
+template <typename T>
+void PackedArray<T>::push_back(const T& p_value) {
+    // p_value may point into our own buffer.
+    T value = p_value;
+    _write().push_back(value);
+    count++;
+}
+
+template <typename T>
+void PackedArray<T>::append_array(const PackedArray<T>& p_other) {
+    // Holding a reference keeps the source alive and makes a self-append
+    // copy our buffer before writing to it.
+    PackedArray<T> source = p_other;
+    append_array(source.ptr(), source.count);
+}
+
+template <typename T>
+void PackedArray<T>::append_array(const T* p_data, size_t p_count) {
+    if (!p_count) {
+        return;
+    }
+    std::vector<T>& data = _write();
+    if (p_data >= data.data() && p_data < data.data() + data.size()) {
+        std::vector<T> copy(p_data, p_data + p_count);
+        data.insert(data.end(), copy.begin(), copy.end());
+    } else {
+        data.insert(data.end(), p_data, p_data + p_count);
+    }
+    count += p_count;
+}
+
+template <typename T>
+void PackedArray<T>::insert(size_t p_index, const T& p_value) {
+    if (p_index > count) {
+        throw std::out_of_range("PackedArray insert position out of range.");
+    }
+    T value = p_value;
+    std::vector<T>& data = _write();
+    data.insert(data.begin() + p_index, value);
+    count++;
+}
+
+template <typename T>
+void PackedArray<T>::remove_at(size_t p_index) {
+    if (p_index >= count) {
+        throw std::out_of_range("PackedArray index out of range.");
+    }
+    std::vector<T>& data = _write();
+    data.erase(data.begin() + p_index);
+    count--;
+}
+
+template <typename T>
+void PackedArray<T>::resize(size_t p_count) {
+    if (p_count == count) {
+        return;
+    }
+    if (p_count < count && storage.use_count() > 1) {
+        // Shrinking a shared buffer only narrows the view.
+        count = p_count;
+        return;
+    }
+    _write().resize(p_count);
+    count = p_count;
+}
+
+template <typename T>
+void PackedArray<T>::clear() {
+    storage.reset();
+    offset = 0;
+    count = 0;
+}
+
+template <typename T>
+void PackedArray<T>::fill(const T& p_value) {
+    if (!count) {
+        return;
+    }
+    if (storage.use_count() > 1) {
+        // Everything is overwritten, no need to copy the old contents.
+        storage = std::make_shared<std::vector<T>>(count, p_value);
+        offset = 0;
+        return;
+    }
+    T value = p_value;
+    std::vector<T>& data = _write();
+    std::fill(data.begin(), data.end(), value);
+}
+
+template <typename T>
+void PackedArray<T>::reverse() {
+    if (count > 1) {
+        std::vector<T>& data = _write();
+        std::reverse(data.begin(), data.end());
+    }
+}
+
+template <typename T>
+PackedArray<T> PackedArray<T>::slice(int64_t p_begin, int64_t p_end) const {
+    const int64_t size = static_cast<int64_t>(count);
+    if (p_begin < 0) {
+        p_begin = std::max<int64_t>(size + p_begin, 0);
+    }
+    if (p_end < 0) {
+        p_end = std::max<int64_t>(size + p_end, 0);
+    }
+    p_begin = std::min(p_begin, size);
+    p_end = std::min(p_end, size);
+
+    PackedArray<T> result;
+    if (p_end > p_begin) {
+        result.storage = storage;
+        result.offset = offset + static_cast<size_t>(p_begin);
+        result.count = static_cast<size_t>(p_end - p_begin);
+    }
+    return result;
+}
+
+template <typename T>
+PackedArray<T> PackedArray<T>::duplicate() const {
+    return PackedArray<T>(ptr(), count);
+}
+
+template <typename T>
+int64_t PackedArray<T>::find(const T& p_value, size_t p_from) const {
+    const T* data = ptr();
+    for (size_t i = p_from; i < count; i++) {
+        if (data[i] == p_value) {
+            return static_cast<int64_t>(i);
+        }
+    }
+    return -1;
+}
+
+template <typename T>
+bool PackedArray<T>::operator==(const PackedArray<T>& p_other) const {
+    if (count != p_other.count) {
+        return false;
+    }
+    if (ptr() == p_other.ptr()) {
+        return true;
+    }
+    return std::equal(begin(), end(), p_other.begin());
+}
+
+#endif // ARRAY_H
@@ -0,0 +1,185 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "callable.h"
+
+#include <cstdlib>
+
+#include "core/error/error_macros.h"
+
+
+Callable::Invoker Callable::invokers[Callable::MAX_METHODS];
+std::atomic<uint32_t> Callable::invoker_count{ 1 }; // 0 is never a valid method.
+
+Callable::MethodID Callable::_register_invoker(const Invoker& p_invoker) {
+    uint32_t id = invoker_count.fetch_add(1, std::memory_order_relaxed);
+    if (id >= MAX_METHODS) {
+        ERR_PRINT("Too many Callable method bindings, increase Callable::MAX_METHODS.");
+        abort();
+    }
+    invokers[id] = p_invoker;
+    return id;
+}
+
+Callable::Callable(const Callable& p_other) {
+    _copy_from(p_other);
+}
+
+Callable::Callable(Callable&& p_other) noexcept {
+    // Variants are relocatable: move the bytes and forget the source.
+    memcpy(static_cast<void*>(this), static_cast<const void*>(&p_other), sizeof(Callable));
+    p_other.bound_count = 0;
+    p_other.kind = KIND_NULL;
+}
+
+Callable& Callable::operator=(const Callable& p_other) {
+    if (this != &p_other) {
+        _clear_bound();
+        _copy_from(p_other);
+    }
+    return *this;
+}
+
+Callable& Callable::operator=(Callable&& p_other) noexcept {
+    if (this != &p_other) {
+        _clear_bound();
+        memcpy(static_cast<void*>(this), static_cast<const void*>(&p_other), sizeof(Callable));
+        p_other.bound_count = 0;
+        p_other.kind = KIND_NULL;
+    }
+    return *this;
+}
+
+void Callable::_copy_from(const Callable& p_other) {
+    object = p_other.object;
+    method = p_other.method;
+    kind = p_other.kind;
+    bound_count = p_other.bound_count;
+    unbind_count = p_other.unbind_count;
+    memcpy(closure, p_other.closure, CLOSURE_SIZE);
+    for (int i = 0; i < bound_count; i++) {
+        new (&_bound()[i]) Variant(p_other._bound()[i]);
+    }
+}
+
+void Callable::_clear_bound() {
+    for (int i = 0; i < bound_count; i++) {
+        _bound()[i].~Variant();
+    }
+    bound_count = 0;
+}
+
+bool Callable::is_valid() const {
+    switch (kind) {
+        case KIND_METHOD:
+            return ObjectDB::get_instance(object) != nullptr;
+        case KIND_CLOSURE:
+            return object.is_null() || ObjectDB::get_instance(object) != nullptr;
+        default:
+            return false;
+    }
+}
+
+int Callable::get_argument_count() const {
+    if (kind == KIND_NULL) {
+        return 0;
+    }
+    return invokers[method].argument_count - bound_count + unbind_count;
+}
+
+Callable Callable::unbind(int p_count) const {
+    Callable result = *this;
+    result.unbind_count = static_cast<uint8_t>(unbind_count + p_count);
+    return result;
+}
+
+Error Callable::callp(const Variant** p_args, int p_count, Variant& r_return) const {
+    if (kind == KIND_NULL) {
+        return ERR_UNCONFIGURED;
+    }
+    const Invoker& invoker = invokers[method];
+    const int passed = p_count - unbind_count;
+    if (passed < 0 || passed + bound_count != invoker.argument_count || invoker.argument_count > MAX_ARGS) {
+        return ERR_INVALID_PARAMETER;
+    }
+
+    void* target;
+    if (kind == KIND_METHOD) {
+        target = ObjectDB::get_instance(object);
+        if (!target) {
+            return ERR_DOES_NOT_EXIST;
+        }
+    } else {
+        if (object.is_valid() && !ObjectDB::get_instance(object)) {
+            return ERR_DOES_NOT_EXIST;
+        }
+        target = const_cast<unsigned char*>(closure);
+    }
+
+    // Caller arguments, minus the unbound tail, then the bound ones.
+    const Variant* args[MAX_ARGS];
+    for (int i = 0; i < passed; i++) {
+        args[i] = p_args[i];
+    }
+    for (int i = 0; i < bound_count; i++) {
+        args[passed + i] = &_bound()[i];
+    }
+    invoker.call(target, args, r_return);
+    return OK;
+}
+
+bool Callable::operator==(const Callable& p_other) const {
+    if (kind != p_other.kind || method != p_other.method || object != p_other.object ||
+            bound_count != p_other.bound_count || unbind_count != p_other.unbind_count) {
+        return false;
+    }
+    if (kind == KIND_CLOSURE && !invokers[method].equal(closure, p_other.closure)) {
+        return false;
+    }
+    for (int i = 0; i < bound_count; i++) {
+        if (_bound()[i] != p_other._bound()[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static inline uint64_t _mix(uint64_t p_hash, uint64_t p_value) {
+    p_hash ^= p_value + 0x9E3779B97F4A7C15ull + (p_hash << 6) + (p_hash >> 2);
+    return p_hash;
+}
+
+size_t Callable::hash() const {
+    // Bound values are left out: equal callables still hash equal, and
+    // hashing stays a handful of integer ops.
+    uint64_t h = _mix(uint64_t(object), method);
+    h = _mix(h, uint64_t(kind) | (uint64_t(bound_count) << 8) | (uint64_t(unbind_count) << 16));
+    if (kind == KIND_CLOSURE && invokers[method].hash_closure) {
+        for (size_t i = 0; i < CLOSURE_SIZE; i += 8) {
+            uint64_t word;
+            memcpy(&word, closure + i, 8);
+            h = _mix(h, word);
+        }
+    }
+    return static_cast<size_t>(h);
+}
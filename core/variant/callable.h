@@ -0,0 +1,322 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef CALLABLE_H
+#define CALLABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "core/error/error_list.h"
+#include "core/object/object_db.h"
+#include "core/templates/object_id.h"
+#include "core/variant/variant.h"
+
+class Object;
+
+/**
+ * @class Callable
+ * @brief Reference to a method of an Object, or a small closure, plus bound
+ * arguments. Never allocates.
+ *
+ *     Callable on_hit = Callable::create<&Player::take_damage>(player).bind(10);
+ *     on_hit.call();                     // player->take_damage(10)
+ *     Callable log = Callable::from_closure([](int p_code) { printf("%d\n", p_code); });
+ *
+ * A method callable stores the target's ObjectID and a process-wide method
+ * ID, so it does not keep the object alive and calling it after the object
+ * is freed fails cleanly. A closure must be trivially copyable and fit in
+ * CLOSURE_SIZE bytes. Captures are then plain values and pointers, which
+ * is what signal handlers and deferred calls need.
+ *
+ * Up to MAX_BOUND_ARGS arguments are bound inline. Two callables are equal
+ * when they target the same object and method (or hold equal closures)
+ * with equal bound arguments, so a Callable can key a connection map;
+ * std::hash is specialized below. Closures are compared with their own
+ * operator== when they have one, otherwise byte by byte, which requires
+ * captures without padding or floats.
+ */
+class Callable {
+public:
+    typedef uint32_t MethodID;
+
+    static const int MAX_BOUND_ARGS = 4;
+    static const int MAX_ARGS = 16;
+    static const size_t CLOSURE_SIZE = 32;
+
+    Callable() {}
+    Callable(const Callable& p_other);
+    Callable(Callable&& p_other) noexcept;
+    ~Callable() { _clear_bound(); }
+    Callable& operator=(const Callable& p_other);
+    Callable& operator=(Callable&& p_other) noexcept;
+
+    /** @brief Call Method on p_object. The class is deduced from Method. */
+    template <auto Method, typename C>
+    static Callable create(C* p_object);
+
+    /**
+     * Wrap a lambda or function object. p_owner, if given, must outlive
+     * the call: the closure is considered invalid once it is freed.
+     */
+    template <typename F, typename O = Object>
+    static Callable from_closure(F p_closure, const O* p_owner = nullptr);
+
+    bool is_null() const { return kind == KIND_NULL; }
+    bool is_closure() const { return kind == KIND_CLOSURE; }
+    /** @brief Not null, and the target (or closure owner) still exists. */
+    bool is_valid() const;
+
+    ObjectID get_object_id() const { return object; }
+    Object* get_object() const { return object.is_valid() ? ObjectDB::get_instance(object) : nullptr; }
+    MethodID get_method_id() const { return method; }
+    int get_bound_arguments_count() const { return bound_count; }
+    int get_unbound_arguments_count() const { return unbind_count; }
+    /** @brief Arguments the caller must pass. */
+    int get_argument_count() const;
+
+    /**
+     * Append arguments passed after the caller's. Throws std::length_error
+     * beyond MAX_BOUND_ARGS in total.
+     */
+    template <typename... Args>
+    Callable bind(Args&&... p_args) const;
+    /** @brief Drop the last p_count arguments the caller passes. */
+    Callable unbind(int p_count) const;
+
+    /**
+     * Call with p_count arguments.
+     * @return OK, ERR_UNCONFIGURED for a null callable, ERR_DOES_NOT_EXIST
+     *         if the target was freed, or ERR_INVALID_PARAMETER when the
+     *         argument count does not match.
+     */
+    Error callp(const Variant** p_args, int p_count, Variant& r_return) const;
+
+    /** @brief Convenience wrapper around callp(). Errors give a nil Variant. */
+    template <typename... Args>
+    Variant call(Args&&... p_args) const;
+
+    bool operator==(const Callable& p_other) const;
+    bool operator!=(const Callable& p_other) const { return !(*this == p_other); }
+    size_t hash() const;
+
+private:
+    enum Kind : uint8_t {
+        KIND_NULL,
+        KIND_METHOD,
+        KIND_CLOSURE,
+    };
+
+    // p_target is the Object for methods and the closure storage for closures.
+    typedef void (*CallFunc)(void* p_target, const Variant** p_args, Variant& r_return);
+
+    // Closure comparison; nullptr for methods.
+    typedef bool (*EqualFunc)(const void* p_a, const void* p_b);
+
+    struct Invoker {
+        CallFunc call;
+        int argument_count;
+        EqualFunc equal;
+        bool hash_closure; ///< The closure bytes are its value and can be hashed.
+    };
+
+    template <typename F, typename = void>
+    struct HasEqual : std::false_type {};
+
+    template <typename F>
+    struct HasEqual<F, std::void_t<decltype(std::declval<const F&>() == std::declval<const F&>())>> : std::true_type {};
+
+    template <typename M>
+    struct Signature;
+
+    template <typename C, typename R, typename... P>
+    struct Signature<R (C::*)(P...)> {
+        typedef C Class;
+        typedef R Return;
+        typedef std::tuple<P...> Params;
+    };
+
+    template <typename C, typename R, typename... P>
+    struct Signature<R (C::*)(P...) const> {
+        typedef C Class;
+        typedef R Return;
+        typedef std::tuple<P...> Params;
+    };
+
+    // Converted arguments are returned by value; Variant ones by reference.
+    template <typename T>
+    static decltype(auto) _arg(const Variant* p_arg) {
+        typedef typename std::decay<T>::type Value;
+        if constexpr (std::is_same<Value, Variant>::value) {
+            return *p_arg;
+        } else {
+            return static_cast<Value>(*p_arg);
+        }
+    }
+
+    template <typename R, typename Params, typename F, size_t... I>
+    static void _apply(F& p_func, const Variant** p_args, Variant& r_return, std::index_sequence<I...>) {
+        if constexpr (std::is_void<R>::value) {
+            p_func(_arg<typename std::tuple_element<I, Params>::type>(p_args[I])...);
+            r_return = Variant();
+        } else {
+            r_return = Variant(p_func(_arg<typename std::tuple_element<I, Params>::type>(p_args[I])...));
+        }
+    }
+
+    template <auto Method>
+    static void _call_method(void* p_target, const Variant** p_args, Variant& r_return) {
+        typedef Signature<decltype(Method)> Sig;
+        typename Sig::Class* instance = static_cast<typename Sig::Class*>(static_cast<Object*>(p_target));
+        auto invoke = [instance](auto&&... p_values) -> typename Sig::Return {
+            return (instance->*Method)(std::forward<decltype(p_values)>(p_values)...);
+        };
+        _apply<typename Sig::Return, typename Sig::Params>(invoke, p_args, r_return,
+                std::make_index_sequence<std::tuple_size<typename Sig::Params>::value>());
+    }
+
+    template <typename F>
+    static void _call_closure(void* p_target, const Variant** p_args, Variant& r_return) {
+        typedef Signature<decltype(&F::operator())> Sig;
+        F* closure = reinterpret_cast<F*>(p_target);
+        _apply<typename Sig::Return, typename Sig::Params>(*closure, p_args, r_return,
+                std::make_index_sequence<std::tuple_size<typename Sig::Params>::value>());
+    }
+
+    template <typename F>
+    static bool _closure_equal(const void* p_a, const void* p_b) {
+        if constexpr (std::is_empty<F>::value) {
+            return true;
+        } else if constexpr (HasEqual<F>::value) {
+            return bool(*reinterpret_cast<const F*>(p_a) == *reinterpret_cast<const F*>(p_b));
+        } else {
+            return memcmp(p_a, p_b, sizeof(F)) == 0;
+        }
+    }
+
+    template <auto Method>
+    static MethodID _get_method_id() {
+        typedef typename Signature<decltype(Method)>::Params Params;
+        static const MethodID id = _register_invoker({ &_call_method<Method>, int(std::tuple_size<Params>::value), nullptr, false });
+        return id;
+    }
+
+    template <typename F>
+    static MethodID _get_closure_id() {
+        typedef typename Signature<decltype(&F::operator())>::Params Params;
+        static_assert(std::is_empty<F>::value || HasEqual<F>::value || std::has_unique_object_representations<F>::value,
+                "Closure captures have padding or floats, so their bytes are not their value; reorder them or use a function object with operator==");
+        // A user operator== need not agree with the bytes, so such closures
+        // are hashed by type only.
+        static const MethodID id = _register_invoker({ &_call_closure<F>, int(std::tuple_size<Params>::value), &_closure_equal<F>,
+                !std::is_empty<F>::value && !HasEqual<F>::value });
+        return id;
+    }
+
+    static MethodID _register_invoker(const Invoker& p_invoker);
+
+    Variant* _bound() { return reinterpret_cast<Variant*>(bound_storage); }
+    const Variant* _bound() const { return reinterpret_cast<const Variant*>(bound_storage); }
+    void _copy_from(const Callable& p_other);
+    void _clear_bound();
+
+    static const uint32_t MAX_METHODS = 16384;
+    static Invoker invokers[MAX_METHODS];
+    static std::atomic<uint32_t> invoker_count;
+
+    ObjectID object;
+    MethodID method = 0;
+    Kind kind = KIND_NULL;
+    uint8_t bound_count = 0;
+    uint8_t unbind_count = 0;
+    alignas(8) unsigned char closure[CLOSURE_SIZE] = {};
+    // Only the first bound_count are constructed, so copying an unbound
+    // callable does not touch the Variants.
+    alignas(Variant) unsigned char bound_storage[MAX_BOUND_ARGS * sizeof(Variant)];
+};
+
+template <auto Method, typename C>
+Callable Callable::create(C* p_object) {
+    static_assert(std::is_base_of<typename Signature<decltype(Method)>::Class, C>::value, "Method does not belong to the object's class");
+    Callable callable;
+    if (p_object) {
+        callable.object = p_object->get_instance_id();
+        callable.method = _get_method_id<Method>();
+        callable.kind = KIND_METHOD;
+    }
+    return callable;
+}
+
+template <typename F, typename O>
+Callable Callable::from_closure(F p_closure, const O* p_owner) {
+    static_assert(std::is_trivially_copyable<F>::value, "Callable closures may only capture plain values and pointers");
+    static_assert(sizeof(F) <= CLOSURE_SIZE && alignof(F) <= 8, "Closure too large for Callable, capture less or use a method");
+    Callable callable;
+    // Bytes past sizeof(F) stay zero, so hashing the whole buffer is stable.
+    memcpy(callable.closure, static_cast<const void*>(&p_closure), sizeof(F));
+    callable.method = _get_closure_id<F>();
+    callable.kind = KIND_CLOSURE;
+    if (p_owner) {
+        callable.object = p_owner->get_instance_id();
+    }
+    return callable;
+}
+
+template <typename... Args>
+Callable Callable::bind(Args&&... p_args) const {
+    if (bound_count + sizeof...(Args) > MAX_BOUND_ARGS) {
+        throw std::length_error("Too many bound arguments in Callable.");
+    }
+    Callable result = *this;
+    ((new (&result._bound()[result.bound_count++]) Variant(std::forward<Args>(p_args))), ...);
+    return result;
+}
+
+template <typename... Args>
+Variant Callable::call(Args&&... p_args) const {
+    const Variant args[sizeof...(Args) + 1] = { Variant(std::forward<Args>(p_args))... };
+    const Variant* pointers[sizeof...(Args) + 1];
+    for (size_t i = 0; i < sizeof...(Args); i++) {
+        pointers[i] = &args[i];
+    }
+    Variant ret;
+    callp(pointers, int(sizeof...(Args)), ret);
+    return ret;
+}
+
+namespace std {
+template <>
+struct hash<Callable> {
+    size_t operator()(const Callable& p_callable) const { return p_callable.hash(); }
+};
+} // namespace std
+
+#endif // CALLABLE_H
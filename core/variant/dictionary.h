@@ -21,83 +21,645 @@ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
-
 #ifndef DICTIONARY_H
 #define DICTIONARY_H
 
 #include <thirdparty/logger/src/logger.h>
-#include <unordered_map>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
-#include <initializer_list>
 
 
+/**
+ * @class Dictionary
+ * @brief Insertion-ordered string-keyed dictionary.
+ *
+ * Same layout as CPython's compact dict: entries live in a dense array in
+ * insertion order, and a separate open-addressing table maps hashes to
+ * entry positions. The table holds only small integers, 1, 2 or 4 bytes
+ * wide depending on the size, so it stays in cache for typical dictionaries.
+ *
+ * - Iteration follows insertion order, so serialized output is stable.
+ * - Copies and duplicate() share the entries until one side is modified
+ *   (copy-on-write).
+ * - Lookups, inserts and erases are O(1). An erase leaves a tombstone in
+ *   the table and a hole in the entries, as CPython does; the holes are
+ *   compacted away once they reach a third of the entries.
+ * - get_key_at_index() / get_value_at_index() are O(1) while there are no
+ *   holes, O(n) otherwise.
+ *
+ * References returned by writable accessors (get(), getptr(), operator[])
+ * are invalidated by the next insertion or erase, as with std::vector.
+ * Until then the dictionary is not shared: a copy taken while such a
+ * reference may be live gets its own entries, so writing through the
+ * reference never shows in the copy.
+ */
 template <typename T>
 class Dictionary {
 public:
+    struct Entry {
+        std::string key;
+        T value;
+        size_t hash;
+    };
+
+    class const_iterator;
+
     Dictionary();
     Dictionary(const std::initializer_list<std::pair<const std::string, T>>& initList);
+    Dictionary(const Dictionary& p_other);
+    Dictionary& operator=(const Dictionary& p_other);
+
+private:
+    struct Storage;
 
 public:
+    // Walks the entries in insertion order, skipping erased ones.
+    class const_iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef Entry value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const Entry* pointer;
+        typedef const Entry& reference;
+
+        const_iterator() {}
+        const Entry& operator*() const { return storage->entries[position]; }
+        const Entry* operator->() const { return &storage->entries[position]; }
+        const_iterator& operator++() {
+            position++;
+            _skip();
+            return *this;
+        }
+        bool operator==(const const_iterator& p_other) const { return position == p_other.position; }
+        bool operator!=(const const_iterator& p_other) const { return position != p_other.position; }
+
+    private:
+        friend class Dictionary;
+        const_iterator(const Storage* p_storage, size_t p_position) : storage(p_storage), position(p_position) { _skip(); }
+        void _skip() {
+            while (storage && storage->holes && position < storage->entries.size() && storage->erased[position]) {
+                position++;
+            }
+        }
+        const Storage* storage = nullptr;
+        size_t position = 0;
+    };
+
     void insert(const std::string& key, const T& value);
     bool contains(const std::string& key) const;
     T& get(const std::string& key);
-
-    void ref(const std::string& key);
-    void unref(const std::string& key);
-
+    const T& get(const std::string& key) const;
 
     void remove(const std::string& key);
+    void erase(const std::string& key);
     size_t size() const;
 
     bool empty() const;
+    bool is_empty() const;
     void clear();
 
     void push_back(const std::string& key, const T& value);
+    void append(const std::string& key, const T& value);
     void error(const std::string& message) const;
 
     bool has(const std::string& key) const;
     bool has_all(const std::vector<std::string>& keys) const;
 
-    void Dictionary<T>::erase(const std::string& key);
-
-    T& get_valid(const std::string& key, const T& default_value) const;
+    T get_valid(const std::string& key, const T& default_value) const;
+    T& get_or_add(const std::string& key, const T& default_value);
+    T* getptr(const std::string& key);
+    const T* getptr(const std::string& key) const;
     std::string find_key(const T& value) const;
 
-    bool is_empty() const;
     void merge(const Dictionary<T>& other);
 
     std::vector<std::string> keys() const;
     std::vector<T> values() const;
+    std::vector<std::string> get_key_list() const;
 
-    void append(const std::string& key, const T& value);
-    void duplicate(const Dictionary& other);
-
+    // Copy of the dictionary. Shares the entries until either side changes.
+    Dictionary<T> duplicate() const { return *this; }
+    void duplicate(const Dictionary& other) { storage = _share(other.storage); }
 
+    void set_read_only(bool p_read_only) { read_only = p_read_only; }
     bool is_read_only() const;
-    T& get_valid(const std::string& key, const T& default_value) const;
 
     const T& get_value_at_index(size_t index) const;
-    T& get_or_add(const std::string& key, const T& default_value);
+    T& get_value_at_index(size_t index);
+    const std::string& get_key_at_index(size_t index) const;
+    // Position of key in insertion order, or -1.
+    int64_t find_index(const std::string& key) const;
 
     T& operator[](const std::string& key);
     const T& operator[](const std::string& key) const;
 
-    T& get(const std::string& key);
-    T* getptr(const std::string& key);
-
     std::string id() const;
-    size_t size() const;
 
-    std::vector<std::string> get_key_list() const;
-    std::string get_key_at_index(size_t index) const;
+    const_iterator begin() const { return const_iterator(storage.get(), 0); }
+    const_iterator end() const { return const_iterator(storage.get(), storage ? storage->entries.size() : 0); }
 
     bool operator==(const Dictionary<T>& other) const;
     bool operator!=(const Dictionary<T>& other) const;
+
 private:
-    std::unordered_map<std::string, T> data;
+    struct Storage {
+        std::vector<Entry> entries; ///< Insertion order, with holes where keys were erased.
+        std::vector<bool> erased; ///< Same length as entries.
+        size_t holes = 0;
+        // Open-addressing table of entry positions, slot_width bytes each.
+        std::vector<uint8_t> index;
+        uint32_t slot_width = 1;
+        uint32_t mask = 0; ///< Slot count - 1, a power of two minus one.
+        bool leaked = false; ///< A writable reference was handed out; copies must not share.
+
+        uint32_t empty_slot() const { return slot_width == 1 ? 0xFFu : (slot_width == 2 ? 0xFFFFu : 0xFFFFFFFFu); }
+        // Tombstone of an erased key (CPython's DKIX_DUMMY): probing goes on past it.
+        uint32_t dummy_slot() const { return empty_slot() - 1; }
+
+        uint32_t get_slot(uint32_t p_slot) const {
+            switch (slot_width) {
+                case 1:
+                    return index[p_slot];
+                case 2: {
+                    uint16_t v;
+                    memcpy(&v, &index[p_slot * 2], 2);
+                    return v;
+                }
+                default: {
+                    uint32_t v;
+                    memcpy(&v, &index[p_slot * 4], 4);
+                    return v;
+                }
+            }
+        }
+
+        void set_slot(uint32_t p_slot, uint32_t p_value) {
+            switch (slot_width) {
+                case 1:
+                    index[p_slot] = static_cast<uint8_t>(p_value);
+                    break;
+                case 2: {
+                    uint16_t v = static_cast<uint16_t>(p_value);
+                    memcpy(&index[p_slot * 2], &v, 2);
+                } break;
+                default:
+                    memcpy(&index[p_slot * 4], &p_value, 4);
+                    break;
+            }
+        }
+
+        // Slot holding key, or the empty slot where it would go.
+        uint32_t probe(const std::string& p_key, size_t p_hash) const {
+            const uint32_t empty = empty_slot();
+            const uint32_t dummy = dummy_slot();
+            uint32_t slot = static_cast<uint32_t>(p_hash) & mask;
+            while (true) {
+                uint32_t pos = get_slot(slot);
+                if (pos == empty) {
+                    return slot;
+                }
+                if (pos == dummy) {
+                    slot = (slot + 1) & mask;
+                    continue;
+                }
+                const Entry& e = entries[pos];
+                if (e.hash == p_hash && e.key == p_key) {
+                    return slot;
+                }
+                slot = (slot + 1) & mask;
+            }
+        }
+
+        // Drops the holes, sizes the table for p_count entries at a load
+        // factor of 2/3 and reinserts every entry.
+        void rebuild(size_t p_count) {
+            if (holes) {
+                size_t to = 0;
+                for (size_t from = 0; from < entries.size(); from++) {
+                    if (!erased[from]) {
+                        if (to != from) {
+                            entries[to] = std::move(entries[from]);
+                        }
+                        to++;
+                    }
+                }
+                entries.resize(to);
+                holes = 0;
+            }
+            erased.assign(entries.size(), false);
+            uint32_t slots = 8;
+            while (slots * 2 < p_count * 3) {
+                slots <<= 1;
+            }
+            // Entry positions must stay below the tombstone and empty markers.
+            slot_width = slots <= 0xFF ? 1 : (slots <= 0xFFFF ? 2 : 4);
+            mask = slots - 1;
+            index.assign(static_cast<size_t>(slots) * slot_width, 0xFF);
+            for (uint32_t i = 0; i < entries.size(); i++) {
+                uint32_t slot = static_cast<uint32_t>(entries[i].hash) & mask;
+                while (get_slot(slot) != empty_slot()) {
+                    slot = (slot + 1) & mask;
+                }
+                set_slot(slot, i);
+            }
+        }
+    };
+
+    static size_t _hash(const std::string& p_key) { return std::hash<std::string>()(p_key); }
+    // Storage for a copy: shared, unless a writable reference into it may be live.
+    static std::shared_ptr<Storage> _share(const std::shared_ptr<Storage>& p_storage);
+    // Position in entries of the p_index-th live entry.
+    size_t _position(size_t p_index) const;
+
+    const Entry* _find(const std::string& p_key) const;
+    // Unshares the storage before a write.
+    Storage& _write();
+    void _check_writable() const;
+    // p_leak: the caller keeps the returned reference, see Storage::leaked.
+    T& _insert(const std::string& p_key, const T& p_value, bool p_overwrite, bool p_leak);
+
+    std::shared_ptr<Storage> storage;
     bool read_only = false;
 };
 
 
-#endif // DICTIONARY_H
\ No newline at end of file
+template <typename T>
+Dictionary<T>::Dictionary() {}
+
+template <typename T>
+Dictionary<T>::Dictionary(const Dictionary& p_other) : storage(_share(p_other.storage)), read_only(p_other.read_only) {}
+
+template <typename T>
+Dictionary<T>& Dictionary<T>::operator=(const Dictionary& p_other) {
+    if (this != &p_other) {
+        storage = _share(p_other.storage);
+        read_only = p_other.read_only;
+    }
+    return *this;
+}
+
+template <typename T>
+std::shared_ptr<typename Dictionary<T>::Storage> Dictionary<T>::_share(const std::shared_ptr<Storage>& p_storage) {
+    if (!p_storage || !p_storage->leaked) {
+        return p_storage;
+    }
+    std::shared_ptr<Storage> copy = std::make_shared<Storage>(*p_storage);
+    copy->leaked = false;
+    return copy;
+}
+
+template <typename T>
+size_t Dictionary<T>::_position(size_t p_index) const {
+    const Storage& s = *storage;
+    if (!s.holes) {
+        return p_index;
+    }
+    for (size_t pos = 0; pos < s.entries.size(); pos++) {
+        if (!s.erased[pos] && p_index-- == 0) {
+            return pos;
+        }
+    }
+    return s.entries.size();
+}
+
+template <typename T>
+Dictionary<T>::Dictionary(const std::initializer_list<std::pair<const std::string, T>>& initList) {
+    for (const auto& pair : initList) {
+        insert(pair.first, pair.second);
+    }
+}
+
+template <typename T>
+const typename Dictionary<T>::Entry* Dictionary<T>::_find(const std::string& p_key) const {
+    if (!storage || storage->entries.empty()) {
+        return nullptr;
+    }
+    const Storage& s = *storage;
+    uint32_t pos = s.get_slot(s.probe(p_key, _hash(p_key)));
+    return pos == s.empty_slot() ? nullptr : &s.entries[pos];
+}
+
+template <typename T>
+typename Dictionary<T>::Storage& Dictionary<T>::_write() {
+    if (!storage) {
+        storage = std::make_shared<Storage>();
+        storage->rebuild(0);
+    } else if (storage.use_count() > 1) {
+        storage = std::make_shared<Storage>(*storage);
+        storage->leaked = false;
+    }
+    return *storage;
+}
+
+template <typename T>
+void Dictionary<T>::_check_writable() const {
+    if (read_only) {
+        throw std::logic_error("Dictionary is read-only. Cannot modify contents.");
+    }
+}
+
+template <typename T>
+T& Dictionary<T>::_insert(const std::string& p_key, const T& p_value, bool p_overwrite, bool p_leak) {
+    _check_writable();
+    Storage& s = _write();
+    s.leaked = p_leak;
+    const size_t hash = _hash(p_key);
+    uint32_t slot = s.probe(p_key, hash);
+    uint32_t pos = s.get_slot(slot);
+    if (pos != s.empty_slot()) {
+        if (p_overwrite) {
+            s.entries[pos].value = p_value;
+        }
+        return s.entries[pos].value;
+    }
+    // Holes and tombstones count towards the load: each hole has one.
+    if ((s.entries.size() + 1) * 3 > (static_cast<size_t>(s.mask) + 1) * 2) {
+        s.rebuild(s.entries.size() - s.holes + 1);
+        slot = s.probe(p_key, hash);
+    }
+    pos = static_cast<uint32_t>(s.entries.size());
+    s.entries.push_back(Entry{ p_key, p_value, hash });
+    s.erased.push_back(false);
+    s.set_slot(slot, pos);
+    return s.entries.back().value;
+}
+
+template <typename T>
+void Dictionary<T>::insert(const std::string& key, const T& value) {
+    _insert(key, value, true, false);
+}
+
+template <typename T>
+void Dictionary<T>::append(const std::string& key, const T& value) {
+    // Using insert to add or update a key-value pair
+    _insert(key, value, true, false);
+}
+
+template <typename T>
+void Dictionary<T>::push_back(const std::string& key, const T& value) {
+    if (contains(key)) {
+        error("Key already exists in dictionary.");
+    }
+    insert(key, value);
+}
+
+template <typename T>
+T& Dictionary<T>::get_or_add(const std::string& key, const T& default_value) {
+    return _insert(key, default_value, false, true);
+}
+
+template <typename T>
+T& Dictionary<T>::operator[](const std::string& key) {
+    return _insert(key, T(), false, true);
+}
+
+template <typename T>
+const T& Dictionary<T>::operator[](const std::string& key) const {
+    const Entry* e = _find(key);
+    if (!e) {
+        throw std::out_of_range("Key not found in dictionary.");
+    }
+    return e->value;
+}
+
+template <typename T>
+bool Dictionary<T>::contains(const std::string& key) const {
+    return _find(key) != nullptr;
+}
+
+template <typename T>
+bool Dictionary<T>::has(const std::string& key) const {
+    return contains(key);
+}
+
+template <typename T>
+bool Dictionary<T>::has_all(const std::vector<std::string>& keys) const {
+    return std::all_of(keys.begin(), keys.end(), [this](const std::string& key) {
+        return contains(key);
+    });
+}
+
+template <typename T>
+T& Dictionary<T>::get(const std::string& key) {
+    T* value = getptr(key);
+    if (!value) {
+        throw std::out_of_range("Key not found in dictionary.");
+    }
+    return *value;
+}
+
+template <typename T>
+const T& Dictionary<T>::get(const std::string& key) const {
+    return (*this)[key];
+}
+
+template <typename T>
+T* Dictionary<T>::getptr(const std::string& key) {
+    if (!_find(key)) {
+        return nullptr;
+    }
+    // The caller may write through the pointer.
+    Storage& s = _write();
+    s.leaked = true;
+    return &s.entries[s.get_slot(s.probe(key, _hash(key)))].value;
+}
+
+template <typename T>
+const T* Dictionary<T>::getptr(const std::string& key) const {
+    const Entry* e = _find(key);
+    return e ? &e->value : nullptr;
+}
+
+template <typename T>
+T Dictionary<T>::get_valid(const std::string& key, const T& default_value) const {
+    const Entry* e = _find(key);
+    return e ? e->value : default_value;
+}
+
+template <typename T>
+void Dictionary<T>::remove(const std::string& key) {
+    if (!contains(key)) {
+        error("Key not found in dictionary.");
+    }
+    erase(key);
+}
+
+template <typename T>
+void Dictionary<T>::erase(const std::string& key) {
+    _check_writable();
+    if (!_find(key)) {
+        throw std::out_of_range("Key not found in dictionary.");
+    }
+    Storage& s = _write();
+    s.leaked = false;
+    const uint32_t slot = s.probe(key, _hash(key));
+    const uint32_t pos = s.get_slot(slot);
+    s.set_slot(slot, s.dummy_slot());
+    Entry& entry = s.entries[pos];
+    std::string().swap(entry.key);
+    entry.value = T();
+    s.erased[pos] = true;
+    s.holes++;
+    if (s.holes * 3 > s.entries.size()) {
+        s.rebuild(s.entries.size() - s.holes);
+    }
+}
+
+template <typename T>
+void Dictionary<T>::clear() {
+    _check_writable();
+    storage.reset();
+}
+
+template <typename T>
+size_t Dictionary<T>::size() const {
+    return storage ? storage->entries.size() - storage->holes : 0;
+}
+
+template <typename T>
+bool Dictionary<T>::empty() const {
+    return size() == 0;
+}
+
+template <typename T>
+bool Dictionary<T>::is_empty() const {
+    return size() == 0;
+}
+
+template <typename T>
+void Dictionary<T>::error(const std::string& message) const {
+    throw std::runtime_error(message);
+}
+
+template <typename T>
+std::string Dictionary<T>::find_key(const T& value) const {
+    for (const Entry& e : *this) {
+        if (e.value == value) {
+            return e.key;
+        }
+    }
+    return ""; // Return an empty string if value is not found in the dictionary
+}
+
+template <typename T>
+void Dictionary<T>::merge(const Dictionary<T>& other) {
+    if (empty() && !read_only) {
+        storage = _share(other.storage);
+        return;
+    }
+    for (const Entry& e : other) {
+        insert(e.key, e.value);
+    }
+}
+
+template <typename T>
+std::vector<std::string> Dictionary<T>::keys() const {
+    std::vector<std::string> result;
+    result.reserve(size());
+    for (const Entry& e : *this) {
+        result.push_back(e.key);
+    }
+    return result;
+}
+
+template <typename T>
+std::vector<T> Dictionary<T>::values() const {
+    std::vector<T> result;
+    result.reserve(size());
+    for (const Entry& e : *this) {
+        result.push_back(e.value);
+    }
+    return result;
+}
+
+template <typename T>
+std::vector<std::string> Dictionary<T>::get_key_list() const {
+    return keys();
+}
+
+template <typename T>
+bool Dictionary<T>::is_read_only() const {
+    return read_only;
+}
+
+template <typename T>
+const T& Dictionary<T>::get_value_at_index(size_t index) const {
+    if (index >= size()) {
+        throw std::out_of_range("Index out of bounds.");
+    }
+    return storage->entries[_position(index)].value;
+}
+
+template <typename T>
+T& Dictionary<T>::get_value_at_index(size_t index) {
+    if (index >= size()) {
+        throw std::out_of_range("Index out of bounds.");
+    }
+    Storage& s = _write();
+    s.leaked = true;
+    return s.entries[_position(index)].value;
+}
+
+template <typename T>
+const std::string& Dictionary<T>::get_key_at_index(size_t index) const {
+    if (index >= size()) {
+        throw std::out_of_range("Index out of bounds.");
+    }
+    return storage->entries[_position(index)].key;
+}
+
+template <typename T>
+int64_t Dictionary<T>::find_index(const std::string& key) const {
+    const Entry* e = _find(key);
+    if (!e) {
+        return -1;
+    }
+    const size_t pos = static_cast<size_t>(e - storage->entries.data());
+    size_t index = pos;
+    for (size_t i = 0; storage->holes && i < pos; i++) {
+        index -= storage->erased[i];
+    }
+    return static_cast<int64_t>(index);
+}
+
+template <typename T>
+std::string Dictionary<T>::id() const {
+    std::ostringstream oss;
+    oss << reinterpret_cast<std::uintptr_t>(this);
+    return oss.str();
+}
+
+template <typename T>
+bool Dictionary<T>::operator==(const Dictionary<T>& other) const {
+    if (storage == other.storage) {
+        return true;
+    }
+    if (size() != other.size()) {
+        return false;
+    }
+    // Same keys and values, in any order.
+    for (const Entry& e : *this) {
+        const T* value = other.getptr(e.key);
+        if (!value || !(*value == e.value)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename T>
+bool Dictionary<T>::operator!=(const Dictionary<T>& other) const {
+    return !(*this == other);
+}
+
+#endif // DICTIONARY_H
@@ -2,14 +2,39 @@
 #define SIGNALS_H
 
 
-#include <map>
+#include <atomic>
+#include <memory>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
-#include <functional>
+
+#include "core/templates/delegate.h"
+#include "core/object/message_queue.h"
 
 class Object;
 
+// Connection flags
+enum ConnectFlags {
+    CONNECT_DEFAULT = 0,
+    CONNECT_DEFERRED = (1 << 0), ///< Queue the call, it runs when the MessageQueue is flushed.
+    CONNECT_ONE_SHOT = (1 << 1), ///< Disconnect after the first emission.
+};
+
 // Signal class for communication between objects
+//
+// Slots live in one contiguous array and are called in connection order.
+// Connecting or disconnecting from inside a slot is safe: disconnected slots
+// are only marked dead during emission and compacted once it ends, and slots
+// connected during emission are not called until the next one.
+//
+// Connect and disconnect from the thread that created the signal (the scene
+// thread). emit() may be called from any thread: on another thread the slot
+// array is not touched at all, the whole emission is queued on that thread's
+// MessageQueue buffer and every slot, immediate ones included, runs on the
+// scene thread at the next flush, without any lock.
 template <typename... Args>
 class Signal {
 public:
@@ -20,55 +45,211 @@ public:
     // Constructor
     CallError(int code, const std::string& message) : errorCode(code), errorMessage(message) {}
 };
+
 public:
+    using Slot = Delegate<void(Args...)>;
+
    struct Connection {
+    std::string key;
     Object* connectedObject;
-    Signal<Args...>::Slot connectedSlot;
+    Slot connectedSlot;
+    uint32_t flags;
+    bool connected;
 
     // Constructor
-    Connection(Object* obj, const Signal<Args...>::Slot& slot)
-        : connectedObject(obj), connectedSlot(slot) {}
+    Connection(const std::string& k, Object* obj, const Slot& slot, uint32_t f)
+        : key(k), connectedObject(obj), connectedSlot(slot), flags(f), connected(true) {}
 };
 
 public:
-    using Slot = std::function<void(Args...)>;
-
-    void connect(const std::string& key, MObject* obj, const Slot& slot) {
-        // Connect the slot to the signal associated with the provided key
-        connections[key].emplace_back(obj, slot);
+    Signal() : token(std::make_shared<Signal*>(this)), ownerThread(std::this_thread::get_id()) {}
+    Signal(const Signal&) = delete;
+    Signal& operator=(const Signal&) = delete;
+    ~Signal() {
+        // Emissions still queued see a null token and are dropped.
+        *token = nullptr;
     }
 
-    void disconnect(const std::string& key, MObject* obj) {
-        auto it = connections.find(key);
-        if (it != connections.end()) {
-            auto& slots = it->second;
-            slots.erase(std::remove_if(slots.begin(), slots.end(), [obj](const auto& pair) {
-                return pair.first == obj;
-            }), slots.end());
+    void connect(const std::string& key, Object* obj, const Slot& slot, uint32_t flags = CONNECT_DEFAULT) {
+        // Connect the slot to the signal associated with the provided key.
+        // During emission new slots wait aside so the array never moves
+        // under a running slot.
+        if (emitDepth > 0) {
+            pending.emplace_back(key, obj, slot, flags);
+        } else {
+            connections.emplace_back(key, obj, slot, flags);
+        }
+        if (flags & CONNECT_DEFERRED) {
+            deferredCount.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            immediateCount.fetch_add(1, std::memory_order_relaxed);
         }
     }
 
-    void emit(Args... args) {
-        for (const auto& connection : connections) {
-            for (const auto& pair : connection.second) {
-                pair.second(args...);
+    void disconnect(const std::string& key, Object* obj) {
+        _for_each_live([&](Connection& c) {
+            if (c.connectedObject == obj && c.key == key) {
+                _kill(c);
             }
+        });
+        _compact();
+    }
+
+    void disconnect_all() {
+        _for_each_live([&](Connection& c) { _kill(c); });
+        _compact();
+    }
+
+    bool is_connected(const std::string& key, Object* obj) const {
+        bool found = false;
+        const_cast<Signal*>(this)->_for_each_live([&](Connection& c) {
+            found = found || (c.connectedObject == obj && c.key == key);
+        });
+        return found;
+    }
+
+    // Calls every immediate slot now and queues one message for the
+    // deferred ones. Arguments are passed by reference to immediate slots
+    // and copied once for the deferred emission. From another thread the
+    // whole emission is queued instead.
+    void emit(const Args&... args) {
+        if (std::this_thread::get_id() != ownerThread) {
+            if (immediateCount.load(std::memory_order_relaxed) + deferredCount.load(std::memory_order_relaxed) > 0) {
+                _queue(true, args...);
+            }
+            return;
+        }
+        if (immediateCount.load(std::memory_order_relaxed) > 0) {
+            _emit(false, args...);
+        }
+        if (deferredCount.load(std::memory_order_relaxed) > 0) {
+            _queue(false, args...);
         }
     }
 
 // New functions to get and set connections
-    const std::vector<std::pair<Object*, Slot>>& get(const std::string& key) const {
-        auto it = connections.find(key);
-        return (it != connections.end()) ? it->second : emptyVector;
+    std::vector<Slot> get(const std::string& key) const {
+        std::vector<Slot> slots;
+        const_cast<Signal*>(this)->_for_each_live([&](Connection& c) {
+            if (c.key == key) {
+                slots.push_back(c.connectedSlot);
+            }
+        });
+        return slots;
     }
 
-    void set(const std::string& key, const std::vector<std::pair<MObject*, Slot>>& newConnections) {
-        connections[key] = newConnections;
+    void set(const std::string& key, const std::vector<std::pair<Object*, Slot>>& newConnections) {
+        _for_each_live([&](Connection& c) {
+            if (c.key == key) {
+                _kill(c);
+            }
+        });
+        for (const auto& pair : newConnections) {
+            connect(key, pair.first, pair.second);
+        }
+        _compact();
     }
+
+    size_t get_connection_count() const { return connections.size() + pending.size() - deadCount; }
+
 private:
-    // Map to store connections for each key
-    std::map<std::string, std::vector<std::pair<Object*, Slot>>> connections;
-    const std::vector<Connection> emptyVector;
+    // One queued message for the deferred slots, and the immediate ones too
+    // when emitted off the owning thread. The token outlives the signal, so
+    // a message flushed after it is destroyed does nothing.
+    void _queue(bool immediate, const Args&... args) {
+        std::shared_ptr<Signal*> t = token;
+        MessageQueue::get_singleton()->push_callable(
+                [t, immediate, tuple = std::tuple<typename std::decay<Args>::type...>(args...)]() {
+                    if (Signal* s = *t) {
+                        std::apply([s, immediate](const auto&... a) {
+                            if (immediate) {
+                                s->_emit(false, a...);
+                            }
+                            s->_emit(true, a...);
+                        }, tuple);
+                    }
+                });
+    }
+
+    void _emit(bool deferred, const Args&... args) {
+        emitDepth++;
+        // The array cannot change size while emitDepth > 0: dead slots stay
+        // in place and new ones go to the pending list.
+        const size_t count = connections.size();
+        for (size_t i = 0; i < count; i++) {
+            Connection& c = connections[i];
+            if (!c.connected || ((c.flags & CONNECT_DEFERRED) != 0) != deferred) {
+                continue;
+            }
+            if (c.flags & CONNECT_ONE_SHOT) {
+                _kill(c);
+            }
+            c.connectedSlot(args...);
+        }
+        emitDepth--;
+        _compact();
+    }
+
+    void _kill(Connection& c) {
+        c.connected = false;
+        if (c.flags & CONNECT_DEFERRED) {
+            deferredCount.fetch_sub(1, std::memory_order_relaxed);
+        } else {
+            immediateCount.fetch_sub(1, std::memory_order_relaxed);
+        }
+        deadCount++;
+    }
+
+    template <typename F>
+    void _for_each_live(F&& f) {
+        for (Connection& c : connections) {
+            if (c.connected) {
+                f(c);
+            }
+        }
+        for (Connection& c : pending) {
+            if (c.connected) {
+                f(c);
+            }
+        }
+    }
+
+    void _compact() {
+        if (emitDepth > 0) {
+            return;
+        }
+        if (!pending.empty()) {
+            for (Connection& c : pending) {
+                connections.push_back(std::move(c));
+            }
+            pending.clear();
+        }
+        if (deadCount == 0) {
+            return;
+        }
+        size_t w = 0;
+        for (size_t r = 0; r < connections.size(); r++) {
+            if (connections[r].connected) {
+                if (w != r) {
+                    connections[w] = std::move(connections[r]);
+                }
+                w++;
+            }
+        }
+        connections.erase(connections.begin() + w, connections.end());
+        deadCount = 0;
+    }
+
+    // Contiguous slot array, in connection order.
+    std::vector<Connection> connections;
+    std::vector<Connection> pending;
+    std::shared_ptr<Signal*> token;
+    std::thread::id ownerThread;
+    // Atomic so that emit() off the owning thread can read them.
+    std::atomic<uint32_t> deferredCount{0};
+    std::atomic<uint32_t> immediateCount{0};
+    uint32_t deadCount = 0;
+    uint32_t emitDepth = 0;
 };
 
 
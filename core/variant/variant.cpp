@@ -0,0 +1,407 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "variant.h"
+
+#include "core/object/object_db.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+
+struct Variant::SharedString {
+    std::atomic<uint32_t> refcount{ 1 };
+    std::string value;
+
+    explicit SharedString(std::string&& p_value) : value(std::move(p_value)) {}
+};
+
+RefCounted* _variant_get_ref_counted(const Variant& p_variant) {
+    return p_variant.get_ref_counted();
+}
+
+// Defined with Object in m_object.cpp, so Variant does not need the object
+// headers (and through them the graphics stack).
+std::string _object_get_class_name(const Object* p_object);
+
+Variant::Variant(const char* p_string) : Variant(std::string(p_string ? p_string : "")) {}
+
+Variant::Variant(const std::string& p_string) : Variant(std::string(p_string)) {}
+
+Variant::Variant(std::string&& p_string) : type(STRING) {
+    _put(new SharedString(std::move(p_string)));
+}
+
+Variant::Variant(RefCounted* p_ref) {
+    if (p_ref) {
+        type = REF_COUNTED;
+        p_ref->reference();
+        _put(p_ref);
+    }
+}
+
+void Variant::_ref() const {
+    switch (type) {
+        case STRING:
+            _get<SharedString*>()->refcount.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case REF_COUNTED:
+            _get<RefCounted*>()->reference();
+            break;
+        default:
+            break;
+    }
+}
+
+void Variant::_unref() {
+    switch (type) {
+        case STRING: {
+            SharedString* s = _get<SharedString*>();
+            if (s->refcount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                delete s;
+            }
+        } break;
+        case REF_COUNTED: {
+            RefCounted* r = _get<RefCounted*>();
+            if (r->unreference()) {
+                delete r;
+            }
+        } break;
+        default:
+            break;
+    }
+    type = NIL;
+}
+
+Variant& Variant::operator=(const Variant& p_other) {
+    if (this == &p_other) {
+        return *this;
+    }
+    // Reference the new value before dropping the old one, it may own it.
+    if (_is_shared(p_other.type)) {
+        p_other._ref();
+    }
+    if (_is_shared(type)) {
+        _unref();
+    }
+    type = p_other.type;
+    memcpy(_data, p_other._data, sizeof(_data));
+    return *this;
+}
+
+Variant& Variant::operator=(Variant&& p_other) noexcept {
+    if (this == &p_other) {
+        return *this;
+    }
+    if (_is_shared(type)) {
+        _unref();
+    }
+    type = p_other.type;
+    memcpy(_data, p_other._data, sizeof(_data));
+    p_other.type = NIL;
+    return *this;
+}
+
+const std::string* Variant::get_string_ptr() const {
+    return type == STRING ? &_get<SharedString*>()->value : nullptr;
+}
+
+const char* Variant::get_type_name(Type p_type) {
+    static const char* names[VARIANT_MAX] = {
+        "Nil",
+        "bool",
+        "int",
+        "float",
+        "Vector2",
+        "Vector2i",
+        "Rect2i",
+        "Color",
+        "Object",
+        "String",
+        "RefCounted",
+    };
+    return p_type < VARIANT_MAX ? names[p_type] : "";
+}
+
+// Conversion jump tables: one function per (target, stored type). Entries
+// left null mean the conversion is not supported and give the default.
+struct Variant::Table {
+    typedef bool (*ToBool)(const Variant&);
+    typedef int64_t (*ToInt)(const Variant&);
+    typedef double (*ToFloat)(const Variant&);
+    typedef Vector2 (*ToVector2)(const Variant&);
+    typedef Vector2i (*ToVector2i)(const Variant&);
+    typedef Rect2i (*ToRect2i)(const Variant&);
+    typedef Color (*ToColor)(const Variant&);
+    typedef std::string (*ToString)(const Variant&);
+    typedef bool (*Equal)(const Variant&, const Variant&);
+
+    static const ToBool to_bool[VARIANT_MAX];
+    static const ToInt to_int[VARIANT_MAX];
+    static const ToFloat to_float[VARIANT_MAX];
+    static const ToVector2 to_vector2[VARIANT_MAX];
+    static const ToVector2i to_vector2i[VARIANT_MAX];
+    static const ToRect2i to_rect2i[VARIANT_MAX];
+    static const ToColor to_color[VARIANT_MAX];
+    static const ToString to_string[VARIANT_MAX];
+    static const Equal equal[VARIANT_MAX];
+
+    static bool b(const Variant& v) { return v._get<bool>(); }
+    static int64_t i(const Variant& v) { return v._get<int64_t>(); }
+    static double f(const Variant& v) { return v._get<double>(); }
+    static Vector2 v2(const Variant& v) { return v._get<Vector2>(); }
+    static Vector2i v2i(const Variant& v) { return v._get<Vector2i>(); }
+    static Rect2i r2i(const Variant& v) { return v._get<Rect2i>(); }
+    static Color c(const Variant& v) { return v._get<Color>(); }
+    static const std::string& s(const Variant& v) { return v._get<SharedString*>()->value; }
+
+    template <typename T>
+    static bool equal_inline(const Variant& a, const Variant& b) { return a._get<T>() == b._get<T>(); }
+
+    static std::string format_float(double p_value) {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%.17g", p_value);
+        // Shortest form that reads back the same value.
+        for (int precision = 1; precision < 17; precision++) {
+            char shorter[32];
+            snprintf(shorter, sizeof(shorter), "%.*g", precision, p_value);
+            if (strtod(shorter, nullptr) == p_value) {
+                return shorter;
+            }
+        }
+        return buffer;
+    }
+};
+
+const Variant::Table::ToBool Variant::Table::to_bool[VARIANT_MAX] = {
+    nullptr,
+    [](const Variant& v) { return b(v); },
+    [](const Variant& v) { return i(v) != 0; },
+    [](const Variant& v) { return f(v) != 0.0; },
+    [](const Variant& v) { return v2(v) != Vector2{}; },
+    [](const Variant& v) { return v2i(v) != Vector2i(); },
+    [](const Variant& v) { return !(r2i(v) == Rect2i()); },
+    [](const Variant& v) { return c(v) != Color{}; },
+    [](const Variant& v) { return ObjectDB::get_instance(ObjectID(v._get<uint64_t>())) != nullptr; },
+    [](const Variant& v) { return !s(v).empty(); },
+    [](const Variant&) { return true; },
+};
+
+const Variant::Table::ToInt Variant::Table::to_int[VARIANT_MAX] = {
+    nullptr,
+    [](const Variant& v) { return int64_t(b(v)); },
+    [](const Variant& v) { return i(v); },
+    [](const Variant& v) { return int64_t(f(v)); },
+    nullptr,
+    nullptr,
+    nullptr,
+    [](const Variant& v) { return int64_t(color_to_rgba32(c(v))); },
+    [](const Variant& v) { return int64_t(v._get<uint64_t>()); },
+    [](const Variant& v) { return int64_t(strtoll(s(v).c_str(), nullptr, 0)); },
+    nullptr,
+};
+
+const Variant::Table::ToFloat Variant::Table::to_float[VARIANT_MAX] = {
+    nullptr,
+    [](const Variant& v) { return b(v) ? 1.0 : 0.0; },
+    [](const Variant& v) { return double(i(v)); },
+    [](const Variant& v) { return f(v); },
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    [](const Variant& v) { return strtod(s(v).c_str(), nullptr); },
+    nullptr,
+};
+
+const Variant::Table::ToVector2 Variant::Table::to_vector2[VARIANT_MAX] = {
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    [](const Variant& v) { return v2(v); },
+    [](const Variant& v) { Vector2i p = v2i(v); return Vector2{ float(p.x), float(p.y) }; },
+    [](const Variant& v) { Rect2i r = r2i(v); return Vector2{ float(r.x), float(r.y) }; },
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+};
+
+const Variant::Table::ToVector2i Variant::Table::to_vector2i[VARIANT_MAX] = {
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    [](const Variant& v) { Vector2 p = v2(v); return Vector2i(int32_t(p.x), int32_t(p.y)); },
+    [](const Variant& v) { return v2i(v); },
+    [](const Variant& v) { Rect2i r = r2i(v); return Vector2i(r.x, r.y); },
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+};
+
+const Variant::Table::ToRect2i Variant::Table::to_rect2i[VARIANT_MAX] = {
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    [](const Variant& v) { return r2i(v); },
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+};
+
+const Variant::Table::ToColor Variant::Table::to_color[VARIANT_MAX] = {
+    nullptr,
+    nullptr,
+    [](const Variant& v) { return color_from_rgba32(uint32_t(i(v))); },
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    [](const Variant& v) { return c(v); },
+    nullptr,
+    nullptr,
+    nullptr,
+};
+
+const Variant::Table::ToString Variant::Table::to_string[VARIANT_MAX] = {
+    [](const Variant&) { return std::string("<null>"); },
+    [](const Variant& v) { return std::string(b(v) ? "true" : "false"); },
+    [](const Variant& v) { return std::to_string(i(v)); },
+    [](const Variant& v) { return format_float(f(v)); },
+    [](const Variant& v) { Vector2 p = v2(v); return "(" + format_float(p.x) + ", " + format_float(p.y) + ")"; },
+    [](const Variant& v) { Vector2i p = v2i(v); return "(" + std::to_string(p.x) + ", " + std::to_string(p.y) + ")"; },
+    [](const Variant& v) {
+        Rect2i r = r2i(v);
+        return "[P: (" + std::to_string(r.x) + ", " + std::to_string(r.y) + "), S: (" + std::to_string(r.width) + ", " + std::to_string(r.height) + ")]";
+    },
+    [](const Variant& v) {
+        Color col = c(v);
+        return "(" + std::to_string(col.r) + ", " + std::to_string(col.g) + ", " + std::to_string(col.b) + ", " + std::to_string(col.a) + ")";
+    },
+    [](const Variant& v) {
+        Object* object = ObjectDB::get_instance(ObjectID(v._get<uint64_t>()));
+        return object ? std::string("<") + _object_get_class_name(object) + "#" + std::to_string(v._get<uint64_t>()) + ">" : std::string("<Freed Object>");
+    },
+    [](const Variant& v) { return s(v); },
+    [](const Variant&) { return std::string("<RefCounted>"); },
+};
+
+const Variant::Table::Equal Variant::Table::equal[VARIANT_MAX] = {
+    [](const Variant&, const Variant&) { return true; },
+    equal_inline<bool>,
+    equal_inline<int64_t>,
+    equal_inline<double>,
+    equal_inline<Vector2>,
+    equal_inline<Vector2i>,
+    equal_inline<Rect2i>,
+    equal_inline<Color>,
+    equal_inline<uint64_t>,
+    [](const Variant& a, const Variant& b) { return a._get<SharedString*>() == b._get<SharedString*>() || s(a) == s(b); },
+    equal_inline<RefCounted*>,
+};
+
+Variant::operator bool() const {
+    Table::ToBool f = Table::to_bool[type];
+    return f ? f(*this) : false;
+}
+
+Variant::operator int64_t() const {
+    Table::ToInt f = Table::to_int[type];
+    return f ? f(*this) : 0;
+}
+
+Variant::operator double() const {
+    Table::ToFloat f = Table::to_float[type];
+    return f ? f(*this) : 0.0;
+}
+
+Variant::operator Vector2() const {
+    Table::ToVector2 f = Table::to_vector2[type];
+    return f ? f(*this) : Vector2{};
+}
+
+Variant::operator Vector2i() const {
+    Table::ToVector2i f = Table::to_vector2i[type];
+    return f ? f(*this) : Vector2i();
+}
+
+Variant::operator Rect2i() const {
+    Table::ToRect2i f = Table::to_rect2i[type];
+    return f ? f(*this) : Rect2i();
+}
+
+Variant::operator Color() const {
+    Table::ToColor f = Table::to_color[type];
+    return f ? f(*this) : Color{};
+}
+
+Variant::operator std::string() const {
+    return Table::to_string[type](*this);
+}
+
+Variant::operator Object*() const {
+    return type == OBJECT ? ObjectDB::get_instance(ObjectID(_get<uint64_t>())) : nullptr;
+}
+
+bool Variant::operator==(const Variant& p_other) const {
+    return type == p_other.type && Table::equal[type](*this, p_other);
+}
+
+bool Variant::can_convert(Type p_from, Type p_to) {
+    if (p_from >= VARIANT_MAX || p_to >= VARIANT_MAX) {
+        return false;
+    }
+    if (p_from == p_to) {
+        return true;
+    }
+    switch (p_to) {
+        case BOOL:
+            return Table::to_bool[p_from] != nullptr;
+        case INT:
+            return Table::to_int[p_from] != nullptr;
+        case FLOAT:
+            return Table::to_float[p_from] != nullptr;
+        case VECTOR2:
+            return Table::to_vector2[p_from] != nullptr;
+        case VECTOR2I:
+            return Table::to_vector2i[p_from] != nullptr;
+        case RECT2I:
+            return Table::to_rect2i[p_from] != nullptr;
+        case COLOR:
+            return Table::to_color[p_from] != nullptr;
+        case STRING:
+            return true;
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,169 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef VARIANT_H
+#define VARIANT_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "core/math/color.h"
+#include "core/math/rect2i.h"
+#include "core/math/vector2.h"
+#include "core/math/vector2i.h"
+#include "core/object/ref_counted.h"
+#include "core/templates/object_id.h"
+
+class Object;
+
+/**
+ * @class Variant
+ * @brief Dynamically typed value for scripts, containers and serialization.
+ *
+ * Every type up to and including Rect2i and Color lives inline in a 16-byte
+ * payload, so creating or copying one never touches the heap. The payload
+ * is 4-byte aligned, which keeps the whole Variant at 20 bytes: that is the
+ * smallest layout with a type tag that still holds Rect2i and Color inline.
+ *
+ * Heavier types (STRING, REF_COUNTED) store one counted pointer; copies
+ * share it. Conversions between types go through per-target jump tables
+ * indexed by the stored type.
+ */
+class Variant {
+public:
+    // Inline types first: every type from STRING on holds a counted pointer.
+    enum Type : uint32_t {
+        NIL,
+        BOOL,
+        INT,
+        FLOAT,
+        VECTOR2,
+        VECTOR2I,
+        RECT2I,
+        COLOR,
+        OBJECT, ///< ObjectID, resolved through ObjectDB; holds no reference.
+        STRING,
+        REF_COUNTED,
+        VARIANT_MAX
+    };
+
+    Variant() {}
+    Variant(const Variant& p_other) : type(p_other.type) {
+        memcpy(_data, p_other._data, sizeof(_data));
+        if (_is_shared(type)) {
+            _ref();
+        }
+    }
+    Variant(Variant&& p_other) noexcept : type(p_other.type) {
+        memcpy(_data, p_other._data, sizeof(_data));
+        p_other.type = NIL;
+    }
+    ~Variant() {
+        if (_is_shared(type)) {
+            _unref();
+        }
+    }
+
+    Variant& operator=(const Variant& p_other);
+    Variant& operator=(Variant&& p_other) noexcept;
+
+    Variant(bool p_value) : type(BOOL) { _put(p_value); }
+    Variant(int32_t p_value) : type(INT) { _put(int64_t(p_value)); }
+    Variant(uint32_t p_value) : type(INT) { _put(int64_t(p_value)); }
+    Variant(int64_t p_value) : type(INT) { _put(p_value); }
+    Variant(uint64_t p_value) : type(INT) { _put(int64_t(p_value)); }
+    Variant(float p_value) : type(FLOAT) { _put(double(p_value)); }
+    Variant(double p_value) : type(FLOAT) { _put(p_value); }
+    Variant(const Vector2& p_value) : type(VECTOR2) { _put(p_value); }
+    Variant(const Vector2i& p_value) : type(VECTOR2I) { _put(p_value); }
+    Variant(const Rect2i& p_value) : type(RECT2I) { _put(p_value); }
+    Variant(const Color& p_value) : type(COLOR) { _put(p_value); }
+    Variant(const Object* p_object); ///< Defined in m_object.cpp, next to Object.
+    Variant(ObjectID p_id) : type(OBJECT) { _put(uint64_t(p_id)); }
+    Variant(const char* p_string);
+    Variant(const std::string& p_string);
+    Variant(std::string&& p_string);
+    Variant(RefCounted* p_ref);
+    template <class T>
+    Variant(const Ref<T>& p_ref) : Variant(static_cast<RefCounted*>(p_ref.get_ptr())) {}
+
+    Type get_type() const { return type; }
+    static const char* get_type_name(Type p_type);
+    bool is_nil() const { return type == NIL; }
+
+    // Conversions. Unsupported ones give the target's default value.
+    operator bool() const;
+    operator int32_t() const { return static_cast<int32_t>(operator int64_t()); }
+    operator int64_t() const;
+    operator float() const { return static_cast<float>(operator double()); }
+    operator double() const;
+    operator Vector2() const;
+    operator Vector2i() const;
+    operator Rect2i() const;
+    operator Color() const;
+    operator std::string() const;
+    operator Object*() const;
+
+    ObjectID get_object_id() const { return type == OBJECT ? ObjectID(_get<uint64_t>()) : ObjectID(); }
+    RefCounted* get_ref_counted() const { return type == REF_COUNTED ? _get<RefCounted*>() : nullptr; }
+    // No copy for string access in the common case.
+    const std::string* get_string_ptr() const;
+
+    bool operator==(const Variant& p_other) const;
+    bool operator!=(const Variant& p_other) const { return !(*this == p_other); }
+
+    static bool can_convert(Type p_from, Type p_to);
+
+private:
+    struct SharedString;
+    struct Table;
+    friend struct Table;
+
+    static constexpr bool _is_shared(Type p_type) { return p_type >= STRING; }
+
+    template <typename T>
+    T _get() const {
+        static_assert(sizeof(T) <= sizeof(_data), "Type does not fit inline in Variant");
+        T value;
+        memcpy(static_cast<void*>(&value), _data, sizeof(T));
+        return value;
+    }
+    template <typename T>
+    void _put(const T& p_value) {
+        static_assert(sizeof(T) <= sizeof(_data), "Type does not fit inline in Variant");
+        memcpy(_data, static_cast<const void*>(&p_value), sizeof(T));
+    }
+
+    void _ref() const;
+    void _unref();
+
+    Type type = NIL;
+    uint32_t _data[4] = {};
+};
+
+static_assert(sizeof(Variant) == 20, "Variant layout changed");
+
+#endif // VARIANT_H
@@ -0,0 +1,671 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "variant_parser.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define VARIANT_PARSER_SSE2
+#endif
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+static inline bool _is_identifier_char(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static inline bool _is_number_char(char c) {
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+// The non-finite float spellings written by ConfigFile and the scene saver.
+static bool _parse_special_real(std::string_view p_name, double& r_value) {
+    if (p_name == "nan") {
+        r_value = std::numeric_limits<double>::quiet_NaN();
+    } else if (p_name == "inf") {
+        r_value = std::numeric_limits<double>::infinity();
+    } else if (p_name == "inf_neg") {
+        r_value = -std::numeric_limits<double>::infinity();
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static inline int _popcount(uint32_t p_value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcount(p_value);
+#else
+    int count = 0;
+    for (; p_value; p_value &= p_value - 1) {
+        count++;
+    }
+    return count;
+#endif
+}
+
+static inline int _ctz(uint32_t p_value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(p_value);
+#else
+    int count = 0;
+    while (!(p_value & 1)) {
+        p_value >>= 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+
+VariantParser::~VariantParser() {
+    close();
+}
+
+Error VariantParser::open_file(const std::string& p_path) {
+    close();
+#ifdef _WIN32
+    std::ifstream file(p_path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return ERR_FILE_CANT_OPEN;
+    }
+    mapping_size = static_cast<size_t>(file.tellg());
+    char* data = new char[mapping_size ? mapping_size : 1];
+    file.seekg(0);
+    file.read(data, mapping_size);
+    mapping = data;
+#else
+    int fd = ::open(p_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return ERR_FILE_CANT_OPEN;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return ERR_FILE_CANT_READ;
+    }
+    mapping_size = static_cast<size_t>(st.st_size);
+    if (mapping_size > 0) {
+        void* data = mmap(nullptr, mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            ::close(fd);
+            mapping_size = 0;
+            return ERR_FILE_CANT_READ;
+        }
+        // Read once, front to back: let the kernel read ahead and drop
+        // pages behind us.
+        madvise(data, mapping_size, MADV_SEQUENTIAL);
+        mapping = data;
+    }
+    ::close(fd);
+#endif
+    open_buffer(static_cast<const char*>(mapping), mapping_size);
+    return OK;
+}
+
+void VariantParser::open_buffer(const char* p_data, size_t p_size) {
+    begin = p_data;
+    cursor = p_data;
+    end = p_data + p_size;
+    // UTF-8 byte order mark.
+    if (p_size >= 3 && memcmp(p_data, "\xEF\xBB\xBF", 3) == 0) {
+        cursor += 3;
+    }
+    stack[0] = { CONTEXT_TOP, false, false };
+    depth = 1;
+    value_pending = false;
+    line = 1;
+    error_text.clear();
+}
+
+void VariantParser::close() {
+    if (mapping) {
+#ifdef _WIN32
+        delete[] static_cast<char*>(mapping);
+#else
+        munmap(mapping, mapping_size);
+#endif
+    }
+    mapping = nullptr;
+    mapping_size = 0;
+    begin = cursor = end = nullptr;
+    depth = 0;
+}
+
+Error VariantParser::_error(const char* p_message) {
+    error_text = p_message;
+    return ERR_PARSE_ERROR;
+}
+
+void VariantParser::_skip_whitespace() {
+#ifdef VARIANT_PARSER_SSE2
+    // 16 bytes per step: one mask for whitespace, one for newlines so line
+    // numbers stay exact without a scalar pass.
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+    while (end - cursor >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cursor));
+        __m128i newline = _mm_cmpeq_epi8(chunk, lf);
+        __m128i blank = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, cr), newline));
+        uint32_t blank_mask = static_cast<uint32_t>(_mm_movemask_epi8(blank));
+        uint32_t newline_mask = static_cast<uint32_t>(_mm_movemask_epi8(newline));
+        if (blank_mask != 0xFFFF) {
+            int skip = _ctz(~blank_mask);
+            line += _popcount(newline_mask & ((1u << skip) - 1));
+            cursor += skip;
+            return;
+        }
+        line += _popcount(newline_mask);
+        cursor += 16;
+    }
+#endif
+    while (cursor < end) {
+        char c = *cursor;
+        if (c == '\n') {
+            line++;
+        } else if (c != ' ' && c != '\t' && c != '\r') {
+            return;
+        }
+        cursor++;
+    }
+}
+
+void VariantParser::_skip_blank() {
+    while (true) {
+        _skip_whitespace();
+        if (cursor >= end || *cursor != ';') {
+            return;
+        }
+        const void* newline = memchr(cursor, '\n', end - cursor);
+        cursor = newline ? static_cast<const char*>(newline) : end;
+    }
+}
+
+std::string_view VariantParser::_read_identifier() {
+    const char* start = cursor;
+    while (cursor < end && _is_identifier_char(*cursor)) {
+        cursor++;
+    }
+    return std::string_view(start, cursor - start);
+}
+
+Error VariantParser::_push(Context p_context) {
+    if (depth == MAX_DEPTH) {
+        return _error("Values nested too deeply.");
+    }
+    stack[depth++] = { p_context, false, false };
+    return OK;
+}
+
+Error VariantParser::next(Event& r_event) {
+    r_event.value = Variant();
+    r_event.text = std::string_view();
+    r_event.is_string = false;
+    r_event.has_escapes = false;
+    r_event.string_type = STRING_PLAIN;
+    if (depth == 0) {
+        r_event.type = EVENT_EOF;
+        return OK;
+    }
+    if (value_pending) {
+        value_pending = false;
+        return _parse_value(r_event);
+    }
+
+    Frame& frame = stack[depth - 1];
+    switch (frame.context) {
+        case CONTEXT_TOP: {
+            _skip_blank();
+            r_event.line = line;
+            if (cursor >= end) {
+                r_event.type = EVENT_EOF;
+                return OK;
+            }
+            if (*cursor == '[') {
+                cursor++;
+                _skip_whitespace();
+                r_event.text = _read_identifier();
+                if (r_event.text.empty()) {
+                    return _error("Expected tag name after '['.");
+                }
+                r_event.type = EVENT_TAG_BEGIN;
+                return _push(CONTEXT_TAG);
+            }
+            // Property names may contain '/', ':' and digits, so take
+            // everything up to '='.
+            const char* key_begin = cursor;
+            while (cursor < end && *cursor != '=' && *cursor != '\n') {
+                cursor++;
+            }
+            if (cursor >= end || *cursor != '=') {
+                return _error("Expected '=' after property name.");
+            }
+            const char* key_end = cursor;
+            while (key_end > key_begin && (key_end[-1] == ' ' || key_end[-1] == '\t')) {
+                key_end--;
+            }
+            cursor++;
+            r_event.type = EVENT_KEY;
+            r_event.text = std::string_view(key_begin, key_end - key_begin);
+            value_pending = true;
+            return OK;
+        }
+        case CONTEXT_TAG: {
+            _skip_whitespace();
+            r_event.line = line;
+            if (cursor >= end) {
+                return _error("Unexpected end of file inside a tag.");
+            }
+            if (*cursor == ']') {
+                cursor++;
+                depth--;
+                r_event.type = EVENT_TAG_END;
+                return OK;
+            }
+            r_event.text = _read_identifier();
+            if (r_event.text.empty()) {
+                return _error("Expected attribute name.");
+            }
+            _skip_whitespace();
+            if (cursor >= end || *cursor != '=') {
+                return _error("Expected '=' after attribute name.");
+            }
+            cursor++;
+            r_event.type = EVENT_KEY;
+            value_pending = true;
+            return OK;
+        }
+        case CONTEXT_ARRAY:
+            return _next_item(']', EVENT_ARRAY_END, r_event);
+        case CONTEXT_CALL:
+            return _next_item(')', EVENT_CALL_END, r_event);
+        case CONTEXT_DICTIONARY: {
+            _skip_blank();
+            r_event.line = line;
+            if (cursor >= end) {
+                return _error("Unexpected end of file inside a dictionary.");
+            }
+            if (frame.after_key) {
+                if (*cursor != ':') {
+                    return _error("Expected ':' after dictionary key.");
+                }
+                cursor++;
+                frame.after_key = false;
+                return _parse_value(r_event);
+            }
+            if (*cursor != '}' && frame.has_items) {
+                if (*cursor != ',') {
+                    return _error("Expected ',' or '}' in dictionary.");
+                }
+                cursor++;
+                _skip_blank();
+            }
+            if (cursor < end && *cursor == '}') {
+                cursor++;
+                depth--;
+                r_event.type = EVENT_DICTIONARY_END;
+                return OK;
+            }
+            frame.has_items = true;
+            frame.after_key = true;
+            return _parse_value(r_event);
+        }
+    }
+    return _error("Invalid parser state.");
+}
+
+Error VariantParser::_next_item(char p_close, EventType p_end, Event& r_event) {
+    Frame& frame = stack[depth - 1];
+    _skip_blank();
+    r_event.line = line;
+    if (cursor >= end) {
+        return _error("Unexpected end of file, missing closing bracket.");
+    }
+    if (*cursor != p_close && frame.has_items) {
+        if (*cursor != ',') {
+            return _error("Expected ',' between values.");
+        }
+        cursor++;
+        _skip_blank();
+    }
+    // Trailing commas are allowed.
+    if (cursor < end && *cursor == p_close) {
+        cursor++;
+        depth--;
+        r_event.type = p_end;
+        return OK;
+    }
+    frame.has_items = true;
+    return _parse_value(r_event);
+}
+
+Error VariantParser::_parse_value(Event& r_event) {
+    _skip_blank();
+    r_event.line = line;
+    if (cursor >= end) {
+        return _error("Expected a value.");
+    }
+    const char c = *cursor;
+    switch (c) {
+        case '"':
+            return _parse_string(r_event);
+        case '&': // StringName
+        case '^': { // NodePath
+            cursor++;
+            if (cursor >= end || *cursor != '"') {
+                return _error("Expected '\"'.");
+            }
+            const Error err = _parse_string(r_event);
+            r_event.string_type = c == '&' ? STRING_NAME : STRING_NODE_PATH;
+            return err;
+        }
+        case '[':
+            cursor++;
+            r_event.type = EVENT_ARRAY_BEGIN;
+            return _push(CONTEXT_ARRAY);
+        case '{':
+            cursor++;
+            r_event.type = EVENT_DICTIONARY_BEGIN;
+            return _push(CONTEXT_DICTIONARY);
+        default:
+            break;
+    }
+    if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.') {
+        return _parse_number(r_event);
+    }
+
+    std::string_view name = _read_identifier();
+    if (name.empty()) {
+        return _error("Unexpected character.");
+    }
+    r_event.type = EVENT_VALUE;
+    if (name == "true" || name == "false") {
+        r_event.value = name == "true";
+        return OK;
+    }
+    if (name == "null") {
+        return OK;
+    }
+    double special;
+    if (_parse_special_real(name, special)) {
+        r_event.value = special;
+        return OK;
+    }
+
+    _skip_whitespace();
+    if (cursor >= end || *cursor != '(') {
+        return _error("Unexpected identifier.");
+    }
+    cursor++;
+    if (name == "Vector2" || name == "Vector2i") {
+        return _parse_constructor(name, 2, r_event);
+    }
+    if (name == "Rect2i" || name == "Color") {
+        return _parse_constructor(name, 4, r_event);
+    }
+    r_event.type = EVENT_CALL_BEGIN;
+    r_event.text = name;
+    return _push(CONTEXT_CALL);
+}
+
+Error VariantParser::_parse_constructor(std::string_view p_name, int p_count, Event& r_event) {
+    double args[4] = { 0.0, 0.0, 0.0, 1.0 };
+    int count = 0;
+    // nan and inf only fit the float constructors.
+    const bool is_real = p_name == "Vector2" || p_name == "Color";
+    while (true) {
+        _skip_blank();
+        if (cursor < end && *cursor == ')') {
+            cursor++;
+            break;
+        }
+        if (count > 0) {
+            if (cursor >= end || *cursor != ',') {
+                return _error("Expected ',' between constructor arguments.");
+            }
+            cursor++;
+            _skip_blank();
+        }
+        if (count == p_count) {
+            return _error("Too many constructor arguments.");
+        }
+        if (is_real && cursor < end && _is_identifier_char(*cursor) && !(*cursor >= '0' && *cursor <= '9')) {
+            if (!_parse_special_real(_read_identifier(), args[count])) {
+                return _error("Expected a number in constructor.");
+            }
+            count++;
+            continue;
+        }
+        const char* start = cursor;
+        while (cursor < end && _is_number_char(*cursor)) {
+            cursor++;
+        }
+        Variant number;
+        if (!parse_number(std::string_view(start, cursor - start), number)) {
+            return _error("Expected a number in constructor.");
+        }
+        const double value = number.operator double();
+        if (!is_real && (value != std::trunc(value) || value < std::numeric_limits<int32_t>::min() || value > std::numeric_limits<int32_t>::max())) {
+            return _error("Expected an integer in constructor.");
+        }
+        args[count++] = value;
+    }
+
+    // Color alpha is optional.
+    const bool is_color = p_name == "Color";
+    if (count != p_count && !(is_color && count == 3)) {
+        return _error("Wrong number of constructor arguments.");
+    }
+    if (p_name == "Vector2") {
+        r_event.value = Vector2{ float(args[0]), float(args[1]) };
+    } else if (p_name == "Vector2i") {
+        r_event.value = Vector2i(int32_t(args[0]), int32_t(args[1]));
+    } else if (p_name == "Rect2i") {
+        r_event.value = Rect2i(int(args[0]), int(args[1]), int(args[2]), int(args[3]));
+    } else {
+        r_event.value = color_from_normalized(float(args[0]), float(args[1]), float(args[2]), float(args[3]));
+    }
+    r_event.type = EVENT_VALUE;
+    return OK;
+}
+
+Error VariantParser::_parse_string(Event& r_event) {
+    cursor++; // Opening quote.
+    const char* start = cursor;
+    bool escapes = false;
+    while (true) {
+        const char* quote = static_cast<const char*>(memchr(cursor, '"', end - cursor));
+        if (!quote) {
+            return _error("Unterminated string.");
+        }
+        // A quote preceded by an odd number of backslashes is escaped.
+        const char* b = quote;
+        while (b > start && b[-1] == '\\') {
+            b--;
+        }
+        cursor = quote + 1;
+        if (((quote - b) & 1) == 0) {
+            break;
+        }
+        escapes = true;
+    }
+    const size_t length = (cursor - 1) - start;
+    if (!escapes) {
+        escapes = memchr(start, '\\', length) != nullptr;
+    }
+    for (const char* p = start; (p = static_cast<const char*>(memchr(p, '\n', (start + length) - p))); p++) {
+        line++;
+    }
+    r_event.type = EVENT_VALUE;
+    r_event.text = std::string_view(start, length);
+    r_event.is_string = true;
+    r_event.has_escapes = escapes;
+    return OK;
+}
+
+Error VariantParser::_parse_number(Event& r_event) {
+    const char* start = cursor;
+    while (cursor < end && _is_number_char(*cursor)) {
+        cursor++;
+    }
+    if (!parse_number(std::string_view(start, cursor - start), r_event.value)) {
+        return _error("Malformed number.");
+    }
+    r_event.type = EVENT_VALUE;
+    return OK;
+}
+
+bool VariantParser::parse_number(std::string_view p_text, Variant& r_value) {
+    if (p_text.empty()) {
+        return false;
+    }
+    const char* first = p_text.data();
+    const char* last = first + p_text.size();
+    if (*first == '+') {
+        first++;
+    }
+    const bool is_float = p_text.find_first_of(".eE") != std::string_view::npos;
+    if (!is_float) {
+        int64_t value;
+        std::from_chars_result result = std::from_chars(first, last, value);
+        if (result.ec == std::errc() && result.ptr == last) {
+            r_value = value;
+            return true;
+        }
+        if (result.ec != std::errc::result_out_of_range) {
+            return false;
+        }
+        // Too large for int: fall through and keep it as a float.
+    }
+    double value;
+    std::from_chars_result result = std::from_chars(first, last, value);
+    if (result.ec != std::errc() || result.ptr != last) {
+        return false;
+    }
+    r_value = value;
+    return true;
+}
+
+static void _append_utf8(std::string& r_out, uint32_t p_code) {
+    if (p_code < 0x80) {
+        r_out += static_cast<char>(p_code);
+    } else if (p_code < 0x800) {
+        r_out += static_cast<char>(0xC0 | (p_code >> 6));
+        r_out += static_cast<char>(0x80 | (p_code & 0x3F));
+    } else if (p_code < 0x10000) {
+        r_out += static_cast<char>(0xE0 | (p_code >> 12));
+        r_out += static_cast<char>(0x80 | ((p_code >> 6) & 0x3F));
+        r_out += static_cast<char>(0x80 | (p_code & 0x3F));
+    } else {
+        r_out += static_cast<char>(0xF0 | (p_code >> 18));
+        r_out += static_cast<char>(0x80 | ((p_code >> 12) & 0x3F));
+        r_out += static_cast<char>(0x80 | ((p_code >> 6) & 0x3F));
+        r_out += static_cast<char>(0x80 | (p_code & 0x3F));
+    }
+}
+
+void VariantParser::unescape(std::string_view p_raw, std::string& r_out) {
+    r_out.clear();
+    r_out.reserve(p_raw.size());
+    for (size_t i = 0; i < p_raw.size(); i++) {
+        char c = p_raw[i];
+        if (c != '\\' || i + 1 == p_raw.size()) {
+            r_out += c;
+            continue;
+        }
+        c = p_raw[++i];
+        switch (c) {
+            case 'n':
+                r_out += '\n';
+                break;
+            case 't':
+                r_out += '\t';
+                break;
+            case 'r':
+                r_out += '\r';
+                break;
+            case 'b':
+                r_out += '\b';
+                break;
+            case 'f':
+                r_out += '\f';
+                break;
+            case 'u': {
+                uint32_t code = 0;
+                size_t digits = 0;
+                while (digits < 4 && i + 1 < p_raw.size()) {
+                    char h = p_raw[i + 1];
+                    uint32_t v;
+                    if (h >= '0' && h <= '9') {
+                        v = h - '0';
+                    } else if (h >= 'a' && h <= 'f') {
+                        v = h - 'a' + 10;
+                    } else if (h >= 'A' && h <= 'F') {
+                        v = h - 'A' + 10;
+                    } else {
+                        break;
+                    }
+                    code = (code << 4) | v;
+                    digits++;
+                    i++;
+                }
+                _append_utf8(r_out, code);
+            } break;
+            default:
+                // \" \\ \' and anything unknown: the character itself.
+                r_out += c;
+                break;
+        }
+    }
+}
+
+Error VariantParser::skip_group() {
+    const int target = depth - 1;
+    Event event;
+    while (depth > target) {
+        Error err = next(event);
+        if (err != OK) {
+            return err;
+        }
+        if (event.type == EVENT_EOF) {
+            return _error("Unexpected end of file.");
+        }
+    }
+    return OK;
+}
@@ -0,0 +1,163 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef VARIANT_PARSER_H
+#define VARIANT_PARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "core/error/error_list.h"
+#include "core/variant/variant.h"
+
+/**
+ * @class VariantParser
+ * @brief Pull parser for the text scene and resource format.
+ *
+ *     [gd_scene load_steps=2 format=3]
+ *     [node name="Player" type="Node2D"]
+ *     position = Vector2(10, 20)
+ *     tags = ["a", "b"]
+ *
+ * The file is memory-mapped and read once, front to back. next() returns
+ * one event at a time: names, keys and strings are views into the mapped
+ * buffer and numbers are parsed straight into a Variant, so parsing does
+ * not allocate and memory use does not grow with the file size. Nesting is
+ * tracked in a fixed stack of MAX_DEPTH levels.
+ *
+ * Events of a file: TAG_BEGIN, then KEY + value per attribute, TAG_END,
+ * then KEY + value per property, until the next tag or EOF. A value is one
+ * VALUE event, or a BEGIN ... END group of nested values for arrays,
+ * dictionaries (alternating keys and values) and constructor calls the
+ * parser does not fold into a Variant (ExtResource("1"), PackedInt32Array).
+ */
+class VariantParser {
+public:
+    static const int MAX_DEPTH = 64;
+
+    enum EventType {
+        EVENT_EOF,
+        EVENT_TAG_BEGIN, ///< text: tag name.
+        EVENT_TAG_END,
+        EVENT_KEY, ///< text: attribute or property name. A value follows.
+        EVENT_VALUE, ///< value, or text when is_string.
+        EVENT_ARRAY_BEGIN,
+        EVENT_ARRAY_END,
+        EVENT_DICTIONARY_BEGIN,
+        EVENT_DICTIONARY_END,
+        EVENT_CALL_BEGIN, ///< text: constructor name. Arguments follow as values.
+        EVENT_CALL_END,
+    };
+
+    /** @brief Which literal a string value was written as. */
+    enum StringType {
+        STRING_PLAIN, ///< "text"
+        STRING_NAME, ///< &"text"
+        STRING_NODE_PATH, ///< ^"text"
+    };
+
+    struct Event {
+        EventType type = EVENT_EOF;
+        // View into the source. For strings, the raw contents between the
+        // quotes; pass to unescape() when has_escapes is set.
+        std::string_view text;
+        Variant value;
+        bool is_string = false;
+        bool has_escapes = false;
+        StringType string_type = STRING_PLAIN; ///< Set when is_string.
+        uint32_t line = 0;
+    };
+
+    VariantParser() {}
+    ~VariantParser();
+
+    VariantParser(const VariantParser&) = delete;
+    VariantParser& operator=(const VariantParser&) = delete;
+
+    /** @brief Map p_path and start parsing it. */
+    Error open_file(const std::string& p_path);
+    /** @brief Parse a caller-owned buffer. It must outlive the parser. */
+    void open_buffer(const char* p_data, size_t p_size);
+    void close();
+
+    /**
+     * Read the next event.
+     * @return OK, or ERR_PARSE_ERROR (see get_error_text() and get_line()).
+     *         At the end of input returns OK with an EVENT_EOF event.
+     */
+    Error next(Event& r_event);
+
+    /** @brief Skip the rest of the value whose BEGIN event was just returned. */
+    Error skip_group();
+
+    uint32_t get_line() const { return line; }
+    const std::string& get_error_text() const { return error_text; }
+    size_t get_position() const { return static_cast<size_t>(cursor - begin); }
+    size_t get_size() const { return static_cast<size_t>(end - begin); }
+
+    static void unescape(std::string_view p_raw, std::string& r_out);
+    /** @brief Parse an int or float literal; false if p_text is not one. */
+    static bool parse_number(std::string_view p_text, Variant& r_value);
+
+private:
+    enum Context : uint8_t {
+        CONTEXT_TOP,
+        CONTEXT_TAG,
+        CONTEXT_ARRAY,
+        CONTEXT_DICTIONARY,
+        CONTEXT_CALL,
+    };
+
+    struct Frame {
+        Context context;
+        bool has_items; ///< A separator is required before the next item.
+        bool after_key; ///< Dictionary: the next item is the value after ':'.
+    };
+
+    Error _error(const char* p_message);
+    void _skip_whitespace();
+    void _skip_blank();
+    Error _parse_value(Event& r_event);
+    Error _parse_string(Event& r_event);
+    Error _parse_number(Event& r_event);
+    Error _parse_constructor(std::string_view p_name, int p_count, Event& r_event);
+    std::string_view _read_identifier();
+    Error _push(Context p_context);
+    Error _next_item(char p_close, EventType p_end, Event& r_event);
+
+    const char* begin = nullptr;
+    const char* cursor = nullptr;
+    const char* end = nullptr;
+    void* mapping = nullptr;
+    size_t mapping_size = 0;
+
+    Frame stack[MAX_DEPTH];
+    int depth = 0;
+    bool value_pending = false;
+    uint32_t line = 1;
+    std::string error_text;
+};
+
+#endif // VARIANT_PARSER_H
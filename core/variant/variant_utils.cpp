@@ -0,0 +1,641 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "variant_utils.h"
+
+#include <algorithm>
+
+
+size_t VariantBinary::get_packed_element_size(Tag p_tag) {
+    switch (p_tag) {
+        case TAG_PACKED_BYTE:
+            return 1;
+        case TAG_PACKED_INT32:
+        case TAG_PACKED_FLOAT32:
+        case TAG_PACKED_COLOR:
+            return 4;
+        case TAG_PACKED_INT64:
+        case TAG_PACKED_FLOAT64:
+        case TAG_PACKED_VECTOR2:
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+size_t VariantBinary::get_packed_component_size(Tag p_tag) {
+    switch (p_tag) {
+        case TAG_PACKED_INT64:
+        case TAG_PACKED_FLOAT64:
+            return 8;
+        case TAG_PACKED_INT32:
+        case TAG_PACKED_FLOAT32:
+        case TAG_PACKED_VECTOR2:
+            return 4;
+        default:
+            return 1;
+    }
+}
+
+void VariantBinary::swap_packed(Tag p_tag, void* p_data, size_t p_count) {
+    const size_t component = get_packed_component_size(p_tag);
+    if (component == 1) {
+        return;
+    }
+    uint8_t* bytes = static_cast<uint8_t*>(p_data);
+    uint8_t* last = bytes + p_count * get_packed_element_size(p_tag);
+    for (; bytes < last; bytes += component) {
+        std::reverse(bytes, bytes + component);
+    }
+}
+
+static void _write_u16(uint8_t* p_dst, uint16_t p_value) {
+    p_dst[0] = static_cast<uint8_t>(p_value);
+    p_dst[1] = static_cast<uint8_t>(p_value >> 8);
+}
+
+static void _write_u32(uint8_t* p_dst, uint32_t p_value) {
+    for (int i = 0; i < 4; i++) {
+        p_dst[i] = static_cast<uint8_t>(p_value >> (i * 8));
+    }
+}
+
+static uint16_t _read_u16(const uint8_t* p_src) {
+    return uint16_t(p_src[0] | (p_src[1] << 8));
+}
+
+static uint32_t _read_u32(const uint8_t* p_src) {
+    return uint32_t(p_src[0]) | (uint32_t(p_src[1]) << 8) | (uint32_t(p_src[2]) << 16) | (uint32_t(p_src[3]) << 24);
+}
+
+static size_t _align(size_t p_offset, size_t p_alignment) {
+    return (p_offset + p_alignment - 1) & ~(p_alignment - 1);
+}
+
+
+// Encoder
+
+void VariantEncoder::_put_varint(uint64_t p_value) {
+    while (p_value >= 0x80) {
+        body.push_back(static_cast<uint8_t>(p_value | 0x80));
+        p_value >>= 7;
+    }
+    body.push_back(static_cast<uint8_t>(p_value));
+}
+
+void VariantEncoder::_put_raw(const void* p_data, size_t p_size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(p_data);
+    body.insert(body.end(), bytes, bytes + p_size);
+}
+
+void VariantEncoder::_put_float(float p_value) {
+    uint32_t bits;
+    memcpy(&bits, &p_value, 4);
+    uint8_t bytes[4];
+    _write_u32(bytes, bits);
+    _put_raw(bytes, 4);
+}
+
+uint32_t VariantEncoder::_intern(std::string_view p_string) {
+    auto it = string_ids.find(p_string);
+    if (it != string_ids.end()) {
+        return it->second;
+    }
+    const uint32_t id = static_cast<uint32_t>(strings.size());
+    strings.emplace_back(p_string);
+    string_ids.emplace(strings.back(), id);
+    return id;
+}
+
+Error VariantEncoder::put(const Variant& p_value) {
+    switch (p_value.get_type()) {
+        case Variant::NIL:
+            _put_tag(VariantBinary::TAG_NIL);
+            break;
+        case Variant::BOOL:
+            _put_tag(bool(p_value) ? VariantBinary::TAG_TRUE : VariantBinary::TAG_FALSE);
+            break;
+        case Variant::INT:
+            _put_tag(VariantBinary::TAG_INT);
+            _put_zigzag(int64_t(p_value));
+            break;
+        case Variant::FLOAT: {
+            const double value = p_value;
+            const float narrow = static_cast<float>(value);
+            if (static_cast<double>(narrow) == value) {
+                _put_tag(VariantBinary::TAG_FLOAT32);
+                _put_float(narrow);
+            } else {
+                uint64_t bits;
+                memcpy(&bits, &value, 8);
+                _put_tag(VariantBinary::TAG_FLOAT64);
+                uint8_t bytes[8];
+                _write_u32(bytes, static_cast<uint32_t>(bits));
+                _write_u32(bytes + 4, static_cast<uint32_t>(bits >> 32));
+                _put_raw(bytes, 8);
+            }
+        } break;
+        case Variant::VECTOR2: {
+            const Vector2 value = p_value;
+            _put_tag(VariantBinary::TAG_VECTOR2);
+            _put_float(value.x);
+            _put_float(value.y);
+        } break;
+        case Variant::VECTOR2I: {
+            const Vector2i value = p_value;
+            _put_tag(VariantBinary::TAG_VECTOR2I);
+            _put_zigzag(value.x);
+            _put_zigzag(value.y);
+        } break;
+        case Variant::RECT2I: {
+            const Rect2i value = p_value;
+            _put_tag(VariantBinary::TAG_RECT2I);
+            _put_zigzag(value.x);
+            _put_zigzag(value.y);
+            _put_zigzag(value.width);
+            _put_zigzag(value.height);
+        } break;
+        case Variant::COLOR: {
+            const Color value = p_value;
+            _put_tag(VariantBinary::TAG_COLOR);
+            const uint8_t bytes[4] = { value.r, value.g, value.b, value.a };
+            _put_raw(bytes, 4);
+        } break;
+        case Variant::STRING:
+            put_string(*p_value.get_string_ptr());
+            break;
+        default:
+            return ERR_INVALID_PARAMETER;
+    }
+    return OK;
+}
+
+void VariantEncoder::put_string(std::string_view p_string) {
+    if (p_string.size() <= VariantBinary::MAX_INTERNED_LENGTH) {
+        _put_tag(VariantBinary::TAG_STRING);
+        _put_varint(_intern(p_string));
+    } else {
+        _put_tag(VariantBinary::TAG_STRING_INLINE);
+        _put_varint(p_string.size());
+        _put_raw(p_string.data(), p_string.size());
+    }
+}
+
+void VariantEncoder::put_array_begin(uint32_t p_count) {
+    _put_tag(VariantBinary::TAG_ARRAY);
+    _put_varint(p_count);
+}
+
+void VariantEncoder::put_dictionary_begin(uint32_t p_count) {
+    _put_tag(VariantBinary::TAG_DICTIONARY);
+    _put_varint(p_count);
+}
+
+void VariantEncoder::put_key(std::string_view p_key) {
+    _put_varint(_intern(p_key));
+}
+
+void VariantEncoder::_put_packed(VariantBinary::Tag p_tag, const void* p_data, size_t p_count) {
+    _put_tag(p_tag);
+    _put_varint(p_count);
+    // The body starts at an 8-byte boundary of the output, so aligning
+    // within the body aligns in the final buffer.
+    body.resize(_align(body.size(), VariantBinary::get_packed_alignment(p_tag)), 0);
+    _put_raw(p_data, p_count * VariantBinary::get_packed_element_size(p_tag));
+#ifdef VARIANT_BINARY_BIG_ENDIAN
+    VariantBinary::swap_packed(p_tag, body.data() + body.size() - p_count * VariantBinary::get_packed_element_size(p_tag), p_count);
+#endif
+}
+
+Error VariantEncoder::put_array(const std::vector<Variant>& p_array) {
+    put_array_begin(static_cast<uint32_t>(p_array.size()));
+    for (const Variant& value : p_array) {
+        Error err = put(value);
+        if (err != OK) {
+            return err;
+        }
+    }
+    return OK;
+}
+
+Error VariantEncoder::put_dictionary(const Dictionary<Variant>& p_dictionary) {
+    put_dictionary_begin(static_cast<uint32_t>(p_dictionary.size()));
+    for (const Dictionary<Variant>::Entry& entry : p_dictionary) {
+        put_key(entry.key);
+        Error err = put(entry.value);
+        if (err != OK) {
+            return err;
+        }
+    }
+    return OK;
+}
+
+void VariantEncoder::finish(std::vector<uint8_t>& r_out) const {
+    size_t table_size = 0;
+    for (const std::string& string : strings) {
+        table_size += string.size() + 5;
+    }
+    r_out.clear();
+    r_out.reserve(VariantBinary::HEADER_SIZE + table_size + 8 + body.size());
+    r_out.resize(VariantBinary::HEADER_SIZE);
+
+    for (const std::string& string : strings) {
+        uint64_t length = string.size();
+        while (length >= 0x80) {
+            r_out.push_back(static_cast<uint8_t>(length | 0x80));
+            length >>= 7;
+        }
+        r_out.push_back(static_cast<uint8_t>(length));
+        r_out.insert(r_out.end(), string.begin(), string.end());
+    }
+    const size_t body_offset = _align(r_out.size(), 8);
+    r_out.resize(body_offset, 0);
+    r_out.insert(r_out.end(), body.begin(), body.end());
+
+    _write_u32(r_out.data(), VariantBinary::MAGIC);
+    _write_u16(r_out.data() + 4, VariantBinary::VERSION);
+    _write_u16(r_out.data() + 6, 0);
+    _write_u32(r_out.data() + 8, static_cast<uint32_t>(strings.size()));
+    _write_u32(r_out.data() + 12, static_cast<uint32_t>(body_offset));
+}
+
+void VariantEncoder::clear() {
+    body.clear();
+    string_ids.clear();
+    strings.clear();
+}
+
+
+// Decoder
+
+Error VariantDecoder::open(const uint8_t* p_data, size_t p_size) {
+    data = cursor = end = nullptr;
+    strings.clear();
+    if (p_size < VariantBinary::HEADER_SIZE || _read_u32(p_data) != VariantBinary::MAGIC) {
+        return ERR_FILE_UNRECOGNIZED;
+    }
+    version = _read_u16(p_data + 4);
+    if (version == 0 || version > VariantBinary::VERSION) {
+        return ERR_FILE_UNRECOGNIZED;
+    }
+    const uint32_t string_count = _read_u32(p_data + 8);
+    const uint32_t body_offset = _read_u32(p_data + 12);
+    if (body_offset < VariantBinary::HEADER_SIZE || body_offset > p_size || body_offset % 8 != 0) {
+        return ERR_FILE_CORRUPT;
+    }
+
+    data = p_data;
+    cursor = p_data + VariantBinary::HEADER_SIZE;
+    end = p_data + body_offset;
+    // Every string takes at least one byte.
+    if (string_count > static_cast<size_t>(end - cursor)) {
+        return ERR_FILE_CORRUPT;
+    }
+    strings.reserve(string_count);
+    for (uint32_t i = 0; i < string_count; i++) {
+        uint32_t length;
+        if (!_get_count(length) || length > static_cast<size_t>(end - cursor)) {
+            strings.clear();
+            return ERR_FILE_CORRUPT;
+        }
+        strings.emplace_back(reinterpret_cast<const char*>(cursor), length);
+        cursor += length;
+    }
+
+    cursor = p_data + body_offset;
+    end = p_data + p_size;
+    return OK;
+}
+
+bool VariantDecoder::_get_varint(uint64_t& r_value) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (cursor >= end) {
+            return false;
+        }
+        const uint8_t byte = *cursor++;
+        value |= uint64_t(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            r_value = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool VariantDecoder::_get_zigzag(int64_t& r_value) {
+    uint64_t raw;
+    if (!_get_varint(raw)) {
+        return false;
+    }
+    r_value = static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1);
+    return true;
+}
+
+bool VariantDecoder::_get_count(uint32_t& r_count) {
+    uint64_t value;
+    if (!_get_varint(value) || value > UINT32_MAX) {
+        return false;
+    }
+    r_count = static_cast<uint32_t>(value);
+    return true;
+}
+
+bool VariantDecoder::_get_float(float& r_value) {
+    if (end - cursor < 4) {
+        return false;
+    }
+    const uint32_t bits = _read_u32(cursor);
+    memcpy(&r_value, &bits, 4);
+    cursor += 4;
+    return true;
+}
+
+Error VariantDecoder::_expect(VariantBinary::Tag p_tag) {
+    if (cursor >= end) {
+        return ERR_FILE_EOF;
+    }
+    if (*cursor != p_tag) {
+        return ERR_INVALID_DATA;
+    }
+    cursor++;
+    return OK;
+}
+
+Error VariantDecoder::read(Variant& r_value) {
+    if (cursor >= end) {
+        return ERR_FILE_EOF;
+    }
+    const uint8_t* start = cursor;
+    const uint8_t tag = *cursor++;
+    bool ok = true;
+    switch (tag) {
+        case VariantBinary::TAG_NIL:
+            r_value = Variant();
+            break;
+        case VariantBinary::TAG_FALSE:
+        case VariantBinary::TAG_TRUE:
+            r_value = tag == VariantBinary::TAG_TRUE;
+            break;
+        case VariantBinary::TAG_INT: {
+            int64_t value;
+            ok = _get_zigzag(value);
+            if (ok) {
+                r_value = value;
+            }
+        } break;
+        case VariantBinary::TAG_FLOAT32: {
+            float value;
+            ok = _get_float(value);
+            if (ok) {
+                r_value = value;
+            }
+        } break;
+        case VariantBinary::TAG_FLOAT64: {
+            if (end - cursor < 8) {
+                ok = false;
+                break;
+            }
+            const uint64_t bits = uint64_t(_read_u32(cursor)) | (uint64_t(_read_u32(cursor + 4)) << 32);
+            double value;
+            memcpy(&value, &bits, 8);
+            cursor += 8;
+            r_value = value;
+        } break;
+        case VariantBinary::TAG_VECTOR2: {
+            Vector2 value;
+            ok = _get_float(value.x) && _get_float(value.y);
+            if (ok) {
+                r_value = value;
+            }
+        } break;
+        case VariantBinary::TAG_VECTOR2I: {
+            int64_t x, y;
+            ok = _get_zigzag(x) && _get_zigzag(y);
+            if (ok) {
+                r_value = Vector2i(int32_t(x), int32_t(y));
+            }
+        } break;
+        case VariantBinary::TAG_RECT2I: {
+            int64_t x, y, width, height;
+            ok = _get_zigzag(x) && _get_zigzag(y) && _get_zigzag(width) && _get_zigzag(height);
+            if (ok) {
+                r_value = Rect2i(int(x), int(y), int(width), int(height));
+            }
+        } break;
+        case VariantBinary::TAG_COLOR: {
+            ok = end - cursor >= 4;
+            if (ok) {
+                r_value = Color{ cursor[0], cursor[1], cursor[2], cursor[3] };
+                cursor += 4;
+            }
+        } break;
+        case VariantBinary::TAG_STRING:
+        case VariantBinary::TAG_STRING_INLINE: {
+            cursor = start;
+            std::string_view string;
+            Error err = read_string(string);
+            if (err != OK) {
+                return err;
+            }
+            r_value = std::string(string);
+        } break;
+        default:
+            cursor = start;
+            return tag < VariantBinary::TAG_MAX ? ERR_INVALID_DATA : ERR_FILE_CORRUPT;
+    }
+    if (!ok) {
+        // Truncated payload: r_value is left as it was.
+        cursor = start;
+        return ERR_FILE_CORRUPT;
+    }
+    return OK;
+}
+
+Error VariantDecoder::read_string(std::string_view& r_string) {
+    if (cursor >= end) {
+        return ERR_FILE_EOF;
+    }
+    uint32_t value;
+    if (*cursor == VariantBinary::TAG_STRING) {
+        cursor++;
+        if (!_get_count(value) || value >= strings.size()) {
+            return ERR_FILE_CORRUPT;
+        }
+        r_string = strings[value];
+        return OK;
+    }
+    if (*cursor == VariantBinary::TAG_STRING_INLINE) {
+        cursor++;
+        if (!_get_count(value) || value > static_cast<size_t>(end - cursor)) {
+            return ERR_FILE_CORRUPT;
+        }
+        r_string = std::string_view(reinterpret_cast<const char*>(cursor), value);
+        cursor += value;
+        return OK;
+    }
+    return ERR_INVALID_DATA;
+}
+
+Error VariantDecoder::read_array_begin(uint32_t& r_count) {
+    Error err = _expect(VariantBinary::TAG_ARRAY);
+    if (err != OK) {
+        return err;
+    }
+    return _get_count(r_count) ? OK : ERR_FILE_CORRUPT;
+}
+
+Error VariantDecoder::read_dictionary_begin(uint32_t& r_count) {
+    Error err = _expect(VariantBinary::TAG_DICTIONARY);
+    if (err != OK) {
+        return err;
+    }
+    return _get_count(r_count) ? OK : ERR_FILE_CORRUPT;
+}
+
+Error VariantDecoder::read_key(std::string_view& r_key) {
+    uint32_t index;
+    if (!_get_count(index) || index >= strings.size()) {
+        return ERR_FILE_CORRUPT;
+    }
+    r_key = strings[index];
+    return OK;
+}
+
+Error VariantDecoder::_read_packed(VariantBinary::Tag p_tag, const uint8_t*& r_data, uint32_t& r_count) {
+    const uint8_t* start = cursor;
+    Error err = _expect(p_tag);
+    if (err != OK) {
+        return err;
+    }
+    uint32_t count;
+    if (!_get_count(count)) {
+        return ERR_FILE_CORRUPT;
+    }
+    const size_t offset = _align(cursor - data, VariantBinary::get_packed_alignment(p_tag));
+    const size_t size = size_t(count) * VariantBinary::get_packed_element_size(p_tag);
+    if (offset > static_cast<size_t>(end - data) || size > static_cast<size_t>(end - data) - offset) {
+        cursor = start;
+        return ERR_FILE_CORRUPT;
+    }
+    r_data = data + offset;
+    r_count = count;
+    cursor = data + offset + size;
+    return OK;
+}
+
+Error VariantDecoder::read_array(std::vector<Variant>& r_array) {
+    uint32_t count;
+    Error err = read_array_begin(count);
+    if (err != OK) {
+        return err;
+    }
+    r_array.clear();
+    // Every element takes at least one byte; do not trust the count blindly.
+    r_array.reserve(std::min<size_t>(count, end - cursor));
+    for (uint32_t i = 0; i < count; i++) {
+        Variant value;
+        err = read(value);
+        if (err != OK) {
+            return err == ERR_FILE_EOF ? ERR_FILE_CORRUPT : err;
+        }
+        r_array.push_back(std::move(value));
+    }
+    return OK;
+}
+
+Error VariantDecoder::read_dictionary(Dictionary<Variant>& r_dictionary) {
+    uint32_t count;
+    Error err = read_dictionary_begin(count);
+    if (err != OK) {
+        return err;
+    }
+    r_dictionary.clear();
+    for (uint32_t i = 0; i < count; i++) {
+        std::string_view key;
+        err = read_key(key);
+        if (err != OK) {
+            return err;
+        }
+        Variant value;
+        err = read(value);
+        if (err != OK) {
+            return err == ERR_FILE_EOF ? ERR_FILE_CORRUPT : err;
+        }
+        r_dictionary.insert(std::string(key), value);
+    }
+    return OK;
+}
+
+Error VariantDecoder::skip() {
+    return _skip(0);
+}
+
+Error VariantDecoder::_skip(int p_depth) {
+    if (p_depth > VariantBinary::MAX_DEPTH) {
+        return ERR_FILE_CORRUPT;
+    }
+    const VariantBinary::Tag tag = get_next_tag();
+    uint32_t count;
+    switch (tag) {
+        case VariantBinary::TAG_ARRAY:
+        case VariantBinary::TAG_DICTIONARY: {
+            cursor++;
+            if (!_get_count(count)) {
+                return ERR_FILE_CORRUPT;
+            }
+            for (uint32_t i = 0; i < count; i++) {
+                std::string_view key;
+                if (tag == VariantBinary::TAG_DICTIONARY && read_key(key) != OK) {
+                    return ERR_FILE_CORRUPT;
+                }
+                Error err = _skip(p_depth + 1);
+                if (err != OK) {
+                    return err == ERR_FILE_EOF ? ERR_FILE_CORRUPT : err;
+                }
+            }
+            return OK;
+        }
+        case VariantBinary::TAG_PACKED_BYTE:
+        case VariantBinary::TAG_PACKED_INT32:
+        case VariantBinary::TAG_PACKED_INT64:
+        case VariantBinary::TAG_PACKED_FLOAT32:
+        case VariantBinary::TAG_PACKED_FLOAT64:
+        case VariantBinary::TAG_PACKED_VECTOR2:
+        case VariantBinary::TAG_PACKED_COLOR: {
+            const uint8_t* raw;
+            return _read_packed(tag, raw, count);
+        }
+        case VariantBinary::TAG_MAX:
+            return cursor >= end ? ERR_FILE_EOF : ERR_FILE_CORRUPT;
+        default: {
+            // Scalars and strings; skipping a string does not copy it.
+            if (tag == VariantBinary::TAG_STRING || tag == VariantBinary::TAG_STRING_INLINE) {
+                std::string_view string;
+                return read_string(string);
+            }
+            Variant value;
+            return read(value);
+        }
+    }
+}
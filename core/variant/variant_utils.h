@@ -0,0 +1,336 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef VARIANT_UTILS_H
+#define VARIANT_UTILS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "core/error/error_list.h"
+#include "core/variant/array.h"
+#include "core/variant/dictionary.h"
+#include "core/variant/variant.h"
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define VARIANT_BINARY_BIG_ENDIAN
+#endif
+
+/**
+ * @class VariantBinary
+ * @brief Constants of the binary Variant format shared by VariantEncoder and
+ * VariantDecoder.
+ *
+ * Layout, all little-endian:
+ *
+ *     header     "PSVB", u16 version, u16 flags, u32 string count, u32 body offset
+ *     strings    per string: varint length, bytes
+ *     (padding)  up to the body offset, a multiple of 8
+ *     body       tagged values
+ *
+ * Each value is a one-byte tag followed by its payload. Integers are
+ * zigzag varints and floats are stored as 32 bits when that is lossless.
+ * Dictionary keys and short strings are indices into the string table, so
+ * a key repeated across thousands of records is stored once. Packed array
+ * data is aligned to at least 4 bytes (8 for 64-bit elements) from the
+ * start of the buffer, so a decoder over a mapped file can hand it out in
+ * place. Big-endian hosts byte-swap packed elements on the way in and out,
+ * and can only read them through the copying overloads.
+ */
+class VariantBinary {
+public:
+    static const uint32_t MAGIC = 0x42565350; // "PSVB"
+    static const uint16_t VERSION = 1;
+    static const size_t HEADER_SIZE = 16;
+    // Longer strings are written inline; they rarely repeat.
+    static const size_t MAX_INTERNED_LENGTH = 64;
+    static const int MAX_DEPTH = 64;
+
+    enum Tag : uint8_t {
+        TAG_NIL,
+        TAG_FALSE,
+        TAG_TRUE,
+        TAG_INT,
+        TAG_FLOAT32,
+        TAG_FLOAT64,
+        TAG_VECTOR2,
+        TAG_VECTOR2I,
+        TAG_RECT2I,
+        TAG_COLOR, ///< r, g, b, a bytes.
+        TAG_STRING, ///< varint index into the string table.
+        TAG_STRING_INLINE, ///< varint length, bytes.
+        TAG_ARRAY, ///< varint count, values.
+        TAG_DICTIONARY, ///< varint count, (varint key index, value) pairs.
+        TAG_PACKED_BYTE, ///< varint count, padding, raw elements.
+        TAG_PACKED_INT32,
+        TAG_PACKED_INT64,
+        TAG_PACKED_FLOAT32,
+        TAG_PACKED_FLOAT64,
+        TAG_PACKED_VECTOR2,
+        TAG_PACKED_COLOR,
+        TAG_MAX
+    };
+
+    // Element types that can be written as packed arrays.
+    template <typename T>
+    struct Packed;
+
+    static size_t get_packed_element_size(Tag p_tag);
+    /** @brief Size of the scalars an element is made of: 4 for a Vector2, 1 for a Color. */
+    static size_t get_packed_component_size(Tag p_tag);
+    /** @brief Reverse the byte order of every component of p_count elements. */
+    static void swap_packed(Tag p_tag, void* p_data, size_t p_count);
+    static size_t get_packed_alignment(Tag p_tag) { return p_tag == TAG_PACKED_INT64 || p_tag == TAG_PACKED_FLOAT64 ? 8 : 4; }
+};
+
+template <>
+struct VariantBinary::Packed<uint8_t> {
+    static const Tag TAG = TAG_PACKED_BYTE;
+};
+template <>
+struct VariantBinary::Packed<int32_t> {
+    static const Tag TAG = TAG_PACKED_INT32;
+};
+template <>
+struct VariantBinary::Packed<int64_t> {
+    static const Tag TAG = TAG_PACKED_INT64;
+};
+template <>
+struct VariantBinary::Packed<float> {
+    static const Tag TAG = TAG_PACKED_FLOAT32;
+};
+template <>
+struct VariantBinary::Packed<double> {
+    static const Tag TAG = TAG_PACKED_FLOAT64;
+};
+template <>
+struct VariantBinary::Packed<Vector2> {
+    static const Tag TAG = TAG_PACKED_VECTOR2;
+};
+template <>
+struct VariantBinary::Packed<Color> {
+    static const Tag TAG = TAG_PACKED_COLOR;
+};
+
+/**
+ * @class VariantEncoder
+ * @brief Writes values in the binary Variant format.
+ *
+ * Containers are written as a begin call with the element count followed
+ * by the elements, so nested data does not need to be built in memory
+ * first:
+ *
+ *     VariantEncoder encoder;
+ *     encoder.put_dictionary_begin(2);
+ *     encoder.put_key("name");
+ *     encoder.put("Player");
+ *     encoder.put_key("path");
+ *     encoder.put_packed(points.data(), points.size());
+ *     encoder.finish(bytes);
+ */
+class VariantEncoder {
+public:
+    VariantEncoder() {}
+
+    /**
+     * Append a scalar or string value.
+     * @return OK, or ERR_INVALID_PARAMETER for objects and references, which
+     *         have no serialized form.
+     */
+    Error put(const Variant& p_value);
+    void put_string(std::string_view p_string);
+
+    void put_array_begin(uint32_t p_count);
+    /** @brief Start a dictionary; follow with p_count put_key() + value pairs. */
+    void put_dictionary_begin(uint32_t p_count);
+    void put_key(std::string_view p_key);
+
+    template <typename T>
+    void put_packed(const T* p_data, size_t p_count);
+    template <typename T>
+    void put_packed(const PackedArray<T>& p_array) { put_packed(p_array.ptr(), p_array.size()); }
+
+    Error put_array(const std::vector<Variant>& p_array);
+    Error put_dictionary(const Dictionary<Variant>& p_dictionary);
+
+    /** @brief Write the header, string table and body to r_out. */
+    void finish(std::vector<uint8_t>& r_out) const;
+    void clear();
+
+    size_t get_string_count() const { return strings.size(); }
+
+private:
+    void _put_tag(VariantBinary::Tag p_tag) { body.push_back(p_tag); }
+    void _put_varint(uint64_t p_value);
+    void _put_zigzag(int64_t p_value) { _put_varint((static_cast<uint64_t>(p_value) << 1) ^ static_cast<uint64_t>(p_value >> 63)); }
+    void _put_raw(const void* p_data, size_t p_size);
+    void _put_float(float p_value);
+    void _put_packed(VariantBinary::Tag p_tag, const void* p_data, size_t p_count);
+    uint32_t _intern(std::string_view p_string);
+
+    std::vector<uint8_t> body;
+    // Table order; a deque so the map keys below stay valid.
+    std::deque<std::string> strings;
+    std::unordered_map<std::string_view, uint32_t> string_ids;
+};
+
+template <typename T>
+void VariantEncoder::put_packed(const T* p_data, size_t p_count) {
+    _put_packed(VariantBinary::Packed<T>::TAG, p_data, p_count);
+}
+
+/**
+ * @class VariantDecoder
+ * @brief Reads the binary Variant format from a caller-owned buffer.
+ *
+ * Nothing is copied up front: strings come out as views into the buffer
+ * and read_packed() returns a pointer straight to packed array data, so
+ * decoding a memory-mapped save only touches the pages it reads. The
+ * buffer must outlive the decoder and the views it returned.
+ *
+ * All lengths are checked against the buffer, so truncated or hostile
+ * input fails with ERR_FILE_CORRUPT instead of reading out of bounds.
+ */
+class VariantDecoder {
+public:
+    VariantDecoder() {}
+
+    /**
+     * Validate the header and index the string table.
+     * @return OK, ERR_FILE_UNRECOGNIZED for a foreign or newer format, or
+     *         ERR_FILE_CORRUPT.
+     */
+    Error open(const uint8_t* p_data, size_t p_size);
+
+    bool is_at_end() const { return cursor >= end; }
+    /** @brief Tag of the next value, TAG_MAX at the end of the body. */
+    VariantBinary::Tag get_next_tag() const { return cursor < end && *cursor < VariantBinary::TAG_MAX ? VariantBinary::Tag(*cursor) : VariantBinary::TAG_MAX; }
+    uint16_t get_version() const { return version; }
+
+    /** @brief Read a scalar or string value. Containers give ERR_INVALID_DATA. */
+    Error read(Variant& r_value);
+    Error read_string(std::string_view& r_string);
+
+    Error read_array_begin(uint32_t& r_count);
+    Error read_dictionary_begin(uint32_t& r_count);
+    Error read_key(std::string_view& r_key);
+
+    /**
+     * View a packed array in place.
+     * @return OK, ERR_INVALID_DATA if the next value is not a packed array of
+     *         T, or ERR_UNAVAILABLE if the buffer itself is not aligned for T
+     *         or the host is big-endian. The value is not consumed then; use
+     *         the copying overload.
+     */
+    template <typename T>
+    Error read_packed(const T*& r_data, uint32_t& r_count);
+    template <typename T>
+    Error read_packed(std::vector<T>& r_values);
+    template <typename T>
+    Error read_packed(PackedArray<T>& r_array);
+
+    /** @brief Read an array of scalars. Nested containers give ERR_INVALID_DATA. */
+    Error read_array(std::vector<Variant>& r_array);
+    Error read_dictionary(Dictionary<Variant>& r_dictionary);
+
+    /** @brief Skip the next value, containers included. */
+    Error skip();
+
+private:
+    bool _get_varint(uint64_t& r_value);
+    bool _get_zigzag(int64_t& r_value);
+    bool _get_count(uint32_t& r_count);
+    bool _get_float(float& r_value);
+    Error _expect(VariantBinary::Tag p_tag);
+    Error _read_packed(VariantBinary::Tag p_tag, const uint8_t*& r_data, uint32_t& r_count);
+    Error _skip(int p_depth);
+
+    const uint8_t* data = nullptr;
+    const uint8_t* cursor = nullptr;
+    const uint8_t* end = nullptr;
+    std::vector<std::string_view> strings;
+    uint16_t version = 0;
+};
+
+template <typename T>
+Error VariantDecoder::read_packed(const T*& r_data, uint32_t& r_count) {
+    const uint8_t* start = cursor;
+    const uint8_t* raw;
+    Error err = _read_packed(VariantBinary::Packed<T>::TAG, raw, r_count);
+    if (err != OK) {
+        return err;
+    }
+    bool in_place = reinterpret_cast<uintptr_t>(raw) % alignof(T) == 0;
+#ifdef VARIANT_BINARY_BIG_ENDIAN
+    in_place = in_place && VariantBinary::get_packed_component_size(VariantBinary::Packed<T>::TAG) == 1;
+#endif
+    if (!in_place) {
+        cursor = start;
+        return ERR_UNAVAILABLE;
+    }
+    r_data = reinterpret_cast<const T*>(raw);
+    return OK;
+}
+
+template <typename T>
+Error VariantDecoder::read_packed(std::vector<T>& r_values) {
+    const uint8_t* raw;
+    uint32_t count;
+    Error err = _read_packed(VariantBinary::Packed<T>::TAG, raw, count);
+    if (err != OK) {
+        return err;
+    }
+    r_values.resize(count);
+    memcpy(static_cast<void*>(r_values.data()), raw, count * sizeof(T));
+#ifdef VARIANT_BINARY_BIG_ENDIAN
+    VariantBinary::swap_packed(VariantBinary::Packed<T>::TAG, r_values.data(), count);
+#endif
+    return OK;
+}
+
+template <typename T>
+Error VariantDecoder::read_packed(PackedArray<T>& r_array) {
+    const uint8_t* raw;
+    uint32_t count;
+    Error err = _read_packed(VariantBinary::Packed<T>::TAG, raw, count);
+    if (err != OK) {
+        return err;
+    }
+    PackedArray<T> result(count);
+    if (count) {
+        memcpy(static_cast<void*>(result.ptrw()), raw, count * sizeof(T));
+#ifdef VARIANT_BINARY_BIG_ENDIAN
+        VariantBinary::swap_packed(VariantBinary::Packed<T>::TAG, result.ptrw(), count);
+#endif
+    }
+    r_array = result;
+    return OK;
+}
+
+#endif // VARIANT_UTILS_H
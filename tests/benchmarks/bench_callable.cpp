@@ -0,0 +1,97 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "bench_utils.h"
+
+#include <functional>
+#include <vector>
+
+#include "core/variant/callable.h"
+#include "stubs/test_object.h"
+
+// Callable against std::function: building a bound callback, invoking it,
+// and copying a list of them the way a signal emission does.
+
+namespace {
+
+struct Target : public Object {
+    int64_t sum = 0;
+    void add(int64_t p_a, int64_t p_b) { sum += p_a + p_b; }
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const size_t count = bench_quick(argc, argv) ? 10000 : 1000000;
+    Target target;
+    int64_t sum = 0;
+    int64_t* sink = &sum;
+
+    std::vector<Callable> callables;
+    callables.reserve(count);
+    bench_run_batch("Callable create + bind(2)", 5, count, [&](uint64_t) {
+        callables.clear();
+        for (size_t i = 0; i < count; i++) {
+            callables.push_back(Callable::create<&Target::add>(&target).bind(int64_t(i), int64_t(1)));
+        }
+    });
+    std::vector<std::function<void()>> functions;
+    functions.reserve(count);
+    bench_run_batch("std::function capturing 4 values", 5, count, [&](uint64_t) {
+        functions.clear();
+        for (size_t i = 0; i < count; i++) {
+            Target* t = &target;
+            int64_t a = int64_t(i), b = 1, c = 0;
+            functions.push_back([t, a, b, c]() { t->add(a, b + c); });
+        }
+    });
+
+    bench_run_batch("Callable method call (2 bound)", 5, count, [&](uint64_t) {
+        for (size_t i = 0; i < count; i++) {
+            callables[i].call();
+        }
+    });
+    bench_run_batch("std::function call", 5, count, [&](uint64_t) {
+        for (size_t i = 0; i < count; i++) {
+            functions[i]();
+        }
+    });
+
+    Callable closure = Callable::from_closure([sink](int64_t p_value) { *sink += p_value; });
+    std::function<void(int64_t)> function = [sink](int64_t p_value) { *sink += p_value; };
+    bench_run("Callable closure call (1 arg)", count, [&](uint64_t i) { closure.call(int64_t(i)); });
+    bench_run("std::function call (1 arg)", count, [&](uint64_t i) { function(int64_t(i)); });
+
+    bench_run_batch("copy vector<Callable>", 5, count, [&](uint64_t) {
+        std::vector<Callable> copy = callables;
+        bench_keep(copy);
+    });
+    bench_run_batch("copy vector<std::function>", 5, count, [&](uint64_t) {
+        std::vector<std::function<void()>> copy = functions;
+        bench_keep(copy);
+    });
+
+    bench_keep(sum);
+    bench_keep(target.sum);
+    return target.sum != 0 ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "bench_utils.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "core/io/file_access.h"
+
+// Sequential reads of one large file, warm page cache: typed getters from
+// the buffer and from a mapping, against std::ifstream doing the same, plus
+// whole-file reads. 500 MB by default, 16 MB with --quick; pass a size in
+// MB to override.
+
+static void _report(const char* p_name, uint64_t p_bytes, double p_start) {
+    const double elapsed = bench_now() - p_start;
+    std::printf("%-48s %10.1f ms %10.1f MB/s\n", p_name, elapsed * 1e3, double(p_bytes) / (1024.0 * 1024.0) / elapsed);
+}
+
+int main(int argc, char** argv) {
+    uint64_t megabytes = bench_quick(argc, argv) ? 16 : 500;
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] != '-') {
+            megabytes = std::strtoull(argv[i], nullptr, 10);
+        }
+    }
+    const uint64_t size = megabytes * 1024 * 1024;
+    const std::string path = (std::filesystem::temp_directory_path() / ("patsher_bench_fa_" + std::to_string(getpid()) + ".bin")).string();
+
+    {
+        FileAccess out;
+        if (!out.open(path, FileAccess::WRITE)) {
+            std::printf("cannot write %s\n", path.c_str());
+            return 1;
+        }
+        std::vector<uint8_t> block(1024 * 1024);
+        for (size_t i = 0; i < block.size(); i++) {
+            block[i] = uint8_t(i * 131);
+        }
+        const double start = bench_now();
+        for (uint64_t written = 0; written < size; written += block.size()) {
+            out.store_buffer(reinterpret_cast<const char*>(block.data()), block.size());
+        }
+        out.close();
+        _report("write (store_buffer, 1 MB blocks)", size, start);
+    }
+
+    uint64_t sum = 0;
+    {
+        FileAccess in;
+        in.open(path, FileAccess::READ);
+        const double start = bench_now();
+        for (uint64_t i = 0; i < size / 4; i++) {
+            sum += in.get_32();
+        }
+        _report("get_32, buffered", size, start);
+    }
+    {
+        FileAccess in;
+        in.open(path, FileAccess::READ_MMAP);
+        const double start = bench_now();
+        for (uint64_t i = 0; i < size / 4; i++) {
+            sum += in.get_32();
+        }
+        _report("get_32, READ_MMAP", size, start);
+    }
+    {
+        std::ifstream in(path, std::ios::binary);
+        const double start = bench_now();
+        for (uint64_t i = 0; i < size / 4; i++) {
+            uint32_t value = 0;
+            in.read(reinterpret_cast<char*>(&value), 4);
+            sum += value;
+        }
+        _report("ifstream::read(4)", size, start);
+    }
+    {
+        FileAccess in;
+        in.open(path, FileAccess::READ);
+        std::string data;
+        const double start = bench_now();
+        in.read(data);
+        _report("read() whole file", data.size(), start);
+        sum += uint8_t(data[data.size() / 2]);
+    }
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::string data;
+        const uint64_t limit = std::min<uint64_t>(size, 64 * 1024 * 1024);
+        data.reserve(limit);
+        const double start = bench_now();
+        char c;
+        while (data.size() < limit && in.get(c)) {
+            data += c;
+        }
+        _report("ifstream::get() per char (first 64 MB)", data.size(), start);
+    }
+    {
+        FileAccess in;
+        in.open(path, FileAccess::READ_MMAP);
+        const double start = bench_now();
+        Span<const uint8_t> data = in.get_mapped_data();
+        for (size_t i = 0; i < data.size(); i += 4096) {
+            sum += data[i];
+        }
+        _report("READ_MMAP span, one byte per page", size, start);
+    }
+
+    bench_keep(sum);
+    std::filesystem::remove(path);
+    return 0;
+}
@@ -0,0 +1,136 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "bench_utils.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "core/io/file_system_memory.h"
+#include "core/io/file_system_pack.h"
+
+// read_file() cost per layer of the overlay: a file written to memory, one
+// served from a mounted pack, one read from a mounted directory and a miss.
+// All are 4 KB files, the disk ones from a warm page cache, so this is the
+// lookup and buffer cost each layer adds. Then overlay reads on several
+// threads against a writer, which only hold the shared lock.
+
+int main(int argc, char** argv) {
+    const bool quick = bench_quick(argc, argv);
+    const size_t file_count = quick ? 256 : 4096;
+    const uint64_t rounds = quick ? 4 : 50;
+    const std::string root = (std::filesystem::temp_directory_path() / ("patsher_bench_memfs_" + std::to_string(getpid()))).string();
+    const std::vector<uint8_t> content(4096, 'x');
+
+    std::vector<std::string> names;
+    PackWriter writer;
+    for (size_t i = 0; i < file_count; i++) {
+        names.push_back("set" + std::to_string(i % 32) + "/file_" + std::to_string(i) + ".bin");
+        writer.add_buffer(names.back(), content);
+        std::filesystem::create_directories(std::filesystem::path(root + "/disk/" + names.back()).parent_path());
+        std::ofstream(root + "/disk/" + names.back(), std::ios::binary).write(reinterpret_cast<const char*>(content.data()), content.size());
+    }
+    if (writer.save(root + "/data.pck") != OK) {
+        std::printf("cannot write %s/data.pck\n", root.c_str());
+        return 1;
+    }
+    FileSystemPack packs;
+    packs.mount(root + "/data.pck");
+
+    FileSystemMemory fs;
+    fs.mount_packs("pack://", &packs);
+    fs.mount_directory("disk://", root + "/disk");
+    std::vector<std::string> memory_paths, pack_paths, disk_paths, missing_paths;
+    for (const std::string& name : names) {
+        memory_paths.push_back("mem://" + name);
+        pack_paths.push_back("pack://" + name);
+        disk_paths.push_back("disk://" + name);
+        missing_paths.push_back("none://" + name);
+        fs.write_file(memory_paths.back(), content);
+    }
+    std::printf("%zu files of %zu bytes per layer\n", file_count, content.size());
+
+    uint64_t checksum = 0;
+    const auto read_all = [&](const std::vector<std::string>& p_paths) {
+        Ref<MemoryBuffer> buffer;
+        for (const std::string& path : p_paths) {
+            if (fs.read_file(path, buffer) == OK) {
+                checksum += buffer->get_data()[0];
+            }
+        }
+    };
+    bench_run_batch("read_file: overlay (memory)", rounds, file_count, [&](uint64_t) { read_all(memory_paths); });
+    bench_run_batch("read_file: pack mount (borrowed)", rounds, file_count, [&](uint64_t) { read_all(pack_paths); });
+    bench_run_batch("read_file: directory mount (disk)", rounds, file_count, [&](uint64_t) { read_all(disk_paths); });
+    bench_run_batch("read_file: miss", rounds, file_count, [&](uint64_t) { read_all(missing_paths); });
+    bench_run_batch("write_file: replace 4 KB", rounds, file_count, [&](uint64_t) {
+        for (const std::string& path : memory_paths) {
+            fs.write_file(path, content);
+        }
+    });
+    bench_run_batch("normalize_path", rounds, file_count, [&](uint64_t) {
+        for (const std::string& path : disk_paths) {
+            bench_keep(FileSystemMemory::normalize_path(path));
+        }
+    });
+
+    // Readers share the lock; one writer keeps replacing files under them.
+    const unsigned thread_count = std::max(2u, std::thread::hardware_concurrency());
+    const uint64_t reads_per_thread = uint64_t(file_count) * rounds;
+    const double start = bench_now();
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < thread_count; t++) {
+        threads.emplace_back([&, t]() {
+            Ref<MemoryBuffer> buffer;
+            uint64_t local = 0;
+            for (uint64_t i = 0; i < reads_per_thread; i++) {
+                const std::string& path = memory_paths[(i + t * 7) % file_count];
+                if (t == 0 && i % 16 == 0) {
+                    fs.write_file(path, content);
+                } else if (fs.read_file(path, buffer) == OK) {
+                    local += buffer->get_data()[0];
+                }
+            }
+            bench_keep(local);
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    const double elapsed = bench_now() - start;
+    std::printf("%-48s %10.2f ns/op\n", (std::to_string(thread_count) + " threads, 1/16 of thread 0 writing").c_str(),
+        elapsed * 1e9 / double(reads_per_thread * thread_count));
+
+    bench_keep(checksum);
+    fs.unmount("pack://");
+    packs.unmount_all();
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+    return 0;
+}
@@ -0,0 +1,141 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "bench_utils.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "core/io/file_access.h"
+#include "core/io/file_system_zip.h"
+#include "zip_writer.h"
+
+// Shipping assets zipped against unpacking them to disk once: the one-off
+// extract_all(), then loading every file back from the unpacked tree versus
+// straight from the archive (parallel read_files() and a ZipFileReader
+// stream). Throughput counts uncompressed bytes, warm page cache.
+
+static void _report(const char* p_name, uint64_t p_bytes, double p_start) {
+    const double elapsed = bench_now() - p_start;
+    std::printf("%-48s %10.1f ms %10.1f MB/s\n", p_name, elapsed * 1e3, double(p_bytes) / (1024.0 * 1024.0) / elapsed);
+}
+
+int main(int argc, char** argv) {
+    const bool quick = bench_quick(argc, argv);
+    const size_t file_count = quick ? 64 : 1000;
+    const size_t file_size = 128 * 1024;
+    const std::string root = (std::filesystem::temp_directory_path() / ("patsher_bench_zip_" + std::to_string(getpid()))).string();
+    const std::string zip_path = root + "/assets.zip";
+    const std::string unpacked = root + "/unpacked";
+    std::filesystem::create_directories(root);
+
+    // Text-like content: deflates about 2:1.
+    std::vector<std::string> paths;
+    ZipWriter writer;
+    uint32_t seed = 1;
+    for (size_t i = 0; i < file_count; i++) {
+        std::vector<uint8_t> content(file_size);
+        for (size_t b = 0; b < content.size(); b++) {
+            seed = seed * 1103515245 + 12345;
+            content[b] = uint8_t('a' + (seed >> 16) % 12);
+        }
+        paths.push_back("scenes/set" + std::to_string(i % 16) + "/scene_" + std::to_string(i) + ".tscn");
+        writer.add(paths.back(), content, true, 6);
+    }
+    const std::vector<uint8_t> archive = writer.finish();
+    std::ofstream(zip_path, std::ios::binary).write(reinterpret_cast<const char*>(archive.data()), archive.size());
+    const uint64_t total_bytes = uint64_t(file_count) * file_size;
+    std::printf("%zu files, %.1f MB, %.1f MB zipped, %u hardware threads\n", file_count, double(total_bytes) / (1024.0 * 1024.0),
+        double(archive.size()) / (1024.0 * 1024.0), std::thread::hardware_concurrency());
+
+    Ref<ZipArchive> zip;
+    zip.instantiate();
+    double start = bench_now();
+    if (zip->open(zip_path) != OK) {
+        std::printf("cannot open %s\n", zip_path.c_str());
+        return 1;
+    }
+    std::printf("%-48s %10.1f us\n", "zip: open + index", (bench_now() - start) * 1e6);
+
+    start = bench_now();
+    if (zip->extract_all(unpacked) != OK) {
+        std::printf("cannot extract to %s\n", unpacked.c_str());
+        return 1;
+    }
+    _report("unpack: extract_all to disk", total_bytes, start);
+
+    uint64_t checksum = 0;
+    uint64_t loaded = 0;
+    std::vector<uint8_t> scratch(file_size);
+    for (int pass = 0; pass < 2; pass++) { // the first pass warms the cache
+        loaded = 0;
+        start = bench_now();
+        for (const std::string& path : paths) {
+            FileAccess file;
+            if (file.open(unpacked + "/" + path, FileAccess::READ)) {
+                loaded += file.get_buffer(scratch.data(), scratch.size());
+                checksum += scratch[0];
+            }
+        }
+    }
+    _report("unpacked: open + read + close", loaded, start);
+
+    const int threads[] = { 1, 0 };
+    for (int thread_count : threads) {
+        std::vector<std::vector<uint8_t>> data;
+        start = bench_now();
+        if (zip->read_files(paths, data, thread_count) != OK) {
+            std::printf("read_files failed\n");
+            return 1;
+        }
+        _report(thread_count == 1 ? "zip: read_files, 1 thread" : "zip: read_files, all threads", total_bytes, start);
+        checksum += data.back()[0];
+    }
+
+    loaded = 0;
+    start = bench_now();
+    for (const std::string& path : paths) {
+        Ref<ZipFileReader> reader;
+        reader.instantiate();
+        if (reader->open(zip, path) != OK) {
+            continue;
+        }
+        size_t read;
+        while ((read = reader->get_buffer(scratch.data(), 16 * 1024)) > 0) {
+            loaded += read;
+        }
+        checksum += scratch[0];
+    }
+    _report("zip: ZipFileReader, 16 KB reads", loaded, start);
+    bench_keep(checksum);
+
+    zip->close();
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+    return loaded == total_bytes ? 0 : 1;
+}
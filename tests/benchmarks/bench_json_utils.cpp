@@ -0,0 +1,119 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "bench_utils.h"
+
+#include <string>
+
+#include "core/io/json_utils.h"
+
+// JSONDocument against thirdparty/libjson on the same records: parsing
+// alone, then parsing and reading every number. JSONDocument validates the
+// whole grammar, scalars included; libjson only tokenizes, so this is the
+// price of validation plus lazy decoding against an unchecked tree.
+
+extern "C" int bench_libjson_parse(const char* p_text);
+extern "C" double bench_libjson_sum(const char* p_text);
+
+static double _sum_numbers(const JSONValue& p_value) {
+    switch (p_value.get_type()) {
+        case JSONValue::TYPE_NUMBER:
+            return p_value.as_double();
+        case JSONValue::TYPE_ARRAY: {
+            double sum = 0.0;
+            for (JSONValue element : p_value.get_array()) {
+                sum += _sum_numbers(element);
+            }
+            return sum;
+        }
+        case JSONValue::TYPE_OBJECT: {
+            double sum = 0.0;
+            for (JSONValue::Field field : p_value.get_object()) {
+                sum += _sum_numbers(field.value);
+            }
+            return sum;
+        }
+        default:
+            return 0.0;
+    }
+}
+
+static void _report(const char* p_name, uint64_t p_bytes, uint64_t p_rounds, double p_seconds) {
+    std::printf("%-48s %10.2f ms %10.1f MB/s\n", p_name, p_seconds * 1e3 / double(p_rounds), double(p_bytes * p_rounds) / (1024.0 * 1024.0) / p_seconds);
+}
+
+template <class F>
+static double _best(uint64_t p_rounds, F&& p_body) {
+    double best = 1e30;
+    for (int attempt = 0; attempt < 3; attempt++) {
+        const double start = bench_now();
+        for (uint64_t i = 0; i < p_rounds; i++) {
+            p_body();
+        }
+        const double elapsed = bench_now() - start;
+        best = elapsed < best ? elapsed : best;
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    const bool quick = bench_quick(argc, argv);
+    const size_t records = quick ? 5000 : 200000;
+    const uint64_t rounds = quick ? 2 : 5;
+
+    std::string text = "[";
+    char buffer[256];
+    for (size_t i = 0; i < records; i++) {
+        snprintf(buffer, sizeof(buffer),
+            "%s{\"id\": %zu, \"name\": \"entity_%zu\", \"position\": [%.3f, %.3f, -%.2e], \"active\": %s, "
+            "\"parent\": null, \"tags\": [\"static\", \"prop\"]}",
+            i ? ",\n" : "", i, i, double(i) * 0.5, double(i % 977) / 7.0, double(i) * 1.5, i % 3 ? "true" : "false");
+        text += buffer;
+    }
+    text += "]";
+    std::printf("%zu records, %.1f MB\n", records, double(text.size()) / (1024.0 * 1024.0));
+
+    JSONDocument document;
+    bool ok = true;
+    double seconds = _best(rounds, [&]() { ok = ok && document.parse(text) == OK; });
+    _report("JSONDocument::parse", text.size(), rounds, seconds);
+    seconds = _best(rounds, [&]() { ok = ok && bench_libjson_parse(text.c_str()); });
+    _report("libjson json_parse + json_free", text.size(), rounds, seconds);
+
+    double ours = 0.0;
+    double theirs = 0.0;
+    seconds = _best(rounds, [&]() {
+        ok = ok && document.parse(text) == OK;
+        ours = _sum_numbers(document.get_root());
+    });
+    _report("JSONDocument: parse + read every number", text.size(), rounds, seconds);
+    seconds = _best(rounds, [&]() { theirs = bench_libjson_sum(text.c_str()); });
+    _report("libjson: parse + strtod every number", text.size(), rounds, seconds);
+
+    bench_keep(ours);
+    if (!ok || ours != theirs) {
+        std::printf("mismatch: %.17g vs %.17g\n", ours, theirs);
+        return 1;
+    }
+    return 0;
+}
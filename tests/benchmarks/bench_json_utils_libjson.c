@@ -0,0 +1,59 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+// thirdparty/libjson is C-only (it assigns from void*), so bench_json_utils
+// reaches it through these two functions.
+
+#include "libjson/json.h"
+
+#include <stdlib.h>
+
+// libjson stores every scalar as JSON_STRING pointing at its text.
+static double _sum_numbers(const json_t* p_value) {
+    double sum = 0.0;
+    for (; p_value; p_value = p_value->next) {
+        if (p_value->type == JSON_OBJECT || p_value->type == JSON_ARRAY) {
+            sum += _sum_numbers((const json_t*)p_value->value);
+        } else if (p_value->type == JSON_STRING && p_value->valsize > 0) {
+            const char c = *(const char*)p_value->value;
+            if (c == '-' || (c >= '0' && c <= '9')) {
+                sum += strtod((const char*)p_value->value, NULL);
+            }
+        }
+    }
+    return sum;
+}
+
+int bench_libjson_parse(const char* p_text) {
+    json_doc_t* document = json_parse(p_text, false);
+    const int ok = document && document->root;
+    json_free(document);
+    return ok;
+}
+
+double bench_libjson_sum(const char* p_text) {
+    json_doc_t* document = json_parse(p_text, false);
+    const double sum = document && document->root ? _sum_numbers(document->root) : 0.0;
+    json_free(document);
+    return sum;
+}
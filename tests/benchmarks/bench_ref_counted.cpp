@@ -0,0 +1,95 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "bench_utils.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "core/object/ref_counted.h"
+
+// Ref churn in container operations: copies pay a count round trip, moves
+// pay nothing, and RefCountedLocal pays no atomic. std::shared_ptr is the
+// reference point.
+
+namespace {
+
+struct Atomic : public RefCounted {
+    int value = 0;
+};
+
+struct Local : public RefCountedLocal {
+    int value = 0;
+};
+
+struct Plain {
+    int value = 0;
+};
+
+template <class R, class Make>
+void churn(const char* p_label, size_t p_count, Make p_make) {
+    std::vector<R> source;
+    source.reserve(p_count);
+    for (size_t i = 0; i < p_count; i++) {
+        source.push_back(p_make(int((i * 2654435761u) % p_count)));
+    }
+    char name[96];
+
+    std::snprintf(name, sizeof(name), "%s copy vector", p_label);
+    bench_run_batch(name, 20, p_count, [&](uint64_t) {
+        std::vector<R> copy = source;
+        bench_keep(copy);
+    });
+    std::snprintf(name, sizeof(name), "%s push_back with growth", p_label);
+    bench_run_batch(name, 20, p_count, [&](uint64_t) {
+        std::vector<R> grown;
+        for (const R& item : source) {
+            grown.push_back(item);
+        }
+        bench_keep(grown);
+    });
+    std::snprintf(name, sizeof(name), "%s sort", p_label);
+    bench_run_batch(name, 5, p_count, [&](uint64_t) {
+        std::vector<R> sorted = source;
+        std::sort(sorted.begin(), sorted.end(), [](const R& a, const R& b) { return a->value < b->value; });
+        bench_keep(sorted);
+    });
+    std::snprintf(name, sizeof(name), "%s erase front half", p_label);
+    bench_run_batch(name, 20, p_count, [&](uint64_t) {
+        std::vector<R> copy = source;
+        copy.erase(copy.begin(), copy.begin() + copy.size() / 2);
+        bench_keep(copy);
+    });
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const size_t count = bench_quick(argc, argv) ? 10000 : 1000000;
+    std::printf("Ref churn over %zu elements (ns per element)\n", count);
+    churn<Ref<Atomic>>("Ref<RefCounted>", count, [](int v) { Ref<Atomic> r; r.instantiate(); r->value = v; return r; });
+    churn<Ref<Local>>("Ref<RefCountedLocal>", count, [](int v) { Ref<Local> r; r.instantiate(); r->value = v; return r; });
+    churn<std::shared_ptr<Plain>>("std::shared_ptr", count, [](int v) { auto r = std::make_shared<Plain>(); r->value = v; return r; });
+    return 0;
+}
@@ -0,0 +1,87 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BENCH_UTILS_H
+#define BENCH_UTILS_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+/**
+ * Shared helpers for the benchmark executables. Each benchmark takes
+ * "--quick" to shrink its workload, which is how ctest runs it.
+ */
+inline bool bench_quick(int p_argc, char** p_argv) {
+    for (int i = 1; i < p_argc; i++) {
+        if (std::strcmp(p_argv[i], "--quick") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline double bench_now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/** Keeps the optimizer from dropping a computed value. */
+template <class T>
+inline void bench_keep(const T& p_value) {
+    asm volatile("" : : "r"(&p_value) : "memory");
+}
+
+/**
+ * Runs p_body(i) for p_batches iterations, best of three, and prints the
+ * time per item when each iteration handles p_items items.
+ */
+template <class F>
+inline double bench_run_batch(const char* p_name, uint64_t p_batches, uint64_t p_items, F&& p_body) {
+    double best = 1e30;
+    for (int round = 0; round < 3; round++) {
+        const double start = bench_now();
+        for (uint64_t i = 0; i < p_batches; i++) {
+            p_body(i);
+        }
+        const double elapsed = bench_now() - start;
+        best = elapsed < best ? elapsed : best;
+    }
+    const uint64_t items = p_batches * p_items;
+    const double ns = best * 1e9 / double(items != 0 ? items : 1);
+    std::printf("%-48s %10.2f ns/op\n", p_name, ns);
+    return ns;
+}
+
+/** Runs p_body(i) for p_count iterations and prints ns per iteration. */
+template <class F>
+inline double bench_run(const char* p_name, uint64_t p_count, F&& p_body) {
+    return bench_run_batch(p_name, p_count, 1, p_body);
+}
+
+/** Prints throughput for p_bytes processed in p_seconds. */
+inline void bench_report_throughput(const char* p_name, uint64_t p_bytes, double p_seconds) {
+    std::printf("%-48s %10.1f MB/s\n", p_name, double(p_bytes) / (1024.0 * 1024.0) / (p_seconds > 0 ? p_seconds : 1e-9));
+}
+
+#endif // BENCH_UTILS_H
@@ -0,0 +1,95 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "bench_utils.h"
+
+#include <string>
+#include <vector>
+
+#include "core/variant/variant.h"
+
+// Size of Variant and construction/copy/conversion throughput for inline
+// and shared types.
+
+int main(int argc, char** argv) {
+    const size_t count = bench_quick(argc, argv) ? 10000 : 1000000;
+    std::printf("sizeof(Variant) = %zu, alignof = %zu\n", sizeof(Variant), alignof(Variant));
+    std::printf("%zu values per batch\n", count);
+
+    std::vector<Variant> values;
+    values.reserve(count);
+    bench_run_batch("construct int into vector", 10, count, [&](uint64_t) {
+        values.clear();
+        for (size_t i = 0; i < count; i++) {
+            values.emplace_back(int64_t(i));
+        }
+    });
+    bench_run_batch("construct Vector2 into vector", 10, count, [&](uint64_t) {
+        values.clear();
+        for (size_t i = 0; i < count; i++) {
+            values.emplace_back(Vector2{ float(i), 1.0f });
+        }
+    });
+    bench_run_batch("construct Rect2i into vector", 10, count, [&](uint64_t) {
+        values.clear();
+        for (size_t i = 0; i < count; i++) {
+            values.emplace_back(Rect2i(int(i), 0, 16, 16));
+        }
+    });
+    bench_run_batch("construct Color into vector", 10, count, [&](uint64_t) {
+        values.clear();
+        for (size_t i = 0; i < count; i++) {
+            values.emplace_back(Color{ uint8_t(i), 0, 0, 255 });
+        }
+    });
+
+    std::vector<Variant> inline_source(count, Variant(Vector2{ 1.0f, 2.0f }));
+    bench_run_batch("copy inline (Vector2) vector", 10, count, [&](uint64_t) {
+        std::vector<Variant> copy = inline_source;
+        bench_keep(copy);
+    });
+    std::vector<Variant> string_source(count, Variant(std::string("a string too long for SSO")));
+    bench_run_batch("copy shared (String) vector", 10, count, [&](uint64_t) {
+        std::vector<Variant> copy = string_source;
+        bench_keep(copy);
+    });
+
+    std::vector<Variant> ints;
+    ints.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        ints.emplace_back(int64_t(i));
+    }
+    double sum = 0.0;
+    bench_run_batch("convert int -> double (jump table)", 10, count, [&](uint64_t) {
+        for (const Variant& value : ints) {
+            sum += value.operator double();
+        }
+    });
+    bench_run_batch("convert int -> Vector2 (none, fallback)", 10, count, [&](uint64_t) {
+        for (const Variant& value : ints) {
+            sum += value.operator Vector2().x;
+        }
+    });
+    bench_keep(sum);
+    return 0;
+}
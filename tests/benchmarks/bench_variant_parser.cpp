@@ -0,0 +1,102 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "bench_utils.h"
+
+#include <cstdio>
+#include <string>
+
+#include "core/variant/variant_parser.h"
+
+// Throughput of VariantParser over a generated scene, from memory and from
+// a mapped file.
+
+static std::string make_scene(size_t p_nodes) {
+    std::string text = "[gd_scene load_steps=2 format=3]\n\n[ext_resource type=\"Texture2D\" path=\"res://icon.png\" id=\"1\"]\n\n";
+    char buffer[512];
+    for (size_t i = 0; i < p_nodes; i++) {
+        snprintf(buffer, sizeof(buffer),
+                "[node name=\"Sprite%zu\" type=\"Sprite2D\" parent=\".\"]\n"
+                "position = Vector2(%zu.5, -%zu.25)\n"
+                "region_rect = Rect2i(0, 0, 32, %zu)\n"
+                "modulate = Color(1, 0.5, 0.25, 1)\n"
+                "texture = ExtResource(\"1\")\n"
+                "tags = [\"enemy\", \"layer_%zu\", %zu]\n"
+                "meta = {\"hp\": %zu, \"speed\": 1.5e2}\n\n",
+                i, i, i, i % 64, i % 8, i, i % 100);
+        text += buffer;
+    }
+    return text;
+}
+
+static size_t parse_all(VariantParser& p_parser) {
+    size_t events = 0;
+    VariantParser::Event event;
+    while (p_parser.next(event) == OK && event.type != VariantParser::EVENT_EOF) {
+        events++;
+    }
+    return events;
+}
+
+int main(int argc, char** argv) {
+    const size_t nodes = bench_quick(argc, argv) ? 5000 : 400000;
+    const std::string scene = make_scene(nodes);
+    std::printf("%zu nodes, %.1f MB\n", nodes, double(scene.size()) / (1024.0 * 1024.0));
+
+    size_t events = 0;
+    double best = 1e30;
+    for (int round = 0; round < 3; round++) {
+        VariantParser parser;
+        parser.open_buffer(scene.data(), scene.size());
+        const double start = bench_now();
+        events = parse_all(parser);
+        const double elapsed = bench_now() - start;
+        best = elapsed < best ? elapsed : best;
+    }
+    std::printf("%zu events, %.2f ns/event\n", events, best * 1e9 / double(events ? events : 1));
+    bench_report_throughput("parse from memory", scene.size(), best);
+
+    const std::string path = "bench_variant_parser.tscn";
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::printf("cannot write %s\n", path.c_str());
+        return 1;
+    }
+    std::fwrite(scene.data(), 1, scene.size(), file);
+    std::fclose(file);
+    best = 1e30;
+    for (int round = 0; round < 3; round++) {
+        const double start = bench_now();
+        VariantParser parser;
+        if (parser.open_file(path) != OK) {
+            std::printf("cannot map %s\n", path.c_str());
+            return 1;
+        }
+        bench_keep(parse_all(parser));
+        const double elapsed = bench_now() - start;
+        best = elapsed < best ? elapsed : best;
+    }
+    bench_report_throughput("open_file + parse", scene.size(), best);
+    std::remove(path.c_str());
+    return events > nodes * 20 ? 0 : 1;
+}
@@ -0,0 +1,220 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "bench_utils.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "core/variant/variant_parser.h"
+#include "core/variant/variant_utils.h"
+
+// Encodes and decodes the same records in the binary Variant format and as
+// text through VariantParser, to compare the two save paths.
+
+namespace {
+
+const int FIELD_COUNT = 6;
+
+struct Record {
+    int64_t id;
+    std::string name;
+    Vector2 position;
+    Rect2i region;
+    double speed;
+    bool visible;
+};
+
+std::vector<Record> make_records(size_t p_count) {
+    std::vector<Record> records(p_count);
+    for (size_t i = 0; i < p_count; i++) {
+        Record& record = records[i];
+        record.id = int64_t(i);
+        record.name = "Sprite" + std::to_string(i);
+        record.position = Vector2{ float(i) + 0.5f, -float(i % 1000) * 0.25f };
+        record.region = Rect2i(0, 0, 32, int(i % 64));
+        record.speed = 1.5 * double(i % 100);
+        record.visible = (i & 1) == 0;
+    }
+    return records;
+}
+
+void encode_binary(const std::vector<Record>& p_records, std::vector<uint8_t>& r_bytes) {
+    VariantEncoder encoder;
+    for (const Record& record : p_records) {
+        encoder.put_dictionary_begin(FIELD_COUNT);
+        encoder.put_key("id");
+        encoder.put(Variant(record.id));
+        encoder.put_key("name");
+        encoder.put_string(record.name);
+        encoder.put_key("position");
+        encoder.put(Variant(record.position));
+        encoder.put_key("region");
+        encoder.put(Variant(record.region));
+        encoder.put_key("speed");
+        encoder.put(Variant(record.speed));
+        encoder.put_key("visible");
+        encoder.put(Variant(record.visible));
+    }
+    r_bytes.clear();
+    encoder.finish(r_bytes);
+}
+
+void encode_text(const std::vector<Record>& p_records, std::string& r_text) {
+    r_text.clear();
+    char buffer[512];
+    for (const Record& record : p_records) {
+        snprintf(buffer, sizeof(buffer),
+                "[record]\n"
+                "id = %lld\n"
+                "name = \"%s\"\n"
+                "position = Vector2(%.9g, %.9g)\n"
+                "region = Rect2i(%d, %d, %d, %d)\n"
+                "speed = %.17g\n"
+                "visible = %s\n\n",
+                static_cast<long long>(record.id), record.name.c_str(), record.position.x, record.position.y,
+                record.region.x, record.region.y, record.region.width, record.region.height, record.speed,
+                record.visible ? "true" : "false");
+        r_text += buffer;
+    }
+}
+
+// Both decoders fold every record into this sum, so the benchmark can check
+// that the two paths read back the same data.
+double checksum(const Variant& p_value) {
+    switch (p_value.get_type()) {
+        case Variant::BOOL:
+            return p_value.operator bool() ? 1.0 : 0.0;
+        case Variant::INT:
+            return double(p_value.operator int64_t());
+        case Variant::FLOAT:
+            return p_value.operator double();
+        case Variant::VECTOR2: {
+            const Vector2 v = p_value;
+            return double(v.x) + double(v.y);
+        }
+        case Variant::RECT2I: {
+            const Rect2i r = p_value;
+            return double(r.x + r.y + r.width + r.height);
+        }
+        default:
+            return 0.0;
+    }
+}
+
+bool decode_binary(const std::vector<uint8_t>& p_bytes, size_t& r_records, double& r_sum) {
+    VariantDecoder decoder;
+    if (decoder.open(p_bytes.data(), p_bytes.size()) != OK) {
+        return false;
+    }
+    r_records = 0;
+    r_sum = 0.0;
+    while (!decoder.is_at_end()) {
+        uint32_t count = 0;
+        if (decoder.read_dictionary_begin(count) != OK) {
+            return false;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            std::string_view key;
+            Variant value;
+            if (decoder.read_key(key) != OK || decoder.read(value) != OK) {
+                return false;
+            }
+            r_sum += checksum(value) + double(key.size());
+        }
+        r_records++;
+    }
+    return true;
+}
+
+bool decode_text(const std::string& p_text, size_t& r_records, double& r_sum) {
+    VariantParser parser;
+    parser.open_buffer(p_text.data(), p_text.size());
+    r_records = 0;
+    r_sum = 0.0;
+    VariantParser::Event event;
+    while (true) {
+        if (parser.next(event) != OK) {
+            return false;
+        }
+        switch (event.type) {
+            case VariantParser::EVENT_EOF:
+                return true;
+            case VariantParser::EVENT_TAG_BEGIN:
+                r_records++;
+                break;
+            case VariantParser::EVENT_KEY:
+                r_sum += double(event.text.size());
+                break;
+            case VariantParser::EVENT_VALUE:
+                if (!event.is_string) {
+                    r_sum += checksum(event.value);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const size_t count = bench_quick(argc, argv) ? 5000 : 400000;
+    const std::vector<Record> records = make_records(count);
+
+    std::vector<uint8_t> bytes;
+    std::string text;
+    encode_binary(records, bytes);
+    encode_text(records, text);
+    std::printf("%zu records, binary %.1f MB, text %.1f MB\n", count, double(bytes.size()) / (1024.0 * 1024.0),
+            double(text.size()) / (1024.0 * 1024.0));
+
+    bench_run_batch("VariantEncoder: encode record", 1, count, [&](uint64_t) {
+        encode_binary(records, bytes);
+        bench_keep(bytes.size());
+    });
+    bench_run_batch("text: encode record", 1, count, [&](uint64_t) {
+        encode_text(records, text);
+        bench_keep(text.size());
+    });
+
+    size_t binary_records = 0;
+    size_t text_records = 0;
+    double binary_sum = 0.0;
+    double text_sum = 0.0;
+    bool ok = true;
+    bench_run_batch("VariantDecoder: decode record", 1, count, [&](uint64_t) {
+        ok = decode_binary(bytes, binary_records, binary_sum) && ok;
+    });
+    bench_run_batch("VariantParser: decode record", 1, count, [&](uint64_t) {
+        ok = decode_text(text, text_records, text_sum) && ok;
+    });
+
+    if (!ok || binary_records != count || text_records != count || binary_sum != text_sum) {
+        std::printf("decoders disagree: %zu/%zu records, sums %.17g/%.17g\n", binary_records, text_records, binary_sum, text_sum);
+        return 1;
+    }
+    return 0;
+}
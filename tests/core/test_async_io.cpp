@@ -0,0 +1,268 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "test_macros.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "core/io/async_io.h"
+
+namespace {
+
+std::string temp_file(const char* p_name) {
+    return (std::filesystem::temp_directory_path() / ("patsher_test_aio_" + std::to_string(getpid()) + "_" + p_name)).string();
+}
+
+std::vector<uint8_t> write_pattern(const std::string& p_path, size_t p_size) {
+    std::vector<uint8_t> data(p_size);
+    for (size_t i = 0; i < p_size; i++) {
+        data[i] = static_cast<uint8_t>(i * 7 + (i >> 8));
+    }
+    std::ofstream(p_path, std::ios::binary).write(reinterpret_cast<const char*>(data.data()), data.size());
+    return data;
+}
+
+// True once a thread of this process sleeps in open() on a FIFO.
+bool fifo_open_pending() {
+    for (const std::filesystem::directory_entry& task : std::filesystem::directory_iterator("/proc/self/task")) {
+        std::string wchan;
+        std::ifstream(task.path() / "wchan") >> wchan;
+        if (wchan == "wait_for_partner") {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Holds the single I/O thread of either backend: both open the file on
+// that thread, and opening a FIFO for reading blocks until a writer shows
+// up. Everything queued before release() is waiting in the queues when the
+// thread comes back, so coalescing and priorities are deterministic.
+struct Gate {
+    std::string path = temp_file("gate");
+    Ref<AsyncRequest> request;
+
+    explicit Gate(AsyncIO& p_io) {
+        std::filesystem::remove(path);
+        mkfifo(path.c_str(), 0600);
+        request = p_io.read(path, 0, 1, nullptr, AsyncIO::PRIORITY_HIGH);
+        // Wait for the I/O thread to take it, so the gate is in flight.
+        for (int i = 0; i < 2000 && !fifo_open_pending(); i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    ~Gate() { std::filesystem::remove(path); }
+
+    void release() {
+        int fd = ::open(path.c_str(), O_WRONLY);
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+};
+
+// Runs p_test on the thread pool, forced through PATSHER_ASYNC_IO the way
+// a user would, then on io_uring when the kernel allows it.
+void for_each_backend(const std::function<void(AsyncIO&)>& p_test) {
+    setenv("PATSHER_ASYNC_IO", "threads", 1);
+    {
+        AsyncIO io(AsyncIO::BACKEND_IO_URING, 1);
+        CHECK(io.get_backend() == AsyncIO::BACKEND_THREAD_POOL);
+        p_test(io);
+    }
+    unsetenv("PATSHER_ASYNC_IO");
+    AsyncIO io(AsyncIO::BACKEND_IO_URING, 1);
+    if (io.get_backend() == AsyncIO::BACKEND_IO_URING) {
+        p_test(io);
+    } else {
+        std::printf("  io_uring unavailable, thread pool only\n");
+    }
+}
+
+} // namespace
+
+TEST_CASE(async_io_adjacent_reads_are_coalesced) {
+    const std::string path = temp_file("coalesce");
+    const std::vector<uint8_t> data = write_pattern(path, 64 * 1024);
+    for_each_backend([&](AsyncIO& io) {
+        const AsyncIO::Stats before = io.get_stats();
+        std::vector<Ref<AsyncRequest>> reads;
+        {
+            Gate gate(io);
+            // Out of order, so the merge has to grow in both directions.
+            for (int i : { 5, 4, 6, 0, 1, 2, 3, 7, 15, 8, 9, 10, 14, 11, 12, 13 }) {
+                reads.push_back(io.read(path, i * 4096, 4096));
+            }
+            gate.release();
+            gate.request->wait();
+        }
+        bool all_match = true;
+        for (const Ref<AsyncRequest>& request : reads) {
+            CHECK(request->wait() == OK);
+            const std::vector<uint8_t>& got = request->get_data();
+            all_match = all_match && got.size() == 4096 &&
+                    std::equal(got.begin(), got.end(), data.begin() + request->get_offset());
+        }
+        CHECK(all_match);
+        const AsyncIO::Stats after = io.get_stats();
+        CHECK(after.coalesced - before.coalesced == 15);
+        // The gate and one read for the whole span.
+        CHECK(after.operations - before.operations == 2);
+    });
+    std::filesystem::remove(path);
+}
+
+TEST_CASE(async_io_short_read_at_eof) {
+    const std::string path = temp_file("eof");
+    const std::vector<uint8_t> data = write_pattern(path, 1000);
+    for_each_backend([&](AsyncIO& io) {
+        Ref<AsyncRequest> tail = io.read(path, 900, 500);
+        Ref<AsyncRequest> past = io.read(path, 2000, 10);
+        Ref<AsyncRequest> missing = io.read(temp_file("missing"), 0, 10);
+        CHECK(tail->wait() == OK);
+        CHECK(tail->get_bytes_transferred() == 100);
+        CHECK(tail->get_data().size() == 100);
+        CHECK(std::equal(tail->get_data().begin(), tail->get_data().end(), data.begin() + 900));
+        CHECK(past->wait() == OK);
+        CHECK(past->get_bytes_transferred() == 0);
+        CHECK(missing->wait() == ERR_FILE_NOT_FOUND);
+    });
+    std::filesystem::remove(path);
+}
+
+TEST_CASE(async_io_cancel_queued_and_in_flight) {
+    const std::string path = temp_file("cancel");
+    write_pattern(path, 8192);
+    for_each_backend([&](AsyncIO& io) {
+        int callbacks = 0;
+        Gate gate(io);
+        Ref<AsyncRequest> queued = io.read(path, 0, 4096, [&callbacks](AsyncRequest& p_request) {
+            callbacks += p_request.is_canceled() ? 1 : 100;
+        });
+        // Queued: dropped at once, the file is never touched.
+        CHECK(queued->cancel());
+        CHECK(queued->is_canceled());
+        CHECK(!queued->cancel());
+
+        // In flight: the backend still runs it but completes it as canceled.
+        CHECK(gate.request->cancel());
+        CHECK(!gate.request->is_done());
+        gate.release();
+        gate.request->wait();
+        CHECK(gate.request->is_canceled());
+        CHECK(gate.request->get_data().empty());
+
+        CHECK(io.poll() == 1);
+        CHECK(callbacks == 1);
+    });
+    std::filesystem::remove(path);
+}
+
+TEST_CASE(async_io_priority_order) {
+    const std::string paths[3] = { temp_file("prio_low"), temp_file("prio_normal"), temp_file("prio_high") };
+    for (const std::string& path : paths) {
+        write_pattern(path, 4096);
+    }
+    for_each_backend([&](AsyncIO& io) {
+        std::vector<int> order;
+        std::vector<Ref<AsyncRequest>> reads;
+        {
+            Gate gate(io);
+            const AsyncIO::Priority priorities[3] = { AsyncIO::PRIORITY_LOW, AsyncIO::PRIORITY_NORMAL, AsyncIO::PRIORITY_HIGH };
+            for (int i = 0; i < 3; i++) {
+                reads.push_back(io.read(paths[i], 0, 4096, [&order, i](AsyncRequest&) { order.push_back(i); }, priorities[i]));
+            }
+            gate.release();
+            gate.request->wait();
+        }
+        for (const Ref<AsyncRequest>& request : reads) {
+            CHECK(request->wait() == OK);
+        }
+        CHECK(io.poll() == 3);
+        REQUIRE(order.size() == 3);
+        // One pool thread runs them one by one, in priority order. The ring
+        // pops them in that order too, but all three are in flight at once
+        // and may complete in any order.
+        if (io.get_backend() == AsyncIO::BACKEND_THREAD_POOL) {
+            CHECK((order == std::vector<int>{ 2, 1, 0 }));
+        }
+    });
+    for (const std::string& path : paths) {
+        std::filesystem::remove(path);
+    }
+}
+
+TEST_CASE(async_io_destructor_drops_queued_requests) {
+    const std::string path = temp_file("dtor");
+    write_pattern(path, 4096);
+    for (int pass = 0; pass < 2; pass++) {
+        if (pass == 0) {
+            setenv("PATSHER_ASYNC_IO", "threads", 1);
+        } else {
+            unsetenv("PATSHER_ASYNC_IO");
+        }
+        std::vector<Ref<AsyncRequest>> reads;
+        int callbacks = 0;
+        std::thread releaser;
+        {
+            std::unique_ptr<AsyncIO> io(new AsyncIO(AsyncIO::BACKEND_IO_URING, 1));
+            Gate gate(*io);
+            for (int i = 0; i < 8; i++) {
+                reads.push_back(io->read(path, 0, 4096, [&callbacks](AsyncRequest&) { callbacks++; }, AsyncIO::PRIORITY_LOW));
+            }
+            // The destructor cancels the queued reads, then waits for the
+            // I/O thread, which is still held by the gate.
+            releaser = std::thread([&reads, &gate] {
+                while (!reads.back()->is_done()) {
+                    std::this_thread::yield();
+                }
+                gate.release();
+            });
+            io.reset();
+            releaser.join();
+        }
+        bool all_canceled = true;
+        for (const Ref<AsyncRequest>& request : reads) {
+            all_canceled = all_canceled && request->is_canceled();
+            // The owner is gone; wait() must not touch it.
+            request->wait();
+        }
+        CHECK(all_canceled);
+        CHECK(callbacks == 0);
+    }
+    unsetenv("PATSHER_ASYNC_IO");
+    std::filesystem::remove(path);
+}
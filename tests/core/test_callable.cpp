@@ -0,0 +1,127 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "test_macros.h"
+
+#include <string>
+#include <unordered_map>
+
+#include "core/variant/callable.h"
+#include "stubs/test_object.h"
+
+namespace {
+
+struct Player : public Object {
+    int64_t health = 100;
+    void take_damage(int64_t p_amount) { health -= p_amount; }
+    int64_t get_health() const { return health; }
+};
+
+// Captures whose bytes are not their value: a float and a padded layout.
+struct Scale {
+    float factor;
+    char tag;
+    double operator()(double p_value) const { return p_value * factor; }
+    bool operator==(const Scale& p_other) const { return factor == p_other.factor; }
+};
+
+} // namespace
+
+TEST_CASE(callable_method_and_bind) {
+    Player* player = new Player;
+    Callable hit = Callable::create<&Player::take_damage>(player);
+    CHECK(hit.get_argument_count() == 1);
+    hit.call(int64_t(30));
+    CHECK(player->health == 70);
+
+    Callable hit_ten = hit.bind(int64_t(10));
+    CHECK(hit_ten.get_argument_count() == 0);
+    hit_ten.call();
+    CHECK(player->health == 60);
+
+    // The unbound tail is dropped before the bound arguments are appended.
+    Callable on_signal = hit_ten.unbind(2);
+    on_signal.call(std::string("sender"), 3.5);
+    CHECK(player->health == 50);
+
+    CHECK(int64_t(Callable::create<&Player::get_health>(player).call()) == 50);
+
+    delete player;
+    CHECK(!hit.is_valid());
+    Variant ret;
+    const Variant amount(int64_t(1));
+    const Variant* args[] = { &amount };
+    CHECK(hit.callp(args, 1, ret) == ERR_DOES_NOT_EXIST);
+    CHECK(hit.callp(args, 0, ret) == ERR_INVALID_PARAMETER);
+    CHECK(Callable().callp(args, 0, ret) == ERR_UNCONFIGURED);
+}
+
+TEST_CASE(callable_closures) {
+    int64_t total = 0;
+    int64_t* sink = &total;
+    Callable add = Callable::from_closure([sink](int64_t p_value) { *sink += p_value; });
+    add.call(int64_t(5));
+    add.bind(int64_t(7)).call();
+    CHECK(total == 12);
+
+    Callable scale = Callable::from_closure(Scale{ 2.0f, 'a' });
+    CHECK(double(scale.call(1.5)) == 3.0);
+
+    Object* owner = new Object;
+    Callable owned = Callable::from_closure([]() { return int64_t(1); }, owner);
+    CHECK(owned.is_valid());
+    delete owner;
+    CHECK(!owned.is_valid());
+}
+
+TEST_CASE(callable_equality_and_hash) {
+    Player player;
+    Callable a = Callable::create<&Player::take_damage>(&player).bind(int64_t(10));
+    Callable b = Callable::create<&Player::take_damage>(&player).bind(int64_t(10));
+    Callable c = Callable::create<&Player::take_damage>(&player).bind(int64_t(11));
+    CHECK(a == b);
+    CHECK(a.hash() == b.hash());
+    CHECK(a != c);
+
+    int x = 1, y = 2;
+    auto make = [](int* p_target) { return Callable::from_closure([p_target]() { return int64_t(*p_target); }); };
+    CHECK(make(&x) == make(&x));
+    CHECK(make(&x).hash() == make(&x).hash());
+    CHECK(make(&x) != make(&y));
+
+    // Equal by operator== although the padding byte and tag differ.
+    Scale s1{ 2.0f, 'a' };
+    Scale s2{ 2.0f, 'b' };
+    memset(static_cast<void*>(&s2), 0xFF, sizeof(s2));
+    s2.factor = 2.0f;
+    s2.tag = 'b';
+    CHECK(Callable::from_closure(s1) == Callable::from_closure(s2));
+    CHECK(Callable::from_closure(s1).hash() == Callable::from_closure(s2).hash());
+    CHECK(Callable::from_closure(s1) != Callable::from_closure(Scale{ 3.0f, 'a' }));
+
+    std::unordered_map<Callable, int> connections;
+    connections[a] = 1;
+    connections[make(&x)] = 2;
+    CHECK(connections.count(b) == 1);
+    CHECK(connections[make(&x)] == 2);
+}
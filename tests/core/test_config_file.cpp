@@ -0,0 +1,265 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "test_macros.h"
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <unistd.h>
+
+#include "core/io/config_file.h"
+
+namespace {
+
+const char* SETTINGS =
+        "[display]\n"
+        "width = 1280\n"
+        "title = \"My Game\"\n"
+        "driver = opengl3\n";
+
+// CacheHeader in config_file.cpp: magic, version, source size, then mtime.
+const size_t CACHE_MTIME_OFFSET = 16;
+
+std::string temp_dir(const char* p_name) {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / ("patsher_test_config_" + std::to_string(getpid()) + "_" + p_name);
+    std::filesystem::remove_all(path);
+    std::filesystem::create_directories(path);
+    return path.string();
+}
+
+void write_file(const std::string& p_path, const std::string& p_data) {
+    std::ofstream(p_path, std::ios::binary | std::ios::trunc).write(p_data.data(), p_data.size());
+}
+
+std::string read_file(const std::string& p_path) {
+    std::ifstream in(p_path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void shift_mtime(const std::string& p_path, int p_seconds) {
+    std::filesystem::last_write_time(p_path, std::filesystem::last_write_time(p_path) + std::chrono::seconds(p_seconds));
+}
+
+int64_t cached_mtime(const std::string& p_path) {
+    const std::string cache = read_file(ConfigFile::get_cache_path(p_path));
+    int64_t mtime = 0;
+    if (cache.size() >= ConfigFile::CACHE_HEADER_SIZE) {
+        memcpy(&mtime, cache.data() + CACHE_MTIME_OFFSET, sizeof(mtime));
+    }
+    return mtime;
+}
+
+int64_t source_mtime(const std::string& p_path) {
+    return static_cast<int64_t>(std::filesystem::last_write_time(p_path).time_since_epoch().count());
+}
+
+std::string get_string(const ConfigFile& p_config, const char* p_section, const char* p_key) {
+    const Variant* value = p_config.get_value_ptr(p_section, p_key);
+    return value && value->get_type() == Variant::STRING ? *value->get_string_ptr() : std::string("<not a string>");
+}
+
+int64_t get_int(const ConfigFile& p_config, const char* p_section, const char* p_key) {
+    const Variant* value = p_config.get_value_ptr(p_section, p_key);
+    return value && value->get_type() == Variant::INT ? value->operator int64_t() : -1;
+}
+
+} // namespace
+
+TEST_CASE(config_file_cache_paths) {
+    const std::string dir = temp_dir("cache");
+    const std::string path = dir + "/settings.cfg";
+    const std::string cache = ConfigFile::get_cache_path(path);
+    CHECK(cache == dir + "/.settings.cfg.cache");
+    write_file(path, SETTINGS);
+
+    // First load parses and writes the cache.
+    ConfigFile config;
+    REQUIRE(config.load_cached(path) == OK);
+    CHECK(!config.is_from_cache());
+    CHECK(std::filesystem::exists(cache));
+    CHECK(!std::filesystem::exists(cache + ".tmp"));
+    CHECK(get_int(config, "display", "width") == 1280);
+
+    // Size and mtime match: served from the cache, the source is not read.
+    // Same size, new text, old mtime: the old values still come back.
+    ConfigFile cached;
+    REQUIRE(cached.load_cached(path) == OK);
+    CHECK(cached.is_from_cache());
+    CHECK(get_int(cached, "display", "width") == 1280);
+    CHECK(get_string(cached, "display", "title") == "My Game");
+    CHECK(get_string(cached, "display", "driver") == "opengl3");
+    const auto original_time = std::filesystem::last_write_time(path);
+    std::string same_size = SETTINGS;
+    same_size.replace(same_size.find("1280"), 4, "1920");
+    write_file(path, same_size);
+    std::filesystem::last_write_time(path, original_time);
+    REQUIRE(cached.load_cached(path) == OK);
+    CHECK(cached.is_from_cache());
+    CHECK(get_int(cached, "display", "width") == 1280);
+
+    // Only the mtime changed: the content hash matches, the cache is used
+    // and its mtime brought up to date.
+    write_file(path, SETTINGS);
+    shift_mtime(path, 10);
+    REQUIRE(cached.load_cached(path) == OK);
+    CHECK(cached.is_from_cache());
+    CHECK(cached_mtime(path) == source_mtime(path));
+
+    // Content changed at the same size: parsed again, cache rewritten.
+    write_file(path, same_size);
+    shift_mtime(path, 20);
+    REQUIRE(cached.load_cached(path) == OK);
+    CHECK(!cached.is_from_cache());
+    CHECK(get_int(cached, "display", "width") == 1920);
+    CHECK(cached_mtime(path) == source_mtime(path));
+    REQUIRE(cached.load_cached(path) == OK);
+    CHECK(cached.is_from_cache());
+    CHECK(get_int(cached, "display", "width") == 1920);
+
+    // Content and size changed.
+    write_file(path, std::string(SETTINGS) + "[audio]\nvolume = 0.5\n");
+    REQUIRE(cached.load_cached(path) == OK);
+    CHECK(!cached.is_from_cache());
+    CHECK(get_int(cached, "display", "width") == 1280);
+    CHECK(cached.has_section("audio"));
+
+    // A bad source loads nothing and leaves no cache behind.
+    write_file(path, "[display\n");
+    std::filesystem::remove(cache);
+    CHECK(cached.load_cached(path) == ERR_PARSE_ERROR);
+    CHECK(!std::filesystem::exists(cache));
+    CHECK(cached.load_cached(dir + "/missing.cfg") == ERR_FILE_NOT_FOUND);
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE(config_file_damaged_cache) {
+    const std::string dir = temp_dir("damaged");
+    const std::string path = dir + "/settings.cfg";
+    const std::string cache = ConfigFile::get_cache_path(path);
+    write_file(path, SETTINGS);
+    ConfigFile config;
+    REQUIRE(config.load_cached(path) == OK);
+    const std::string good = read_file(cache);
+    REQUIRE(good.size() > ConfigFile::CACHE_HEADER_SIZE);
+
+    std::string bad_magic = good;
+    bad_magic[0] ^= 0xFF;
+    std::string bad_payload = good;
+    for (size_t i = ConfigFile::CACHE_HEADER_SIZE; i < bad_payload.size(); i++) {
+        bad_payload[i] = static_cast<char>(0xEE);
+    }
+    // The header claims more payload than the file has.
+    std::string short_payload = good.substr(0, good.size() - 4);
+    const std::string damaged[] = { good.substr(0, 20), bad_magic, bad_payload, short_payload, std::string() };
+
+    for (const std::string& data : damaged) {
+        write_file(cache, data);
+        ConfigFile loaded;
+        REQUIRE(loaded.load_cached(path) == OK);
+        CHECK(!loaded.is_from_cache());
+        CHECK(get_int(loaded, "display", "width") == 1280);
+        CHECK(get_string(loaded, "display", "driver") == "opengl3");
+        CHECK(loaded.get_sections().size() == 1);
+        // Rewritten, and trusted again.
+        CHECK(read_file(cache) == good);
+        REQUIRE(loaded.load_cached(path) == OK);
+        CHECK(loaded.is_from_cache());
+    }
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE(config_file_comments) {
+    const char* text =
+            "; leading comment\n"
+            "# another\n"
+            "top = 1\n"
+            "[style]\n"
+            "   ; indented comment\n"
+            "width = 1280 ; trailing\n"
+            "color = #fff\n"
+            "list = a;b\n"
+            "driver = opengl3 ; default\n"
+            "hash = opengl3 # default\n"
+            "name = \"a ; b # c\" ; real comment\n";
+    ConfigFile config;
+    REQUIRE(config.parse(text) == OK);
+    CHECK(get_int(config, "", "top") == 1);
+    CHECK((config.get_section_keys("style") == std::vector<std::string>{ "width", "color", "list", "driver", "hash", "name" }));
+    CHECK(get_int(config, "style", "width") == 1280);
+    CHECK(get_string(config, "style", "color") == "#fff");
+    CHECK(get_string(config, "style", "list") == "a;b");
+    CHECK(get_string(config, "style", "driver") == "opengl3");
+    CHECK(get_string(config, "style", "hash") == "opengl3");
+    CHECK(get_string(config, "style", "name") == "a ; b # c");
+}
+
+TEST_CASE(config_file_multi_line_values) {
+    const char* text =
+            "[data]\n"
+            "items = [1, 2, ; first two\n"
+            "    3] ; done\n"
+            "size = Vector2i(1280,\n"
+            "    720)\n"
+            "text = \"line one\n"
+            "line two ; still text\"\n"
+            "map = {\n"
+            "    \"a\": \"]\", # bracket in a string\n"
+            "    \"b\": [1, 2]\n"
+            "}\n"
+            "after = 7\n";
+    ConfigFile config;
+    REQUIRE(config.parse(text) == OK);
+    CHECK(get_string(config, "data", "items") == "[1, 2,\n    3]");
+    const Variant* size = config.get_value_ptr("data", "size");
+    REQUIRE(size && size->get_type() == Variant::VECTOR2I);
+    Vector2i v = *size;
+    CHECK(v.x == 1280 && v.y == 720);
+    CHECK(get_string(config, "data", "text") == "line one\nline two ; still text");
+    CHECK(get_string(config, "data", "map") == "{\n    \"a\": \"]\",\n    \"b\": [1, 2]\n}");
+    CHECK(get_int(config, "data", "after") == 7);
+
+    // Saved verbatim and read back the same.
+    const std::string dir = temp_dir("multi_line");
+    const std::string path = dir + "/data.cfg";
+    REQUIRE(config.save(path) == OK);
+    ConfigFile reloaded;
+    REQUIRE(reloaded.load(path) == OK);
+    CHECK(get_string(reloaded, "data", "items") == get_string(config, "data", "items"));
+    CHECK(get_string(reloaded, "data", "map") == get_string(config, "data", "map"));
+    CHECK(get_string(reloaded, "data", "text") == "line one\nline two ; still text");
+    std::filesystem::remove_all(dir);
+
+    // A bare value ends with its line even with an open bracket.
+    REQUIRE(config.parse("a = 1(\nb = 2\n") == OK);
+    CHECK(get_int(config, "", "b") == 2);
+
+    // Unterminated values report the line they start on.
+    CHECK(config.parse("x = 1\ny = [1,\n2\n") == ERR_PARSE_ERROR);
+    CHECK(config.get_error_line() == 2);
+    CHECK(config.parse("s = \"open\nstill open\n") == ERR_PARSE_ERROR);
+    CHECK(config.get_error_line() == 1);
+}
@@ -0,0 +1,167 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "test_macros.h"
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "core/variant/dictionary.h"
+
+namespace {
+
+std::vector<std::string> order(const Dictionary<int>& p_dictionary) {
+    std::vector<std::string> keys;
+    for (const Dictionary<int>::Entry& entry : p_dictionary) {
+        keys.push_back(entry.key);
+    }
+    return keys;
+}
+
+} // namespace
+
+TEST_CASE(dictionary_keeps_insertion_order) {
+    Dictionary<int> d;
+    const char* names[] = { "zeta", "alpha", "mid", "beta", "omega" };
+    for (int i = 0; i < 5; i++) {
+        d.insert(names[i], i);
+    }
+    d.insert("alpha", 10); // An overwrite keeps the position.
+    CHECK(order(d) == (std::vector<std::string>{ "zeta", "alpha", "mid", "beta", "omega" }));
+    CHECK(d.get("alpha") == 10);
+    CHECK(d.get_key_at_index(3) == "beta");
+    CHECK(d.get_value_at_index(4) == 4);
+    CHECK(d.find_index("mid") == 2);
+    CHECK(d.find_index("missing") == -1);
+
+    // Enough keys to widen the index from 1 to 2 and 4 byte slots.
+    Dictionary<int> big;
+    for (int i = 0; i < 70000; i++) {
+        big.insert("k" + std::to_string(i), i);
+    }
+    bool ordered = true;
+    int expected = 0;
+    for (const Dictionary<int>::Entry& entry : big) {
+        ordered = ordered && entry.value == expected++;
+    }
+    CHECK(ordered);
+    CHECK(big.size() == 70000);
+    CHECK(big.get("k65535") == 65535);
+}
+
+TEST_CASE(dictionary_erase_and_reinsert) {
+    Dictionary<int> d;
+    for (int i = 0; i < 10; i++) {
+        d.insert("k" + std::to_string(i), i);
+    }
+    d.erase("k3");
+    d.erase("k0");
+    CHECK(d.size() == 8);
+    CHECK(!d.contains("k3"));
+    CHECK(d.get("k4") == 4); // Found past the tombstones.
+    CHECK(d.get_key_at_index(0) == "k1");
+    CHECK(d.get_key_at_index(2) == "k4");
+    CHECK(d.find_index("k9") == 7);
+    bool threw = false;
+    try {
+        d.erase("k3");
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    CHECK(threw);
+
+    // A reinserted key goes to the end.
+    d.insert("k3", 33);
+    CHECK(order(d) == (std::vector<std::string>{ "k1", "k2", "k4", "k5", "k6", "k7", "k8", "k9", "k3" }));
+    CHECK(d.get_value_at_index(8) == 33);
+
+    // Erasing most keys compacts; the rest stay in order and findable.
+    for (int i = 1; i < 9; i++) {
+        d.erase("k" + std::to_string(i));
+    }
+    CHECK(order(d) == (std::vector<std::string>{ "k9" }));
+    CHECK(d.get("k9") == 9);
+}
+
+TEST_CASE(dictionary_erase_is_constant_time) {
+    // The scratch case from review: erasing a third of 100k keys one by one.
+    Dictionary<int> d;
+    for (int i = 0; i < 100000; i++) {
+        d.insert("key_" + std::to_string(i), i);
+    }
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 100000; i += 3) {
+        d.erase("key_" + std::to_string(i));
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    CHECK(seconds < 1.0);
+    CHECK(d.size() == 66666);
+    bool all = true;
+    for (int i = 0; i < 100000; i++) {
+        all = all && d.contains("key_" + std::to_string(i)) == (i % 3 != 0);
+    }
+    CHECK(all);
+    CHECK(d.get_key_at_index(0) == "key_1");
+    CHECK(d.get_key_at_index(66665) == "key_99998");
+}
+
+TEST_CASE(dictionary_copy_on_write_isolation) {
+    Dictionary<int> d{ { "a", 1 }, { "b", 2 } };
+    Dictionary<int> copy = d;
+    d.insert("a", 5);
+    d.erase("b");
+    CHECK(copy.get("a") == 1);
+    CHECK(copy.contains("b"));
+
+    // A reference taken first, a copy after: the copy must not alias it.
+    int& r = d.get("a");
+    Dictionary<int> g = d;
+    r = 99;
+    CHECK(d.get("a") == 99);
+    CHECK(g.get("a") == 5);
+
+    // The same through getptr(), operator[] and assignment.
+    int* p = d.getptr("a");
+    Dictionary<int> h;
+    h = d;
+    *p = 7;
+    CHECK(h.get("a") == 99);
+    int& slot = d["new"];
+    Dictionary<int> i = d.duplicate();
+    slot = 3;
+    CHECK(d.get("new") == 3);
+    CHECK(i.get("new") == 0);
+
+    // A copy taken first, then a reference: writing unshares.
+    Dictionary<int> j = d;
+    j.get("a") = -1;
+    CHECK(d.get("a") == 7);
+    CHECK(j.get("a") == -1);
+
+    // Read-only access keeps the storage shared and unaffected.
+    const Dictionary<int>& view = d;
+    Dictionary<int> k = view;
+    CHECK(k == d);
+}
@@ -0,0 +1,139 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "test_macros.h"
+
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+#include <unistd.h>
+
+#include "core/io/file_access.h"
+
+namespace {
+
+std::string temp_file(const char* p_name) {
+    return (std::filesystem::temp_directory_path() / ("patsher_test_fa_" + std::to_string(getpid()) + "_" + p_name)).string();
+}
+
+} // namespace
+
+TEST_CASE(file_access_typed_values_are_little_endian) {
+    const std::string path = temp_file("typed");
+    {
+        FileAccess out;
+        REQUIRE(out.open(path, FileAccess::WRITE));
+        CHECK(out.store_8(0x12));
+        CHECK(out.store_16(0x3456));
+        CHECK(out.store_32(0x789ABCDE));
+        CHECK(out.store_64(0x0102030405060708ull));
+        CHECK(out.store_float(1.5f));
+        CHECK(out.store_double(-2.25));
+    }
+    FileAccess in;
+    REQUIRE(in.open(path, FileAccess::READ));
+    CHECK(in.get_length() == 1 + 2 + 4 + 8 + 4 + 8);
+    CHECK(in.get_8() == 0x12);
+    CHECK(in.get_16() == 0x3456);
+    CHECK(in.get_32() == 0x789ABCDE);
+    CHECK(in.get_64() == 0x0102030405060708ull);
+    CHECK(in.get_float() == 1.5f);
+    CHECK(in.get_double() == -2.25);
+    CHECK(!in.eof_reached());
+    CHECK(in.get_32() == 0);
+    CHECK(in.eof_reached());
+
+    // Byte order on disk does not depend on the host.
+    CHECK(in.seek(1));
+    uint8_t raw[2];
+    CHECK(in.get_buffer(raw, 2) == 2);
+    CHECK(raw[0] == 0x56 && raw[1] == 0x34);
+    in.close();
+    std::filesystem::remove(path);
+}
+
+TEST_CASE(file_access_small_buffer_lines_and_append) {
+    const std::string path = temp_file("lines");
+    {
+        FileAccess out;
+        out.set_buffer_size(16); // Every line crosses a buffer refill.
+        REQUIRE(out.open(path, FileAccess::WRITE));
+        out.write_line_to_file("first line, longer than the buffer");
+        out.write_line_to_file("");
+    }
+    {
+        FileAccess out;
+        REQUIRE(out.open(path, FileAccess::APPEND));
+        out.store_string("last");
+    }
+    FileAccess in;
+    in.set_buffer_size(16);
+    REQUIRE(in.open(path, FileAccess::READ));
+    std::string line;
+    CHECK(in.get_line_from_file(line));
+    CHECK(line == "first line, longer than the buffer");
+    CHECK(in.get_line_from_file(line));
+    CHECK(line.empty());
+    CHECK(in.get_line_from_file(line));
+    CHECK(line == "last");
+
+    std::string all;
+    CHECK(in.read(all));
+    CHECK(all == "first line, longer than the buffer\n\nlast\n"); // store_string() ends the line.
+    in.close();
+    std::filesystem::remove(path);
+}
+
+TEST_CASE(file_access_mmap_spans) {
+    const std::string path = temp_file("mmap");
+    std::string content(100000, 'x');
+    for (size_t i = 0; i < content.size(); i++) {
+        content[i] = char('a' + i % 26);
+    }
+    {
+        FileAccess out;
+        REQUIRE(out.open(path, FileAccess::WRITE));
+        REQUIRE(out.store_buffer(content.data(), content.size()));
+    }
+    FileAccess in;
+    REQUIRE(in.open(path, FileAccess::READ_MMAP));
+    CHECK(in.get_mapped_data().size() == content.size());
+    Span<const uint8_t> head = in.get_span(10);
+    CHECK(head.size() == 10 && memcmp(head.data(), content.data(), 10) == 0);
+    // The view is into the mapping itself.
+    CHECK(head.data() == in.get_mapped_data().data());
+    Span<const uint8_t> rest = in.get_span(content.size());
+    CHECK(rest.size() == content.size() - 10);
+    CHECK(in.eof_reached());
+
+    // Buffered mode cannot view more than its buffer.
+    FileAccess buffered;
+    buffered.set_buffer_size(4096);
+    REQUIRE(buffered.open(path, FileAccess::READ));
+    CHECK(buffered.get_span(8192).size() == 0);
+    CHECK(buffered.get_span(4096).size() == 4096);
+    buffered.close();
+    in.close();
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,267 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "test_macros.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "core/io/file_system.h"
+
+namespace {
+
+typedef std::vector<std::pair<std::string, FileSystemIndex::ChangeType>> Changes;
+
+const int64_t SECOND = 1000000000;
+
+std::string temp_dir(const char* p_name) {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / ("patsher_test_fs_" + std::to_string(getpid()) + "_" + p_name);
+    std::filesystem::remove_all(path);
+    std::filesystem::create_directories(path);
+    return path.string();
+}
+
+void write_file(const std::string& p_path, const std::string& p_data) {
+    std::ofstream(p_path, std::ios::binary | std::ios::trunc).write(p_data.data(), p_data.size());
+}
+
+// Pins the mtime, so comparisons do not depend on the clock's resolution.
+void set_mtime(const std::string& p_path, int64_t p_seconds) {
+    struct timespec times[2];
+    times[0].tv_sec = p_seconds;
+    times[0].tv_nsec = 0;
+    times[1] = times[0];
+    utimensat(AT_FDCWD, p_path.c_str(), times, 0);
+}
+
+// root/
+//   icon.PNG, player.gd, Player_old.gd, .hidden
+//   art/ hero.png, tree.png
+//   scripts/ enemy.gd
+void make_tree(const std::string& p_root) {
+    std::filesystem::create_directories(p_root + "/art");
+    std::filesystem::create_directories(p_root + "/scripts");
+    write_file(p_root + "/icon.PNG", "png");
+    write_file(p_root + "/player.gd", "extends Node");
+    write_file(p_root + "/Player_old.gd", "extends Node2D");
+    write_file(p_root + "/.hidden", "x");
+    write_file(p_root + "/art/hero.png", "hero");
+    write_file(p_root + "/art/tree.png", "tree");
+    write_file(p_root + "/scripts/enemy.gd", "extends Area2D");
+}
+
+std::vector<std::string> sorted(std::vector<std::string> p_paths) {
+    std::sort(p_paths.begin(), p_paths.end());
+    return p_paths;
+}
+
+bool has_change(const Changes& p_changes, const std::string& p_path, FileSystemIndex::ChangeType p_type) {
+    return std::find(p_changes.begin(), p_changes.end(), std::make_pair(p_path, p_type)) != p_changes.end();
+}
+
+} // namespace
+
+TEST_CASE(file_system_cache_and_incremental_scan) {
+    const std::string root = temp_dir("cache");
+    const std::string cache = root + ".cache";
+    make_tree(root);
+
+    Changes changes;
+    {
+        FileSystemIndex index;
+        index.set_change_listener([&changes](const std::string& p_path, FileSystemIndex::ChangeType p_type) {
+            changes.emplace_back(p_path, p_type);
+        });
+        REQUIRE(index.open(root) == OK);
+        CHECK(index.get_file_count() == 6);
+        CHECK(!index.has_file(".hidden"));
+        CHECK((index.get_directory("") == std::vector<std::string>{ "Player_old.gd", "art", "icon.PNG", "player.gd", "scripts" }));
+        CHECK(changes.empty()); // The first build reports nothing.
+        REQUIRE(index.save_cache(cache) == OK);
+        CHECK(!std::filesystem::exists(cache + ".tmp"));
+    }
+
+    // While closed: art/ gains a file (its mtime moves on), and a file in
+    // scripts/ changes without touching its directory.
+    write_file(root + "/art/rock.png", "rock");
+    set_mtime(root + "/art", 2000000000);
+    write_file(root + "/scripts/enemy.gd", "extends Area2D # edited");
+
+    FileSystemIndex index;
+    index.set_change_listener([&changes](const std::string& p_path, FileSystemIndex::ChangeType p_type) {
+        changes.emplace_back(p_path, p_type);
+    });
+    REQUIRE(index.open(root, cache) == OK);
+    // Only changes since the cache are reported: it was loaded, not crawled.
+    CHECK((changes == Changes{ { "art/rock.png", FileSystemIndex::CHANGE_ADDED } }));
+    CHECK(index.get_file_count() == 7);
+    FileSystemIndex::FileInfo info;
+    REQUIRE(index.get_info("scripts/enemy.gd", info));
+    CHECK(info.size == std::string("extends Area2D").size());
+
+    // A verifying scan re-stats the files too.
+    changes.clear();
+    CHECK(index.scan(true) == 1);
+    CHECK((changes == Changes{ { "scripts/enemy.gd", FileSystemIndex::CHANGE_MODIFIED } }));
+    REQUIRE(index.get_info("scripts/enemy.gd", info));
+    CHECK(info.size == std::string("extends Area2D # edited").size());
+
+    // A cache written for another root, or damaged, is not used.
+    FileSystemIndex other;
+    CHECK(other.open(root + "/art") == OK);
+    CHECK(other.load_cache(cache) == ERR_INVALID_DATA);
+    std::string data;
+    {
+        std::ifstream in(cache, std::ios::binary);
+        data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    write_file(cache, data.substr(0, data.size() / 2));
+    CHECK(index.load_cache(cache) == ERR_FILE_CORRUPT);
+    CHECK(index.open(root, cache) == OK);
+    CHECK(index.get_file_count() == 7);
+
+    std::filesystem::remove_all(root);
+    std::filesystem::remove(cache);
+}
+
+TEST_CASE(file_system_watch_events) {
+    const std::string root = temp_dir("watch");
+    const std::string outside = temp_dir("watch_outside");
+    make_tree(root);
+
+    Changes changes;
+    FileSystemIndex index;
+    index.set_change_listener([&changes](const std::string& p_path, FileSystemIndex::ChangeType p_type) {
+        changes.emplace_back(p_path, p_type);
+    });
+    REQUIRE(index.open(root) == OK);
+    if (!index.start_watching()) {
+        std::filesystem::remove_all(root);
+        std::filesystem::remove_all(outside);
+        return; // No inotify here.
+    }
+    CHECK(index.process_events() == 0);
+
+    write_file(root + "/art/new.png", "new");
+    CHECK(index.process_events() >= 1);
+    CHECK(has_change(changes, "art/new.png", FileSystemIndex::CHANGE_ADDED));
+    CHECK(index.has_file("art/new.png"));
+
+    changes.clear();
+    std::filesystem::remove(root + "/art/tree.png");
+    CHECK(index.process_events() == 1);
+    CHECK((changes == Changes{ { "art/tree.png", FileSystemIndex::CHANGE_REMOVED } }));
+    CHECK(!index.has_file("art/tree.png"));
+
+    // A rename is IN_MOVED_FROM then IN_MOVED_TO.
+    changes.clear();
+    std::filesystem::rename(root + "/player.gd", root + "/scripts/hero.gd");
+    index.process_events();
+    CHECK(has_change(changes, "player.gd", FileSystemIndex::CHANGE_REMOVED));
+    CHECK(has_change(changes, "scripts/hero.gd", FileSystemIndex::CHANGE_ADDED));
+    CHECK(!index.has_file("player.gd"));
+    CHECK(index.has_file("scripts/hero.gd"));
+
+    // A directory moved in brings its files; one moved out takes them along.
+    changes.clear();
+    std::filesystem::create_directories(outside + "/sounds/music");
+    write_file(outside + "/sounds/hit.wav", "wav");
+    write_file(outside + "/sounds/music/theme.ogg", "ogg");
+    std::filesystem::rename(outside + "/sounds", root + "/sounds");
+    index.process_events();
+    CHECK(index.has_file("sounds/hit.wav"));
+    CHECK(index.has_file("sounds/music/theme.ogg"));
+    CHECK(has_change(changes, "sounds/music/theme.ogg", FileSystemIndex::CHANGE_ADDED));
+
+    changes.clear();
+    std::filesystem::rename(root + "/sounds", outside + "/sounds");
+    index.process_events();
+    CHECK(!index.has_file("sounds"));
+    CHECK(!index.has_file("sounds/music/theme.ogg"));
+    CHECK(has_change(changes, "sounds/hit.wav", FileSystemIndex::CHANGE_REMOVED));
+
+    // Edits in place, and hidden names are ignored.
+    changes.clear();
+    write_file(root + "/icon.PNG", "a larger png");
+    write_file(root + "/.swap", "x");
+    index.process_events();
+    CHECK(has_change(changes, "icon.PNG", FileSystemIndex::CHANGE_MODIFIED));
+    CHECK(!index.has_file(".swap"));
+    CHECK(index.get_file_count() == 6);
+
+    index.stop_watching();
+    write_file(root + "/art/late.png", "late");
+    CHECK(index.process_events() == 0);
+    CHECK(!index.has_file("art/late.png"));
+
+    std::filesystem::remove_all(root);
+    std::filesystem::remove_all(outside);
+}
+
+TEST_CASE(file_system_queries) {
+    const std::string root = temp_dir("queries");
+    make_tree(root);
+    for (const char* path : { "/icon.PNG", "/player.gd", "/Player_old.gd", "/art/hero.png", "/art/tree.png", "/scripts/enemy.gd" }) {
+        set_mtime(root + path, 1000);
+    }
+    set_mtime(root + "/art/hero.png", 3000);
+    set_mtime(root + "/scripts/enemy.gd", 2000);
+
+    FileSystemIndex index;
+    REQUIRE(index.open(root) == OK);
+
+    CHECK((sorted(index.get_files_with_extension("png")) == std::vector<std::string>{ "art/hero.png", "art/tree.png", "icon.PNG" }));
+    CHECK(sorted(index.get_files_with_extension(".PNG")) == sorted(index.get_files_with_extension("png")));
+    CHECK(index.get_files_with_extension("wav").empty());
+
+    CHECK((sorted(index.find_by_name_prefix("pla")) == std::vector<std::string>{ "Player_old.gd", "player.gd" }));
+    CHECK(index.find_by_name_prefix("PLAYER_", 0) == std::vector<std::string>{ "Player_old.gd" });
+    CHECK(index.find_by_name_prefix("", 2).size() == 2);
+    CHECK(index.find_by_name_prefix("zzz").empty());
+
+    // Files only, oldest first.
+    CHECK((index.get_modified_since(2000 * SECOND) == std::vector<std::string>{ "scripts/enemy.gd", "art/hero.png" }));
+    CHECK(index.get_modified_since(2000 * SECOND + 1) == std::vector<std::string>{ "art/hero.png" });
+    CHECK(index.get_modified_since(0).size() == 6);
+
+    // The indexes follow changes.
+    std::filesystem::rename(root + "/art/hero.png", root + "/art/villain.PNG");
+    write_file(root + "/art/new.gd", "new");
+    set_mtime(root + "/art/new.gd", 4000);
+    set_mtime(root + "/art", 5000);
+    index.scan(false);
+    CHECK((sorted(index.get_files_with_extension("png")) == std::vector<std::string>{ "art/tree.png", "art/villain.PNG", "icon.PNG" }));
+    CHECK(index.find_by_name_prefix("hero").empty());
+    CHECK(index.find_by_name_prefix("vill") == std::vector<std::string>{ "art/villain.PNG" });
+    CHECK((index.get_modified_since(2500 * SECOND) == std::vector<std::string>{ "art/villain.PNG", "art/new.gd" }));
+
+    std::filesystem::remove_all(root);
+}
@@ -0,0 +1,179 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "test_macros.h"
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/io/file_system_memory.h"
+#include "core/io/file_system_pack.h"
+#include "test_utils.h"
+
+namespace {
+
+std::string text(const Ref<MemoryBuffer>& p_buffer) {
+    return ::text(p_buffer->get_data());
+}
+
+void write_disk(const std::string& p_path, const std::string& p_text) {
+    std::filesystem::create_directories(std::filesystem::path(p_path).parent_path());
+    std::ofstream(p_path, std::ios::binary) << p_text;
+}
+
+} // namespace
+
+TEST_CASE(memory_normalize_path) {
+    CHECK(FileSystemMemory::normalize_path("res://a\\b/./c") == "res://a/b/c");
+    CHECK(FileSystemMemory::normalize_path("res://a/../b//c/") == "res://b/c");
+    CHECK(FileSystemMemory::normalize_path("res://../../x") == "res://x");
+    CHECK(FileSystemMemory::normalize_path("/tmp/./a") == "/tmp/a");
+    CHECK(FileSystemMemory::normalize_path("a/b/..") == "a");
+}
+
+TEST_CASE(memory_overlay_over_disk) {
+    const std::string root = temp_dir() + "/disk";
+    write_disk(root + "/config.cfg", "disk");
+    write_disk(root + "/levels/one.json", "{}");
+
+    FileSystemMemory fs;
+    fs.mount_directory("res://", root);
+    std::vector<std::string> changes;
+    const int listener = fs.add_change_listener([&changes](const std::string& p_path) { changes.push_back(p_path); });
+
+    Ref<MemoryBuffer> buffer;
+    REQUIRE(fs.read_file("res://config.cfg", buffer) == OK);
+    CHECK(text(buffer) == "disk");
+    CHECK(!fs.is_overridden("res://config.cfg"));
+    CHECK(fs.get_version("res://config.cfg") == 0);
+
+    // A write shadows the disk copy; the old buffer stays a snapshot.
+    Ref<MemoryBuffer> before = buffer;
+    REQUIRE(fs.write_file("res://config.cfg", bytes("memory")) == OK);
+    REQUIRE(fs.read_file("res://./config.cfg", buffer) == OK);
+    CHECK(text(buffer) == "memory");
+    CHECK(text(before) == "disk");
+    CHECK(fs.get_version("res://config.cfg") > 0);
+
+    // Append copies up from disk; copy shares the buffer.
+    REQUIRE(fs.append_file("res://levels/one.json", Span<const uint8_t>(bytes("\n"))) == OK);
+    REQUIRE(fs.read_file("res://levels/one.json", buffer) == OK);
+    CHECK(text(buffer) == "{}\n");
+    REQUIRE(fs.copy_file("res://levels/one.json", "res://levels/two.json") == OK);
+    Ref<MemoryBuffer> copy;
+    REQUIRE(fs.read_file("res://levels/two.json", copy) == OK);
+    CHECK(copy->get_data().data() == buffer->get_data().data());
+
+    // Removing a file that exists on disk leaves a whiteout until reverted.
+    REQUIRE(fs.remove_file("res://config.cfg") == OK);
+    CHECK(!fs.has_file("res://config.cfg"));
+    CHECK(fs.read_file("res://config.cfg", buffer) == ERR_FILE_NOT_FOUND);
+    CHECK(fs.remove_file("res://config.cfg") == ERR_FILE_NOT_FOUND);
+    CHECK(fs.revert_file("res://config.cfg"));
+    REQUIRE(fs.read_file("res://config.cfg", buffer) == OK);
+    CHECK(text(buffer) == "disk");
+    CHECK(std::ifstream(root + "/config.cfg").get() == 'd');
+
+    // An overlay-only file just goes away.
+    REQUIRE(fs.remove_file("res://levels/two.json") == OK);
+    CHECK(!fs.is_overridden("res://levels/two.json"));
+    CHECK(fs.get_overlay_files("res://levels") == (std::vector<std::string>{ "res://levels/one.json" }));
+
+    CHECK(changes == (std::vector<std::string>{ "res://config.cfg", "res://levels/one.json", "res://levels/two.json", "res://config.cfg",
+                             "res://config.cfg", "res://levels/two.json" }));
+    fs.remove_change_listener(listener);
+    fs.clear();
+    CHECK(changes.size() == 6);
+    CHECK(fs.get_overlay_files().empty());
+
+    FileSystemMemory::Stats stats = fs.get_stats();
+    CHECK(stats.disk_reads == 3);
+    CHECK(stats.overlay_hits == 4);
+    CHECK(stats.misses == 1);
+}
+
+TEST_CASE(memory_mounts_packs_and_prefixes) {
+    const std::string pack_path = temp_dir() + "/data.pck";
+    PackWriter writer;
+    writer.add_buffer("sounds/hit.wav", bytes("wav"));
+    REQUIRE(writer.save(pack_path) == OK);
+    FileSystemPack packs;
+    REQUIRE(packs.mount(pack_path) == OK);
+
+    const std::string root = temp_dir() + "/user";
+    write_disk(root + "/save.dat", "save");
+
+    FileSystemMemory fs;
+    Ref<MemoryBuffer> buffer;
+    CHECK(fs.read_file("res://sounds/hit.wav", buffer) == ERR_FILE_NOT_FOUND);
+    fs.mount_packs("res://", &packs);
+    fs.mount_directory("res://user", root);
+
+    REQUIRE(fs.read_file("res://sounds/hit.wav", buffer) == OK);
+    CHECK(buffer->is_borrowed());
+    CHECK(text(buffer) == "wav");
+    // The longest prefix wins, and only at a segment boundary.
+    REQUIRE(fs.read_file("res://user/save.dat", buffer) == OK);
+    CHECK(text(buffer) == "save");
+    CHECK(!fs.has_file("res://username/save.dat"));
+
+    // A borrowed buffer keeps its pack mapped after the pack is unmounted.
+    REQUIRE(fs.read_file("res://sounds/hit.wav", buffer) == OK);
+    CHECK(fs.unmount("res://"));
+    packs.unmount_all();
+    CHECK(!fs.has_file("res://sounds/hit.wav"));
+    CHECK(text(buffer) == "wav");
+}
+
+TEST_CASE(memory_concurrent_reads_and_writes) {
+    FileSystemMemory fs;
+    for (int i = 0; i < 64; i++) {
+        fs.write_file("mem://f" + std::to_string(i), bytes("0000"));
+    }
+    std::atomic<bool> stop{ false };
+    std::atomic<int> torn{ 0 };
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++) {
+        readers.emplace_back([&]() {
+            Ref<MemoryBuffer> buffer;
+            for (int n = 0; !stop.load(); n++) {
+                if (fs.read_file("mem://f" + std::to_string(n % 64), buffer) != OK || text(buffer).find_first_not_of(text(buffer)[0]) != std::string::npos) {
+                    torn.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (int round = 1; round <= 2000; round++) {
+        const char c = char('0' + round % 10);
+        fs.write_file("mem://f" + std::to_string(round % 64), bytes(std::string(4, c)));
+    }
+    stop.store(true);
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    CHECK(torn.load() == 0);
+}
@@ -0,0 +1,109 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "test_macros.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "core/io/file_system_pack.h"
+#include "test_utils.h"
+
+TEST_CASE(pack_round_trip_and_alignment) {
+    const std::string path = temp_dir() + "/base.pck";
+    PackWriter writer;
+    REQUIRE(writer.add_buffer("res://textures/player.png", bytes("png data")) == OK);
+    REQUIRE(writer.add_buffer("scenes/main.tscn", bytes("[gd_scene]")) == OK);
+    REQUIRE(writer.add_buffer("empty.txt", {}) == OK);
+    REQUIRE(writer.save(path) == OK);
+
+    Ref<PackFile> pack;
+    pack.instantiate();
+    REQUIRE(pack->open(path) == OK);
+    CHECK(pack->get_file_count() == 3);
+
+    Span<const uint8_t> data;
+    REQUIRE(pack->get_file("textures/player.png", data));
+    CHECK(text(data) == "png data");
+    CHECK(reinterpret_cast<uintptr_t>(data.data()) % PackFile::DATA_ALIGNMENT == 0);
+    // Lookups normalize the same way the writer did.
+    CHECK(pack->has_file("res://scenes/main.tscn"));
+    CHECK(pack->has_file("./scenes\\main.tscn"));
+    REQUIRE(pack->get_file("empty.txt", data));
+    CHECK(data.size() == 0);
+    CHECK(!pack->has_file("scenes/missing.tscn"));
+}
+
+TEST_CASE(pack_layering) {
+    const std::string base_path = temp_dir() + "/layer_base.pck";
+    const std::string patch_path = temp_dir() + "/layer_patch.pck";
+    PackWriter base;
+    base.add_buffer("a.txt", bytes("base a"));
+    base.add_buffer("b.txt", bytes("base b"));
+    base.add_buffer("c.txt", bytes("base c"));
+    REQUIRE(base.save(base_path) == OK);
+    PackWriter patch;
+    patch.add_buffer("a.txt", bytes("patched a"));
+    patch.add_buffer("d.txt", bytes("new d"));
+    patch.add_deletion("c.txt");
+    REQUIRE(patch.save(patch_path) == OK);
+
+    FileSystemPack packs;
+    REQUIRE(packs.mount(base_path) == OK);
+    REQUIRE(packs.mount(patch_path) == OK);
+    Span<const uint8_t> data;
+    REQUIRE(packs.get_file("a.txt", data));
+    CHECK(text(data) == "patched a");
+    REQUIRE(packs.get_file("b.txt", data));
+    CHECK(text(data) == "base b");
+    CHECK(!packs.has_file("c.txt"));
+    CHECK(packs.has_file("d.txt"));
+    CHECK(packs.get_file_list() == (std::vector<std::string>{ "a.txt", "b.txt", "d.txt" }));
+
+    REQUIRE(packs.unmount(patch_path));
+    REQUIRE(packs.get_file("a.txt", data));
+    CHECK(text(data) == "base a");
+    CHECK(packs.has_file("c.txt"));
+}
+
+TEST_CASE(pack_rejects_foreign_and_truncated_files) {
+    const std::string good = temp_dir() + "/good.pck";
+    PackWriter writer;
+    writer.add_buffer("x.bin", std::vector<uint8_t>(10000, 7));
+    REQUIRE(writer.save(good) == OK);
+
+    Ref<PackFile> pack;
+    pack.instantiate();
+    CHECK(pack->open(temp_dir() + "/missing.pck") != OK);
+
+    const std::string truncated = temp_dir() + "/truncated.pck";
+    std::filesystem::copy_file(good, truncated, std::filesystem::copy_options::overwrite_existing);
+    std::filesystem::resize_file(truncated, std::filesystem::file_size(good) - 100);
+    CHECK(pack->open(truncated) != OK);
+
+    const std::string foreign = temp_dir() + "/foreign.pck";
+    std::filesystem::copy_file(good, foreign, std::filesystem::copy_options::overwrite_existing);
+    std::filesystem::resize_file(foreign, 8);
+    CHECK(pack->open(foreign) != OK);
+}
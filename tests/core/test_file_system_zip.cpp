@@ -0,0 +1,170 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "test_macros.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "core/io/file_system_zip.h"
+#include "test_utils.h"
+#include "zip_writer.h"
+
+namespace {
+
+std::string write_archive(const std::string& p_name, const std::vector<uint8_t>& p_data) {
+    const std::string path = temp_dir() + "/" + p_name;
+    std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(p_data.data()), p_data.size());
+    return path;
+}
+
+// Counts up in little-endian 32-bit words, so any offset can be checked.
+std::vector<uint8_t> counter_data(size_t p_words) {
+    std::vector<uint8_t> data(p_words * 4);
+    for (size_t i = 0; i < p_words; i++) {
+        for (int b = 0; b < 4; b++) {
+            data[i * 4 + b] = uint8_t(uint32_t(i) >> (b * 8));
+        }
+    }
+    return data;
+}
+
+} // namespace
+
+TEST_CASE(zip_entries_stored_and_deflated) {
+    ZipWriter writer;
+    writer.add("readme.txt", bytes("stored text"), false);
+    writer.add("data/level.json", bytes(std::string(5000, 'x') + "end"), true);
+    writer.add("data/", {}, false);
+    const std::string path = write_archive("basic.zip", writer.finish());
+
+    Ref<ZipArchive> zip;
+    zip.instantiate();
+    REQUIRE(zip->open(path) == OK);
+    CHECK(zip->get_entry_count() == 3);
+    CHECK(zip->get_file_list() == (std::vector<std::string>{ "readme.txt", "data/level.json" }));
+    CHECK(zip->has_file("data/level.json"));
+    CHECK(!zip->has_file("data/missing.json"));
+
+    Span<const uint8_t> view;
+    REQUIRE(zip->get_stored_data("readme.txt", view) == OK);
+    CHECK(std::string(reinterpret_cast<const char*>(view.data()), view.size()) == "stored text");
+    CHECK(zip->get_stored_data("data/level.json", view) == ERR_UNAVAILABLE);
+
+    std::vector<uint8_t> data;
+    REQUIRE(zip->read_file("data/level.json", data) == OK);
+    CHECK(data == bytes(std::string(5000, 'x') + "end"));
+    CHECK(zip->read_file("nope", data) == ERR_FILE_NOT_FOUND);
+
+    std::vector<std::vector<uint8_t>> many;
+    REQUIRE(zip->read_files({ "data/level.json", "readme.txt" }, many, 2) == OK);
+    REQUIRE(many.size() == 2);
+    CHECK(many[0].size() == 5003);
+    CHECK(many[1] == bytes("stored text"));
+
+    const std::string out = temp_dir() + "/extracted";
+    REQUIRE(zip->extract_all(out, 2) == OK);
+    std::ifstream extracted(out + "/data/level.json", std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(extracted)), std::istreambuf_iterator<char>());
+    CHECK(content == std::string(5000, 'x') + "end");
+}
+
+TEST_CASE(zip_reader_streams_past_its_buffer) {
+    const size_t words = ZipFileReader::BUFFER_SIZE; // four buffers' worth
+    ZipWriter writer;
+    writer.add("counter.bin", counter_data(words), true);
+    writer.add("lines.txt", bytes("first\r\nsecond\nlast"), true);
+    const std::string path = write_archive("stream.zip", writer.finish());
+
+    Ref<ZipArchive> zip;
+    zip.instantiate();
+    REQUIRE(zip->open(path) == OK);
+
+    Ref<ZipFileReader> reader;
+    reader.instantiate();
+    REQUIRE(reader->open(zip, "counter.bin") == OK);
+    CHECK(reader->get_length() == words * 4);
+    bool in_order = true;
+    for (size_t i = 0; i < words; i++) {
+        in_order = in_order && reader->get_32() == uint32_t(i);
+    }
+    CHECK(in_order);
+    reader->get_8();
+    CHECK(reader->eof_reached());
+    CHECK(reader->get_error() == OK);
+
+    // Backward outside the buffer restarts the stream; forward discards.
+    REQUIRE(reader->seek(4 * 10));
+    CHECK(reader->get_32() == 10);
+    REQUIRE(reader->seek(4 * (words - 2)));
+    CHECK(reader->get_32() == uint32_t(words - 2));
+
+    // A large read goes straight into the caller's memory.
+    REQUIRE(reader->seek(0));
+    std::vector<uint8_t> all(words * 4);
+    CHECK(reader->get_buffer(all.data(), all.size()) == all.size());
+    CHECK(all == counter_data(words));
+
+    REQUIRE(reader->open(zip, "lines.txt") == OK);
+    CHECK(reader->get_line() == "first");
+    CHECK(reader->get_line() == "second");
+    CHECK(reader->get_line() == "last");
+}
+
+TEST_CASE(zip_rejects_corrupt_and_hostile_archives) {
+    ZipWriter writer;
+    writer.add("good.txt", bytes(std::string(1000, 'g')), true);
+    std::vector<uint8_t> archive = writer.finish();
+
+    Ref<ZipArchive> zip;
+    zip.instantiate();
+    CHECK(zip->open(temp_dir() + "/missing.zip") != OK);
+    CHECK(zip->open(write_archive("foreign.zip", bytes("not a zip archive at all"))) == ERR_FILE_UNRECOGNIZED);
+
+    // Truncating the central directory leaves an end record pointing past it.
+    std::vector<uint8_t> truncated(archive.begin(), archive.begin() + 40);
+    truncated.insert(truncated.end(), archive.end() - 22, archive.end());
+    CHECK(zip->open(write_archive("truncated.zip", truncated)) != OK);
+
+    // Flip a bit of the stored CRC (local header offset 14).
+    std::vector<uint8_t> bad_crc = archive;
+    bad_crc[14] ^= 1;
+    const size_t directory_crc = archive.size() - 22 - (46 + 8) + 16;
+    bad_crc[directory_crc] ^= 1;
+    REQUIRE(zip->open(write_archive("bad_crc.zip", bad_crc)) == OK);
+    std::vector<uint8_t> data;
+    CHECK(zip->read_file("good.txt", data) == ERR_FILE_CORRUPT);
+
+    ZipWriter escape;
+    escape.add("../outside.txt", bytes("x"), false);
+    escape.add("inside.txt", bytes("y"), false);
+    REQUIRE(zip->open(write_archive("escape.zip", escape.finish())) == OK);
+    const std::string out = temp_dir() + "/escape";
+    CHECK(zip->extract_all(out, 1) == ERR_FILE_BAD_PATH);
+    CHECK(std::filesystem::exists(out + "/inside.txt"));
+    CHECK(!std::filesystem::exists(temp_dir() + "/outside.txt"));
+
+    zip->close();
+}
@@ -0,0 +1,471 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "test_macros.h"
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "core/io/http_client.h"
+#include "core/io/http_server.h"
+#include "core/io/json_utils.h"
+
+namespace {
+
+std::string temp_dir(const char* p_name) {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / ("patsher_test_http_" + std::to_string(getpid()) + "_" + p_name);
+    std::filesystem::remove_all(path);
+    std::filesystem::create_directories(path);
+    return path.string();
+}
+
+std::string pattern(size_t p_size) {
+    std::string data(p_size, '\0');
+    for (size_t i = 0; i < p_size; i++) {
+        data[i] = static_cast<char>('a' + (i * 7 + i / 251) % 26);
+    }
+    return data;
+}
+
+void write_file(const std::string& p_path, const std::string& p_data) {
+    std::ofstream(p_path, std::ios::binary).write(p_data.data(), p_data.size());
+}
+
+std::string read_file(const std::string& p_path) {
+    std::ifstream in(p_path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// The routes every case shares: /echo/... answers with its path, /big with
+// a 3 MB body, /chunked with a streamed body, /assets/ serves p_directory.
+void start_server(HTTPServer& r_server, const std::string& p_directory) {
+    r_server.add_route("GET", "/echo/*", [](const HTTPServer::Request& p_request, HTTPServer::Response& r_response) {
+        r_response.body = p_request.path;
+    });
+    r_server.add_route("GET", "/big", [](const HTTPServer::Request&, HTTPServer::Response& r_response) {
+        r_response.body = pattern(3 * 1024 * 1024);
+    });
+    r_server.add_route("GET", "/chunked", [](const HTTPServer::Request&, HTTPServer::Response& r_response) {
+        Ref<HTTPStream> stream = r_response.begin_stream("text/plain");
+        std::thread([stream] {
+            for (int i = 0; i < 5; i++) {
+                stream->write("chunk" + std::to_string(i) + ";");
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+            stream->close();
+        }).detach();
+    });
+    r_server.mount_directory("/assets/", p_directory);
+    REQUIRE(r_server.start(0) == OK);
+}
+
+std::string url(const HTTPServer& p_server, const std::string& p_path) {
+    return "http://127.0.0.1:" + std::to_string(p_server.get_port()) + p_path;
+}
+
+bool wait_all(HTTPClient& p_client, const std::vector<Ref<HTTPRequest>>& p_requests) {
+    for (const Ref<HTTPRequest>& request : p_requests) {
+        if (request.is_null() || p_client.wait(request.get_ptr(), 10000) != OK) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Plain blocking socket, to look at exactly what the server sends.
+int raw_connect(const HTTPServer& p_server) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(p_server.get_port());
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    timeval timeout = { 5, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Reads until p_until shows up, the server closes, or 5 s pass.
+std::string raw_read(int p_fd, const std::string& p_until = std::string()) {
+    std::string data;
+    char buffer[65536];
+    while (p_until.empty() || data.find(p_until) == std::string::npos) {
+        ssize_t got = recv(p_fd, buffer, sizeof(buffer), 0);
+        if (got <= 0) {
+            break;
+        }
+        data.append(buffer, static_cast<size_t>(got));
+    }
+    return data;
+}
+
+std::string raw_exchange(const HTTPServer& p_server, const std::string& p_requests) {
+    int fd = raw_connect(p_server);
+    if (fd < 0) {
+        return std::string();
+    }
+    (void)send(fd, p_requests.data(), p_requests.size(), 0);
+    std::string response = raw_read(fd);
+    ::close(fd);
+    return response;
+}
+
+size_t count(const std::string& p_text, const std::string& p_what) {
+    size_t found = 0;
+    for (size_t at = p_text.find(p_what); at != std::string::npos; at = p_text.find(p_what, at + 1)) {
+        found++;
+    }
+    return found;
+}
+
+} // namespace
+
+TEST_CASE(http_client_pools_and_pipelines) {
+    const std::string dir = temp_dir("pool");
+    HTTPServer server;
+    start_server(server, dir);
+    HTTPClient client;
+
+    // Open the four pooled connections first, so the next burst finds them
+    // idle and connected.
+    std::vector<Ref<HTTPRequest>> warm;
+    for (int i = 0; i < 4; i++) {
+        warm.push_back(client.get(url(server, "/echo/warm" + std::to_string(i))));
+    }
+    REQUIRE(wait_all(client, warm));
+    CHECK(client.get_stats().connections_opened == 4);
+
+    // 4 go out on the idle connections, 12 are pipelined 3 deep behind
+    // them, and 4 wait for a slot.
+    std::vector<Ref<HTTPRequest>> requests;
+    for (int i = 0; i < 20; i++) {
+        requests.push_back(client.get(url(server, "/echo/" + std::to_string(i))));
+    }
+    CHECK(client.get_stats().pipelined == 12);
+    REQUIRE(wait_all(client, requests));
+    bool all_match = true;
+    for (int i = 0; i < 20; i++) {
+        all_match = all_match && requests[i]->get_response_code() == 200 && requests[i]->get_body() == "/echo/" + std::to_string(i);
+    }
+    CHECK(all_match);
+    const HTTPClient::Stats stats = client.get_stats();
+    CHECK(stats.connections_opened == 4);
+    CHECK(stats.reused == 20);
+    CHECK(stats.retries == 0);
+    CHECK(server.get_stats().connections_accepted == 4);
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE(http_client_large_body_and_errors) {
+    const std::string dir = temp_dir("errors");
+    write_file(dir + "/secret.txt", "outside");
+    std::filesystem::create_directories(dir + "/public");
+    HTTPServer server;
+    start_server(server, dir + "/public");
+    HTTPClient client;
+
+    Ref<HTTPRequest> big = client.get(url(server, "/big"));
+    Ref<HTTPRequest> missing = client.get(url(server, "/nothing/here"));
+    Ref<HTTPRequest> escape = client.get(url(server, "/assets/../secret.txt"));
+    REQUIRE(wait_all(client, { big, missing, escape }));
+
+    CHECK(big->get_response_code() == 200);
+    CHECK(big->get_content_length() == 3 * 1024 * 1024);
+    CHECK(big->get_body() == pattern(3 * 1024 * 1024));
+    CHECK(missing->get_response_code() == 404);
+    CHECK(escape->get_response_code() == 403);
+    CHECK(escape->get_body().find("outside") == std::string::npos);
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE(http_client_resumed_download) {
+    const std::string dir = temp_dir("resume");
+    const std::string data = pattern(1024 * 1024 + 333);
+    std::filesystem::create_directories(dir + "/served");
+    write_file(dir + "/served/pack.bin", data);
+    HTTPServer server;
+    start_server(server, dir + "/served");
+    HTTPClient client;
+
+    // A third of the file is already there; only the rest is fetched.
+    const std::string local = dir + "/pack.bin";
+    write_file(local, data.substr(0, data.size() / 3));
+    Ref<HTTPRequest> download = client.download(url(server, "/assets/pack.bin"), local, true);
+    REQUIRE(wait_all(client, { download }));
+    CHECK(download->get_response_code() == 206);
+    CHECK(download->get_range_start() == int64_t(data.size() / 3));
+    CHECK(download->get_bytes_received() == data.size() - data.size() / 3);
+    CHECK(read_file(local) == data);
+
+    // Nothing to resume from: a plain 200 writes the whole file.
+    std::filesystem::remove(local);
+    Ref<HTTPRequest> fresh = client.download(url(server, "/assets/pack.bin"), local, true);
+    REQUIRE(wait_all(client, { fresh }));
+    CHECK(fresh->get_response_code() == 200);
+    CHECK(read_file(local) == data);
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE(http_client_chunked_body) {
+    const std::string dir = temp_dir("chunked");
+    HTTPServer server;
+    start_server(server, dir);
+    HTTPClient client;
+
+    Ref<HTTPRequest> request = client.get(url(server, "/chunked"));
+    REQUIRE(wait_all(client, { request }));
+    CHECK(request->get_response_code() == 200);
+    CHECK(request->get_content_length() == -1);
+    CHECK(request->get_response_header("transfer-encoding") == "chunked");
+    CHECK(request->get_body() == "chunk0;chunk1;chunk2;chunk3;chunk4;");
+
+    // The connection is still good for the next request.
+    Ref<HTTPRequest> next = client.get(url(server, "/echo/after"));
+    REQUIRE(wait_all(client, { next }));
+    CHECK(next->get_body() == "/echo/after");
+    CHECK(client.get_stats().connections_opened == 1);
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE(http_client_body_callback_backpressure) {
+    const std::string dir = temp_dir("pause");
+    HTTPServer server;
+    start_server(server, dir);
+    HTTPClient client;
+
+    std::string received;
+    bool paused = false;
+    int pauses = 0;
+    Ref<HTTPRequest> request = client.create_request("GET", url(server, "/big"));
+    // Takes at most 10000 bytes per call, then refuses until resumed.
+    request->set_body_callback([&](HTTPRequest&, Span<const uint8_t> p_data) -> size_t {
+        if (paused) {
+            return 0;
+        }
+        const size_t taken = std::min<size_t>(p_data.size(), 10000);
+        received.append(reinterpret_cast<const char*>(p_data.data()), taken);
+        paused = true;
+        pauses++;
+        return taken;
+    });
+    REQUIRE(client.send(request) == OK);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!request->is_done() && std::chrono::steady_clock::now() < deadline) {
+        client.poll(10);
+        if (paused) {
+            paused = false;
+            request->resume();
+        }
+    }
+    CHECK(request->get_status() == HTTPRequest::STATUS_DONE);
+    CHECK(request->get_body().empty());
+    CHECK(pauses >= 3 * 1024 * 1024 / 10000);
+    CHECK(received == pattern(3 * 1024 * 1024));
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE(http_client_retries_closed_pooled_connection) {
+    const std::string dir = temp_dir("retry");
+    HTTPServer server;
+    server.set_keep_alive_timeout(10);
+    start_server(server, dir);
+    HTTPClient client;
+    client.set_max_connections(1);
+
+    Ref<HTTPRequest> first = client.get(url(server, "/echo/first"));
+    REQUIRE(wait_all(client, { first }));
+
+    // The server drops the idle connection on its next sweep. The client
+    // does not poll meanwhile, so it still has it pooled.
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (server.get_stats().active_connections != 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    REQUIRE(server.get_stats().active_connections == 0);
+
+    Ref<HTTPRequest> second = client.get(url(server, "/echo/second"));
+    REQUIRE(wait_all(client, { second }));
+    CHECK(second->get_status() == HTTPRequest::STATUS_DONE);
+    CHECK(second->get_body() == "/echo/second");
+    const HTTPClient::Stats stats = client.get_stats();
+    CHECK(stats.retries == 1);
+    CHECK(stats.connections_opened == 2);
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE(http_server_keep_alive_and_pipelining) {
+    const std::string dir = temp_dir("server_pipeline");
+    HTTPServer server;
+    start_server(server, dir);
+
+    // Three requests in one write; answered in order on the one connection.
+    const std::string response = raw_exchange(server,
+            "GET /echo/a HTTP/1.1\r\nHost: x\r\n\r\n"
+            "GET /echo/b HTTP/1.1\r\nHost: x\r\n\r\n"
+            "GET /echo/c HTTP/1.1\r\nHost: x\r\nConnection: close\r\n\r\n");
+    CHECK(count(response, "HTTP/1.1 200 OK") == 3);
+    CHECK(count(response, "Connection: keep-alive") == 2);
+    CHECK(count(response, "Connection: close") == 1);
+    const size_t a = response.find("\r\n\r\n/echo/a");
+    const size_t b = response.find("\r\n\r\n/echo/b");
+    const size_t c = response.find("\r\n\r\n/echo/c");
+    CHECK(a != std::string::npos && b != std::string::npos && c != std::string::npos);
+    CHECK(a < b && b < c);
+
+    // HTTP/1.0 closes unless asked to keep the connection.
+    const std::string old = raw_exchange(server, "GET /echo/old HTTP/1.0\r\n\r\n");
+    CHECK(old.find("Connection: close") != std::string::npos);
+    CHECK(old.find("/echo/old") != std::string::npos);
+
+    const HTTPServer::Stats stats = server.get_stats();
+    CHECK(stats.connections_accepted == 2);
+    CHECK(stats.requests == 4);
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE(http_server_range_requests) {
+    const std::string dir = temp_dir("server_range");
+    const std::string data = pattern(1000);
+    write_file(dir + "/data.bin", data);
+    HTTPServer server;
+    start_server(server, dir);
+
+    const std::string middle = raw_exchange(server, "GET /assets/data.bin HTTP/1.1\r\nRange: bytes=10-19\r\nConnection: close\r\n\r\n");
+    CHECK(middle.compare(0, 12, "HTTP/1.1 206") == 0);
+    CHECK(middle.find("Content-Range: bytes 10-19/1000") != std::string::npos);
+    CHECK(middle.find("Content-Length: 10\r\n") != std::string::npos);
+    CHECK(middle.substr(middle.size() - 10) == data.substr(10, 10));
+
+    const std::string suffix = raw_exchange(server, "GET /assets/data.bin HTTP/1.1\r\nRange: bytes=-5\r\nConnection: close\r\n\r\n");
+    CHECK(suffix.find("Content-Range: bytes 995-999/1000") != std::string::npos);
+    CHECK(suffix.substr(suffix.size() - 5) == data.substr(995));
+
+    const std::string beyond = raw_exchange(server, "GET /assets/data.bin HTTP/1.1\r\nRange: bytes=5000-\r\nConnection: close\r\n\r\n");
+    CHECK(beyond.compare(0, 12, "HTTP/1.1 416") == 0);
+    CHECK(beyond.find("Content-Range: bytes */1000") != std::string::npos);
+
+    // Several ranges are not supported: the whole file.
+    const std::string multi = raw_exchange(server, "GET /assets/data.bin HTTP/1.1\r\nRange: bytes=0-1,5-6\r\nConnection: close\r\n\r\n");
+    CHECK(multi.compare(0, 12, "HTTP/1.1 200") == 0);
+    CHECK(multi.substr(multi.size() - 1000) == data);
+
+    const std::string head = raw_exchange(server, "HEAD /assets/data.bin HTTP/1.1\r\nConnection: close\r\n\r\n");
+    CHECK(head.find("Content-Length: 1000\r\n") != std::string::npos);
+    CHECK(head.size() == head.find("\r\n\r\n") + 4);
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE(http_server_rejects_path_traversal) {
+    const std::string dir = temp_dir("server_traversal");
+    write_file(dir + "/secret.txt", "outside");
+    std::filesystem::create_directories(dir + "/public/sub");
+    write_file(dir + "/public/sub/inside.txt", "inside");
+    HTTPServer server;
+    start_server(server, dir + "/public");
+
+    const std::string response = raw_exchange(server,
+            "GET /assets/../secret.txt HTTP/1.1\r\n\r\n"
+            "GET /assets/%2e%2e/secret.txt HTTP/1.1\r\n\r\n"
+            "GET /assets/sub/../../secret.txt HTTP/1.1\r\n\r\n"
+            "GET /assets/sub/inside.txt HTTP/1.1\r\nConnection: close\r\n\r\n");
+    CHECK(count(response, "HTTP/1.1 403") == 3);
+    CHECK(count(response, "HTTP/1.1 200") == 1);
+    CHECK(response.find("outside") == std::string::npos);
+    CHECK(response.find("inside") != std::string::npos);
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE(http_server_chunked_stream) {
+    const std::string dir = temp_dir("server_stream");
+    HTTPServer server;
+    start_server(server, dir);
+
+    int fd = raw_connect(server);
+    REQUIRE(fd >= 0);
+    const std::string request = "GET /chunked HTTP/1.1\r\n\r\n";
+    (void)send(fd, request.data(), request.size(), 0);
+    const std::string stream = raw_read(fd, "0\r\n\r\n");
+    CHECK(stream.find("Transfer-Encoding: chunked") != std::string::npos);
+    CHECK(stream.find("Content-Length") == std::string::npos);
+    CHECK(stream.find("\r\n\r\n7\r\nchunk0;\r\n7\r\nchunk1;\r\n") != std::string::npos);
+    CHECK(stream.find("7\r\nchunk4;\r\n0\r\n\r\n") != std::string::npos);
+
+    // The stream ended the body, not the connection.
+    const std::string next = "GET /echo/next HTTP/1.1\r\nConnection: close\r\n\r\n";
+    (void)send(fd, next.data(), next.size(), 0);
+    CHECK(raw_read(fd).find("/echo/next") != std::string::npos);
+    ::close(fd);
+    CHECK(server.get_stats().active_streams == 0);
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE(http_server_json_stream_idles_without_subscribers) {
+    const std::string dir = temp_dir("server_json");
+    std::atomic<int> ticks{ 0 };
+    HTTPServer server;
+    server.add_json_stream("/stats/ticks", 5, [&ticks](JSONWriter& r_writer) {
+        r_writer.begin_object();
+        r_writer.key("tick");
+        r_writer.value(int32_t(ticks.fetch_add(1)));
+        r_writer.end_object();
+    });
+    start_server(server, dir);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK(ticks.load() == 0);
+
+    int fd = raw_connect(server);
+    REQUIRE(fd >= 0);
+    const std::string request = "GET /stats/ticks HTTP/1.1\r\n\r\n";
+    (void)send(fd, request.data(), request.size(), 0);
+    const std::string lines = raw_read(fd, "{\"tick\":2}");
+    CHECK(lines.find("application/x-ndjson") != std::string::npos);
+    CHECK(lines.find("{\"tick\":0}\n") != std::string::npos);
+    CHECK(lines.find("{\"tick\":2}") != std::string::npos);
+    ::close(fd);
+
+    // Once the server notices the hang-up the source stops running.
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (server.get_stats().active_streams != 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    CHECK(server.get_stats().active_streams == 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const int stopped = ticks.load();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK(ticks.load() == stopped);
+    std::filesystem::remove_all(dir);
+}
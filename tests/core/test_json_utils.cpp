@@ -0,0 +1,120 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "test_macros.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <unistd.h>
+
+#include "core/io/json_utils.h"
+
+namespace {
+
+bool parses(const std::string& p_text) {
+    JSONDocument document;
+    return document.parse(p_text) == OK;
+}
+
+} // namespace
+
+TEST_CASE(json_accepts_valid_scalars) {
+    CHECK(parses("[true, false, null]"));
+    CHECK(parses("[0, -0, 1, -12, 0.5, 1e3, 1E+3, -2.5e-3, 10]"));
+    CHECK(parses("{\"a\":1,\"b\":[null],\"c\":\"x\"}"));
+    CHECK(parses("  42  "));
+    CHECK(parses("\"text\""));
+
+    JSONDocument document;
+    REQUIRE(document.parse("{\"n\": -2.5e-3, \"i\": 10, \"t\": true}") == OK);
+    CHECK(document.get_root()["n"].as_double() == -2.5e-3);
+    CHECK(document.get_root()["i"].as_int() == 10);
+    CHECK(document.get_root()["t"].as_bool());
+}
+
+TEST_CASE(json_rejects_malformed_scalars) {
+    // Each starts with a character a valid scalar could start with.
+    const char* invalid[] = { "[tru]", "[nul]", "[fals]", "[truex]", "[nulll]", "[01]", "[1.]", "[-]", "[.5]", "[1e]", "[1e+]", "[-01]",
+        "[1.5.2]", "[0x10]", "{\"a\": nan}", "{\"a\": 1x}", "tru", "-" };
+    for (const char* text : invalid) {
+        JSONDocument document;
+        const bool rejected = document.parse(text) == ERR_PARSE_ERROR;
+        CHECK(rejected);
+        if (!rejected) {
+            std::printf("    accepted: %s\n", text);
+        }
+    }
+    JSONDocument document;
+    CHECK(document.parse("[1, tru]") == ERR_PARSE_ERROR);
+    CHECK(document.get_error_offset() == 4);
+}
+
+TEST_CASE(json_stream_reader_scalars_across_windows) {
+    const std::string path = (std::filesystem::temp_directory_path() / ("patsher_test_json_" + std::to_string(getpid()) + ".json")).string();
+    std::string text = "[";
+    for (int i = 0; i < 2000; i++) {
+        text += (i ? ", " : "") + std::to_string(i * 7919) + ", true, null, -1.25e2";
+    }
+    text += "]";
+    std::ofstream(path, std::ios::binary) << text;
+
+    // A window far smaller than the file cuts scalars at every refill.
+    JSONStreamReader reader;
+    REQUIRE(reader.open(path, 61) == OK);
+    JSONValue value;
+    std::string_view key;
+    int count = 0;
+    bool ok = true;
+    Error err;
+    while ((err = reader.next(value, key)) == OK) {
+        switch (count % 4) {
+            case 0:
+                ok = ok && value.as_int(-1) == int64_t(count / 4) * 7919;
+                break;
+            case 1:
+                ok = ok && value.as_bool();
+                break;
+            case 2:
+                ok = ok && value.is_null();
+                break;
+            case 3:
+                ok = ok && value.as_double() == -125.0;
+                break;
+        }
+        count++;
+    }
+    CHECK(err == ERR_FILE_EOF);
+    CHECK(count == 8000);
+    CHECK(ok);
+    reader.close();
+
+    std::ofstream(path, std::ios::binary) << "[1, 2, tru, 4]";
+    REQUIRE(reader.open(path, 61) == OK);
+    CHECK(reader.next(value, key) == OK);
+    CHECK(reader.next(value, key) == OK);
+    CHECK(reader.next(value, key) == ERR_PARSE_ERROR);
+    reader.close();
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,153 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "test_macros.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "core/object/message_queue.h"
+#include "stubs/test_object.h"
+
+namespace {
+
+struct Recorder : public Object {
+    std::vector<int> values;
+
+    void add(int p_value) { values.push_back(p_value); }
+    void keep(std::shared_ptr<int> p_value) { values.push_back(*p_value); }
+};
+
+} // namespace
+
+TEST_CASE(message_queue_order_across_threads) {
+    MessageQueue queue;
+    Recorder recorder;
+    const ObjectID id = recorder.get_instance_id();
+
+    // Calls from different threads run in submission order.
+    queue.push_call<&Recorder::add>(id, 1);
+    std::thread([&] { queue.push_call<&Recorder::add>(id, 2); }).join();
+    queue.push_call<&Recorder::add>(id, 3);
+    std::thread([&] { queue.push_call<&Recorder::add>(id, 4); }).join();
+    CHECK(queue.flush() == 4);
+    CHECK((recorder.values == std::vector<int>{ 1, 2, 3, 4 }));
+
+    // Concurrent producers keep their own order.
+    recorder.values.clear();
+    const int threads = 4;
+    const int calls = 5000;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&queue, id, t] {
+            for (int i = 0; i < calls; i++) {
+                queue.push_call<&Recorder::add>(id, t * calls + i);
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    CHECK(queue.flush() == uint32_t(threads * calls));
+    REQUIRE(recorder.values.size() == size_t(threads * calls));
+    std::vector<int> last(threads, -1);
+    bool ordered = true;
+    for (int value : recorder.values) {
+        const int t = value / calls;
+        ordered = ordered && value > last[t];
+        last[t] = value;
+    }
+    CHECK(ordered);
+}
+
+TEST_CASE(message_queue_flush_budget) {
+    MessageQueue queue;
+    Recorder recorder;
+    for (int i = 0; i < 10; i++) {
+        queue.push_call<&Recorder::add>(recorder.get_instance_id(), i);
+    }
+    queue.set_flush_budget(4);
+    CHECK(queue.flush(MessageQueue::PHASE_AFTER_PHYSICS) == 4);
+    CHECK(queue.flush(MessageQueue::PHASE_BEFORE_RENDER) == 4);
+    CHECK(queue.flush() == 2);
+    CHECK(queue.flush() == 0);
+    CHECK((recorder.values == std::vector<int>{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+
+    const MessageQueue::Stats stats = queue.get_stats();
+    CHECK(stats.pushed == 10);
+    CHECK(stats.flushed == 10);
+    CHECK(stats.budget_exhausted == 2);
+    CHECK(stats.flushed_per_phase[MessageQueue::PHASE_AFTER_PHYSICS] == 4);
+    CHECK(stats.flushed_per_phase[MessageQueue::PHASE_IDLE] == 2);
+}
+
+TEST_CASE(message_queue_calls_pushed_during_flush_wait) {
+    MessageQueue queue;
+    int runs = 0;
+    // Requeues itself every time it runs; with no budget this used to spin forever.
+    std::function<void()> requeue = [&] {
+        runs++;
+        queue.push_callable(MessageQueue::Message([&requeue] { requeue(); }));
+    };
+    queue.push_callable(MessageQueue::Message([&requeue] { requeue(); }));
+    CHECK(queue.flush() == 1);
+    CHECK(runs == 1);
+    CHECK(queue.flush() == 1);
+    CHECK(runs == 2);
+}
+
+TEST_CASE(message_queue_skips_freed_objects) {
+    MessageQueue queue;
+    std::shared_ptr<int> value = std::make_shared<int>(7);
+    Recorder kept;
+    ObjectID freed_id;
+    {
+        Recorder freed;
+        freed_id = freed.get_instance_id();
+        queue.push_call<&Recorder::keep>(freed_id, value);
+        queue.push_call<&Recorder::keep>(kept.get_instance_id(), value);
+    }
+    CHECK(value.use_count() == 3);
+    CHECK(queue.flush() == 2);
+    CHECK((kept.values == std::vector<int>{ 7 }));
+    CHECK(queue.get_stats().dropped_freed == 1);
+    // The arguments of the dropped call are destroyed too.
+    CHECK(value.use_count() == 1);
+}
+
+TEST_CASE(message_queue_thread_buffer_limit) {
+    MessageQueue queue;
+    Recorder recorder;
+    queue.set_max_thread_bytes(128 * 1024);
+    Error err = OK;
+    int pushed = 0;
+    while (err == OK && pushed < 100000) {
+        err = queue.push_call<&Recorder::add>(recorder.get_instance_id(), pushed);
+        pushed += err == OK ? 1 : 0;
+    }
+    CHECK(err == ERR_OUT_OF_MEMORY);
+    CHECK(queue.get_stats().overflowed == 1);
+    CHECK(queue.flush() == uint32_t(pushed));
+    CHECK(queue.push_call<&Recorder::add>(recorder.get_instance_id(), 0) == OK);
+}
@@ -0,0 +1,242 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "test_macros.h"
+
+#include <cstring>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "core/object/object_pool.h"
+
+#if defined(__SANITIZE_ADDRESS__)
+#define TEST_ASAN
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define TEST_ASAN
+#endif
+#endif
+
+#ifdef TEST_ASAN
+#include <sanitizer/asan_interface.h>
+#endif
+
+namespace {
+
+const size_t SIZE_CLASSES[] = {
+    16, 32, 48, 64, 80, 96, 112, 128,
+    160, 192, 224, 256, 320, 384, 448, 512,
+    640, 768, 896, 1024, 1280, 1536, 1792, 2048
+};
+
+ObjectPool::ClassStats raw_stats("raw");
+
+bool is_poisoned(const void* p_ptr, size_t p_offset) {
+#ifdef TEST_ASAN
+    return __asan_address_is_poisoned(static_cast<const char*>(p_ptr) + p_offset) != 0;
+#else
+    (void)p_ptr;
+    (void)p_offset;
+    return true;
+#endif
+}
+
+class Shape {
+public:
+    MCLASS_POOLED(Shape);
+
+public:
+    int sides = 0;
+    virtual ~Shape() {}
+};
+
+// Not pooled itself: counted under Shape, in a larger size class.
+class Polygon : public Shape {
+public:
+    char points[200] = {};
+};
+
+class Circle : public Shape {
+    MCLASS_POOLED(Circle);
+
+public:
+    double radius = 1.0;
+};
+
+class Huge : public Shape {
+public:
+    char data[ObjectPool::MAX_POOLED_SIZE * 2] = {};
+};
+
+} // namespace
+
+TEST_CASE(object_pool_every_size_class) {
+    for (size_t size : SIZE_CLASSES) {
+        // The smallest and the largest request of the class.
+        const size_t smallest = size == 16 ? 1 : size - 15;
+        for (size_t request : { smallest, size }) {
+            std::vector<unsigned char*> blocks;
+            for (int i = 0; i < 64; i++) {
+                unsigned char* block = static_cast<unsigned char*>(ObjectPool::allocate(request, raw_stats));
+                CHECK(reinterpret_cast<uintptr_t>(block) % 16 == 0);
+                memset(block, i, request);
+                blocks.push_back(block);
+            }
+            // Blocks of a class do not overlap.
+            for (int i = 0; i < 64; i++) {
+                bool intact = true;
+                for (size_t b = 0; b < request; b++) {
+                    intact = intact && blocks[i][b] == static_cast<unsigned char>(i);
+                }
+                CHECK(intact);
+                // Past the request is off limits under ASan.
+                if (request < size) {
+                    CHECK(is_poisoned(blocks[i], request));
+                }
+            }
+            for (unsigned char* block : blocks) {
+                ObjectPool::free(block, request, raw_stats);
+                CHECK(is_poisoned(block, size - 1));
+            }
+            // The thread cache hands the last freed block back first.
+            void* again = ObjectPool::allocate(request, raw_stats);
+            CHECK(again == blocks.back());
+            ObjectPool::free(again, request, raw_stats);
+        }
+    }
+    CHECK(raw_stats.live.load() == 0);
+    CHECK(raw_stats.allocs.load() == raw_stats.frees.load());
+
+    const uint64_t fallbacks = ObjectPool::get_stats().heap_fallbacks;
+    void* large = ObjectPool::allocate(ObjectPool::MAX_POOLED_SIZE + 1, raw_stats);
+    memset(large, 1, ObjectPool::MAX_POOLED_SIZE + 1);
+    ObjectPool::free(large, ObjectPool::MAX_POOLED_SIZE + 1, raw_stats);
+    CHECK(ObjectPool::get_stats().heap_fallbacks == fallbacks + 1);
+}
+
+TEST_CASE(object_pool_cross_thread_frees) {
+    const size_t size = 1792;
+    const int count = 1000;
+    ObjectPool::flush_thread_cache();
+
+    std::vector<void*> blocks;
+    for (int i = 0; i < count; i++) {
+        blocks.push_back(ObjectPool::allocate(size, raw_stats));
+    }
+    const std::set<void*> first(blocks.begin(), blocks.end());
+    const size_t slabs = ObjectPool::get_stats().slabs;
+
+    // Freed on a worker: its cache goes back to the global lists when the
+    // thread exits, and this thread allocates the same blocks again.
+    std::thread([&] {
+        for (void* block : blocks) {
+            ObjectPool::free(block, size, raw_stats);
+        }
+    }).join();
+    CHECK(raw_stats.live.load() == 0);
+    ObjectPool::flush_thread_cache();
+
+    // A few blocks cached here before come back first; the rest are the
+    // worker's, and no slab is added.
+    blocks.clear();
+    size_t reused = 0;
+    for (int i = 0; i < count; i++) {
+        blocks.push_back(ObjectPool::allocate(size, raw_stats));
+        reused += first.count(blocks.back());
+    }
+    CHECK(ObjectPool::get_stats().slabs == slabs);
+    CHECK(reused >= size_t(count) - 64);
+    for (void* block : blocks) {
+        ObjectPool::free(block, size, raw_stats);
+    }
+
+    // Producer and consumer threads at once.
+    const int threads = 4;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([] {
+            std::vector<Circle*> made;
+            for (int i = 0; i < count; i++) {
+                made.push_back(new Circle);
+            }
+            std::thread([&made] {
+                for (Circle* circle : made) {
+                    delete circle;
+                }
+            }).join();
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    CHECK(Circle::get_pool_stats().live.load() == 0);
+    CHECK(Circle::get_pool_stats().allocs.load() == uint64_t(threads * count));
+}
+
+TEST_CASE(object_pool_class_new_delete) {
+    ObjectPool::ClassStats& shapes = Shape::get_pool_stats();
+    ObjectPool::ClassStats& circles = Circle::get_pool_stats();
+    const uint64_t shape_allocs = shapes.allocs.load();
+    const uint64_t circle_allocs = circles.allocs.load();
+
+    // Deleting through the base frees with the size of the real class.
+    Shape* polygon = new Polygon;
+    polygon->sides = 5;
+    memset(static_cast<Polygon*>(polygon)->points, 7, sizeof(Polygon::points));
+    delete polygon;
+    Shape* again = new Polygon;
+    CHECK(again == polygon);
+    delete again;
+    CHECK(shapes.allocs.load() == shape_allocs + 2);
+    CHECK(shapes.live.load() == 0);
+
+    // A subclass with its own MCLASS_POOLED is counted on its own.
+    Shape* circle = new Circle;
+    CHECK(circles.live.load() == 1);
+    CHECK(shapes.live.load() == 0);
+    delete circle;
+    CHECK(circles.allocs.load() == circle_allocs + 1 && circles.live.load() == 0);
+
+    // Too large for the slabs: new and delete both take the heap.
+    const uint64_t fallbacks = ObjectPool::get_stats().heap_fallbacks;
+    Shape* huge = new Huge;
+    delete huge;
+    CHECK(ObjectPool::get_stats().heap_fallbacks == fallbacks + 1);
+    CHECK(shapes.live.load() == 0);
+
+    // Arrays and placement new are not pooled.
+    Circle* many = new Circle[3];
+    delete[] many;
+    CHECK(circles.allocs.load() == circle_allocs + 1);
+    alignas(Circle) unsigned char buffer[sizeof(Circle)];
+    Circle* placed = new (buffer) Circle;
+    placed->~Circle();
+    CHECK(circles.allocs.load() == circle_allocs + 1);
+
+    bool listed = false;
+    for (const ObjectPool::ClassStatsSnapshot& snapshot : ObjectPool::get_class_stats()) {
+        listed = listed || strcmp(snapshot.class_name, "Circle") == 0;
+    }
+    CHECK(listed);
+}
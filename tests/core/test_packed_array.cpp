@@ -0,0 +1,125 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "test_macros.h"
+
+#include "core/variant/array.h"
+
+namespace {
+
+bool equals(const PackedInt32Array& p_array, std::initializer_list<int32_t> p_values) {
+    return p_array == PackedInt32Array(p_values);
+}
+
+} // namespace
+
+TEST_CASE(packed_slice_write_leaves_parent) {
+    PackedInt32Array parent = { 1, 2, 3, 4, 5 };
+    PackedInt32Array slice = parent.slice(1, 4);
+    CHECK(slice.ptr() == parent.ptr() + 1);
+    CHECK(parent.is_shared());
+
+    slice.set(0, 20);
+    slice.push_back(50);
+    CHECK(equals(slice, { 20, 3, 4, 50 }));
+    CHECK(equals(parent, { 1, 2, 3, 4, 5 }));
+    CHECK(!parent.is_shared());
+
+    // A slice whose parent is gone trims the buffer in place.
+    PackedInt32Array tail = parent.slice(3);
+    parent = PackedInt32Array();
+    tail.ptrw()[0] = 40;
+    CHECK(equals(tail, { 40, 5 }));
+}
+
+TEST_CASE(packed_resize_shrinks_shared_view) {
+    PackedInt32Array a = { 1, 2, 3, 4 };
+    PackedInt32Array b = a;
+    const int32_t* shared = a.ptr();
+
+    b.resize(2);
+    CHECK(b.ptr() == shared);
+    CHECK(equals(b, { 1, 2 }));
+    CHECK(equals(a, { 1, 2, 3, 4 }));
+
+    // Growing again must not bring back the hidden elements.
+    b.resize(3);
+    CHECK(equals(b, { 1, 2, 0 }));
+    CHECK(equals(a, { 1, 2, 3, 4 }));
+    b.push_back(9);
+    CHECK(equals(b, { 1, 2, 0, 9 }));
+    CHECK(equals(a, { 1, 2, 3, 4 }));
+}
+
+TEST_CASE(packed_append_self) {
+    PackedInt32Array a = { 1, 2, 3 };
+    a.append_array(a);
+    CHECK(equals(a, { 1, 2, 3, 1, 2, 3 }));
+
+    PackedInt32Array copy = a;
+    a.append_array(a.slice(-2));
+    CHECK(equals(a, { 1, 2, 3, 1, 2, 3, 2, 3 }));
+    CHECK(equals(copy, { 1, 2, 3, 1, 2, 3 }));
+
+    // Appending from our own buffer by pointer, with room to reallocate.
+    PackedInt32Array b = { 7, 8 };
+    for (int i = 0; i < 4; i++) {
+        b.append_array(b.ptr(), b.size());
+    }
+    CHECK(b.size() == 32);
+    CHECK(b[30] == 7 && b[31] == 8);
+}
+
+TEST_CASE(packed_fill_shared) {
+    PackedInt32Array a = { 1, 2, 3, 4 };
+    PackedInt32Array b = a;
+    b.fill(7);
+    CHECK(equals(b, { 7, 7, 7, 7 }));
+    CHECK(equals(a, { 1, 2, 3, 4 }));
+    CHECK(!a.is_shared() && !b.is_shared());
+
+    PackedInt32Array slice = a.slice(1, 3);
+    slice.fill(0);
+    CHECK(equals(slice, { 0, 0 }));
+    CHECK(equals(a, { 1, 2, 3, 4 }));
+
+    // The fill value may live in the array itself.
+    a.fill(a[3]);
+    CHECK(equals(a, { 4, 4, 4, 4 }));
+}
+
+TEST_CASE(packed_negative_slice_indices) {
+    const PackedInt32Array a = { 0, 1, 2, 3, 4 };
+    CHECK(equals(a.slice(-2), { 3, 4 }));
+    CHECK(equals(a.slice(1, -1), { 1, 2, 3 }));
+    CHECK(equals(a.slice(-4, -2), { 1, 2 }));
+    CHECK(equals(a.slice(-100, 2), { 0, 1 }));
+    CHECK(a.slice(-1, -3).is_empty());
+    CHECK(a.slice(3, -100).is_empty());
+    CHECK(a.slice(10).is_empty());
+
+    // Slices of slices resolve against the slice, not the parent.
+    const PackedInt32Array inner = a.slice(1, 4).slice(-2);
+    CHECK(equals(inner, { 2, 3 }));
+    CHECK(inner.ptr() == a.ptr() + 2);
+}
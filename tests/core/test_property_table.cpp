@@ -0,0 +1,179 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "test_macros.h"
+
+#include <string>
+
+#include "core/object/property_table.h"
+#include "stubs/test_object.h"
+
+namespace {
+
+struct Mixin {
+    virtual ~Mixin() {}
+    double padding[3] = {};
+};
+
+// Two RAW property types of the same size.
+struct Cell {
+    int32_t x = 0;
+    int32_t y = 0;
+};
+
+struct Offset {
+    float x = 0.0f;
+    float y = 0.0f;
+};
+
+// Object is not the first base, so Sprite* and Object* differ.
+struct Sprite : public Mixin, public Object {
+    int32_t frame = 0;
+    float speed = 1.0f;
+    std::string name;
+    Cell cell;
+    Offset offset;
+
+    float get_double_speed() const { return speed * 2.0f; }
+    int32_t get_frame() const { return frame; }
+    void set_frame(int32_t p_frame) { frame = p_frame * 10; }
+};
+
+struct AnimatedSprite : public Sprite {
+    bool playing = false;
+};
+
+PropertyTable& sprite_table() {
+    static PropertyTable table(nullptr, "Sprite");
+    static bool bound = [] {
+        MPROPERTY(table, Sprite, frame);
+        MPROPERTY(table, Sprite, speed);
+        MPROPERTY(table, Sprite, name);
+        MPROPERTY(table, Sprite, cell);
+        MPROPERTY(table, Sprite, offset);
+        MPROPERTY_READ_ONLY(table, Sprite, float, "double_speed", get_double_speed);
+        return true;
+    }();
+    (void)bound;
+    return table;
+}
+
+} // namespace
+
+TEST_CASE(property_member_through_non_primary_base) {
+    const PropertyTable& table = sprite_table();
+    Sprite sprite;
+    Object* object = &sprite;
+    REQUIRE(static_cast<void*>(object) != static_cast<void*>(&sprite));
+
+    int frame = table.find("frame");
+    int speed = table.find("speed");
+    int32_t new_frame = 7;
+    float new_speed = 3.5f;
+    CHECK(table.set(object, frame, &new_frame));
+    CHECK(table.set(object, speed, &new_speed));
+    CHECK(sprite.frame == 7);
+    CHECK(sprite.speed == 3.5f);
+
+    int32_t read_frame = 0;
+    CHECK(table.get(object, frame, &read_frame));
+    CHECK(read_frame == 7);
+    CHECK(table.get_info(frame).is_member());
+}
+
+TEST_CASE(property_non_trivial_and_read_only) {
+    const PropertyTable& table = sprite_table();
+    Sprite sprite;
+    std::string name = "hero";
+    CHECK(table.set(&sprite, table.find("name"), &name));
+    CHECK(sprite.name == "hero");
+
+    int double_speed = table.find("double_speed");
+    CHECK(table.get_info(double_speed).is_read_only());
+    float value = 0.0f;
+    CHECK(table.get(&sprite, double_speed, &value));
+    CHECK(value == 2.0f);
+    CHECK(!table.set(&sprite, double_speed, &value));
+}
+
+TEST_CASE(property_raw_types_do_not_alias) {
+    const PropertyTable& table = sprite_table();
+    const int cell = table.find("cell");
+    const int offset = table.find("offset");
+    REQUIRE(table.get_info(cell).type == PROPERTY_TYPE_RAW && table.get_info(offset).type == PROPERTY_TYPE_RAW);
+    REQUIRE(table.get_info(cell).size == table.get_info(offset).size);
+    CHECK(table.is_type<Cell>(cell));
+    CHECK(!table.is_type<Offset>(cell));
+    CHECK(table.is_type<Offset>(offset));
+    CHECK(!table.is_type<Cell>(offset));
+    CHECK(table.is_type<int32_t>(table.find("frame")));
+    CHECK(!table.is_type<float>(table.find("frame")));
+    CHECK(!table.is_type<Cell>(-1));
+}
+
+TEST_CASE(property_derived_table_keeps_indices) {
+    PropertyTable table(&sprite_table(), "AnimatedSprite");
+    int playing = MPROPERTY(table, AnimatedSprite, playing);
+    CHECK(table.find("frame") == sprite_table().find("frame"));
+    CHECK(playing == sprite_table().get_count());
+
+    // Override the inherited slot with an accessor.
+    int frame = MPROPERTY_ACCESSOR(table, Sprite, int32_t, "frame", get_frame, set_frame);
+    CHECK(frame == sprite_table().find("frame"));
+
+    AnimatedSprite sprite;
+    int32_t value = 4;
+    bool on = true;
+    CHECK(table.set(&sprite, frame, &value));
+    CHECK(table.set(&sprite, playing, &on));
+    CHECK(sprite.frame == 40);
+    CHECK(sprite.playing);
+}
+
+TEST_CASE(property_batch_skips_invalid_indices) {
+    const PropertyTable& table = sprite_table();
+    Sprite sprite;
+    sprite.frame = 3;
+    sprite.speed = 0.5f;
+
+    int32_t frame = -1;
+    float speed = -1.0f;
+    int32_t untouched = 99;
+    const int indices[] = { table.find("frame"), -1, table.find("speed"), table.get_count() };
+    void* const values[] = { &frame, &untouched, &speed, &untouched };
+    CHECK(!table.get_batch(&sprite, indices, 4, values));
+    CHECK(frame == 3);
+    CHECK(speed == 0.5f);
+    CHECK(untouched == 99);
+
+    const int valid[] = { table.find("frame"), table.find("speed") };
+    int32_t new_frame = 12;
+    float new_speed = 4.0f;
+    const void* const new_values[] = { &new_frame, &new_speed };
+    CHECK(table.set_batch(&sprite, valid, 2, new_values));
+    CHECK(sprite.frame == 12);
+    CHECK(sprite.speed == 4.0f);
+
+    CHECK(!table.get(&sprite, 1000, &frame));
+    CHECK(!table.set(&sprite, -5, &new_frame));
+}
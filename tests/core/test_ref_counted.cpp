@@ -0,0 +1,167 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "test_macros.h"
+
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "core/object/ref_counted.h"
+
+namespace {
+
+struct Counted : public RefCounted {
+    static int alive;
+    int value = 0;
+    Counted() { alive++; }
+    ~Counted() { alive--; }
+};
+int Counted::alive = 0;
+
+struct Derived : public Counted {};
+
+struct Local : public RefCountedLocal {
+    static int alive;
+    Local() { alive++; }
+    ~Local() { alive--; }
+};
+int Local::alive = 0;
+
+} // namespace
+
+TEST_CASE(ref_deletes_on_last_release) {
+    {
+        Ref<Counted> a;
+        a.instantiate();
+        CHECK(a->get_reference_count() == 1);
+        Ref<Counted> b = a;
+        CHECK(a->get_reference_count() == 2);
+        b.unref();
+        CHECK(a->get_reference_count() == 1);
+        CHECK(Counted::alive == 1);
+    }
+    CHECK(Counted::alive == 0);
+}
+
+TEST_CASE(ref_move_has_no_count_traffic) {
+    Ref<Counted> a;
+    a.instantiate();
+    Counted* raw = a.get_ptr();
+    Ref<Counted> b = std::move(a);
+    CHECK(a.is_null());
+    CHECK(b.get_ptr() == raw);
+    CHECK(raw->get_reference_count() == 1);
+
+    Ref<Counted> c;
+    c = std::move(b);
+    CHECK(raw->get_reference_count() == 1);
+
+    std::vector<Ref<Counted>> list;
+    list.push_back(std::move(c));
+    for (int i = 0; i < 100; i++) {
+        list.insert(list.begin(), Ref<Counted>()); // Reallocations move.
+    }
+    CHECK(raw->get_reference_count() == 1);
+    list.clear();
+    CHECK(Counted::alive == 0);
+}
+
+TEST_CASE(ref_converting_move_and_copy) {
+    Ref<Derived> derived;
+    derived.instantiate();
+    Ref<Counted> base = derived;
+    CHECK(derived->get_reference_count() == 2);
+    Ref<Counted> moved = std::move(derived);
+    CHECK(derived.is_null());
+    CHECK(moved->get_reference_count() == 2);
+    moved.unref();
+    base.unref();
+    CHECK(Counted::alive == 0);
+}
+
+TEST_CASE(ref_self_assignment_keeps_object) {
+    Ref<Counted> a;
+    a.instantiate();
+    Ref<Counted>& alias = a;
+    a = alias;
+    a.ref_pointer(a.get_ptr());
+    CHECK(a.is_valid());
+    CHECK(a->get_reference_count() == 1);
+}
+
+TEST_CASE(weak_ref_tracks_lifetime) {
+    WeakRef<Counted> weak;
+    CHECK(!weak.is_valid());
+    {
+        Ref<Counted> strong;
+        strong.instantiate();
+        strong->value = 7;
+        weak = strong;
+        WeakRef<Counted> copy = weak;
+        CHECK(weak.is_valid());
+        Ref<Counted> locked = copy.lock();
+        REQUIRE(locked.is_valid());
+        CHECK(locked->value == 7);
+        CHECK(strong->get_reference_count() == 2);
+    }
+    CHECK(!weak.is_valid());
+    CHECK(weak.lock().is_null());
+    CHECK(Counted::alive == 0);
+}
+
+TEST_CASE(local_policy_same_api) {
+    WeakRef<Local> weak;
+    {
+        Ref<Local> a;
+        a.instantiate();
+        Ref<Local> b = a;
+        CHECK(a->get_reference_count() == 2);
+        weak = b;
+        CHECK(weak.lock().is_valid());
+    }
+    CHECK(Local::alive == 0);
+    CHECK(weak.lock().is_null());
+}
+
+TEST_CASE(atomic_count_across_threads) {
+    Ref<Counted> shared;
+    shared.instantiate();
+    WeakRef<Counted> weak = shared;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&shared, &weak] {
+            for (int i = 0; i < 20000; i++) {
+                Ref<Counted> copy = shared;
+                Ref<Counted> locked = weak.lock();
+                (void)locked;
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    CHECK(shared->get_reference_count() == 1);
+    shared.unref();
+    CHECK(Counted::alive == 0);
+}
@@ -0,0 +1,304 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "test_macros.h"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/io/file_system_memory.h"
+#include "core/io/resources.h"
+
+namespace {
+
+std::atomic<int> blobs_alive{ 0 };
+
+struct Blob : public RefCounted {
+    std::string data;
+
+    Blob() { blobs_alive++; }
+    ~Blob() { blobs_alive--; }
+};
+
+// The loader every case registers: a Blob holding the file, sized by it.
+Error load_blob(Span<const uint8_t> p_data, Ref<RefCounted>& r_resource, uint64_t& r_bytes) {
+    Ref<Blob> blob;
+    blob.instantiate();
+    blob->data.assign(reinterpret_cast<const char*>(p_data.data()), p_data.size());
+    r_bytes = p_data.size();
+    r_resource = blob;
+    return OK;
+}
+
+void write(FileSystemMemory& r_fs, const std::string& p_path, size_t p_size) {
+    r_fs.write_file(p_path, std::vector<uint8_t>(p_size, 'x'));
+}
+
+const ResourceCache::TypeStats* find_type(const ResourceCache::Stats& p_stats, const char* p_type) {
+    for (const ResourceCache::TypeStats& type : p_stats.types) {
+        if (type.type == p_type) {
+            return &type;
+        }
+    }
+    return nullptr;
+}
+
+bool wait_for(const std::atomic<int>& p_value, int p_expected) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (p_value.load() != p_expected) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+} // namespace
+
+TEST_CASE(resource_cache_shares_in_flight_load) {
+    FileSystemMemory fs;
+    write(fs, "res://shared.blob", 10);
+    ResourceCache cache;
+    std::atomic<int> calls{ 0 };
+    std::atomic<bool> release{ false };
+    cache.register_loader("Blob", { "blob" }, [&](const std::string& p_path, Span<const uint8_t> p_data, Ref<RefCounted>& r_resource, uint64_t& r_bytes) {
+        calls++;
+        while (!release.load()) {
+            std::this_thread::yield();
+        }
+        if (p_path.find("missing") != std::string::npos) {
+            return ERR_FILE_CORRUPT;
+        }
+        return load_blob(p_data, r_resource, r_bytes);
+    });
+
+    // The second thread finds the load in flight and waits for it.
+    Ref<RefCounted> first;
+    Ref<RefCounted> second;
+    Error first_error = FAILED;
+    Error second_error = FAILED;
+    std::thread a([&] { first_error = cache.load("res://shared.blob", first); });
+    REQUIRE(wait_for(calls, 1));
+    std::thread b([&] { second_error = cache.load("res://./shared.blob", second); });
+    while (cache.get_stats().shared_loads == 0) {
+        std::this_thread::yield();
+    }
+    release = true;
+    a.join();
+    b.join();
+    CHECK(first_error == OK && second_error == OK);
+    CHECK(first.is_valid() && first == second);
+    CHECK(calls.load() == 1);
+    ResourceCache::Stats stats = cache.get_stats();
+    CHECK(stats.misses == 1 && stats.hits == 0 && stats.shared_loads == 1);
+
+    // A failed load fails its waiters too, and is not cached.
+    write(fs, "res://missing.blob", 1);
+    release = false;
+    calls = 0;
+    std::thread c([&] { first_error = cache.load("res://missing.blob", first); });
+    REQUIRE(wait_for(calls, 1));
+    std::thread d([&] { second_error = cache.load("res://missing.blob", second); });
+    while (cache.get_stats().shared_loads == 1) {
+        std::this_thread::yield();
+    }
+    release = true;
+    c.join();
+    d.join();
+    CHECK(first_error == ERR_FILE_CORRUPT && second_error == ERR_FILE_CORRUPT);
+    CHECK(first.is_null() && second.is_null());
+    CHECK(calls.load() == 1);
+    CHECK(!cache.has("res://missing.blob"));
+    CHECK(cache.load("res://missing.blob", first) == ERR_FILE_CORRUPT);
+    CHECK(calls.load() == 2);
+    CHECK(cache.get_stats().failed_loads == 2); // Counted per load, not per waiter.
+}
+
+TEST_CASE(resource_cache_lru_eviction_and_demotion) {
+    FileSystemMemory fs;
+    for (const char* name : { "a", "b", "c", "d" }) {
+        write(fs, std::string("res://") + name + ".blob", 100);
+    }
+    ResourceCache cache;
+    cache.register_loader("Blob", { "blob" }, [](const std::string&, Span<const uint8_t> p_data, Ref<RefCounted>& r_resource, uint64_t& r_bytes) {
+        return load_blob(p_data, r_resource, r_bytes);
+    });
+    cache.set_budget(300);
+    const int alive = blobs_alive.load();
+
+    Ref<RefCounted> held;
+    {
+        Ref<RefCounted> resource;
+        REQUIRE(cache.load("res://a.blob", resource) == OK);
+        REQUIRE(cache.load("res://b.blob", held) == OK);
+        REQUIRE(cache.load("res://c.blob", resource) == OK);
+        // a becomes the most recently used; b is now the oldest.
+        REQUIRE(cache.load("res://a.blob", resource) == OK);
+    }
+    CHECK(blobs_alive.load() == alive + 3);
+    CHECK(cache.get_stats().bytes_resident == 300);
+
+    // Over budget: b is still in use, so it is demoted to weak; c only
+    // the cache holds, so it is dropped.
+    Ref<RefCounted> d;
+    REQUIRE(cache.load("res://d.blob", d) == OK);
+    ResourceCache::Stats stats = cache.get_stats();
+    CHECK(stats.demotions == 1 && stats.evictions == 1);
+    CHECK(stats.bytes_resident == 300);
+    CHECK(cache.has("res://a.blob") && cache.has("res://b.blob") && !cache.has("res://c.blob"));
+    CHECK(blobs_alive.load() == alive + 3);
+
+    // The weak entry still deduplicates while its user lives.
+    Ref<RefCounted> again = cache.get("res://b.blob");
+    CHECK(again == held);
+    again.unref();
+
+    // Its last user frees it; the entry goes with it.
+    held.unref();
+    CHECK(blobs_alive.load() == alive + 2);
+    CHECK(!cache.has("res://b.blob"));
+    stats = cache.get_stats();
+    CHECK(stats.entries == 2 && stats.bytes_resident == 200);
+
+    // Reloading a dropped entry is a miss.
+    cache.reset_stats();
+    Ref<RefCounted> c;
+    REQUIRE(cache.load("res://c.blob", c) == OK);
+    CHECK(cache.get_stats().misses == 1);
+
+    // A weak load is never kept by the cache alone.
+    Ref<RefCounted> weak;
+    REQUIRE(cache.load("res://b.blob", weak, ResourceCache::CACHE_WEAK) == OK);
+    const int with_weak = blobs_alive.load();
+    weak.unref();
+    CHECK(blobs_alive.load() == with_weak - 1);
+    CHECK(!cache.has("res://b.blob"));
+
+    cache.trim(0);
+    CHECK(cache.get_stats().bytes_resident == 200); // c and d are still in use.
+    d.unref();
+    c.unref();
+    cache.clear();
+    CHECK(blobs_alive.load() == alive);
+}
+
+TEST_CASE(resource_cache_pin_nesting) {
+    FileSystemMemory fs;
+    write(fs, "res://pinned.blob", 50);
+    write(fs, "res://other.blob", 50);
+    ResourceCache cache;
+    cache.register_loader("Blob", { "blob" }, [](const std::string&, Span<const uint8_t> p_data, Ref<RefCounted>& r_resource, uint64_t& r_bytes) {
+        return load_blob(p_data, r_resource, r_bytes);
+    });
+
+    CHECK(!cache.pin("res://pinned.blob")); // Not loaded.
+    Ref<RefCounted> resource;
+    REQUIRE(cache.load("res://pinned.blob", resource) == OK);
+    REQUIRE(cache.load("res://other.blob", resource) == OK);
+    resource.unref();
+
+    CHECK(cache.pin("res://pinned.blob"));
+    CHECK(cache.pin("res://pinned.blob"));
+    CHECK(cache.get_stats().pinned == 1);
+    cache.trim(0);
+    CHECK(cache.has("res://pinned.blob"));
+    CHECK(!cache.has("res://other.blob"));
+
+    CHECK(cache.unpin("res://pinned.blob"));
+    CHECK(cache.is_pinned("res://pinned.blob"));
+    cache.trim(0);
+    CHECK(cache.has("res://pinned.blob"));
+
+    CHECK(cache.unpin("res://pinned.blob"));
+    CHECK(!cache.is_pinned("res://pinned.blob"));
+    CHECK(!cache.unpin("res://pinned.blob"));
+    cache.trim(0);
+    CHECK(!cache.has("res://pinned.blob"));
+
+    // Pinning a weak entry makes the cache keep it.
+    Ref<RefCounted> weak;
+    REQUIRE(cache.load("res://other.blob", weak, ResourceCache::CACHE_WEAK) == OK);
+    CHECK(cache.pin("res://other.blob"));
+    weak.unref();
+    CHECK(cache.has("res://other.blob"));
+    cache.set_budget(1);
+    CHECK(cache.has("res://other.blob"));
+    CHECK(cache.unpin("res://other.blob")); // Back under the budget rule.
+    CHECK(!cache.has("res://other.blob"));
+}
+
+TEST_CASE(resource_cache_per_type_accounting) {
+    FileSystemMemory fs;
+    write(fs, "res://hero.png", 100);
+    write(fs, "res://tree.PNG", 50);
+    write(fs, "res://sky.jpg", 10);
+    write(fs, "res://hit.wav", 200);
+    ResourceCache cache;
+    const ResourceCache::Loader loader = [](const std::string&, Span<const uint8_t> p_data, Ref<RefCounted>& r_resource, uint64_t& r_bytes) {
+        return load_blob(p_data, r_resource, r_bytes);
+    };
+    cache.register_loader("Texture", { "png", "jpg" }, loader);
+    cache.register_loader("Audio", { "wav" }, loader);
+
+    Ref<RefCounted> resource;
+    for (const char* path : { "res://hero.png", "res://tree.PNG", "res://sky.jpg", "res://hit.wav" }) {
+        REQUIRE(cache.load(path, resource) == OK);
+    }
+    CHECK(cache.load("res://notes.txt", resource) == ERR_FILE_UNRECOGNIZED);
+
+    ResourceCache::Stats stats = cache.get_stats();
+    const ResourceCache::TypeStats* textures = find_type(stats, "Texture");
+    const ResourceCache::TypeStats* audio = find_type(stats, "Audio");
+    REQUIRE(textures && audio);
+    CHECK(textures->count == 3 && textures->bytes == 160);
+    CHECK(audio->count == 1 && audio->bytes == 200);
+    CHECK(stats.bytes_resident == 360 && stats.entries == 4);
+
+    // Resizing, invalidating and adding update the type they belong to.
+    CHECK(cache.set_resource_size("res://hero.png", 400));
+    CHECK(cache.invalidate("res://hit.wav"));
+    Ref<Blob> mesh;
+    mesh.instantiate();
+    cache.add("res://procedural/mesh", "Mesh", mesh, 30);
+    stats = cache.get_stats();
+    CHECK(find_type(stats, "Texture")->bytes == 460);
+    CHECK(find_type(stats, "Audio")->count == 0 && find_type(stats, "Audio")->bytes == 0);
+    CHECK(find_type(stats, "Mesh")->count == 1 && find_type(stats, "Mesh")->bytes == 30);
+    CHECK(stats.bytes_resident == 490);
+
+    // Replacing an entry does not count it twice.
+    cache.add("res://procedural/mesh", "Mesh", mesh, 40);
+    stats = cache.get_stats();
+    CHECK(find_type(stats, "Mesh")->count == 1 && find_type(stats, "Mesh")->bytes == 40);
+
+    cache.clear();
+    stats = cache.get_stats();
+    for (const ResourceCache::TypeStats& type : stats.types) {
+        CHECK(type.count == 0 && type.bytes == 0);
+    }
+    CHECK(stats.bytes_resident == 0 && stats.entries == 0);
+}
@@ -0,0 +1,230 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "test_macros.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "core/object/script_cache.h"
+#include "thirdparty/duktape/duktape.h"
+#include "thirdparty/lua/lua.hpp"
+
+namespace {
+
+const char* JS_SOURCE = "(function () { return 6 * 7; })()";
+const char* LUA_SOURCE = "return { answer = 42 }";
+
+// Entry layout from script_cache.cpp: magic, language, hash, source size,
+// payload size, payload hash, then the payload.
+const size_t HEADER_SIZE = 40;
+const size_t SOURCE_SIZE_OFFSET = 16;
+
+std::string temp_dir(const char* p_name) {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / ("patsher_test_script_cache_" + std::to_string(getpid()) + "_" + p_name);
+    std::filesystem::remove_all(path);
+    std::filesystem::create_directories(path);
+    return path.string();
+}
+
+std::string entry_path(ScriptCache::Language p_language, const std::string& p_source) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx%s", static_cast<unsigned long long>(ScriptCache::hash_source(p_language, p_source.data(), p_source.size())),
+            p_language == ScriptCache::LANGUAGE_LUA ? ".luac" : ".jsbc");
+    return (std::filesystem::path(ScriptCache::get_cache_dir()) / name).string();
+}
+
+std::string read_file(const std::string& p_path) {
+    std::ifstream in(p_path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void write_file(const std::string& p_path, const std::string& p_data) {
+    std::ofstream(p_path, std::ios::binary | std::ios::trunc).write(p_data.data(), p_data.size());
+}
+
+// Loads p_source in a fresh heap and runs it; -1 when it does not load.
+int run_duktape(const std::string& p_source, bool p_trusted = false) {
+    duk_context* ctx = duk_create_heap_default();
+    int result = -1;
+    if (ScriptCache::load_duktape(ctx, p_source, "test.js", p_trusted) == OK && duk_pcall(ctx, 0) == DUK_EXEC_SUCCESS) {
+        result = duk_get_int(ctx, -1);
+    }
+    duk_destroy_heap(ctx);
+    return result;
+}
+
+// The chunk that load_lua() left on the stack, or "" when it failed.
+std::string load_lua(const std::string& p_source, bool p_trusted = false) {
+    lua_State* L = luaL_newstate();
+    std::string chunk;
+    if (ScriptCache::load_lua(L, p_source, "test.lua", p_trusted) == OK) {
+        chunk = lua_tostring(L, -1);
+    }
+    lua_close(L);
+    return chunk;
+}
+
+ScriptCache::Stats stats_since(const ScriptCache::Stats& p_before) {
+    ScriptCache::Stats now = ScriptCache::get_stats();
+    now.hits -= p_before.hits;
+    now.misses -= p_before.misses;
+    now.writes -= p_before.writes;
+    now.rejected -= p_before.rejected;
+    return now;
+}
+
+} // namespace
+
+TEST_CASE(script_cache_miss_then_hit) {
+    const std::string dir = temp_dir("hit");
+    ScriptCache::set_cache_dir(dir);
+    const ScriptCache::Stats before = ScriptCache::get_stats();
+
+    CHECK(run_duktape(JS_SOURCE) == 42);
+    ScriptCache::Stats stats = stats_since(before);
+    CHECK(stats.misses == 1 && stats.hits == 0 && stats.writes == 1);
+    CHECK(std::filesystem::exists(entry_path(ScriptCache::LANGUAGE_DUKTAPE, JS_SOURCE)));
+
+    CHECK(run_duktape(JS_SOURCE) == 42);
+    stats = stats_since(before);
+    CHECK(stats.misses == 1 && stats.hits == 1 && stats.writes == 1);
+
+    CHECK(load_lua(LUA_SOURCE) == LUA_SOURCE);
+    CHECK(load_lua(LUA_SOURCE) == LUA_SOURCE);
+    stats = stats_since(before);
+    CHECK(stats.misses == 2 && stats.hits == 2 && stats.writes == 2);
+    CHECK(std::filesystem::exists(entry_path(ScriptCache::LANGUAGE_LUA, LUA_SOURCE)));
+
+    // Another source is another entry.
+    CHECK(run_duktape("40 + 2") == 42);
+    CHECK(stats_since(before).misses == 3);
+
+    // No directory, no cache.
+    ScriptCache::set_cache_dir("");
+    CHECK(run_duktape(JS_SOURCE) == 42);
+    stats = stats_since(before);
+    CHECK(stats.misses == 4 && stats.hits == 2 && stats.writes == 3);
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE(script_cache_rejects_damaged_entries) {
+    const std::string dir = temp_dir("damaged");
+    ScriptCache::set_cache_dir(dir);
+    CHECK(run_duktape(JS_SOURCE) == 42);
+    const std::string path = entry_path(ScriptCache::LANGUAGE_DUKTAPE, JS_SOURCE);
+    const std::string good = read_file(path);
+    REQUIRE(good.size() > HEADER_SIZE);
+
+    // Header that does not describe this source.
+    std::string header = good;
+    header[SOURCE_SIZE_OFFSET] ^= 1;
+    write_file(path, header);
+    ScriptCache::Stats before = ScriptCache::get_stats();
+    CHECK(run_duktape(JS_SOURCE) == 42);
+    ScriptCache::Stats stats = stats_since(before);
+    CHECK(stats.rejected == 1 && stats.misses == 1 && stats.hits == 0 && stats.writes == 1);
+    CHECK(read_file(path) == good);
+
+    // Payload flipped under an intact header.
+    std::string payload = good;
+    payload[HEADER_SIZE + (good.size() - HEADER_SIZE) / 2] ^= 0x40;
+    write_file(path, payload);
+    before = ScriptCache::get_stats();
+    CHECK(run_duktape(JS_SOURCE) == 42);
+    stats = stats_since(before);
+    CHECK(stats.rejected == 1 && stats.misses == 1 && stats.writes == 1);
+    CHECK(read_file(path) == good);
+
+    // Truncated.
+    write_file(path, good.substr(0, good.size() - 3));
+    before = ScriptCache::get_stats();
+    CHECK(run_duktape(JS_SOURCE) == 42);
+    CHECK(stats_since(before).rejected == 1);
+
+    // The rewritten entry is trusted again.
+    before = ScriptCache::get_stats();
+    CHECK(run_duktape(JS_SOURCE) == 42);
+    stats = stats_since(before);
+    CHECK(stats.hits == 1 && stats.rejected == 0);
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE(script_cache_writes_through_a_temp_file) {
+    const std::string dir = temp_dir("rename");
+    ScriptCache::set_cache_dir(dir);
+    const std::string path = entry_path(ScriptCache::LANGUAGE_DUKTAPE, JS_SOURCE);
+
+    // Leftover of an interrupted run: replaced, and gone after the rename.
+    write_file(path + ".tmp", "partial");
+    CHECK(run_duktape(JS_SOURCE) == 42);
+    CHECK(!std::filesystem::exists(path + ".tmp"));
+    CHECK(std::filesystem::exists(path));
+    size_t entries = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        CHECK(entry.path().extension() == ".jsbc");
+        entries++;
+    }
+    CHECK(entries == 1);
+
+    // When the temp file cannot be written, nothing is published and the
+    // script still loads from source.
+    std::filesystem::remove(path);
+    std::filesystem::create_directory(path + ".tmp");
+    const ScriptCache::Stats before = ScriptCache::get_stats();
+    CHECK(run_duktape(JS_SOURCE) == 42);
+    CHECK(stats_since(before).writes == 0);
+    CHECK(!std::filesystem::exists(path));
+
+    ScriptCache::clear();
+    std::filesystem::remove(path + ".tmp");
+    CHECK(std::filesystem::is_empty(dir));
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE(script_cache_bytecode_only_when_trusted) {
+    ScriptCache::set_cache_dir("");
+
+    std::vector<uint8_t> js;
+    REQUIRE(ScriptCache::export_duktape(JS_SOURCE, "test.js", js) == OK);
+    const std::string js_bytecode(js.begin(), js.end());
+    CHECK(run_duktape(js_bytecode, true) == 42);
+    CHECK(run_duktape(js_bytecode) == -1);
+
+    std::vector<uint8_t> lua;
+    REQUIRE(ScriptCache::export_lua(LUA_SOURCE, "test.lua", lua) == OK);
+    const std::string lua_bytecode(lua.begin(), lua.end());
+    CHECK(memcmp(lua_bytecode.data(), LUA_SIGNATURE, 4) == 0);
+    CHECK(load_lua(lua_bytecode, true) == LUA_SOURCE);
+    CHECK(load_lua(lua_bytecode).empty());
+
+    // Trust only opens the bytecode path; text still loads as text.
+    CHECK(run_duktape(JS_SOURCE, true) == 42);
+    CHECK(load_lua(LUA_SOURCE, true) == LUA_SOURCE);
+}
@@ -0,0 +1,165 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "test_macros.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "core/object/message_queue.h"
+#include "core/templates/delegate.h"
+#include "core/variant/signals.h"
+
+namespace {
+
+typedef Signal<int> IntSignal;
+
+uint32_t flush() {
+    return MessageQueue::get_singleton()->flush();
+}
+
+} // namespace
+
+TEST_CASE(signal_disconnect_during_emit) {
+    IntSignal signal;
+    std::vector<int> calls;
+    signal.connect("a", nullptr, [&](int p_value) {
+        calls.push_back(p_value);
+        // Later slots disconnected here are skipped in this emission.
+        signal.disconnect("b", nullptr);
+        signal.disconnect("a", nullptr);
+    });
+    signal.connect("b", nullptr, [&](int p_value) { calls.push_back(p_value * 10); });
+    signal.connect("c", nullptr, [&](int p_value) { calls.push_back(p_value * 100); });
+    signal.emit(1);
+    CHECK((calls == std::vector<int>{ 1, 100 }));
+    CHECK(signal.get_connection_count() == 1);
+    CHECK(!signal.is_connected("a", nullptr));
+
+    calls.clear();
+    signal.emit(2);
+    CHECK((calls == std::vector<int>{ 200 }));
+
+    // A one-shot slot that emits again is not called twice.
+    calls.clear();
+    signal.connect("once", nullptr, [&](int p_value) {
+        calls.push_back(-p_value);
+        if (p_value == 3) {
+            signal.emit(4);
+        }
+    }, CONNECT_ONE_SHOT);
+    signal.emit(3);
+    CHECK((calls == std::vector<int>{ 300, -3, 400 }));
+    CHECK(signal.get_connection_count() == 1);
+}
+
+TEST_CASE(signal_connect_during_emit) {
+    IntSignal signal;
+    std::vector<int> calls;
+    signal.connect("a", nullptr, [&](int p_value) {
+        calls.push_back(p_value);
+        if (p_value == 1) {
+            // Waits for the next emission, after the existing slots.
+            signal.connect("late", nullptr, [&](int p_late) { calls.push_back(p_late * 10); });
+        }
+    });
+    signal.connect("b", nullptr, [&](int p_value) { calls.push_back(p_value * 100); });
+    signal.emit(1);
+    CHECK((calls == std::vector<int>{ 1, 100 }));
+    CHECK(signal.get_connection_count() == 3);
+    CHECK(signal.is_connected("late", nullptr));
+
+    calls.clear();
+    signal.emit(2);
+    CHECK((calls == std::vector<int>{ 2, 200, 20 }));
+
+    // Connected during emission and disconnected before it ended.
+    calls.clear();
+    signal.connect("c", nullptr, [&](int) {
+        signal.connect("gone", nullptr, [&](int) { calls.push_back(-1); });
+        signal.disconnect("gone", nullptr);
+    });
+    signal.emit(3);
+    signal.emit(4);
+    CHECK((calls == std::vector<int>{ 3, 300, 30, 4, 400, 40 }));
+}
+
+TEST_CASE(signal_deferred_after_destroy) {
+    flush();
+    std::vector<int> calls;
+    std::unique_ptr<IntSignal> signal = std::make_unique<IntSignal>();
+    signal->connect("d", nullptr, [&](int p_value) { calls.push_back(p_value); }, CONNECT_DEFERRED);
+    signal->emit(1);
+    signal->emit(2);
+    CHECK(calls.empty());
+    CHECK(flush() == 2);
+    CHECK((calls == std::vector<int>{ 1, 2 }));
+
+    // The queued emission outlives the signal: the token drops it.
+    calls.clear();
+    signal->emit(3);
+    signal.reset();
+    CHECK(flush() == 1);
+    CHECK(calls.empty());
+}
+
+TEST_CASE(signal_emit_from_worker_thread) {
+    flush();
+    IntSignal signal;
+    std::vector<int> calls;
+    std::vector<std::thread::id> threads;
+    signal.connect("now", nullptr, [&](int p_value) {
+        calls.push_back(p_value);
+        threads.push_back(std::this_thread::get_id());
+    });
+    signal.connect("later", nullptr, [&](int p_value) {
+        calls.push_back(p_value * 10);
+        threads.push_back(std::this_thread::get_id());
+    }, CONNECT_DEFERRED);
+
+    // Immediate slots are not run on the worker; the whole emission waits
+    // for the flush on this thread.
+    std::thread([&] { signal.emit(1); }).join();
+    CHECK(calls.empty());
+    CHECK(flush() == 1);
+    CHECK((calls == std::vector<int>{ 1, 10 }));
+    CHECK(threads.size() == 2 && threads[0] == std::this_thread::get_id() && threads[1] == std::this_thread::get_id());
+
+    // Nothing connected, nothing queued.
+    IntSignal quiet;
+    std::thread([&] { quiet.emit(2); }).join();
+    CHECK(flush() == 0);
+}
+
+TEST_CASE(delegate_empty_call) {
+    Delegate<void(int)> empty;
+    CHECK(!empty);
+    empty(1);
+    Delegate<int()> none;
+    CHECK(none() == 0);
+    Delegate<int()> moved = [] { return 7; };
+    Delegate<int()> target = std::move(moved);
+    CHECK(target() == 7);
+    CHECK(moved() == 0);
+}
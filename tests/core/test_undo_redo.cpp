@@ -0,0 +1,226 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "test_macros.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "core/object/undo_redo.h"
+
+namespace {
+
+class Node2D : public Object {
+    CLASS(Node2D, Object);
+
+public:
+    float x = 0.0f;
+    float y = 0.0f;
+
+    static void _bind_properties(PropertyTable& p_table) {
+        MPROPERTY(p_table, Node2D, x);
+        MPROPERTY(p_table, Node2D, y);
+    }
+};
+
+int undo_all(UndoRedo& p_undo) {
+    int steps = 0;
+    while (p_undo.has_undo()) {
+        p_undo.undo();
+        steps++;
+    }
+    return steps;
+}
+
+std::vector<uint8_t> random_bytes(std::mt19937& p_rng, size_t p_size) {
+    std::vector<uint8_t> data(p_size);
+    for (uint8_t& byte : data) {
+        byte = static_cast<uint8_t>(p_rng());
+    }
+    return data;
+}
+
+} // namespace
+
+TEST_CASE(undo_redo_merge_ends_keeps_first_undo_and_last_do) {
+    UndoRedo undo;
+    Node2D node;
+    const int x = node.get_property_index("x");
+    REQUIRE(x >= 0);
+
+    for (int i = 0; i < 5; i++) {
+        float from = float(i);
+        float to = float(i + 1);
+        node.x = to;
+        undo.add_property_action(&node, x, from, to);
+    }
+    CHECK(undo.get_memory_stats().merged == 4);
+
+    undo.undo();
+    CHECK(node.x == 0.0f);
+    CHECK(!undo.has_undo());
+    undo.redo();
+    CHECK(node.x == 5.0f);
+}
+
+TEST_CASE(undo_redo_merge_disable_and_break_merge) {
+    UndoRedo undo;
+    Node2D node;
+    const int x = node.get_property_index("x");
+
+    undo.add_property_action(&node, x, 0.0f, 1.0f, UndoRedo::MERGE_DISABLE);
+    undo.add_property_action(&node, x, 1.0f, 2.0f, UndoRedo::MERGE_DISABLE);
+    undo.add_property_action(&node, x, 2.0f, 3.0f);
+    undo.add_property_action(&node, x, 3.0f, 4.0f);
+    undo.break_merge();
+    undo.add_property_action(&node, x, 4.0f, 5.0f);
+    CHECK(undo.get_memory_stats().merged == 1);
+
+    node.x = 5.0f;
+    undo.undo();
+    CHECK(node.x == 4.0f);
+    undo.undo();
+    CHECK(node.x == 2.0f);
+    CHECK(undo_all(undo) == 2);
+    CHECK(node.x == 0.0f);
+}
+
+TEST_CASE(undo_redo_merge_needs_same_object_property_and_type) {
+    UndoRedo undo;
+    Node2D a;
+    Node2D b;
+    const int x = a.get_property_index("x");
+    const int y = a.get_property_index("y");
+
+    undo.add_property_action(&a, x, 0.0f, 1.0f);
+    undo.add_property_action(&b, x, 0.0f, 1.0f);
+    undo.add_property_action(&b, y, 0.0f, 1.0f);
+    // Same object and slot, different value type: merging would reinterpret
+    // a double as the float the previous edit holds.
+    undo.add_property_action(&b, y, 0.0, 2.0);
+    CHECK(undo.get_memory_stats().merged == 0);
+
+    // A generic action reusing the property edit's key does not merge either.
+    undo.add_property_action(&a, y, 0.0f, 1.0f);
+    const uint64_t key = (static_cast<uint64_t>(a.get_instance_id()) * 0x9E3779B97F4A7C15ull) ^ static_cast<uint64_t>(y + 1);
+    undo.add_action("other", [] {}, [] {}, UndoRedo::MERGE_ENDS, key);
+    CHECK(undo.get_memory_stats().merged == 0);
+    CHECK(undo_all(undo) == 6);
+
+    undo.add_action("a", [] {}, [] {}, UndoRedo::MERGE_ENDS, 7);
+    undo.add_action("b", [] {}, [] {}, UndoRedo::MERGE_ENDS, 7);
+    CHECK(undo.get_memory_stats().merged == 1);
+}
+
+TEST_CASE(undo_redo_property_action_rejects_bad_index) {
+    UndoRedo undo;
+    Node2D node;
+    undo.add_property_action(&node, 99, 0.0f, 1.0f);
+    undo.add_property_action(&node, -1, 0.0f, 1.0f);
+    undo.add_property_action<float>(nullptr, 0, 0.0f, 1.0f);
+    CHECK(!undo.has_undo());
+}
+
+TEST_CASE(undo_redo_step_limit_and_memory_cap) {
+    UndoRedo undo;
+    int value = 0;
+    for (int i = 0; i < 10; i++) {
+        undo.add_action("step", [&value, i] { value = i + 1; }, [&value, i] { value = i; });
+    }
+    undo.set_max_steps(3);
+    CHECK(undo.get_memory_stats().evicted == 7);
+    value = 10;
+    CHECK(undo_all(undo) == 3);
+    CHECK(value == 7);
+    undo.clear_history();
+    undo.set_max_steps(0);
+
+    std::vector<uint8_t> state(4096, 0);
+    auto capture = [&state] { return state; };
+    auto apply = [&state](const std::vector<uint8_t>& p_state) { state = p_state; };
+    std::mt19937 rng(3);
+    for (int i = 0; i < 8; i++) {
+        std::vector<uint8_t> before = state;
+        std::vector<uint8_t> after = random_bytes(rng, state.size());
+        state = after;
+        undo.add_snapshot_action("paint", before, after, capture, apply);
+    }
+    const UndoRedo::MemoryStats full = undo.get_memory_stats();
+    CHECK(full.undoBytes > 8 * 4096);
+
+    // Room for about two snapshots; the newest one always stays.
+    undo.set_max_memory(full.undoBytes / 4);
+    const UndoRedo::MemoryStats capped = undo.get_memory_stats();
+    CHECK(capped.undoBytes <= full.undoBytes / 4);
+    CHECK(capped.evicted >= 6);
+    undo.set_max_memory(1);
+    CHECK(undo.has_undo());
+    CHECK(undo_all(undo) == 1);
+}
+
+TEST_CASE(undo_redo_delta_round_trip) {
+    std::mt19937 rng(11);
+    const size_t sizes[][2] = { { 0, 0 }, { 0, 100 }, { 100, 0 }, { 1000, 1000 }, { 1000, 1700 }, { 5000, 300 } };
+    for (const auto& size : sizes) {
+        std::vector<uint8_t> from = random_bytes(rng, size[0]);
+        std::vector<uint8_t> to = from;
+        to.resize(size[1]);
+        for (size_t i = 0; i < to.size(); i += 97) {
+            to[i] ^= 0x5A;
+        }
+        const std::vector<uint8_t> delta = UndoRedo::encode_delta(from, to);
+
+        std::vector<uint8_t> forward = from;
+        UndoRedo::apply_delta(forward, delta);
+        CHECK(forward == to);
+        std::vector<uint8_t> back = to;
+        UndoRedo::apply_delta(back, delta);
+        CHECK(back == from);
+    }
+
+    // A local change in a big buffer costs a few bytes.
+    std::vector<uint8_t> big = random_bytes(rng, 1 << 20);
+    std::vector<uint8_t> edited = big;
+    for (size_t i = 500000; i < 500016; i++) {
+        edited[i] = uint8_t(~edited[i]);
+    }
+    const std::vector<uint8_t> delta = UndoRedo::encode_delta(big, edited);
+    CHECK(delta.size() < 64);
+    UndoRedo::apply_delta(big, delta);
+    CHECK(big == edited);
+}
+
+TEST_CASE(undo_redo_snapshot_action_do_and_undo) {
+    UndoRedo undo;
+    std::vector<uint8_t> state = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    const std::vector<uint8_t> before = state;
+    const std::vector<uint8_t> after = { 1, 2, 9, 4, 5, 6, 7, 8, 10, 11 };
+    state = after;
+    undo.add_snapshot_action("edit", before, after, [&state] { return state; },
+                             [&state](const std::vector<uint8_t>& p_state) { state = p_state; });
+    undo.undo();
+    CHECK(state == before);
+    undo.redo();
+    CHECK(state == after);
+}
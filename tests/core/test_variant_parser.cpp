@@ -0,0 +1,118 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "test_macros.h"
+
+#include <cmath>
+#include <cstring>
+#include <string>
+
+#include "core/variant/variant_parser.h"
+
+namespace {
+
+// Parses "key = <p_value>" and returns the value event.
+Error parse_value(const char* p_value, VariantParser::Event& r_event) {
+    static std::string text;
+    text = std::string("key = ") + p_value + "\n";
+    static VariantParser parser;
+    parser.open_buffer(text.data(), text.size());
+    Error err = parser.next(r_event);
+    if (err != OK) {
+        return err;
+    }
+    return parser.next(r_event);
+}
+
+} // namespace
+
+TEST_CASE(parser_events_of_a_scene) {
+    const char* text =
+            "[gd_scene load_steps=2 format=3]\n"
+            "[node name=\"Player\" type=\"Node2D\"]\n"
+            "position = Vector2(10, 20)\n"
+            "tags = [\"a\", 2]\n";
+    VariantParser parser;
+    parser.open_buffer(text, strlen(text));
+    VariantParser::Event event;
+    const VariantParser::EventType expected[] = {
+        VariantParser::EVENT_TAG_BEGIN, VariantParser::EVENT_KEY, VariantParser::EVENT_VALUE, VariantParser::EVENT_KEY, VariantParser::EVENT_VALUE, VariantParser::EVENT_TAG_END,
+        VariantParser::EVENT_TAG_BEGIN, VariantParser::EVENT_KEY, VariantParser::EVENT_VALUE, VariantParser::EVENT_KEY, VariantParser::EVENT_VALUE, VariantParser::EVENT_TAG_END,
+        VariantParser::EVENT_KEY, VariantParser::EVENT_VALUE,
+        VariantParser::EVENT_KEY, VariantParser::EVENT_ARRAY_BEGIN, VariantParser::EVENT_VALUE, VariantParser::EVENT_VALUE, VariantParser::EVENT_ARRAY_END,
+        VariantParser::EVENT_EOF,
+    };
+    for (VariantParser::EventType type : expected) {
+        REQUIRE(parser.next(event) == OK);
+        CHECK(event.type == type);
+        if (event.type == VariantParser::EVENT_VALUE && event.value.get_type() == Variant::VECTOR2) {
+            Vector2 v = event.value;
+            CHECK(v.x == 10.0f && v.y == 20.0f);
+        }
+    }
+}
+
+TEST_CASE(parser_non_finite_reals) {
+    VariantParser::Event event;
+    REQUIRE(parse_value("nan", event) == OK);
+    CHECK(std::isnan(event.value.operator double()));
+    REQUIRE(parse_value("inf_neg", event) == OK);
+    CHECK(event.value.operator double() == -INFINITY);
+
+    // ConfigFile writes non-finite Vector2 components this way.
+    REQUIRE(parse_value("Vector2(nan, inf)", event) == OK);
+    Vector2 v = event.value;
+    CHECK(std::isnan(v.x));
+    CHECK(std::isinf(v.y) && v.y > 0);
+    REQUIRE(parse_value("Vector2(inf_neg, 1.5)", event) == OK);
+    v = event.value;
+    CHECK(v.x == -INFINITY && v.y == 1.5f);
+
+    // Integer constructors have no non-finite values.
+    CHECK(parse_value("Vector2i(nan, 1)", event) != OK);
+    CHECK(parse_value("Vector2(nope, 1)", event) != OK);
+}
+
+TEST_CASE(parser_string_literal_types) {
+    VariantParser::Event event;
+    REQUIRE(parse_value("\"plain\"", event) == OK);
+    CHECK(event.is_string && event.string_type == VariantParser::STRING_PLAIN);
+    REQUIRE(parse_value("&\"name\"", event) == OK);
+    CHECK(event.is_string && event.string_type == VariantParser::STRING_NAME);
+    CHECK(event.text == "name");
+    REQUIRE(parse_value("^\"Node/Path\"", event) == OK);
+    CHECK(event.is_string && event.string_type == VariantParser::STRING_NODE_PATH);
+    CHECK(event.text == "Node/Path");
+    CHECK(parse_value("&name", event) != OK);
+}
+
+TEST_CASE(parser_integer_constructors_reject_fractions) {
+    VariantParser::Event event;
+    REQUIRE(parse_value("Rect2i(1, -2, 3.0, 4)", event) == OK);
+    Rect2i r = event.value;
+    CHECK(r == Rect2i(1, -2, 3, 4));
+    CHECK(parse_value("Rect2i(1.5, 0, 0, 0)", event) != OK);
+    CHECK(parse_value("Vector2i(0, -0.25)", event) != OK);
+    CHECK(parse_value("Vector2i(0, 1e10)", event) != OK);
+    REQUIRE(parse_value("Vector2(1.5, 0.25)", event) == OK);
+}
@@ -0,0 +1,235 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "test_macros.h"
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "core/variant/variant_utils.h"
+
+namespace {
+
+std::vector<Variant> sample_scalars() {
+    return {
+        Variant(),
+        Variant(true),
+        Variant(false),
+        Variant(int64_t(0)),
+        Variant(int64_t(-1)),
+        Variant(INT64_MAX),
+        Variant(INT64_MIN),
+        Variant(1.5), // Fits a float32.
+        Variant(0.1), // Needs a float64.
+        Variant(Vector2{ -3.25f, 1e30f }),
+        Variant(Vector2i(INT32_MIN, INT32_MAX)),
+        Variant(Rect2i(-4, 8, 16, 32)),
+        Variant(Color{ 1, 2, 3, 255 }),
+        Variant(std::string("short")),
+        Variant(std::string(200, 'x')), // Written inline.
+    };
+}
+
+// A buffer holding every kind of value the format knows.
+std::vector<uint8_t> sample_buffer() {
+    VariantEncoder encoder;
+    const std::vector<Variant> scalars = sample_scalars();
+    for (const Variant& value : scalars) {
+        encoder.put(value);
+    }
+    encoder.put_array(scalars);
+    Dictionary<Variant> dictionary;
+    dictionary.insert("name", Variant(std::string("Player")));
+    dictionary.insert("hp", Variant(int64_t(100)));
+    encoder.put_dictionary(dictionary);
+    const int32_t ints[] = { 1, -2, 3 };
+    const double doubles[] = { 0.5, -1e300 };
+    const Vector2 points[] = { { 1.0f, 2.0f }, { 3.0f, 4.0f } };
+    const Color colors[] = { { 1, 2, 3, 4 } };
+    encoder.put_packed(ints, 3);
+    encoder.put_packed(doubles, 2);
+    encoder.put_packed(points, 2);
+    encoder.put_packed(colors, 1);
+    std::vector<uint8_t> bytes;
+    encoder.finish(bytes);
+    return bytes;
+}
+
+// Walks every value of a buffer, the way a loader would. Must never crash.
+Error decode_all(const std::vector<uint8_t>& p_bytes) {
+    VariantDecoder decoder;
+    Error err = decoder.open(p_bytes.data(), p_bytes.size());
+    while (err == OK && !decoder.is_at_end()) {
+        const VariantBinary::Tag tag = decoder.get_next_tag();
+        if (tag == VariantBinary::TAG_ARRAY) {
+            std::vector<Variant> array;
+            err = decoder.read_array(array);
+        } else if (tag == VariantBinary::TAG_DICTIONARY) {
+            Dictionary<Variant> dictionary;
+            err = decoder.read_dictionary(dictionary);
+        } else if (tag == VariantBinary::TAG_PACKED_FLOAT64) {
+            std::vector<double> values;
+            err = decoder.read_packed(values);
+        } else if (tag >= VariantBinary::TAG_PACKED_BYTE && tag < VariantBinary::TAG_MAX) {
+            err = decoder.skip();
+        } else {
+            Variant value;
+            err = decoder.read(value);
+        }
+    }
+    return err;
+}
+
+} // namespace
+
+TEST_CASE(variant_binary_scalar_round_trip) {
+    const std::vector<uint8_t> bytes = sample_buffer();
+    VariantDecoder decoder;
+    REQUIRE(decoder.open(bytes.data(), bytes.size()) == OK);
+    for (const Variant& expected : sample_scalars()) {
+        Variant value;
+        REQUIRE(decoder.read(value) == OK);
+        CHECK(value.get_type() == expected.get_type());
+        CHECK(value == expected);
+    }
+
+    std::vector<Variant> array;
+    REQUIRE(decoder.read_array(array) == OK);
+    CHECK(array.size() == sample_scalars().size());
+    CHECK(array[9] == sample_scalars()[9]);
+
+    Dictionary<Variant> dictionary;
+    REQUIRE(decoder.read_dictionary(dictionary) == OK);
+    REQUIRE(dictionary.getptr("hp"));
+    CHECK(int64_t(*dictionary.getptr("hp")) == 100);
+    CHECK(*dictionary.getptr("name")->get_string_ptr() == "Player");
+
+    const int32_t* ints;
+    uint32_t count;
+    REQUIRE(decoder.read_packed(ints, count) == OK);
+    CHECK(count == 3 && ints[0] == 1 && ints[1] == -2 && ints[2] == 3);
+    std::vector<double> doubles;
+    REQUIRE(decoder.read_packed(doubles) == OK);
+    CHECK(doubles.size() == 2 && doubles[1] == -1e300);
+    PackedArray<Vector2> points;
+    REQUIRE(decoder.read_packed(points) == OK);
+    CHECK(points.size() == 2 && points[1] == (Vector2{ 3.0f, 4.0f }));
+    std::vector<Color> colors;
+    REQUIRE(decoder.read_packed(colors) == OK);
+    CHECK(colors.size() == 1 && colors[0] == (Color{ 1, 2, 3, 4 }));
+    CHECK(decoder.is_at_end());
+}
+
+TEST_CASE(variant_binary_repeated_keys_are_interned) {
+    VariantEncoder encoder;
+    for (int i = 0; i < 1000; i++) {
+        encoder.put_dictionary_begin(1);
+        encoder.put_key("position");
+        encoder.put(Variant(int64_t(i)));
+    }
+    CHECK(encoder.get_string_count() == 1);
+    std::vector<uint8_t> bytes;
+    encoder.finish(bytes);
+
+    VariantDecoder decoder;
+    REQUIRE(decoder.open(bytes.data(), bytes.size()) == OK);
+    int records = 0;
+    while (!decoder.is_at_end()) {
+        REQUIRE(decoder.skip() == OK);
+        records++;
+    }
+    CHECK(records == 1000);
+}
+
+TEST_CASE(variant_binary_truncated_int_leaves_value) {
+    VariantEncoder encoder;
+    encoder.put(Variant(int64_t(1) << 40)); // A multi-byte varint.
+    std::vector<uint8_t> bytes;
+    encoder.finish(bytes);
+    bytes.pop_back();
+
+    VariantDecoder decoder;
+    REQUIRE(decoder.open(bytes.data(), bytes.size()) == OK);
+    Variant value(std::string("untouched"));
+    CHECK(decoder.read(value) == ERR_FILE_CORRUPT);
+    CHECK(value == Variant(std::string("untouched")));
+    // The cursor is left at the value, so the error is stable.
+    CHECK(decoder.read(value) == ERR_FILE_CORRUPT);
+}
+
+TEST_CASE(variant_binary_every_truncation_fails_cleanly) {
+    const std::vector<uint8_t> bytes = sample_buffer();
+    REQUIRE(decode_all(bytes) == OK);
+    for (size_t size = 0; size < bytes.size(); size++) {
+        const std::vector<uint8_t> prefix(bytes.begin(), bytes.begin() + size);
+        decode_all(prefix);
+    }
+}
+
+TEST_CASE(variant_binary_fuzz) {
+    const std::vector<uint8_t> bytes = sample_buffer();
+    std::mt19937 rng(1234);
+    for (int round = 0; round < 20000; round++) {
+        std::vector<uint8_t> mutated = bytes;
+        const int flips = 1 + int(rng() % 8);
+        for (int i = 0; i < flips; i++) {
+            // Leave the magic and version alone most of the time so the
+            // body gets exercised.
+            const size_t at = rng() % 4 == 0 ? rng() % mutated.size() : VariantBinary::HEADER_SIZE + rng() % (mutated.size() - VariantBinary::HEADER_SIZE);
+            mutated[at] = uint8_t(rng());
+        }
+        if (rng() % 4 == 0) {
+            mutated.resize(rng() % mutated.size());
+        }
+        decode_all(mutated);
+    }
+    // Pure noise behind a valid header.
+    for (int round = 0; round < 2000; round++) {
+        std::vector<uint8_t> noise(VariantBinary::HEADER_SIZE + rng() % 256);
+        for (uint8_t& byte : noise) {
+            byte = uint8_t(rng());
+        }
+        std::copy(bytes.begin(), bytes.begin() + VariantBinary::HEADER_SIZE, noise.begin());
+        decode_all(noise);
+    }
+}
+
+TEST_CASE(variant_binary_swap_packed) {
+    int32_t ints[] = { 0x01020304, -1 };
+    VariantBinary::swap_packed(VariantBinary::TAG_PACKED_INT32, ints, 2);
+    CHECK(ints[0] == 0x04030201 && ints[1] == -1);
+    VariantBinary::swap_packed(VariantBinary::TAG_PACKED_INT32, ints, 2);
+    CHECK(ints[0] == 0x01020304);
+
+    Color colors[] = { { 1, 2, 3, 4 } };
+    VariantBinary::swap_packed(VariantBinary::TAG_PACKED_COLOR, colors, 1);
+    CHECK(colors[0] == (Color{ 1, 2, 3, 4 }));
+
+    Vector2 point = { 1.0f, 2.0f };
+    VariantBinary::swap_packed(VariantBinary::TAG_PACKED_VECTOR2, &point, 1);
+    VariantBinary::swap_packed(VariantBinary::TAG_PACKED_VECTOR2, &point, 1);
+    CHECK(point == (Vector2{ 1.0f, 2.0f }));
+}
@@ -0,0 +1,77 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef M_OBJECT_H
+#define M_OBJECT_H
+
+#include <cstring>
+#include <type_traits>
+
+#include "core/object/object_db.h"
+#include "core/object/property_table.h"
+#include "stubs/test_object.h"
+
+// Stand-in for core/object/m_object.h, which pulls in the graphics stack.
+// CLASS() keeps only what the property table needs: a per-class table that
+// chains to the base one and is filled from _bind_properties(). Method
+// binding is a no-op on the stub Object. Classes on another base (CLASS
+// over RefCounted) get an empty table of their own.
+
+template <class B, class = void>
+struct _StubBase {
+    static PropertyTable* get_table() { return nullptr; }
+};
+
+template <class B>
+struct _StubBase<B, std::void_t<decltype(&B::get_property_table_static)>> {
+    static PropertyTable* get_table() { return &B::get_property_table_static(); }
+};
+
+template <class T, class B>
+bool _init_property_table(PropertyTable& p_table) {
+    if constexpr (std::is_base_of<Object, T>::value) {
+        if (&T::_bind_properties != &B::_bind_properties) {
+            T::_bind_properties(p_table);
+        }
+    }
+    (void)p_table;
+    return true;
+}
+
+#define CLASS(class_name, base_class_name)                                                      \
+public:                                                                                         \
+    static const char* get_class_name_static() { return #class_name; }                          \
+    static PropertyTable& get_property_table_static() {                                         \
+        static PropertyTable table(_StubBase<base_class_name>::get_table(), #class_name);       \
+        static bool bound = _init_property_table<class_name, base_class_name>(table);           \
+        (void)bound;                                                                            \
+        return table;                                                                           \
+    }                                                                                           \
+    virtual const PropertyTable& _get_property_table() const {                                  \
+        return get_property_table_static();                                                     \
+    }                                                                                           \
+    static void _bind_methods();                                                                \
+                                                                                                \
+private:
+
+#endif // M_OBJECT_H
@@ -0,0 +1,96 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "thirdparty/lua/lua.hpp"
+
+// The Lua library is not part of the tree, only its headers. ScriptCache
+// only loads, dumps and pops, so this stand-in models a state as a stack of
+// strings: a loaded chunk is its source text and a dump is LUA_SIGNATURE
+// followed by that text. It is enough to tell which path a load took.
+struct lua_State {
+    std::vector<std::string> stack;
+};
+
+namespace {
+
+const size_t SIGNATURE_SIZE = sizeof(LUA_SIGNATURE) - 1;
+
+int _push_error(lua_State* L, const char* p_message) {
+    L->stack.push_back(p_message);
+    return LUA_ERRSYNTAX;
+}
+
+} // namespace
+
+extern "C" {
+
+lua_State* luaL_newstate(void) {
+    return new lua_State;
+}
+
+void lua_close(lua_State* L) {
+    delete L;
+}
+
+int lua_gettop(lua_State* L) {
+    return static_cast<int>(L->stack.size());
+}
+
+void lua_settop(lua_State* L, int idx) {
+    L->stack.resize(idx >= 0 ? static_cast<size_t>(idx) : L->stack.size() + idx + 1);
+}
+
+const char* lua_tolstring(lua_State* L, int idx, size_t* len) {
+    const std::string& value = L->stack[idx > 0 ? idx - 1 : L->stack.size() + idx];
+    if (len) {
+        *len = value.size();
+    }
+    return value.c_str();
+}
+
+int luaL_loadbufferx(lua_State* L, const char* buff, size_t sz, const char*, const char* mode) {
+    const bool binary = sz >= SIGNATURE_SIZE && memcmp(buff, LUA_SIGNATURE, SIGNATURE_SIZE) == 0;
+    if (binary && mode && !strchr(mode, 'b')) {
+        return _push_error(L, "attempt to load a binary chunk");
+    }
+    if (!binary && mode && !strchr(mode, 't')) {
+        return _push_error(L, "attempt to load a text chunk");
+    }
+    std::string chunk = binary ? std::string(buff + SIGNATURE_SIZE, sz - SIGNATURE_SIZE) : std::string(buff, sz);
+    if (chunk.find("syntax error") != std::string::npos) {
+        return _push_error(L, "syntax error");
+    }
+    L->stack.push_back(chunk);
+    return LUA_OK;
+}
+
+int lua_dump(lua_State* L, lua_Writer writer, void* data, int) {
+    const std::string dump = LUA_SIGNATURE + L->stack.back();
+    return writer(L, dump.data(), dump.size(), data);
+}
+
+} // extern "C"
@@ -0,0 +1,83 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef TEST_OBJECT_H
+#define TEST_OBJECT_H
+
+#include "core/object/object_db.h"
+#include "core/object/property_table.h"
+
+// Object sits behind core/typedefs.h and the graphics stack, which the test
+// targets do not build. This stand-in registers with ObjectDB the same way
+// the real one in core/object/m_object.h does, which is all Callable, the
+// property table and MessageQueue need. The property accessors mirror the
+// real ones so UndoRedo and friends can be tested against it.
+class Object {
+public:
+    Object() {}
+    Object(const Object&) {}
+    Object& operator=(const Object&) { return *this; }
+    virtual ~Object() { ObjectDB::remove_instance(_instance_id); }
+
+    static PropertyTable& get_property_table_static() {
+        static PropertyTable table(nullptr, "Object");
+        return table;
+    }
+    virtual const PropertyTable& _get_property_table() const { return get_property_table_static(); }
+    static void _bind_properties(PropertyTable& p_table) {}
+
+    int get_property_index(const std::string& p_name) const { return _get_property_table().find(p_name); }
+
+    template <typename M>
+    static void bind_method(const char* p_name, M p_method) {}
+
+    template <typename T>
+    T get_property_value(int p_index) const {
+        T value{};
+        const PropertyTable& table = _get_property_table();
+        if (table.is_type<T>(p_index)) {
+            table.get(this, p_index, &value);
+        }
+        return value;
+    }
+
+    template <typename T>
+    void set_property_value(int p_index, const T& p_value) {
+        const PropertyTable& table = _get_property_table();
+        if (table.is_type<T>(p_index)) {
+            table.set(this, p_index, &p_value);
+        }
+    }
+
+    ObjectID get_instance_id() const {
+        if (_instance_id.is_null()) {
+            _instance_id = ObjectDB::add_instance(const_cast<Object*>(this));
+        }
+        return _instance_id;
+    }
+
+private:
+    mutable ObjectID _instance_id;
+};
+
+#endif // TEST_OBJECT_H
@@ -0,0 +1,79 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef TEST_MACROS_H
+#define TEST_MACROS_H
+
+#include <cstdio>
+#include <vector>
+
+/**
+ * Minimal test harness: TEST_CASE registers a function, test_main.cpp runs
+ * every registered case of the executable. CHECK records a failure and
+ * continues, REQUIRE returns from the case.
+ */
+struct TestCase {
+    const char* name;
+    void (*function)();
+};
+
+inline std::vector<TestCase>& test_cases() {
+    static std::vector<TestCase> cases;
+    return cases;
+}
+
+inline int& test_failures() {
+    static int failures = 0;
+    return failures;
+}
+
+struct TestRegistrar {
+    TestRegistrar(const char* p_name, void (*p_function)()) { test_cases().push_back({ p_name, p_function }); }
+};
+
+inline void test_fail(const char* p_file, int p_line, const char* p_expression) {
+    std::printf("%s:%d: check failed: %s\n", p_file, p_line, p_expression);
+    test_failures()++;
+}
+
+#define TEST_CASE(m_name)                                              \
+    static void m_name();                                              \
+    static TestRegistrar m_name##_registrar(#m_name, &m_name);         \
+    static void m_name()
+
+#define CHECK(m_expression)                                            \
+    do {                                                               \
+        if (!(m_expression)) {                                         \
+            test_fail(__FILE__, __LINE__, #m_expression);              \
+        }                                                              \
+    } while (0)
+
+#define REQUIRE(m_expression)                                          \
+    do {                                                               \
+        if (!(m_expression)) {                                         \
+            test_fail(__FILE__, __LINE__, #m_expression);              \
+            return;                                                    \
+        }                                                              \
+    } while (0)
+
+#endif // TEST_MACROS_H
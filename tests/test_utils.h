@@ -0,0 +1,74 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef TEST_UTILS_H
+#define TEST_UTILS_H
+
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <unistd.h>
+
+#include "core/templates/span.h"
+
+// Helpers shared by the test executables.
+
+// Scratch directory named after the test and the process id, created empty and
+// removed again when the owner goes out of scope.
+class TempDir {
+    std::string path;
+
+public:
+    explicit TempDir(const std::string& p_name) :
+            path((std::filesystem::temp_directory_path() / ("patsher_test_" + p_name + "_" + std::to_string(getpid()))).string()) {
+        std::error_code ec;
+        std::filesystem::remove_all(path, ec);
+        std::filesystem::create_directories(path, ec);
+    }
+    ~TempDir() {
+        std::error_code ec;
+        std::filesystem::remove_all(path, ec);
+    }
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+
+    const std::string& get_path() const { return path; }
+};
+
+// Returns the scratch directory of this test process; it is removed at exit.
+inline const std::string& temp_dir() {
+    static TempDir dir("tmp");
+    return dir.get_path();
+}
+
+inline std::vector<uint8_t> bytes(const std::string& p_text) {
+    return std::vector<uint8_t>(p_text.begin(), p_text.end());
+}
+
+inline std::string text(Span<const uint8_t> p_data) {
+    return std::string(reinterpret_cast<const char*>(p_data.data()), p_data.size());
+}
+
+#endif // TEST_UTILS_H
@@ -0,0 +1,124 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef ZIP_WRITER_H
+#define ZIP_WRITER_H
+
+#include <zlib.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Builds small ZIP archives in memory for the zip tests and benchmarks:
+// stored or raw-deflated entries, no ZIP64, no timestamps.
+class ZipWriter {
+    struct Record {
+        std::string name;
+        uint16_t method;
+        uint32_t crc;
+        uint32_t compressed_size;
+        uint32_t uncompressed_size;
+        uint32_t offset;
+    };
+
+    std::vector<uint8_t> data;
+    std::vector<Record> records;
+
+    void _put_16(uint16_t p_value) {
+        data.push_back(uint8_t(p_value));
+        data.push_back(uint8_t(p_value >> 8));
+    }
+    void _put_32(uint32_t p_value) {
+        _put_16(uint16_t(p_value));
+        _put_16(uint16_t(p_value >> 16));
+    }
+
+public:
+    void add(const std::string& p_name, const std::vector<uint8_t>& p_content, bool p_deflate, int p_level = Z_DEFAULT_COMPRESSION) {
+        std::vector<uint8_t> payload = p_content;
+        if (p_deflate) {
+            z_stream stream = {};
+            deflateInit2(&stream, p_level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+            payload.resize(deflateBound(&stream, uLong(p_content.size())));
+            stream.next_in = const_cast<Bytef*>(p_content.data());
+            stream.avail_in = uInt(p_content.size());
+            stream.next_out = payload.data();
+            stream.avail_out = uInt(payload.size());
+            deflate(&stream, Z_FINISH);
+            payload.resize(stream.total_out);
+            deflateEnd(&stream);
+        }
+        const Record record = { p_name, uint16_t(p_deflate ? 8 : 0), uint32_t(::crc32(0, p_content.data(), uInt(p_content.size()))),
+            uint32_t(payload.size()), uint32_t(p_content.size()), uint32_t(data.size()) };
+        _put_32(0x04034b50);
+        _put_16(20); // version needed
+        _put_16(0); // flags
+        _put_16(record.method);
+        _put_32(0); // time, date
+        _put_32(record.crc);
+        _put_32(record.compressed_size);
+        _put_32(record.uncompressed_size);
+        _put_16(uint16_t(p_name.size()));
+        _put_16(0); // extra
+        data.insert(data.end(), p_name.begin(), p_name.end());
+        data.insert(data.end(), payload.begin(), payload.end());
+        records.push_back(record);
+    }
+
+    std::vector<uint8_t> finish() {
+        const uint32_t directory_offset = uint32_t(data.size());
+        for (const Record& record : records) {
+            _put_32(0x02014b50);
+            _put_16(20); // version made by
+            _put_16(20); // version needed
+            _put_16(0); // flags
+            _put_16(record.method);
+            _put_32(0); // time, date
+            _put_32(record.crc);
+            _put_32(record.compressed_size);
+            _put_32(record.uncompressed_size);
+            _put_16(uint16_t(record.name.size()));
+            _put_16(0); // extra
+            _put_16(0); // comment
+            _put_16(0); // disk
+            _put_16(0); // internal attributes
+            _put_32(0); // external attributes
+            _put_32(record.offset);
+            data.insert(data.end(), record.name.begin(), record.name.end());
+        }
+        const uint32_t directory_size = uint32_t(data.size()) - directory_offset;
+        _put_32(0x06054b50);
+        _put_16(0); // disk
+        _put_16(0); // directory disk
+        _put_16(uint16_t(records.size()));
+        _put_16(uint16_t(records.size()));
+        _put_32(directory_size);
+        _put_32(directory_offset);
+        _put_16(0); // comment
+        records.clear();
+        return std::move(data);
+    }
+};
+
+#endif // ZIP_WRITER_H
@@ -0,0 +1,144 @@
+/**
+ * MIT License
+
+Copyright (c) 2024/2025 rPatsher
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+/**
+ * patsher_pack: builds and inspects pack files.
+ *
+ *   patsher_pack create <out.pck> <directory> [--prefix <path>] [--delete <path>]...
+ *   patsher_pack list <pack.pck>
+ *   patsher_pack cat <pack.pck> <path>
+ *
+ * --delete writes a deletion marker, so a patch pack can remove a file that
+ * exists in the base pack.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "core/io/file_system_pack.h"
+
+static int _usage() {
+    std::fprintf(stderr,
+            "usage:\n"
+            "  patsher_pack create <out.pck> <directory> [--prefix <path>] [--delete <path>]...\n"
+            "  patsher_pack list <pack.pck>\n"
+            "  patsher_pack cat <pack.pck> <path>\n");
+    return 2;
+}
+
+static int _create(int argc, char** argv) {
+    if (argc < 4) {
+        return _usage();
+    }
+    std::string output = argv[2];
+    std::string directory = argv[3];
+    std::string prefix;
+    std::vector<std::string> deleted;
+    for (int i = 4; i < argc; i++) {
+        if (std::strcmp(argv[i], "--prefix") == 0 && i + 1 < argc) {
+            prefix = argv[++i];
+        } else if (std::strcmp(argv[i], "--delete") == 0 && i + 1 < argc) {
+            deleted.push_back(argv[++i]);
+        } else {
+            return _usage();
+        }
+    }
+
+    PackWriter writer;
+    Error err = writer.add_directory(directory, prefix);
+    if (err != OK) {
+        std::fprintf(stderr, "patsher_pack: cannot read '%s' (error %d)\n", directory.c_str(), err);
+        return 1;
+    }
+    for (const std::string& path : deleted) {
+        if (writer.add_deletion(path) != OK) {
+            std::fprintf(stderr, "patsher_pack: invalid path '%s'\n", path.c_str());
+            return 1;
+        }
+    }
+    err = writer.save(output);
+    if (err != OK) {
+        std::fprintf(stderr, "patsher_pack: cannot write '%s' (error %d)\n", output.c_str(), err);
+        return 1;
+    }
+    std::printf("%s: %d entries\n", output.c_str(), writer.get_file_count());
+    return 0;
+}
+
+static int _list(int argc, char** argv) {
+    if (argc != 3) {
+        return _usage();
+    }
+    PackFile pack;
+    Error err = pack.open(argv[2]);
+    if (err != OK) {
+        std::fprintf(stderr, "patsher_pack: cannot open '%s' (error %d)\n", argv[2], err);
+        return 1;
+    }
+    for (const std::string& path : pack.get_file_list()) {
+        Span<const uint8_t> data;
+        pack.get_file(path, data);
+        std::printf("%12zu  %s\n", data.size(), path.c_str());
+    }
+    for (const std::string& path : pack.get_deleted_list()) {
+        std::printf("%12s  %s\n", "deleted", path.c_str());
+    }
+    return 0;
+}
+
+static int _cat(int argc, char** argv) {
+    if (argc != 4) {
+        return _usage();
+    }
+    PackFile pack;
+    Error err = pack.open(argv[2]);
+    if (err != OK) {
+        std::fprintf(stderr, "patsher_pack: cannot open '%s' (error %d)\n", argv[2], err);
+        return 1;
+    }
+    Span<const uint8_t> data;
+    if (!pack.get_file(argv[3], data)) {
+        std::fprintf(stderr, "patsher_pack: '%s' not in pack\n", argv[3]);
+        return 1;
+    }
+    std::fwrite(data.data(), 1, data.size(), stdout);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        return _usage();
+    }
+    if (std::strcmp(argv[1], "create") == 0) {
+        return _create(argc, argv);
+    }
+    if (std::strcmp(argv[1], "list") == 0) {
+        return _list(argc, argv);
+    }
+    if (std::strcmp(argv[1], "cat") == 0) {
+        return _cat(argc, argv);
+    }
+    return _usage();
+}